@@ -33,6 +33,7 @@ copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\storage.h %COINDIR%\include\I
 copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\worker.h %COINDIR%\include\Inventor\C\threads\worker.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\wpool.h %COINDIR%\include\Inventor\C\threads\wpool.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\sched.h %COINDIR%\include\Inventor\C\threads\sched.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\wsched.h %COINDIR%\include\Inventor\C\threads\wsched.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\sync.h %COINDIR%\include\Inventor\C\threads\sync.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\fifo.h %COINDIR%\include\Inventor\C\threads\fifo.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\C\threads\barrier.h %COINDIR%\include\Inventor\C\threads\barrier.h >nul:
@@ -122,8 +123,12 @@ copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoLineHighlightRenderAction.h %
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoPickAction.h %COINDIR%\include\Inventor\actions\SoPickAction.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoRayPickAction.h %COINDIR%\include\Inventor\actions\SoRayPickAction.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoReorganizeAction.h %COINDIR%\include\Inventor\actions\SoReorganizeAction.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoBatchMergeAction.h %COINDIR%\include\Inventor\actions\SoBatchMergeAction.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoRenderListAction.h %COINDIR%\include\Inventor\actions\SoRenderListAction.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoSearchAction.h %COINDIR%\include\Inventor\actions\SoSearchAction.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoSimplifyAction.h %COINDIR%\include\Inventor\actions\SoSimplifyAction.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoShapeSimplifyAction.h %COINDIR%\include\Inventor\actions\SoShapeSimplifyAction.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoGlobalSimplifyAction.h %COINDIR%\include\Inventor\actions\SoGlobalSimplifyAction.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoToVRMLAction.h %COINDIR%\include\Inventor\actions\SoToVRMLAction.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoToVRML2Action.h %COINDIR%\include\Inventor\actions\SoToVRML2Action.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\actions\SoWriteAction.h %COINDIR%\include\Inventor\actions\SoWriteAction.h >nul:
@@ -174,6 +179,7 @@ copy /Y ..\%msvc%\..\..\include\Inventor\details\SoConeDetail.h %COINDIR%\includ
 copy /Y ..\%msvc%\..\..\include\Inventor\details\SoCubeDetail.h %COINDIR%\include\Inventor\details\SoCubeDetail.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\details\SoCylinderDetail.h %COINDIR%\include\Inventor\details\SoCylinderDetail.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\details\SoFaceDetail.h %COINDIR%\include\Inventor\details\SoFaceDetail.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\details\SoInstanceDetail.h %COINDIR%\include\Inventor\details\SoInstanceDetail.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\details\SoLineDetail.h %COINDIR%\include\Inventor\details\SoLineDetail.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\details\SoNodeKitDetail.h %COINDIR%\include\Inventor\details\SoNodeKitDetail.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\details\SoPointDetail.h %COINDIR%\include\Inventor\details\SoPointDetail.h >nul:
@@ -606,6 +612,7 @@ copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoIndexedPointSet.h %COINDIR%\inc
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoIndexedShape.h %COINDIR%\include\Inventor\nodes\SoIndexedShape.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoIndexedTriangleStripSet.h %COINDIR%\include\Inventor\nodes\SoIndexedTriangleStripSet.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoInfo.h %COINDIR%\include\Inventor\nodes\SoInfo.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoInstancedCopy.h %COINDIR%\include\Inventor\nodes\SoInstancedCopy.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoLOD.h %COINDIR%\include\Inventor\nodes\SoLOD.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoLabel.h %COINDIR%\include\Inventor\nodes\SoLabel.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoLevelOfDetail.h %COINDIR%\include\Inventor\nodes\SoLevelOfDetail.h >nul:
@@ -648,6 +655,7 @@ copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoRotor.h %COINDIR%\include\Inven
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoScale.h %COINDIR%\include\Inventor\nodes\SoScale.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoSceneTexture2.h %COINDIR%\include\Inventor\nodes\SoSceneTexture2.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoSceneTextureCubeMap.h %COINDIR%\include\Inventor\nodes\SoSceneTextureCubeMap.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoScreenSpaceErrorLOD.h %COINDIR%\include\Inventor\nodes\SoScreenSpaceErrorLOD.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoSelection.h %COINDIR%\include\Inventor\nodes\SoSelection.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoSeparator.h %COINDIR%\include\Inventor\nodes\SoSeparator.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\nodes\SoShape.h %COINDIR%\include\Inventor\nodes\SoShape.h >nul:
@@ -811,6 +819,7 @@ copy /Y ..\%msvc%\..\..\include\Inventor\SbDPPlane.h %COINDIR%\include\Inventor\
 copy /Y ..\%msvc%\..\..\include\Inventor\SbDPRotation.h %COINDIR%\include\Inventor\SbDPRotation.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\SbDPViewVolume.h %COINDIR%\include\Inventor\SbDPViewVolume.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\SbDict.h %COINDIR%\include\Inventor\SbDict.h >nul:
+copy /Y ..\%msvc%\..\..\include\Inventor\SbExternalBuffer.h %COINDIR%\include\Inventor\SbExternalBuffer.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\SbHeap.h %COINDIR%\include\Inventor\SbHeap.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\SbImage.h %COINDIR%\include\Inventor\SbImage.h >nul:
 copy /Y ..\%msvc%\..\..\include\Inventor\SbLine.h %COINDIR%\include\Inventor\SbLine.h >nul:
@@ -33,6 +33,7 @@ del %COINDIR%\include\Inventor\C\threads\storage.h
 del %COINDIR%\include\Inventor\C\threads\worker.h
 del %COINDIR%\include\Inventor\C\threads\wpool.h
 del %COINDIR%\include\Inventor\C\threads\sched.h
+del %COINDIR%\include\Inventor\C\threads\wsched.h
 del %COINDIR%\include\Inventor\C\threads\sync.h
 del %COINDIR%\include\Inventor\C\threads\fifo.h
 del %COINDIR%\include\Inventor\C\threads\barrier.h
@@ -122,8 +123,12 @@ del %COINDIR%\include\Inventor\actions\SoLineHighlightRenderAction.h
 del %COINDIR%\include\Inventor\actions\SoPickAction.h
 del %COINDIR%\include\Inventor\actions\SoRayPickAction.h
 del %COINDIR%\include\Inventor\actions\SoReorganizeAction.h
+del %COINDIR%\include\Inventor\actions\SoBatchMergeAction.h
+del %COINDIR%\include\Inventor\actions\SoRenderListAction.h
 del %COINDIR%\include\Inventor\actions\SoSearchAction.h
 del %COINDIR%\include\Inventor\actions\SoSimplifyAction.h
+del %COINDIR%\include\Inventor\actions\SoShapeSimplifyAction.h
+del %COINDIR%\include\Inventor\actions\SoGlobalSimplifyAction.h
 del %COINDIR%\include\Inventor\actions\SoToVRMLAction.h
 del %COINDIR%\include\Inventor\actions\SoToVRML2Action.h
 del %COINDIR%\include\Inventor\actions\SoWriteAction.h
@@ -174,6 +179,7 @@ del %COINDIR%\include\Inventor\details\SoConeDetail.h
 del %COINDIR%\include\Inventor\details\SoCubeDetail.h
 del %COINDIR%\include\Inventor\details\SoCylinderDetail.h
 del %COINDIR%\include\Inventor\details\SoFaceDetail.h
+del %COINDIR%\include\Inventor\details\SoInstanceDetail.h
 del %COINDIR%\include\Inventor\details\SoLineDetail.h
 del %COINDIR%\include\Inventor\details\SoNodeKitDetail.h
 del %COINDIR%\include\Inventor\details\SoPointDetail.h
@@ -606,6 +612,7 @@ del %COINDIR%\include\Inventor\nodes\SoIndexedPointSet.h
 del %COINDIR%\include\Inventor\nodes\SoIndexedShape.h
 del %COINDIR%\include\Inventor\nodes\SoIndexedTriangleStripSet.h
 del %COINDIR%\include\Inventor\nodes\SoInfo.h
+del %COINDIR%\include\Inventor\nodes\SoInstancedCopy.h
 del %COINDIR%\include\Inventor\nodes\SoLOD.h
 del %COINDIR%\include\Inventor\nodes\SoLabel.h
 del %COINDIR%\include\Inventor\nodes\SoLevelOfDetail.h
@@ -648,6 +655,7 @@ del %COINDIR%\include\Inventor\nodes\SoRotor.h
 del %COINDIR%\include\Inventor\nodes\SoScale.h
 del %COINDIR%\include\Inventor\nodes\SoSceneTexture2.h
 del %COINDIR%\include\Inventor\nodes\SoSceneTextureCubeMap.h
+del %COINDIR%\include\Inventor\nodes\SoScreenSpaceErrorLOD.h
 del %COINDIR%\include\Inventor\nodes\SoSelection.h
 del %COINDIR%\include\Inventor\nodes\SoSeparator.h
 del %COINDIR%\include\Inventor\nodes\SoShape.h
@@ -811,6 +819,7 @@ del %COINDIR%\include\Inventor\SbDPPlane.h
 del %COINDIR%\include\Inventor\SbDPRotation.h
 del %COINDIR%\include\Inventor\SbDPViewVolume.h
 del %COINDIR%\include\Inventor\SbDict.h
+del %COINDIR%\include\Inventor\SbExternalBuffer.h
 del %COINDIR%\include\Inventor\SbHeap.h
 del %COINDIR%\include\Inventor\SbImage.h
 del %COINDIR%\include\Inventor\SbLine.h
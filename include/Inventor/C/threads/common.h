@@ -52,6 +52,8 @@ extern "C" {
 /* ********************************************************************** */
 
   typedef struct cc_sched cc_sched;
+  typedef struct cc_wsched cc_wsched;
+  typedef struct cc_wsched_group cc_wsched_group;
   typedef struct cc_wpool cc_wpool;
   typedef struct cc_worker cc_worker;
   typedef struct cc_thread cc_thread;
@@ -0,0 +1,75 @@
+#ifndef COIN_SBEXTERNALBUFFER_H
+#define COIN_SBEXTERNALBUFFER_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/system/inttypes.h>
+#include <stddef.h> // for size_t
+
+class COIN_DLL_API SbExternalBuffer {
+public:
+  enum Access {
+    READ_ONLY,
+    READ_WRITE
+  };
+
+  typedef void ReleaseCB(void * closure, void * data, size_t size);
+
+  SbExternalBuffer(void * data, const size_t size,
+                   const Access access = READ_ONLY,
+                   ReleaseCB * releasecb = NULL, void * closure = NULL);
+
+  static SbExternalBuffer * mapFile(const char * filename,
+                                    const Access access = READ_ONLY);
+
+  void ref(void) const;
+  void unref(void) const;
+  int32_t getRefCount(void) const;
+
+  const void * getData(void) const;
+  void * getWritableData(void) const;
+  size_t getSize(void) const;
+  Access getAccess(void) const;
+  SbBool isWritable(void) const;
+  SbBool isMapped(void) const;
+
+private:
+  SbExternalBuffer(const SbExternalBuffer & buffer);
+  SbExternalBuffer & operator=(const SbExternalBuffer & buffer);
+  ~SbExternalBuffer();
+
+  class SbExternalBufferP * pimpl;
+};
+
+#endif // !COIN_SBEXTERNALBUFFER_H
@@ -55,6 +55,10 @@ class SoProto;
 class SoField;
 class SoFieldContainer;
 class SoInputP;
+class SoInput;
+class SoNode;
+
+typedef SbBool SoInputNodeCB(void * userdata, SoInput * in, SoNode * node, int depth);
 
 // *************************************************************************
 
@@ -87,6 +91,7 @@ public:
   virtual void setBuffer(const void * bufpointer, size_t bufsize);
           void setStringArray(const char * strings[]);
   virtual size_t getNumBytesRead(void) const;
+  void setNodeCallback(SoInputNodeCB * func, void * userdata, int maxdepth = 0);
   virtual SbString getHeader(void);
   virtual float getIVVersion(void);
   virtual SbBool isBinary(void);
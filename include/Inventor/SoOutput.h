@@ -157,6 +157,7 @@ private:
   
   friend class SoBase; // Need to be able to remove items from dict.
   friend class SoWriterefCounter; // ditto
+  friend class SoOutput_Writer; // for getWriter()
   void removeSoBase2IdRef(const SoBase * base);
 };
 
@@ -35,6 +35,7 @@
 
 #include <Inventor/SbColor4f.h>
 #include <Inventor/SbVec2s.h>
+#include <Inventor/SbTime.h>
 #include <Inventor/actions/SoGLRenderAction.h>
 
 class SbViewportRegion;
@@ -184,6 +185,16 @@ public:
   static SbBool isRealTimeUpdateEnabled(void);
   static uint32_t getDefaultRedrawPriority(void);
 
+  void setTargetFrameTime(const SbTime & frametime);
+  SbTime getTargetFrameTime(void) const;
+  void setMinimumQuality(const float quality);
+  float getMinimumQuality(void) const;
+  void setSmallFeatureSize(const float pixels);
+  float getSmallFeatureSize(void) const;
+  float getQualityLevel(void) const;
+  SbTime getLastFrameTime(void) const;
+  SbTime getAverageFrameTime(void) const;
+
   void addPreRenderCallback(SoRenderManagerRenderCB * cb, void * data);
   void removePreRenderCallback(SoRenderManagerRenderCB * cb, void * data);
 
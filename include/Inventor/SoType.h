@@ -59,6 +59,7 @@ template <class Type> class SbList;
 class COIN_DLL_API SoType {
 public:
   typedef void * (*instantiationMethod)(void);
+  typedef void (*initClassMethod)(void);
 
   static SoType fromName(const SbName name);
   SbName getName(void) const;
@@ -90,6 +91,11 @@ public:
 
   static SbBool removeType(const SbName & name);
 
+  static void deferInitClass(const SbName & name, const SbName & parent,
+                             const initClassMethod method);
+  static SbBool initDeferredClass(const SbName & name);
+  static void initDeferredClasses(void);
+
   static void init(void);
 
   static SoType fromKey(uint16_t key);
@@ -105,6 +111,8 @@ public:
 
 private:
   static void clean(void);
+  static int getAllInitializedDerivedFrom(const SoType type, SoTypeList & list);
+  friend class SoActionMethodList;
 
   int16_t index;
 
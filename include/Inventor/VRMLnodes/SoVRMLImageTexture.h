@@ -86,7 +86,8 @@ private:
   static void urlSensorCB(void *, SoSensor *);
   static void glimage_callback(void * closure);
   static SbBool image_read_cb(const SbString &, SbImage *, void *);
-  static void read_thread(void * closure);
+  static SbBool prequalify_read_cb(const SbString &, SbImage *, void *);
+  static void image_loaded_cb(void *, SbImage * const *, const int);
   static SbBool default_prequalify_cb(const SbString & url,  void * closure, 
                                       SoVRMLImageTexture * node);
   static void oneshot_readimage_cb(void *, SoSensor *);
@@ -0,0 +1,80 @@
+#ifndef COIN_SOBATCHMERGEACTION_H
+#define COIN_SOBATCHMERGEACTION_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Inventor/actions/SoReorganizeAction.h>
+
+class SoPath;
+class SoPickedPoint;
+class SoShape;
+class SoBatchMergeActionP;
+
+class COIN_DLL_API SoBatchMergeAction : public SoReorganizeAction {
+  typedef SoReorganizeAction inherited;
+
+  SO_ACTION_HEADER(SoBatchMergeAction);
+
+public:
+  static void initClass(void);
+
+  SoBatchMergeAction(void);
+  virtual ~SoBatchMergeAction(void);
+
+  void setMinBatchSize(const int numshapes);
+  int getMinBatchSize(void) const;
+
+  virtual void apply(SoNode * root);
+  virtual void apply(SoPath * path);
+  virtual void apply(const SoPathList & pathlist, SbBool obeysrules = FALSE);
+
+  int getNumBatches(void) const;
+  SoShape * getBatchShape(const int batch) const;
+  int getNumMergedShapes(void) const;
+
+  const SoPath * getOriginalPath(const SoShape * batchshape,
+                                 const int primitiveindex) const;
+  const SoPath * getOriginalPath(const SoPickedPoint * pp) const;
+
+protected:
+  virtual void beginTraversal(SoNode * node);
+
+private:
+  SbPimplPtr<SoBatchMergeActionP> pimpl;
+
+  // NOT IMPLEMENTED:
+  SoBatchMergeAction(const SoBatchMergeAction & rhs);
+  SoBatchMergeAction & operator = (const SoBatchMergeAction & rhs);
+}; // SoBatchMergeAction
+
+#endif // !COIN_SOBATCHMERGEACTION_H
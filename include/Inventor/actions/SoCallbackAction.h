@@ -182,6 +182,9 @@ public:
   void setCallbackAll(SbBool callbackall);
   SbBool isCallbackAll(void) const;
 
+  void setCompiledTraversal(const SbBool onoff);
+  SbBool isCompiledTraversal(void) const;
+
 protected:
   virtual void beginTraversal(SoNode * node);
 
@@ -191,6 +194,7 @@ private:
 private:
   SbPimplPtr<SoCallbackActionP> pimpl;
   friend class SoCallbackActionP;
+  friend class SoShapeListCache;
 
   SoCallbackAction(const SoCallbackAction & rhs);
   SoCallbackAction & operator = (const SoCallbackAction & rhs);
@@ -84,6 +84,12 @@ public:
     CUSTOM_CALLBACK
   };
 
+  enum RenderListMode {
+    NO_RENDER_LIST,
+    IMMEDIATE_RENDER_LIST,
+    PIPELINED_RENDER_LIST
+  };
+
   typedef AbortCode SoGLRenderAbortCB(void * userdata);
 
   void setViewportRegion(const SbViewportRegion & newregion);
@@ -135,6 +141,17 @@ public:
   SbBool isRenderingTranspPaths(void) const;
   SbBool isRenderingTranspBackfaces(void) const;
 
+  void setRenderListMode(const RenderListMode mode);
+  RenderListMode getRenderListMode(void) const;
+  void setStateSorting(const SbBool onoff);
+  SbBool isStateSorting(void) const;
+  int getNumStateChanges(const int key) const;
+
+  uint32_t getFrameCounter(void) const;
+
+  void setSmallFeatureSize(const float pixels);
+  float getSmallFeatureSize(void) const;
+
 protected:
   friend class SoGLRenderActionP; // calls beginTraversal
   virtual void beginTraversal(SoNode * node);
@@ -33,14 +33,10 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-// FIXME: this class has not yet been implemented in Coin. this is a
-// placeholder / stub / skeleton code, not yet built (nor installed,
-// obviously).  --mortene.
-
 #include <Inventor/actions/SoSimplifyAction.h>
-#include <Inventor/tools/SbLazyPimplPtr.h>
 
 class SoGlobalSimplifyActionP;
+class SoSeparator;
 
 class COIN_DLL_API SoGlobalSimplifyAction : public SoSimplifyAction {
   typedef SoSimplifyAction inherited;
@@ -53,11 +49,13 @@ public:
   SoGlobalSimplifyAction(void);
   virtual ~SoGlobalSimplifyAction(void);
 
+  SoSeparator * getSimplifiedSceneGraph(void) const;
+
 protected:
   virtual void beginTraversal(SoNode * node);
 
 private:
-  SbLazyPimplPtr<SoGlobalSimplifyActionP> pimpl;
+  SbPimplPtr<SoGlobalSimplifyActionP> pimpl;
 
   // NOT IMPLEMENTED:
   SoGlobalSimplifyAction(const SoGlobalSimplifyAction & rhs);
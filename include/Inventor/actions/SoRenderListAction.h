@@ -0,0 +1,97 @@
+#ifndef COIN_SORENDERLISTACTION_H
+#define COIN_SORENDERLISTACTION_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoSubAction.h>
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbMatrix.h>
+#include <Inventor/lists/SbList.h>
+
+class SoPath;
+class SoPathList;
+class SoRenderListActionP;
+
+class COIN_DLL_API SoRenderListAction : public SoCallbackAction {
+  typedef SoCallbackAction inherited;
+
+  SO_ACTION_HEADER(SoRenderListAction);
+
+public:
+  static void initClass(void);
+
+  SoRenderListAction(void);
+  SoRenderListAction(const SbViewportRegion & vp);
+  virtual ~SoRenderListAction(void);
+
+  enum StateKey {
+    SHADER_KEY,
+    TEXTURE_KEY,
+    MATERIAL_KEY,
+    VERTEX_DATA_KEY,
+    NUM_STATE_KEYS
+  };
+
+  static void addEntryType(const SoType type);
+
+  int getNumEntries(void) const;
+  SoNode * getNode(const int entry) const;
+  const SbMatrix & getModelMatrix(const int entry) const;
+  const SbBox3f & getBoundingBox(const int entry) const;
+  SbBool isTransparent(const int entry) const;
+  uint32_t getStateKey(const int entry, const StateKey key) const;
+
+  SoPath * createPath(const int entry) const;
+  int getPaths(SoPathList & pathlist) const;
+
+  void getOpaqueShapes(SbList<int> & entries, const SbBool sortbystate) const;
+  int countStateChanges(const SbList<int> & entries, const StateKey key) const;
+
+  int getNumCulled(void) const;
+  SoNode * getRoot(void) const;
+
+protected:
+  virtual void beginTraversal(SoNode * node);
+
+private:
+  SbPimplPtr<SoRenderListActionP> pimpl;
+
+  // NOT IMPLEMENTED:
+  SoRenderListAction(const SoRenderListAction & rhs);
+  SoRenderListAction & operator = (const SoRenderListAction & rhs);
+}; // SoRenderListAction
+
+#endif // !COIN_SORENDERLISTACTION_H
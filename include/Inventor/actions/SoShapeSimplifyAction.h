@@ -33,12 +33,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-// FIXME: this class has not yet been implemented in Coin. this is a
-// placeholder / stub / skeleton code, not yet built (nor installed,
-// obviously).  --mortene.
-
 #include <Inventor/actions/SoSimplifyAction.h>
-#include <Inventor/tools/SbLazyPimplPtr.h>
 
 class SoShapeSimplifyActionP;
 
@@ -53,11 +48,13 @@ public:
   SoShapeSimplifyAction(void);
   virtual ~SoShapeSimplifyAction(void);
 
+  int getNumSimplifiedShapes(void) const;
+
 protected:
   virtual void beginTraversal(SoNode * node);
 
 private:
-  SbLazyPimplPtr<SoShapeSimplifyActionP> pimpl;
+  SbPimplPtr<SoShapeSimplifyActionP> pimpl;
 
   // NOT IMPLEMENTED:
   SoShapeSimplifyAction(const SoShapeSimplifyAction & rhs);
@@ -53,6 +53,23 @@ public:
   virtual void apply(SoPath * path);
   virtual void apply(const SoPathList & pathlist, SbBool obeysrules = FALSE);
 
+  void setSimplificationLevels(const int num, const float levels[]);
+  const float * getSimplificationLevels(void) const;
+  int getNumSimplificationLevels(void) const;
+
+  void setRanges(const int num, const float ranges[]);
+  const float * getRanges(void) const;
+  int getNumRanges(void) const;
+
+  void setSizeFactor(const float size);
+  float getSizeFactor(void) const;
+
+  void setMinTriangles(const int num);
+  int getMinTriangles(void) const;
+
+  void setNumThreads(const int num);
+  int getNumThreads(void) const;
+
 protected:
   virtual void beginTraversal(SoNode * node);
 
@@ -67,7 +67,8 @@ public:
   // profiling setters
   enum FootprintType {
     MEMORY_SIZE,
-    VIDEO_MEMORY_SIZE
+    VIDEO_MEMORY_SIZE,
+    SHARED_MEMORY_SIZE
   };
 
   enum NodeFlag {
@@ -37,6 +37,7 @@
 #include <Inventor/details/SoCubeDetail.h>
 #include <Inventor/details/SoCylinderDetail.h>
 #include <Inventor/details/SoFaceDetail.h>
+#include <Inventor/details/SoInstanceDetail.h>
 #include <Inventor/details/SoLineDetail.h>
 #include <Inventor/details/SoNodeKitDetail.h>
 #include <Inventor/details/SoPointDetail.h>
@@ -278,6 +278,7 @@ protected:
 private:
   SoLazyElementP * pimpl; // for future use
 
+  friend class SoShapeListCache;
 };
 
 class COIN_DLL_API SoColorPacker {
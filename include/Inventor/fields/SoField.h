@@ -156,7 +156,11 @@ protected:
 
   virtual SoNotRec createNotRec(SoBase * cont);
 
+  void setValuesPending(const SbBool pending);
+  virtual void loadPendingValues(void);
+
 private:
+  friend class SoTranscribeP; // For readValue() & writeValue().
 
   enum FieldFlags {
     FLAG_TYPEMASK = 0x0007,  // need 3 bits for values [0-5]
@@ -169,7 +173,8 @@ private:
     FLAG_DONOTIFY = 0x0200,
     FLAG_ISDESTRUCTING = 0x0400,
     FLAG_ISEVALUATING = 0x0800,
-    FLAG_ISNOTIFIED = 0x1000
+    FLAG_ISNOTIFIED = 0x1000,
+    FLAG_VALUESPENDING = 0x2000
   };
 
   void evaluateField(void) const;
@@ -94,6 +94,7 @@ public:
   static void copyDone(void);
 
   virtual void getFieldsMemorySize(size_t & managed, size_t & unmanaged) const;
+  size_t getFieldsSharedMemorySize(void) const;
 
   void setUserData(void * userdata) const;
   void * getUserData(void) const;
@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFBool : public SoMField {
   SO_MFIELD_HEADER(SoMFBool, SbBool, SbBool);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbBool);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
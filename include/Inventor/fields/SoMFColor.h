@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFColor : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(float);
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbColor);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
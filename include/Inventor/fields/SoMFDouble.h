@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFDouble : public SoMField {
   SO_MFIELD_HEADER(SoMFDouble, double, double);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(double);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFFloat : public SoMField {
   SO_MFIELD_HEADER(SoMFFloat, float, float);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(float);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
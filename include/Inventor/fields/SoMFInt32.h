@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFInt32 : public SoMField {
   SO_MFIELD_HEADER(SoMFInt32, int32_t, int32_t);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(int32_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFShort : public SoMField {
   SO_MFIELD_HEADER(SoMFShort, short, short);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(short);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
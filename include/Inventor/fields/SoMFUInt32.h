@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFUInt32 : public SoMField {
   SO_MFIELD_HEADER(SoMFUInt32, uint32_t, uint32_t);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(uint32_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -42,6 +42,7 @@ class COIN_DLL_API SoMFUShort : public SoMField {
   SO_MFIELD_HEADER(SoMFUShort, unsigned short, unsigned short);
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(unsigned short);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec2d : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec2d);
   SO_MFIELD_SETVALUESPOINTER_HEADER(double);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec2f : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec2f);
   SO_MFIELD_SETVALUESPOINTER_HEADER(float);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec2i32 : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec2i32);
   SO_MFIELD_SETVALUESPOINTER_HEADER(int32_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
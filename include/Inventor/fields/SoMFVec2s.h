@@ -43,6 +43,7 @@ class COIN_DLL_API SoMFVec2s : public SoMField {
   SO_MFIELD_HEADER(SoMFVec2s, SbVec2s, SbVec2s);
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec2s);
   SO_MFIELD_SETVALUESPOINTER_HEADER(short);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -43,6 +43,7 @@ class COIN_DLL_API SoMFVec3b : public SoMField {
   SO_MFIELD_HEADER(SoMFVec3b, SbVec3b, SbVec3b);
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec3b);
   SO_MFIELD_SETVALUESPOINTER_HEADER(int8_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -43,6 +43,7 @@ class COIN_DLL_API SoMFVec3d : public SoMField {
   SO_MFIELD_HEADER(SoMFVec3d, SbVec3d, const SbVec3d &);
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec3d);
   SO_MFIELD_SETVALUESPOINTER_HEADER(double);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -43,6 +43,7 @@ class COIN_DLL_API SoMFVec3i32 : public SoMField {
   SO_MFIELD_HEADER(SoMFVec3i32, SbVec3i32, const SbVec3i32 &);
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec3i32);
   SO_MFIELD_SETVALUESPOINTER_HEADER(int32_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
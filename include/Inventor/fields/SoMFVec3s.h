@@ -43,6 +43,7 @@ class COIN_DLL_API SoMFVec3s : public SoMField {
   SO_MFIELD_HEADER(SoMFVec3s, SbVec3s, const SbVec3s &);
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec3s);
   SO_MFIELD_SETVALUESPOINTER_HEADER(short);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
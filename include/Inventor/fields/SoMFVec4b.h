@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec4b : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec4b);
   SO_MFIELD_SETVALUESPOINTER_HEADER(int8_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
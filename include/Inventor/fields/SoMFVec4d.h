@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec4d : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec4d);
   SO_MFIELD_SETVALUESPOINTER_HEADER(double);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
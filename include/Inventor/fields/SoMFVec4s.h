@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec4s : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec4s);
   SO_MFIELD_SETVALUESPOINTER_HEADER(short);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec4ub : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec4ub);
   SO_MFIELD_SETVALUESPOINTER_HEADER(uint8_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec4ui32 : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec4ui32);
   SO_MFIELD_SETVALUESPOINTER_HEADER(uint32_t);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
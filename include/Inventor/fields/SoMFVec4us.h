@@ -44,6 +44,7 @@ class COIN_DLL_API SoMFVec4us : public SoMField {
 
   SO_MFIELD_SETVALUESPOINTER_HEADER(SbVec4us);
   SO_MFIELD_SETVALUESPOINTER_HEADER(unsigned short);
+  SO_MFIELD_SETVALUESBUFFER_HEADER();
 
 public:
   static void initClass(void);
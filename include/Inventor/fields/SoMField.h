@@ -35,6 +35,7 @@
 
 #include <Inventor/fields/SoField.h>
 
+class SbExternalBuffer;
 class SoInput;
 class SoOutput;
 
@@ -60,6 +61,8 @@ public:
 
   virtual void enableDeleteValues(void);
   virtual SbBool isDeleteValuesEnabled(void) const;
+  SbBool isSharingValues(void) const;
+  SbExternalBuffer * getValuesBuffer(void) const;
 
 protected:
   SoMField(void);
@@ -77,11 +80,21 @@ protected:
   void setChangedIndex(const int chgidx);
   void setChangedIndices(const int chgidx = -1, const int numchgind = 0);
 
+  SbBool shareValues(const SoMField & field);
+  SbBool claimSharedValues(const int newnum);
+  SbBool releaseSharedValues(const void * values);
+  void unshareValues(void);
+  void bindValuesBuffer(const int num, SbExternalBuffer * buffer,
+                        const size_t offset);
+
   int num;
   int maxNum;
   SbBool userDataIsUsed;
+  SbBool valuesAreShared;
 
 private:
+  friend class SoTranscribeP; // For read1Value() & write1Value().
+
   virtual void deleteAllValues(void) = 0;
   virtual void copyValue(int to, int from) = 0;
   virtual SbBool readValue(SoInput * in);
@@ -91,6 +104,7 @@ private:
   virtual SbBool readBinaryValues(SoInput * in, int num);
   virtual void writeBinaryValues(SoOutput * out) const;
   virtual int getNumValuesPerLine(void) const;
+  virtual void loadPendingValues(void);
 
   static SoType classTypeId;
   int changedIndex, numChangedIndices;
@@ -105,4 +119,16 @@ SoMField::getNum(void) const
   return this->num;
 }
 
+inline SbBool
+SoMField::isSharingValues(void) const
+{
+  return this->valuesAreShared;
+}
+
+inline void
+SoMField::unshareValues(void)
+{
+  if (this->valuesAreShared) this->allocValues(this->num);
+}
+
 #endif // !COIN_SOMFIELD_H
@@ -231,6 +231,7 @@ protected: \
   virtual void * valuesPtr(void); \
   virtual void setValuesPtr(void * ptr); \
   virtual void allocValues(int num); \
+  SbBool shareValues(const _class_ & field); \
  \
   _valtype_ * values; \
 public: \
@@ -248,7 +249,8 @@ public: \
   _valref_ operator=(_valref_ val) { this->setValue(val); return val; } \
   SbBool operator==(const _class_ & field) const; \
   SbBool operator!=(const _class_ & field) const { return !operator==(field); } \
-  _valtype_ * startEditing(void) { this->evaluate(); return this->values; } \
+  _valtype_ * startEditing(void) \
+    { this->evaluate(); this->unshareValues(); return this->values; } \
   void finishEditing(void) { this->valueChanged(); }
 
 #define SO_MFIELD_DERIVED_VALUE_HEADER(_class_, _valtype_, _valref_) \
@@ -274,6 +276,10 @@ public: \
   void setValuesPointer(const int num, const _valtype_ * userdata); \
   void setValuesPointer(const int num, _valtype_ * userdata)
 
+#define SO_MFIELD_SETVALUESBUFFER_HEADER() \
+  void setValuesBuffer(const int num, SbExternalBuffer * buffer, \
+                       const size_t offset = 0)
+
 
 /**************************************************************************
  *
@@ -314,6 +320,10 @@ PRIVATE_EQUALITY_SOURCE(_class_); \
 const _class_ & \
 _class_::operator=(const _class_ & field) \
 { \
+  /* Large arrays are shared with the other field until one of */ \
+  /* them is written to, instead of being copied. */ \
+  if (this->shareValues(field)) return *this; \
+ \
   /* The allocValues() call is needed, as setValues() doesn't */ \
   /* necessarily make the field's getNum() size become the same */ \
   /* as the second argument (only if it expands on the old size). */ \
@@ -344,6 +354,12 @@ _class_::setValuesPtr(void * ptr) \
   this->values = static_cast<_valtype_ *>(ptr); \
 } \
  \
+SbBool \
+_class_::shareValues(const _class_ & field) \
+{ \
+  return SoMField::shareValues(field); \
+} \
+ \
 int \
 _class_::find(_valref_ value, SbBool addifnotfound) \
 { \
@@ -357,6 +373,7 @@ _class_::find(_valref_ value, SbBool addifnotfound) \
 void \
 _class_::setValues(const int start, const int numarg, const _valtype_ * newvals) \
 { \
+  this->unshareValues(); \
   if (start+numarg > this->maxNum) this->allocValues(start+numarg); \
   else if (start+numarg > this->num) this->num = start+numarg; \
  \
@@ -370,6 +387,7 @@ _class_::setValues(const int start, const int numarg, const _valtype_ * newvals)
 void \
 _class_::set1Value(const int idx, _valref_ value) \
 { \
+  this->unshareValues(); \
   if (idx+1 > this->maxNum) this->allocValues(idx+1); \
   else if (idx+1 > this->num) this->num = idx+1; \
   this->values[idx] = value; \
@@ -428,16 +446,22 @@ _class_::allocValues(int newnum) \
   int i; \
   int oldmaxnum; \
   _valtype_ * newblock; \
+  _valtype_ * sharedvalues = this->values; \
+  SbBool copyshared; \
   assert(newnum >= 0); \
  \
   this->setChangedIndices(); \
+  /* A buffer shared with other fields must be copied before it is */ \
+  /* changed, unless the other fields have let go of it already. */ \
+  copyshared = this->valuesAreShared && !this->claimSharedValues(newnum); \
+ \
   if (newnum == 0) { \
-    if (!this->userDataIsUsed) delete[] this->values; /* don't fetch pointer through valuesPtr() (avoids void* cast) */ \
+    if (!this->userDataIsUsed && !copyshared) delete[] this->values; /* don't fetch pointer through valuesPtr() (avoids void* cast) */ \
     this->setValuesPtr(NULL); \
     this->maxNum = 0; \
     this->userDataIsUsed = FALSE; \
   } \
-  else if (newnum > this->maxNum || newnum < this->num) { \
+  else if (copyshared || newnum > this->maxNum || newnum < this->num) { \
     if (this->valuesPtr()) { \
  \
       /* Allocation strategy is to repeatedly double the size of the */ \
@@ -451,13 +475,13 @@ _class_::allocValues(int newnum) \
       while (newnum > this->maxNum) this->maxNum *= 2; \
       while ((this->maxNum / 2) >= newnum) this->maxNum /= 2; \
  \
-      if (oldmaxnum != this->maxNum) { \
+      if (copyshared || oldmaxnum != this->maxNum) { \
         newblock = new _valtype_[this->maxNum]; \
  \
         for (i=0; i < SbMin(this->num, newnum); i++) \
           newblock[i] = this->values[i]; \
  \
-        delete[] this->values; /* don't fetch pointer through valuesPtr() (avoids void* cast) */ \
+        if (!this->userDataIsUsed && !copyshared) delete[] this->values; /* don't fetch pointer through valuesPtr() (avoids void* cast) */ \
         this->setValuesPtr(newblock); \
         this->userDataIsUsed = FALSE; \
       } \
@@ -470,6 +494,8 @@ _class_::allocValues(int newnum) \
   } \
  \
   this->num = newnum; \
+  if (copyshared && this->releaseSharedValues(sharedvalues)) \
+    delete[] sharedvalues; \
 }
 
 
@@ -520,4 +546,12 @@ _class_::setValuesPointer(const int numarg, const _usertype_ * userdata) \
   this->setValuesPointer(numarg, const_cast<_usertype_*>(userdata)); \
 }
 
+#define SO_MFIELD_SETVALUESBUFFER_SOURCE(_class_) \
+void \
+_class_::setValuesBuffer(const int numarg, SbExternalBuffer * buffer, \
+                         const size_t offset) \
+{ \
+  this->bindValuesBuffer(numarg, buffer, offset); \
+}
+
 #endif // !COIN_SOSUBFIELD_H
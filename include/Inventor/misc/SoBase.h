@@ -35,7 +35,6 @@
 
 #include <Inventor/SoType.h>
 #include <Inventor/lists/SoAuditorList.h>
-#include <Inventor/C/base/rbptree.h>
 
 class SbString;
 class SoBaseList;
@@ -126,7 +125,21 @@ private:
   } objdata;
 
   void doNotify(SoNotList * l, const void * auditor, const SoNotRec::Type type);
-  cc_rbptree auditortree;
+
+  // The first few auditors are stored inline, as most objects only
+  // have one or two (e.g. the parent node, or a sensor). The rest go
+  // in a heap allocated overflow store.
+  enum { NUM_INLINE_AUDITORS = 4 };
+  struct AuditorOverflow;
+  struct {
+    void * object[NUM_INLINE_AUDITORS];
+    unsigned char type[NUM_INLINE_AUDITORS];
+    unsigned char num;
+    // set when getAuditors() has made a list for the object
+    mutable unsigned char haslist;
+    mutable AuditorOverflow * overflow;
+  } auditordata;
+  AuditorOverflow * getAuditorOverflow(void) const;
 
   class PImpl;
   friend class PImpl; // MSVC6
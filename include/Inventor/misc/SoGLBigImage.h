@@ -36,8 +36,14 @@
 #include <Inventor/SbBasic.h>
 #include <Inventor/SbVec2s.h>
 #include <Inventor/SbVec2f.h>
+#include <Inventor/SbVec2i32.h>
 #include <Inventor/misc/SoGLImage.h>
 
+class SbString;
+
+typedef SbBool SoGLBigImageReadRowsCB(void * closure, const int y,
+                                      const int numrows, unsigned char * rows);
+
 class COIN_DLL_API SoGLBigImage : public SoGLImage {
   typedef SoGLImage inherited;
 
@@ -64,6 +70,18 @@ public:
                        const int border = 0,
                        SoState * createinstate = NULL);
 
+  SbBool setPyramidFile(const SbString & filename,
+                        const Wrap wraps = REPEAT,
+                        const Wrap wrapt = REPEAT,
+                        const float quality = 0.5f);
+  static SbBool createPyramidFile(const SbString & filename,
+                                  const SbVec2i32 & size,
+                                  const int numcomponents,
+                                  SoGLBigImageReadRowsCB * cb,
+                                  void * closure,
+                                  const int tilesize = 256);
+  static SbBool isPyramidFile(const SbString & filename);
+
   int initSubImages(const SbVec2s & subimagesize) const;
   void handleSubImage(const int idx, SbVec2f & start, SbVec2f & end,
                       SbVec2f & tcmul);
@@ -71,6 +89,7 @@ public:
                      const SbVec2s & projsize);
   SbBool exceededChangeLimit(void);
   static int setChangeLimit(const int limit);
+  static int setTextureMemoryLimit(const int megabytes);
 
   // will return NULL to avoid that SoGLTextureImageElement will
   // update the texture state.
@@ -37,6 +37,7 @@
 
 class SoGroup;
 class SoInput;
+class SoTranReceiverP;
 
 class COIN_DLL_API SoTranReceiver {
 
@@ -47,10 +48,10 @@ public:
   SbBool interpret(SoInput * input);
 
 private:
-  // Placeholder for any data for the instance. Just added for the
-  // sake of making it possible to implement this class after release
-  // without breaking ABI compatibility.
-  void * pimpl;
+  SoTranReceiver(const SoTranReceiver & rhs); // N/A
+  SoTranReceiver & operator = (const SoTranReceiver & rhs); // N/A
+
+  SoTranReceiverP * pimpl;
 };
 
 #endif // !COIN_SOTRANRECEIVER_H
@@ -37,7 +37,7 @@
 
 class SoOutput;
 class SoNode;
-
+class SoTranSenderP;
 
 class COIN_DLL_API SoTranSender {
 
@@ -53,11 +53,14 @@ public:
   void modify(SoNode * node);
   void prepareToSend(void);
 
+  void setTrackChanges(const SbBool onoff);
+  SbBool isTrackingChanges(void) const;
+
 private:
-  // Placeholder for any data for the instance. Just added for the
-  // sake of making it possible to implement this class after release
-  // without breaking ABI compatibility.
-  void * pimpl;
+  SoTranSender(const SoTranSender & rhs); // N/A
+  SoTranSender & operator = (const SoTranSender & rhs); // N/A
+
+  SoTranSenderP * pimpl;
 };
 
 #endif // !COIN_SOTRANSENDER_H
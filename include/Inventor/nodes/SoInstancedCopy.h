@@ -0,0 +1,84 @@
+#ifndef COIN_SOINSTANCEDCOPY_H
+#define COIN_SOINSTANCEDCOPY_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/fields/SoMFMatrix.h>
+#include <Inventor/fields/SoMFVec3f.h>
+#include <Inventor/fields/SoMFRotation.h>
+
+class SoInstancedCopyP;
+
+class COIN_DLL_API SoInstancedCopy : public SoGroup {
+  typedef SoGroup inherited;
+
+  SO_NODE_HEADER(SoInstancedCopy);
+
+public:
+  static void initClass(void);
+  SoInstancedCopy(void);
+
+  SoMFMatrix matrix;
+  SoMFVec3f translation;
+  SoMFRotation rotation;
+  SoMFVec3f scaleFactor;
+
+  int getNumInstances(void) const;
+  SbMatrix getInstanceMatrix(const int idx) const;
+
+  virtual SbBool affectsState(void) const;
+
+  virtual void doAction(SoAction * action);
+  virtual void callback(SoCallbackAction * action);
+  virtual void GLRender(SoGLRenderAction * action);
+  virtual void pick(SoPickAction * action);
+  virtual void rayPick(SoRayPickAction * action);
+  virtual void getBoundingBox(SoGetBoundingBoxAction * action);
+  virtual void handleEvent(SoHandleEventAction * action);
+  virtual void getMatrix(SoGetMatrixAction * action);
+  virtual void search(SoSearchAction * action);
+  virtual void getPrimitiveCount(SoGetPrimitiveCountAction * action);
+  virtual void audioRender(SoAudioRenderAction * action);
+
+  virtual void notify(SoNotList * list);
+
+protected:
+  virtual ~SoInstancedCopy();
+
+private:
+  SoInstancedCopyP * pimpl;
+};
+
+#endif // !COIN_SOINSTANCEDCOPY_H
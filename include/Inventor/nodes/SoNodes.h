@@ -77,6 +77,7 @@
 #include <Inventor/nodes/SoBlinker.h>
 #include <Inventor/nodes/SoLOD.h>
 #include <Inventor/nodes/SoLevelOfDetail.h>
+#include <Inventor/nodes/SoScreenSpaceErrorLOD.h>
 #include <Inventor/nodes/SoMultipleCopy.h>
 #include <Inventor/nodes/SoPathSwitch.h>
 #include <Inventor/nodes/SoTransformSeparator.h>
@@ -112,6 +113,7 @@
 #include <Inventor/nodes/SoFont.h>
 #include <Inventor/nodes/SoFontStyle.h>
 #include <Inventor/nodes/SoInfo.h>
+#include <Inventor/nodes/SoInstancedCopy.h>
 #include <Inventor/nodes/SoLabel.h>
 #include <Inventor/nodes/SoLightModel.h>
 #include <Inventor/nodes/SoProfile.h>
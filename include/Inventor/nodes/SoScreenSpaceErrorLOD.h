@@ -0,0 +1,92 @@
+#ifndef COIN_SOSCREENSPACEERRORLOD_H
+#define COIN_SOSCREENSPACEERRORLOD_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/fields/SoMFFloat.h>
+#include <Inventor/fields/SoMFInt32.h>
+#include <Inventor/fields/SoSFFloat.h>
+#include <Inventor/fields/SoSFVec3f.h>
+
+class SoState;
+class SoScreenSpaceErrorLODP;
+
+class COIN_DLL_API SoScreenSpaceErrorLOD : public SoGroup {
+  typedef SoGroup inherited;
+
+  SO_NODE_HEADER(SoScreenSpaceErrorLOD);
+
+public:
+  static void initClass(void);
+  SoScreenSpaceErrorLOD(void);
+  SoScreenSpaceErrorLOD(int numchildren);
+
+  SoMFFloat geometricError;
+  SoMFInt32 triangleCount;
+  SoSFVec3f center;
+  SoSFFloat maxScreenError;
+  SoSFFloat hysteresis;
+
+  static void setTriangleBudget(const int32_t numtriangles);
+  static int32_t getTriangleBudget(void);
+
+  float getScreenError(SoState * state, const int level) const;
+  int getRenderedChild(void) const;
+
+  virtual void doAction(SoAction * action);
+  virtual void callback(SoCallbackAction * action);
+  virtual void GLRender(SoGLRenderAction * action);
+  virtual void GLRenderBelowPath(SoGLRenderAction * action);
+  virtual void GLRenderInPath(SoGLRenderAction * action);
+  virtual void GLRenderOffPath(SoGLRenderAction * action);
+  virtual void rayPick(SoRayPickAction * action);
+  virtual void getPrimitiveCount(SoGetPrimitiveCountAction * action);
+  virtual void notify(SoNotList * list);
+
+protected:
+  virtual ~SoScreenSpaceErrorLOD();
+
+  virtual int whichToTraverse(SoAction * action);
+
+private:
+  void commonConstructor(void);
+
+  SoScreenSpaceErrorLODP * pimpl;
+  friend class SoScreenSpaceErrorLODP;
+};
+
+#endif // !COIN_SOSCREENSPACEERRORLOD_H
@@ -90,6 +90,7 @@ protected:
 private:
   void commonConstructor(void);
   SbBool cullTestNoPush(SoState * state);
+  void compiledCallback(SoCallbackAction * action);
 
   static int numrendercaches;
 
@@ -94,7 +94,10 @@ private: \
 // *************************************************************************
 
 #define PRIVATE_NODE_TYPESYSTEM_SOURCE(_class_) \
-SoType _class_::getClassTypeId(void) { return _class_::classTypeId; } \
+SoType _class_::getClassTypeId(void) { \
+  if (_class_::classTypeId.isBad()) (void)SoType::initDeferredClass(SO__QUOTE(_class_)); \
+  return _class_::classTypeId; \
+} \
 SoType _class_::getTypeId(void) const { return _class_::classTypeId; } \
 SoType _class_::classTypeId STATIC_SOTYPE_INIT
 
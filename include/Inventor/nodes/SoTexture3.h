@@ -44,6 +44,7 @@
 
 class SoFieldSensor;
 class SoSensor;
+class SbImage;
 
 class COIN_DLL_API SoTexture3 : public SoTexture {
   typedef SoTexture inherited;
@@ -94,6 +95,8 @@ private:
 
   class SoFieldSensor *filenamesensor;
   static void filenameSensorCB(void *, SoSensor *);
+  static void imagesLoadedCB(void * closure, SbImage * const * images,
+                             const int numimages);
 };
 
 #endif // !COIN_SOTEXTURE3_H
@@ -429,7 +429,11 @@ SoAction::initClasses(void)
   SoIntersectionDetectionAction::initClass();
 
   SoSimplifyAction::initClass();
+  SoShapeSimplifyAction::initClass();
+  SoGlobalSimplifyAction::initClass();
   SoReorganizeAction::initClass();
+  SoBatchMergeAction::initClass();
+  SoRenderListAction::initClass();
   SoToVRMLAction::initClass();
 #ifdef HAVE_VRML97
   SoToVRML2Action::initClass();
@@ -949,6 +953,11 @@ SoAction::traverse(SoNode * const node)
 
   int idx = SoNode::getActionMethodIndex(t);
   SoActionMethod func = (*this->traversalMethods)[idx];
+  if (func == NULL) {
+    // the node class was initialized during traversal
+    this->traversalMethods->setUp();
+    func = (*this->traversalMethods)[idx];
+  }
 
   SoNodeProfiling profiling;
   profiling.preTraversal(this);
@@ -0,0 +1,1098 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SoBatchMergeAction SoBatchMergeAction.h Inventor/actions/SoBatchMergeAction.h
+  \brief The SoBatchMergeAction class merges static shapes with the same appearance into a few large shapes.
+  \ingroup actions
+
+  Large CAD models typically consist of thousands of small shapes,
+  each with its own transformation, but with only a handful of
+  different materials. Rendering such a scene graph is limited by
+  the number of shapes to traverse and draw, not by the amount of
+  geometry. This action reorganizes the scene graph so that shapes
+  which are rendered with the same state are drawn with a single
+  shape instead.
+
+  The action traverses the scene graph with an SoCallbackAction and
+  collects the triangles, line segments and points of every shape.
+  The primitives are transformed into the coordinate system of the
+  node the action is applied to, and shapes sharing the same
+  material, texture, light model, draw style, shape hints, pick style
+  and lights are put in the same batch. Each batch is converted to a
+  single SoIndexedFaceSet, SoIndexedLineSet or SoPointSet with an
+  SoVertexProperty node. The merged shape replaces the first shape of
+  the batch in the scene graph, and the other shapes of the batch are
+  removed from their parent groups.
+
+  The scene graph is changed in place, so this should be done as an
+  offline step, on scene graphs that will not be modified
+  afterwards. Shapes are left untouched if they can not be merged
+  without changing the appearance of the scene. This is the case for
+  shapes below switch and level-of-detail nodes or nodekits, shapes
+  affected by clipping planes, multi-texturing or texture coordinate
+  generation, shapes with more than one material, and image and
+  screen-aligned text shapes.
+
+  Since the original shapes disappear from the scene graph, picking
+  will return the merged shapes. The action keeps the paths to all
+  merged shapes, as they were before the scene graph was changed, and
+  getOriginalPath() can be used to find the original path of a
+  picked point:
+
+  \code
+  SoBatchMergeAction merger;
+  merger.apply(root);
+  // ...
+  const SoPickedPoint * pp = rpaction->getPickedPoint();
+  const SoPath * orgpath = pp ? merger.getOriginalPath(pp) : NULL;
+  if (orgpath == NULL && pp) orgpath = pp->getPath(); // not merged
+  \endcode
+
+  The settings inherited from SoReorganizeAction are not used by this
+  action.
+
+  \sa SoReorganizeAction
+  \since Coin 4.0
+*/
+
+#include <Inventor/actions/SoBatchMergeAction.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cstring>
+#include <cassert>
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/details/SoFaceDetail.h>
+#include <Inventor/details/SoLineDetail.h>
+#include <Inventor/details/SoPointDetail.h>
+#include <Inventor/elements/SoClipPlaneElement.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/elements/SoLightElement.h>
+#include <Inventor/elements/SoMultiTextureCoordinateElement.h>
+#include <Inventor/elements/SoMultiTextureEnabledElement.h>
+#include <Inventor/elements/SoNormalElement.h>
+#include <Inventor/elements/SoPolygonOffsetElement.h>
+#include <Inventor/elements/SoShapeStyleElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/lists/SoNodeList.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/misc/SoTempPath.h>
+#include <Inventor/nodes/SoArray.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoImage.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoIndexedLineSet.h>
+#include <Inventor/nodes/SoInstancedCopy.h>
+#include <Inventor/nodes/SoMarkerSet.h>
+#include <Inventor/nodes/SoIndexedMarkerSet.h>
+#include <Inventor/nodes/SoMaterialBinding.h>
+#include <Inventor/nodes/SoMatrixTransform.h>
+#include <Inventor/nodes/SoMultipleCopy.h>
+#include <Inventor/nodes/SoPointSet.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/nodes/SoTransformSeparator.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+
+#include "misc/SbHash.h"
+#include "SbBasicP.h"
+#include "actions/SoSubActionP.h"
+
+// *************************************************************************
+
+class SoBatchMergeActionP {
+public:
+  SoBatchMergeActionP(void)
+    : master(NULL),
+      minbatchsize(2),
+      nummerged(0),
+      cbaction(SbViewportRegion(640, 480))
+  {
+    this->cbaction.addPreCallback(SoShape::getClassTypeId(), pre_shape_cb, this);
+    this->cbaction.addPostCallback(SoShape::getClassTypeId(), post_shape_cb, this);
+    this->cbaction.addTriangleCallback(SoShape::getClassTypeId(), triangle_cb, this);
+    this->cbaction.addLineSegmentCallback(SoShape::getClassTypeId(), line_segment_cb, this);
+    this->cbaction.addPointCallback(SoShape::getClassTypeId(), point_cb, this);
+  }
+  ~SoBatchMergeActionP() {
+    this->clearResult();
+    this->clearTraversalData();
+  }
+
+  enum PrimitiveType {
+    NO_PRIMITIVES,
+    TRIANGLES,
+    LINES,
+    POINTS
+  };
+
+  // The traversal state a shape must share with the other shapes in
+  // its batch. Everything not stored here is taken from the place in
+  // the scene graph where the merged shape is inserted.
+  struct StateKey {
+    int primtype;
+    SbColor ambient, diffuse, specular, emission;
+    float shininess, transparency;
+    int lightmodel;
+    int drawstyle;
+    float linewidth, pointsize;
+    unsigned short linepattern;
+    int vertexordering, shapetype, facetype;
+    int pickstyle;
+    int transparencytype;
+    float offsetfactor, offsetunits;
+    int offsetstyles;
+    SbBool offseton;
+    SbBool textured;
+    const unsigned char * teximage;
+    SbVec2s texsize;
+    int texnc;
+    int texmodel, texwraps, texwrapt;
+    SbColor texblendcolor;
+    SbMatrix texmatrix;
+    int numlights;
+    uint32_t lights;
+
+    unsigned int hash(void) const;
+    SbBool operator==(const StateKey & k) const;
+  };
+
+  // A (parent, shape) combination in the scene graph. Shapes are
+  // removed from their parents one pair at a time, so a pair is only
+  // merged if all traversals through it could be merged into the
+  // same batch.
+  struct Pair {
+    SoGroup * parent;
+    SoShape * shape;
+    int key;
+    int numoccurrences;
+    SbBool ok;
+    int nextsameshape;
+  };
+
+  struct Batch {
+    Batch(const int type, const SbBool usetexture)
+      : primtype(type), textured(usetexture),
+        numoccurrences(0), placement(-1), merge(FALSE),
+        vertexhash(NULL), numprimitives(0), shape(NULL) { }
+    ~Batch() {
+      delete this->vertexhash;
+      for (int i = 0; i < this->memberpaths.getLength(); i++) {
+        this->memberpaths[i]->unref();
+      }
+      if (this->shape) this->shape->unref();
+    }
+    int primtype;
+    SbBool textured;
+    int numoccurrences;
+    int placement;
+    SbBool merge;
+
+    // geometry, in the space of the node the action is applied to
+    SbList<SbVec3f> coords;
+    SbList<SbVec3f> normals;
+    SbList<SbVec2f> texcoords;
+    SbList<int32_t> indices;
+    SbHash<unsigned int, int32_t> * vertexhash;
+    SbMatrix placementmatrix;
+
+    // first primitive and original path of each merged shape
+    SbList<int> memberstart;
+    SbList<SoTempPath *> memberpaths;
+    SoNodeList membershapes; // keeps removed shapes alive for the paths
+    int numprimitives;
+    SoShape * shape;
+  };
+
+  SoBatchMergeAction * master;
+  int minbatchsize;
+  int nummerged;
+  SoCallbackAction cbaction;
+
+  // traversal data
+  int pass;
+  SbList<StateKey> keys;
+  SbList<int> keynext;
+  SbHash<unsigned int, int> keyhash;
+  SbList<Pair> pairs;
+  SbHash<const SoBase *, int> shapepairs;
+  SbList<Batch *> batches;
+
+  // state for the shape currently being traversed
+  int curpair;
+  SbBool curok;
+  int curkey;
+  int curprimtype;
+  Batch * curbatch;
+  SbBool curinit;
+  SbMatrix curmatrix;
+  SbMatrix curnormalmatrix;
+  SbBool curflip;
+
+  // the result
+  SbList<Batch *> result;
+  SbHash<const SoBase *, int> shapetoresult;
+
+  static SoCallbackAction::Response pre_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node);
+  static SoCallbackAction::Response post_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node);
+  static void triangle_cb(void * userdata, SoCallbackAction * action,
+                          const SoPrimitiveVertex * v1,
+                          const SoPrimitiveVertex * v2,
+                          const SoPrimitiveVertex * v3);
+  static void line_segment_cb(void * userdata, SoCallbackAction * action,
+                              const SoPrimitiveVertex * v1,
+                              const SoPrimitiveVertex * v2);
+  static void point_cb(void * userdata, SoCallbackAction * action,
+                       const SoPrimitiveVertex * v);
+
+  void merge(SoNode * root, SoPath * path);
+  void addPrimitive(SoCallbackAction * action, const int type,
+                    const SoPrimitiveVertex ** v, const int num);
+  SbBool isMergeablePath(const SoFullPath * path) const;
+  int findPair(SoNode * parent, SoNode * shape);
+  int findKey(SoCallbackAction * action, const int primtype);
+  int32_t addVertex(Batch * batch, const SoPrimitiveVertex * v);
+  SoShape * createShape(Batch * batch) const;
+  void updateSceneGraph(void);
+  void clearTraversalData(void);
+  void clearResult(void);
+};
+
+#define PRIVATE(obj) obj->pimpl
+
+// *************************************************************************
+
+static inline uint32_t
+sobatchmerge_hash(uint32_t h, const void * data, const size_t size)
+{
+  // FNV-1a
+  const unsigned char * ptr = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++) {
+    h ^= ptr[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+unsigned int
+SoBatchMergeActionP::StateKey::hash(void) const
+{
+  uint32_t h = 2166136261u;
+  h = sobatchmerge_hash(h, &this->primtype, sizeof(int));
+  h = sobatchmerge_hash(h, this->diffuse.getValue(), 3 * sizeof(float));
+  h = sobatchmerge_hash(h, &this->transparency, sizeof(float));
+  h = sobatchmerge_hash(h, &this->teximage, sizeof(const unsigned char *));
+  h = sobatchmerge_hash(h, &this->lights, sizeof(uint32_t));
+  return h;
+}
+
+SbBool
+SoBatchMergeActionP::StateKey::operator==(const StateKey & k) const
+{
+  if (this->primtype != k.primtype ||
+      this->ambient != k.ambient ||
+      this->diffuse != k.diffuse ||
+      this->specular != k.specular ||
+      this->emission != k.emission ||
+      this->shininess != k.shininess ||
+      this->transparency != k.transparency ||
+      this->lightmodel != k.lightmodel ||
+      this->drawstyle != k.drawstyle ||
+      this->linewidth != k.linewidth ||
+      this->pointsize != k.pointsize ||
+      this->linepattern != k.linepattern ||
+      this->vertexordering != k.vertexordering ||
+      this->shapetype != k.shapetype ||
+      this->facetype != k.facetype ||
+      this->pickstyle != k.pickstyle ||
+      this->transparencytype != k.transparencytype ||
+      this->offsetfactor != k.offsetfactor ||
+      this->offsetunits != k.offsetunits ||
+      this->offsetstyles != k.offsetstyles ||
+      this->offseton != k.offseton ||
+      this->numlights != k.numlights ||
+      this->lights != k.lights ||
+      this->textured != k.textured) return FALSE;
+
+  if (this->textured) {
+    if (this->teximage != k.teximage ||
+        this->texsize != k.texsize ||
+        this->texnc != k.texnc ||
+        this->texmodel != k.texmodel ||
+        this->texwraps != k.texwraps ||
+        this->texwrapt != k.texwrapt ||
+        this->texblendcolor != k.texblendcolor ||
+        this->texmatrix != k.texmatrix) return FALSE;
+  }
+  return TRUE;
+}
+
+// *************************************************************************
+
+SO_ACTION_SOURCE(SoBatchMergeAction);
+
+// Override from parent class.
+void
+SoBatchMergeAction::initClass(void)
+{
+  SO_ACTION_INTERNAL_INIT_CLASS(SoBatchMergeAction, SoReorganizeAction);
+}
+
+/*!
+  Constructor.
+*/
+SoBatchMergeAction::SoBatchMergeAction(void)
+{
+  PRIVATE(this)->master = this;
+  SO_ACTION_CONSTRUCTOR(SoBatchMergeAction);
+}
+
+/*!
+  The destructor.
+*/
+SoBatchMergeAction::~SoBatchMergeAction(void)
+{
+}
+
+/*!
+  Sets the minimum number of shapes needed to create a batch. Sets of
+  shapes with the same appearance which are smaller than this will be
+  left untouched. The default value is 2.
+*/
+void
+SoBatchMergeAction::setMinBatchSize(const int numshapes)
+{
+  PRIVATE(this)->minbatchsize = SbMax(numshapes, 1);
+}
+
+/*!
+  Returns the minimum number of shapes needed to create a batch.
+*/
+int
+SoBatchMergeAction::getMinBatchSize(void) const
+{
+  return PRIVATE(this)->minbatchsize;
+}
+
+/*!
+  Merges the shapes in the scene graph below \a root.
+*/
+void
+SoBatchMergeAction::apply(SoNode * root)
+{
+  PRIVATE(this)->clearResult();
+  PRIVATE(this)->merge(root, NULL);
+}
+
+/*!
+  Merges the shapes in the scene graph below the tail of \a path. The
+  merged geometry will be in the coordinate system of the head of the
+  path.
+*/
+void
+SoBatchMergeAction::apply(SoPath * path)
+{
+  PRIVATE(this)->clearResult();
+  PRIVATE(this)->merge(NULL, path);
+}
+
+/*!
+  Merges the shapes below each path in \a pathlist. Shapes are only
+  merged with shapes from the same path.
+*/
+void
+SoBatchMergeAction::apply(const SoPathList & pathlist, SbBool COIN_UNUSED_ARG(obeysrules))
+{
+  PRIVATE(this)->clearResult();
+  for (int i = 0; i < pathlist.getLength(); i++) {
+    PRIVATE(this)->merge(NULL, pathlist[i]);
+  }
+}
+
+// Documented in superclass.
+void
+SoBatchMergeAction::beginTraversal(SoNode * /* node */)
+{
+  assert(0 && "should never get here");
+}
+
+/*!
+  Returns the number of merged shapes created by the last apply().
+*/
+int
+SoBatchMergeAction::getNumBatches(void) const
+{
+  return PRIVATE(this)->result.getLength();
+}
+
+/*!
+  Returns merged shape number \a batch.
+*/
+SoShape *
+SoBatchMergeAction::getBatchShape(const int batch) const
+{
+  assert(batch >= 0 && batch < PRIVATE(this)->result.getLength());
+  return PRIVATE(this)->result[batch]->shape;
+}
+
+/*!
+  Returns the number of shape traversals which were merged into the
+  merged shapes by the last apply().
+*/
+int
+SoBatchMergeAction::getNumMergedShapes(void) const
+{
+  return PRIVATE(this)->nummerged;
+}
+
+/*!
+  Returns the path to the original shape for primitive number \a
+  primitiveindex of \a batchshape, or \c NULL if \a batchshape is not
+  a shape created by the last apply().
+
+  The primitive index is the face index for merged triangles, the
+  line index for merged line segments and the coordinate index for
+  merged points.
+
+  Note that the returned path describes the scene graph as it was
+  before the shapes were merged.
+*/
+const SoPath *
+SoBatchMergeAction::getOriginalPath(const SoShape * batchshape,
+                                    const int primitiveindex) const
+{
+  int idx;
+  if (!PRIVATE(this)->shapetoresult.get(batchshape, idx)) return NULL;
+  const SoBatchMergeActionP::Batch * batch = PRIVATE(this)->result[idx];
+  if (primitiveindex < 0 || primitiveindex >= batch->numprimitives) return NULL;
+
+  // binary search for the last member starting at or before primitiveindex
+  const int * start = batch->memberstart.getArrayPtr();
+  int lo = 0, hi = batch->memberstart.getLength() - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi + 1) / 2;
+    if (start[mid] <= primitiveindex) lo = mid;
+    else hi = mid - 1;
+  }
+  return batch->memberpaths[lo];
+}
+
+/*!
+  Returns the path to the original shape that was hit at \a pp, or \c
+  NULL if the picked point is not on a shape created by the last
+  apply().
+*/
+const SoPath *
+SoBatchMergeAction::getOriginalPath(const SoPickedPoint * pp) const
+{
+  SoNode * tail = reclassify_cast<const SoFullPath *>(pp->getPath())->getTail();
+  if (!tail->isOfType(SoShape::getClassTypeId())) return NULL;
+
+  const SoDetail * detail = pp->getDetail(tail);
+  if (detail == NULL) return NULL;
+
+  int primitiveindex = -1;
+  if (detail->isOfType(SoFaceDetail::getClassTypeId())) {
+    primitiveindex = coin_assert_cast<const SoFaceDetail *>(detail)->getFaceIndex();
+  }
+  else if (detail->isOfType(SoLineDetail::getClassTypeId())) {
+    primitiveindex = coin_assert_cast<const SoLineDetail *>(detail)->getLineIndex();
+  }
+  else if (detail->isOfType(SoPointDetail::getClassTypeId())) {
+    primitiveindex = coin_assert_cast<const SoPointDetail *>(detail)->getCoordinateIndex();
+  }
+  return this->getOriginalPath(coin_assert_cast<const SoShape *>(tail), primitiveindex);
+}
+
+// *************************************************************************
+
+// Does the actual work. The scene graph is traversed twice. The
+// first traversal decides which shapes can be merged, and which
+// batches they belong to. The second traversal collects the geometry
+// of the shapes that will be merged.
+void
+SoBatchMergeActionP::merge(SoNode * root, SoPath * path)
+{
+  this->clearTraversalData();
+
+  this->pass = 1;
+  if (root) this->cbaction.apply(root);
+  else this->cbaction.apply(path);
+
+  int i, n = 0;
+  for (i = 0; i < this->pairs.getLength(); i++) {
+    const Pair & p = this->pairs[i];
+    if (!p.ok) continue;
+    Batch * batch = this->batches[p.key];
+    batch->numoccurrences += p.numoccurrences;
+    // the merged shape must be inserted where it is traversed only once
+    if (batch->placement < 0 && p.numoccurrences == 1) batch->placement = i;
+  }
+  for (i = 0; i < this->batches.getLength(); i++) {
+    Batch * batch = this->batches[i];
+    batch->merge =
+      batch->placement >= 0 &&
+      batch->numoccurrences >= this->minbatchsize;
+    if (batch->merge) {
+      batch->vertexhash = new SbHash<unsigned int, int32_t>(1024);
+      n++;
+    }
+  }
+  if (n == 0) return;
+
+  this->pass = 2;
+  if (root) this->cbaction.apply(root);
+  else this->cbaction.apply(path);
+
+  this->updateSceneGraph();
+  this->clearTraversalData();
+}
+
+SbBool
+SoBatchMergeActionP::isMergeablePath(const SoFullPath * path) const
+{
+  const int len = path->getLength();
+  if (len < 2) return FALSE;
+
+  SoNode * tail = path->getTail();
+  if (tail->isOfType(SoText2::getClassTypeId()) ||
+      tail->isOfType(SoImage::getClassTypeId()) ||
+      tail->isOfType(SoMarkerSet::getClassTypeId()) ||
+      tail->isOfType(SoIndexedMarkerSet::getClassTypeId())) {
+    return FALSE;
+  }
+
+  // only allow groups that traverse all their children in the same
+  // way every time
+  for (int i = 0; i < len - 1; i++) {
+    const SoType t = path->getNode(i)->getTypeId();
+    if (t != SoGroup::getClassTypeId() &&
+        t != SoSeparator::getClassTypeId() &&
+        t != SoTransformSeparator::getClassTypeId() &&
+        t != SoArray::getClassTypeId() &&
+        t != SoMultipleCopy::getClassTypeId() &&
+        t != SoInstancedCopy::getClassTypeId()) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+int
+SoBatchMergeActionP::findPair(SoNode * parent, SoNode * shape)
+{
+  int idx = -1;
+  if (this->shapepairs.get(shape, idx)) {
+    while (idx >= 0) {
+      if (this->pairs[idx].parent == parent) return idx;
+      idx = this->pairs[idx].nextsameshape;
+    }
+    this->shapepairs.get(shape, idx);
+  }
+  Pair p;
+  p.parent = parent && parent->isOfType(SoGroup::getClassTypeId()) ?
+    coin_assert_cast<SoGroup *>(parent) : NULL;
+  p.shape = coin_assert_cast<SoShape *>(shape);
+  p.key = -1;
+  p.numoccurrences = 0;
+  p.ok = p.parent != NULL;
+  p.nextsameshape = idx;
+  this->pairs.append(p);
+  this->shapepairs.put(shape, this->pairs.getLength() - 1);
+  return this->pairs.getLength() - 1;
+}
+
+// Returns the index of the batch for the current state, or -1 if a
+// shape can't be merged with this state.
+int
+SoBatchMergeActionP::findKey(SoCallbackAction * action, const int primtype)
+{
+  SoState * state = action->getState();
+
+  if (SoClipPlaneElement::getInstance(state)->getNum() > 0) return -1;
+
+  const unsigned int shapeflags = SoShapeStyleElement::get(state)->getFlags();
+  if (shapeflags & (SoShapeStyleElement::BUMPMAP|
+                    SoShapeStyleElement::BBOXCMPLX|
+                    SoShapeStyleElement::INVISIBLE|
+                    SoShapeStyleElement::BIGIMAGE)) {
+    return -1;
+  }
+
+  // the merged shape has a single overall material
+  const SoLazyElement * lelem = SoLazyElement::getInstance(state);
+  if (action->getMaterialBinding() != SoMaterialBinding::OVERALL &&
+      (lelem->getNumDiffuse() > 1 || lelem->getNumTransparencies() > 1)) {
+    return -1;
+  }
+
+  // the geometry is transformed, so the matrix must be invertible
+  const SbMatrix & m = action->getModelMatrix();
+  if (SbAbs(m.det3()) < 1.0e-12f) return -1;
+
+  StateKey k;
+  k.primtype = primtype;
+  action->getMaterial(k.ambient, k.diffuse, k.specular, k.emission,
+                      k.shininess, k.transparency);
+  k.lightmodel = action->getLightModel();
+  k.drawstyle = action->getDrawStyle();
+  k.linewidth = action->getLineWidth();
+  k.pointsize = action->getPointSize();
+  k.linepattern = action->getLinePattern();
+  k.vertexordering = action->getVertexOrdering();
+  k.shapetype = action->getShapeType();
+  k.facetype = action->getFaceType();
+  k.pickstyle = action->getPickStyle();
+  k.transparencytype = SoShapeStyleElement::getTransparencyType(state);
+
+  SoPolygonOffsetElement::Style offsetstyles;
+  SoPolygonOffsetElement::get(state, k.offsetfactor, k.offsetunits,
+                              offsetstyles, k.offseton);
+  k.offsetstyles = static_cast<int>(offsetstyles);
+
+  // lines and points are merged without normals, which is only
+  // correct if they were rendered without lighting
+  if (primtype != TRIANGLES &&
+      k.lightmodel != SoLightModel::BASE_COLOR &&
+      SoNormalElement::getInstance(state)->getNum() > 0) {
+    return -1;
+  }
+
+  int lastenabled = -1;
+  (void) SoMultiTextureEnabledElement::getEnabledUnits(state, lastenabled);
+  if (lastenabled > 0) return -1;
+
+  k.textured = SoMultiTextureEnabledElement::get(state, 0);
+  k.teximage = NULL;
+  k.texnc = 0;
+  k.texmodel = k.texwraps = k.texwrapt = 0;
+  if (k.textured) {
+    if (SoMultiTextureEnabledElement::getMode(state, 0) !=
+        SoMultiTextureEnabledElement::TEXTURE2D) return -1;
+    // generated texture coordinates depend on the untransformed geometry
+    if (SoMultiTextureCoordinateElement::getType(state, 0) ==
+        SoMultiTextureCoordinateElement::TEXGEN) return -1;
+    k.teximage = action->getTextureImage(k.texsize, k.texnc);
+    k.texmodel = action->getTextureModel();
+    k.texwraps = action->getTextureWrapS();
+    k.texwrapt = action->getTextureWrapT();
+    k.texblendcolor = action->getTextureBlendColor();
+    k.texmatrix = action->getTextureMatrix();
+  }
+
+  const SoNodeList & lights = SoLightElement::getLights(state);
+  k.numlights = lights.getLength();
+  k.lights = 2166136261u;
+  for (int i = 0; i < k.numlights; i++) {
+    const SoNode * light = lights[i];
+    k.lights = sobatchmerge_hash(k.lights, &light, sizeof(const SoNode *));
+  }
+
+  const unsigned int h = k.hash();
+  int idx;
+  int first = -1;
+  if (this->keyhash.get(h, first)) {
+    for (idx = first; idx >= 0; idx = this->keynext[idx]) {
+      if (this->keys[idx] == k) return idx;
+    }
+  }
+  this->keys.append(k);
+  this->keynext.append(first);
+  this->batches.append(new Batch(k.primtype, k.textured));
+  idx = this->keys.getLength() - 1;
+  this->keyhash.put(h, idx);
+  return idx;
+}
+
+int32_t
+SoBatchMergeActionP::addVertex(Batch * batch, const SoPrimitiveVertex * v)
+{
+  const int primtype = batch->primtype;
+  SbVec3f p, n;
+  SbVec2f t(0.0f, 0.0f);
+  this->curmatrix.multVecMatrix(v->getPoint(), p);
+  if (primtype == TRIANGLES) {
+    this->curnormalmatrix.multDirMatrix(v->getNormal(), n);
+    (void) n.normalize();
+  }
+  if (batch->textured) {
+    SbVec4f tmp = v->getTextureCoords();
+    if (tmp[3] != 0.0f) {
+      tmp[0] /= tmp[3];
+      tmp[1] /= tmp[3];
+    }
+    t.setValue(tmp[0], tmp[1]);
+  }
+
+  int32_t idx;
+  uint32_t h = 2166136261u;
+  if (primtype != POINTS) {
+    h = sobatchmerge_hash(h, p.getValue(), 3 * sizeof(float));
+    h = sobatchmerge_hash(h, n.getValue(), 3 * sizeof(float));
+    h = sobatchmerge_hash(h, t.getValue(), 2 * sizeof(float));
+    if (batch->vertexhash->get(h, idx) &&
+        batch->coords[idx] == p &&
+        (primtype != TRIANGLES || batch->normals[idx] == n) &&
+        (!batch->textured || batch->texcoords[idx] == t)) {
+      return idx;
+    }
+  }
+
+  idx = batch->coords.getLength();
+  batch->coords.append(p);
+  if (primtype == TRIANGLES) batch->normals.append(n);
+  if (batch->textured) batch->texcoords.append(t);
+  if (primtype != POINTS) batch->vertexhash->put(h, idx);
+  return idx;
+}
+
+void
+SoBatchMergeActionP::addPrimitive(SoCallbackAction * action, const int type,
+                                  const SoPrimitiveVertex ** v, const int num)
+{
+  int i;
+  if (this->pass == 1) {
+    if (!this->curok) return;
+    if (!this->curinit) {
+      this->curinit = TRUE;
+      this->curprimtype = type;
+      this->curkey = this->findKey(action, type);
+      if (this->curkey < 0) { this->curok = FALSE; return; }
+    }
+    if (type != this->curprimtype) { this->curok = FALSE; return; }
+    for (i = 0; i < num; i++) {
+      if (v[i]->getMaterialIndex() != 0) { this->curok = FALSE; return; }
+    }
+    return;
+  }
+
+  Batch * batch = this->curbatch;
+  if (batch == NULL) return;
+
+  int32_t idx[3];
+  for (i = 0; i < num; i++) {
+    idx[i] = this->addVertex(batch, v[i]);
+  }
+  if (type == TRIANGLES) {
+    batch->indices.append(idx[0]);
+    // keep the vertex ordering when the matrix mirrors the geometry
+    batch->indices.append(this->curflip ? idx[2] : idx[1]);
+    batch->indices.append(this->curflip ? idx[1] : idx[2]);
+    batch->indices.append(-1);
+  }
+  else if (type == LINES) {
+    batch->indices.append(idx[0]);
+    batch->indices.append(idx[1]);
+    batch->indices.append(-1);
+  }
+  batch->numprimitives++;
+}
+
+SoCallbackAction::Response
+SoBatchMergeActionP::pre_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node)
+{
+  SoBatchMergeActionP * thisp = static_cast<SoBatchMergeActionP *>(userdata);
+  const SoFullPath * path = reclassify_cast<const SoFullPath *>(action->getCurPath());
+  SoNode * parent = path->getLength() > 1 ? path->getNodeFromTail(1) : NULL;
+
+  thisp->curpair = thisp->findPair(parent, const_cast<SoNode *>(node));
+  thisp->curinit = FALSE;
+  thisp->curkey = -1;
+  thisp->curprimtype = NO_PRIMITIVES;
+  thisp->curbatch = NULL;
+
+  Pair & pair = thisp->pairs[thisp->curpair];
+  if (thisp->pass == 1) {
+    pair.numoccurrences++;
+    thisp->curok = pair.ok && thisp->isMergeablePath(path);
+    return thisp->curok ? SoCallbackAction::CONTINUE : SoCallbackAction::PRUNE;
+  }
+
+  if (!pair.ok || !thisp->batches[pair.key]->merge) return SoCallbackAction::PRUNE;
+
+  Batch * batch = thisp->batches[pair.key];
+  thisp->curbatch = batch;
+  thisp->curmatrix = action->getModelMatrix();
+  thisp->curnormalmatrix = thisp->curmatrix.inverse().transpose();
+  thisp->curflip = thisp->curmatrix.det3() < 0.0f;
+  if (thisp->curpair == batch->placement) {
+    batch->placementmatrix = thisp->curmatrix;
+  }
+
+  // store a copy of the path, since the scene graph will change
+  const int len = path->getLength();
+  SoTempPath * copy = new SoTempPath(len);
+  copy->ref();
+  copy->setHead(path->getHead());
+  for (int i = 1; i < len; i++) {
+    copy->simpleAppend(path->getNode(i), path->getIndex(i));
+  }
+  batch->memberstart.append(batch->numprimitives);
+  batch->memberpaths.append(copy);
+  batch->membershapes.append(const_cast<SoNode *>(node));
+  thisp->nummerged++;
+  return SoCallbackAction::CONTINUE;
+}
+
+SoCallbackAction::Response
+SoBatchMergeActionP::post_shape_cb(void * userdata, SoCallbackAction * COIN_UNUSED_ARG(action), const SoNode * COIN_UNUSED_ARG(node))
+{
+  SoBatchMergeActionP * thisp = static_cast<SoBatchMergeActionP *>(userdata);
+  if (thisp->pass == 1) {
+    Pair & pair = thisp->pairs[thisp->curpair];
+    if (!thisp->curok || !thisp->curinit) pair.ok = FALSE;
+    else if (pair.key < 0) pair.key = thisp->curkey;
+    else if (pair.key != thisp->curkey) pair.ok = FALSE;
+  }
+  thisp->curbatch = NULL;
+  return SoCallbackAction::CONTINUE;
+}
+
+void
+SoBatchMergeActionP::triangle_cb(void * userdata, SoCallbackAction * action,
+                                 const SoPrimitiveVertex * v1,
+                                 const SoPrimitiveVertex * v2,
+                                 const SoPrimitiveVertex * v3)
+{
+  const SoPrimitiveVertex * v[3] = { v1, v2, v3 };
+  static_cast<SoBatchMergeActionP *>(userdata)->addPrimitive(action, TRIANGLES, v, 3);
+}
+
+void
+SoBatchMergeActionP::line_segment_cb(void * userdata, SoCallbackAction * action,
+                                     const SoPrimitiveVertex * v1,
+                                     const SoPrimitiveVertex * v2)
+{
+  const SoPrimitiveVertex * v[2] = { v1, v2 };
+  static_cast<SoBatchMergeActionP *>(userdata)->addPrimitive(action, LINES, v, 2);
+}
+
+void
+SoBatchMergeActionP::point_cb(void * userdata, SoCallbackAction * action,
+                              const SoPrimitiveVertex * v)
+{
+  static_cast<SoBatchMergeActionP *>(userdata)->addPrimitive(action, POINTS, &v, 1);
+}
+
+SoShape *
+SoBatchMergeActionP::createShape(Batch * batch) const
+{
+  SoVertexProperty * vp = new SoVertexProperty;
+  vp->vertex.setValues(0, batch->coords.getLength(), batch->coords.getArrayPtr());
+  if (batch->primtype == TRIANGLES) {
+    vp->normal.setValues(0, batch->normals.getLength(), batch->normals.getArrayPtr());
+    vp->normalBinding = SoVertexProperty::PER_VERTEX_INDEXED;
+  }
+  else {
+    vp->normalBinding = SoVertexProperty::OVERALL;
+  }
+  if (batch->textured) {
+    vp->texCoord.setValues(0, batch->texcoords.getLength(), batch->texcoords.getArrayPtr());
+  }
+  vp->materialBinding = SoVertexProperty::OVERALL;
+
+  SoShape * shape;
+  if (batch->primtype == TRIANGLES) {
+    SoIndexedFaceSet * ifs = new SoIndexedFaceSet;
+    ifs->vertexProperty = vp;
+    ifs->coordIndex.setValues(0, batch->indices.getLength(), batch->indices.getArrayPtr());
+    ifs->normalIndex.setNum(0);
+    ifs->materialIndex.setNum(0);
+    ifs->textureCoordIndex.setNum(0);
+    shape = ifs;
+  }
+  else if (batch->primtype == LINES) {
+    SoIndexedLineSet * ils = new SoIndexedLineSet;
+    ils->vertexProperty = vp;
+    ils->coordIndex.setValues(0, batch->indices.getLength(), batch->indices.getArrayPtr());
+    ils->normalIndex.setNum(0);
+    ils->materialIndex.setNum(0);
+    ils->textureCoordIndex.setNum(0);
+    shape = ils;
+  }
+  else {
+    SoPointSet * ps = new SoPointSet;
+    ps->vertexProperty = vp;
+    ps->numPoints = batch->coords.getLength();
+    shape = ps;
+  }
+  return shape;
+}
+
+// Replaces the first shape in each merged batch with the merged
+// shape, and removes the other shapes.
+void
+SoBatchMergeActionP::updateSceneGraph(void)
+{
+  int i;
+  for (i = 0; i < this->batches.getLength(); i++) {
+    Batch * batch = this->batches[i];
+    if (!batch->merge) continue;
+
+    batch->shape = this->createShape(batch);
+    batch->shape->ref();
+
+    // the state at the placement is equal to the state of the shapes
+    // in the batch, except for the transformation and bindings
+    SoSeparator * sep = new SoSeparator;
+    SoMatrixTransform * mt = new SoMatrixTransform;
+    mt->matrix = batch->placementmatrix.inverse();
+    sep->addChild(mt);
+    SoMaterialBinding * mb = new SoMaterialBinding;
+    mb->value = SoMaterialBinding::OVERALL;
+    sep->addChild(mb);
+    sep->addChild(batch->shape);
+
+    const Pair & p = this->pairs[batch->placement];
+    p.parent->replaceChild(p.parent->findChild(p.shape), sep);
+
+    this->shapetoresult.put(batch->shape, this->result.getLength());
+    this->result.append(batch);
+    this->batches[i] = NULL;
+  }
+
+  for (i = 0; i < this->pairs.getLength(); i++) {
+    const Pair & p = this->pairs[i];
+    // batches that were merged have been moved to the result list
+    if (!p.ok || this->batches[p.key] != NULL) continue;
+    int idx;
+    while ((idx = p.parent->findChild(p.shape)) >= 0) {
+      p.parent->removeChild(idx);
+    }
+  }
+}
+
+void
+SoBatchMergeActionP::clearTraversalData(void)
+{
+  for (int i = 0; i < this->batches.getLength(); i++) {
+    delete this->batches[i];
+  }
+  this->batches.truncate(0);
+  this->keys.truncate(0);
+  this->keynext.truncate(0);
+  this->keyhash.clear();
+  this->pairs.truncate(0);
+  this->shapepairs.clear();
+}
+
+void
+SoBatchMergeActionP::clearResult(void)
+{
+  for (int i = 0; i < this->result.getLength(); i++) {
+    delete this->result[i];
+  }
+  this->result.truncate(0);
+  this->shapetoresult.clear();
+  this->nummerged = 0;
+}
+
+#undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/actions/SoBatchMergeAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+static SoSeparator *
+sobatchmerge_make_cube(const SbVec3f & pos, const SbColor & color)
+{
+  SoSeparator * sep = new SoSeparator;
+  SoMaterial * mat = new SoMaterial;
+  mat->diffuseColor = color;
+  SoTranslation * t = new SoTranslation;
+  t->translation = pos;
+  sep->addChild(mat);
+  sep->addChild(t);
+  sep->addChild(new SoCube);
+  return sep;
+}
+
+BOOST_AUTO_TEST_CASE(mergeByMaterial)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoSeparator * red1 = sobatchmerge_make_cube(SbVec3f(-5.0f, 0.0f, 0.0f), SbColor(1.0f, 0.0f, 0.0f));
+  SoSeparator * red2 = sobatchmerge_make_cube(SbVec3f(5.0f, 0.0f, 0.0f), SbColor(1.0f, 0.0f, 0.0f));
+  SoSeparator * blue = sobatchmerge_make_cube(SbVec3f(0.0f, 5.0f, 0.0f), SbColor(0.0f, 0.0f, 1.0f));
+  root->addChild(red1);
+  root->addChild(red2);
+  root->addChild(blue);
+  SoNode * redcube = red2->getChild(2);
+
+  SoBatchMergeAction merger;
+  merger.apply(root);
+
+  BOOST_CHECK_MESSAGE(merger.getNumBatches() == 1, "expected one merged batch");
+  BOOST_CHECK_MESSAGE(merger.getNumMergedShapes() == 2, "expected two merged shapes");
+  BOOST_CHECK_MESSAGE(red2->findChild(redcube) < 0, "merged shape still in the scene graph");
+  BOOST_CHECK_MESSAGE(blue->getNumChildren() == 3, "unmergeable shape was changed");
+
+  SbViewportRegion vp(100, 100);
+  SoGetPrimitiveCountAction pcaction(vp);
+  pcaction.apply(root);
+  BOOST_CHECK_MESSAGE(pcaction.getTriangleCount() == 36, "wrong number of triangles after merge");
+
+  // pick the second red cube, and find its original path
+  SoRayPickAction rp(vp);
+  rp.setRay(SbVec3f(5.0f, 0.0f, 10.0f), SbVec3f(0.0f, 0.0f, -1.0f));
+  rp.apply(root);
+  const SoPickedPoint * pp = rp.getPickedPoint();
+  BOOST_REQUIRE(pp != NULL);
+  BOOST_CHECK_MESSAGE((pp->getPoint() - SbVec3f(5.0f, 0.0f, 1.0f)).length() < 1.0e-4f,
+                      "wrong picked point after merge");
+  const SoPath * orgpath = merger.getOriginalPath(pp);
+  BOOST_REQUIRE(orgpath != NULL);
+  BOOST_CHECK_MESSAGE(static_cast<const SoFullPath *>(orgpath)->getTail() == redcube,
+                      "wrong original path for picked point");
+
+  root->unref();
+}
+
+#endif // COIN_TEST_SUITE
@@ -219,6 +219,8 @@
 #include <Inventor/SbViewportRegion.h>
 
 #include "actions/SoSubActionP.h"
+#include "actions/SoCallbackActionP.h"
+#include "caches/SoShapeListCache.h"
 #include "SbBasicP.h"
 
 #ifndef DOXYGEN_SKIP_THIS
@@ -325,27 +327,6 @@ SoCallbackData::doPointCallbacks(SoCallbackAction * action,
   }
 }
 
-// class to hold private, hidden data
-class SoCallbackActionP {
-public:
-  SbBool viewportset;
-  SbViewportRegion viewport;
-  SoCallbackAction::Response response;
-  SoNode * currentnode;
-
-  SbList <SoCallbackData *> precallback;
-  SbList <SoCallbackData *> postcallback;
-
-  SoCallbackData * pretailcallback;
-  SoCallbackData * posttailcallback;
-
-  SbList <SoCallbackData *> trianglecallback;
-  SbList <SoCallbackData *> linecallback;
-  SbList <SoCallbackData *> pointcallback;
-
-  SbBool callbackall;
-};
-
 #endif // !DOXYGEN_SKIP_THIS
 
 
@@ -440,6 +421,10 @@ SoCallbackAction::commonConstructor(void)
   PRIVATE(this)->posttailcallback = NULL;
   PRIVATE(this)->viewportset = FALSE;
   PRIVATE(this)->callbackall = FALSE;
+  PRIVATE(this)->compiled = FALSE;
+  PRIVATE(this)->hasnodecallbacks = FALSE;
+  PRIVATE(this)->recording = NULL;
+  PRIVATE(this)->nodecounter = 0;
 }
 
 /*!
@@ -519,6 +504,7 @@ SoCallbackAction::addPreCallback(const SoType type, SoCallbackActionCB * cb,
                                  void * userdata)
 {
   set_callback_data(PRIVATE(this)->precallback, type, function_to_object_cast<void *>(cb), userdata);
+  PRIVATE(this)->hasnodecallbacks = TRUE;
 }
 
 /*!
@@ -530,6 +516,7 @@ SoCallbackAction::addPostCallback(const SoType type, SoCallbackActionCB * cb,
                                   void * userdata)
 {
   set_callback_data(PRIVATE(this)->postcallback, type, function_to_object_cast<void *>(cb), userdata);
+  PRIVATE(this)->hasnodecallbacks = TRUE;
 }
 
 /*!
@@ -539,6 +526,7 @@ SoCallbackAction::addPostCallback(const SoType type, SoCallbackActionCB * cb,
 void
 SoCallbackAction::addPreTailCallback(SoCallbackActionCB * cb, void * userdata)
 {
+  PRIVATE(this)->hasnodecallbacks = TRUE;
   if (PRIVATE(this)->pretailcallback == NULL)
     PRIVATE(this)->pretailcallback = new SoCallbackData(function_to_object_cast<void *>(cb), userdata);
   else
@@ -552,6 +540,7 @@ SoCallbackAction::addPreTailCallback(SoCallbackActionCB * cb, void * userdata)
 void
 SoCallbackAction::addPostTailCallback(SoCallbackActionCB * cb, void * userdata)
 {
+  PRIVATE(this)->hasnodecallbacks = TRUE;
   if (PRIVATE(this)->posttailcallback == NULL)
     PRIVATE(this)->posttailcallback = new SoCallbackData(function_to_object_cast<void *>(cb), userdata);
   else
@@ -1193,6 +1182,10 @@ SoCallbackAction::invokeTriangleCallbacks(const SoShape * const shape,
                                           const SoPrimitiveVertex * const v2,
                                           const SoPrimitiveVertex * const v3)
 {
+  if (PRIVATE(this)->recording) {
+    const SoPrimitiveVertex * v[3] = { v1, v2, v3 };
+    PRIVATE(this)->recording->addPrimitive(this, shape, 3, v);
+  }
   int idx = static_cast<int>(shape->getTypeId().getData());
   if (idx < PRIVATE(this)->trianglecallback.getLength() && PRIVATE(this)->trianglecallback[idx] != NULL)
     PRIVATE(this)->trianglecallback[idx]->doTriangleCallbacks(this, v1, v2, v3);
@@ -1208,6 +1201,10 @@ SoCallbackAction::invokeLineSegmentCallbacks(const SoShape * const shape,
                                              const SoPrimitiveVertex * const v1,
                                              const SoPrimitiveVertex * const v2)
 {
+  if (PRIVATE(this)->recording) {
+    const SoPrimitiveVertex * v[2] = { v1, v2 };
+    PRIVATE(this)->recording->addPrimitive(this, shape, 2, v);
+  }
   int idx = static_cast<int>(shape->getTypeId().getData());
   if (idx < PRIVATE(this)->linecallback.getLength() && PRIVATE(this)->linecallback[idx] != NULL)
     PRIVATE(this)->linecallback[idx]->doLineSegmentCallbacks(this, v1, v2);
@@ -1222,6 +1219,9 @@ void
 SoCallbackAction::invokePointCallbacks(const SoShape * const shape,
                                        const SoPrimitiveVertex * const v)
 {
+  if (PRIVATE(this)->recording) {
+    PRIVATE(this)->recording->addPrimitive(this, shape, 1, &v);
+  }
   int idx = static_cast<int>(shape->getTypeId().getData());
   if (idx < PRIVATE(this)->pointcallback.getLength() && PRIVATE(this)->pointcallback[idx] != NULL)
     PRIVATE(this)->pointcallback[idx]->doPointCallbacks(this, v);
@@ -1237,6 +1237,9 @@ SoCallbackAction::invokePointCallbacks(const SoShape * const shape,
 SbBool
 SoCallbackAction::shouldGeneratePrimitives(const SoShape * shape) const
 {
+  // shapes are compiled with all their primitives, so that the
+  // compiled list can be used whatever callbacks are set later
+  if (PRIVATE(this)->recording) return TRUE;
   int idx = static_cast<int>(shape->getTypeId().getData());
   if (idx < PRIVATE(this)->trianglecallback.getLength() && PRIVATE(this)->trianglecallback[idx])
     return TRUE;
@@ -1265,6 +1268,7 @@ void
 SoCallbackAction::setCurrentNode(SoNode * const node)
 {
   PRIVATE(this)->currentnode = node;
+  PRIVATE(this)->nodecounter++;
 }
 
 // Documented in superclass. Overridden from parent class to
@@ -1273,6 +1277,7 @@ void
 SoCallbackAction::beginTraversal(SoNode * node)
 {
   PRIVATE(this)->response = SoCallbackAction::CONTINUE;
+  PRIVATE(this)->recording = NULL;
   // we set the viewport region element here. This element is not enabled
   // for SoCallbackAction in Inventor, bu we think it should be.
   // It makes it possible to calculate screen space stuff in
@@ -1293,12 +1298,74 @@ SbBool SoCallbackAction::isCallbackAll(void) const
   return PRIVATE(this)->callbackall;
 }
 
+/*!
+  Sets whether SoSeparator nodes should compile their subgraphs. Default
+  is \c FALSE.
+
+  When enabled, every SoSeparator records a flat list of the shapes
+  below it the first time it is traversed, with the model matrix, the
+  material and the primitives of each shape. On later traversals of an
+  unchanged subgraph, the list is replayed directly to the triangle,
+  line segment and point callbacks instead of traversing the nodes and
+  generating the primitives again. A list is rebuilt when something
+  below its separator changes, or when the state it was recorded in is
+  different.
+
+  This is meant for applications which apply the action to the same
+  scene graph many times, for instance to extract geometry for
+  collision detection or export, and only use the primitive
+  callbacks. Note the following when replaying:
+
+  <ul>
+  <li> The model matrix, the material and the current path are
+       restored for each shape. Other state, like the coordinates or
+       the complexity, is what it was at the separator.</li>
+  <li> Material indices in the primitive vertices are renumbered, and
+       refer to the restored material.</li>
+  <li> Compiling is not done if any pre or post callbacks are set,
+       since these need the nodes to be traversed.</li>
+  <li> Each compiled list keeps a copy of the primitives, so this uses
+       memory in proportion to the size of the geometry, times the
+       number of nested separators.</li>
+  </ul>
+
+  This method is an extension versus the Open Inventor API.
+
+  \sa isCompiledTraversal()
+
+  \since Coin 4.0
+*/
+void
+SoCallbackAction::setCompiledTraversal(const SbBool onoff)
+{
+  PRIVATE(this)->compiled = onoff;
+}
+
+/*!
+  Returns whether SoSeparator nodes compile their subgraphs.
+
+  \sa setCompiledTraversal()
+
+  \since Coin 4.0
+*/
+SbBool
+SoCallbackAction::isCompiledTraversal(void) const
+{
+  return PRIVATE(this)->compiled;
+}
+
 #undef PRIVATE
 
 #ifdef COIN_TEST_SUITE
 
 #include <Inventor/nodes/SoSwitch.h>
 #include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTranslation.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/SoFullPath.h>
 
 static SoCallbackAction::Response
 preCB(void * userdata, SoCallbackAction *, const SoNode * node)
@@ -1331,4 +1398,108 @@ BOOST_AUTO_TEST_CASE(callbackall)
   sw->unref();
 }
 
+struct TriangleSums {
+  int num;
+  SbVec3f point;
+  SbVec3f color;
+  int numspheres;
+};
+
+static void
+triangleCB(void * userdata, SoCallbackAction * action,
+           const SoPrimitiveVertex * v1,
+           const SoPrimitiveVertex * v2,
+           const SoPrimitiveVertex * v3)
+{
+  TriangleSums * sums = (TriangleSums *) userdata;
+  const SoPrimitiveVertex * v[3] = { v1, v2, v3 };
+  for (int i = 0; i < 3; i++) {
+    SbVec3f p;
+    action->getModelMatrix().multVecMatrix(v[i]->getPoint(), p);
+    sums->point += p;
+    SbColor ambient, diffuse, specular, emission;
+    float shininess, transparency;
+    action->getMaterial(ambient, diffuse, specular, emission,
+                        shininess, transparency, v[i]->getMaterialIndex());
+    sums->color += diffuse;
+  }
+  const SoFullPath * path = (const SoFullPath *) action->getCurPath();
+  if (path->getTail()->isOfType(SoSphere::getClassTypeId())) sums->numspheres++;
+  sums->num++;
+}
+
+static TriangleSums
+collect_triangles(SoNode * root, SbBool compiled)
+{
+  TriangleSums sums = { 0, SbVec3f(0, 0, 0), SbVec3f(0, 0, 0), 0 };
+  SoCallbackAction cba;
+  cba.setCompiledTraversal(compiled);
+  cba.addTriangleCallback(SoShape::getClassTypeId(), triangleCB, &sums);
+  cba.apply(root);
+  return sums;
+}
+
+static SbBool
+same_triangles(const TriangleSums & a, const TriangleSums & b)
+{
+  return a.num == b.num && a.numspheres == b.numspheres &&
+    a.point.equals(b.point, 0.01f) && a.color.equals(b.color, 0.01f);
+}
+
+BOOST_AUTO_TEST_CASE(compiledTraversal)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoMaterial * outermaterial = new SoMaterial;
+  root->addChild(outermaterial);
+  SoTranslation * translation = new SoTranslation;
+  translation->translation.setValue(1.0f, 0.0f, 0.0f);
+  root->addChild(translation);
+  SoSeparator * sep = new SoSeparator;
+  root->addChild(sep);
+  sep->addChild(new SoCube);
+  SoSeparator * inner = new SoSeparator;
+  sep->addChild(inner);
+  SoMaterial * material = new SoMaterial;
+  material->diffuseColor.setValue(0.0f, 0.0f, 1.0f);
+  inner->addChild(material);
+  SoTranslation * innertranslation = new SoTranslation;
+  innertranslation->translation.setValue(0.0f, 2.0f, 0.0f);
+  inner->addChild(innertranslation);
+  inner->addChild(new SoSphere);
+
+  SoCallbackAction cba;
+  cba.setCompiledTraversal(TRUE);
+  BOOST_CHECK_MESSAGE(cba.isCompiledTraversal(), "Compiled traversal not set");
+
+  TriangleSums expected = collect_triangles(root, FALSE);
+  BOOST_CHECK_MESSAGE(expected.num > 12 && expected.numspheres > 0,
+                      "Expected triangles from both shapes");
+
+  // the first traversal records the shape lists, the second one
+  // replays them
+  for (int i = 0; i < 2; i++) {
+    BOOST_CHECK_MESSAGE(same_triangles(collect_triangles(root, TRUE), expected),
+                        "Compiled traversal should give the same triangles");
+  }
+
+  // changes below and above the separators
+  innertranslation->translation.setValue(0.0f, 3.0f, 0.0f);
+  expected = collect_triangles(root, FALSE);
+  BOOST_CHECK_MESSAGE(same_triangles(collect_triangles(root, TRUE), expected),
+                      "Change below the separator not picked up");
+
+  translation->translation.setValue(-1.0f, 0.0f, 0.0f);
+  expected = collect_triangles(root, FALSE);
+  BOOST_CHECK_MESSAGE(same_triangles(collect_triangles(root, TRUE), expected),
+                      "Change of the model matrix above not picked up");
+
+  outermaterial->diffuseColor.setValue(1.0f, 0.0f, 0.0f);
+  expected = collect_triangles(root, FALSE);
+  BOOST_CHECK_MESSAGE(same_triangles(collect_triangles(root, TRUE), expected),
+                      "Change of the material above not picked up");
+
+  root->unref();
+}
+
 #endif // COIN_TEST_SUITE
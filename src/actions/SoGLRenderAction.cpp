@@ -71,11 +71,13 @@
 #include <boost/scoped_array.hpp>
 
 #include <Inventor/C/glue/gl.h>
+#include <Inventor/C/threads/sched.h>
 #include <Inventor/C/tidbits.h>
 #include <Inventor/SbColor.h>
 #include <Inventor/SbPlane.h>
 #include <Inventor/SoFullPath.h>
 #include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoRenderListAction.h>
 #include <Inventor/actions/SoSearchAction.h>
 #include <Inventor/caches/SoBoundingBoxCache.h>
 #include <Inventor/elements/SoCacheElement.h>
@@ -125,6 +127,8 @@
 #include "glue/glp.h"
 #include "glue/simage_wrapper.h"
 #include "rendering/SoGL.h"
+#include "misc/SbRadixSort.h"
+#include "nodes/SoScreenSpaceErrorLODP.h"
 
 #include <Inventor/annex/Profiler/nodes/SoProfilerStats.h>
 #include "profiler/SoProfilerP.h"
@@ -536,6 +540,37 @@
   second pass.
 */
 
+/*!
+  \enum SoGLRenderAction::RenderListMode
+
+  Enumerates the ways the scene graph can be traversed when rendering.
+
+  \sa setRenderListMode()
+  \since Coin 4.0
+*/
+
+/*!
+  \var SoGLRenderAction::RenderListMode SoGLRenderAction::NO_RENDER_LIST
+
+  Traverse and render the complete scene graph. This is the default.
+*/
+
+/*!
+  \var SoGLRenderAction::RenderListMode SoGLRenderAction::IMMEDIATE_RENDER_LIST
+
+  Build a list of the visible shapes with an SoRenderListAction before
+  rendering, and render only the paths to these shapes.
+*/
+
+/*!
+  \var SoGLRenderAction::RenderListMode SoGLRenderAction::PIPELINED_RENDER_LIST
+
+  Build the render list for the next frame on a separate thread while
+  the current frame is rendered. Only available when Coin is built
+  with thread safe traversals, otherwise the same as
+  IMMEDIATE_RENDER_LIST.
+*/
+
 // *************************************************************************
 
 class SoGLRenderActionP {
@@ -561,6 +596,9 @@ public:
   SoPathList transpobjpaths;
   SoPathList sorttranspobjpaths;
   SbList<float> sorttranspobjdistances;
+  SbRadixSort pathsorter;
+  SbList<void *> pathsorttmppaths;
+  SbList<float> pathsorttmpdistances;
   SoGLRenderAction::TransparentDelayedObjectRenderType transpdelayedrendertype;
   SbBool renderingtranspbackfaces;
 
@@ -626,6 +664,27 @@ public:
   boost::scoped_ptr<SoNodeSensor> deleteSensor;
   static void deleteNodeCB(void * userdata, SoSensor * sensor);
 
+  // For rendering from a list of visible shapes
+  SoGLRenderAction::RenderListMode renderlistmode;
+  boost::scoped_ptr<SoRenderListAction> renderlist;
+  boost::scoped_ptr<SoRenderListAction> nextrenderlist;
+  SoNode * nextrenderlistroot;
+  cc_sched * renderlistsched;
+  SoPathList renderlistpaths;
+  SbBool userenderlist;
+  SbBool statesorting;
+  SbList<SoPathList *> renderruns;
+  int statechanges[SoRenderListAction::NUM_STATE_KEYS];
+  void prepareRenderList(SoNode * node);
+  SbBool buildRenderRuns(const SbList<int> & opaque);
+  void clearRenderRuns(void);
+  void waitRenderList(void);
+  void finishRenderList(void);
+  static void buildRenderListCB(void * closure);
+
+  uint32_t framecounter;
+  float smallfeaturesize;
+
 };
 
 // *************************************************************************
@@ -633,6 +692,7 @@ public:
 SO_ACTION_SOURCE(SoGLRenderAction);
 
 static int COIN_GLBBOX = 0;
+static int COIN_RENDER_LIST = 0;
 
 // *************************************************************************
 
@@ -661,6 +721,14 @@ SoGLRenderAction::initClass(void)
   else {
     COIN_GLBBOX = 0;
   }
+
+  env = coin_getenv("COIN_RENDER_LIST");
+  if (env) {
+    COIN_RENDER_LIST = SbClamp(atoi(env), 0, 2);
+  }
+  else {
+    COIN_RENDER_LIST = 0;
+  }
 }
 
 // *************************************************************************
@@ -737,6 +805,17 @@ SoGLRenderAction::SoGLRenderAction(const SbViewportRegion & viewportregion)
   PRIVATE(this)->sortedobjectstrategy = BBOX_CENTER;
   PRIVATE(this)->sortedobjectcb = NULL;
   PRIVATE(this)->sortedobjectclosure = NULL;
+
+  PRIVATE(this)->renderlistmode = static_cast<RenderListMode>(COIN_RENDER_LIST);
+  PRIVATE(this)->nextrenderlistroot = NULL;
+  PRIVATE(this)->renderlistsched = NULL;
+  PRIVATE(this)->userenderlist = FALSE;
+  PRIVATE(this)->statesorting = FALSE;
+  for (int i = 0; i < SoRenderListAction::NUM_STATE_KEYS; i++) {
+    PRIVATE(this)->statechanges[i] = 0;
+  }
+  PRIVATE(this)->framecounter = 0;
+  PRIVATE(this)->smallfeaturesize = 0.0f;
 }
 
 /*!
@@ -744,6 +823,12 @@ SoGLRenderAction::SoGLRenderAction(const SbViewportRegion & viewportregion)
 */
 SoGLRenderAction::~SoGLRenderAction()
 {
+  PRIVATE(this)->finishRenderList();
+  if (PRIVATE(this)->renderlistsched) {
+    cc_sched_destruct(PRIVATE(this)->renderlistsched);
+  }
+  PRIVATE(this)->clearRenderRuns();
+  SoScreenSpaceErrorLODP::removeBudget(this);
 }
 
 /*!
@@ -1482,30 +1567,28 @@ SoGLRenderAction::invalidateState(void)
 void
 SoGLRenderActionP::doPathSort(void)
 {
+  const int n = this->sorttranspobjdistances.getLength();
+  if (n < 2) return;
+
   // need to cast to SbPList to avoid ref/unref problems, since
   // operator[] is overloaded with non-virtual inheritance.
   SbPList * plist = &this->sorttranspobjpaths;
   float * darray = const_cast<float *>(this->sorttranspobjdistances.getArrayPtr());
 
-  int i, j, distance, n = this->sorttranspobjdistances.getLength();
-  void * ptmp;
-  float dtmp;
-
-  // shell sort algorithm (O(nlog(n))
-  for (distance = 1; distance <= n/9; distance = 3*distance + 1) ;
-  for (; distance > 0; distance /= 3) {
-    for (i = distance; i < n; i++) {
-      dtmp = darray[i];
-      ptmp = plist->get(i);
-      j = i;
-      while (j >= distance && darray[j-distance] < dtmp) {
-        darray[j] = darray[j-distance];
-        plist->set(j, plist->get(j-distance));
-        j -= distance;
-      }
-      darray[j] = dtmp;
-      plist->set(j, ptmp);
-    }
+  // radix sort back to front (O(n)). The sort buffers are kept
+  // between frames to avoid reallocations.
+  const int * sorted = this->pathsorter.sort(darray, n, SbRadixSort::DESCENDING);
+
+  int i;
+  this->pathsorttmppaths.truncate(0);
+  this->pathsorttmpdistances.truncate(0);
+  for (i = 0; i < n; i++) {
+    this->pathsorttmppaths.append(plist->get(i));
+    this->pathsorttmpdistances.append(darray[i]);
+  }
+  for (i = 0; i < n; i++) {
+    plist->set(i, this->pathsorttmppaths[sorted[i]]);
+    darray[i] = this->pathsorttmpdistances[sorted[i]];
   }
 }
 
@@ -1690,6 +1773,7 @@ void
 SoGLRenderActionP::render(SoNode * node)
 {
   this->isrendering = TRUE;
+  this->framecounter++;
 
   SoState * state = this->action->getState();
   state->push();
@@ -1721,6 +1805,15 @@ SoGLRenderActionP::render(SoNode * node)
 
   this->precblist.invokeCallbacks(static_cast<void *>(this->action));
 
+  for (int i = 0; i < SoRenderListAction::NUM_STATE_KEYS; i++) {
+    this->statechanges[i] = 0;
+  }
+  if (this->renderlistmode != SoGLRenderAction::NO_RENDER_LIST &&
+      this->transparencytype != SoGLRenderAction::SORTED_LAYERS_BLEND &&
+      this->action->getWhatAppliedTo() == SoAction::NODE) {
+    this->prepareRenderList(node);
+  }
+
   if (this->action->getNumPasses() > 1 && this->internal_multipass) {
     // Check if the current OpenGL context has an accumulation buffer
     // (rendering multiple passes doesn't make much sense otherwise).
@@ -1743,6 +1836,13 @@ SoGLRenderActionP::render(SoNode * node)
   } else {
     this->renderSingle(node);
   }
+  this->userenderlist = FALSE;
+  this->renderlistpaths.truncate(0);
+  this->clearRenderRuns();
+  // sensors, engines, draggers and the application change the scene
+  // graph as soon as the frame is done, so the next list must be
+  // complete by then
+  this->waitRenderList();
 
   if (SoProfiler::isOverlayActive()) {
     if (node == this->cachedprofilingsg) {
@@ -1769,6 +1869,155 @@ SoGLRenderActionP::render(SoNode * node)
   this->isrendering = FALSE;
 }
 
+//
+// find the paths to render for the scene below node, either by
+// building the render list now or by using the list built on the
+// render list thread during the previous frame
+//
+void
+SoGLRenderActionP::prepareRenderList(SoNode * node)
+{
+  SbBool built = FALSE;
+  if (this->nextrenderlistroot) {
+    const SbBool sameroot = (this->nextrenderlistroot == node);
+    this->finishRenderList();
+    if (sameroot) {
+      this->renderlist.swap(this->nextrenderlist);
+      built = TRUE;
+    }
+  }
+  if (!built) {
+    if (!this->renderlist) {
+      this->renderlist.reset(new SoRenderListAction(this->viewport));
+    }
+    this->renderlist->setViewportRegion(this->viewport);
+    this->renderlist->apply(node);
+  }
+
+  SbList<int> opaque;
+  this->renderlist->getOpaqueShapes(opaque, this->statesorting);
+  for (int i = 0; i < SoRenderListAction::NUM_STATE_KEYS; i++) {
+    this->statechanges[i] =
+      this->renderlist->countStateChanges(opaque, static_cast<SoRenderListAction::StateKey>(i));
+  }
+
+  // fall back to rendering the complete scene graph if it has changed
+  // since the list was built
+  this->renderlistpaths.truncate(0);
+  this->clearRenderRuns();
+  if (this->statesorting) {
+    this->userenderlist = this->buildRenderRuns(opaque);
+    if (!this->userenderlist) {
+      this->renderlistpaths.truncate(0);
+      this->clearRenderRuns();
+    }
+  }
+  else {
+    this->userenderlist = this->renderlist->getPaths(this->renderlistpaths) == 0;
+  }
+
+  // the list is built while the frame is rendered, which needs the
+  // locking of the scene graph caches in thread safe builds
+#ifdef COIN_THREADSAFE
+  if (this->renderlistmode == SoGLRenderAction::PIPELINED_RENDER_LIST) {
+    if (this->renderlistsched == NULL) {
+      this->renderlistsched = cc_sched_construct(1);
+    }
+    if (!this->nextrenderlist) {
+      this->nextrenderlist.reset(new SoRenderListAction(this->viewport));
+    }
+    this->nextrenderlist->setViewportRegion(this->viewport);
+    this->nextrenderlistroot = node;
+    node->ref();
+    (void) cc_sched_schedule(this->renderlistsched,
+                             SoGLRenderActionP::buildRenderListCB, this, 0);
+  }
+#endif // COIN_THREADSAFE
+}
+
+//
+// split the state sorted opaque shapes into runs of shapes with
+// equal state, and put the paths to the other entries in
+// renderlistpaths. Returns FALSE if the list is no longer valid.
+//
+SbBool
+SoGLRenderActionP::buildRenderRuns(const SbList<int> & opaque)
+{
+  const SoRenderListAction * list = this->renderlist.get();
+  const int numentries = list->getNumEntries();
+  SbList<SbBool> inrun(numentries);
+  for (int i = 0; i < numentries; i++) { inrun.append(FALSE); }
+
+  SoPathList * run = NULL;
+  for (int i = 0; i < opaque.getLength(); i++) {
+    const int entry = opaque[i];
+    SbBool newrun = (run == NULL);
+    for (int k = 0; !newrun && k < SoRenderListAction::NUM_STATE_KEYS; k++) {
+      const SoRenderListAction::StateKey key = static_cast<SoRenderListAction::StateKey>(k);
+      newrun = list->getStateKey(entry, key) != list->getStateKey(opaque[i-1], key);
+    }
+    if (newrun) {
+      run = new SoPathList;
+      this->renderruns.append(run);
+    }
+    SoPath * path = list->createPath(entry);
+    if (path == NULL) return FALSE;
+    run->append(path);
+    inrun[entry] = TRUE;
+  }
+
+  for (int i = 0; i < numentries; i++) {
+    if (inrun[i]) continue;
+    SoPath * path = list->createPath(i);
+    if (path == NULL) return FALSE;
+    this->renderlistpaths.append(path);
+  }
+  return TRUE;
+}
+
+void
+SoGLRenderActionP::clearRenderRuns(void)
+{
+  for (int i = 0; i < this->renderruns.getLength(); i++) {
+    delete this->renderruns[i];
+  }
+  this->renderruns.truncate(0);
+}
+
+//
+// wait for the render list thread to finish
+//
+void
+SoGLRenderActionP::waitRenderList(void)
+{
+  if (this->renderlistsched) {
+    cc_sched_wait_all(this->renderlistsched);
+  }
+}
+
+//
+// wait for the render list thread, and forget about the list it built
+//
+void
+SoGLRenderActionP::finishRenderList(void)
+{
+  this->waitRenderList();
+  if (this->nextrenderlistroot) {
+    this->nextrenderlistroot->unref();
+    this->nextrenderlistroot = NULL;
+  }
+}
+
+//
+// called on the render list thread
+//
+void
+SoGLRenderActionP::buildRenderListCB(void * closure)
+{
+  SoGLRenderActionP * thisp = static_cast<SoGLRenderActionP *>(closure);
+  thisp->nextrenderlist->apply(thisp->nextrenderlistroot);
+}
+
 //
 // render multiple passes (antialiasing)
 //
@@ -1857,7 +2106,19 @@ SoGLRenderActionP::renderSingle(SoNode * node)
     return;
   }
 
-  this->action->beginTraversal(node);
+  if (this->userenderlist) {
+    // state sorted runs of opaque shapes first, if any
+    for (int i = 0; i < this->renderruns.getLength(); i++) {
+      this->action->apply(*this->renderruns[i], TRUE);
+      if (this->action->hasTerminated()) break;
+    }
+    if (!this->action->hasTerminated()) {
+      this->action->apply(this->renderlistpaths, TRUE);
+    }
+  }
+  else {
+    this->action->beginTraversal(node);
+  }
 
   if ((this->transpobjpaths.getLength() || this->sorttranspobjpaths.getLength()) &&
       !this->action->hasTerminated()) {
@@ -2016,6 +2277,170 @@ SoGLRenderAction::isRenderingTranspBackfaces(void) const
   return PRIVATE(this)->renderingtranspbackfaces;
 }
 
+/*!
+  Sets how the scene graph is traversed when rendering. The default
+  is NO_RENDER_LIST, which can be overridden with the COIN_RENDER_LIST
+  environment variable.
+
+  With IMMEDIATE_RENDER_LIST, an SoRenderListAction is applied to the
+  scene graph before each frame. It does view volume culling,
+  level-of-detail selection and transparency classification without
+  touching OpenGL, and the action then renders only the paths to the
+  visible shapes. Nodes affecting the state of these shapes are still
+  traversed as usual, and transparent shapes are delayed according to
+  the transparency type.
+
+  With PIPELINED_RENDER_LIST, the render list for the next frame is
+  built on a separate thread while the current frame is rendered, and
+  the action waits for it before returning. The list is therefore one
+  frame late: shapes which become visible
+  because the camera or the scene graph changed will appear in the
+  frame after the change. If the scene graph structure has changed so
+  that the list is no longer valid, or the action is applied to a
+  different root node, the complete scene graph is rendered instead.
+  The scene graph may be changed freely between frames, but must not
+  be changed while the frame is rendered, for instance from an
+  SoCallback node. Building the list while rendering requires the
+  scene graph caches to be locked, so unless Coin is built with
+  thread safe traversals (--enable-threadsafe), this mode works like
+  IMMEDIATE_RENDER_LIST.
+
+  The render list is only used when the action is applied to a node,
+  not to paths or path lists, and not with the SORTED_LAYERS_BLEND
+  transparency type. Since separators are traversed in path mode,
+  their render caches are not used when rendering from the list, so
+  this is mostly useful for large scenes where only a small part is
+  visible at a time.
+
+  \sa SoRenderListAction
+  \since Coin 4.0
+*/
+void
+SoGLRenderAction::setRenderListMode(const RenderListMode mode)
+{
+  if (mode != PIPELINED_RENDER_LIST) {
+    PRIVATE(this)->finishRenderList();
+  }
+  PRIVATE(this)->renderlistmode = mode;
+}
+
+/*!
+  Returns how the scene graph is traversed when rendering.
+
+  \sa setRenderListMode()
+  \since Coin 4.0
+*/
+SoGLRenderAction::RenderListMode
+SoGLRenderAction::getRenderListMode(void) const
+{
+  return PRIVATE(this)->renderlistmode;
+}
+
+/*!
+  Sets whether opaque shapes should be rendered sorted on their
+  OpenGL state when rendering from a render list. The default is \c
+  FALSE.
+
+  SoGLLazyElement avoids sending state which hasn't changed, but when
+  shapes with different materials or textures alternate in the scene
+  graph, the state still changes between most shapes. With state
+  sorting, the opaque shapes of the render list are sorted on shader
+  program, texture, material and vertex data, and each run of shapes
+  with equal state is rendered as one path list. Transparent shapes
+  and other entries are rendered afterwards, in scene graph order.
+
+  This only has an effect when a render list mode is set, see
+  setRenderListMode(). Shapes are rendered in a different order than
+  they appear in the scene graph, so this should not be used for
+  scenes which depend on the rendering order of opaque shapes, such
+  as scenes using SoCallback nodes to change OpenGL state between
+  shapes.
+
+  \sa getNumStateChanges(), SoRenderListAction::getOpaqueShapes()
+  \since Coin 4.0
+*/
+void
+SoGLRenderAction::setStateSorting(const SbBool onoff)
+{
+  PRIVATE(this)->statesorting = onoff;
+}
+
+/*!
+  Returns whether opaque shapes are sorted on their OpenGL state.
+
+  \sa setStateSorting()
+  \since Coin 4.0
+*/
+SbBool
+SoGLRenderAction::isStateSorting(void) const
+{
+  return PRIVATE(this)->statesorting;
+}
+
+/*!
+  Returns how many times the state \a key, one of the
+  SoRenderListAction::StateKey values, changed between the opaque
+  shapes of the last frame rendered from a render list, in the order
+  they were rendered. Comparing the counts with and without
+  setStateSorting() shows how much state sorting helps for a scene.
+
+  Returns 0 if the last frame was not rendered from a render list.
+
+  \sa SoRenderListAction::countStateChanges()
+  \since Coin 4.0
+*/
+int
+SoGLRenderAction::getNumStateChanges(const int key) const
+{
+  assert(key >= 0 && key < SoRenderListAction::NUM_STATE_KEYS);
+  return PRIVATE(this)->statechanges[key];
+}
+
+/*!
+  Returns a counter which is incremented each time the action starts
+  rendering a scene graph, i.e. once for every apply() from the
+  application. Nodes which collect data over a frame, like
+  SoScreenSpaceErrorLOD, use it to detect frame boundaries.
+
+  \since Coin 4.0
+*/
+uint32_t
+SoGLRenderAction::getFrameCounter(void) const
+{
+  return PRIVATE(this)->framecounter;
+}
+
+/*!
+  Sets the size, in pixels, below which shapes are not rendered. A
+  shape is skipped when its bounding box projects to fewer than \a
+  pixels both horizontally and vertically. This trades small details
+  for speed, and is used by SoRenderManager to keep the frame time
+  down while the user interacts with a heavy scene.
+
+  Shapes are not skipped while a render cache is being built. The
+  default value is 0, which disables small feature culling.
+
+  \sa SoRenderManager::setTargetFrameTime()
+  \since Coin 4.0
+*/
+void
+SoGLRenderAction::setSmallFeatureSize(const float pixels)
+{
+  PRIVATE(this)->smallfeaturesize = pixels;
+}
+
+/*!
+  Returns the size below which shapes are not rendered.
+
+  \sa setSmallFeatureSize()
+  \since Coin 4.0
+*/
+float
+SoGLRenderAction::getSmallFeatureSize(void) const
+{
+  return PRIVATE(this)->smallfeaturesize;
+}
+
 /*!
   Sets the render type of delayed or sorted transparent objects. Default is ONE_PASS.
 
@@ -30,20 +30,158 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-// FIXME: this class has not yet been implemented in Coin. this is a
-// placeholder / stub / skeleton code, not yet built (nor installed,
-// obviously).  --mortene.
-
 /*!
   \class SoGlobalSimplifyAction Inventor/include/SoGlobalSimplifyAction.h
   \brief The SoGlobalSimplifyAction class is for globally simplifying the
   geometry of a scene graph, globally.
+  \ingroup actions
+
+  The action collects all the triangles in the scene graph, in the
+  coordinate system of the node the action is applied to, and sorts
+  them by material and texture. Each set of triangles is then
+  simplified as one mesh, so that triangles from neighbouring shapes
+  can be collapsed together. This works well for scenes made of many
+  small shapes, where SoShapeSimplifyAction can not remove much.
+
+  The scene graph the action is applied to is not changed. The result
+  is a new scene graph, available from getSimplifiedSceneGraph(),
+  with an SoLOD node as its only child. The levels of the SoLOD
+  containing the original geometry (simplification level 1.0 or
+  more) use the node the action was applied to (or the head of the
+  path), and the other levels contain one SoIndexedFaceSet per
+  material.
+
+  \code
+  SoGlobalSimplifyAction simplify;
+  simplify.apply(geometry);
+  SoSeparator * lodroot = simplify.getSimplifiedSceneGraph();
+  root->replaceChild(geometry, lodroot);
+  \endcode
+
+  Only materials, textures, texture transforms and shape hints are
+  kept in the simplified levels, so the action should be applied to
+  the part of the scene graph below any cameras and lights. Line and
+  point shapes are not included in the simplified levels. Since all
+  the geometry uses the same SoLOD node, the whole scene switches
+  between levels at the same distance.
+
+  \sa SoShapeSimplifyAction
+  \since Coin 4.0
 */
 
-#include <Inventor/SbName.h>
 #include <Inventor/actions/SoGlobalSimplifyAction.h>
-#include <coindefs.h> // COIN_STUB()
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbName.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/elements/SoMultiTextureCoordinateElement.h>
+#include <Inventor/elements/SoMultiTextureEnabledElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoShapeHints.h>
+#include <Inventor/nodes/SoTexture2.h>
+#include <Inventor/nodes/SoTextureMatrixTransform.h>
+
+#include "coindefs.h" // COIN_UNUSED_ARG
+#include "misc/SbMeshDecimator.h"
+#include "actions/SoSubActionP.h"
+#include "actions/SoSimplifyActionP.h"
+
+// *************************************************************************
+
+class SoGlobalSimplifyActionP {
+public:
+  SoGlobalSimplifyActionP(void)
+    : cbaction(SbViewportRegion(640, 480)),
+      result(NULL),
+      currentgroup(-1)
+  {
+    this->cbaction.addPreCallback(SoShape::getClassTypeId(), pre_shape_cb, this);
+    this->cbaction.addTriangleCallback(SoShape::getClassTypeId(), triangle_cb, this);
+  }
+  ~SoGlobalSimplifyActionP() {
+    this->clear();
+    if (this->result) this->result->unref();
+  }
+
+  // The triangles with the same appearance are simplified together.
+  struct Group {
+    Group(void) : mesh(NULL) { }
+    ~Group() { delete this->mesh; }
+
+    SbColor ambient, diffuse, specular, emission;
+    float shininess, transparency;
+    int vertexordering, shapetype;
+    SbBool textured;
+    const unsigned char * teximage;
+    SbVec2s texsize;
+    int texnc;
+    int texmodel, texwraps, texwrapt;
+    SbColor texblendcolor;
+    SbMatrix texmatrix;
+
+    SbMeshDecimator * mesh;
+
+    SbBool matches(const Group & g) const;
+  };
+
+  SoCallbackAction cbaction;
+  SbList<Group *> groups;
+  SbBox3f bbox;
+  SoSeparator * result;
+
+  // cached lookup for the current shape
+  int currentgroup;
+  int currentmaterialindex;
+
+  static SoCallbackAction::Response pre_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node);
+  static void triangle_cb(void * userdata, SoCallbackAction * action,
+                          const SoPrimitiveVertex * v1,
+                          const SoPrimitiveVertex * v2,
+                          const SoPrimitiveVertex * v3);
+
+  int findGroup(SoCallbackAction * action, const int materialindex);
+  SoNode * createAppearance(const Group * group) const;
+  void clear(void);
+};
+
+#define PRIVATE(obj) obj->pimpl
+
+SbBool
+SoGlobalSimplifyActionP::Group::matches(const Group & g) const
+{
+  if (this->diffuse != g.diffuse ||
+      this->ambient != g.ambient ||
+      this->specular != g.specular ||
+      this->emission != g.emission ||
+      this->shininess != g.shininess ||
+      this->transparency != g.transparency ||
+      this->vertexordering != g.vertexordering ||
+      this->shapetype != g.shapetype ||
+      this->textured != g.textured) return FALSE;
+  if (!this->textured) return TRUE;
+  return
+    this->teximage == g.teximage &&
+    this->texsize == g.texsize &&
+    this->texnc == g.texnc &&
+    this->texmodel == g.texmodel &&
+    this->texwraps == g.texwraps &&
+    this->texwrapt == g.texwrapt &&
+    this->texblendcolor == g.texblendcolor &&
+    this->texmatrix == g.texmatrix;
+}
+
+// *************************************************************************
 
 SO_ACTION_SOURCE(SoGlobalSimplifyAction);
 
@@ -61,7 +199,7 @@ SoGlobalSimplifyAction::initClass(void)
 
 SoGlobalSimplifyAction::SoGlobalSimplifyAction(void)
 {
-  COIN_STUB();
+  SO_ACTION_CONSTRUCTOR(SoGlobalSimplifyAction);
 }
 
 /*!
@@ -70,12 +208,294 @@ SoGlobalSimplifyAction::SoGlobalSimplifyAction(void)
 
 SoGlobalSimplifyAction::~SoGlobalSimplifyAction(void)
 {
-  COIN_STUB();
+}
+
+/*!
+  Returns the scene graph created by the last apply(), or \c NULL if
+  the action has not been applied. The scene graph is owned by the
+  action until it is applied again or destructed, so it must be
+  ref'ed if it is to be used after that.
+*/
+SoSeparator *
+SoGlobalSimplifyAction::getSimplifiedSceneGraph(void) const
+{
+  return PRIVATE(this)->result;
 }
 
 // Documented in superclass.
 void
-SoGlobalSimplifyAction::beginTraversal(SoNode * /* node */)
+SoGlobalSimplifyAction::beginTraversal(SoNode * node)
 {
-  COIN_STUB();
+  SoGlobalSimplifyActionP * thisp = &PRIVATE(this).get();
+  thisp->clear();
+  if (thisp->result) {
+    thisp->result->unref();
+    thisp->result = NULL;
+  }
+
+  switch (this->getWhatAppliedTo()) {
+  case SoAction::NODE:
+    thisp->cbaction.apply(node);
+    break;
+  case SoAction::PATH:
+    thisp->cbaction.apply(this->getPathAppliedTo());
+    break;
+  case SoAction::PATH_LIST:
+    thisp->cbaction.apply(*this->getPathListAppliedTo(), TRUE);
+    break;
+  default:
+    assert(0 && "unknown apply code");
+    break;
+  }
+
+  const int numlevels = this->getNumSimplificationLevels();
+  const float * levels = this->getSimplificationLevels();
+  SbList<float> ratios;
+  int i, j;
+  for (i = 0; i < numlevels; i++) {
+    if (levels[i] < 1.0f) ratios.append(levels[i]);
+  }
+  SbList<float> keepall;
+  for (i = 0; i < ratios.getLength(); i++) keepall.append(1.0f);
+
+  // small groups are kept as they are in all levels
+  SbList<SbMeshDecimator *> meshes;
+  for (i = 0; i < thisp->groups.getLength(); i++) {
+    SbMeshDecimator * mesh = thisp->groups[i]->mesh;
+    if (mesh->getNumTriangles() < this->getMinTriangles()) {
+      mesh->setLevels(keepall.getLength(), keepall.getArrayPtr());
+    }
+    else {
+      mesh->setLevels(ratios.getLength(), ratios.getArrayPtr());
+    }
+    meshes.append(mesh);
+  }
+  SbMeshDecimator::decimate(meshes.getArrayPtr(), meshes.getLength(),
+                            this->getNumThreads());
+
+  float radius = 0.0f;
+  SbVec3f center(0.0f, 0.0f, 0.0f);
+  if (!thisp->bbox.isEmpty()) {
+    float dx, dy, dz;
+    thisp->bbox.getSize(dx, dy, dz);
+    radius = SbVec3f(dx, dy, dz).length() * 0.5f;
+    center = thisp->bbox.getCenter();
+  }
+
+  SbList<SoNode *> appearances;
+  for (i = 0; i < thisp->groups.getLength(); i++) {
+    appearances.append(thisp->createAppearance(thisp->groups[i]));
+  }
+
+  thisp->result = new SoSeparator;
+  thisp->result->ref();
+  SoLOD * lod = SoSimplifyActionP::createLOD(this, center, radius);
+  thisp->result->addChild(lod);
+  int level = 0;
+  for (i = 0; i < numlevels; i++) {
+    if (levels[i] >= 1.0f) {
+      lod->addChild(node);
+      continue;
+    }
+    SoSeparator * levelroot = new SoSeparator;
+    for (j = 0; j < thisp->groups.getLength(); j++) {
+      SoSeparator * sep = new SoSeparator;
+      sep->addChild(appearances[j]);
+      sep->addChild(SoSimplifyActionP::createShape(thisp->groups[j]->mesh, level));
+      levelroot->addChild(sep);
+    }
+    lod->addChild(levelroot);
+    level++;
+  }
+  thisp->clear();
 }
+
+// *************************************************************************
+
+SoCallbackAction::Response
+SoGlobalSimplifyActionP::pre_shape_cb(void * userdata, SoCallbackAction * COIN_UNUSED_ARG(action), const SoNode * COIN_UNUSED_ARG(node))
+{
+  SoGlobalSimplifyActionP * thisp = static_cast<SoGlobalSimplifyActionP *>(userdata);
+  thisp->currentgroup = -1;
+  return SoCallbackAction::CONTINUE;
+}
+
+int
+SoGlobalSimplifyActionP::findGroup(SoCallbackAction * action, const int materialindex)
+{
+  SoState * state = action->getState();
+  Group * g = new Group;
+  action->getMaterial(g->ambient, g->diffuse, g->specular, g->emission,
+                      g->shininess, g->transparency, materialindex);
+  g->vertexordering = action->getVertexOrdering();
+  g->shapetype = action->getShapeType();
+
+  // generated texture coordinates can't be kept
+  g->textured =
+    SoMultiTextureEnabledElement::getMode(state, 0) == SoMultiTextureEnabledElement::TEXTURE2D &&
+    SoMultiTextureCoordinateElement::getType(state, 0) != SoMultiTextureCoordinateElement::TEXGEN;
+  g->teximage = NULL;
+  if (g->textured) {
+    g->teximage = action->getTextureImage(g->texsize, g->texnc);
+    g->texmodel = action->getTextureModel();
+    g->texwraps = action->getTextureWrapS();
+    g->texwrapt = action->getTextureWrapT();
+    g->texblendcolor = action->getTextureBlendColor();
+    g->texmatrix = action->getTextureMatrix();
+    if (g->teximage == NULL) g->textured = FALSE;
+  }
+
+  for (int i = 0; i < this->groups.getLength(); i++) {
+    if (this->groups[i]->matches(*g)) {
+      delete g;
+      return i;
+    }
+  }
+  g->mesh = new SbMeshDecimator(TRUE, g->textured);
+  this->groups.append(g);
+  return this->groups.getLength() - 1;
+}
+
+void
+SoGlobalSimplifyActionP::triangle_cb(void * userdata, SoCallbackAction * action,
+                                     const SoPrimitiveVertex * v1,
+                                     const SoPrimitiveVertex * v2,
+                                     const SoPrimitiveVertex * v3)
+{
+  SoGlobalSimplifyActionP * thisp = static_cast<SoGlobalSimplifyActionP *>(userdata);
+  const int materialindex = v1->getMaterialIndex();
+  if (thisp->currentgroup < 0 || materialindex != thisp->currentmaterialindex) {
+    thisp->currentgroup = thisp->findGroup(action, materialindex);
+    thisp->currentmaterialindex = materialindex;
+  }
+  SbMeshDecimator * mesh = thisp->groups[thisp->currentgroup]->mesh;
+
+  const SbMatrix & m = action->getModelMatrix();
+  const SbMatrix n = m.inverse().transpose();
+  const SbBool flip = m.det3() < 0.0f;
+
+  const SoPrimitiveVertex * v[3] = { v1, flip ? v3 : v2, flip ? v2 : v3 };
+  int idx[3];
+  for (int i = 0; i < 3; i++) {
+    SbVec3f p, normal;
+    m.multVecMatrix(v[i]->getPoint(), p);
+    n.multDirMatrix(v[i]->getNormal(), normal);
+    (void) normal.normalize();
+    const SbVec4f & tc = v[i]->getTextureCoords();
+    SbVec2f t(tc[0], tc[1]);
+    if (tc[3] != 0.0f) t /= tc[3];
+    idx[i] = mesh->addVertex(p, normal, t);
+    thisp->bbox.extendBy(p);
+  }
+  mesh->addTriangle(idx[0], idx[1], idx[2]);
+}
+
+// Creates the nodes needed to render a group like the original
+// triangles.
+SoNode *
+SoGlobalSimplifyActionP::createAppearance(const Group * group) const
+{
+  SoGroup * appearance = new SoGroup;
+  SoMaterial * mat = new SoMaterial;
+  mat->ambientColor = group->ambient;
+  mat->diffuseColor = group->diffuse;
+  mat->specularColor = group->specular;
+  mat->emissiveColor = group->emission;
+  mat->shininess = group->shininess;
+  mat->transparency = group->transparency;
+  appearance->addChild(mat);
+
+  SoShapeHints * hints = new SoShapeHints;
+  hints->vertexOrdering = group->vertexordering;
+  hints->shapeType = group->shapetype;
+  appearance->addChild(hints);
+
+  if (group->textured) {
+    if (group->texmatrix != SbMatrix::identity()) {
+      SoTextureMatrixTransform * tm = new SoTextureMatrixTransform;
+      tm->matrix = group->texmatrix;
+      appearance->addChild(tm);
+    }
+    SoTexture2 * tex = new SoTexture2;
+    tex->image.setValue(group->texsize, group->texnc, group->teximage);
+    tex->model = group->texmodel;
+    tex->wrapS = group->texwraps;
+    tex->wrapT = group->texwrapt;
+    tex->blendColor = group->texblendcolor;
+    appearance->addChild(tex);
+  }
+  return appearance;
+}
+
+void
+SoGlobalSimplifyActionP::clear(void)
+{
+  for (int i = 0; i < this->groups.getLength(); i++) {
+    delete this->groups[i];
+  }
+  this->groups.truncate(0);
+  this->bbox.makeEmpty();
+  this->currentgroup = -1;
+}
+
+#undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoGlobalSimplifyAction.h>
+#include <Inventor/nodes/SoComplexity.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+BOOST_AUTO_TEST_CASE(simplifyScene)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoComplexity * complexity = new SoComplexity;
+  complexity->value = 1.0f;
+  root->addChild(complexity);
+  for (int i = 0; i < 2; i++) {
+    SoMaterial * mat = new SoMaterial;
+    mat->diffuseColor.setValue(SbColor(i == 0 ? 1.0f : 0.0f, 0.0f, i == 1 ? 1.0f : 0.0f));
+    SoTranslation * t = new SoTranslation;
+    t->translation.setValue(3.0f, 0.0f, 0.0f);
+    root->addChild(mat);
+    root->addChild(new SoSphere);
+    root->addChild(t);
+  }
+
+  SbViewportRegion vp(100, 100);
+  SoGetPrimitiveCountAction pcaction(vp);
+  pcaction.apply(root);
+  const int numtriangles = pcaction.getTriangleCount();
+
+  SoGlobalSimplifyAction simplify;
+  const float levels[] = { 1.0f, 0.2f };
+  simplify.setSimplificationLevels(2, levels);
+  simplify.apply(root);
+
+  SoSeparator * result = simplify.getSimplifiedSceneGraph();
+  BOOST_REQUIRE(result != NULL);
+  BOOST_REQUIRE(result->getNumChildren() == 1);
+  BOOST_REQUIRE(result->getChild(0)->isOfType(SoLOD::getClassTypeId()));
+  SoLOD * lod = static_cast<SoLOD *>(result->getChild(0));
+  BOOST_REQUIRE(lod->getNumChildren() == 2);
+  BOOST_CHECK_MESSAGE(lod->getChild(0) == root, "first level should be the original scene");
+
+  SoGroup * simplified = static_cast<SoGroup *>(lod->getChild(1));
+  BOOST_CHECK_MESSAGE(simplified->getNumChildren() == 2, "expected one shape per material");
+  pcaction.apply(simplified);
+  const int num = pcaction.getTriangleCount();
+  BOOST_CHECK_MESSAGE(num <= 0.2f * numtriangles + 4 && num > 0.1f * numtriangles,
+                      "wrong number of triangles in simplified level");
+  root->unref();
+}
+
+#endif // COIN_TEST_SUITE
@@ -0,0 +1,828 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SoRenderListAction SoRenderListAction.h Inventor/actions/SoRenderListAction.h
+  \brief The SoRenderListAction class builds a flat list of the shapes that are visible in a scene.
+  \ingroup actions
+
+  The action traverses the scene graph the same way SoGLRenderAction
+  does, but instead of sending anything to OpenGL it records one
+  entry for each shape that would be rendered. Separators and shapes
+  outside the view volume of the camera are culled, level-of-detail
+  and switch nodes select their children as they would during
+  rendering, and invisible shapes are skipped. For each entry the
+  action stores the path to the shape, its model matrix, its bounding
+  box in world coordinates, and whether the shape will be rendered as
+  a transparent object.
+
+  No OpenGL context is needed, so the action can be applied on a
+  separate thread while another thread renders. SoGLRenderAction uses
+  it for its render list modes, see
+  SoGLRenderAction::setRenderListMode().
+
+  \code
+  SoRenderListAction listaction(viewport);
+  listaction.apply(root);
+  for (int i = 0; i < listaction.getNumEntries(); i++) {
+    SoNode * node = listaction.getNode(i);
+    const SbBox3f & box = listaction.getBoundingBox(i);
+    // ...
+  }
+  SoPathList paths;
+  listaction.getPaths(paths);
+  \endcode
+
+  Besides shapes, SoCallback nodes are recorded, since they may
+  render directly with OpenGL. Their callbacks are not invoked by this
+  action. Other node types which render without being shapes can be
+  added with addEntryType().
+
+  Each shape entry also gets a key for each kind of OpenGL state that
+  is expensive to change: the shader program, the texture, the
+  material and the vertex data. Entries with equal keys can be
+  rendered without changing that part of the state in between.
+  getOpaqueShapes() returns the opaque shapes either in traversal
+  order or sorted on these keys, and countStateChanges() counts how
+  many times a key changes in such a list. SoGLRenderAction uses this
+  to render opaque shapes in state order, see
+  SoGLRenderAction::setStateSorting().
+
+  The entries refer to nodes in the scene graph without referencing
+  them, so the root node the action was applied to must be kept alive
+  while the entries are used. If the scene graph changes after the
+  action was applied, createPath() and getPaths() will skip the
+  entries that are no longer valid.
+
+  \sa SoGLRenderAction, SoCallbackAction
+  \since Coin 4.0
+*/
+
+#include <Inventor/actions/SoRenderListAction.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cstdlib>
+
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/elements/SoCoordinateElement.h>
+#include <Inventor/elements/SoCullElement.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoMultiTextureEnabledElement.h>
+#include <Inventor/elements/SoMultiTextureImageElement.h>
+#include <Inventor/elements/SoShapeStyleElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoCallback.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShaderProgram.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoVertexShape.h>
+
+#include "actions/SoSubActionP.h"
+#include "tidbitsp.h"
+#include "coindefs.h"
+#include "SbBasicP.h"
+
+// *************************************************************************
+
+class SoRenderListActionP {
+public:
+  SoRenderListActionP(void)
+    : root(NULL), numculled(0), shaderkey(0)
+  { }
+
+  class Entry {
+  public:
+    SoNode * node;
+    SbMatrix modelmatrix;
+    SbBox3f bbox;
+    SbBool transparent;
+    SbBool isshape;
+    uint32_t statekeys[SoRenderListAction::NUM_STATE_KEYS];
+    // the path to the node is stored in chainnodes and chainindices
+    int chainstart;
+    int chainlength;
+  };
+
+  void clear(void);
+  Entry & addEntry(SoCallbackAction * action, const SoNode * node,
+                   const SbBox3f & bbox, const SbBool transparent);
+  void setStateKeys(SoState * state, const SoNode * shape, Entry & entry) const;
+
+  static SoCallbackAction::Response shapeCB(void * closure,
+                                            SoCallbackAction * action,
+                                            const SoNode * node);
+  static SoCallbackAction::Response entryCB(void * closure,
+                                            SoCallbackAction * action,
+                                            const SoNode * node);
+  static SoCallbackAction::Response cameraCB(void * closure,
+                                             SoCallbackAction * action,
+                                             const SoNode * node);
+  static SoCallbackAction::Response shaderCB(void * closure,
+                                             SoCallbackAction * action,
+                                             const SoNode * node);
+  static SoCallbackAction::Response preSeparatorCB(void * closure,
+                                                   SoCallbackAction * action,
+                                                   const SoNode * node);
+  static SoCallbackAction::Response postSeparatorCB(void * closure,
+                                                    SoCallbackAction * action,
+                                                    const SoNode * node);
+  void addCallbacks(SoRenderListAction * action);
+
+  static SbList<SoType> * entrytypes;
+  static void cleanup(void);
+
+  SoNode * root;
+  SbList<Entry> entries;
+  SbList<SoNode *> chainnodes;
+  SbList<int> chainindices;
+  int numculled;
+
+  // the shader program isn't tracked by any element in
+  // SoCallbackAction, so we scope it by separators ourselves
+  uint32_t shaderkey;
+  SbList<uint32_t> shaderstack;
+};
+
+// FNV-1a, used for combining the parts of a state key
+static uint32_t
+sorenderlist_hash(uint32_t hash, const void * data, const size_t size)
+{
+  const unsigned char * ptr = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ ptr[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static const uint32_t SORENDERLIST_HASH_INIT = 2166136261u;
+
+// used for sorting shapes on their state keys
+typedef struct {
+  uint32_t keys[SoRenderListAction::NUM_STATE_KEYS];
+  int entry;
+} sorenderlist_sortitem;
+
+extern "C" {
+static int
+sorenderlist_compare(const void * v0, const void * v1)
+{
+  const sorenderlist_sortitem * i0 = static_cast<const sorenderlist_sortitem *>(v0);
+  const sorenderlist_sortitem * i1 = static_cast<const sorenderlist_sortitem *>(v1);
+  for (int k = 0; k < SoRenderListAction::NUM_STATE_KEYS; k++) {
+    if (i0->keys[k] != i1->keys[k]) return i0->keys[k] < i1->keys[k] ? -1 : 1;
+  }
+  // keep traversal order for equal state
+  return i0->entry - i1->entry;
+}
+}
+
+SbList<SoType> * SoRenderListActionP::entrytypes = NULL;
+
+void
+SoRenderListActionP::cleanup(void)
+{
+  delete SoRenderListActionP::entrytypes;
+  SoRenderListActionP::entrytypes = NULL;
+}
+
+void
+SoRenderListActionP::clear(void)
+{
+  this->root = NULL;
+  this->entries.truncate(0);
+  this->chainnodes.truncate(0);
+  this->chainindices.truncate(0);
+  this->numculled = 0;
+  this->shaderkey = 0;
+  this->shaderstack.truncate(0);
+}
+
+void
+SoRenderListActionP::addCallbacks(SoRenderListAction * action)
+{
+  action->addPreCallback(SoShape::getClassTypeId(),
+                         SoRenderListActionP::shapeCB, this);
+  action->addPreCallback(SoCallback::getClassTypeId(),
+                         SoRenderListActionP::entryCB, this);
+  action->addPostCallback(SoCamera::getClassTypeId(),
+                          SoRenderListActionP::cameraCB, this);
+  action->addPreCallback(SoShaderProgram::getClassTypeId(),
+                         SoRenderListActionP::shaderCB, this);
+  action->addPreCallback(SoSeparator::getClassTypeId(),
+                         SoRenderListActionP::preSeparatorCB, this);
+  action->addPostCallback(SoSeparator::getClassTypeId(),
+                          SoRenderListActionP::postSeparatorCB, this);
+  if (SoRenderListActionP::entrytypes) {
+    for (int i = 0; i < SoRenderListActionP::entrytypes->getLength(); i++) {
+      action->addPreCallback((*SoRenderListActionP::entrytypes)[i],
+                             SoRenderListActionP::entryCB, this);
+    }
+  }
+}
+
+SoRenderListActionP::Entry &
+SoRenderListActionP::addEntry(SoCallbackAction * action, const SoNode * node,
+                              const SbBox3f & bbox, const SbBool transparent)
+{
+  const SoFullPath * path = reclassify_cast<const SoFullPath *>(action->getCurPath());
+  const int len = path->getLength();
+
+  Entry entry;
+  entry.node = const_cast<SoNode *>(node);
+  entry.modelmatrix = SoModelMatrixElement::get(action->getState());
+  entry.bbox = bbox;
+  entry.transparent = transparent;
+  entry.isshape = FALSE;
+  for (int k = 0; k < SoRenderListAction::NUM_STATE_KEYS; k++) {
+    entry.statekeys[k] = 0;
+  }
+  entry.chainstart = this->chainnodes.getLength();
+  entry.chainlength = len;
+  for (int i = 0; i < len; i++) {
+    this->chainnodes.append(path->getNode(i));
+    this->chainindices.append(i > 0 ? path->getIndex(i) : 0);
+  }
+  this->entries.append(entry);
+  return this->entries[this->entries.getLength()-1];
+}
+
+void
+SoRenderListActionP::setStateKeys(SoState * state, const SoNode * shape,
+                                  Entry & entry) const
+{
+  entry.isshape = TRUE;
+  entry.statekeys[SoRenderListAction::SHADER_KEY] = this->shaderkey;
+
+  if (SoMultiTextureEnabledElement::get(state, 0)) {
+    SbVec2s size;
+    int nc;
+    const unsigned char * bytes =
+      SoMultiTextureImageElement::getImage(state, 0, size, nc);
+    uint32_t key = sorenderlist_hash(SORENDERLIST_HASH_INIT, &bytes, sizeof(bytes));
+    key = sorenderlist_hash(key, &size, sizeof(size));
+    entry.statekeys[SoRenderListAction::TEXTURE_KEY] = key;
+  }
+
+  // SoGLLazyElement resends the material when the material arrays
+  // come from another node, so the array pointers identify it
+  SoLazyElement * lazy = SoLazyElement::getInstance(state);
+  const void * ptrs[3] = {
+    lazy->isPacked() ? static_cast<const void *>(lazy->getPackedPointer()) :
+    static_cast<const void *>(lazy->getDiffusePointer()),
+    lazy->getTransparencyPointer(),
+    NULL
+  };
+  const SbColor colors[3] = {
+    SoLazyElement::getAmbient(state),
+    SoLazyElement::getEmissive(state),
+    SoLazyElement::getSpecular(state)
+  };
+  const float shininess = SoLazyElement::getShininess(state);
+  const int32_t lightmodel = SoLazyElement::getLightModel(state);
+  uint32_t key = sorenderlist_hash(SORENDERLIST_HASH_INIT, ptrs, sizeof(ptrs));
+  key = sorenderlist_hash(key, colors[0].getValue(), 3 * sizeof(float));
+  key = sorenderlist_hash(key, colors[1].getValue(), 3 * sizeof(float));
+  key = sorenderlist_hash(key, colors[2].getValue(), 3 * sizeof(float));
+  key = sorenderlist_hash(key, &shininess, sizeof(shininess));
+  key = sorenderlist_hash(key, &lightmodel, sizeof(lightmodel));
+  entry.statekeys[SoRenderListAction::MATERIAL_KEY] = key;
+
+  // vertex arrays and VBOs belong to the node providing the coordinates
+  if (shape->isOfType(SoVertexShape::getClassTypeId())) {
+    const SoNode * vp =
+      coin_assert_cast<const SoVertexShape *>(shape)->vertexProperty.getValue();
+    entry.statekeys[SoRenderListAction::VERTEX_DATA_KEY] = vp ?
+      vp->getNodeId() : SoCoordinateElement::getInstance(state)->getNodeId();
+  }
+}
+
+// Records visible shapes. Primitives are never generated, since the
+// shape is pruned after it has been recorded.
+SoCallbackAction::Response
+SoRenderListActionP::shapeCB(void * closure, SoCallbackAction * action,
+                             const SoNode * node)
+{
+  SoRenderListActionP * thisp = static_cast<SoRenderListActionP *>(closure);
+  SoState * state = action->getState();
+
+  const unsigned int flags = SoShapeStyleElement::get(state)->getFlags();
+  if (flags & SoShapeStyleElement::INVISIBLE) return SoCallbackAction::PRUNE;
+
+  SoShape * shape = const_cast<SoShape *>(coin_assert_cast<const SoShape *>(node));
+  SbBox3f box;
+  SbVec3f center;
+  shape->computeBBox(action, box, center);
+
+  // the separator above us has already been tested if the cull
+  // element says we're completely inside the view volume
+  if (!box.isEmpty() && !SoCullElement::completelyInside(state) &&
+      SoCullElement::cullTest(state, box, TRUE)) {
+    thisp->numculled++;
+    return SoCallbackAction::PRUNE;
+  }
+
+  SbBool transparent = (flags & SoShapeStyleElement::TRANSP_MATERIAL) != 0;
+  if (!transparent && SoMultiTextureEnabledElement::get(state, 0)) {
+    transparent = SoMultiTextureImageElement::containsTransparency(state);
+  }
+
+  if (!box.isEmpty()) box.transform(SoModelMatrixElement::get(state));
+  SoRenderListActionP::Entry & entry = thisp->addEntry(action, node, box, transparent);
+  thisp->setStateKeys(state, node, entry);
+  return SoCallbackAction::PRUNE;
+}
+
+// Records nodes of other entry types, without traversing them.
+SoCallbackAction::Response
+SoRenderListActionP::entryCB(void * closure, SoCallbackAction * action,
+                             const SoNode * node)
+{
+  SoRenderListActionP * thisp = static_cast<SoRenderListActionP *>(closure);
+  thisp->addEntry(action, node, SbBox3f(), FALSE);
+  return SoCallbackAction::PRUNE;
+}
+
+// Sets up view volume culling after each camera, like
+// SoCamera::GLRender() does for SoGLRenderAction.
+SoCallbackAction::Response
+SoRenderListActionP::cameraCB(void * COIN_UNUSED_ARG(closure),
+                              SoCallbackAction * action,
+                              const SoNode * COIN_UNUSED_ARG(node))
+{
+  SoState * state = action->getState();
+  const SbViewVolume & vv = SoViewVolumeElement::get(state);
+  if (vv.getDepth() != 0.0f && vv.getWidth() != 0.0f && vv.getHeight() != 0.0f) {
+    SoCullElement::setViewVolume(state, vv);
+  }
+  return SoCallbackAction::CONTINUE;
+}
+
+SoCallbackAction::Response
+SoRenderListActionP::shaderCB(void * closure, SoCallbackAction * COIN_UNUSED_ARG(action),
+                              const SoNode * node)
+{
+  SoRenderListActionP * thisp = static_cast<SoRenderListActionP *>(closure);
+  thisp->shaderkey = node->getNodeId();
+  return SoCallbackAction::CONTINUE;
+}
+
+SoCallbackAction::Response
+SoRenderListActionP::preSeparatorCB(void * closure, SoCallbackAction * COIN_UNUSED_ARG(action),
+                                    const SoNode * COIN_UNUSED_ARG(node))
+{
+  SoRenderListActionP * thisp = static_cast<SoRenderListActionP *>(closure);
+  thisp->shaderstack.push(thisp->shaderkey);
+  return SoCallbackAction::CONTINUE;
+}
+
+SoCallbackAction::Response
+SoRenderListActionP::postSeparatorCB(void * closure, SoCallbackAction * COIN_UNUSED_ARG(action),
+                                     const SoNode * COIN_UNUSED_ARG(node))
+{
+  SoRenderListActionP * thisp = static_cast<SoRenderListActionP *>(closure);
+  if (thisp->shaderstack.getLength()) {
+    thisp->shaderkey = thisp->shaderstack.pop();
+  }
+  return SoCallbackAction::CONTINUE;
+}
+
+// *************************************************************************
+
+#define PRIVATE(obj) ((obj)->pimpl)
+
+SO_ACTION_SOURCE(SoRenderListAction);
+
+// Override from parent class.
+void
+SoRenderListAction::initClass(void)
+{
+  SO_ACTION_INTERNAL_INIT_CLASS(SoRenderListAction, SoCallbackAction);
+}
+
+/*!
+  Constructor.
+*/
+SoRenderListAction::SoRenderListAction(void)
+{
+  SO_ACTION_CONSTRUCTOR(SoRenderListAction);
+  PRIVATE(this)->addCallbacks(this);
+}
+
+/*!
+  Constructor which sets the viewport region used for culling and
+  level-of-detail selection.
+*/
+SoRenderListAction::SoRenderListAction(const SbViewportRegion & vp)
+  : inherited(vp)
+{
+  SO_ACTION_CONSTRUCTOR(SoRenderListAction);
+  PRIVATE(this)->addCallbacks(this);
+}
+
+/*!
+  The destructor.
+*/
+SoRenderListAction::~SoRenderListAction(void)
+{
+}
+
+/*!
+  Makes all render list actions constructed after this call record
+  nodes of \a type as entries, in addition to shapes and SoCallback
+  nodes. Use this for node types which render directly with OpenGL
+  without being shapes.
+
+  Nodes of these types are recorded but not traversed.
+*/
+void
+SoRenderListAction::addEntryType(const SoType type)
+{
+  if (SoRenderListActionP::entrytypes == NULL) {
+    SoRenderListActionP::entrytypes = new SbList<SoType>;
+    coin_atexit(static_cast<coin_atexit_f *>(SoRenderListActionP::cleanup), CC_ATEXIT_NORMAL);
+  }
+  if (SoRenderListActionP::entrytypes->find(type) < 0) {
+    SoRenderListActionP::entrytypes->append(type);
+  }
+}
+
+/*!
+  Returns the number of entries recorded by the last apply().
+*/
+int
+SoRenderListAction::getNumEntries(void) const
+{
+  return PRIVATE(this)->entries.getLength();
+}
+
+/*!
+  Returns the shape, or other node, recorded for \a entry.
+*/
+SoNode *
+SoRenderListAction::getNode(const int entry) const
+{
+  return PRIVATE(this)->entries.getArrayPtr()[entry].node;
+}
+
+/*!
+  Returns the model matrix of \a entry.
+*/
+const SbMatrix &
+SoRenderListAction::getModelMatrix(const int entry) const
+{
+  return PRIVATE(this)->entries.getArrayPtr()[entry].modelmatrix;
+}
+
+/*!
+  Returns the bounding box of \a entry in world coordinates. The box
+  is empty for entries which are not shapes.
+*/
+const SbBox3f &
+SoRenderListAction::getBoundingBox(const int entry) const
+{
+  return PRIVATE(this)->entries.getArrayPtr()[entry].bbox;
+}
+
+/*!
+  Returns \c TRUE if \a entry has a transparent material or a texture
+  with transparency, in which case SoGLRenderAction will normally
+  delay it to the transparency pass.
+*/
+SbBool
+SoRenderListAction::isTransparent(const int entry) const
+{
+  return PRIVATE(this)->entries.getArrayPtr()[entry].transparent;
+}
+
+/*!
+  Returns the \a key of the OpenGL state \a entry will be rendered
+  with. Shapes with equal keys share that part of the state. The keys
+  are 0 for entries which are not shapes, and for shapes without
+  texture, shader program or vertex data.
+*/
+uint32_t
+SoRenderListAction::getStateKey(const int entry, const StateKey key) const
+{
+  return PRIVATE(this)->entries.getArrayPtr()[entry].statekeys[key];
+}
+
+/*!
+  Returns a new path to \a entry, starting at the node the action was
+  applied to. Returns \c NULL if the scene graph has changed so that
+  the node is no longer found where it was recorded.
+*/
+SoPath *
+SoRenderListAction::createPath(const int entry) const
+{
+  const SoRenderListActionP::Entry & e = PRIVATE(this)->entries.getArrayPtr()[entry];
+  SoNode * const * nodes = PRIVATE(this)->chainnodes.getArrayPtr() + e.chainstart;
+  const int * indices = PRIVATE(this)->chainindices.getArrayPtr() + e.chainstart;
+
+  for (int i = 1; i < e.chainlength; i++) {
+    const SoChildList * children = nodes[i-1]->getChildren();
+    if (children == NULL || indices[i] >= children->getLength() ||
+        (*children)[indices[i]] != nodes[i]) return NULL;
+  }
+
+  SoPath * path = new SoPath(e.chainlength);
+  path->setHead(nodes[0]);
+  for (int i = 1; i < e.chainlength; i++) {
+    path->append(indices[i]);
+  }
+  return path;
+}
+
+/*!
+  Appends paths to all entries to \a pathlist, in traversal order.
+  Returns the number of entries which were skipped because the scene
+  graph has changed since the action was applied.
+
+  \sa createPath()
+*/
+int
+SoRenderListAction::getPaths(SoPathList & pathlist) const
+{
+  int numstale = 0;
+  const int n = PRIVATE(this)->entries.getLength();
+  for (int i = 0; i < n; i++) {
+    SoPath * path = this->createPath(i);
+    if (path) pathlist.append(path);
+    else numstale++;
+  }
+  return numstale;
+}
+
+/*!
+  Sets \a entries to the indices of the opaque shape entries. With
+  \a sortbystate, the entries are sorted on the shader program,
+  texture, material and vertex data keys, in that order, so that
+  shapes sharing state are next to each other. Otherwise, they are in
+  traversal order.
+
+  \sa countStateChanges()
+*/
+void
+SoRenderListAction::getOpaqueShapes(SbList<int> & entries, const SbBool sortbystate) const
+{
+  entries.truncate(0);
+  const SoRenderListActionP::Entry * e = PRIVATE(this)->entries.getArrayPtr();
+  const int n = PRIVATE(this)->entries.getLength();
+  for (int i = 0; i < n; i++) {
+    if (e[i].isshape && !e[i].transparent) entries.append(i);
+  }
+  if (!sortbystate || entries.getLength() < 2) return;
+
+  const int num = entries.getLength();
+  sorenderlist_sortitem * items = new sorenderlist_sortitem[num];
+  for (int i = 0; i < num; i++) {
+    const SoRenderListActionP::Entry & entry = e[entries[i]];
+    for (int k = 0; k < NUM_STATE_KEYS; k++) {
+      items[i].keys[k] = entry.statekeys[k];
+    }
+    items[i].entry = entries[i];
+  }
+  qsort(items, num, sizeof(sorenderlist_sortitem), sorenderlist_compare);
+  for (int i = 0; i < num; i++) {
+    entries[i] = items[i].entry;
+  }
+  delete[] items;
+}
+
+/*!
+  Returns the number of times the state \a key changes when the
+  entries in \a entries are rendered in order.
+
+  \sa getOpaqueShapes()
+*/
+int
+SoRenderListAction::countStateChanges(const SbList<int> & entries, const StateKey key) const
+{
+  const SoRenderListActionP::Entry * e = PRIVATE(this)->entries.getArrayPtr();
+  int changes = 0;
+  for (int i = 1; i < entries.getLength(); i++) {
+    if (e[entries[i]].statekeys[key] != e[entries[i-1]].statekeys[key]) changes++;
+  }
+  return changes;
+}
+
+/*!
+  Returns the number of shapes that were culled against the view
+  volume during the last apply(). Shapes below separators that were
+  culled as a whole are not counted.
+*/
+int
+SoRenderListAction::getNumCulled(void) const
+{
+  return PRIVATE(this)->numculled;
+}
+
+/*!
+  Returns the node the action was last applied to, or the head of the
+  path if it was applied to a path.
+*/
+SoNode *
+SoRenderListAction::getRoot(void) const
+{
+  return PRIVATE(this)->root;
+}
+
+// Documented in superclass.
+void
+SoRenderListAction::beginTraversal(SoNode * node)
+{
+  PRIVATE(this)->clear();
+  PRIVATE(this)->root = node;
+  inherited::beginTraversal(node);
+}
+
+#undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoRenderListAction.h>
+#include <Inventor/nodes/SoCallback.h>
+#include <Inventor/nodes/SoCone.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShaderProgram.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+static SoSeparator *
+sorenderlist_make_shape(SoNode * shape, const SbVec3f & pos, const float transparency)
+{
+  SoSeparator * sep = new SoSeparator;
+  SoMaterial * mat = new SoMaterial;
+  mat->transparency = transparency;
+  SoTranslation * t = new SoTranslation;
+  t->translation = pos;
+  sep->addChild(mat);
+  sep->addChild(t);
+  sep->addChild(shape);
+  return sep;
+}
+
+BOOST_AUTO_TEST_CASE(cullAndClassify)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoPerspectiveCamera * camera = new SoPerspectiveCamera;
+  camera->position = SbVec3f(0.0f, 0.0f, 20.0f);
+  camera->nearDistance = 1.0f;
+  camera->farDistance = 1000.0f;
+  root->addChild(camera);
+
+  SoCube * opaque = new SoCube;
+  SoSphere * transparent = new SoSphere;
+  SoCube * outside = new SoCube;
+  root->addChild(sorenderlist_make_shape(opaque, SbVec3f(-2.0f, 0.0f, 0.0f), 0.0f));
+  root->addChild(sorenderlist_make_shape(transparent, SbVec3f(2.0f, 0.0f, 0.0f), 0.5f));
+  root->addChild(sorenderlist_make_shape(outside, SbVec3f(0.0f, 0.0f, 100.0f), 0.0f));
+
+  SoLOD * lod = new SoLOD;
+  lod->range.setValue(50.0f);
+  SoCube * nearshape = new SoCube;
+  lod->addChild(nearshape);
+  lod->addChild(new SoCone);
+  root->addChild(lod);
+
+  SoCallback * cb = new SoCallback;
+  root->addChild(cb);
+
+  SoRenderListAction listaction(SbViewportRegion(100, 100));
+  listaction.apply(root);
+
+  BOOST_REQUIRE(listaction.getNumEntries() == 4);
+  BOOST_CHECK_MESSAGE(listaction.getNumCulled() == 1, "shape behind the camera not culled");
+  BOOST_CHECK_MESSAGE(listaction.getNode(0) == opaque, "wrong first entry");
+  BOOST_CHECK_MESSAGE(!listaction.isTransparent(0), "opaque shape classified as transparent");
+  BOOST_CHECK_MESSAGE(listaction.getNode(1) == transparent, "wrong second entry");
+  BOOST_CHECK_MESSAGE(listaction.isTransparent(1), "transparent shape not classified");
+  BOOST_CHECK_MESSAGE(listaction.getNode(2) == nearshape, "wrong level of detail selected");
+  BOOST_CHECK_MESSAGE(listaction.getNode(3) == cb, "callback node not recorded");
+
+  const SbBox3f & box = listaction.getBoundingBox(0);
+  BOOST_CHECK_MESSAGE((box.getCenter() - SbVec3f(-2.0f, 0.0f, 0.0f)).length() < 1.0e-4f,
+                      "bounding box not in world coordinates");
+
+  SoPathList paths;
+  BOOST_CHECK_EQUAL(listaction.getPaths(paths), 0);
+  BOOST_REQUIRE(paths.getLength() == 4);
+  BOOST_CHECK_MESSAGE(static_cast<SoFullPath *>(paths[1])->getTail() == transparent,
+                      "wrong path to entry");
+
+  // stale entries should be skipped
+  root->removeChild(cb);
+  BOOST_CHECK_MESSAGE(listaction.createPath(3) == NULL, "stale entry not detected");
+  paths.truncate(0);
+  BOOST_CHECK_EQUAL(listaction.getPaths(paths), 1);
+
+  // from far away, the shape behind the camera becomes visible and
+  // the level-of-detail node selects its other child
+  camera->position = SbVec3f(0.0f, 0.0f, 200.0f);
+  listaction.apply(root);
+  BOOST_REQUIRE(listaction.getNumEntries() == 4);
+  BOOST_CHECK_MESSAGE(listaction.getNumCulled() == 0, "visible shape culled");
+  BOOST_CHECK_MESSAGE(listaction.getNode(2) == outside, "wrong third entry");
+  BOOST_CHECK_MESSAGE(listaction.getNode(3)->isOfType(SoCone::getClassTypeId()),
+                      "wrong level of detail selected");
+
+  root->unref();
+}
+
+BOOST_AUTO_TEST_CASE(sortByState)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoMaterial * red = new SoMaterial;
+  red->diffuseColor.setValue(1.0f, 0.0f, 0.0f);
+  SoMaterial * blue = new SoMaterial;
+  blue->diffuseColor.setValue(0.0f, 0.0f, 1.0f);
+
+  // alternating materials, the last shape with a shader program
+  for (int i = 0; i < 5; i++) {
+    SoSeparator * sep = new SoSeparator;
+    if (i == 4) sep->addChild(new SoShaderProgram);
+    sep->addChild((i % 2) ? blue : red);
+    sep->addChild(new SoCube);
+    root->addChild(sep);
+  }
+  // outside the separator of the shader program
+  root->addChild(new SoCube);
+
+  SoRenderListAction listaction(SbViewportRegion(100, 100));
+  listaction.apply(root);
+  BOOST_REQUIRE(listaction.getNumEntries() == 6);
+
+  const SoRenderListAction::StateKey material = SoRenderListAction::MATERIAL_KEY;
+  const SoRenderListAction::StateKey shader = SoRenderListAction::SHADER_KEY;
+  BOOST_CHECK_MESSAGE(listaction.getStateKey(0, material) == listaction.getStateKey(2, material),
+                      "shared material got different keys");
+  BOOST_CHECK_MESSAGE(listaction.getStateKey(0, material) != listaction.getStateKey(1, material),
+                      "different materials got the same key");
+  BOOST_CHECK_MESSAGE(listaction.getStateKey(4, shader) != 0, "shader program not tracked");
+  BOOST_CHECK_MESSAGE(listaction.getStateKey(5, shader) == 0, "shader program leaked out of separator");
+
+  SbList<int> entries;
+  listaction.getOpaqueShapes(entries, FALSE);
+  BOOST_REQUIRE(entries.getLength() == 6);
+  BOOST_CHECK_EQUAL(listaction.countStateChanges(entries, material), 5);
+  BOOST_CHECK_EQUAL(listaction.countStateChanges(entries, shader), 2);
+
+  listaction.getOpaqueShapes(entries, TRUE);
+  BOOST_REQUIRE(entries.getLength() == 6);
+  BOOST_CHECK_EQUAL(listaction.countStateChanges(entries, shader), 1);
+  BOOST_CHECK_MESSAGE(listaction.countStateChanges(entries, material) <= 3,
+                      "sorting did not reduce material changes");
+  BOOST_CHECK_MESSAGE(entries[entries.getLength()-1] == 4, "shader program not sorted last");
+
+  root->unref();
+}
+
+#endif // COIN_TEST_SUITE
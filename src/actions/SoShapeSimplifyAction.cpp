@@ -30,20 +30,113 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-// FIXME: this class has not yet been implemented in Coin. this is a
-// placeholder / stub / skeleton code, not yet built (nor installed,
-// obviously).  --mortene.
-
 /*!
   \class SoShapeSimplifyAction Inventor/include/SoShapeSimplifyAction.h
   \brief The SoShapeSimplifyAction class replaces complex primitives
   with simplified polygon representations.
+  \ingroup actions
+
+  Each shape with enough triangles (see
+  SoSimplifyAction::setMinTriangles()) is replaced by an SoLOD node
+  with one child per simplification level. The first level is
+  normally the original shape, and the other levels are
+  SoIndexedFaceSet nodes with fewer triangles. The shapes are
+  simplified in their own coordinate system, so a shape which is used
+  several places in the scene graph is only simplified once, and all
+  the places will use the same SoLOD node.
+
+  The scene graph is changed in place. Shapes are simplified in
+  parallel when more than one thread is allowed, see
+  SoSimplifyAction::setNumThreads().
+
+  \code
+  SoShapeSimplifyAction simplify;
+  const float levels[] = { 1.0f, 0.25f, 0.05f };
+  simplify.setSimplificationLevels(3, levels);
+  simplify.apply(root);
+  \endcode
+
+  Shapes inside nodekits, shapes with more than one material, and
+  shapes using multiple texture units are not simplified. Only
+  triangles are simplified; line and point shapes are left untouched.
+
+  \sa SoGlobalSimplifyAction
+  \since Coin 4.0
 */
 
-#include <Inventor/SbName.h>
 #include <Inventor/actions/SoShapeSimplifyAction.h>
-#include <coindefs.h> // COIN_STUB()
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbName.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoFullPath.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/elements/SoMultiTextureCoordinateElement.h>
+#include <Inventor/elements/SoMultiTextureEnabledElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoShape.h>
+
+#include "misc/SbHash.h"
+#include "coindefs.h" // COIN_UNUSED_ARG
+#include "misc/SbMeshDecimator.h"
+#include "SbBasicP.h"
+#include "actions/SoSubActionP.h"
+#include "actions/SoSimplifyActionP.h"
+
+// *************************************************************************
+
+class SoShapeSimplifyActionP {
+public:
+  SoShapeSimplifyActionP(void)
+    : cbaction(SbViewportRegion(640, 480)),
+      current(NULL),
+      numsimplified(0)
+  {
+    this->cbaction.addPreCallback(SoShape::getClassTypeId(), pre_shape_cb, this);
+    this->cbaction.addPostCallback(SoShape::getClassTypeId(), post_shape_cb, this);
+    this->cbaction.addTriangleCallback(SoShape::getClassTypeId(), triangle_cb, this);
+  }
+  ~SoShapeSimplifyActionP() {
+    this->clear();
+  }
+
+  struct ShapeData {
+    ShapeData(void) : shape(NULL), ok(TRUE), mesh(NULL) { }
+    ~ShapeData() { delete this->mesh; }
+    SoShape * shape;
+    SbBool ok;
+    SbMeshDecimator * mesh;
+    SbBox3f bbox;
+    SbList<SoGroup *> parents;
+  };
+
+  SoCallbackAction cbaction;
+  SbList<ShapeData *> shapes;
+  SbHash<const SoBase *, int> shapedict;
+  ShapeData * current;
+  int numsimplified;
+
+  static SoCallbackAction::Response pre_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node);
+  static SoCallbackAction::Response post_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node);
+  static void triangle_cb(void * userdata, SoCallbackAction * action,
+                          const SoPrimitiveVertex * v1,
+                          const SoPrimitiveVertex * v2,
+                          const SoPrimitiveVertex * v3);
+
+  void clear(void);
+};
+
+#define PRIVATE(obj) obj->pimpl
+
+// *************************************************************************
 
 SO_ACTION_SOURCE(SoShapeSimplifyAction);
 
@@ -61,7 +154,7 @@ SoShapeSimplifyAction::initClass(void)
 
 SoShapeSimplifyAction::SoShapeSimplifyAction(void)
 {
-  COIN_STUB();
+  SO_ACTION_CONSTRUCTOR(SoShapeSimplifyAction);
 }
 
 /*!
@@ -70,12 +163,255 @@ SoShapeSimplifyAction::SoShapeSimplifyAction(void)
 
 SoShapeSimplifyAction::~SoShapeSimplifyAction(void)
 {
-  COIN_STUB();
+}
+
+/*!
+  Returns the number of shapes which were replaced by SoLOD nodes by
+  the last apply().
+*/
+int
+SoShapeSimplifyAction::getNumSimplifiedShapes(void) const
+{
+  return PRIVATE(this)->numsimplified;
 }
 
 // Documented in superclass.
 void
-SoShapeSimplifyAction::beginTraversal(SoNode * /* node */)
+SoShapeSimplifyAction::beginTraversal(SoNode * node)
 {
-  COIN_STUB();
+  typedef SoShapeSimplifyActionP::ShapeData ShapeData;
+  SoShapeSimplifyActionP * thisp = &PRIVATE(this).get();
+  thisp->clear();
+  thisp->numsimplified = 0;
+
+  switch (this->getWhatAppliedTo()) {
+  case SoAction::NODE:
+    thisp->cbaction.apply(node);
+    break;
+  case SoAction::PATH:
+    thisp->cbaction.apply(this->getPathAppliedTo());
+    break;
+  case SoAction::PATH_LIST:
+    thisp->cbaction.apply(*this->getPathListAppliedTo(), TRUE);
+    break;
+  default:
+    assert(0 && "unknown apply code");
+    break;
+  }
+
+  // the levels below 1.0 are generated by the decimator
+  const int numlevels = this->getNumSimplificationLevels();
+  const float * levels = this->getSimplificationLevels();
+  SbList<float> ratios;
+  int i, j;
+  for (i = 0; i < numlevels; i++) {
+    if (levels[i] < 1.0f) ratios.append(levels[i]);
+  }
+
+  SbList<ShapeData *> jobs;
+  SbList<SbMeshDecimator *> meshes;
+  for (i = 0; i < thisp->shapes.getLength(); i++) {
+    ShapeData * data = thisp->shapes[i];
+    if (!data->ok || data->mesh == NULL || data->parents.getLength() == 0) continue;
+    if (data->mesh->getNumTriangles() < this->getMinTriangles()) continue;
+    data->mesh->setLevels(ratios.getLength(), ratios.getArrayPtr());
+    jobs.append(data);
+    meshes.append(data->mesh);
+  }
+  if (jobs.getLength() == 0 || ratios.getLength() == 0) {
+    thisp->clear();
+    return;
+  }
+
+  SbMeshDecimator::decimate(meshes.getArrayPtr(), meshes.getLength(),
+                            this->getNumThreads());
+
+  for (i = 0; i < jobs.getLength(); i++) {
+    ShapeData * data = jobs[i];
+    SbVec3f center = data->bbox.getCenter();
+    float dx, dy, dz;
+    data->bbox.getSize(dx, dy, dz);
+    const float radius = SbVec3f(dx, dy, dz).length() * 0.5f;
+
+    SoLOD * lod = SoSimplifyActionP::createLOD(this, center, radius);
+    lod->ref();
+    int level = 0;
+    for (j = 0; j < numlevels; j++) {
+      if (levels[j] >= 1.0f) lod->addChild(data->shape);
+      else lod->addChild(SoSimplifyActionP::createShape(data->mesh, level++));
+    }
+    for (j = 0; j < data->parents.getLength(); j++) {
+      SoGroup * parent = data->parents[j];
+      int idx;
+      while ((idx = parent->findChild(data->shape)) >= 0) {
+        parent->replaceChild(idx, lod);
+      }
+    }
+    lod->unrefNoDelete();
+    thisp->numsimplified++;
+  }
+  thisp->clear();
 }
+
+// *************************************************************************
+
+SoCallbackAction::Response
+SoShapeSimplifyActionP::pre_shape_cb(void * userdata, SoCallbackAction * action, const SoNode * node)
+{
+  SoShapeSimplifyActionP * thisp = static_cast<SoShapeSimplifyActionP *>(userdata);
+  const SoFullPath * path = reclassify_cast<const SoFullPath *>(action->getCurPath());
+  const int len = path->getLength();
+
+  // only shapes below normal groups can be replaced, not shapes
+  // inside nodekits or other nodes with hidden children
+  SoNode * parent = len > 1 ? path->getNodeFromTail(1) : NULL;
+  if (parent == NULL) return SoCallbackAction::PRUNE;
+  for (int i = 0; i < len - 1; i++) {
+    if (!path->getNode(i)->isOfType(SoGroup::getClassTypeId())) {
+      return SoCallbackAction::PRUNE;
+    }
+  }
+
+  ShapeData * data;
+  int idx;
+  if (thisp->shapedict.get(node, idx)) {
+    // the shape has already been collected
+    data = thisp->shapes[idx];
+    if (data->parents.find(coin_assert_cast<SoGroup *>(parent)) < 0) {
+      data->parents.append(coin_assert_cast<SoGroup *>(parent));
+    }
+    return SoCallbackAction::PRUNE;
+  }
+
+  data = new ShapeData;
+  data->shape = coin_assert_cast<SoShape *>(const_cast<SoNode *>(node));
+  data->parents.append(coin_assert_cast<SoGroup *>(parent));
+  thisp->shapedict.put(node, thisp->shapes.getLength());
+  thisp->shapes.append(data);
+
+  int lastenabled = -1;
+  (void) SoMultiTextureEnabledElement::getEnabledUnits(action->getState(), lastenabled);
+  if (lastenabled > 0) {
+    data->ok = FALSE;
+    return SoCallbackAction::PRUNE;
+  }
+  thisp->current = data;
+  return SoCallbackAction::CONTINUE;
+}
+
+SoCallbackAction::Response
+SoShapeSimplifyActionP::post_shape_cb(void * userdata, SoCallbackAction * COIN_UNUSED_ARG(action), const SoNode * COIN_UNUSED_ARG(node))
+{
+  static_cast<SoShapeSimplifyActionP *>(userdata)->current = NULL;
+  return SoCallbackAction::CONTINUE;
+}
+
+void
+SoShapeSimplifyActionP::triangle_cb(void * userdata, SoCallbackAction * action,
+                                    const SoPrimitiveVertex * v1,
+                                    const SoPrimitiveVertex * v2,
+                                    const SoPrimitiveVertex * v3)
+{
+  SoShapeSimplifyActionP * thisp = static_cast<SoShapeSimplifyActionP *>(userdata);
+  ShapeData * data = thisp->current;
+  if (data == NULL || !data->ok) return;
+
+  const SoPrimitiveVertex * v[3] = { v1, v2, v3 };
+  int i;
+  for (i = 0; i < 3; i++) {
+    if (v[i]->getMaterialIndex() != 0) { data->ok = FALSE; return; }
+  }
+
+  if (data->mesh == NULL) {
+    // generated texture coordinates are generated for the simplified
+    // shape too, so only explicit texture coordinates must be kept
+    SoState * state = action->getState();
+    const SbBool textured =
+      SoMultiTextureEnabledElement::getMode(state, 0) == SoMultiTextureEnabledElement::TEXTURE2D &&
+      SoMultiTextureCoordinateElement::getType(state, 0) !=
+      SoMultiTextureCoordinateElement::TEXGEN;
+    data->mesh = new SbMeshDecimator(TRUE, textured);
+  }
+
+  int idx[3];
+  for (i = 0; i < 3; i++) {
+    const SbVec4f & tc = v[i]->getTextureCoords();
+    SbVec2f t(tc[0], tc[1]);
+    if (tc[3] != 0.0f) t /= tc[3];
+    idx[i] = data->mesh->addVertex(v[i]->getPoint(), v[i]->getNormal(), t);
+    data->bbox.extendBy(v[i]->getPoint());
+  }
+  data->mesh->addTriangle(idx[0], idx[1], idx[2]);
+}
+
+void
+SoShapeSimplifyActionP::clear(void)
+{
+  for (int i = 0; i < this->shapes.getLength(); i++) {
+    delete this->shapes[i];
+  }
+  this->shapes.truncate(0);
+  this->shapedict.clear();
+  this->current = NULL;
+}
+
+#undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoShapeSimplifyAction.h>
+#include <Inventor/nodes/SoComplexity.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+
+BOOST_AUTO_TEST_CASE(simplifySphere)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoComplexity * complexity = new SoComplexity;
+  complexity->value = 1.0f;
+  root->addChild(complexity);
+  SoSphere * sphere = new SoSphere;
+  root->addChild(sphere);
+
+  SbViewportRegion vp(100, 100);
+  SoGetPrimitiveCountAction pcaction(vp);
+  pcaction.apply(root);
+  const int numtriangles = pcaction.getTriangleCount();
+
+  SoShapeSimplifyAction simplify;
+  const float levels[] = { 1.0f, 0.5f, 0.1f };
+  simplify.setSimplificationLevels(3, levels);
+  simplify.apply(root);
+
+  BOOST_CHECK_MESSAGE(simplify.getNumSimplifiedShapes() == 1, "sphere not simplified");
+  BOOST_REQUIRE(root->getChild(1)->isOfType(SoLOD::getClassTypeId()));
+  SoLOD * lod = static_cast<SoLOD *>(root->getChild(1));
+  BOOST_REQUIRE(lod->getNumChildren() == 3);
+  BOOST_CHECK_MESSAGE(lod->getChild(0) == sphere, "first level should be the original shape");
+  BOOST_CHECK_MESSAGE(lod->range.getNum() == 2, "wrong number of ranges");
+
+  SoGetBoundingBoxAction bbaction(vp);
+  for (int i = 1; i < 3; i++) {
+    pcaction.apply(lod->getChild(i));
+    const int num = pcaction.getTriangleCount();
+    BOOST_CHECK_MESSAGE(num <= levels[i] * numtriangles + 2 && num > levels[i] * numtriangles * 0.5f,
+                        "wrong number of triangles in simplified level");
+
+    // the simplified sphere should stay close to the original
+    bbaction.apply(lod->getChild(i));
+    const SbVec3f size = bbaction.getBoundingBox().getMax() - bbaction.getBoundingBox().getMin();
+    for (int j = 0; j < 3; j++) {
+      BOOST_CHECK_MESSAGE(size[j] > 1.8f && size[j] < 2.02f, "simplified sphere lost its shape");
+    }
+  }
+  root->unref();
+}
+
+#endif // COIN_TEST_SUITE
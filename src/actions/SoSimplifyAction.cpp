@@ -34,18 +34,34 @@
   \class SoSimplifyAction Inventor/include/SoSimplifyAction.h
   \brief The SoSimplifyAction class is the base class for the simplify
   action classes.
+
+  The simplify actions generate SoLOD nodes with simplified versions
+  of the geometry in a scene graph. The geometry is simplified by
+  repeatedly collapsing the edge which changes the surface the least,
+  measured with quadric error metrics. The settings in this class
+  control the number of levels, the number of triangles in each
+  level, and the distances where the levels are switched.
+
+  \sa SoShapeSimplifyAction, SoGlobalSimplifyAction
 */
 
 #include <Inventor/actions/SoSimplifyAction.h>
 
+#include <cmath>
+
 #include <Inventor/SbName.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoLOD.h>
+#include <Inventor/nodes/SoMaterialBinding.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoVertexProperty.h>
 
 #include "coindefs.h" // COIN_STUB()
 #include "actions/SoSubActionP.h"
+#include "actions/SoSimplifyActionP.h"
+#include "misc/SbMeshDecimator.h"
 
-class SoSimplifyActionP {
-public:
-};
+#define PRIVATE(obj) obj->pimpl
 
 SO_ACTION_SOURCE(SoSimplifyAction);
 
@@ -63,6 +79,11 @@ SoSimplifyAction::initClass(void)
 
 SoSimplifyAction::SoSimplifyAction(void)
 {
+  static const float defaultlevels[] = { 1.0f, 0.3f, 0.1f };
+  this->setSimplificationLevels(3, defaultlevels);
+  PRIVATE(this)->sizefactor = 10.0f;
+  PRIVATE(this)->mintriangles = 64;
+  PRIVATE(this)->numthreads = 4;
 }
 
 /*!
@@ -97,3 +118,216 @@ SoSimplifyAction::apply(const SoPathList & pathlist, SbBool obeysrules)
 {
   inherited::apply(pathlist, obeysrules);
 }
+
+/*!
+  Sets the simplification levels to generate. Each level is given as
+  the fraction of the original number of triangles to keep, and the
+  levels should be sorted from the most to the least detailed. A
+  level of 1.0 or more uses the original geometry.
+
+  The default levels are 1.0, 0.3 and 0.1.
+*/
+void
+SoSimplifyAction::setSimplificationLevels(const int num, const float levels[])
+{
+  PRIVATE(this)->levels.truncate(0);
+  for (int i = 0; i < num; i++) {
+    PRIVATE(this)->levels.append(SbMax(levels[i], 0.0f));
+  }
+}
+
+/*!
+  Returns the simplification levels.
+*/
+const float *
+SoSimplifyAction::getSimplificationLevels(void) const
+{
+  return PRIVATE(this)->levels.getArrayPtr();
+}
+
+/*!
+  Returns the number of simplification levels.
+*/
+int
+SoSimplifyAction::getNumSimplificationLevels(void) const
+{
+  return PRIVATE(this)->levels.getLength();
+}
+
+/*!
+  Sets the ranges of the generated SoLOD nodes. See SoLOD::range. The
+  number of ranges should be one less than the number of
+  simplification levels. If not, the ranges will be calculated from
+  the size of the geometry, see setSizeFactor().
+
+  No ranges are set by default.
+*/
+void
+SoSimplifyAction::setRanges(const int num, const float ranges[])
+{
+  PRIVATE(this)->ranges.truncate(0);
+  for (int i = 0; i < num; i++) {
+    PRIVATE(this)->ranges.append(ranges[i]);
+  }
+}
+
+/*!
+  Returns the ranges set with setRanges().
+*/
+const float *
+SoSimplifyAction::getRanges(void) const
+{
+  return PRIVATE(this)->ranges.getArrayPtr();
+}
+
+/*!
+  Returns the number of ranges set with setRanges().
+*/
+int
+SoSimplifyAction::getNumRanges(void) const
+{
+  return PRIVATE(this)->ranges.getLength();
+}
+
+/*!
+  Sets the factor used for calculating SoLOD ranges when no ranges
+  have been set. The level which keeps the fraction \a r of the
+  triangles is used from the distance \a size * radius / sqrt(\a r),
+  where radius is the radius of the bounding sphere of the
+  geometry. Larger values make the action switch to the simplified
+  levels further away from the camera.
+
+  The default value is 10.
+*/
+void
+SoSimplifyAction::setSizeFactor(const float size)
+{
+  PRIVATE(this)->sizefactor = size;
+}
+
+/*!
+  Returns the size factor.
+*/
+float
+SoSimplifyAction::getSizeFactor(void) const
+{
+  return PRIVATE(this)->sizefactor;
+}
+
+/*!
+  Sets the smallest number of triangles in a shape for it to be
+  simplified. The default value is 64.
+*/
+void
+SoSimplifyAction::setMinTriangles(const int num)
+{
+  PRIVATE(this)->mintriangles = num;
+}
+
+/*!
+  Returns the smallest number of triangles in a shape for it to be
+  simplified.
+*/
+int
+SoSimplifyAction::getMinTriangles(void) const
+{
+  return PRIVATE(this)->mintriangles;
+}
+
+/*!
+  Sets the number of threads used for simplifying shapes. Different
+  shapes are simplified in parallel. A value of 1 or less will make
+  the action simplify everything in the calling thread.
+
+  The default value is 4. Threads are not used if Coin was built
+  without thread support.
+*/
+void
+SoSimplifyAction::setNumThreads(const int num)
+{
+  PRIVATE(this)->numthreads = num;
+}
+
+/*!
+  Returns the number of threads used for simplifying shapes.
+*/
+int
+SoSimplifyAction::getNumThreads(void) const
+{
+  return PRIVATE(this)->numthreads;
+}
+
+// *************************************************************************
+
+// Creates a shape for the given level of the simplified mesh.
+SoNode *
+SoSimplifyActionP::createShape(const SbMeshDecimator * mesh, const int level)
+{
+  const SbList<SbVec3f> & points = mesh->getPoints(level);
+  const SbList<SbVec3f> & normals = mesh->getNormals(level);
+  const SbList<SbVec2f> & texcoords = mesh->getTexCoords(level);
+  const SbList<int32_t> & triangles = mesh->getTriangles(level);
+
+  SoVertexProperty * vp = new SoVertexProperty;
+  vp->vertex.setValues(0, points.getLength(), points.getArrayPtr());
+  vp->normal.setValues(0, normals.getLength(), normals.getArrayPtr());
+  vp->texCoord.setValues(0, texcoords.getLength(), texcoords.getArrayPtr());
+  vp->normalBinding = SoVertexProperty::PER_VERTEX_INDEXED;
+  vp->materialBinding = SoVertexProperty::OVERALL;
+
+  SoIndexedFaceSet * ifs = new SoIndexedFaceSet;
+  ifs->vertexProperty = vp;
+  const int numtri = triangles.getLength() / 3;
+  ifs->coordIndex.setNum(numtri * 4);
+  int32_t * idx = ifs->coordIndex.startEditing();
+  for (int i = 0; i < numtri; i++) {
+    idx[i*4] = triangles[i*3];
+    idx[i*4+1] = triangles[i*3+1];
+    idx[i*4+2] = triangles[i*3+2];
+    idx[i*4+3] = -1;
+  }
+  ifs->coordIndex.finishEditing();
+  ifs->normalIndex.setNum(0);
+  ifs->materialIndex.setNum(0);
+  ifs->textureCoordIndex.setNum(0);
+
+  // SoVertexProperty doesn't set the material binding when it has no
+  // colors
+  SoSeparator * sep = new SoSeparator;
+  SoMaterialBinding * mb = new SoMaterialBinding;
+  mb->value = SoMaterialBinding::OVERALL;
+  sep->addChild(mb);
+  sep->addChild(ifs);
+  return sep;
+}
+
+// Creates an SoLOD node without children, with the ranges for the
+// action's simplification levels.
+SoLOD *
+SoSimplifyActionP::createLOD(const SoSimplifyAction * action,
+                             const SbVec3f & center, const float radius)
+{
+  SoLOD * lod = new SoLOD;
+  lod->center = center;
+
+  const int numlevels = action->getNumSimplificationLevels();
+  const float * levels = action->getSimplificationLevels();
+  if (action->getNumRanges() == numlevels - 1) {
+    lod->range.setValues(0, numlevels - 1, action->getRanges());
+  }
+  else {
+    lod->range.setNum(numlevels - 1);
+    float * range = lod->range.startEditing();
+    float prev = 0.0f;
+    for (int i = 1; i < numlevels; i++) {
+      const float r = levels[i] > 0.0f ? levels[i] : 1.0e-4f;
+      range[i-1] = SbMax(prev, action->getSizeFactor() * radius /
+                         static_cast<float>(sqrt(SbMin(r, 1.0f))));
+      prev = range[i-1];
+    }
+    lod->range.finishEditing();
+  }
+  return lod;
+}
+
+#undef PRIVATE
@@ -49,8 +49,12 @@
 #include "SoPickAction.cpp"
 #include "SoRayPickAction.cpp"
 #include "SoReorganizeAction.cpp"
+#include "SoBatchMergeAction.cpp"
+#include "SoRenderListAction.cpp"
 #include "SoSearchAction.cpp"
 #include "SoSimplifyAction.cpp"
+#include "SoGlobalSimplifyAction.cpp"
+#include "SoShapeSimplifyAction.cpp"
 #include "SoToVRMLAction.cpp"
 #include "SoWriteAction.cpp"
 #include "SoAudioRenderAction.cpp"
@@ -0,0 +1,402 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+/*!
+  \class SbExternalBuffer SbExternalBuffer.h Inventor/SbExternalBuffer.h
+  \brief The SbExternalBuffer class is a reference counted block of application memory.
+  \ingroup base
+
+  An SbExternalBuffer wraps memory which Coin does not own, like the
+  result arrays of a simulation or a memory mapped file, so that it
+  can be used as the values of multi-fields without being copied. See
+  for instance SoMFVec3f::setValuesBuffer().
+
+  The buffer is reference counted like nodes are: it is destructed
+  when the last reference to it goes away, and each field using it
+  holds a reference. The memory is handed back to the application
+  through the release callback at that point, so the application does
+  not need to keep track of which fields still use it.
+
+  A READ_ONLY buffer is never written to by Coin. A field using it
+  gets a copy of its own the first time it is changed. A READ_WRITE
+  buffer is written to in place by changes to a field which is the
+  only user of the buffer, as long as the number of values stays the
+  same.
+
+  \code
+  SbExternalBuffer * buffer = SbExternalBuffer::mapFile("points.bin");
+  if (buffer) {
+    SoCoordinate3 * coords = new SoCoordinate3;
+    coords->point.setValuesBuffer(int(buffer->getSize() / sizeof(SbVec3f)), buffer);
+  }
+  \endcode
+
+  \COIN_CLASS_EXTENSION
+
+  \since Coin 4.0
+*/
+
+/*! \file SbExternalBuffer.h */
+#include <Inventor/SbExternalBuffer.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cstdio>
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif // HAVE_SYS_TYPES_H
+
+#if defined(HAVE_UNISTD_H) && defined(HAVE_SYS_STAT_H) && !defined(_WIN32)
+#define SBEXTERNALBUFFER_MMAP
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <Inventor/errors/SoDebugError.h>
+
+#include "threads/atomicp.h"
+#include "coindefs.h"
+
+// *************************************************************************
+
+class SbExternalBufferP {
+public:
+  void * data;
+  size_t size;
+  SbExternalBuffer::Access access;
+  SbExternalBuffer::ReleaseCB * releasecb;
+  void * closure;
+  SbBool mapped;
+  volatile int32_t refcount;
+};
+
+#define PRIVATE(obj) ((obj)->pimpl)
+
+// *************************************************************************
+
+/*!
+  \enum SbExternalBuffer::Access
+  Whether Coin may write to the buffer.
+*/
+/*!
+  \var SbExternalBuffer::Access SbExternalBuffer::READ_ONLY
+  The buffer is never written to. Fields using it copy the values
+  before changing them.
+*/
+/*!
+  \var SbExternalBuffer::Access SbExternalBuffer::READ_WRITE
+  Fields using the buffer may change the values in place.
+*/
+/*!
+  \typedef void SbExternalBuffer::ReleaseCB(void * closure, void * data, size_t size)
+  The type of the callback which is called with the memory of the
+  buffer when the buffer is destructed.
+*/
+
+// *************************************************************************
+
+/*!
+  Constructor. Wraps the \a size bytes at \a data, which must stay
+  valid until \a releasecb is called with \a closure, \a data and \a
+  size, when the last reference to the buffer goes away. Without a
+  release callback, the application must make sure the memory
+  outlives the buffer.
+
+  The buffer starts out with a reference count of zero, like nodes
+  do, and must be referenced with ref() unless it is passed directly
+  on to a field.
+*/
+SbExternalBuffer::SbExternalBuffer(void * data, const size_t size,
+                                   const Access access,
+                                   ReleaseCB * releasecb, void * closure)
+{
+  PRIVATE(this) = new SbExternalBufferP;
+  PRIVATE(this)->data = data;
+  PRIVATE(this)->size = data ? size : 0;
+  PRIVATE(this)->access = access;
+  PRIVATE(this)->releasecb = releasecb;
+  PRIVATE(this)->closure = closure;
+  PRIVATE(this)->mapped = FALSE;
+  PRIVATE(this)->refcount = 0;
+}
+
+// Never called, SbExternalBuffer instances can not be copied.
+SbExternalBuffer::SbExternalBuffer(const SbExternalBuffer & COIN_UNUSED_ARG(buffer))
+{
+  assert(FALSE);
+}
+
+// Never called, SbExternalBuffer instances can not be copied.
+SbExternalBuffer &
+SbExternalBuffer::operator=(const SbExternalBuffer & COIN_UNUSED_ARG(buffer))
+{
+  assert(FALSE);
+  return *this;
+}
+
+/*!
+  Destructor, called from unref(). Hands the memory back to the
+  application through the release callback.
+*/
+SbExternalBuffer::~SbExternalBuffer()
+{
+  if (PRIVATE(this)->releasecb) {
+    PRIVATE(this)->releasecb(PRIVATE(this)->closure,
+                             PRIVATE(this)->data, PRIVATE(this)->size);
+  }
+  delete PRIVATE(this);
+}
+
+#ifdef SBEXTERNALBUFFER_MMAP
+static void
+sbexternalbuffer_unmap(void * COIN_UNUSED_ARG(closure), void * data, size_t size)
+{
+  (void) munmap(data, size);
+}
+#endif // SBEXTERNALBUFFER_MMAP
+
+static void
+sbexternalbuffer_delete(void * COIN_UNUSED_ARG(closure), void * data,
+                        size_t COIN_UNUSED_ARG(size))
+{
+  delete[] static_cast<unsigned char *>(data);
+}
+
+/*!
+  Returns a buffer with the contents of \a filename, or \c NULL if
+  the file could not be read.
+
+  Where the platform supports it, the file is mapped into memory
+  instead of read, so that only the parts of it which are used are
+  loaded, and so that changes to a READ_WRITE buffer are written back
+  to the file. Otherwise the file is read into memory, and changes
+  are not written back. See isMapped().
+*/
+SbExternalBuffer *
+SbExternalBuffer::mapFile(const char * filename, const Access access)
+{
+  FILE * fp = fopen(filename, access == READ_WRITE ? "r+b" : "rb");
+  if (!fp) {
+    SoDebugError::postWarning("SbExternalBuffer::mapFile",
+                              "Could not open '%s'.", filename);
+    return NULL;
+  }
+  long size = -1;
+  if (fseek(fp, 0, SEEK_END) == 0) size = ftell(fp);
+  if (size < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+    SoDebugError::postWarning("SbExternalBuffer::mapFile",
+                              "Could not find the size of '%s'.", filename);
+    fclose(fp);
+    return NULL;
+  }
+  if (size == 0) {
+    fclose(fp);
+    return new SbExternalBuffer(NULL, 0, access);
+  }
+
+#ifdef SBEXTERNALBUFFER_MMAP
+  const int prot = PROT_READ | (access == READ_WRITE ? PROT_WRITE : 0);
+  void * p = mmap(NULL, (size_t) size, prot, MAP_SHARED, fileno(fp), 0);
+  if (p != MAP_FAILED) {
+    // the mapping stays valid after the file is closed
+    fclose(fp);
+    SbExternalBuffer * buffer =
+      new SbExternalBuffer(p, (size_t) size, access, sbexternalbuffer_unmap, NULL);
+    PRIVATE(buffer)->mapped = TRUE;
+    return buffer;
+  }
+#endif // SBEXTERNALBUFFER_MMAP
+
+  unsigned char * data = new unsigned char[size];
+  const size_t numread = fread(data, 1, (size_t) size, fp);
+  fclose(fp);
+  if (numread != (size_t) size) {
+    SoDebugError::postWarning("SbExternalBuffer::mapFile",
+                              "Could not read '%s'.", filename);
+    delete[] data;
+    return NULL;
+  }
+  return new SbExternalBuffer(data, (size_t) size, access,
+                              sbexternalbuffer_delete, NULL);
+}
+
+// *************************************************************************
+
+/*!
+  Increases the reference count of the buffer.
+*/
+void
+SbExternalBuffer::ref(void) const
+{
+  (void) cc_atomic_add32(&PRIVATE(this)->refcount, 1);
+}
+
+/*!
+  Decreases the reference count of the buffer, and destructs it when
+  the count reaches zero.
+*/
+void
+SbExternalBuffer::unref(void) const
+{
+  const int32_t count = cc_atomic_add32(&PRIVATE(this)->refcount, -1);
+  assert(count >= 0);
+  if (count == 0) delete const_cast<SbExternalBuffer *>(this);
+}
+
+/*!
+  Returns the reference count of the buffer.
+*/
+int32_t
+SbExternalBuffer::getRefCount(void) const
+{
+  return cc_atomic_load32(&PRIVATE(this)->refcount);
+}
+
+// *************************************************************************
+
+/*!
+  Returns the memory of the buffer.
+*/
+const void *
+SbExternalBuffer::getData(void) const
+{
+  return PRIVATE(this)->data;
+}
+
+/*!
+  Returns the memory of the buffer for writing, or \c NULL for a
+  READ_ONLY buffer.
+
+  Fields using the buffer are not notified when it is changed through
+  this pointer. Call SoField::touch() on them afterwards.
+*/
+void *
+SbExternalBuffer::getWritableData(void) const
+{
+  return PRIVATE(this)->access == READ_WRITE ? PRIVATE(this)->data : NULL;
+}
+
+/*!
+  Returns the size of the buffer in bytes.
+*/
+size_t
+SbExternalBuffer::getSize(void) const
+{
+  return PRIVATE(this)->size;
+}
+
+/*!
+  Returns whether the buffer may be written to.
+*/
+SbExternalBuffer::Access
+SbExternalBuffer::getAccess(void) const
+{
+  return PRIVATE(this)->access;
+}
+
+/*!
+  Returns \c TRUE for a READ_WRITE buffer.
+*/
+SbBool
+SbExternalBuffer::isWritable(void) const
+{
+  return PRIVATE(this)->access == READ_WRITE;
+}
+
+/*!
+  Returns \c TRUE if the buffer is a file mapped into memory by
+  mapFile().
+*/
+SbBool
+SbExternalBuffer::isMapped(void) const
+{
+  return PRIVATE(this)->mapped;
+}
+
+#undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <cstring>
+
+static void
+release_cb(void * closure, void * data, size_t size)
+{
+  *static_cast<size_t *>(closure) = size;
+  delete[] static_cast<float *>(data);
+}
+
+BOOST_AUTO_TEST_CASE(releaseOnLastUnref)
+{
+  size_t released = 0;
+  float * data = new float[16];
+  SbExternalBuffer * buffer =
+    new SbExternalBuffer(data, 16 * sizeof(float), SbExternalBuffer::READ_ONLY,
+                         release_cb, &released);
+  buffer->ref();
+  buffer->ref();
+  BOOST_CHECK_EQUAL(buffer->getRefCount(), 2);
+  BOOST_CHECK(buffer->getData() == data);
+  BOOST_CHECK(buffer->getWritableData() == NULL);
+  buffer->unref();
+  BOOST_CHECK_EQUAL(released, size_t(0));
+  buffer->unref();
+  BOOST_CHECK_EQUAL(released, 16 * sizeof(float));
+}
+
+BOOST_AUTO_TEST_CASE(mapFile)
+{
+  const char * filename = "sbexternalbuffer-test.bin";
+  const float values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  FILE * fp = fopen(filename, "wb");
+  BOOST_REQUIRE(fp != NULL);
+  BOOST_REQUIRE(fwrite(values, sizeof(float), 4, fp) == 4);
+  fclose(fp);
+
+  SbExternalBuffer * buffer = SbExternalBuffer::mapFile(filename);
+  BOOST_REQUIRE(buffer != NULL);
+  buffer->ref();
+  BOOST_CHECK_EQUAL(buffer->getSize(), sizeof(values));
+  BOOST_CHECK(memcmp(buffer->getData(), values, sizeof(values)) == 0);
+  buffer->unref();
+  (void) remove(filename);
+}
+
+#endif // COIN_TEST_SUITE
@@ -377,3 +377,36 @@ SbName::empty(void) // static
   }
   return *emptyname;
 }
+
+#ifdef COIN_TEST_SUITE
+#include <Inventor/SbName.h>
+#include <Inventor/SbString.h>
+
+BOOST_AUTO_TEST_CASE(permanentAddresses)
+{
+  // enough names to make the name table grow a few times
+  const int numnames = 50000;
+  const char ** addresses = new const char *[numnames];
+  for (int i = 0; i < numnames; i++) {
+    SbString str;
+    str.sprintf("SbName_permanentAddresses_%d", i);
+    addresses[i] = SbName(str).getString();
+  }
+
+  int moved = 0, wrong = 0;
+  for (int i = 0; i < numnames; i++) {
+    SbString str;
+    str.sprintf("SbName_permanentAddresses_%d", i);
+    const SbName name(str);
+    if (name.getString() != addresses[i]) moved++;
+    if (str != name.getString()) wrong++;
+  }
+  delete[] addresses;
+
+  BOOST_CHECK_MESSAGE(moved == 0, "equal names should have the same address");
+  BOOST_CHECK_MESSAGE(wrong == 0, "names should keep their contents");
+  BOOST_CHECK_MESSAGE(SbName("").getString() == SbName::empty().getString(),
+                      "empty name should be unique");
+}
+
+#endif // COIN_TEST_SUITE
@@ -65,6 +65,7 @@
 #include "SbGLUTessellator.cpp"
 #include "SbTime.cpp"
 #include "SbByteBuffer.cpp"
+#include "SbExternalBuffer.cpp"
 
 #include "SbVec2b.cpp"
 #include "SbVec2ub.cpp"
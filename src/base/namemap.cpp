@@ -37,13 +37,15 @@
 #include <cstring>
 
 #include "threads/threadsutilp.h"
+#include "threads/atomicp.h"
 #include "tidbitsp.h"
 #include "coindefs.h"
 
 #ifndef COIN_WORKAROUND_NO_USING_STD_FUNCS
 using std::malloc;
+using std::calloc;
 using std::free;
-using std::strcpy;
+using std::memcpy;
 using std::strlen;
 using std::strcmp;
 #endif // !COIN_WORKAROUND_NO_USING_STD_FUNCS
@@ -63,10 +65,34 @@ using std::strcmp;
   mortene.
 */
 
+/*
+  The table is an open addressing hash table (linear probing) of
+  string addresses, which grows when it gets half full. Each string
+  is stored in chunk memory right after its 32-bit hash value, so the
+  table can be rehashed without touching the strings, and the string
+  addresses never change.
+
+  Lookups of existing names do not lock. Slots only ever go from NULL
+  to a string address, and a string is completely written before its
+  address is stored in a slot.
+
+  Inserts lock one of NUM_SHARDS mutexes, picked from the hash value,
+  so the same string is never inserted twice, while different strings
+  can be inserted in parallel. A slot is claimed with compare-and-swap
+  as other shards may probe into it at the same time. The string
+  memory chunks are per shard.
+
+  Growing the table locks all shards. The old slot arrays are not
+  freed until exit, as lookups in other threads may still be reading
+  them.
+*/
+
 /* ************************************************************************* */
 
 #define CHUNK_SIZE (65536-32)
-static const unsigned int NAME_TABLE_SIZE = 1999;
+#define NUM_SHARDS 16
+#define SHARD_SHIFT 28 /* picks the top 4 bits of the hash value */
+static const unsigned int INITIAL_TABLE_SIZE = 2048; /* must be a power of two */
 
 struct NamemapMemChunk {
   char mem[CHUNK_SIZE];
@@ -75,15 +101,23 @@ struct NamemapMemChunk {
   struct NamemapMemChunk * next;
 };
 
-struct NamemapBucketEntry {
-  unsigned long hashvalue;
-  const char * str;
-  struct NamemapBucketEntry * next;
+struct NamemapTable {
+  unsigned int size;
+  void * volatile * slots;
+  struct NamemapTable * prev; /* the smaller tables this replaced */
+};
+
+struct NamemapShard {
+  void * mutex;
+  struct NamemapMemChunk * headchunk;
 };
 
-static void * access_mutex = NULL;
-static struct NamemapBucketEntry ** nametable = NULL;
-static struct NamemapMemChunk * headchunk = NULL;
+static void * init_mutex = NULL;
+static void * volatile nametable = NULL; /* struct NamemapTable * */
+static volatile int32_t numnames = 0;
+static struct NamemapShard shards[NUM_SHARDS];
+
+#define NAMEMAP_HASH(_str_) (reinterpret_cast<const uint32_t *>(_str_)[-1])
 
 /* ************************************************************************* */
 
@@ -93,107 +127,206 @@ extern "C" {
 static void
 namemap_cleanup(void)
 {
-  unsigned int i;
-
-  struct NamemapMemChunk * chunkptr = headchunk;
-  while (chunkptr) {
-    struct NamemapMemChunk * next = chunkptr->next;
-    free(chunkptr);
-    chunkptr = next;
+  int i;
+
+  struct NamemapTable * table = static_cast<struct NamemapTable *>(nametable);
+  while (table) {
+    struct NamemapTable * prev = table->prev;
+    free(const_cast<void **>(table->slots));
+    free(table);
+    table = prev;
   }
-  
-  for (i = 0; i < NAME_TABLE_SIZE; i++) {
-    struct NamemapBucketEntry * entry = nametable[i];
-    while (entry) {
-      struct NamemapBucketEntry * next = entry->next;
-      free(entry);
-      entry = next;
+  nametable = NULL;
+  numnames = 0;
+
+  for (i = 0; i < NUM_SHARDS; i++) {
+    struct NamemapMemChunk * chunkptr = shards[i].headchunk;
+    while (chunkptr) {
+      struct NamemapMemChunk * next = chunkptr->next;
+      free(chunkptr);
+      chunkptr = next;
     }
+    shards[i].headchunk = NULL;
+    CC_MUTEX_DESTRUCT(shards[i].mutex);
   }
-  free(nametable);
-  nametable = static_cast<struct NamemapBucketEntry **>(NULL);
 
-  CC_MUTEX_DESTRUCT(access_mutex);
+  CC_MUTEX_DESTRUCT(init_mutex);
 }
 
 } // extern "C"
 
+static struct NamemapTable *
+namemap_create_table(unsigned int size)
+{
+  struct NamemapTable * table = static_cast<struct NamemapTable *>(
+    malloc(sizeof(struct NamemapTable)));
+  table->size = size;
+  table->slots = static_cast<void * volatile *>(calloc(size, sizeof(void *)));
+  table->prev = NULL;
+  return table;
+}
+
 /* Initializes static data. */
 static void
 namemap_init(void)
 {
-  unsigned int i;
+  int i;
+
+  if (init_mutex == NULL) { CC_MUTEX_CONSTRUCT(init_mutex); }
+  CC_MUTEX_LOCK(init_mutex);
+
+  if (cc_atomic_load_ptr(&nametable) == NULL) {
+    for (i = 0; i < NUM_SHARDS; i++) {
+      shards[i].mutex = NULL;
+      CC_MUTEX_CONSTRUCT(shards[i].mutex);
+      shards[i].headchunk = NULL;
+    }
+    numnames = 0;
+    coin_atexit(static_cast<coin_atexit_f *>(namemap_cleanup), CC_ATEXIT_SBNAME);
 
-  nametable = static_cast<struct NamemapBucketEntry **>(
-    malloc(sizeof(struct NamemapBucketEntry *) * NAME_TABLE_SIZE));
-  for (i = 0; i < NAME_TABLE_SIZE; i++) { nametable[i] = NULL; }
+    cc_atomic_store_ptr(&nametable, namemap_create_table(INITIAL_TABLE_SIZE));
+  }
 
-  headchunk = NULL;
+  CC_MUTEX_UNLOCK(init_mutex);
+}
 
-  coin_atexit(static_cast<coin_atexit_f *>(namemap_cleanup), CC_ATEXIT_SBNAME);
+/*
+  FNV-1a, followed by a final mix so the low bits used for the table
+  index and the top bits used for the shard both depend on all of
+  the string. cc_string_hash_text() is too weak for large sets of
+  similar names, like "Pipe_000001", "Pipe_000002", etc.
+*/
+static uint32_t
+namemap_hash(const char * str, size_t * len)
+{
+  const char * ptr = str;
+  uint32_t h = 2166136261u;
+  while (*ptr) {
+    h ^= static_cast<unsigned char>(*ptr++);
+    h *= 16777619u;
+  }
+  *len = ptr - str;
+
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
 }
 
 static const char *
-find_string_address(const char * s)
+find_string_address(struct NamemapShard * shard, const char * s, size_t len, uint32_t h)
 {
-  size_t len = strlen(s) + 1;
+  /* room for the hash value, the string and its terminator, aligned
+     so that the next hash value is aligned */
+  const size_t size = (sizeof(uint32_t) + len + 1 + sizeof(uint32_t) - 1) &
+    ~(sizeof(uint32_t) - 1);
 
   /* FIXME: this is an unacceptable limitation. 20030608 mortene. */
-  assert(len < CHUNK_SIZE);
+  assert(size < CHUNK_SIZE);
 
-  if (headchunk == NULL || headchunk->bytesleft < len) {
-    struct NamemapMemChunk * newchunk = static_cast<struct NamemapMemChunk *>(
+  struct NamemapMemChunk * chunk = shard->headchunk;
+  if (chunk == NULL || chunk->bytesleft < size) {
+    chunk = static_cast<struct NamemapMemChunk *>(
       malloc(sizeof(struct NamemapMemChunk))
       );
 
-    newchunk->curbyte = newchunk->mem;
-    newchunk->bytesleft = CHUNK_SIZE;
-    newchunk->next = headchunk;
+    chunk->curbyte = chunk->mem;
+    chunk->bytesleft = CHUNK_SIZE & ~(sizeof(uint32_t) - 1);
+    chunk->next = shard->headchunk;
 
-    headchunk = newchunk;
+    shard->headchunk = chunk;
   }
 
-  (void)strcpy(headchunk->curbyte, s);
-  s = headchunk->curbyte;
+  (void)memcpy(chunk->curbyte, &h, sizeof(uint32_t));
+  char * str = chunk->curbyte + sizeof(uint32_t);
+  (void)memcpy(str, s, len + 1);
 
-  headchunk->curbyte += len;
-  headchunk->bytesleft -= len;
+  chunk->curbyte += size;
+  chunk->bytesleft -= size;
 
-  return s;
+  return str;
 }
 
 static const char *
-namemap_find_or_add_string(const char * str, SbBool addifnotfound)
+namemap_lookup(const struct NamemapTable * table, const char * str, uint32_t h)
 {
-  unsigned long h, i;
-  struct NamemapBucketEntry * entry;
+  const unsigned int mask = table->size - 1;
+  for (unsigned int i = h & mask; TRUE; i = (i + 1) & mask) {
+    const char * entry =
+      static_cast<const char *>(cc_atomic_load_ptr(&table->slots[i]));
+    if (entry == NULL) { return NULL; }
+    if (NAMEMAP_HASH(entry) == h && strcmp(entry, str) == 0) { return entry; }
+  }
+}
 
-  if (access_mutex == NULL) { CC_MUTEX_CONSTRUCT(access_mutex); }
-  CC_MUTEX_LOCK(access_mutex);
+static void
+namemap_insert(struct NamemapTable * table, const char * str, uint32_t h)
+{
+  const unsigned int mask = table->size - 1;
+  void * entry = const_cast<char *>(str);
+  for (unsigned int i = h & mask; TRUE; i = (i + 1) & mask) {
+    if (cc_atomic_cas_ptr(&table->slots[i], NULL, entry) == NULL) { return; }
+  }
+}
 
-  if (nametable == NULL) { namemap_init(); }
-  assert(nametable != static_cast<struct NamemapBucketEntry **>(NULL) && "name hash dead");
+/* Replaces the table with one twice the size, unless someone else
+   already did. */
+static void
+namemap_grow(struct NamemapTable * table)
+{
+  int i;
+  unsigned int j;
 
-  h = cc_string_hash_text(str);
-  i = h % NAME_TABLE_SIZE;
-  entry = nametable[i];
+  for (i = 0; i < NUM_SHARDS; i++) { CC_MUTEX_LOCK(shards[i].mutex); }
 
-  while (entry != NULL) {
-    if (entry->hashvalue == h && strcmp(entry->str, str) == 0) { break; }
-    entry = entry->next;
+  if (cc_atomic_load_ptr(&nametable) == table) {
+    struct NamemapTable * newtable = namemap_create_table(table->size * 2);
+    for (j = 0; j < table->size; j++) {
+      const char * entry = static_cast<const char *>(table->slots[j]);
+      if (entry) { namemap_insert(newtable, entry, NAMEMAP_HASH(entry)); }
+    }
+    newtable->prev = table;
+    cc_atomic_store_ptr(&nametable, newtable);
   }
 
-  if ((entry == NULL) && addifnotfound) {
-    entry = static_cast<struct NamemapBucketEntry *>(malloc(sizeof(struct NamemapBucketEntry)));
-    entry->str = find_string_address(str);
-    entry->hashvalue = h;
-    entry->next = nametable[i];
+  for (i = NUM_SHARDS - 1; i >= 0; i--) { CC_MUTEX_UNLOCK(shards[i].mutex); }
+}
 
-    nametable[i] = entry;
+static const char *
+namemap_find_or_add_string(const char * str, SbBool addifnotfound)
+{
+  struct NamemapTable * table =
+    static_cast<struct NamemapTable *>(cc_atomic_load_ptr(&nametable));
+  if (table == NULL) {
+    namemap_init();
+    table = static_cast<struct NamemapTable *>(cc_atomic_load_ptr(&nametable));
+  }
+  assert(table != NULL && "name hash dead");
+
+  size_t len;
+  const uint32_t h = namemap_hash(str, &len);
+  const char * entry = namemap_lookup(table, str, h);
+  if (entry || !addifnotfound) { return entry; }
+
+  struct NamemapShard * shard = &shards[h >> SHARD_SHIFT];
+  int32_t count = 0;
+
+  CC_MUTEX_LOCK(shard->mutex);
+  /* the table can not be replaced while we hold a shard lock, but
+     may have been since we looked it up */
+  table = static_cast<struct NamemapTable *>(cc_atomic_load_ptr(&nametable));
+  entry = namemap_lookup(table, str, h);
+  if (entry == NULL) {
+    entry = find_string_address(shard, str, len, h);
+    namemap_insert(table, entry, h);
+    count = cc_atomic_add32(&numnames, 1);
   }
+  CC_MUTEX_UNLOCK(shard->mutex);
 
-  CC_MUTEX_UNLOCK(access_mutex);
-  return entry ? entry->str : NULL;
+  if (static_cast<uint32_t>(count) > table->size / 2) { namemap_grow(table); }
+  return entry;
 }
 
 /* ************************************************************************* */
@@ -221,4 +354,7 @@ cc_namemap_peek_string(const char * str)
   return namemap_find_or_add_string(str, FALSE);
 }
 
+#undef NAMEMAP_HASH
+#undef SHARD_SHIFT
+#undef NUM_SHARDS
 #undef CHUNK_SIZE
@@ -69,6 +69,7 @@
 
 #include "tidbitsp.h"
 #include "misc/SbHash.h"
+#include "misc/SbRadixSort.h"
 #include "rendering/SoGL.h"
 #include "rendering/SoVBO.h"
 #include "rendering/SoVertexArrayIndexer.h"
@@ -152,6 +153,10 @@ public:
   SoState * state;
   SbPlane prevsortplane;
   float * deptharray;
+  SbRadixSort depthsorter;
+  SbList <GLint> sorttmpindices;
+  SbList <float> sorttmpdepths;
+  SbList <float> vertexdepths;
 
   SoVertexArrayIndexer * triangleindexer;
   SoVertexArrayIndexer * lineindexer;
@@ -168,6 +173,9 @@ public:
 
   void addVertex(const Vertex & v);
 
+  SbBool repairDepthSort(const int numtri, float * darray, GLint * iptr);
+  void fullDepthSort(const int numtri, float * darray, GLint * iptr);
+
   void renderImmediate(const cc_glglue * glue,
                        const GLint * indices,
                        const int numindices,
@@ -208,6 +216,10 @@ public:
 
 // *************************************************************************
 
+static int COIN_INCREMENTAL_DEPTHSORT = -1;
+
+// *************************************************************************
+
 namespace {
   // SoGLLazyElement shares the same class stack index as
   // SoLazyElement. Do a type check to test if SoGLLazyElement is
@@ -834,6 +846,18 @@ SoPrimitiveVertexCache::fit(void)
   if (PRIVATE(this)->pointindexer) PRIVATE(this)->pointindexer->close();
 }
 
+/*!
+  Sorts the triangles back to front, based on the distance from the
+  near plane of the current view volume to the triangle centers. The
+  sort is only done if the view volume or model matrix has changed
+  since the last sort.
+
+  By default, the previous sort order is kept and repaired with an
+  insertion sort when the camera moves, since the order usually
+  changes very little from one frame to the next. A full sort is only
+  done when too many triangles are out of order. Set the environment
+  variable COIN_INCREMENTAL_DEPTHSORT to 0 to always do a full sort.
+*/
 void
 SoPrimitiveVertexCache::depthSortTriangles(SoState * state)
 {
@@ -841,53 +865,119 @@ SoPrimitiveVertexCache::depthSortTriangles(SoState * state)
   int numtri = this->getNumTriangleIndices() / 3;
   if (numv == 0 || numtri == 0) return;
 
+  if (COIN_INCREMENTAL_DEPTHSORT < 0) {
+    const char * env = coin_getenv("COIN_INCREMENTAL_DEPTHSORT");
+    if (env) COIN_INCREMENTAL_DEPTHSORT = atoi(env);
+    else COIN_INCREMENTAL_DEPTHSORT = 1;
+  }
+
   SbPlane sortplane = SoViewVolumeElement::get(state).getPlane(0.0);
   // move plane into object space
   sortplane.transform(SoModelMatrixElement::get(state).inverse());
 
   if (PRIVATE(this)->deptharray == NULL ||
       (sortplane != PRIVATE(this)->prevsortplane)) {
+    SbBool firstsort = FALSE;
     if (!PRIVATE(this)->deptharray) {
       PRIVATE(this)->deptharray = new float[numtri];
+      firstsort = TRUE;
     }
     PRIVATE(this)->prevsortplane = sortplane;
     float * darray = PRIVATE(this)->deptharray;
     const SbVec3f * vptr = PRIVATE(this)->vertexlist.getArrayPtr();
     GLint * iptr = PRIVATE(this)->triangleindexer->getWriteableIndices();
-    int i,j;
+    int i;
+
+    // find the distance for each vertex first, to avoid calculating
+    // it once per triangle using it
+    const SbVec3f & n = sortplane.getNormal();
+    const float d = sortplane.getDistanceFromOrigin();
+    PRIVATE(this)->vertexdepths.truncate(0);
+    for (i = 0; i < numv; i++) {
+      PRIVATE(this)->vertexdepths.append(n.dot(vptr[i]) - d);
+    }
+    const float * vdepth = PRIVATE(this)->vertexdepths.getArrayPtr();
     for (i = 0; i < numtri; i++) {
-      float acc = 0.0;
-      for (j = 0; j < 3; j++) {
-        acc += sortplane.getDistance(vptr[iptr[i*3+j]]);
-      }
-      darray[i] = acc / 3.0f;
+      darray[i] = (vdepth[iptr[i*3]] + vdepth[iptr[i*3+1]] + vdepth[iptr[i*3+2]]) / 3.0f;
     }
-    int distance;
-    float dtmp;
-    int itmp[3];
-
-    // shell sort algorithm (O(nlog(n))
-    for (distance = 1; distance <= numtri/9; distance = 3*distance + 1) ;
-    for (; distance > 0; distance /= 3) {
-      for (i = distance; i < numtri; i++) {
-        dtmp = darray[i];
-        itmp[0] = iptr[i*3];
-        itmp[1] = iptr[i*3+1];
-        itmp[2] = iptr[i*3+2];
-        j = i;
-        while (j >= distance && darray[j-distance] > dtmp) {
-          darray[j] = darray[j-distance];
-          iptr[j*3] = iptr[(j-distance)*3];
-          iptr[j*3+1] = iptr[(j-distance)*3+1];
-          iptr[j*3+2] = iptr[(j-distance)*3+2];
-          j -= distance;
-        }
-        darray[j] = dtmp;
-        iptr[j*3] = itmp[0];
-        iptr[j*3+1] = itmp[1];
-        iptr[j*3+2] = itmp[2];
-      }
+
+    if (firstsort || !COIN_INCREMENTAL_DEPTHSORT ||
+        !PRIVATE(this)->repairDepthSort(numtri, darray, iptr)) {
+      PRIVATE(this)->fullDepthSort(numtri, darray, iptr);
+    }
+  }
+}
+
+// Repairs the triangle order from the previous frame with an
+// insertion sort, which runs in O(n + k) time for k inversions. Gives
+// up and returns FALSE if the order looks too far from sorted, in
+// which case the arrays still contain a permutation of the input, but
+// need a full sort.
+SbBool
+SoPrimitiveVertexCacheP::repairDepthSort(const int numtri, float * darray, GLint * iptr)
+{
+  int i, j;
+  // a quick estimate first. Each descent between neighbours is at
+  // least one inversion, and an order with descents everywhere is
+  // most likely not from a previous frame
+  int numdescents = 0;
+  for (i = 1; i < numtri; i++) {
+    if (darray[i-1] > darray[i]) numdescents++;
+  }
+  if (numdescents == 0) return TRUE;
+  if (numdescents > numtri / 4) return FALSE;
+
+  // allow roughly as many element moves as a full sort would cost
+  int budget = 2 * numtri + 64;
+  float dtmp;
+  GLint itmp[3];
+  for (i = 1; i < numtri; i++) {
+    dtmp = darray[i];
+    if (darray[i-1] <= dtmp) continue;
+    itmp[0] = iptr[i*3];
+    itmp[1] = iptr[i*3+1];
+    itmp[2] = iptr[i*3+2];
+    j = i;
+    while (j > 0 && darray[j-1] > dtmp) {
+      darray[j] = darray[j-1];
+      iptr[j*3] = iptr[(j-1)*3];
+      iptr[j*3+1] = iptr[(j-1)*3+1];
+      iptr[j*3+2] = iptr[(j-1)*3+2];
+      j--;
+      budget--;
     }
+    darray[j] = dtmp;
+    iptr[j*3] = itmp[0];
+    iptr[j*3+1] = itmp[1];
+    iptr[j*3+2] = itmp[2];
+    if (budget < 0) return FALSE;
+  }
+  return TRUE;
+}
+
+// Sorts all triangles from scratch.
+void
+SoPrimitiveVertexCacheP::fullDepthSort(const int numtri, float * darray, GLint * iptr)
+{
+  const int * sorted = this->depthsorter.sort(darray, numtri);
+
+  int i;
+  this->sorttmpindices.truncate(0);
+  this->sorttmpdepths.truncate(0);
+  for (i = 0; i < numtri; i++) {
+    this->sorttmpindices.append(iptr[i*3]);
+    this->sorttmpindices.append(iptr[i*3+1]);
+    this->sorttmpindices.append(iptr[i*3+2]);
+    this->sorttmpdepths.append(darray[i]);
+  }
+  const GLint * tmpi = this->sorttmpindices.getArrayPtr();
+  const float * tmpd = this->sorttmpdepths.getArrayPtr();
+  for (i = 0; i < numtri; i++) {
+    const int src = sorted[i];
+    darray[i] = tmpd[src];
+    iptr[i*3] = tmpi[src*3];
+    iptr[i*3+1] = tmpi[src*3+1];
+    iptr[i*3+2] = tmpi[src*3+2];
   }
 }
 
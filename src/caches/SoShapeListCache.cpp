@@ -0,0 +1,478 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SoShapeListCache SoShapeListCache.h
+  \brief The SoShapeListCache class stores a compiled subgraph for SoCallbackAction.
+  \ingroup caches
+
+  The cache is a flat list with one record for every shape below an
+  SoSeparator, holding the path from the separator to the shape, the
+  model matrix relative to the separator, the material and the
+  primitives the shape generated. Nested separators with a cache of
+  their own are stored as one record pointing to that cache.
+
+  The list is recorded from the primitives passed to the callbacks
+  while the subgraph is traversed, and replayed by setting the model
+  matrix and material for each record and calling the callbacks
+  directly. See SoCallbackAction::setCompiledTraversal().
+
+  SoLazyElement can't be used for cache dependencies, so the material
+  at the separator is compared when the cache is replayed instead.
+*/
+
+// *************************************************************************
+
+#include "caches/SoShapeListCache.h"
+
+#include <Inventor/SbColor.h>
+#include <Inventor/SbMatrix.h>
+#include <Inventor/SoFullPath.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/details/SoDetail.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoShape.h>
+
+#include "actions/SoCallbackActionP.h"
+
+// *************************************************************************
+
+namespace {
+
+struct Record {
+  SoNode * node; // the shape, or the separator of subcache
+  SoShapeListCache * subcache;
+  SbMatrix matrix; // relative to the separator of this cache
+  int firstpath, pathlength;
+  int firstmaterial, nummaterials;
+  SbColor ambient, emissive, specular;
+  float shininess;
+  int firstprimitive, numprimitives;
+  int firstvertex;
+};
+
+} // namespace
+
+// the parts of SoLazyElement which the recorded materials depend on
+struct SoShapeListCache::MaterialKey {
+  uint32_t diffusenodeid, transpnodeid;
+  SbBool packeddiffuse;
+  SbColor ambient, emissive, specular;
+  float shininess;
+};
+
+class SoShapeListCacheP {
+public:
+  SbList <Record> records;
+  SbList <SoNode *> pathnodes;
+  SbList <int> pathindices;
+  SbList <SbColor> diffuse;
+  SbList <float> transparency;
+  SbList <unsigned char> primitives; // number of vertices in each
+  SbList <SoPrimitiveVertex> vertices;
+  SbList <SoDetail *> details;
+  SoColorPacker packer;
+  SoShapeListCache::MaterialKey materialkey;
+  SbBool callbackall;
+  int numshapes;
+
+  // used while recording
+  SoShapeListCache * parent;
+  int pathbase;
+  SbMatrix basematrix, baseinv;
+  SbBool singular;
+  uint32_t nodecounter;
+  SbList <int> materialstamp, materialmap;
+
+  static const SbMatrix & getModelMatrix(SoState * state);
+  void appendPath(SoCallbackAction * action, Record & rec);
+  int mapMaterial(SoState * state, Record & rec, int index);
+};
+
+#define PRIVATE(obj) ((obj)->pimpl)
+#define ACTIONP(obj) ((obj)->pimpl)
+
+void
+SoShapeListCache::getMaterialKey(SoState * state, MaterialKey & key)
+{
+  const SoLazyElement * elem = SoLazyElement::getInstance(state);
+  key.diffusenodeid = elem->coinstate.diffusenodeid;
+  key.transpnodeid = elem->coinstate.transpnodeid;
+  key.packeddiffuse = elem->coinstate.packeddiffuse;
+  key.ambient = elem->coinstate.ambient;
+  key.emissive = elem->coinstate.emissive;
+  key.specular = elem->coinstate.specular;
+  key.shininess = elem->coinstate.shininess;
+}
+
+// The matrices are stored relative to the separator, so they are
+// read without adding a cache dependency.
+const SbMatrix &
+SoShapeListCacheP::getModelMatrix(SoState * state)
+{
+  const SoModelMatrixElement * elem =
+    static_cast<const SoModelMatrixElement *>
+    (state->getConstElement(SoModelMatrixElement::getClassStackIndex()));
+  return elem->getModelMatrix();
+}
+
+void
+SoShapeListCacheP::appendPath(SoCallbackAction * action, Record & rec)
+{
+  const SoFullPath * path = static_cast<const SoFullPath *>(action->getCurPath());
+  const int len = path->getLength();
+  rec.firstpath = this->pathnodes.getLength();
+  rec.pathlength = len - this->pathbase;
+  for (int i = this->pathbase; i < len; i++) {
+    this->pathnodes.append(path->getNode(i));
+    this->pathindices.append(path->getIndex(i));
+  }
+}
+
+// Copies the material of index into the record, and returns the index
+// of the copy.
+int
+SoShapeListCacheP::mapMaterial(SoState * state, Record & rec, int index)
+{
+  const int numdiffuse = SoLazyElement::getInstance(state)->getNumDiffuse();
+  if (index >= numdiffuse) index = numdiffuse - 1;
+  if (index < 0) index = 0;
+
+  const int stamp = this->records.getLength();
+  while (this->materialstamp.getLength() <= index) {
+    this->materialstamp.append(0);
+    this->materialmap.append(0);
+  }
+  if (this->materialstamp[index] != stamp) {
+    this->materialstamp[index] = stamp;
+    this->materialmap[index] = rec.nummaterials++;
+    this->diffuse.append(SoLazyElement::getDiffuse(state, index));
+    this->transparency.append(SoLazyElement::getTransparency(state, index));
+  }
+  return this->materialmap[index];
+}
+
+// *************************************************************************
+
+/*!
+  Constructor with \a state being the current state.
+*/
+SoShapeListCache::SoShapeListCache(SoState * state)
+  : SoCache(state)
+{
+  PRIVATE(this) = new SoShapeListCacheP;
+  PRIVATE(this)->callbackall = FALSE;
+  PRIVATE(this)->numshapes = 0;
+  PRIVATE(this)->parent = NULL;
+  PRIVATE(this)->pathbase = 0;
+  PRIVATE(this)->singular = FALSE;
+  PRIVATE(this)->nodecounter = 0;
+}
+
+/*!
+  Destructor.
+*/
+SoShapeListCache::~SoShapeListCache()
+{
+  const int numdetails = PRIVATE(this)->details.getLength();
+  for (int i = 0; i < numdetails; i++) {
+    delete PRIVATE(this)->details[i];
+  }
+  const int numrecords = PRIVATE(this)->records.getLength();
+  for (int i = 0; i < numrecords; i++) {
+    if (PRIVATE(this)->records[i].subcache) {
+      PRIVATE(this)->records[i].subcache->unref();
+    }
+  }
+  delete PRIVATE(this);
+}
+
+/*!
+  Returns \c TRUE if separators should compile their subgraphs for
+  \a action at the current traversal position.
+*/
+SbBool
+SoShapeListCache::shouldCompile(SoCallbackAction * action)
+{
+  if (!ACTIONP(action)->compiled || ACTIONP(action)->hasnodecallbacks) {
+    return FALSE;
+  }
+  const SoAction::PathCode code = action->getCurPathCode();
+  return code == SoAction::NO_PATH || code == SoAction::BELOW_PATH;
+}
+
+/*!
+  Returns \c TRUE if the cache is valid, and can be replayed for \a
+  action.
+*/
+SbBool
+SoShapeListCache::canReplay(SoCallbackAction * action) const
+{
+  SoState * state = action->getState();
+  if (!this->isValid(state)) return FALSE;
+  if (PRIVATE(this)->callbackall != action->isCallbackAll()) return FALSE;
+
+  MaterialKey key;
+  SoShapeListCache::getMaterialKey(state, key);
+  const MaterialKey & old = PRIVATE(this)->materialkey;
+  return
+    key.diffusenodeid == old.diffusenodeid &&
+    key.transpnodeid == old.transpnodeid &&
+    key.packeddiffuse == old.packeddiffuse &&
+    key.ambient == old.ambient &&
+    key.emissive == old.emissive &&
+    key.specular == old.specular &&
+    key.shininess == old.shininess;
+}
+
+/*!
+  Returns the number of shapes in the cache, including those in
+  nested caches.
+*/
+int
+SoShapeListCache::getNumShapes(void) const
+{
+  return PRIVATE(this)->numshapes;
+}
+
+/*!
+  Starts recording the primitives passed to the callbacks of \a
+  action. Should be called from the separator which owns the cache,
+  before its children are traversed.
+*/
+void
+SoShapeListCache::beginRecording(SoCallbackAction * action)
+{
+  SoState * state = action->getState();
+  PRIVATE(this)->callbackall = action->isCallbackAll();
+  SoShapeListCache::getMaterialKey(state, PRIVATE(this)->materialkey);
+  PRIVATE(this)->pathbase =
+    static_cast<const SoFullPath *>(action->getCurPath())->getLength();
+  PRIVATE(this)->basematrix = SoShapeListCacheP::getModelMatrix(state);
+  PRIVATE(this)->singular = PRIVATE(this)->basematrix.det4() == 0.0f;
+  if (!PRIVATE(this)->singular) {
+    PRIVATE(this)->baseinv = PRIVATE(this)->basematrix.inverse();
+  }
+  PRIVATE(this)->nodecounter = ACTIONP(action)->nodecounter;
+  PRIVATE(this)->parent = ACTIONP(action)->recording;
+  ACTIONP(action)->recording = this;
+}
+
+/*!
+  Stops recording, and adds the cache to the cache of the closest
+  separator above which is also recording.
+*/
+void
+SoShapeListCache::endRecording(SoCallbackAction * action)
+{
+  assert(ACTIONP(action)->recording == this);
+  SoShapeListCache * parent = PRIVATE(this)->parent;
+  ACTIONP(action)->recording = parent;
+  PRIVATE(this)->parent = NULL;
+  PRIVATE(this)->materialstamp.truncate(0, TRUE);
+  PRIVATE(this)->materialmap.truncate(0, TRUE);
+
+  // the matrices can't be made relative to a singular matrix
+  if (PRIVATE(this)->singular || action->hasTerminated()) {
+    this->invalidate();
+    if (parent) parent->invalidate();
+  }
+  else if (parent) {
+    parent->addSubCache(action, this, PRIVATE(this)->basematrix);
+  }
+}
+
+/*!
+  Replays the cache to the callbacks of \a action. Should be called
+  from the separator which owns the cache, instead of traversing its
+  children.
+*/
+void
+SoShapeListCache::replay(SoCallbackAction * action)
+{
+  const SbMatrix base = SoShapeListCacheP::getModelMatrix(action->getState());
+  SoShapeListCache * recording = ACTIONP(action)->recording;
+  if (recording) {
+    // the separator above gets a reference to this cache instead of
+    // the primitives
+    recording->addSubCache(action, this, base);
+    ACTIONP(action)->recording = NULL;
+  }
+  this->replayRecords(action, base);
+  ACTIONP(action)->recording = recording;
+}
+
+/*!
+  Adds a primitive with \a numvertices vertices, generated by \a
+  shape. Called from the SoCallbackAction::invoke*Callbacks() methods
+  while recording.
+*/
+void
+SoShapeListCache::addPrimitive(SoCallbackAction * action, const SoShape * shape,
+                               const int numvertices,
+                               const SoPrimitiveVertex * const * vertices)
+{
+  SoState * state = action->getState();
+  SoShapeListCacheP * thisp = PRIVATE(this);
+
+  int numrecords = thisp->records.getLength();
+  if (numrecords == 0 || thisp->records[numrecords - 1].subcache ||
+      thisp->nodecounter != ACTIONP(action)->nodecounter) {
+    // first primitive from this shape
+    Record rec;
+    rec.node = const_cast<SoShape *>(shape);
+    rec.subcache = NULL;
+    rec.matrix = SoShapeListCacheP::getModelMatrix(state);
+    rec.matrix.multRight(thisp->baseinv);
+    thisp->appendPath(action, rec);
+    rec.firstmaterial = thisp->diffuse.getLength();
+    rec.nummaterials = 0;
+    rec.ambient = SoLazyElement::getAmbient(state);
+    rec.emissive = SoLazyElement::getEmissive(state);
+    rec.specular = SoLazyElement::getSpecular(state);
+    rec.shininess = SoLazyElement::getShininess(state);
+    rec.firstprimitive = thisp->primitives.getLength();
+    rec.numprimitives = 0;
+    rec.firstvertex = thisp->vertices.getLength();
+    thisp->records.append(rec);
+    thisp->nodecounter = ACTIONP(action)->nodecounter;
+    thisp->numshapes++;
+    numrecords++;
+  }
+
+  Record & rec = thisp->records[numrecords - 1];
+  thisp->primitives.append(static_cast<unsigned char>(numvertices));
+  rec.numprimitives++;
+  // the vertices of a face or line usually share one detail
+  const SoDetail * detail = NULL;
+  SoDetail * detailcopy = NULL;
+  for (int i = 0; i < numvertices; i++) {
+    SoPrimitiveVertex v(*vertices[i]);
+    if (v.getDetail() && v.getDetail() != detail) {
+      detail = v.getDetail();
+      detailcopy = detail->copy();
+      thisp->details.append(detailcopy);
+    }
+    v.setDetail(detail ? detailcopy : NULL);
+    v.setMaterialIndex(thisp->mapMaterial(state, rec, v.getMaterialIndex()));
+    thisp->vertices.append(v);
+  }
+}
+
+// Adds a record for the separator at the end of the current path,
+// which has the compiled list sub and the model matrix matrix.
+void
+SoShapeListCache::addSubCache(SoCallbackAction * action, SoShapeListCache * sub,
+                              const SbMatrix & matrix)
+{
+  Record rec;
+  rec.node = action->getCurPathTail();
+  rec.subcache = sub;
+  sub->ref();
+  rec.matrix = matrix;
+  rec.matrix.multRight(PRIVATE(this)->baseinv);
+  PRIVATE(this)->appendPath(action, rec);
+  rec.firstmaterial = rec.nummaterials = 0;
+  rec.shininess = 0.0f;
+  rec.firstprimitive = rec.numprimitives = rec.firstvertex = 0;
+  PRIVATE(this)->records.append(rec);
+  PRIVATE(this)->numshapes += PRIVATE(sub)->numshapes;
+}
+
+void
+SoShapeListCache::replayRecords(SoCallbackAction * action, const SbMatrix & base)
+{
+  SoState * state = action->getState();
+  SoShapeListCacheP * thisp = PRIVATE(this);
+  const Record * records = thisp->records.getArrayPtr();
+  const int numrecords = thisp->records.getLength();
+
+  for (int i = 0; i < numrecords; i++) {
+    const Record & rec = records[i];
+    for (int j = 0; j < rec.pathlength; j++) {
+      action->pushCurPath(thisp->pathindices[rec.firstpath + j],
+                          thisp->pathnodes[rec.firstpath + j]);
+    }
+    state->push();
+    SbMatrix matrix = rec.matrix;
+    matrix.multRight(base);
+    SoModelMatrixElement::set(state, rec.node, matrix);
+
+    if (rec.subcache) {
+      rec.subcache->replayRecords(action, matrix);
+    }
+    else {
+      if (rec.nummaterials) {
+        SoLazyElement::setDiffuse(state, rec.node, rec.nummaterials,
+                                  thisp->diffuse.getArrayPtr() + rec.firstmaterial,
+                                  &thisp->packer);
+        SoLazyElement::setTransparency(state, rec.node, rec.nummaterials,
+                                       thisp->transparency.getArrayPtr() + rec.firstmaterial,
+                                       &thisp->packer);
+      }
+      SoLazyElement::setAmbient(state, &rec.ambient);
+      SoLazyElement::setEmissive(state, &rec.emissive);
+      SoLazyElement::setSpecular(state, &rec.specular);
+      SoLazyElement::setShininess(state, rec.shininess);
+
+      action->setCurrentNode(rec.node);
+      const SoShape * shape = static_cast<const SoShape *>(rec.node);
+      const unsigned char * primitives =
+        thisp->primitives.getArrayPtr() + rec.firstprimitive;
+      const SoPrimitiveVertex * v = thisp->vertices.getArrayPtr() + rec.firstvertex;
+      for (int j = 0; j < rec.numprimitives; j++) {
+        switch (primitives[j]) {
+        case 3:
+          action->invokeTriangleCallbacks(shape, v, v + 1, v + 2);
+          break;
+        case 2:
+          action->invokeLineSegmentCallbacks(shape, v, v + 1);
+          break;
+        default:
+          action->invokePointCallbacks(shape, v);
+          break;
+        }
+        v += primitives[j];
+      }
+    }
+
+    state->pop();
+    for (int j = 0; j < rec.pathlength; j++) action->popCurPath();
+  }
+}
+
+#undef ACTIONP
+#undef PRIVATE
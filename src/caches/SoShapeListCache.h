@@ -0,0 +1,82 @@
+#ifndef COIN_SOSHAPELISTCACHE_H
+#define COIN_SOSHAPELISTCACHE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* !COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <Inventor/caches/SoCache.h>
+
+class SbMatrix;
+class SoCallbackAction;
+class SoPrimitiveVertex;
+class SoShape;
+class SoShapeListCacheP;
+
+// *************************************************************************
+
+class SoShapeListCache : public SoCache {
+  typedef SoCache inherited;
+public:
+  SoShapeListCache(SoState * state);
+  virtual ~SoShapeListCache();
+
+  static SbBool shouldCompile(SoCallbackAction * action);
+  SbBool canReplay(SoCallbackAction * action) const;
+  int getNumShapes(void) const;
+
+  void beginRecording(SoCallbackAction * action);
+  void endRecording(SoCallbackAction * action);
+  void replay(SoCallbackAction * action);
+
+  void addPrimitive(SoCallbackAction * action, const SoShape * shape,
+                    const int numvertices,
+                    const SoPrimitiveVertex * const * vertices);
+
+private:
+  struct MaterialKey;
+  static void getMaterialKey(SoState * state, MaterialKey & key);
+
+  void addSubCache(SoCallbackAction * action, SoShapeListCache * sub,
+                   const SbMatrix & matrix);
+  void replayRecords(SoCallbackAction * action, const SbMatrix & base);
+
+  SoShapeListCacheP * pimpl;
+  friend class SoShapeListCacheP;
+};
+
+#endif // !COIN_SOSHAPELISTCACHE_H
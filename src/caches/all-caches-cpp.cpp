@@ -40,4 +40,5 @@
 #include "SoPrimitiveVertexCache.cpp"
 #include "SoGlyphCache.cpp"
 #include "SoShaderProgramCache.cpp"
+#include "SoShapeListCache.cpp"
 #include "SoVBOCache.cpp"
@@ -53,6 +53,7 @@
 #include <Inventor/details/SoCubeDetail.h>
 #include <Inventor/details/SoCylinderDetail.h>
 #include <Inventor/details/SoFaceDetail.h>
+#include <Inventor/details/SoInstanceDetail.h>
 #include <Inventor/details/SoLineDetail.h>
 #include <Inventor/details/SoPointDetail.h>
 #include <Inventor/details/SoTextDetail.h>
@@ -171,6 +172,7 @@ SoDetail::initClasses(void)
   SoCubeDetail::initClass();
   SoCylinderDetail::initClass();
   SoFaceDetail::initClass();
+  SoInstanceDetail::initClass();
   SoLineDetail::initClass();
   SoPointDetail::initClass();
   SoTextDetail::initClass();
@@ -0,0 +1,114 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SoInstanceDetail SoInstanceDetail.h Inventor/details/SoInstanceDetail.h
+  \brief The SoInstanceDetail class tells which instance of an SoInstancedCopy was hit.
+  \ingroup details
+
+  An SoInstancedCopy node draws its children once per instance, but
+  the children appear only once in the path of a picked point. To
+  tell the copies apart, the SoInstancedCopy node attaches an
+  instance of this class to its own entry in the path of every
+  SoPickedPoint generated below it.
+
+  \code
+  const SoPickedPoint * pp = rpaction->getPickedPoint();
+  const SoDetail * d = pp ? pp->getDetail(instancednode) : NULL;
+  if (d && d->isOfType(SoInstanceDetail::getClassTypeId())) {
+    int idx = ((const SoInstanceDetail *)d)->getInstanceIndex();
+    // ...
+  }
+  \endcode
+
+  \sa SoInstancedCopy, SoRayPickAction, SoPickedPoint
+  \since Coin 4.0
+*/
+
+/*!
+  \var int SoInstanceDetail::instanceindex
+  \COININTERNAL
+*/
+
+#include <Inventor/details/SoInstanceDetail.h>
+#include <Inventor/SbName.h>
+
+SO_DETAIL_SOURCE(SoInstanceDetail);
+
+/*!
+  Constructor.
+ */
+SoInstanceDetail::SoInstanceDetail(void)
+  : instanceindex(0)
+{
+}
+
+/*!
+  Destructor.
+ */
+SoInstanceDetail::~SoInstanceDetail()
+{
+}
+
+// doc in super
+void
+SoInstanceDetail::initClass(void)
+{
+  SO_DETAIL_INIT_CLASS(SoInstanceDetail, SoDetail);
+}
+
+// doc in super
+SoDetail *
+SoInstanceDetail::copy(void) const
+{
+  SoInstanceDetail * copy = new SoInstanceDetail;
+  copy->instanceindex = this->instanceindex;
+  return copy;
+}
+
+/*!
+  Set the index of the instance which was picked.
+ */
+void
+SoInstanceDetail::setInstanceIndex(const int idx)
+{
+  this->instanceindex = idx;
+}
+
+/*!
+  Returns the index of the picked instance.
+ */
+int
+SoInstanceDetail::getInstanceIndex(void) const
+{
+  return this->instanceindex;
+}
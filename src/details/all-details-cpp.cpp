@@ -39,6 +39,7 @@
 #include "SoCubeDetail.cpp"
 #include "SoCylinderDetail.cpp"
 #include "SoFaceDetail.cpp"
+#include "SoInstanceDetail.cpp"
 #include "SoLineDetail.cpp"
 #include "SoPointDetail.cpp"
 #include "SoTextDetail.cpp"
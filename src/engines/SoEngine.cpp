@@ -72,6 +72,7 @@
 #include "config.h"
 #endif // HAVE_CONFIG_H
 #include "coindefs.h" // COIN_STUB()
+#include "engines/SoSubEngineP.h"
 #ifdef COIN_THREADSAFE
 #include "threads/recmutexp.h"
 #endif // COIN_THREADSAFE
@@ -172,39 +173,39 @@ void
 SoEngine::initClasses(void)
 {
   SoNodeEngine::initClass();
-  SoBoolOperation::initClass();
-  SoCalculator::initClass();
-  SoComposeVec2f::initClass();
-  SoComposeVec3f::initClass();
-  SoComposeVec4f::initClass();
-  SoDecomposeVec2f::initClass();
-  SoDecomposeVec3f::initClass();
-  SoDecomposeVec4f::initClass();
-  SoComposeRotation::initClass();
-  SoComposeRotationFromTo::initClass();
-  SoDecomposeRotation::initClass();
-  SoComposeMatrix::initClass();
-  SoDecomposeMatrix::initClass();
-  SoComputeBoundingBox::initClass();
-  SoConcatenate::initClass();
-  SoCounter::initClass();
-  SoElapsedTime::initClass();
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoBoolOperation, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoCalculator, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComposeVec2f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComposeVec3f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComposeVec4f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoDecomposeVec2f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoDecomposeVec3f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoDecomposeVec4f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComposeRotation, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComposeRotationFromTo, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoDecomposeRotation, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComposeMatrix, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoDecomposeMatrix, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoComputeBoundingBox, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoConcatenate, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoCounter, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoElapsedTime, SoEngine);
   SoFieldConverter::initClass();
-  SoGate::initClass();
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoGate, SoEngine);
   SoInterpolate::initClass();
     SoInterpolateFloat::initClass();
     SoInterpolateRotation::initClass();
     SoInterpolateVec2f::initClass();
     SoInterpolateVec3f::initClass();
     SoInterpolateVec4f::initClass();
-  SoOnOff::initClass();
-  SoOneShot::initClass();
-  SoSelectOne::initClass();
-  SoTimeCounter::initClass();
-  SoTransformVec3f::initClass();
-  SoTriggerAny::initClass();
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoOnOff, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoOneShot, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoSelectOne, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoTimeCounter, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoTransformVec3f, SoEngine);
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoTriggerAny, SoEngine);
   SoTexture2Convert::initClass();
-  SoHeightMapToNormalMap::initClass();
+  SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(SoHeightMapToNormalMap, SoTexture2Convert);
 }
 
 // Documented in superclass.
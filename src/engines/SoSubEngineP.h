@@ -55,6 +55,9 @@
 
 #define SO_ENGINE_INTERNAL_CONSTRUCTOR(_class_) \
   do { \
+    /* The class may not have been initialized yet, see */ \
+    /* SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(). */ \
+    (void)_class_::getClassTypeId(); \
     SO_ENGINE_CONSTRUCTOR(_class_); \
     /* Restore value of isBuiltIn flag (which is set to FALSE */ \
     /* in the SO_ENGINE_CONSTRUCTOR() macro). */ \
@@ -76,6 +79,15 @@
   } while (0)
 
 
+// Registers the class to be initialized the first time its type is
+// asked for, instead of right away.
+#define SO_ENGINE_INTERNAL_DEFER_INIT_CLASS(_class_, _parentclass_) \
+  do { \
+    SoType::deferInitClass(SO__QUOTE(_class_), SO__QUOTE(_parentclass_), \
+                           _class_::initClass); \
+  } while (0)
+
+
 #define SO_INTERPOLATE_INTERNAL_INIT_CLASS(_class_) \
  \
 void \
@@ -87,6 +87,14 @@ SoMF_Typename_::setValuesPtr(void * ptr)
   this->values = (So_Typename_ **)ptr;
 }
 
+SbBool
+SoMF_Typename_::shareValues(const SoMF_Typename_ & COIN_UNUSED_ARG(field))
+{
+  // Every field holds its own references to the _typename_s, so the
+  // values array can not be shared.
+  return FALSE;
+}
+
 int
 SoMF_Typename_::find(So_Typename_ * value, SbBool addifnotfound)
 {
@@ -2130,6 +2130,20 @@ SoField::evaluateField(void) const
     return;
   }
 
+  // Cast away the const. (evaluate() must be const, since we're using
+  // evaluate() from getValue().)
+  SoField * that = const_cast<SoField *>(this);
+
+  if (this->getStatus(FLAG_VALUESPENDING)) {
+    SOFIELD_RECLOCK;
+    // another thread might have loaded the values while we waited
+    if (this->getStatus(FLAG_VALUESPENDING)) {
+      that->loadPendingValues();
+      that->setValuesPending(FALSE);
+    }
+    SOFIELD_RECUNLOCK;
+  }
+
   if (!this->isConnected()) return;
 
   assert(this->storage != NULL);
@@ -2160,10 +2174,6 @@ SoField::evaluateField(void) const
     return;
   }
 
-  // Cast away the const. (evaluate() must be const, since we're using
-  // evaluate() from getValue().)
-  SoField * that = const_cast<SoField *>(this);
-
   // Check the NEEDEVALUATION flag in case some other thread has just
   // evaluated the field. The flag is checked in SoField::evaluate(),
   // but it is possible that two (or more) threads might enter
@@ -2195,9 +2205,49 @@ SoField::getDirty(void) const
 void
 SoField::setDirty(SbBool dirty)
 {
+  // values waiting to be loaded must be loaded on the next read
+  if (!dirty && this->getStatus(FLAG_VALUESPENDING)) return;
   (void) this->changeStatusBits(FLAG_NEEDEVALUATION, dirty);
 }
 
+/*!
+  Marks the values of this field as not yet loaded, for fields which
+  load their values on first access. While \a pending is \c TRUE, the
+  next read access will call loadPendingValues(), and clear the flag
+  afterwards.
+
+  \sa loadPendingValues()
+  \since Coin 4.0
+*/
+void
+SoField::setValuesPending(const SbBool pending)
+{
+  if (pending) {
+    // evaluate() only calls evaluateField() for fields with extended
+    // storage
+    this->extendStorageIfNecessary();
+    this->setStatusBits(FLAG_VALUESPENDING);
+    this->setDirty(TRUE);
+  }
+  else {
+    this->clearStatusBits(FLAG_VALUESPENDING);
+    if (!this->isConnected()) this->setDirty(FALSE);
+  }
+}
+
+/*!
+  Called on the first read access to a field with values marked as
+  pending by setValuesPending(), to load the values. The default
+  method does nothing.
+
+  \sa setValuesPending()
+  \since Coin 4.0
+*/
+void
+SoField::loadPendingValues(void)
+{
+}
+
 /*!
   Connect ourself as slave to another object, while still keeping the
   other connections currently in place.
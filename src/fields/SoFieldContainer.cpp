@@ -106,6 +106,11 @@ static void sofieldcontainer_copydict_cleanup(void);
 static void SoFieldContainer_cleanupClass(void);
 }
 
+static void sofieldcontainer_fields_memory_size(const SoFieldContainer * container,
+                                                size_t & managed,
+                                                size_t & unmanaged,
+                                                size_t & shared);
+
 SoType SoFieldContainer::classTypeId STATIC_SOTYPE_INIT;
 
 // used by setUserData() and getUserData()
@@ -1057,7 +1062,8 @@ SoFieldContainer::readInstance(SoInput * in, unsigned short flags)
   The \a managed argument returns the size of the fields that Coin manages the
   memory for, and the \a unmanaged argument returns the size of the data in
   the multi-fields controlled by the application through
-  SoMField::setValuesPointer() which Coin will not delete.
+  SoMField::setValuesPointer() which Coin will not delete, or through
+  an SbExternalBuffer (see SoMField::getValuesBuffer()).
 
   Data that is kept in the object memory chunk (that is included when you
   do sizeof(object)) is not included in these values - only the memory that
@@ -1070,15 +1076,45 @@ SoFieldContainer::readInstance(SoInput * in, unsigned short flags)
   This method is used for memory profiling purposes.
 
   \since Coin 3.0
+  \sa getFieldsSharedMemorySize()
 */
 void
 SoFieldContainer::getFieldsMemorySize(size_t & managed, size_t & unmanaged) const
+{
+  size_t shared;
+  sofieldcontainer_fields_memory_size(this, managed, unmanaged, shared);
+}
+
+/*!
+  Returns how much of the managed memory returned from
+  getFieldsMemorySize() is in multi-field value arrays which are
+  shared with fields in other field containers, typically after
+  copying a scene graph. Shared arrays are copied when one of the
+  fields sharing them is changed, see SoMField::isSharingValues().
+
+  This method is used for memory profiling purposes.
+
+  \since Coin 4.0
+*/
+size_t
+SoFieldContainer::getFieldsSharedMemorySize(void) const
+{
+  size_t managed, unmanaged, shared;
+  sofieldcontainer_fields_memory_size(this, managed, unmanaged, shared);
+  return shared;
+}
+
+static void
+sofieldcontainer_fields_memory_size(const SoFieldContainer * container,
+                                    size_t & managed, size_t & unmanaged,
+                                    size_t & shared)
 {
   managed = 0;
   unmanaged = 0;
+  shared = 0;
 
   SoFieldList fields;
-  int numfields = this->getAllFields(fields);
+  int numfields = container->getAllFields(fields);
   for (int c = 0; c < numfields; ++c) {
     const SoField * field = fields[c];
 
@@ -1243,13 +1279,14 @@ SoFieldContainer::getFieldsMemorySize(size_t & managed, size_t & unmanaged) cons
       if (mfield->isDeleteValuesEnabled()) {
         // assume this is a self-managed multi-field
         managed += elementsize * numelements;
+        if (mfield->isSharingValues()) shared += elementsize * numelements;
       } else {
         // assume setValuesPointer() has been used
         unmanaged += elementsize * numelements;
       }
     }
   }
-} // getMFieldsDataSize()
+} // sofieldcontainer_fields_memory_size()
 
 /*!
   Set a generic user data pointer for this field container.
@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store multiple boolean on/off or TRUE/FALSE values.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SoSFBool
 */
@@ -61,6 +61,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFBool, SbBool, SbBool);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFBool, SbBool, SbBool);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFBool);
 
 // *************************************************************************
 
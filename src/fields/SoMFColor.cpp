@@ -39,9 +39,9 @@
   needs to store multiple color values (i.e. "Red Green Blue"
   triplets).
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbColor, SoSFColor
 
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFColor, SbColor, const SbColor &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFColor, SbColor, float);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFColor, SbColor, SbColor);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFColor);
 
 // Override from parent.
 void
@@ -104,6 +105,7 @@ SoMFColor::write1Value(SoOutput * out, int idx) const
 void
 SoMFColor::setValues(int start, int numarg, const float rgb[][3])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->makeRoom(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
@@ -117,6 +119,7 @@ SoMFColor::setValues(int start, int numarg, const float rgb[][3])
 void
 SoMFColor::setHSVValues(int start, int numarg, const float hsv[][3])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->makeRoom(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
@@ -39,9 +39,9 @@
   needs to store multiple color values (i.e. "Red Green Blue"
   triplets).
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbColor4f, SoSFColorRGBA
 
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFColorRGBA, SbColor4f, const SbColor4f &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFColorRGBA, SbColor4f, float);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFColorRGBA, SbColor4f, SbColor4f);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFColorRGBA);
 
 // Override from parent.
 void
@@ -104,6 +105,7 @@ SoMFColorRGBA::write1Value(SoOutput * out, int idx) const
 void
 SoMFColorRGBA::setValues(int start, int numarg, const float rgba[][4])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->makeRoom(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
@@ -117,6 +119,7 @@ SoMFColorRGBA::setValues(int start, int numarg, const float rgba[][4])
 void
 SoMFColorRGBA::setHSVValues(int start, int numarg, const float hsva[][4])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->makeRoom(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
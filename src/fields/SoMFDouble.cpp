@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store a group of multiple floating point values.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SoSFDouble
   \since Coin 2.5
@@ -63,6 +63,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFDouble, double, double);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFDouble, double, double);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFDouble);
 
 // *************************************************************************
 
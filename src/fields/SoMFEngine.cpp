@@ -58,6 +58,7 @@
 
 #include <Inventor/fields/SoMFEngine.h>
 
+#include "coindefs.h"
 #include "SbBasicP.h"
 
 #include <Inventor/fields/SoSFEngine.h>
@@ -126,6 +127,14 @@ SoMFEngine::setValuesPtr(void * ptr)
   this->values = static_cast<SoEngine **>(ptr);
 }
 
+SbBool
+SoMFEngine::shareValues(const SoMFEngine & COIN_UNUSED_ARG(field))
+{
+  // Every field holds its own references to the engines, so the
+  // values array can not be shared.
+  return FALSE;
+}
+
 int
 SoMFEngine::find(SoEngine * value, SbBool addifnotfound)
 {
@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store a group of multiple floating point values.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SoSFFloat
 */
@@ -62,6 +62,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFFloat, float, float);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFFloat, float, float);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFFloat);
 
 // *************************************************************************
 
@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store a group of multiple 32-bit integer values.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SoSFInt32
 */
@@ -60,6 +60,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFInt32, int32_t, int32_t);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFInt32, int32_t, int32_t);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFInt32);
 
 
 // Override from parent.
@@ -108,6 +108,7 @@ SoMFName::write1Value(SoOutput * out, int idx) const
 void
 SoMFName::setValues(const int start, const int numarg, const char * strings[])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
@@ -60,6 +60,7 @@
 
 #include <Inventor/fields/SoMFNode.h>
 
+#include "coindefs.h"
 #include "SbBasicP.h"
 
 #include <Inventor/fields/SoSFNode.h>
@@ -130,6 +131,14 @@ SoMFNode::setValuesPtr(void * ptr)
   this->values = static_cast<SoNode **>(ptr);
 }
 
+SbBool
+SoMFNode::shareValues(const SoMFNode & COIN_UNUSED_ARG(field))
+{
+  // Every field holds its own references to the nodes, so the
+  // values array can not be shared.
+  return FALSE;
+}
+
 int
 SoMFNode::find(SoNode * value, SbBool addifnotfound)
 {
@@ -128,6 +128,14 @@ SoMFPath::setValuesPtr(void * ptr)
   this->values = static_cast<SoPath **>(ptr);
 }
 
+SbBool
+SoMFPath::shareValues(const SoMFPath & COIN_UNUSED_ARG(field))
+{
+  // Every field holds its own references to the paths, so the
+  // values array can not be shared.
+  return FALSE;
+}
+
 int
 SoMFPath::find(SoPath * value, SbBool addifnotfound)
 {
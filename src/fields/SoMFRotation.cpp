@@ -96,6 +96,7 @@ SoMFRotation::write1Value(SoOutput * out, int idx) const
 void
 SoMFRotation::setValues(const int start, const int numarg, const float q[][4])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
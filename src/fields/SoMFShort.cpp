@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store a group of multiple short integer values.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SoSFShort
 */
@@ -62,6 +62,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFShort, short, short);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFShort, short, short);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFShort);
 
 // *************************************************************************
 
@@ -94,6 +94,7 @@ SoMFString::write1Value(SoOutput * out, int idx) const
 void
 SoMFString::setValues(const int start, const int numarg, const char * strings[])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
@@ -119,6 +120,7 @@ void
 SoMFString::deleteText(const int fromline, const int fromchar,
                        const int toline, const int tochar)
 {
+  this->unshareValues();
 #if COIN_DEBUG && 1 // debug
   if (fromline < 0 || toline >= this->getNum() || fromline > toline ||
       (fromline == toline && fromchar >= tochar) ||
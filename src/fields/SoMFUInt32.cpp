@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store a group of multiple 32-bit unsigned integer values.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SoSFUInt32
 */
@@ -62,6 +62,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFUInt32, uint32_t, uint32_t);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFUInt32, uint32_t, uint32_t);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFUInt32);
 
 // *************************************************************************
 
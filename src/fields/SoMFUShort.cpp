@@ -35,9 +35,9 @@
   \brief The SoMFUShort class is a container for unsigned short integer values.
   \ingroup fields
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   This field is used where nodes, engines or other field containers
   needs to store a group of multiple short unsigned integer values.
@@ -62,6 +62,7 @@
 SO_MFIELD_SOURCE_MALLOC(SoMFUShort, unsigned short, unsigned short);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFUShort, unsigned short, unsigned short);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFUShort);
 
 // *************************************************************************
 
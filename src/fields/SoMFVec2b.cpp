@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with two elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec2b, SoSFVec2b
   \COIN_CLASS_EXTENSION
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFVec2b, SbVec2b, SbVec2b);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2b, SbVec2b, SbVec2b);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2b, SbVec2b, int8_t);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec2b);
 
 // *************************************************************************
 
@@ -108,6 +109,7 @@ SoMFVec2b::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec2b::setValues(int start, int numarg, const int8_t xy[][2])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
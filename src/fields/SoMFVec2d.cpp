@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with two elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec2d, SoSFVec2d
   \COIN_CLASS_EXTENSION
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFVec2d, SbVec2d, const SbVec2d &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2d, SbVec2d, SbVec2d);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2d, SbVec2d, double);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec2d);
 
 // *************************************************************************
 
@@ -108,6 +109,7 @@ SoMFVec2d::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec2d::setValues(int start, int numarg, const double xy[][2])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
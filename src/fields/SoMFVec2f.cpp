@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with two elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec2f, SoSFVec2f
 */
@@ -63,6 +63,7 @@ SO_MFIELD_SOURCE(SoMFVec2f, SbVec2f, const SbVec2f &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2f, SbVec2f, SbVec2f);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2f, SbVec2f, float);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec2f);
 
 // *************************************************************************
 
@@ -106,6 +107,7 @@ SoMFVec2f::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec2f::setValues(int start, int numarg, const float xy[][2])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
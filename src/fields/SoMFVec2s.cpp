@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with two elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec2s, SoSFVec2s
   \COIN_CLASS_EXTENSION
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFVec2s, SbVec2s, SbVec2s);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2s, SbVec2s, SbVec2s);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec2s, SbVec2s, short);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec2s);
 
 // *************************************************************************
 
@@ -108,6 +109,7 @@ SoMFVec2s::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec2s::setValues(int start, int numarg, const short xy[][2])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
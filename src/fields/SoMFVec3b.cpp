@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with three elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec3b, SoSFVec3b
   \COIN_CLASS_EXTENSION
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFVec3b, SbVec3b, SbVec3b);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec3b, SbVec3b, SbVec3b);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec3b, SbVec3b, int8_t);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec3b);
 
 // *************************************************************************
 
@@ -119,6 +120,7 @@ SoMFVec3b::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec3b::setValues(int start, int numarg, const int8_t xyz[][3])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
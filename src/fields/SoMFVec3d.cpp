@@ -56,6 +56,7 @@ SO_MFIELD_SOURCE(SoMFVec3d, SbVec3d, const SbVec3d &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec3d, SbVec3d, SbVec3d);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec3d, SbVec3d, double);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec3d);
 
 // *************************************************************************
 
@@ -104,6 +105,7 @@ SoMFVec3d::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec3d::setValues(int start, int numarg, const double xyz[][3])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
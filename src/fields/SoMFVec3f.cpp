@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with three elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec3f, SoSFVec3f
 */
@@ -63,6 +63,7 @@ SO_MFIELD_SOURCE(SoMFVec3f, SbVec3f, const SbVec3f &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec3f, SbVec3f, SbVec3f);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec3f, SbVec3f, float);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec3f);
 
 // *************************************************************************
 
@@ -117,6 +118,7 @@ SoMFVec3f::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec3f::setValues(int start, int numarg, const float xyz[][3])
 {
+  this->unshareValues();
   if (start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if (start+numarg > this->num) this->num = start+numarg;
 
@@ -167,6 +169,9 @@ SoMFVec3f::setValue(const float xyz[3])
 
 #ifdef COIN_TEST_SUITE
 
+#include <Inventor/SbExternalBuffer.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+
 BOOST_AUTO_TEST_CASE(initialized)
 {
   SoMFVec3f field;
@@ -175,4 +180,152 @@ BOOST_AUTO_TEST_CASE(initialized)
   BOOST_CHECK_EQUAL(field.getNum(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(copyOnWrite)
+{
+  const int num = 1000;
+  SoMFVec3f field1, field2, field3;
+  field1.setNum(num);
+  SbVec3f * values = field1.startEditing();
+  for (int i = 0; i < num; i++) values[i].setValue(float(i), 0.0f, 0.0f);
+  field1.finishEditing();
+
+  field2 = field1;
+  field3 = field2;
+  BOOST_CHECK(field1.isSharingValues() && field2.isSharingValues() &&
+              field3.isSharingValues());
+  BOOST_CHECK(field2.getValues(0) == field1.getValues(0));
+  BOOST_CHECK(field3.getValues(0) == field1.getValues(0));
+
+  field2.set1Value(10, SbVec3f(-1.0f, -1.0f, -1.0f));
+  BOOST_CHECK(!field2.isSharingValues());
+  BOOST_CHECK(field2.getValues(0) != field1.getValues(0));
+  BOOST_CHECK_EQUAL(field2.getNum(), num);
+  BOOST_CHECK_EQUAL(field1[10][0], 10.0f);
+  BOOST_CHECK_EQUAL(field3[10][0], 10.0f);
+  BOOST_CHECK_EQUAL(field2[10][0], -1.0f);
+  BOOST_CHECK_EQUAL(field2[999][0], 999.0f);
+
+  // the last two fields sharing the array
+  field3.startEditing()[0].setValue(5.0f, 5.0f, 5.0f);
+  field3.finishEditing();
+  BOOST_CHECK(!field3.isSharingValues());
+  BOOST_CHECK_EQUAL(field1[0][0], 0.0f);
+  BOOST_CHECK_EQUAL(field3[0][0], 5.0f);
+
+  // the first field now owns the array alone
+  field1.setNum(num / 2);
+  BOOST_CHECK(!field1.isSharingValues());
+  BOOST_CHECK_EQUAL(field1.getNum(), num / 2);
+  BOOST_CHECK_EQUAL(field1[499][0], 499.0f);
+
+  // small arrays are copied
+  SoMFVec3f small;
+  small.setValue(SbVec3f(1.0f, 2.0f, 3.0f));
+  field2 = small;
+  BOOST_CHECK(!field2.isSharingValues());
+  BOOST_CHECK_EQUAL(field2.getNum(), 1);
+
+  // data set through setValuesPointer() is copied
+  SbVec3f * userdata = new SbVec3f[num];
+  SoMFVec3f user;
+  user.setValuesPointer(num, userdata);
+  field2 = user;
+  BOOST_CHECK(!field2.isSharingValues() && !user.isSharingValues());
+  BOOST_CHECK(field2.getValues(0) != userdata);
+  user.setValuesPointer(0, static_cast<SbVec3f *>(NULL));
+  delete[] userdata;
+}
+
+BOOST_AUTO_TEST_CASE(copyOnWriteNodeCopy)
+{
+  SoCoordinate3 * coords = new SoCoordinate3;
+  coords->ref();
+  coords->point.setNum(1000);
+  BOOST_CHECK_EQUAL(coords->getFieldsSharedMemorySize(), size_t(0));
+
+  SoCoordinate3 * copy = static_cast<SoCoordinate3 *>(coords->copy());
+  copy->ref();
+  BOOST_CHECK(copy->point.getValues(0) == coords->point.getValues(0));
+  BOOST_CHECK_EQUAL(copy->getFieldsSharedMemorySize(),
+                    1000 * sizeof(SbVec3f));
+  coords->unref();
+
+  // the copy is the only owner left, so writing does not copy
+  const SbVec3f * values = copy->point.getValues(0);
+  copy->point.set1Value(0, SbVec3f(1.0f, 1.0f, 1.0f));
+  BOOST_CHECK(copy->point.getValues(0) == values);
+  BOOST_CHECK_EQUAL(copy->getFieldsSharedMemorySize(), size_t(0));
+  copy->unref();
+}
+
+static void
+release_points(void * closure, void * data, size_t)
+{
+  (*static_cast<int *>(closure))++;
+  delete[] static_cast<SbVec3f *>(data);
+}
+
+BOOST_AUTO_TEST_CASE(externalBuffer)
+{
+  const int num = 100;
+  int released = 0;
+  SbVec3f * points = new SbVec3f[num + 1];
+  for (int i = 0; i < num + 1; i++) points[i].setValue(float(i), 0.0f, 0.0f);
+  SbExternalBuffer * buffer =
+    new SbExternalBuffer(points, (num + 1) * sizeof(SbVec3f),
+                         SbExternalBuffer::READ_ONLY, release_points, &released);
+
+  SoCoordinate3 * coords = new SoCoordinate3;
+  coords->ref();
+  coords->point.setValuesBuffer(num, buffer, sizeof(SbVec3f));
+  BOOST_CHECK(coords->point.getValuesBuffer() == buffer);
+  BOOST_CHECK(coords->point.getValues(0) == points + 1);
+  BOOST_CHECK_EQUAL(coords->point.getNum(), num);
+  BOOST_CHECK_EQUAL(buffer->getRefCount(), 1);
+
+  // copies use the buffer too, also for small arrays
+  SoCoordinate3 * copy = static_cast<SoCoordinate3 *>(coords->copy());
+  copy->ref();
+  BOOST_CHECK(copy->point.getValues(0) == points + 1);
+  BOOST_CHECK(copy->point.getValuesBuffer() == buffer);
+  coords->unref();
+  BOOST_CHECK_EQUAL(released, 0);
+
+  // a read-only buffer is copied before it is written to
+  copy->point.set1Value(0, SbVec3f(-1.0f, -1.0f, -1.0f));
+  BOOST_CHECK(copy->point.getValues(0) != points + 1);
+  BOOST_CHECK(copy->point.getValuesBuffer() == NULL);
+  BOOST_CHECK_EQUAL(copy->point.getNum(), num);
+  BOOST_CHECK_EQUAL(copy->point[1][0], 2.0f);
+  BOOST_CHECK_EQUAL(released, 1);
+  copy->unref();
+
+  // a writable buffer is written to in place by its only user
+  points = new SbVec3f[num];
+  for (int i = 0; i < num; i++) points[i].setValue(0.0f, 0.0f, 0.0f);
+  buffer = new SbExternalBuffer(points, num * sizeof(SbVec3f),
+                                SbExternalBuffer::READ_WRITE,
+                                release_points, &released);
+  SoMFVec3f field;
+  field.setValuesBuffer(num, buffer);
+  field.set1Value(5, SbVec3f(5.0f, 5.0f, 5.0f));
+  field.startEditing()[6].setValue(6.0f, 6.0f, 6.0f);
+  field.finishEditing();
+  BOOST_CHECK(field.getValuesBuffer() == buffer);
+  BOOST_CHECK_EQUAL(points[5][0], 5.0f);
+  BOOST_CHECK_EQUAL(points[6][0], 6.0f);
+
+  // ..but not when it grows, or when it is shared
+  SoMFVec3f other;
+  other = field;
+  other.set1Value(7, SbVec3f(7.0f, 7.0f, 7.0f));
+  BOOST_CHECK(other.getValuesBuffer() == NULL);
+  BOOST_CHECK_EQUAL(points[7][0], 0.0f);
+  field.set1Value(num, SbVec3f(1.0f, 1.0f, 1.0f));
+  BOOST_CHECK(field.getValuesBuffer() == NULL);
+  BOOST_CHECK_EQUAL(field.getNum(), num + 1);
+  BOOST_CHECK_EQUAL(field[5][0], 5.0f);
+  BOOST_CHECK_EQUAL(released, 2);
+}
+
 #endif // COIN_TEST_SUITE
@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with four elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec4i32, SoSFVec4i32
   \COIN_CLASS_EXTENSION
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFVec4i32, SbVec4i32, const SbVec4i32 &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec4i32, SbVec4i32, SbVec4i32);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec4i32, SbVec4i32, int32_t);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec4i32);
 
 // *************************************************************************
 
@@ -110,6 +111,7 @@ SoMFVec4i32::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec4i32::setValues(int start, int numarg, const int32_t xyzw[][4])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
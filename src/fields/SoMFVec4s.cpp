@@ -38,9 +38,9 @@
   This field is used where nodes, engines or other field containers
   needs to store an array of vectors with four elements.
 
-  This field supports application data sharing through a
-  setValuesPointer() method. See SoMField documentation for
-  information on how to use this function.
+  This field supports application data sharing through the
+  setValuesPointer() and setValuesBuffer() methods. See SoMField
+  documentation for information on how to use these functions.
 
   \sa SbVec4s, SoSFVec4s
   \COIN_CLASS_EXTENSION
@@ -65,6 +65,7 @@ SO_MFIELD_SOURCE(SoMFVec4s, SbVec4s, const SbVec4s &);
 
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec4s, SbVec4s, SbVec4s);
 SO_MFIELD_SETVALUESPOINTER_SOURCE(SoMFVec4s, SbVec4s, short);
+SO_MFIELD_SETVALUESBUFFER_SOURCE(SoMFVec4s);
 
 // *************************************************************************
 
@@ -110,6 +111,7 @@ SoMFVec4s::write1Value(SoOutput * out, int idx) const
 void
 SoMFVec4s::setValues(int start, int numarg, const short xyzw[][4])
 {
+  this->unshareValues();
   if(start+numarg > this->maxNum) this->allocValues(start+numarg);
   else if(start+numarg > this->num) this->num = start+numarg;
 
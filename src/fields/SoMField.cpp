@@ -235,6 +235,27 @@
   very careful about how your application and DLLs are linked to the
   underlying C library.
 
+  The same fields also support setValuesBuffer(), which uses the
+  memory of a reference counted SbExternalBuffer, for instance a
+  memory mapped file, as the values array:
+
+  \code
+
+  SbExternalBuffer * buffer = SbExternalBuffer::mapFile("result.bin");
+  mynode->point.setValuesBuffer(int(buffer->getSize() / sizeof(SbVec3f)), buffer);
+
+  \endcode
+
+  Unlike with setValuesPointer(), the field keeps a reference to the
+  buffer, so that it stays valid for as long as the field uses it, and
+  copying the field (or the node it belongs to) shares the buffer
+  instead of copying the values, like other large arrays are shared
+  (see isSharingValues()). A field using a READ_ONLY buffer copies the
+  values the first time it is changed, while changes to a field using
+  a READ_WRITE buffer are written to the buffer, as long as no other
+  field shares it and the number of values stays the same. Reading
+  the field from file replaces the buffer.
+
   \sa SoSField
 */
 
@@ -243,15 +264,25 @@
 #include <Inventor/fields/SoMField.h>
 
 #include <cassert>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 
+#include <Inventor/SbExternalBuffer.h>
 #include <Inventor/SoInput.h>
 #include <Inventor/SoOutput.h>
 #include <Inventor/errors/SoDebugError.h>
 #include <Inventor/errors/SoReadError.h>
 #include <Inventor/fields/SoSubField.h>
-
+#include <Inventor/fields/SoMFEngine.h>
+#include <Inventor/fields/SoMFNode.h>
+#include <Inventor/fields/SoMFPath.h>
+#include <Inventor/fields/SoFieldContainer.h>
+
+#include "io/SoChunkedFile.h"
+#include "io/SoInputP.h"
+#include "io/SoOutput_Writer.h"
+#include "misc/SbHash.h"
 #include "threads/threadsutilp.h"
 #include "tidbitsp.h"
 #include "coindefs.h" // COIN_WORKAROUND_*
@@ -283,6 +314,14 @@ using std::strlen;
   Is \c TRUE if data has been set through a setValuesPointer() call
   and set to \c FALSE through a enableDeleteValues() call.
 */
+/*!
+  \var SbBool SoMField::valuesAreShared
+  Is \c TRUE if the values array may be shared with other fields of
+  the same type. See shareValues(). If userDataIsUsed is \c TRUE as
+  well, the array is the memory of an SbExternalBuffer.
+
+  \since Coin 4.0
+*/
 
 // *************************************************************************
 
@@ -297,6 +336,74 @@ somfield_mutex_cleanup(void)
   CC_MUTEX_DESTRUCT(somfield_mutex);
 }
 
+// Number of fields sharing each shared values array, keyed on the
+// array address, and the SbExternalBuffer the array belongs to, if
+// any. Fields only look here when they start or stop sharing an
+// array, never when reading it.
+struct somfield_sharedvalues_entry {
+  int count;
+  SbExternalBuffer * buffer;
+};
+static SbHash<size_t, somfield_sharedvalues_entry> * somfield_sharedvalues = NULL;
+static void * somfield_sharedvalues_mutex = NULL;
+
+// Arrays smaller than this (in bytes) are cheaper to copy than to share.
+static const int SOMFIELD_MIN_SHARED_SIZE = 256;
+
+// Fields read from a chunked file (see SoOutput::setCompression())
+// whose values have not been loaded yet, keyed on the field address,
+// with the chunk holding their values. Also guarded by
+// somfield_sharedvalues_mutex.
+struct somfield_pendingvalues_entry {
+  SoChunkedFile * file;
+  int chunk;
+};
+static SbHash<size_t, somfield_pendingvalues_entry> * somfield_pendingvalues = NULL;
+
+// Arrays smaller than this (in bytes) are written inline in chunked
+// files, as usual.
+static const int SOMFIELD_MIN_CHUNK_SIZE = 16384;
+
+static void
+somfield_sharedvalues_cleanup(void)
+{
+  delete somfield_sharedvalues;
+  somfield_sharedvalues = NULL;
+  delete somfield_pendingvalues;
+  somfield_pendingvalues = NULL;
+  CC_MUTEX_DESTRUCT(somfield_sharedvalues_mutex);
+}
+
+// Takes the pending values entry of field out of the table. Returns
+// FALSE if there was none.
+static SbBool
+somfield_take_pendingvalues(const SoMField * field,
+                            somfield_pendingvalues_entry & entry)
+{
+  CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+  const SbBool found = somfield_pendingvalues->get((size_t) field, entry);
+  if (found) (void) somfield_pendingvalues->erase((size_t) field);
+  CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+  return found;
+}
+
+// Returns TRUE if the values of field should be written to a chunk
+// of their own in out.
+static SbBool
+somfield_write_chunk(const SoMField * field, SoOutput * out,
+                     const int num, const int fieldsize)
+{
+  if (out->getStage() != SoOutput::WRITE) return FALSE;
+  if (num * fieldsize < SOMFIELD_MIN_CHUNK_SIZE) return FALSE;
+  if (SoOutput_Writer::getWriter(out)->getType() !=
+      SoOutput_Writer::CHUNKEDFILE) return FALSE;
+  // references to other objects are resolved in the scene graph chunk
+  const SoType type = field->getTypeId();
+  return !(type.isDerivedFrom(SoMFNode::getClassTypeId()) ||
+           type.isDerivedFrom(SoMFEngine::getClassTypeId()) ||
+           type.isDerivedFrom(SoMFPath::getClassTypeId()));
+}
+
 // *************************************************************************
 
 // Overridden from parent class.
@@ -314,6 +421,11 @@ SoMField::initClass(void)
 
   CC_MUTEX_CONSTRUCT(somfield_mutex);
   coin_atexit(somfield_mutex_cleanup, CC_ATEXIT_NORMAL);
+
+  somfield_sharedvalues = new SbHash<size_t, somfield_sharedvalues_entry>;
+  somfield_pendingvalues = new SbHash<size_t, somfield_pendingvalues_entry>;
+  CC_MUTEX_CONSTRUCT(somfield_sharedvalues_mutex);
+  coin_atexit(somfield_sharedvalues_cleanup, CC_ATEXIT_NORMAL);
 }
 
 void
@@ -330,6 +442,7 @@ SoMField::SoMField(void)
 {
   this->maxNum = this->num = 0;
   this->userDataIsUsed = FALSE;
+  this->valuesAreShared = FALSE;
 }
 
 /*!
@@ -362,6 +475,7 @@ SoMField::makeRoom(int newnum)
 SbBool
 SoMField::set1(const int index, const char * const valuestring)
 {
+  this->unshareValues();
   int oldnum = this->num;
   // make sure the array has room for the new item
   if (index >= this->maxNum) this->allocValues(index+1);
@@ -471,11 +585,54 @@ SoMField::readValue(SoInput * in)
     return FALSE; \
   }
 
+  // All values are replaced, so a shared array is let go of instead
+  // of copied.
+  if (this->valuesAreShared) this->allocValues(0);
+
   // ** Binary format ******************************************************
   if (in->isBinary()) {
     int numtoread;
     READ_VAL(numtoread);
 
+    // A negative number is a reference to a chunk of a chunked
+    // file, followed by the number of values in the chunk. The
+    // values are loaded on first access, unless the chunk was
+    // decompressed while opening the file.
+    SoChunkedFile * file = SoInputP::getChunkedFile(in);
+    if (numtoread < 0 && file) {
+      // INT_MIN can't be negated, and is rejected as chunk 0
+      const int chunk = (numtoread == INT_MIN) ? 0 : -numtoread;
+      READ_VAL(numtoread);
+      if (chunk <= 0 || chunk >= file->getNumChunks() || numtoread < 0) {
+        SoReadError::post(in, "invalid chunk %d with %d values in field",
+                          chunk, numtoread);
+        return FALSE;
+      }
+      this->makeRoom(0);
+      CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+      somfield_pendingvalues_entry entry = { file, chunk };
+      somfield_pendingvalues->put((size_t) this, entry);
+      CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+      file->ref();
+
+      // pending values are treated as shared, so that they are
+      // loaded before they are changed (see claimSharedValues())
+      this->valuesAreShared = TRUE;
+      this->num = numtoread;
+      this->setValuesPending(TRUE);
+      this->valueChanged();
+
+      if (file->isDecompressed(chunk)) {
+        this->evaluate();
+        if (this->num != numtoread) {
+          SoReadError::post(in, "could not read values of field from chunk %d",
+                            chunk);
+          return FALSE;
+        }
+      }
+      return TRUE;
+    }
+
     // Sanity checking on the value, to avoid barfing on corrupt
     // files.
     if (numtoread < 0) {
@@ -566,6 +723,28 @@ void
 SoMField::writeValue(SoOutput * out) const
 {
   if (out->isBinary()) {
+    const int count = this->getNum();
+    if (somfield_write_chunk(this, out, count, this->fieldSizeof())) {
+      SoOutput chunkout;
+      chunkout.setBinary(TRUE);
+      size_t size = 65536;
+      void * buf = malloc(size);
+      chunkout.setBuffer(buf, size, realloc);
+      this->writeBinaryValues(&chunkout);
+      (void) chunkout.getBuffer(buf, size);
+
+      SbName fieldname;
+      SoFieldContainer * container = this->getContainer();
+      if (container) (void) container->getFieldName(this, fieldname);
+      const int chunk = static_cast<SoOutput_ChunkedFileWriter *>
+        (SoOutput_Writer::getWriter(out))->addChunk(buf, size, fieldname);
+      free(buf);
+      if (chunk > 0) {
+        out->write(-chunk);
+        out->write(count);
+        return;
+      }
+    }
     this->writeBinaryValues(out);
     return;
   }
@@ -695,7 +874,9 @@ SoMField::deleteValues(int start, int numarg)
   }
 #endif // COIN_DEBUG
 
-  // Move elements downward to fill the gap.
+  // Move elements downward to fill the gap, in a copy of the array if
+  // it is shared.
+  if (this->valuesAreShared && end < oldnum) this->allocValues(oldnum);
   for (int i = 0; i < oldnum-(start+numarg); i++)
     this->copyValue(start+i, start+numarg+i);
 
@@ -721,6 +902,9 @@ SoMField::deleteValues(int start, int numarg)
 void
 SoMField::enableDeleteValues(void)
 {
+  // memory from an SbExternalBuffer is returned through its release
+  // callback, never deleted by the field
+  if (this->valuesAreShared) return;
   this->userDataIsUsed = FALSE;
 }
 
@@ -789,15 +973,21 @@ SoMField::allocValues(int newnum)
 
   assert(newnum >= 0);
 
+  // A buffer shared with other fields must be copied before it is
+  // changed, unless the other fields have let go of it already.
+  void * sharedvalues = this->valuesPtr();
+  const SbBool copyshared =
+    this->valuesAreShared && !this->claimSharedValues(newnum);
+
   if (newnum == 0) {
-    if (!this->userDataIsUsed) {
+    if (!this->userDataIsUsed && !copyshared) {
       delete[] static_cast<unsigned char *>(this->valuesPtr());
     }
     this->setValuesPtr(NULL);
     this->userDataIsUsed = FALSE;
     this->maxNum = 0;
   }
-  else if (newnum > this->maxNum || newnum < this->num) {
+  else if (copyshared || newnum > this->maxNum || newnum < this->num) {
     int fsize = this->fieldSizeof();
     if (this->valuesPtr()) {
 
@@ -820,7 +1010,7 @@ SoMField::allocValues(int newnum)
 
 #endif // debug
 
-      if (oldmaxnum != this->maxNum) {
+      if (copyshared || oldmaxnum != this->maxNum) {
         // FIXME: Umm.. aren't we supposed to use realloc() here?
         // 20000915 mortene.
         unsigned char * newblock = new unsigned char[this->maxNum * fsize];
@@ -833,7 +1023,7 @@ SoMField::allocValues(int newnum)
         if (rest > 0) {
           (void)memset(newblock + copysize, 0, rest);
         }
-        if (!this->userDataIsUsed) {
+        if (!this->userDataIsUsed && !copyshared) {
           delete[] static_cast<unsigned char *>(this->valuesPtr());
         }
         this->setValuesPtr(newblock);
@@ -852,9 +1042,305 @@ SoMField::allocValues(int newnum)
   }
 
   this->num = newnum;
+  if (copyshared && this->releaseSharedValues(sharedvalues)) {
+    delete[] static_cast<unsigned char *>(sharedvalues);
+  }
 }
 #endif // DOXYGEN_SKIP_THIS
 
+/*!
+  Makes this field share the values array of \a field, which must be
+  of the same type, instead of copying it. Used from the assignment
+  operator of the field classes.
+
+  The array is only copied once one of the fields sharing it is
+  changed, through any of the methods which write to the values
+  array (like setValues(), set1Value() or startEditing()). Arrays
+  set through setValuesPointer() are never shared, neither are
+  small arrays, where copying is cheaper than keeping track of the
+  sharing. Arrays set through setValuesBuffer() are always shared.
+
+  Returns \c TRUE if the array is shared (or if \a field is this
+  field), or \c FALSE if the caller should copy the values.
+
+  \sa isSharingValues()
+  \since Coin 4.0
+*/
+SbBool
+SoMField::shareValues(const SoMField & field)
+{
+  if (this == &field) return TRUE;
+
+  SoMField & source = const_cast<SoMField &>(field);
+  source.evaluate();
+  void * values = source.valuesPtr();
+  const SbBool external = source.valuesAreShared && source.userDataIsUsed;
+  if (!values || (this->userDataIsUsed && !this->valuesAreShared)) {
+    return FALSE;
+  }
+  if (!external && (source.userDataIsUsed ||
+                    source.num * source.fieldSizeof() < SOMFIELD_MIN_SHARED_SIZE)) {
+    return FALSE;
+  }
+
+  this->allocValues(0);
+
+  CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+  somfield_sharedvalues_entry entry = { 0, NULL };
+  if (source.valuesAreShared) {
+    SbBool found = somfield_sharedvalues->get((size_t) values, entry);
+    assert(found); (void) found;
+  }
+  else {
+    entry.count = 1;
+  }
+  entry.count++;
+  somfield_sharedvalues->put((size_t) values, entry);
+  CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+
+  source.valuesAreShared = TRUE;
+  this->setValuesPtr(values);
+  this->num = source.num;
+  this->maxNum = source.maxNum;
+  this->valuesAreShared = TRUE;
+  this->userDataIsUsed = external;
+
+  this->setChangedIndices(0, this->num);
+  this->valueChanged();
+  this->setChangedIndices();
+  return TRUE;
+}
+
+/*!
+  Returns \c TRUE if the shared values array may be changed in place
+  to hold \a newnum values, which is the case when no other fields
+  use it anymore. This field then stops sharing the array and owns it
+  again, unless it belongs to an SbExternalBuffer, which may only be
+  changed in place if it is writable and \a newnum is the current
+  number of values.
+
+  Otherwise returns \c FALSE, and the array must be copied before it
+  is changed. Call releaseSharedValues() once the copy is done.
+
+  \since Coin 4.0
+*/
+SbBool
+SoMField::claimSharedValues(const int newnum)
+{
+  assert(this->valuesAreShared);
+
+  // values which are not loaded yet are dropped if they are all
+  // replaced, and loaded otherwise
+  if (this->valuesPtr() == NULL) {
+    if (newnum == 0) {
+      somfield_pendingvalues_entry entry;
+      if (somfield_take_pendingvalues(this, entry)) entry.file->unref();
+      this->valuesAreShared = FALSE;
+      this->setValuesPending(FALSE);
+    }
+    else {
+      this->evaluate();
+    }
+    return TRUE;
+  }
+
+  const size_t key = (size_t) this->valuesPtr();
+
+  CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+  somfield_sharedvalues_entry entry = { 0, NULL };
+  SbBool found = somfield_sharedvalues->get(key, entry);
+  assert(found && entry.count > 0); (void) found;
+  SbBool claimed = (entry.count == 1);
+  if (entry.buffer) {
+    claimed = claimed && entry.buffer->isWritable() && newnum == this->num;
+  }
+  else if (claimed) {
+    (void) somfield_sharedvalues->erase(key);
+  }
+  CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+
+  if (claimed && !entry.buffer) this->valuesAreShared = FALSE;
+  return claimed;
+}
+
+// Loads the values of a field read from a chunked file. Called from
+// SoField::evaluateField() on first access.
+void
+SoMField::loadPendingValues(void)
+{
+  somfield_pendingvalues_entry entry;
+  if (!somfield_take_pendingvalues(this, entry)) return;
+
+  const int numvalues = this->num;
+  this->valuesAreShared = FALSE;
+  this->num = 0;
+
+  size_t size;
+  unsigned char * data = entry.file->readChunk(entry.chunk, size);
+  SbBool ok = FALSE;
+  if (data) {
+    SoInput in;
+    in.setBuffer(data, size);
+    const SbBool notify = this->enableNotify(FALSE);
+    ok = this->readValue(&in) && (this->num == numvalues);
+    (void) this->enableNotify(notify);
+  }
+  if (!ok) {
+    SoDebugError::post("SoMField::loadPendingValues",
+                       "could not read %d values from chunk %d of '%s'",
+                       numvalues, entry.chunk,
+                       entry.file->getFilename().getString());
+    if (this->num) this->allocValues(0);
+  }
+  free(data);
+  entry.file->unref();
+}
+
+/*!
+  Stops sharing \a values, the array this field shared with other
+  fields before it got a copy of its own (or no values at all).
+  Returns \c TRUE if the other fields let go of the array in the
+  meantime, so that the caller must delete it.
+
+  The array of an SbExternalBuffer is never deleted. The buffer is
+  unreferenced when the last field stops using it instead.
+
+  \since Coin 4.0
+*/
+SbBool
+SoMField::releaseSharedValues(const void * values)
+{
+  assert(this->valuesAreShared);
+  const size_t key = (size_t) values;
+
+  CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+  somfield_sharedvalues_entry entry = { 0, NULL };
+  SbBool found = somfield_sharedvalues->get(key, entry);
+  assert(found && entry.count > 0); (void) found;
+  if (entry.count == 1) { (void) somfield_sharedvalues->erase(key); }
+  else {
+    entry.count--;
+    somfield_sharedvalues->put(key, entry);
+    entry.count++;
+  }
+  CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+
+  this->valuesAreShared = FALSE;
+  if (entry.buffer) {
+    if (entry.count == 1) entry.buffer->unref();
+    return FALSE;
+  }
+  return (entry.count == 1);
+}
+
+/*!
+  Makes the \a numarg values at byte offset \a offset of \a buffer
+  the values of this field, without copying them. Used by the
+  setValuesBuffer() method of the field classes which support it,
+  which are the same as those which support setValuesPointer().
+
+  The field references the buffer for as long as it uses it. A \c
+  NULL buffer or a \a numarg of zero clears the field.
+
+  \since Coin 4.0
+*/
+void
+SoMField::bindValuesBuffer(const int numarg, SbExternalBuffer * buffer,
+                           const size_t offset)
+{
+  // a buffer nobody has referenced yet is destructed on the way out
+  // if it is not used
+  if (buffer) buffer->ref();
+
+  this->makeRoom(0);
+  if (numarg > 0 && buffer) {
+    const size_t size = size_t(numarg) * this->fieldSizeof();
+    void * values =
+      static_cast<unsigned char *>(const_cast<void *>(buffer->getData())) + offset;
+    SbBool found = FALSE, inuse = FALSE;
+
+    if (offset > buffer->getSize() || size > buffer->getSize() - offset) {
+      SoDebugError::post("SoMField::setValuesBuffer",
+                         "%d values at offset %lu do not fit in a buffer "
+                         "of %lu bytes", numarg, (unsigned long) offset,
+                         (unsigned long) buffer->getSize());
+      values = NULL;
+    }
+    else {
+      CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+      somfield_sharedvalues_entry entry = { 0, buffer };
+      found = somfield_sharedvalues->get((size_t) values, entry);
+      // the memory may be the shared values of fields which do not
+      // use this buffer
+      inuse = found && entry.buffer != buffer;
+      if (!inuse) {
+        entry.count++;
+        somfield_sharedvalues->put((size_t) values, entry);
+      }
+      CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+      if (inuse) {
+        SoDebugError::post("SoMField::setValuesBuffer",
+                           "the buffer memory is used by other fields");
+        values = NULL;
+      }
+    }
+
+    if (values) {
+      if (!found) buffer->ref();
+      this->setValuesPtr(values);
+      this->num = this->maxNum = numarg;
+      this->userDataIsUsed = TRUE;
+      this->valuesAreShared = TRUE;
+      this->setChangedIndices(0, this->num);
+    }
+  }
+  this->valueChanged();
+  this->setChangedIndices();
+
+  if (buffer) buffer->unref();
+}
+
+/*!
+  Returns the buffer this field uses as its values array, or \c NULL
+  if it does not use one.
+
+  \sa setValuesBuffer()
+  \since Coin 4.0
+*/
+SbExternalBuffer *
+SoMField::getValuesBuffer(void) const
+{
+  if (!this->valuesAreShared || !this->userDataIsUsed) return NULL;
+
+  SoMField * that = const_cast<SoMField *>(this);
+  CC_MUTEX_LOCK(somfield_sharedvalues_mutex);
+  somfield_sharedvalues_entry entry = { 0, NULL };
+  (void) somfield_sharedvalues->get((size_t) that->valuesPtr(), entry);
+  CC_MUTEX_UNLOCK(somfield_sharedvalues_mutex);
+  return entry.buffer;
+}
+
+/*!
+  \fn void SoMField::unshareValues(void)
+
+  Makes sure the values array is not shared with other fields, by
+  copying it if necessary. Must be called before writing to the
+  values array.
+
+  \since Coin 4.0
+*/
+
+/*!
+  \fn SbBool SoMField::isSharingValues(void) const
+
+  Returns \c TRUE if the values array of this field may be shared
+  with other fields. This happens when a field is assigned from
+  another field, for instance when copying nodes, and lasts until one
+  of the fields is changed.
+
+  \since Coin 4.0
+*/
+
 SoNotRec
 SoMField::createNotRec(SoBase * cont)
 {
@@ -0,0 +1,545 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "io/SoChunkedFile.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Inventor/C/tidbits.h>
+#include <Inventor/C/threads/wsched.h>
+#include <Inventor/SbBasic.h>
+#include <Inventor/errors/SoDebugError.h>
+
+#include "glue/zlib.h"
+#include "threads/atomicp.h"
+#include "threads/threadsutilp.h"
+#include "threads/wschedp.h"
+
+// *************************************************************************
+
+// stuff copied from the zlib.h header file, like in gzmemio.cpp (we
+// want to avoid including it here so that zlib is not required to
+// compile Coin)
+struct internal_state;
+typedef void * (*alloc_func)(void * opaque, unsigned int items, unsigned int size);
+typedef void   (*free_func)(void * opaque, void * address);
+
+#define Z_DEFAULT_STRATEGY 0
+#define Z_OK 0
+#define Z_STREAM_END 1
+#define Z_FINISH 4
+#define Z_DEFLATED 8
+#define MAX_WBITS 15
+
+typedef struct {
+  unsigned char * next_in;
+  unsigned int avail_in;
+  unsigned long total_in;
+
+  unsigned char * next_out;
+  unsigned int avail_out;
+  unsigned long total_out;
+
+  char * msg;
+  struct internal_state * state;
+
+  alloc_func zalloc;
+  free_func zfree;
+  void * opaque;
+
+  int data_type;
+  unsigned long adler;
+  unsigned long reserved;
+} sochunkedfile_z_stream;
+
+// *************************************************************************
+
+static const unsigned char SOCHUNKEDFILE_MAGIC[8] = {
+  'C', 'O', 'I', 'N', 'C', 'H', 'N', 'K'
+};
+
+// Chunks smaller than this are decompressed when the file is opened,
+// the others when they are read.
+static size_t
+sochunkedfile_lazy_size(void)
+{
+  static size_t lazysize = 0;
+  if (lazysize == 0) {
+    const char * env = coin_getenv("COIN_CHUNKED_LAZY_SIZE");
+    lazysize = (env && atol(env) > 0) ? (size_t) atol(env) : 1024 * 1024;
+  }
+  return lazysize;
+}
+
+// Decompressing less than this in total is not worth splitting up
+// between threads.
+static const size_t MIN_PARALLEL_BYTES = 256 * 1024;
+
+static void
+sochunkedfile_put32(SbList<unsigned char> & buf, const uint32_t val)
+{
+  for (int i = 3; i >= 0; i--) buf.append((unsigned char) (val >> (i * 8)));
+}
+
+static void
+sochunkedfile_put64(SbList<unsigned char> & buf, const uint64_t val)
+{
+  sochunkedfile_put32(buf, (uint32_t) (val >> 32));
+  sochunkedfile_put32(buf, (uint32_t) val);
+}
+
+static void
+sochunkedfile_putname(SbList<unsigned char> & buf, const SbName & name)
+{
+  const uint32_t len = name.getLength();
+  sochunkedfile_put32(buf, len);
+  for (uint32_t i = 0; i < len; i++) buf.append((unsigned char) name[i]);
+}
+
+// Reads integers and names from the table of contents, and remembers
+// whether it ran past the end.
+class SoChunkedFileParser {
+public:
+  SoChunkedFileParser(const unsigned char * buf, const size_t size)
+    : ptr(buf), end(buf + size), ok(TRUE) { }
+
+  uint32_t get32(void) {
+    if (this->end - this->ptr < 4) { this->ok = FALSE; return 0; }
+    const uint32_t val =
+      (uint32_t(this->ptr[0]) << 24) | (uint32_t(this->ptr[1]) << 16) |
+      (uint32_t(this->ptr[2]) << 8) | uint32_t(this->ptr[3]);
+    this->ptr += 4;
+    return val;
+  }
+  uint64_t get64(void) {
+    const uint64_t hi = this->get32();
+    return (hi << 32) | this->get32();
+  }
+  SbName getName(void) {
+    const uint32_t len = this->get32();
+    if ((size_t) (this->end - this->ptr) < len) { this->ok = FALSE; }
+    if (!this->ok || len == 0) return SbName::empty();
+    const SbString str((const char *) this->ptr, 0, int(len) - 1);
+    this->ptr += len;
+    return SbName(str);
+  }
+
+  const unsigned char * ptr;
+  const unsigned char * end;
+  SbBool ok;
+};
+
+static unsigned char *
+sochunkedfile_inflate(const unsigned char * data, const size_t compressedsize,
+                      const size_t size)
+{
+  unsigned char * out = (unsigned char *) malloc(size ? size : 1);
+  if (!out) return NULL;
+
+  sochunkedfile_z_stream stream;
+  (void) memset(&stream, 0, sizeof(stream));
+  if (cc_zlibglue_inflateInit2(&stream, MAX_WBITS) != Z_OK) {
+    free(out);
+    return NULL;
+  }
+  stream.next_in = const_cast<unsigned char *>(data);
+  stream.avail_in = (unsigned int) compressedsize;
+  stream.next_out = out;
+  stream.avail_out = (unsigned int) size;
+  const int err = cc_zlibglue_inflate(&stream, Z_FINISH);
+  const size_t total = stream.total_out;
+  (void) cc_zlibglue_inflateEnd(&stream);
+
+  if (err != Z_STREAM_END || total != size) {
+    free(out);
+    return NULL;
+  }
+  return out;
+}
+
+// Decompresses a chunk read into memory. Stored chunks are returned
+// as they are.
+static unsigned char *
+sochunkedfile_decompress(const SoChunkedFile::Chunk & chunk, unsigned char * data)
+{
+  if (chunk.method == SoChunkedFile::STORED) return data;
+  unsigned char * out = NULL;
+  if (chunk.method == SoChunkedFile::ZLIB && cc_zlibglue_available()) {
+    out = sochunkedfile_inflate(data, (size_t) chunk.compressedsize,
+                                (size_t) chunk.size);
+  }
+  free(data);
+  return out;
+}
+
+static unsigned char *
+sochunkedfile_read(FILE * fp, const SoChunkedFile::Chunk & chunk)
+{
+  const size_t size = (size_t) chunk.compressedsize;
+  unsigned char * data = (unsigned char *) malloc(size ? size : 1);
+  if (!data) return NULL;
+  if (fseek(fp, (long) chunk.offset, SEEK_SET) != 0 ||
+      fread(data, 1, size, fp) != size) {
+    free(data);
+    return NULL;
+  }
+  return data;
+}
+
+struct sochunkedfile_decompress_data {
+  const SoChunkedFile::Chunk * chunks;
+  const int * indices;
+  unsigned char ** data;
+};
+
+static void
+sochunkedfile_decompress_range(void * closure, int begin, int end)
+{
+  sochunkedfile_decompress_data * d =
+    static_cast<sochunkedfile_decompress_data *>(closure);
+  for (int i = begin; i < end; i++) {
+    if (d->data[i]) {
+      d->data[i] = sochunkedfile_decompress(d->chunks[d->indices[i]], d->data[i]);
+    }
+  }
+}
+
+// *************************************************************************
+
+SoChunkedFile::SoChunkedFile(void)
+{
+  this->fp = NULL;
+  this->mutex = NULL;
+  this->refcount = 0;
+  CC_MUTEX_CONSTRUCT(this->mutex);
+}
+
+SoChunkedFile::~SoChunkedFile()
+{
+  for (int i = 0; i < this->decompressed.getLength(); i++) {
+    free(this->decompressed[i]);
+  }
+  if (this->fp) fclose(this->fp);
+  CC_MUTEX_DESTRUCT(this->mutex);
+}
+
+SbBool
+SoChunkedFile::isChunkedFile(const unsigned char * header, const size_t size)
+{
+  return size >= sizeof(SOCHUNKEDFILE_MAGIC) &&
+    memcmp(header, SOCHUNKEDFILE_MAGIC, sizeof(SOCHUNKEDFILE_MAGIC)) == 0;
+}
+
+SoChunkedFile *
+SoChunkedFile::open(FILE * fp, const SbString & filename, const SbBool keepopen)
+{
+  SoChunkedFile * file = new SoChunkedFile;
+  file->filename = filename;
+  if (!file->readTableOfContents(fp)) {
+    delete file;
+    return NULL;
+  }
+  file->decompressChunks(fp, !keepopen);
+  if (!file->isDecompressed(0)) {
+    SoDebugError::postWarning("SoChunkedFile::open",
+                              "Could not decompress the scene graph of '%s'.",
+                              filename.getString());
+    delete file;
+    return NULL;
+  }
+  if (keepopen) file->fp = fp;
+  file->ref();
+  return file;
+}
+
+void
+SoChunkedFile::ref(void)
+{
+  (void) cc_atomic_add32(&this->refcount, 1);
+}
+
+void
+SoChunkedFile::unref(void)
+{
+  if (cc_atomic_add32(&this->refcount, -1) == 0) delete this;
+}
+
+const SbString &
+SoChunkedFile::getFilename(void) const
+{
+  return this->filename;
+}
+
+int
+SoChunkedFile::getNumChunks(void) const
+{
+  return this->chunks.getLength();
+}
+
+const SoChunkedFile::Chunk &
+SoChunkedFile::getChunk(const int idx) const
+{
+  return this->chunks.getArrayPtr()[idx];
+}
+
+SbBool
+SoChunkedFile::isDecompressed(const int idx) const
+{
+  return this->decompressed[idx] != NULL;
+}
+
+int
+SoChunkedFile::getNumObjects(void) const
+{
+  return this->objects.getLength();
+}
+
+const SoChunkedFile::Object &
+SoChunkedFile::getObject(const int idx) const
+{
+  return this->objects.getArrayPtr()[idx];
+}
+
+unsigned char *
+SoChunkedFile::readChunk(const int idx, size_t & size)
+{
+  assert(idx >= 0 && idx < this->chunks.getLength());
+  size = (size_t) this->chunks[idx].size;
+
+  CC_MUTEX_LOCK(this->mutex);
+  // chunks decompressed up front are only read once
+  unsigned char * data = this->decompressed[idx];
+  this->decompressed[idx] = NULL;
+  SbBool compressed = FALSE;
+  if (!data && this->fp) {
+    data = sochunkedfile_read(this->fp, this->chunks[idx]);
+    compressed = TRUE;
+  }
+  CC_MUTEX_UNLOCK(this->mutex);
+
+  if (data && compressed) data = sochunkedfile_decompress(this->chunks[idx], data);
+  return data;
+}
+
+SbBool
+SoChunkedFile::readTableOfContents(FILE * fp)
+{
+  unsigned char header[HEADER_SIZE];
+  unsigned char trailer[TRAILER_SIZE];
+  if (fseek(fp, 0, SEEK_SET) != 0 ||
+      fread(header, 1, HEADER_SIZE, fp) != HEADER_SIZE ||
+      fseek(fp, -TRAILER_SIZE, SEEK_END) != 0) return FALSE;
+  const long tocend = ftell(fp);
+  if (tocend < HEADER_SIZE ||
+      fread(trailer, 1, TRAILER_SIZE, fp) != TRAILER_SIZE) return FALSE;
+
+  SoChunkedFileParser parser(header, HEADER_SIZE);
+  parser.ptr += sizeof(SOCHUNKEDFILE_MAGIC);
+  const uint32_t version = parser.get32();
+  if (version > FORMAT_VERSION) {
+    SoDebugError::postWarning("SoChunkedFile::readTableOfContents",
+                              "'%s' is a chunked file of version %u, "
+                              "which is not supported.",
+                              this->filename.getString(), version);
+    return FALSE;
+  }
+  SoChunkedFileParser tparser(trailer, TRAILER_SIZE);
+  const uint64_t tocoffset = tparser.get64();
+  if (!isChunkedFile(tparser.ptr, TRAILER_SIZE - 8) ||
+      tocoffset < HEADER_SIZE || tocoffset > (uint64_t) tocend) return FALSE;
+
+  const size_t tocsize = size_t(tocend - tocoffset);
+  unsigned char * toc = (unsigned char *) malloc(tocsize ? tocsize : 1);
+  if (!toc || fseek(fp, (long) tocoffset, SEEK_SET) != 0 ||
+      fread(toc, 1, tocsize, fp) != tocsize) {
+    free(toc);
+    return FALSE;
+  }
+
+  SoChunkedFileParser p(toc, tocsize);
+  const uint32_t numchunks = p.get32();
+  for (uint32_t i = 0; i < numchunks && p.ok; i++) {
+    Chunk chunk;
+    chunk.method = (Method) p.get32();
+    chunk.offset = p.get64();
+    chunk.compressedsize = p.get64();
+    chunk.size = p.get64();
+    chunk.object = (int32_t) p.get32();
+    chunk.field = p.getName();
+    if (chunk.offset < HEADER_SIZE || chunk.offset > tocoffset ||
+        chunk.compressedsize > tocoffset - chunk.offset ||
+        chunk.size != (uint64_t) (size_t) chunk.size) p.ok = FALSE;
+    this->chunks.append(chunk);
+    this->decompressed.append(NULL);
+  }
+  const uint32_t numobjects = p.get32();
+  for (uint32_t i = 0; i < numobjects && p.ok; i++) {
+    Object object;
+    object.type = p.getName();
+    object.name = p.getName();
+    object.offset = p.get64();
+    this->objects.append(object);
+  }
+  free(toc);
+  if (!p.ok || numchunks == 0) {
+    SoDebugError::postWarning("SoChunkedFile::readTableOfContents",
+                              "The table of contents of '%s' is corrupt.",
+                              this->filename.getString());
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// Decompresses the scene graph chunk, and all the other chunks if
+// all is TRUE, or else those below the lazy size. The chunks are
+// read in the calling thread, and decompressed in parallel.
+void
+SoChunkedFile::decompressChunks(FILE * fp, const SbBool all)
+{
+  const size_t lazysize = sochunkedfile_lazy_size();
+  SbList<int> indices;
+  for (int i = 0; i < this->chunks.getLength(); i++) {
+    if (i == 0 || all || this->chunks[i].size < lazysize) indices.append(i);
+  }
+
+  const int num = indices.getLength();
+  unsigned char ** data = new unsigned char *[num];
+  size_t total = 0;
+  for (int i = 0; i < num; i++) {
+    const Chunk & chunk = this->getChunk(indices[i]);
+    data[i] = sochunkedfile_read(fp, chunk);
+    total += (size_t) chunk.size;
+  }
+
+  sochunkedfile_decompress_data closure;
+  closure.chunks = this->chunks.getArrayPtr();
+  closure.indices = indices.getArrayPtr();
+  closure.data = data;
+  if (total < MIN_PARALLEL_BYTES || num == 1) {
+    sochunkedfile_decompress_range(&closure, 0, num);
+  }
+  else {
+    cc_wsched_parallel_for(cc_wsched_global_instance(), 0, num,
+                           1, sochunkedfile_decompress_range, &closure);
+  }
+
+  for (int i = 0; i < num; i++) {
+    this->decompressed[indices[i]] = data[i];
+  }
+  delete[] data;
+}
+
+unsigned char *
+SoChunkedFile::compressChunk(const void * data, const size_t size,
+                             const float level, Chunk & chunk)
+{
+  chunk.method = STORED;
+  chunk.size = chunk.compressedsize = size;
+  if (level <= 0.0f || size == 0 || size > 0x7fffffff ||
+      !cc_zlibglue_available()) return NULL;
+
+  // only worth it if the result is smaller
+  unsigned char * out = (unsigned char *) malloc(size);
+  if (!out) return NULL;
+
+  sochunkedfile_z_stream stream;
+  (void) memset(&stream, 0, sizeof(stream));
+  // convert level from [0.0, 1.0] to [1, 9], like SoOutput_GZFileWriter
+  const int zlevel = (int) SbClamp((level * 8.0f) + 1.0f, 1.0f, 9.0f);
+  if (cc_zlibglue_deflateInit2(&stream, zlevel, Z_DEFLATED, MAX_WBITS, 8,
+                               Z_DEFAULT_STRATEGY) != Z_OK) {
+    free(out);
+    return NULL;
+  }
+  stream.next_in = static_cast<unsigned char *>(const_cast<void *>(data));
+  stream.avail_in = (unsigned int) size;
+  stream.next_out = out;
+  stream.avail_out = (unsigned int) size;
+  const int err = cc_zlibglue_deflate(&stream, Z_FINISH);
+  const size_t total = stream.total_out;
+  (void) cc_zlibglue_deflateEnd(&stream);
+
+  if (err != Z_STREAM_END) {
+    free(out);
+    return NULL;
+  }
+  chunk.method = ZLIB;
+  chunk.compressedsize = total;
+  return out;
+}
+
+SbBool
+SoChunkedFile::writeHeader(FILE * fp)
+{
+  SbList<unsigned char> buf;
+  for (size_t i = 0; i < sizeof(SOCHUNKEDFILE_MAGIC); i++) {
+    buf.append(SOCHUNKEDFILE_MAGIC[i]);
+  }
+  sochunkedfile_put32(buf, FORMAT_VERSION);
+  while (buf.getLength() < HEADER_SIZE) buf.append(0);
+  return fwrite(buf.getArrayPtr(), 1, HEADER_SIZE, fp) == HEADER_SIZE;
+}
+
+SbBool
+SoChunkedFile::writeTableOfContents(FILE * fp, const uint64_t offset,
+                                    const SbList<Chunk> & chunks,
+                                    const SbList<Object> & objects)
+{
+  SbList<unsigned char> buf;
+  sochunkedfile_put32(buf, chunks.getLength());
+  for (int i = 0; i < chunks.getLength(); i++) {
+    sochunkedfile_put32(buf, chunks[i].method);
+    sochunkedfile_put64(buf, chunks[i].offset);
+    sochunkedfile_put64(buf, chunks[i].compressedsize);
+    sochunkedfile_put64(buf, chunks[i].size);
+    sochunkedfile_put32(buf, (uint32_t) chunks[i].object);
+    sochunkedfile_putname(buf, chunks[i].field);
+  }
+  sochunkedfile_put32(buf, objects.getLength());
+  for (int i = 0; i < objects.getLength(); i++) {
+    sochunkedfile_putname(buf, objects[i].type);
+    sochunkedfile_putname(buf, objects[i].name);
+    sochunkedfile_put64(buf, objects[i].offset);
+  }
+  sochunkedfile_put64(buf, offset);
+  for (size_t i = 0; i < sizeof(SOCHUNKEDFILE_MAGIC); i++) {
+    buf.append(SOCHUNKEDFILE_MAGIC[i]);
+  }
+  const size_t size = buf.getLength();
+  return fwrite(buf.getArrayPtr(), 1, size, fp) == size;
+}
@@ -0,0 +1,150 @@
+#ifndef COIN_SOCHUNKEDFILE_H
+#define COIN_SOCHUNKEDFILE_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <stdio.h>
+
+#include <Inventor/SbName.h>
+#include <Inventor/SbString.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/system/inttypes.h>
+
+// *************************************************************************
+
+// A chunked binary file (see SoOutput::setCompression()) is made up
+// of:
+//
+//   - a header: MAGIC and the format version as a 32-bit integer,
+//     padded to HEADER_SIZE bytes
+//   - the chunks, each compressed on its own
+//   - the table of contents: the offset, sizes and compression method
+//     of each chunk, and the objects written to the scene graph chunk
+//   - a trailer: the offset of the table of contents as a 64-bit
+//     integer, followed by MAGIC
+//
+// All integers are big-endian, like in binary Inventor files. Chunk
+// 0 is the scene graph as a regular Inventor file. The other chunks
+// hold the values of large multi-fields, written as binary Inventor
+// files with just the field values in them, and are referenced from
+// the scene graph in place of the values (see SoMField::readValue()).
+
+class SoChunkedFile {
+public:
+  enum Method {
+    STORED = 0,
+    ZLIB = 1
+  };
+
+  struct Chunk {
+    Method method;
+    uint64_t offset;
+    uint64_t compressedsize;
+    uint64_t size;
+    // the object the values belong to, as an index in the table of
+    // contents, or -1 for chunk 0
+    int32_t object;
+    SbName field;
+  };
+
+  struct Object {
+    SbName type;
+    SbName name;
+    // where the object starts in chunk 0
+    uint64_t offset;
+  };
+
+  enum {
+    HEADER_SIZE = 16,
+    TRAILER_SIZE = 16,
+    FORMAT_VERSION = 1
+  };
+
+  static SbBool isChunkedFile(const unsigned char * header, const size_t size);
+
+  // Reads the table of contents of fp, and returns NULL if it is not
+  // a valid chunked file. If keepopen is TRUE, the file takes over
+  // fp, and decompresses large chunks when they are read. Otherwise
+  // all chunks are decompressed up front.
+  static SoChunkedFile * open(FILE * fp, const SbString & filename,
+                              const SbBool keepopen);
+
+  void ref(void);
+  void unref(void);
+
+  const SbString & getFilename(void) const;
+  int getNumChunks(void) const;
+  const Chunk & getChunk(const int idx) const;
+  SbBool isDecompressed(const int idx) const;
+  int getNumObjects(void) const;
+  const Object & getObject(const int idx) const;
+
+  // Returns the decompressed contents of chunk idx, which the caller
+  // must free(), or NULL if it could not be read.
+  unsigned char * readChunk(const int idx, size_t & size);
+
+  // Compresses a chunk, and sets its method and sizes. Returns the
+  // compressed data, which the caller must free(), or NULL if the
+  // data should be stored as it is.
+  static unsigned char * compressChunk(const void * data, const size_t size,
+                                       const float level, Chunk & chunk);
+
+  static SbBool writeHeader(FILE * fp);
+  static SbBool writeTableOfContents(FILE * fp, const uint64_t offset,
+                                     const SbList<Chunk> & chunks,
+                                     const SbList<Object> & objects);
+
+private:
+  SoChunkedFile(void);
+  ~SoChunkedFile();
+
+  SbBool readTableOfContents(FILE * fp);
+  void decompressChunks(FILE * fp, const SbBool all);
+
+  SbString filename;
+  FILE * fp;
+  void * mutex;
+  volatile int32_t refcount;
+  SbList<Chunk> chunks;
+  SbList<Object> objects;
+  // chunks which were decompressed up front, until they are read
+  SbList<unsigned char *> decompressed;
+};
+
+#endif // ! COIN_SOCHUNKEDFILE_H
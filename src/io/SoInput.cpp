@@ -120,6 +120,7 @@
 #include <Inventor/lists/SbStringList.h>
 #include <Inventor/misc/SoProto.h>
 #include <Inventor/nodes/SoNode.h>
+#include <Inventor/nodes/SoSeparator.h>
 #include <Inventor/threads/SbStorage.h>
 
 #include "misc/SbHash.h"
@@ -128,6 +129,7 @@
 #include "coindefs.h" // COIN_STUB(), COIN_OBSOLETED()
 #include "io/SoInputP.h"
 #include "io/SoInput_FileInfo.h"
+#include "misc/SoDBP.h"
 
 // This (POSIX-compliant) macro is missing from the Win32 API header
 // files for MSVC++ 6.0.
@@ -247,6 +249,87 @@ SoInputP::getTopOfStackPopOnEOF(void)
   return fi;
 }
 
+// Returns the chunked file being read, if any. Used when reading
+// multi-fields, as the values of large multi-fields in chunked files
+// are stored apart from the scene graph.
+SoChunkedFile *
+SoInputP::getChunkedFile(SoInput * in)
+{
+  SoInput_FileInfo * fi = in->getTopOfStack();
+  return fi ? fi->chunkedFile() : NULL;
+}
+
+// Called by SoGroup::readChildren() before and after reading the
+// children of a group node, to keep track of the depth of the nodes
+// which are read.
+void
+SoInputP::pushGroup(SoInput * in)
+{
+  in->pimpl->groupdepth++;
+}
+
+void
+SoInputP::popGroup(SoInput * in)
+{
+  in->pimpl->groupdepth--;
+}
+
+// Called when a node has been read completely, either as a top-level
+// node by SoDB::readAll() or as the child of a group node. Top-level
+// nodes and separators down to the maximum depth are passed on to
+// the node callback. Returns FALSE if the node should be left out of
+// the scene graph.
+SbBool
+SoInputP::nodeRead(SoInput * in, SoNode * node)
+{
+  SoInputP * thisp = in->pimpl;
+  const int depth = thisp->groupdepth;
+  if (depth > 0) (void) SoInputP::progress(in, FALSE);
+
+  if ((thisp->nodecb == NULL) || (depth > thisp->nodecbmaxdepth)) return TRUE;
+  if ((depth > 0) && !node->isOfType(SoSeparator::getClassTypeId())) return TRUE;
+  return thisp->nodecb(thisp->nodecbdata, in, node, depth);
+}
+
+// Called by SoDB::readAll() before and after reading the file, to
+// report progress to the callbacks set up with
+// SoDB::addProgressCallback(). Only the outermost readAll() on an
+// SoInput reports progress.
+void
+SoInputP::beginReadAll(SoInput * in)
+{
+  SoInputP * thisp = in->pimpl;
+  if (++thisp->readalldepth > 1) return;
+  thisp->progressfile = in->getTopOfStack();
+  thisp->lastprogress = 0.0f;
+  (void) SoDBP::progress(SbName("File import"), 0.0f, FALSE);
+}
+
+void
+SoInputP::endReadAll(SoInput * in, SbBool ok)
+{
+  SoInputP * thisp = in->pimpl;
+  if (--thisp->readalldepth > 0) return;
+  thisp->progressfile = NULL;
+  (void) SoDBP::progress(SbName("File import"), ok ? 1.0f : -1.0f, FALSE);
+}
+
+// Reports progress for each percent of the file which has been read,
+// if the size of the file is known. Returns TRUE if the import
+// should be aborted, which is only possible if it is interruptible.
+SbBool
+SoInputP::progress(SoInput * in, SbBool interruptible)
+{
+  SoInputP * thisp = in->pimpl;
+  if ((thisp->readalldepth != 1) || (thisp->progressfile == NULL)) return FALSE;
+
+  // the last report with 1.0 is made by endReadAll()
+  const float fraction = thisp->progressfile->fractionRead();
+  if ((fraction < thisp->lastprogress + 0.01f) || (fraction >= 1.0f)) return FALSE;
+  thisp->lastprogress = fraction;
+  return SoDBP::progress(SbName("File import"), fraction, interruptible);
+}
+
 // Helperfunctions to handle different filetypes (Inventor, VRML 1.0
 // and VRML 2.0).
 //
@@ -1058,6 +1141,50 @@ SoInput::getNumBytesRead(void) const
   return fi->getNumBytesParsedSoFar();
 }
 
+/*!
+  \typedef SbBool SoInputNodeCB(void * userdata, SoInput * in, SoNode * node, int depth)
+
+  The type of the callback set with SoInput::setNodeCallback().
+*/
+
+/*!
+  Sets a callback which is invoked for each node as soon as it has
+  been read completely, while the rest of the file is still being
+  read. This makes it possible to process and discard the parts of a
+  huge file one at a time, instead of holding the complete scene
+  graph in memory.
+
+  The callback is invoked for each top-level node read by
+  SoDB::readAll() with a \a depth of 0, and for each SoSeparator node
+  which is the child of a group node, down to a depth of \a maxdepth,
+  where the children of a top-level node have a depth of 1.
+
+  If the callback returns \c TRUE, the node is added to its parent
+  (or the root returned from SoDB::readAll()) as usual. If it returns
+  \c FALSE, the node is left out of the scene graph, and the
+  callback is responsible for it, as for nodes returned by
+  SoDB::read(): ref() it, and unref() it when done with it. Nodes
+  which are named with DEF and used again later in the file must be
+  kept referenced until the file has been read.
+
+  Set \a func to \c NULL to remove the callback. Note that the
+  children of VRML97 nodes are not passed on to the callback.
+
+  Progress is reported to the callbacks set up with
+  SoDB::addProgressCallback() while SoDB::readAll() reads the file,
+  if the size of the file is known.
+
+  \sa SoDB::read()
+  \since Coin 4.0
+*/
+void
+SoInput::setNodeCallback(SoInputNodeCB * func, void * userdata, int maxdepth)
+{
+  PRIVATE(this)->nodecb = func;
+  PRIVATE(this)->nodecbdata = userdata;
+  PRIVATE(this)->nodecbmaxdepth = maxdepth;
+}
+
 /*!
   Returns header of current file.
 */
@@ -2899,3 +3026,312 @@ SoInput::findFile(const char * basename, SbString & fullname)
 #undef READ_UNSIGNED_INTEGER
 #undef READ_REAL
 #undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <cstring>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/C/tidbits.h>
+#include <Inventor/C/threads/thread.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+static SoCoordinate3 *
+soinput_make_coordinates(const int num)
+{
+  SoCoordinate3 * coords = new SoCoordinate3;
+  coords->point.setNum(num);
+  SbVec3f * values = coords->point.startEditing();
+  for (int i = 0; i < num; i++) values[i].setValue(float(i), float(num), 0.0f);
+  coords->point.finishEditing();
+  return coords;
+}
+
+static SoSeparator *
+soinput_read_file(const char * filename,
+                  SoInputNodeCB * func = NULL, void * userdata = NULL)
+{
+  SoInput in;
+  if (!in.openFile(filename)) return NULL;
+  if (func) in.setNodeCallback(func, userdata, 1);
+  SoSeparator * root = SoDB::readAll(&in);
+  in.closeFile();
+  if (root) root->ref();
+  return root;
+}
+
+static void
+soinput_write_file(SoNode * root, const char * filename,
+                   const char * compression, const float level)
+{
+  SoOutput out;
+  if (compression) BOOST_CHECK(out.setCompression(compression, level));
+  BOOST_REQUIRE(out.openFile(filename));
+  out.setBinary(compression && strcmp(compression, "CHUNKED") == 0);
+  SoWriteAction wa(&out);
+  wa.apply(root);
+  out.closeFile();
+}
+
+static void
+soinput_load_bytes(const char * filename, SbList<unsigned char> & bytes)
+{
+  bytes.truncate(0);
+  FILE * fp = fopen(filename, "rb");
+  BOOST_REQUIRE(fp != NULL);
+  int c;
+  while ((c = fgetc(fp)) != EOF) bytes.append((unsigned char) c);
+  fclose(fp);
+}
+
+static void
+soinput_save_bytes(const char * filename, const SbList<unsigned char> & bytes,
+                   const int num)
+{
+  FILE * fp = fopen(filename, "wb");
+  BOOST_REQUIRE(fp != NULL);
+  BOOST_REQUIRE(fwrite(bytes.getArrayPtr(), 1, num, fp) == (size_t) num);
+  fclose(fp);
+}
+
+BOOST_AUTO_TEST_CASE(chunkedFile)
+{
+  const char * filename = "soinput-test.ivc";
+  // the first array is decompressed when the file is opened, the
+  // second is loaded on first access
+  const int small = 2000, large = 100000;
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  root->addChild(soinput_make_coordinates(small));
+  root->addChild(soinput_make_coordinates(large));
+  root->addChild(soinput_make_coordinates(10));
+  soinput_write_file(root, filename, "CHUNKED", 0.5f);
+
+  char magic[8] = { 0 };
+  FILE * fp = fopen(filename, "rb");
+  BOOST_REQUIRE(fp != NULL);
+  BOOST_CHECK(fread(magic, 1, 8, fp) == 8 && memcmp(magic, "COINCHNK", 8) == 0);
+  fclose(fp);
+
+  SoSeparator * read = soinput_read_file(filename);
+  BOOST_REQUIRE(read != NULL);
+  BOOST_REQUIRE_EQUAL(read->getNumChildren(), 3);
+  for (int i = 0; i < 3; i++) {
+    const SoMFVec3f & expected = static_cast<SoCoordinate3 *>(root->getChild(i))->point;
+    const SoMFVec3f & field = static_cast<SoCoordinate3 *>(read->getChild(i))->point;
+    BOOST_CHECK_MESSAGE(field == expected, "values of array " << i << " differ");
+  }
+  read->unref();
+
+  // values not loaded yet are not loaded if they are all replaced,
+  // but copies get them
+  read = soinput_read_file(filename);
+  BOOST_REQUIRE(read != NULL);
+  SoCoordinate3 * coords = static_cast<SoCoordinate3 *>(read->getChild(1));
+  SoSeparator * copy = static_cast<SoSeparator *>(read->copy());
+  copy->ref();
+  coords->point.setNum(0);
+  BOOST_CHECK_EQUAL(coords->point.getNum(), 0);
+  coords = static_cast<SoCoordinate3 *>(copy->getChild(1));
+  BOOST_CHECK_EQUAL(coords->point.getNum(), large);
+  BOOST_CHECK_EQUAL(coords->point[large - 1][0], float(large - 1));
+  copy->unref();
+  read->unref();
+
+  // ..and the file is released when the scene graph is destructed
+  // without accessing them
+  read = soinput_read_file(filename);
+  BOOST_REQUIRE(read != NULL);
+  read->unref();
+
+  root->unref();
+  (void) remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(corruptChunkedFile)
+{
+  const char * filename = "soinput-test.ivc";
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  root->addChild(soinput_make_coordinates(2000));
+  // stored uncompressed, so the chunk references can be patched
+  soinput_write_file(root, filename, "CHUNKED", 0.0f);
+  root->unref();
+
+  SbList<unsigned char> bytes;
+  soinput_load_bytes(filename, bytes);
+  const int size = bytes.getLength();
+  BOOST_REQUIRE(size > 32);
+
+  static const char * filters[] = { "chunk", NULL };
+  TestSuite::PushMessageSuppressFilters(filters);
+
+  // the trailer with the offset of the table of contents is missing
+  soinput_save_bytes(filename, bytes, size - 10);
+  SoSeparator * read = soinput_read_file(filename);
+  BOOST_CHECK_MESSAGE(read == NULL, "truncated file was read");
+  if (read) read->unref();
+
+  // the table of contents claims more chunks than it holds
+  uint64_t tocoffset = 0;
+  for (int i = 0; i < 8; i++) tocoffset = (tocoffset << 8) | bytes[size - 16 + i];
+  BOOST_REQUIRE(tocoffset > 16 && tocoffset < (uint64_t) size - 16);
+  SbList<unsigned char> corrupt(bytes);
+  corrupt[(int) tocoffset] = 0x7f;
+  soinput_save_bytes(filename, corrupt, size);
+  read = soinput_read_file(filename);
+  BOOST_CHECK_MESSAGE(read == NULL, "file with corrupt table of contents was read");
+  if (read) read->unref();
+
+  // the scene graph refers to chunks which don't exist. A reference
+  // is the negated chunk index followed by the number of values.
+  static const unsigned char reference[] = { 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x07, 0xd0 };
+  int refpos = -1;
+  for (int i = 0; refpos < 0 && i + 8 <= (int) tocoffset; i++) {
+    if (memcmp(bytes.getArrayPtr() + i, reference, 8) == 0) refpos = i;
+  }
+  BOOST_REQUIRE(refpos >= 0);
+  static const unsigned char badchunks[][4] = {
+    { 0xff, 0xff, 0xff, 0xf9 }, { 0x80, 0x00, 0x00, 0x00 }
+  };
+  for (int i = 0; i < 2; i++) {
+    corrupt = bytes;
+    for (int j = 0; j < 4; j++) corrupt[refpos + j] = badchunks[i][j];
+    soinput_save_bytes(filename, corrupt, size);
+    TestSuite::ResetReadErrorCount();
+    read = soinput_read_file(filename);
+    BOOST_CHECK_MESSAGE(read == NULL, "file with invalid chunk index was read");
+    BOOST_CHECK_MESSAGE(TestSuite::GetReadErrorCount() > 0,
+                        "invalid chunk index not reported");
+    if (read) read->unref();
+  }
+  TestSuite::ResetReadErrorCount();
+
+  TestSuite::PopMessageSuppressFilters();
+  (void) remove(filename);
+}
+
+// The size of the buffers read by SoInput, and by the read-ahead
+// thread.
+static const long SOINPUT_BUFSIZE = 65536 * 2;
+
+static long
+soinput_wait_for_read_ahead(FILE * fp)
+{
+  // give the read-ahead thread time to fill its buffers
+  for (int i = 0; (i < 500) && (ftell(fp) <= 2 * SOINPUT_BUFSIZE); i++) {
+    cc_sleep(0.01f);
+  }
+  return ftell(fp);
+}
+
+struct soinput_filepos {
+  SbBool readahead;
+  int numparts;
+  long pos;
+};
+
+static SbBool
+soinput_record_filepos(void * userdata, SoInput * in, SoNode * /* node */,
+                       int /* depth */)
+{
+  soinput_filepos * state = static_cast<soinput_filepos *>(userdata);
+  // how far the file has been read when the first part is done
+  FILE * fp = in->getCurFile();
+  if ((state->numparts++ == 0) && fp) {
+    state->pos = state->readahead ? soinput_wait_for_read_ahead(fp) : ftell(fp);
+  }
+  return TRUE;
+}
+
+BOOST_AUTO_TEST_CASE(readAheadFile)
+{
+  // large files are read ahead on a separate thread, unless the
+  // COIN_SOINPUT_READ_AHEAD environment variable is 0
+  const char * filename = "soinput-test.iv";
+  const int sizes[] = { 10, 100000, 10 };
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < 3; i++) {
+    SoSeparator * part = new SoSeparator;
+    part->addChild(soinput_make_coordinates(sizes[i]));
+    root->addChild(part);
+  }
+
+  const char * env = coin_getenv("COIN_SOINPUT_READ_AHEAD");
+  const SbBool hadenv = env != NULL;
+  const SbString prevenv(hadenv ? env : "");
+
+  for (int compressed = 0; compressed < 2; compressed++) {
+    soinput_write_file(root, filename, compressed ? "GZIP" : NULL, 0.5f);
+
+    for (int readahead = 1; readahead >= 0; readahead--) {
+      coin_setenv("COIN_SOINPUT_READ_AHEAD", readahead ? "4" : "0", TRUE);
+      soinput_filepos state = { readahead, 0, 0 };
+      SoSeparator * read = soinput_read_file(filename, soinput_record_filepos, &state);
+      BOOST_REQUIRE(read != NULL);
+      BOOST_REQUIRE_EQUAL(read->getNumChildren(), 3);
+      for (int i = 0; i < 3; i++) {
+        const SoMFVec3f & expected =
+          static_cast<SoCoordinate3 *>(static_cast<SoSeparator *>(root->getChild(i))->getChild(0))->point;
+        const SoMFVec3f & field =
+          static_cast<SoCoordinate3 *>(static_cast<SoSeparator *>(read->getChild(i))->getChild(0))->point;
+        BOOST_CHECK_MESSAGE(field == expected,
+                            "values of array " << i << " differ, read ahead: " << readahead);
+      }
+      read->unref();
+
+      // the file position of compressed files says nothing about
+      // how much has been decompressed
+      if (!compressed) {
+        // the parts and the top-level separator
+        BOOST_CHECK_EQUAL(state.numparts, 4);
+        if (readahead) {
+          BOOST_CHECK_MESSAGE(state.pos > 2 * SOINPUT_BUFSIZE,
+                              "file was not read ahead, position " << state.pos);
+        }
+        else {
+          BOOST_CHECK_MESSAGE(state.pos <= SOINPUT_BUFSIZE,
+                              "file was read ahead, position " << state.pos);
+        }
+      }
+    }
+  }
+
+  // the file is closed after reading the first of the top-level
+  // parts, while the read-ahead thread waits for its buffers to be
+  // used
+  coin_setenv("COIN_SOINPUT_READ_AHEAD", "4", TRUE);
+  {
+    SoOutput out;
+    BOOST_REQUIRE(out.openFile(filename));
+    SoWriteAction wa(&out);
+    for (int i = 0; i < 3; i++) wa.apply(root->getChild(i));
+    out.closeFile();
+  }
+  SoInput in;
+  BOOST_REQUIRE(in.openFile(filename));
+  SoNode * node = NULL;
+  BOOST_CHECK(SoDB::read(&in, node));
+  BOOST_REQUIRE(node != NULL);
+  node->ref();
+  BOOST_CHECK(soinput_wait_for_read_ahead(in.getCurFile()) > 2 * SOINPUT_BUFSIZE);
+  in.closeFile();
+  BOOST_REQUIRE(node->isOfType(SoSeparator::getClassTypeId()));
+  SoNode * coords = static_cast<SoSeparator *>(node)->getChild(0);
+  BOOST_CHECK_EQUAL(static_cast<SoCoordinate3 *>(coords)->point.getNum(), sizes[0]);
+  node->unref();
+
+  if (hadenv) coin_setenv("COIN_SOINPUT_READ_AHEAD", prevenv.getString(), TRUE);
+  else coin_unsetenv("COIN_SOINPUT_READ_AHEAD");
+  root->unref();
+  (void) remove(filename);
+}
+
+#endif // COIN_TEST_SUITE
@@ -41,8 +41,10 @@
 
 #include "misc/SbHash.h"
 
-class SoInput;
+#include <Inventor/SoInput.h>
+
 class SoInput_FileInfo;
+class SoChunkedFile;
 
 // *************************************************************************
 
@@ -51,6 +53,13 @@ public:
   SoInputP(SoInput * owner) {
     this->owner = owner;
     this->usingstdin = FALSE;
+    this->nodecb = NULL;
+    this->nodecbdata = NULL;
+    this->nodecbmaxdepth = 0;
+    this->groupdepth = 0;
+    this->readalldepth = 0;
+    this->progressfile = NULL;
+    this->lastprogress = 0.0f;
   }
 
   static SbBool debug(void);
@@ -58,6 +67,16 @@ public:
 
   SoInput_FileInfo * getTopOfStackPopOnEOF(void);
 
+  static SoChunkedFile * getChunkedFile(SoInput * in);
+
+  static void pushGroup(SoInput * in);
+  static void popGroup(SoInput * in);
+  static SbBool nodeRead(SoInput * in, SoNode * node);
+
+  static void beginReadAll(SoInput * in);
+  static SbBool progress(SoInput * in, SbBool interruptible);
+  static void endReadAll(SoInput * in, SbBool ok);
+
   static SbBool isNameStartChar(unsigned char c, SbBool validIdent);
   static SbBool isNameChar(unsigned char c, SbBool validIdent);
   static SbBool isNameStartCharVRML1(unsigned char c, SbBool validIdent);
@@ -69,6 +88,15 @@ public:
 
   SbHash<const char *, SoBase *> copied_references;
 
+  SoInputNodeCB * nodecb;
+  void * nodecbdata;
+  int nodecbmaxdepth;
+  int groupdepth;
+
+  int readalldepth;
+  SoInput_FileInfo * progressfile;
+  float lastprogress;
+
 private:
   SoInput * owner;
 };
@@ -137,6 +137,16 @@ public:
     if (this->reader == NULL) return coin_get_stdin();
     return this->getReader()->getFilePointer();
   }
+  SoChunkedFile * chunkedFile(void) {
+    // if reader == NULL, it means that we're reading from stdin
+    if (this->reader == NULL) return NULL;
+    return this->getReader()->getChunkedFile();
+  }
+  float fractionRead(void) const {
+    // if reader == NULL, it means that we're reading from stdin
+    if (this->reader == NULL) return -1.0f;
+    return this->reader->getFractionRead();
+  }
   const SbString & ivFilename(void) {
     // if reader == NULL, it means that we're reading from stdin
     if (this->reader == NULL) return this->stdinname;
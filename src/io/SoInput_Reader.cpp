@@ -33,6 +33,7 @@
 #include "io/SoInput_Reader.h"
 
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -51,8 +52,15 @@
 #endif
 
 #include <Inventor/errors/SoDebugError.h>
+#include <Inventor/C/tidbits.h>
+#ifdef HAVE_THREADS
+#include <Inventor/C/threads/thread.h>
+#include <Inventor/C/threads/mutex.h>
+#include <Inventor/C/threads/condvar.h>
+#endif // HAVE_THREADS
 
 #include "io/gzmemio.h"
+#include "io/SoChunkedFile.h"
 #include "glue/zlib.h"
 #include "glue/bzip2.h"
 
@@ -70,6 +78,10 @@
 // abstract class
 //
 
+// the size of each buffer read ahead, which is the size of the reads
+// done by SoInput_FileInfo
+static const size_t READAHEAD_BUFSIZE = 65536 * 2;
+
 SoInput_Reader::SoInput_Reader(void)
   : dummyname("")
 {
@@ -91,6 +103,18 @@ SoInput_Reader::getFilePointer(void)
   return NULL;
 }
 
+SoChunkedFile *
+SoInput_Reader::getChunkedFile(void)
+{
+  return NULL;
+}
+
+float
+SoInput_Reader::getFractionRead(void) const
+{
+  return -1.0f;
+}
+
 // creates the correct reader based on the file type in fp (will
 // examine the file header). If fullname is empty, it's assumed that
 // file FILE pointer is passed from the user, and that we cannot
@@ -100,6 +124,7 @@ SoInput_Reader::createReader(FILE * fp, const SbString & fullname)
 {
   SoInput_Reader * reader = NULL;
   SbBool trycompression = FALSE;
+  size_t filesize = 0;
 
 #ifdef HAVE_FSTAT
   // need to make sure stream is seekable to enable compression
@@ -109,21 +134,39 @@ SoInput_Reader::createReader(FILE * fp, const SbString & fullname)
   if ( fstat(fn, &sb) == 0 ) {
     if ( sb.st_mode & S_IFREG ) { // regular file
       trycompression = TRUE;
+      filesize = (size_t) sb.st_size;
     }
   }
 #endif // HAVE_FSTAT
 
   if ( trycompression ) {
     static const size_t HEADER_SIZE = 4;
-    unsigned char header[HEADER_SIZE];
+    static const size_t CHUNKED_HEADER_SIZE = 8;
+    unsigned char header[CHUNKED_HEADER_SIZE];
     long offset = ftell(fp);
     SbBool valid_header = TRUE;
-    if (fread(header, 1, HEADER_SIZE, fp)<HEADER_SIZE) {
+    const size_t numread = fread(header, 1, CHUNKED_HEADER_SIZE, fp);
+    if (numread < HEADER_SIZE) {
       valid_header = FALSE;
     }
     (void) fseek(fp, offset, SEEK_SET);
     fflush(fp); // needed since we fetch the file descriptor later
 
+    if (valid_header && SoChunkedFile::isChunkedFile(header, numread)) {
+      // files we opened ourselves are kept open, so that large
+      // chunks can be read when they are needed
+      const SbBool keepopen = fullname.getLength() && fullname != "<stdin>";
+      SoChunkedFile * file = SoChunkedFile::open(fp, fullname, keepopen);
+      if (file) {
+        reader = new SoInput_ChunkedFileReader(fullname.getString(), file);
+      }
+      else {
+        SoDebugError::postWarning("SoInput_Reader::createReader",
+                                  "Unable to read chunked file.");
+        (void) fseek(fp, offset, SEEK_SET);
+      }
+    }
+
     if (valid_header && header[0] == 'B' && header[1] == 'Z') {
       if (!cc_bzglue_available()) {
         SoDebugError::postWarning("SoInput_Reader::createReader",
@@ -184,6 +227,16 @@ SoInput_Reader::createReader(FILE * fp, const SbString & fullname)
   if (reader == NULL) {
     reader = new SoInput_FileReader(fullname.getString(), fp);
   }
+
+  // read regular files ahead on a separate thread, unless they are
+  // too small for it to pay off. Chunked files are decompressed when
+  // they are opened, and are not read ahead.
+  const int numbuffers = SoInput_ReadAheadReader::getNumBuffers();
+  if (trycompression && (numbuffers > 0) &&
+      (filesize >= 2 * READAHEAD_BUFSIZE) &&
+      (reader->getType() != CHUNKEDFILE)) {
+    reader = new SoInput_ReadAheadReader(reader, numbuffers);
+  }
   return reader;
 }
 
@@ -197,6 +250,18 @@ SoInput_FileReader::SoInput_FileReader(const char * const filenamearg, FILE * fi
 {
   this->fp = filepointer;
   this->filename = filenamearg;
+  this->numread = 0;
+  this->size = 0;
+
+  // find the number of bytes left in the file, for progress
+  // reporting. Fails for stdin and other streams which are not
+  // seekable, and the size is then unknown.
+  const long offset = ftell(this->fp);
+  if ((offset >= 0) && (fseek(this->fp, 0, SEEK_END) == 0)) {
+    const long end = ftell(this->fp);
+    if (end > offset) this->size = (size_t)(end - offset);
+    (void) fseek(this->fp, offset, SEEK_SET);
+  }
 }
 
 SoInput_FileReader::~SoInput_FileReader()
@@ -221,7 +286,9 @@ SoInput_FileReader::getType(void) const
 size_t
 SoInput_FileReader::readBuffer(char * buf, const size_t readlen)
 {
-  return fread(buf, 1, readlen, this->fp);
+  const size_t num = fread(buf, 1, readlen, this->fp);
+  this->numread += num;
+  return num;
 }
 
 const SbString &
@@ -236,6 +303,14 @@ SoInput_FileReader::getFilePointer(void)
   return this->fp;
 }
 
+float
+SoInput_FileReader::getFractionRead(void) const
+{
+  if (this->size == 0) return -1.0f;
+  const float fraction = float(this->numread) / float(this->size);
+  return fraction < 1.0f ? fraction : 1.0f;
+}
+
 //
 // standard membuffer class
 //
@@ -269,6 +344,13 @@ SoInput_MemBufferReader::readBuffer(char * buffer, const size_t readlen)
   return len;
 }
 
+float
+SoInput_MemBufferReader::getFractionRead(void) const
+{
+  if (this->buflen == 0) return -1.0f;
+  return float(this->bufpos) / float(this->buflen);
+}
+
 //
 // gzip readers
 //
@@ -401,5 +483,226 @@ SoInput_BZ2FileReader::getFilename(void)
   return this->filename;
 }
 
+//
+// chunked file reader
+//
+
+SoInput_ChunkedFileReader::SoInput_ChunkedFileReader(const char * const filenamearg,
+                                                     SoChunkedFile * filearg)
+{
+  this->file = filearg;
+  this->filename = filenamearg;
+  this->bufpos = 0;
+  this->buf = this->file->readChunk(0, this->buflen);
+  if (this->buf == NULL) this->buflen = 0;
+}
+
+SoInput_ChunkedFileReader::~SoInput_ChunkedFileReader()
+{
+  free(this->buf);
+  // the fields with values which are not loaded yet keep the file
+  // open until they are loaded
+  this->file->unref();
+}
+
+SoInput_Reader::ReaderType
+SoInput_ChunkedFileReader::getType(void) const
+{
+  return CHUNKEDFILE;
+}
+
+size_t
+SoInput_ChunkedFileReader::readBuffer(char * bufarg, const size_t readlen)
+{
+  size_t num = this->buflen - this->bufpos;
+  if (num > readlen) num = readlen;
+  memcpy(bufarg, this->buf + this->bufpos, num);
+  this->bufpos += num;
+  return num;
+}
+
+const SbString &
+SoInput_ChunkedFileReader::getFilename(void)
+{
+  return this->filename;
+}
+
+SoChunkedFile *
+SoInput_ChunkedFileReader::getChunkedFile(void)
+{
+  return this->file;
+}
+
+float
+SoInput_ChunkedFileReader::getFractionRead(void) const
+{
+  if (this->buflen == 0) return -1.0f;
+  return float(this->bufpos) / float(this->buflen);
+}
+
+//
+// read-ahead reader
+//
+
+SoInput_ReadAheadReader::SoInput_ReadAheadReader(SoInput_Reader * readerarg,
+                                                 const int numbuffersarg)
+{
+  this->reader = readerarg;
+  this->numbuffers = numbuffersarg;
+  this->buffers = new char*[this->numbuffers];
+  this->bufferlen = new size_t[this->numbuffers];
+  this->bufferfraction = new float[this->numbuffers];
+  for (int i = 0; i < this->numbuffers; i++) {
+    this->buffers[i] = new char[READAHEAD_BUFSIZE];
+  }
+  this->readidx = 0;
+  this->writeidx = 0;
+  this->numfilled = 0;
+  this->readpos = 0;
+  this->fraction = this->reader->getFractionRead();
+  this->eof = FALSE;
+  this->quit = FALSE;
+
+#ifdef HAVE_THREADS
+  this->mutex = cc_mutex_construct();
+  this->condvar = cc_condvar_construct();
+  this->thread = cc_thread_construct(SoInput_ReadAheadReader::threadFunc, this);
+#endif // HAVE_THREADS
+}
+
+SoInput_ReadAheadReader::~SoInput_ReadAheadReader()
+{
+#ifdef HAVE_THREADS
+  cc_mutex_lock(this->mutex);
+  this->quit = TRUE;
+  cc_mutex_unlock(this->mutex);
+  cc_condvar_wake_all(this->condvar);
+  (void) cc_thread_join(this->thread, NULL);
+  cc_thread_destruct(this->thread);
+  cc_condvar_destruct(this->condvar);
+  cc_mutex_destruct(this->mutex);
+#endif // HAVE_THREADS
+
+  for (int i = 0; i < this->numbuffers; i++) delete[] this->buffers[i];
+  delete[] this->buffers;
+  delete[] this->bufferlen;
+  delete[] this->bufferfraction;
+  delete this->reader;
+}
+
+// Returns the number of buffers to read ahead, from the
+// COIN_SOINPUT_READ_AHEAD environment variable. 0 means that files
+// are not read ahead. Checked each time a file is opened.
+int
+SoInput_ReadAheadReader::getNumBuffers(void)
+{
+#ifdef HAVE_THREADS
+  const char * env = coin_getenv("COIN_SOINPUT_READ_AHEAD");
+  const int numbuffers = env ? atoi(env) : 4;
+  return (numbuffers < 0) ? 0 : numbuffers;
+#else // HAVE_THREADS
+  return 0;
+#endif // !HAVE_THREADS
+}
+
+// Fills the buffers until all of them are filled, then waits for the
+// parsing thread to use them. An empty buffer marks the end of the
+// file.
+void *
+SoInput_ReadAheadReader::threadFunc(void * closure)
+{
+#ifdef HAVE_THREADS
+  SoInput_ReadAheadReader * thisp = (SoInput_ReadAheadReader *) closure;
+  cc_mutex_lock(thisp->mutex);
+  while (TRUE) {
+    while (!thisp->quit && (thisp->numfilled == thisp->numbuffers)) {
+      cc_condvar_wait(thisp->condvar, thisp->mutex);
+    }
+    if (thisp->quit) break;
+
+    // the buffer is not used by the parsing thread until it has been
+    // counted as filled, so it can be filled without the lock
+    const int idx = thisp->writeidx;
+    cc_mutex_unlock(thisp->mutex);
+    const size_t len = thisp->reader->readBuffer(thisp->buffers[idx], READAHEAD_BUFSIZE);
+    const float fraction = thisp->reader->getFractionRead();
+    cc_mutex_lock(thisp->mutex);
+
+    thisp->bufferlen[idx] = len;
+    thisp->bufferfraction[idx] = fraction;
+    thisp->writeidx = (idx + 1) % thisp->numbuffers;
+    thisp->numfilled++;
+    cc_condvar_wake_all(thisp->condvar);
+    if (len == 0) break;
+  }
+  cc_mutex_unlock(thisp->mutex);
+#endif // HAVE_THREADS
+  return NULL;
+}
+
+SoInput_Reader::ReaderType
+SoInput_ReadAheadReader::getType(void) const
+{
+  return this->reader->getType();
+}
+
+size_t
+SoInput_ReadAheadReader::readBuffer(char * buf, const size_t readlen)
+{
+  if (this->eof) return 0;
+
+#ifdef HAVE_THREADS
+  cc_mutex_lock(this->mutex);
+  while (this->numfilled == 0) {
+    cc_condvar_wait(this->condvar, this->mutex);
+  }
+  cc_mutex_unlock(this->mutex);
+#endif // HAVE_THREADS
+
+  // the thread does not touch a filled buffer, so it can be read
+  // without the lock
+  const int idx = this->readidx;
+  const size_t len = this->bufferlen[idx];
+  if (len == 0) {
+    this->eof = TRUE;
+    return 0;
+  }
+  size_t num = len - this->readpos;
+  if (num > readlen) num = readlen;
+  memcpy(buf, this->buffers[idx] + this->readpos, num);
+  this->readpos += num;
+  this->fraction = this->bufferfraction[idx];
+
+  if (this->readpos == len) {
+    this->readpos = 0;
+    this->readidx = (idx + 1) % this->numbuffers;
+#ifdef HAVE_THREADS
+    cc_mutex_lock(this->mutex);
+    this->numfilled--;
+    cc_mutex_unlock(this->mutex);
+    cc_condvar_wake_all(this->condvar);
+#endif // HAVE_THREADS
+  }
+  return num;
+}
+
+const SbString &
+SoInput_ReadAheadReader::getFilename(void)
+{
+  return this->reader->getFilename();
+}
+
+FILE *
+SoInput_ReadAheadReader::getFilePointer(void)
+{
+  return this->reader->getFilePointer();
+}
+
+float
+SoInput_ReadAheadReader::getFractionRead(void) const
+{
+  return this->fraction;
+}
+
 #undef BZ_OK
 #undef BZ_STREAM_END
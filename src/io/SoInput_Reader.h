@@ -40,8 +40,11 @@
 // *************************************************************************
 
 #include <Inventor/SbString.h>
+#include <Inventor/C/threads/common.h>
 #include <stdio.h>
 
+class SoChunkedFile;
+
 // *************************************************************************
 
 class SoInput_Reader {
@@ -55,7 +58,8 @@ public:
     MEMBUFFER,
     GZFILE,
     BZ2FILE,
-    GZMEMBUFFER
+    GZMEMBUFFER,
+    CHUNKEDFILE
   };
 
   // must be overloaded to return type
@@ -73,6 +77,15 @@ public:
   // reader uses FILE * to read data.
   virtual FILE * getFilePointer(void);
 
+  // default method returns NULL. Should only be overloaded by the
+  // reader of chunked files.
+  virtual SoChunkedFile * getChunkedFile(void);
+
+  // should be overloaded to return how much of the input has been
+  // read so far, in the range [0, 1], for progress reporting. Default
+  // method returns -1.0 (unknown).
+  virtual float getFractionRead(void) const;
+
   static SoInput_Reader * createReader(FILE * fp, const SbString & fullname);
 
 public:
@@ -89,10 +102,13 @@ public:
 
   virtual const SbString & getFilename(void);
   virtual FILE * getFilePointer(void);
+  virtual float getFractionRead(void) const;
 
 public:
   SbString filename;
   FILE * fp;
+  size_t size;
+  size_t numread;
 
 };
 
@@ -103,6 +119,7 @@ public:
 
   virtual ReaderType getType(void) const;
   virtual size_t readBuffer(char * buf, const size_t readlen);
+  virtual float getFractionRead(void) const;
 
 public:
   char * buf;
@@ -154,4 +171,66 @@ public:
   SbString filename;
 };
 
+// reads the scene graph chunk of a chunked file
+class SoInput_ChunkedFileReader : public SoInput_Reader {
+public:
+  SoInput_ChunkedFileReader(const char * const filename, SoChunkedFile * file);
+  virtual ~SoInput_ChunkedFileReader();
+
+  virtual ReaderType getType(void) const;
+  virtual size_t readBuffer(char * buf, const size_t readlen);
+
+  virtual const SbString & getFilename(void);
+  virtual SoChunkedFile * getChunkedFile(void);
+  virtual float getFractionRead(void) const;
+
+public:
+  SoChunkedFile * file;
+  SbString filename;
+  unsigned char * buf;
+  size_t buflen;
+  size_t bufpos;
+};
+
+// reads the data of another reader ahead into a ring of buffers on a
+// separate thread, so that reading and decompressing the file
+// overlaps with parsing
+class SoInput_ReadAheadReader : public SoInput_Reader {
+public:
+  SoInput_ReadAheadReader(SoInput_Reader * reader, const int numbuffers);
+  virtual ~SoInput_ReadAheadReader();
+
+  virtual ReaderType getType(void) const;
+  virtual size_t readBuffer(char * buf, const size_t readlen);
+
+  virtual const SbString & getFilename(void);
+  virtual FILE * getFilePointer(void);
+  virtual float getFractionRead(void) const;
+
+  static int getNumBuffers(void);
+
+public:
+  static void * threadFunc(void * closure);
+
+  SoInput_Reader * reader;
+  cc_thread * thread;
+  cc_mutex * mutex;
+  cc_condvar * condvar;
+
+  int numbuffers;
+  char ** buffers;
+  size_t * bufferlen;
+  float * bufferfraction;
+
+  // the buffer being read from, the buffer being filled by the
+  // thread, and the number of filled buffers
+  int readidx;
+  int writeidx;
+  int numfilled;
+  size_t readpos;
+  float fraction;
+  SbBool eof;
+  SbBool quit;
+};
+
 #endif // COIN_SOINPUT_READER_H
@@ -61,6 +61,11 @@
   You can not use file compression together with I/O to memory buffers,
   except for reading from memory buffers containing gzip-compressed files.
 
+  From Coin 4.0, SoOutput::setCompression also supports \e CHUNKED, a
+  binary format where large multi-field arrays are compressed
+  separately, decompressed in parallel when the file is read, and
+  loaded on first access.
+
   For backwards compatibility with Coin 2.0 and Coin 1.0, compressed files
   must not be used.  Compressed files works only from Coin 2.1 and
   upwards.
@@ -291,6 +296,7 @@ SoOutput_compression_list_init(void)
   if (cc_bzglue_available()) {
     SoOutput_compmethods->append(SbName("BZIP2"));
   }
+  SoOutput_compmethods->append(SbName("CHUNKED"));
   coin_atexit((coin_atexit_f*) SoOutput_compression_list_cleanup, CC_ATEXIT_NORMAL);
 }
 
@@ -451,9 +457,22 @@ SoOutput::closeFile(void)
   compressing. \a level is the compression level, where 0.0 means no
   compression and 1.0 means maximum compression.
 
-  Currently \e BZIP2, \e GZIP are the only compression methods
-  supported, and you have to compile Coin with zlib and bzip2-support
-  to enable them.
+  Currently \e BZIP2, \e GZIP and \e CHUNKED are the compression
+  methods supported, and you have to compile Coin with zlib and
+  bzip2-support to enable the first two.
+
+  \e CHUNKED writes a Coin specific file format, where the scene graph
+  and the values of large multi-fields are compressed with zlib in
+  separate chunks, followed by a table of contents. When reading the
+  file, the chunks are decompressed in parallel, and the largest
+  arrays are not read from the file until their values are first
+  accessed (see the COIN_CHUNKED_LAZY_SIZE environment variable).
+  Multi-field values are only stored in separate chunks when writing
+  in binary mode. A \a level of 0.0 stores the chunks uncompressed,
+  and zlib is then not needed to read or write the file. The file is
+  completed when the SoOutput is closed or reset. Such files can not
+  be read by other Inventor implementations, or by Coin versions
+  before 4.0.
 
   Supply \a compmethod = \e NONE or \e level = 0.0 if you want to
   disable compression. The compression is disabled by default.
@@ -485,6 +504,7 @@ SoOutput::setCompression(const SbName & compmethod, const float level)
     SoDebugError::postWarning("SoOutput::setCompression",
                               "Requested BZIP2 compression, but libbz2 is not available.");
   }
+  if (compmethod == "CHUNKED") return TRUE;
 
   PRIVATE(this)->compmethod = SbName("NONE");
   PRIVATE(this)->complevel = 0.0f;
@@ -1715,4 +1735,12 @@ SoOutput_getHeaderString(const SoOutputP * pout)
   else return SoOutput::getDefaultASCIIHeader();
 }
 
+// Declared in SoOutput_Writer.h. Used to get at the chunked file
+// writer from SoBase::writeHeader() and SoMField::writeValue().
+SoOutput_Writer *
+SoOutput_Writer::getWriter(SoOutput * out)
+{
+  return PRIVATE(out)->getWriter();
+}
+
 #undef PRIVATE
@@ -34,6 +34,7 @@
 #include "coindefs.h"
 
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 
 #ifdef HAVE_CONFIG_H
@@ -90,6 +91,9 @@ SoOutput_Writer::createWriter(FILE * fp,
                               const SbName & compmethod,
                               const float level)
 {
+  if (compmethod == "CHUNKED") {
+    return new SoOutput_ChunkedFileWriter(fp, shouldclose, level);
+  }
   if (compmethod == "GZIP") {
     if (cc_zlibglue_available()) {
       return new SoOutput_GZFileWriter(fp, shouldclose, level);
@@ -355,5 +359,121 @@ SoOutput_BZ2FileWriter::bytesInBuf(void)
   return this->writecounter;
 }
 
+//
+// chunked file writer
+//
+
+SoOutput_ChunkedFileWriter::SoOutput_ChunkedFileWriter(FILE * fparg, const SbBool shouldclosearg, const float levelarg)
+{
+  this->fp = fparg;
+  this->shouldclose = shouldclosearg;
+  this->level = levelarg;
+  this->fileoffset = SoChunkedFile::HEADER_SIZE;
+  this->scene = NULL;
+  this->scenesize = 0;
+  this->scenecapacity = 0;
+
+  this->failed = !SoChunkedFile::writeHeader(this->fp);
+  if (this->failed) {
+    SoDebugError::postWarning("SoOutput_ChunkedFileWriter::SoOutput_ChunkedFileWriter",
+                              "Unable to write file header.");
+  }
+  // placeholder for the scene graph, which is written last
+  SoChunkedFile::Chunk chunk;
+  chunk.method = SoChunkedFile::STORED;
+  chunk.offset = chunk.compressedsize = chunk.size = 0;
+  chunk.object = -1;
+  this->chunks.append(chunk);
+}
+
+SoOutput_ChunkedFileWriter::~SoOutput_ChunkedFileWriter()
+{
+  if (!this->failed) {
+    if (!this->writeChunk(this->scene, this->scenesize, this->chunks[0]) ||
+        !SoChunkedFile::writeTableOfContents(this->fp, this->fileoffset,
+                                             this->chunks, this->objects)) {
+      SoDebugError::postWarning("SoOutput_ChunkedFileWriter::~SoOutput_ChunkedFileWriter",
+                                "I/O error while writing.");
+    }
+  }
+  free(this->scene);
+  if (this->shouldclose) {
+    assert(this->fp);
+    fclose(this->fp);
+  }
+}
+
+SoOutput_Writer::WriterType
+SoOutput_ChunkedFileWriter::getType(void) const
+{
+  return CHUNKEDFILE;
+}
+
+size_t
+SoOutput_ChunkedFileWriter::write(const char * buf, size_t numbytes, const SbBool COIN_UNUSED_ARG(binary))
+{
+  if (this->scenesize + numbytes > this->scenecapacity) {
+    size_t newcapacity = this->scenecapacity ? this->scenecapacity : 65536;
+    while (newcapacity < this->scenesize + numbytes) newcapacity *= 2;
+    char * newscene = (char *) realloc(this->scene, newcapacity);
+    if (!newscene) return 0;
+    this->scene = newscene;
+    this->scenecapacity = newcapacity;
+  }
+  (void) memcpy(this->scene + this->scenesize, buf, numbytes);
+  this->scenesize += numbytes;
+  return numbytes;
+}
+
+size_t
+SoOutput_ChunkedFileWriter::bytesInBuf(void)
+{
+  return this->scenesize;
+}
+
+int
+SoOutput_ChunkedFileWriter::addChunk(const void * data, const size_t size,
+                                     const SbName & field)
+{
+  if (this->failed) return -1;
+
+  SoChunkedFile::Chunk chunk;
+  chunk.object = this->objects.getLength() - 1;
+  chunk.field = field;
+  if (!this->writeChunk(data, size, chunk)) {
+    SoDebugError::postWarning("SoOutput_ChunkedFileWriter::addChunk",
+                              "I/O error while writing.");
+    this->failed = TRUE;
+    return -1;
+  }
+  this->chunks.append(chunk);
+  return this->chunks.getLength() - 1;
+}
+
+void
+SoOutput_ChunkedFileWriter::addObject(const SbName & type, const SbName & name)
+{
+  SoChunkedFile::Object object;
+  object.type = type;
+  object.name = name;
+  object.offset = this->scenesize;
+  this->objects.append(object);
+}
+
+SbBool
+SoOutput_ChunkedFileWriter::writeChunk(const void * data, const size_t size,
+                                       SoChunkedFile::Chunk & chunk)
+{
+  unsigned char * compressed =
+    SoChunkedFile::compressChunk(data, size, this->level, chunk);
+  chunk.offset = this->fileoffset;
+  const void * out = compressed ? compressed : data;
+  const size_t outsize = (size_t) chunk.compressedsize;
+  const SbBool ok = (outsize == 0) || (fwrite(out, 1, outsize, this->fp) == outsize);
+  free(compressed);
+  this->fileoffset += outsize;
+  return ok;
+}
+
 #undef BZ_OK
 #undef BZ_IO_ERROR
@@ -42,6 +42,8 @@
 #include <Inventor/SoOutput.h>
 #include <stdio.h>
 
+#include "io/SoChunkedFile.h"
+
 // *************************************************************************
 
 class SoOutput_Writer {
@@ -54,7 +56,8 @@ public:
     REGULAR_FILE,
     MEMBUFFER,
     GZFILE,
-    BZ2FILE
+    BZ2FILE,
+    CHUNKEDFILE
   };
 
   // default method returns NULL. Should return the FILE pointer if
@@ -76,6 +79,9 @@ public:
                                         const SbName & compmethod,
                                         const float level);
 
+  // returns the writer used by out. Implemented in SoOutput.cpp.
+  static SoOutput_Writer * getWriter(SoOutput * out);
+
 };
 
 // class for stdio writing
@@ -147,4 +153,36 @@ public:
   size_t writecounter;
 };
 
+// class for chunked file writing. The scene graph is kept in memory
+// and written as chunk 0 when the writer is destructed, while the
+// other chunks are compressed and written as soon as they are added.
+class SoOutput_ChunkedFileWriter : public SoOutput_Writer {
+public:
+  SoOutput_ChunkedFileWriter(FILE * fp, const SbBool shouldclose, const float level);
+  virtual ~SoOutput_ChunkedFileWriter();
+
+  virtual size_t bytesInBuf(void);
+  virtual WriterType getType(void) const;
+  virtual size_t write(const char * buf, size_t numbytes, const SbBool binary);
+
+  // writes a chunk with the values of field of the last object
+  // added, and returns its index, or -1 if it could not be written
+  int addChunk(const void * data, const size_t size, const SbName & field);
+  void addObject(const SbName & type, const SbName & name);
+
+private:
+  SbBool writeChunk(const void * data, const size_t size, SoChunkedFile::Chunk & chunk);
+
+  FILE * fp;
+  SbBool shouldclose;
+  float level;
+  uint64_t fileoffset;
+  SbBool failed;
+  char * scene;
+  size_t scenesize;
+  size_t scenecapacity;
+  SbList<SoChunkedFile::Chunk> chunks;
+  SbList<SoChunkedFile::Object> objects;
+};
+
 #endif // COIN_SOOUTPUT_WRITER_H
@@ -1,54 +1,324 @@
-/**************************************************************************\
- * Copyright (c) Kongsberg Oil & Gas Technologies AS
- * All rights reserved.
- * 
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are
- * met:
- * 
- * Redistributions of source code must retain the above copyright notice,
- * this list of conditions and the following disclaimer.
- * 
- * Redistributions in binary form must reproduce the above copyright
- * notice, this list of conditions and the following disclaimer in the
- * documentation and/or other materials provided with the distribution.
- * 
- * Neither the name of the copyright holder nor the names of its
- * contributors may be used to endorse or promote products derived from
- * this software without specific prior written permission.
- * 
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
- * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
- * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
- * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
- * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
- * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
- * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
- * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
- * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
- * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
- * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-\**************************************************************************/
-
-// FIXME: this class has not been implemented yet. 20000627 mortene.
+
+/*!
+  \class SoTranReceiver SoTranReceiver.h Inventor/misc/SoTranReceiver.h
+  \brief The SoTranReceiver class applies scene graph changes sent by an SoTranSender.
+  \ingroup general
+
+  The receiver keeps a replica of the nodes sent by an SoTranSender
+  below the root node given to the constructor, and applies one
+  batch of edits per call to interpret().
+
+  \sa SoTranSender
+*/
 
 #include <Inventor/misc/SoTranReceiver.h>
-#include <coindefs.h> // COIN_STUB
 
+#include <Inventor/SoInput.h>
+#include <Inventor/errors/SoReadError.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/fields/SoMField.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/nodes/SoGroup.h>
+
+#include "io/SoTranscribeP.h"
+
+// *************************************************************************
+
+class SoTranReceiverP {
+public:
+  SoTranReceiverP(SoGroup * root) : root(root) { }
+
+  SoNode * readNode(SoInput * in);
+  SoNode * getNode(SoInput * in);
+  SoGroup * getGroup(SoInput * in);
+  SbBool readString(SoInput * in, SbString & s);
+  SbBool readFields(SoInput * in, SoNode * node);
+
+  SoGroup * root;
+  // the nodes sent, indexed by id, each of them referenced
+  SbList <SoNode *> nodes;
+  SbList <char> buffer;
+};
+
+#define PRIVATE(obj) ((obj)->pimpl)
+
+// *************************************************************************
+
+// Reads the complete value of the field.
+SbBool
+SoTranscribeP::readValue(SoInput * in, SoField * field)
+{
+  if (!field->readValue(in)) return FALSE;
+  field->valueChanged();
+  return TRUE;
+}
+
+// Reads \a num values of the multi-field, starting at \a start, after
+// setting the number of values to \a total.
+SbBool
+SoTranscribeP::readValues(SoInput * in, SoMField * field,
+                          const int start, const int num, const int total)
+{
+  if (start < 0 || num < 0 || total < 0 || start + num > total) return FALSE;
+  field->evaluate();
+  const SbBool notify = field->enableNotify(FALSE);
+  field->setNum(total);
+  field->unshareValues();
+  field->enableNotify(notify);
+  for (int i = start; i < start + num; i++) {
+    if (!field->read1Value(in, i)) return FALSE;
+  }
+  // notify with the range of changed values, as the sender does
+  field->setChangedIndices(start, num);
+  field->valueChanged();
+  field->setChangedIndices();
+  return TRUE;
+}
+
+// *************************************************************************
+
+// Reads a node id, and returns the node, or NULL on errors.
+SoNode *
+SoTranReceiverP::getNode(SoInput * in)
+{
+  int id;
+  if (!in->read(id)) {
+    SoReadError::post(in, "Premature end of transcription");
+    return NULL;
+  }
+  if (id < 0 || id >= this->nodes.getLength() || this->nodes[id] == NULL) {
+    SoReadError::post(in, "Unknown node id %d", id);
+    return NULL;
+  }
+  return this->nodes[id];
+}
+
+SoGroup *
+SoTranReceiverP::getGroup(SoInput * in)
+{
+  SoNode * node = this->getNode(in);
+  if (node && !node->isOfType(SoGroup::getClassTypeId())) {
+    SoReadError::post(in, "Node of type %s is not a group",
+                      node->getTypeId().getName().getString());
+    return NULL;
+  }
+  return (SoGroup *) node;
+}
+
+SbBool
+SoTranReceiverP::readString(SoInput * in, SbString & s)
+{
+  int length;
+  if (!in->read(length) || length < 0) return FALSE;
+  this->buffer.truncate(0);
+  if (in->isBinary()) {
+    const int padded = (length + 3) / 4 * 4;
+    for (int i = 0; i < padded; i++) this->buffer.append('\0');
+    if (!in->readBinaryArray((unsigned char *) this->buffer.getArrayPtr(), padded)) {
+      return FALSE;
+    }
+  }
+  else {
+    char c;
+    // skip the separator after the length
+    if (!in->get(c)) return FALSE;
+    for (int i = 0; i < length; i++) {
+      if (!in->get(c)) return FALSE;
+      this->buffer.append(c);
+    }
+  }
+  if (this->buffer.getLength() == length) this->buffer.append('\0');
+  else this->buffer[length] = '\0';
+  s = this->buffer.getArrayPtr();
+  return TRUE;
+}
+
+SbBool
+SoTranReceiverP::readFields(SoInput * in, SoNode * node)
+{
+  int numfields;
+  if (!in->read(numfields)) return FALSE;
+  SbString name;
+  for (int i = 0; i < numfields; i++) {
+    int start;
+    if (!this->readString(in, name) || !in->read(start)) return FALSE;
+    SoField * field = node->getField(SbName(name.getString()));
+    if (field == NULL) {
+      SoReadError::post(in, "Unknown field \"%s\" in node of type %s",
+                        name.getString(), node->getTypeId().getName().getString());
+      return FALSE;
+    }
+    SbBool ok;
+    if (start < 0) ok = SoTranscribeP::readValue(in, field);
+    else {
+      int num, total;
+      ok = field->isOfType(SoMField::getClassTypeId()) &&
+        in->read(num) && in->read(total) &&
+        SoTranscribeP::readValues(in, (SoMField *) field, start, num, total);
+    }
+    if (!ok) {
+      SoReadError::post(in, "Invalid value for field \"%s\"", name.getString());
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+// Reads a node, either a reference to an already known node or a
+// complete node with its children. Returns NULL on errors.
+SoNode *
+SoTranReceiverP::readNode(SoInput * in)
+{
+  int id, isnew;
+  if (!in->read(id) || !in->read(isnew)) {
+    SoReadError::post(in, "Premature end of transcription");
+    return NULL;
+  }
+  if (!isnew) {
+    if (id < 0 || id >= this->nodes.getLength() || this->nodes[id] == NULL) {
+      SoReadError::post(in, "Unknown node id %d", id);
+      return NULL;
+    }
+    return this->nodes[id];
+  }
+
+  SbString typename_, name;
+  if (!this->readString(in, typename_) || !this->readString(in, name)) {
+    SoReadError::post(in, "Premature end of transcription");
+    return NULL;
+  }
+  SoType type = SoType::fromName(SbName(typename_.getString()));
+  if (type == SoType::badType() || !type.isDerivedFrom(SoNode::getClassTypeId()) ||
+      !type.canCreateInstance()) {
+    SoReadError::post(in, "Unknown node type %s", typename_.getString());
+    return NULL;
+  }
+  if (id < 0 || (id < this->nodes.getLength() && this->nodes[id] != NULL)) {
+    SoReadError::post(in, "Invalid node id %d", id);
+    return NULL;
+  }
+  SoNode * node = (SoNode *) type.createInstance();
+  node->ref();
+  while (this->nodes.getLength() <= id) this->nodes.append(NULL);
+  this->nodes[id] = node;
+  if (name.getLength() > 0) node->setName(SbName(name.getString()));
+
+  if (!this->readFields(in, node)) return NULL;
+
+  int numchildren;
+  if (!in->read(numchildren)) return NULL;
+  if (numchildren >= 0) {
+    if (!node->isOfType(SoGroup::getClassTypeId())) {
+      SoReadError::post(in, "Node of type %s can not have children",
+                        typename_.getString());
+      return NULL;
+    }
+    for (int i = 0; i < numchildren; i++) {
+      SoNode * child = this->readNode(in);
+      if (child == NULL) return NULL;
+      ((SoGroup *) node)->addChild(child);
+    }
+  }
+  return node;
+}
 
-SoTranReceiver::SoTranReceiver(SoGroup * COIN_UNUSED_ARG(root))
+// *************************************************************************
+
+/*!
+  Constructor. Nodes inserted with SoTranSender::insert(SoNode *) will
+  be added as children of \a root.
+*/
+SoTranReceiver::SoTranReceiver(SoGroup * root)
 {
-  COIN_STUB();
+  PRIVATE(this) = new SoTranReceiverP(root);
+  root->ref();
 }
 
+/*!
+  Destructor.
+*/
 SoTranReceiver::~SoTranReceiver()
 {
-  COIN_STUB();
+  for (int i = 0; i < PRIVATE(this)->nodes.getLength(); i++) {
+    if (PRIVATE(this)->nodes[i]) PRIVATE(this)->nodes[i]->unref();
+  }
+  PRIVATE(this)->root->unref();
+  delete PRIVATE(this);
 }
 
+/*!
+  Reads and applies one batch of edits, as written by one call to
+  SoTranSender::prepareToSend(). Returns \c FALSE if the end of the
+  input was reached before the end of the batch, or if the input
+  could not be interpreted.
+*/
 SbBool
-SoTranReceiver::interpret(SoInput * COIN_UNUSED_ARG(in))
+SoTranReceiver::interpret(SoInput * in)
 {
-  COIN_STUB();
-  return FALSE;
+  SoTranReceiverP * pimpl = PRIVATE(this);
+  int command, index;
+  SoNode * node;
+  SoGroup * parent;
+
+  // the header must be read before the format is known
+  if (!in->isValidFile()) return FALSE;
+
+  for (;;) {
+    if (!in->read(command)) return FALSE;
+
+    switch (command) {
+    case SOTRAN_END:
+      return TRUE;
+    case SOTRAN_INSERT_ROOT:
+      if ((node = pimpl->readNode(in)) == NULL) return FALSE;
+      pimpl->root->addChild(node);
+      break;
+    case SOTRAN_INSERT:
+      if ((parent = pimpl->getGroup(in)) == NULL || !in->read(index) ||
+          (node = pimpl->readNode(in)) == NULL) return FALSE;
+      if (index < 0 || index >= parent->getNumChildren()) parent->addChild(node);
+      else parent->insertChild(node, index);
+      break;
+    case SOTRAN_REMOVE:
+      if ((parent = pimpl->getGroup(in)) == NULL || !in->read(index)) return FALSE;
+      if (index < 0 || index >= parent->getNumChildren()) {
+        SoReadError::post(in, "Child index %d out of range", index);
+        return FALSE;
+      }
+      parent->removeChild(index);
+      break;
+    case SOTRAN_REPLACE:
+      if ((parent = pimpl->getGroup(in)) == NULL || !in->read(index) ||
+          (node = pimpl->readNode(in)) == NULL) return FALSE;
+      if (index < 0 || index >= parent->getNumChildren()) {
+        SoReadError::post(in, "Child index %d out of range", index);
+        return FALSE;
+      }
+      parent->replaceChild(index, node);
+      break;
+    case SOTRAN_REMOVE_ALL:
+      if ((parent = pimpl->getGroup(in)) == NULL) return FALSE;
+      parent->removeAllChildren();
+      break;
+    case SOTRAN_MODIFY:
+      if ((node = pimpl->getNode(in)) == NULL || !pimpl->readFields(in, node)) {
+        return FALSE;
+      }
+      break;
+    case SOTRAN_FORGET:
+      if (!in->read(index)) return FALSE;
+      if (index < 0 || index >= pimpl->nodes.getLength() || pimpl->nodes[index] == NULL) {
+        SoReadError::post(in, "Unknown node id %d", index);
+        return FALSE;
+      }
+      pimpl->nodes[index]->unref();
+      pimpl->nodes[index] = NULL;
+      break;
+    default:
+      SoReadError::post(in, "Unknown transcription command %d", command);
+      return FALSE;
+    }
+  }
 }
+
+#undef PRIVATE
@@ -30,61 +30,812 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
-// FIXME: this class has not been implemented yet. 20000627 mortene.
+/*!
+  \class SoTranSender SoTranSender.h Inventor/misc/SoTranSender.h
+  \brief The SoTranSender class is used for replicating scene graph changes.
+  \ingroup general
+
+  An SoTranSender writes a stream of scene graph edits to an
+  SoOutput, which an SoTranReceiver applies to a copy of the scene
+  graph, e.g. in another process at the other end of a pipe or
+  socket. The first time a node is sent, the complete node is
+  written. After that, the node is referred to by an id, so
+  following edits only cost the size of the changed field values.
+
+  The edit methods only record the edits. They are written, in the
+  order they were made, by prepareToSend(), which should be called
+  once per batch of changes (typically once per frame).
+
+  With setTrackChanges(), the sender will instead detect changes to
+  the subgraphs passed to insert(SoNode *) by itself. Field changes
+  and group child changes are then sent without any calls to
+  modify(), insert() or remove().
+
+  Fields containing nodes, paths or engines are not transmitted,
+  and neither are the hidden children of nodes which are not
+  SoGroup nodes, like nodekits.
+
+  \sa SoTranReceiver
+*/
 
 #include <Inventor/misc/SoTranSender.h>
-#include <coindefs.h> // COIN_STUB
-#include <stdlib.h>
 
-SoTranSender::SoTranSender(SoOutput * COIN_UNUSED_ARG(output))
+#include <stdio.h>
+
+#include <Inventor/SoOutput.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/fields/SoMField.h>
+#include <Inventor/fields/SoFieldData.h>
+#include <Inventor/fields/SoSFNode.h>
+#include <Inventor/fields/SoMFNode.h>
+#include <Inventor/fields/SoSFPath.h>
+#include <Inventor/fields/SoMFPath.h>
+#include <Inventor/fields/SoSFEngine.h>
+#include <Inventor/fields/SoMFEngine.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+#include "misc/SbHash.h"
+#include "io/SoTranscribeP.h"
+
+// *************************************************************************
+
+namespace {
+
+// An edit waiting for prepareToSend(). Nodes in a record are
+// referenced until the record has been written.
+struct SoTranRecord {
+  SoTranCommand command;
+  SoNode * node;
+  SoNode * child;
+  int index;
+  SbBool allfields;
+  // the changed fields, each with the range of changed values, or
+  // -1 if the complete field has changed
+  SbList <int> fields;
+  SbList <int> firstchanged;
+  SbList <int> lastchanged;
+  // children leaving the scene, to be forgotten if no longer used
+  SbList <SoNode *> removed;
+};
+
+} // anonymous namespace
+
+class SoTranSenderP {
+public:
+  SoTranSenderP(SoOutput * output)
+    : output(output), nextid(0), track(FALSE), laststamp(0) { }
+
+  SoTranRecord * addRecord(SoTranCommand command, SoNode * node,
+                           SoNode * child = NULL, int index = -1);
+  void addRemoved(SoTranRecord * record, SoNode * parent, int index);
+  void deleteRecord(SoTranRecord * record);
+  void addModify(SoNode * node, int field, int first = -1, int num = 0);
+  void notify(SoNotList * l);
+
+  void writeInt(int value);
+  void writeString(const SbString & s);
+  void writeFields(SoNode * node, const SbList <int> & fields,
+                   const SbList <int> * firstchanged = NULL,
+                   const SbList <int> * lastchanged = NULL);
+  void writeNode(SoNode * node);
+  SbBool getId(SoNode * node, int & id) const;
+  void forget(SoNode * node);
+
+  SoOutput * output;
+  // nodes known by the receiver, each of them referenced
+  SbHash<const SoNode *, int> ids;
+  int nextid;
+  // nodes written in full in the current batch
+  SbHash<const SoNode *, int> written;
+  SbList <SoTranRecord *> records;
+  SbHash<const SoNode *, SoTranRecord *> modifyrecords;
+  SbList <SoNodeSensor *> sensors;
+  SbBool track;
+  uint32_t laststamp;
+};
+
+namespace {
+
+// Records the changes below a tracked root. The sensor is never
+// scheduled, the changes are recorded immediately from the
+// notification.
+class SoTranSensor : public SoNodeSensor {
+public:
+  SoTranSensor(SoTranSenderP * sender) : sender(sender) { }
+  virtual void notify(SoNotList * l) { this->sender->notify(l); }
+private:
+  SoTranSenderP * sender;
+};
+
+SbBool
+sotransender_is_transmittable(const SoField * field)
+{
+  // node, path and engine values can't be written as field values
+  // without also transmitting what they point to
+  return !(field->isOfType(SoSFNode::getClassTypeId()) ||
+           field->isOfType(SoMFNode::getClassTypeId()) ||
+           field->isOfType(SoSFPath::getClassTypeId()) ||
+           field->isOfType(SoMFPath::getClassTypeId()) ||
+           field->isOfType(SoSFEngine::getClassTypeId()) ||
+           field->isOfType(SoMFEngine::getClassTypeId()));
+}
+
+} // anonymous namespace
+
+// *************************************************************************
+
+// Writes the complete value of the field.
+void
+SoTranscribeP::writeValue(SoOutput * out, const SoField * field)
+{
+  // values loaded on demand are loaded here
+  field->evaluate();
+  field->writeValue(out);
+  if (!out->isBinary()) out->write(' ');
+}
+
+// Writes \a num values of the multi-field, starting at \a start.
+void
+SoTranscribeP::writeValues(SoOutput * out, const SoMField * field,
+                           const int start, const int num)
+{
+  field->evaluate();
+  for (int i = start; i < start + num; i++) {
+    field->write1Value(out, i);
+    if (!out->isBinary()) out->write(' ');
+  }
+}
+
+#define PRIVATE(obj) ((obj)->pimpl)
+
+// *************************************************************************
+
+SoTranRecord *
+SoTranSenderP::addRecord(SoTranCommand command, SoNode * node,
+                         SoNode * child, int index)
+{
+  SoTranRecord * record = new SoTranRecord;
+  record->command = command;
+  record->node = node;
+  record->child = child;
+  record->index = index;
+  record->allfields = FALSE;
+  if (node) node->ref();
+  if (child) child->ref();
+  this->records.append(record);
+  return record;
+}
+
+void
+SoTranSenderP::addRemoved(SoTranRecord * record, SoNode * parent, int index)
+{
+  if (!parent->isOfType(SoGroup::getClassTypeId())) return;
+  SoGroup * group = (SoGroup *) parent;
+  const int first = index < 0 ? 0 : index;
+  const int last = index < 0 ? group->getNumChildren() : index + 1;
+  for (int i = first; i < last && i < group->getNumChildren(); i++) {
+    SoNode * child = group->getChild(i);
+    child->ref();
+    record->removed.append(child);
+  }
+}
+
+void
+SoTranSenderP::deleteRecord(SoTranRecord * record)
+{
+  if (record->node) record->node->unref();
+  if (record->child) record->child->unref();
+  for (int i = 0; i < record->removed.getLength(); i++) {
+    record->removed[i]->unref();
+  }
+  delete record;
+}
+
+// Records a change to \a field of \a node, or to all fields if \a
+// field is -1. \a first and \a num give the changed values of a
+// multi-field, and \a first is -1 if all values may have changed.
+void
+SoTranSenderP::addModify(SoNode * node, int field, int first, int num)
+{
+  // Field values are written as they are when the batch is sent, so
+  // all changes to a node in a batch can be written together.
+  SoTranRecord * record;
+  if (!this->modifyrecords.get(node, record)) {
+    record = this->addRecord(SOTRAN_MODIFY, node);
+    this->modifyrecords.put(node, record);
+  }
+  if (field < 0) {
+    record->allfields = TRUE;
+    return;
+  }
+  const int last = first < 0 ? -1 : first + num - 1;
+  const int idx = record->fields.find(field);
+  if (idx < 0) {
+    record->fields.append(field);
+    record->firstchanged.append(first);
+    record->lastchanged.append(last);
+  }
+  else if (record->firstchanged[idx] >= 0) {
+    // several changes in a batch are sent as one range
+    if (first < 0) record->firstchanged[idx] = -1;
+    else {
+      if (first < record->firstchanged[idx]) record->firstchanged[idx] = first;
+      if (last > record->lastchanged[idx]) record->lastchanged[idx] = last;
+    }
+  }
+}
+
+void
+SoTranSenderP::notify(SoNotList * l)
+{
+  // a change seen through several tracked roots is only recorded once
+  if (l->getTimeStamp() == this->laststamp) return;
+  this->laststamp = l->getTimeStamp();
+
+  SoNotRec * rec = l->getFirstRecAtNode();
+  if (rec == NULL) return;
+  SoNode * node = (SoNode *) rec->getBase();
+  SoTranRecord * record;
+
+  // Removals are notified before the children are removed from the
+  // group, insertions and replacements after.
+  switch (rec->getOperationType()) {
+  case SoNotRec::GROUP_ADDCHILD:
+    this->addRecord(SOTRAN_INSERT, node, (SoNode *) rec->getGroupChild(), -1);
+    break;
+  case SoNotRec::GROUP_INSERTCHILD:
+    this->addRecord(SOTRAN_INSERT, node, (SoNode *) rec->getGroupChild(),
+                    rec->getIndex());
+    break;
+  case SoNotRec::GROUP_REMOVECHILD:
+    record = this->addRecord(SOTRAN_REMOVE, node, NULL, rec->getIndex());
+    this->addRemoved(record, node, rec->getIndex());
+    break;
+  case SoNotRec::GROUP_REPLACECHILD:
+    record = this->addRecord(SOTRAN_REPLACE, node, (SoNode *) rec->getGroupChild(),
+                             rec->getIndex());
+    if (rec->getGroupPrevChild()) {
+      SoNode * prev = (SoNode *) rec->getGroupPrevChild();
+      prev->ref();
+      record->removed.append(prev);
+    }
+    break;
+  case SoNotRec::GROUP_REMOVEALLCHILDREN:
+    record = this->addRecord(SOTRAN_REMOVE_ALL, node);
+    this->addRemoved(record, node, -1);
+    break;
+  default:
+    {
+      SoField * field = l->getLastField();
+      if (field && field->getContainer() == node &&
+          sotransender_is_transmittable(field)) {
+        const SoFieldData * fielddata = node->getFieldData();
+        // the record of a multi-field change has the changed values
+        int first = -1, num = 0;
+        if (field->isOfType(SoMField::getClassTypeId()) &&
+            rec->getOperationType() == SoNotRec::FIELD_UPDATE &&
+            rec->getIndex() >= 0 && rec->getFieldNumIndices() > 0) {
+          first = rec->getIndex();
+          num = rec->getFieldNumIndices();
+        }
+        if (fielddata) {
+          this->addModify(node, fielddata->getIndex(node, field), first, num);
+        }
+      }
+    }
+    break;
+  }
+}
+
+void
+SoTranSenderP::writeInt(int value)
 {
-  COIN_STUB();
+  this->output->write(value);
+  if (!this->output->isBinary()) this->output->write(' ');
 }
 
+// Strings are written as their length followed by the characters,
+// as field values may be longer than what SoInput can read as a
+// binary string, and may contain quotes and newlines.
+void
+SoTranSenderP::writeString(const SbString & s)
+{
+  const int length = s.getLength();
+  this->writeInt(length);
+  if (this->output->isBinary()) {
+    static const unsigned char padding[3] = { 0, 0, 0 };
+    this->output->writeBinaryArray((const unsigned char *) s.getString(), length);
+    if (length % 4) this->output->writeBinaryArray(padding, 4 - length % 4);
+  }
+  else {
+    this->output->write(s.getString());
+    this->output->write(' ');
+  }
+}
+
+// Writes the fields, each with the range of changed values if
+// ranges are given, or the complete values otherwise.
+void
+SoTranSenderP::writeFields(SoNode * node, const SbList <int> & fields,
+                           const SbList <int> * firstchanged,
+                           const SbList <int> * lastchanged)
+{
+  const SoFieldData * fielddata = node->getFieldData();
+  this->writeInt(fields.getLength());
+  for (int i = 0; i < fields.getLength(); i++) {
+    SoField * field = fielddata->getField(node, fields[i]);
+    this->writeString(fielddata->getFieldName(fields[i]).getString());
+
+    int first = firstchanged ? (*firstchanged)[i] : -1;
+    if (first >= 0) {
+      // values beyond the end have been deleted since they changed
+      const SoMField * mfield = (const SoMField *) field;
+      const int num = mfield->getNum();
+      int last = (*lastchanged)[i];
+      if (last >= num) last = num - 1;
+      if (first > last) first = last = num;
+      this->writeInt(first);
+      this->writeInt(last - first + 1);
+      this->writeInt(num);
+      SoTranscribeP::writeValues(this->output, mfield, first, last - first + 1);
+    }
+    else {
+      this->writeInt(-1);
+      SoTranscribeP::writeValue(this->output, field);
+    }
+  }
+}
+
+SbBool
+SoTranSenderP::getId(SoNode * node, int & id) const
+{
+  return this->ids.get(node, id);
+}
+
+void
+SoTranSenderP::writeNode(SoNode * node)
+{
+  int id;
+  if (this->getId(node, id)) {
+    this->writeInt(id);
+    this->writeInt(0);
+    return;
+  }
+  id = this->nextid++;
+  node->ref();
+  this->ids.put(node, id);
+  this->written.put(node, id);
+
+  this->writeInt(id);
+  this->writeInt(1);
+  this->writeString(node->getTypeId().getName().getString());
+  this->writeString(node->getName().getString());
+
+  SbList <int> fields;
+  const SoFieldData * fielddata = node->getFieldData();
+  const int numfields = fielddata ? fielddata->getNumFields() : 0;
+  for (int i = 0; i < numfields; i++) {
+    SoField * field = fielddata->getField(node, i);
+    if (!field->isDefault() && sotransender_is_transmittable(field)) {
+      fields.append(i);
+    }
+  }
+  this->writeFields(node, fields);
+
+  if (node->isOfType(SoGroup::getClassTypeId())) {
+    SoGroup * group = (SoGroup *) node;
+    const int numchildren = group->getNumChildren();
+    this->writeInt(numchildren);
+    if (!this->output->isBinary()) this->output->write('\n');
+    for (int i = 0; i < numchildren; i++) {
+      this->writeNode(group->getChild(i));
+    }
+  }
+  else {
+    this->writeInt(-1);
+    if (!this->output->isBinary()) this->output->write('\n');
+  }
+}
+
+void
+SoTranSenderP::forget(SoNode * node)
+{
+  int id;
+  // only forget nodes that nobody else is using
+  if (!this->getId(node, id) || node->getRefCount() != 1) return;
+
+  SbList <SoNode *> children;
+  if (node->isOfType(SoGroup::getClassTypeId())) {
+    SoGroup * group = (SoGroup *) node;
+    for (int i = 0; i < group->getNumChildren(); i++) {
+      children.append(group->getChild(i));
+    }
+  }
+  this->ids.erase(node);
+  this->writeInt(SOTRAN_FORGET);
+  this->writeInt(id);
+  node->unref();
+  // the children are still referenced by us if they are known
+  for (int i = 0; i < children.getLength(); i++) {
+    this->forget(children[i]);
+  }
+}
+
+// *************************************************************************
+
+/*!
+  Constructor. The edits will be written to \a output.
+*/
+SoTranSender::SoTranSender(SoOutput * output)
+{
+  PRIVATE(this) = new SoTranSenderP(output);
+}
+
+/*!
+  Destructor.
+*/
 SoTranSender::~SoTranSender()
 {
-  COIN_STUB();
+  int i;
+  for (i = 0; i < PRIVATE(this)->sensors.getLength(); i++) {
+    delete PRIVATE(this)->sensors[i];
+  }
+  for (i = 0; i < PRIVATE(this)->records.getLength(); i++) {
+    PRIVATE(this)->deleteRecord(PRIVATE(this)->records[i]);
+  }
+  SbList <const SoNode *> nodes;
+  PRIVATE(this)->ids.makeKeyList(nodes);
+  for (i = 0; i < nodes.getLength(); i++) {
+    nodes[i]->unref();
+  }
+  delete PRIVATE(this);
 }
 
+/*!
+  Returns the output stream the edits are written to.
+*/
 SoOutput *
 SoTranSender::getOutput(void) const
 {
-  COIN_STUB();
-  return NULL;
+  return PRIVATE(this)->output;
 }
 
+/*!
+  Sends \a node, which the receiver adds as the last child of its
+  root node.
+
+  If change tracking is enabled, changes to the subgraph of \a node
+  will be sent automatically from now on.
+*/
 void
-SoTranSender::insert(SoNode * COIN_UNUSED_ARG(node))
+SoTranSender::insert(SoNode * node)
 {
-  COIN_STUB();
+  PRIVATE(this)->addRecord(SOTRAN_INSERT_ROOT, node);
+  if (PRIVATE(this)->track) {
+    SoNodeSensor * sensor = new SoTranSensor(PRIVATE(this));
+    sensor->attach(node);
+    PRIVATE(this)->sensors.append(sensor);
+  }
 }
 
+/*!
+  Sends \a node, which the receiver inserts as child number \a n of
+  \a parent. \a parent must be a group node which has already been
+  sent. If \a n is negative or larger than the number of children,
+  \a node is added as the last child.
+*/
 void
-SoTranSender::insert(SoNode * COIN_UNUSED_ARG(node), SoNode * COIN_UNUSED_ARG(parent), int COIN_UNUSED_ARG(n))
+SoTranSender::insert(SoNode * node, SoNode * parent, int n)
 {
-  COIN_STUB();
+  PRIVATE(this)->addRecord(SOTRAN_INSERT, parent, node, n);
 }
 
+/*!
+  Removes child number \a n of \a parent in the receiver.
+*/
 void
-SoTranSender::remove(SoNode * COIN_UNUSED_ARG(parent), int COIN_UNUSED_ARG(n))
+SoTranSender::remove(SoNode * parent, int n)
 {
-  COIN_STUB();
+  SoTranRecord * record = PRIVATE(this)->addRecord(SOTRAN_REMOVE, parent, NULL, n);
+  // The child at n is either the one to be removed, or the one that
+  // already took its place. Both are only forgotten when unused.
+  if (n >= 0) PRIVATE(this)->addRemoved(record, parent, n);
 }
 
+/*!
+  Replaces child number \a n of \a parent with \a newnode in the
+  receiver.
+*/
 void
-SoTranSender::replace(SoNode * COIN_UNUSED_ARG(parent), int COIN_UNUSED_ARG(n), SoNode * COIN_UNUSED_ARG(newnode))
+SoTranSender::replace(SoNode * parent, int n, SoNode * newnode)
 {
-  COIN_STUB();
+  SoTranRecord * record = PRIVATE(this)->addRecord(SOTRAN_REPLACE, parent, newnode, n);
+  if (n >= 0) PRIVATE(this)->addRemoved(record, parent, n);
 }
 
+/*!
+  Sends the current field values of \a node, which must already have
+  been sent.
+*/
 void
-SoTranSender::modify(SoNode * COIN_UNUSED_ARG(node))
+SoTranSender::modify(SoNode * node)
 {
-  COIN_STUB();
+  PRIVATE(this)->addModify(node, -1);
 }
 
+/*!
+  Writes all edits since the last call to the output, followed by an
+  end-of-batch marker. A call to SoTranReceiver::interpret() applies
+  one batch.
+
+  Nodes are written as they are at the time of this call.
+*/
 void
 SoTranSender::prepareToSend(void)
 {
-  COIN_STUB();
+  SoTranSenderP * pimpl = PRIVATE(this);
+  SbList <SoNode *> removed;
+  int i, id = -1;
+
+  for (i = 0; i < pimpl->records.getLength(); i++) {
+    SoTranRecord * record = pimpl->records[i];
+    // Edits of nodes which are unknown to the receiver, or which were
+    // written in full in this batch, are already part of the nodes as
+    // written.
+    if (record->command != SOTRAN_INSERT_ROOT &&
+        (!pimpl->getId(record->node, id) || pimpl->written.get(record->node, id))) {
+      continue;
+    }
+    pimpl->writeInt(record->command);
+    switch (record->command) {
+    case SOTRAN_INSERT_ROOT:
+      pimpl->writeNode(record->node);
+      break;
+    case SOTRAN_INSERT:
+    case SOTRAN_REPLACE:
+      pimpl->writeInt(id);
+      pimpl->writeInt(record->index);
+      pimpl->writeNode(record->child);
+      break;
+    case SOTRAN_REMOVE:
+      pimpl->writeInt(id);
+      pimpl->writeInt(record->index);
+      break;
+    case SOTRAN_REMOVE_ALL:
+      pimpl->writeInt(id);
+      break;
+    case SOTRAN_MODIFY:
+      pimpl->writeInt(id);
+      if (record->allfields) {
+        record->fields.truncate(0);
+        record->firstchanged.truncate(0);
+        record->lastchanged.truncate(0);
+        const SoFieldData * fielddata = record->node->getFieldData();
+        const int numfields = fielddata ? fielddata->getNumFields() : 0;
+        for (int j = 0; j < numfields; j++) {
+          if (sotransender_is_transmittable(fielddata->getField(record->node, j))) {
+            record->fields.append(j);
+            record->firstchanged.append(-1);
+            record->lastchanged.append(-1);
+          }
+        }
+      }
+      pimpl->writeFields(record->node, record->fields,
+                         &record->firstchanged, &record->lastchanged);
+      break;
+    default:
+      assert(0 && "unknown command");
+      break;
+    }
+    if (!pimpl->output->isBinary()) pimpl->output->write('\n');
+  }
+
+  // The records keep the removed nodes alive, so they can only be
+  // checked when all the records are gone.
+  for (i = 0; i < pimpl->records.getLength(); i++) {
+    SoTranRecord * record = pimpl->records[i];
+    for (int j = 0; j < record->removed.getLength(); j++) {
+      if (pimpl->getId(record->removed[j], id)) removed.append(record->removed[j]);
+    }
+    pimpl->deleteRecord(record);
+  }
+  pimpl->records.truncate(0);
+  pimpl->modifyrecords.clear();
+  pimpl->written.clear();
+
+  for (i = 0; i < removed.getLength(); i++) {
+    pimpl->forget(removed[i]);
+  }
+
+  pimpl->writeInt(SOTRAN_END);
+  if (!pimpl->output->isBinary()) pimpl->output->write('\n');
+  FILE * fp = pimpl->output->getFilePointer();
+  if (fp) (void) fflush(fp);
+}
+
+/*!
+  Enables or disables automatic change tracking. When enabled, the
+  subgraphs of nodes passed to insert(SoNode *) after this call are
+  watched, and all changes to them are recorded for the next
+  prepareToSend(). Do not also report these changes through the edit
+  methods, as they would then be sent twice.
+
+  Tracking is disabled by default.
+*/
+void
+SoTranSender::setTrackChanges(const SbBool onoff)
+{
+  PRIVATE(this)->track = onoff;
+  if (!onoff) {
+    for (int i = 0; i < PRIVATE(this)->sensors.getLength(); i++) {
+      delete PRIVATE(this)->sensors[i];
+    }
+    PRIVATE(this)->sensors.truncate(0);
+  }
 }
+
+/*!
+  Returns whether changes are tracked automatically.
+
+  \sa setTrackChanges()
+*/
+SbBool
+SoTranSender::isTrackingChanges(void) const
+{
+  return PRIVATE(this)->track;
+}
+
+#undef PRIVATE
+
+#ifdef COIN_TEST_SUITE
+
+#include <stdlib.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/misc/SoTranReceiver.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+static SbString
+sotransender_to_string(SoNode * node)
+{
+  SoOutput out;
+  out.setBuffer(malloc(1024), 1024, realloc);
+  SoWriteAction wa(&out);
+  wa.apply(node);
+  void * buf;
+  size_t size;
+  out.getBuffer(buf, size);
+  SbString s((const char *) buf);
+  free(buf);
+  return s;
+}
+
+BOOST_AUTO_TEST_CASE(replicateEdits)
+{
+  for (int binary = 0; binary < 2; binary++) {
+    SoSeparator * root = new SoSeparator;
+    root->ref();
+    SoMaterial * mat = new SoMaterial;
+    root->addChild(mat);
+    for (int i = 0; i < 100; i++) {
+      SoSeparator * sep = new SoSeparator;
+      SoTranslation * t = new SoTranslation;
+      t->translation = SbVec3f(float(i), 0.0f, 0.0f);
+      sep->addChild(t);
+      sep->addChild(new SoCube);
+      root->addChild(sep);
+    }
+
+    SoOutput out;
+    out.setBinary(binary ? TRUE : FALSE);
+    out.setBuffer(malloc(1024), 1024, realloc);
+    SoTranSender sender(&out);
+    sender.setTrackChanges(TRUE);
+    sender.insert(root);
+    sender.prepareToSend();
+    const SbString state1 = sotransender_to_string(root);
+
+    void * buf;
+    size_t size1, size2;
+    out.getBuffer(buf, size1);
+
+    mat->diffuseColor.setValue(1.0f, 0.0f, 0.0f);
+    root->removeChild(5);
+    SoSeparator * sep = (SoSeparator *) root->getChild(10);
+    sep->replaceChild(1, new SoCube);
+    ((SoCube *) sep->getChild(1))->width = 3.0f;
+    root->insertChild(new SoCube, 1);
+    sender.prepareToSend();
+    const SbString state2 = sotransender_to_string(root);
+
+    out.getBuffer(buf, size2);
+    BOOST_CHECK_MESSAGE(size2 - size1 < 512, "edits were not sent as small deltas");
+
+    SoGroup * replica = new SoGroup;
+    replica->ref();
+    SoTranReceiver receiver(replica);
+    SoInput in;
+    in.setBuffer(buf, size2);
+
+    BOOST_CHECK_MESSAGE(receiver.interpret(&in), "first batch not interpreted");
+    BOOST_REQUIRE(replica->getNumChildren() == 1);
+    BOOST_CHECK_MESSAGE(sotransender_to_string(replica->getChild(0)) == state1,
+                        "replica differs from scene after first batch");
+    BOOST_CHECK_MESSAGE(receiver.interpret(&in), "second batch not interpreted");
+    BOOST_CHECK_MESSAGE(sotransender_to_string(replica->getChild(0)) == state2,
+                        "replica differs from scene after second batch");
+    BOOST_CHECK_MESSAGE(!receiver.interpret(&in), "interpreted past end of stream");
+
+    replica->unref();
+    root->unref();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(replicatePartialEdits)
+{
+  for (int binary = 0; binary < 2; binary++) {
+    SoSeparator * root = new SoSeparator;
+    root->ref();
+    SoCoordinate3 * coords = new SoCoordinate3;
+    coords->point.setNum(10000);
+    SbVec3f * points = coords->point.startEditing();
+    for (int i = 0; i < 10000; i++) points[i].setValue(float(i), 1.0f, 2.0f);
+    coords->point.finishEditing();
+    root->addChild(coords);
+
+    SoOutput out;
+    out.setBinary(binary ? TRUE : FALSE);
+    out.setBuffer(malloc(1024), 1024, realloc);
+    SoTranSender sender(&out);
+    sender.setTrackChanges(TRUE);
+    sender.insert(root);
+    sender.prepareToSend();
+
+    void * buf;
+    size_t size1, size2, size3;
+    out.getBuffer(buf, size1);
+
+    // changes to a few values are sent as one range
+    coords->point.set1Value(100, SbVec3f(-1.0f, -2.0f, -3.0f));
+    coords->point.set1Value(102, SbVec3f(-4.0f, -5.0f, -6.0f));
+    sender.prepareToSend();
+    out.getBuffer(buf, size2);
+    BOOST_CHECK_MESSAGE(size2 - size1 < 256, "partial edit was not sent as a delta");
+
+    coords->point.set1Value(10000, SbVec3f(7.0f, 8.0f, 9.0f));
+    sender.prepareToSend();
+    out.getBuffer(buf, size3);
+    BOOST_CHECK_MESSAGE(size3 - size2 < 256, "appended value was not sent as a delta");
+
+    // changes to a range after which values are deleted
+    coords->point.set1Value(4000, SbVec3f(0.0f, 0.0f, 0.0f));
+    coords->point.deleteValues(3000);
+    sender.prepareToSend();
+    const SbString state = sotransender_to_string(root);
+    out.getBuffer(buf, size3);
+
+    SoGroup * replica = new SoGroup;
+    replica->ref();
+    SoTranReceiver receiver(replica);
+    SoInput in;
+    in.setBuffer(buf, size3);
+    for (int i = 0; i < 4; i++) {
+      BOOST_CHECK_MESSAGE(receiver.interpret(&in), "batch not interpreted");
+    }
+    BOOST_REQUIRE(replica->getNumChildren() == 1);
+    BOOST_CHECK_MESSAGE(sotransender_to_string(replica->getChild(0)) == state,
+                        "replica differs from scene after partial edits");
+
+    replica->unref();
+    root->unref();
+  }
+}
+
+#endif // COIN_TEST_SUITE
@@ -0,0 +1,95 @@
+#ifndef COIN_SOTRANSCRIBEP_H
+#define COIN_SOTRANSCRIBEP_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* !COIN_INTERNAL */
+
+#include <Inventor/SbBasic.h>
+
+// The commands of the transcription stream written by SoTranSender
+// and interpreted by SoTranReceiver. Each command is an int followed
+// by its arguments. Nodes are identified by ids assigned by the
+// sender when a node is first written.
+//
+//   INSERT_ROOT  node
+//   INSERT       parentid index node     (index -1 appends)
+//   REMOVE       parentid index
+//   REPLACE      parentid index node
+//   REMOVE_ALL   parentid
+//   MODIFY       nodeid fields
+//   FORGET       nodeid                  (the sender no longer uses the id)
+//   END                                  (end of a prepareToSend() batch)
+//
+// A node is written as its id followed by 0 if the receiver already
+// knows it, or by 1, the type name, the node name, its non-default
+// fields and, for groups, the number of children and the children
+// (-1 for other nodes). Fields are written as a count followed by
+// name and value pairs. A value is either -1 followed by the complete
+// field value, or, when only a part of a multi-field has changed,
+// the index of the first changed value, the number of changed
+// values, the new number of values in the field and the changed
+// values. Values are written in the binary or ASCII format of the
+// stream, as in files.
+
+enum SoTranCommand {
+  SOTRAN_END = 0,
+  SOTRAN_INSERT_ROOT,
+  SOTRAN_INSERT,
+  SOTRAN_REMOVE,
+  SOTRAN_REPLACE,
+  SOTRAN_REMOVE_ALL,
+  SOTRAN_MODIFY,
+  SOTRAN_FORGET
+};
+
+class SoField;
+class SoMField;
+class SoInput;
+class SoOutput;
+
+// Writes and reads field values in the format of the stream.
+class SoTranscribeP {
+public:
+  static void writeValue(SoOutput * out, const SoField * field);
+  static void writeValues(SoOutput * out, const SoMField * field,
+                          const int start, const int num);
+  static SbBool readValue(SoInput * in, SoField * field);
+  static SbBool readValues(SoInput * in, SoMField * field,
+                           const int start, const int num, const int total);
+};
+
+#endif // !COIN_SOTRANSCRIBEP_H
@@ -31,6 +31,7 @@
 \**************************************************************************/
 
 #include "SoByteStream.cpp"
+#include "SoChunkedFile.cpp"
 #include "SoInput.cpp"
 #include "SoInput_FileInfo.cpp"
 #include "SoInput_Reader.cpp"
@@ -165,7 +165,7 @@ SoActionMethodList::setUp(void)
 
     // for node types with no action method, inherit from parent nodetype(s)
     SoTypeList allnodes;
-    SoType::getAllDerivedFrom(SoNode::getClassTypeId(), allnodes);
+    SoType::getAllInitializedDerivedFrom(SoNode::getClassTypeId(), allnodes);
     n = allnodes.getLength();
 
     for (i = 0; i < n; i++) {
@@ -0,0 +1,342 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "misc/SbIdDepthBuffer.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+#include "misc/SbLassoGrid.h"
+
+// *************************************************************************
+
+// Clip a convex polygon against the plane where dot(plane, v) >= 0,
+// i.e. (w + z) >= 0 for the near plane and (w - z) >= 0 for the far
+// plane. Returns the number of vertices written to 'out'.
+static int
+clip_polygon(const SbVec4f * in, const int n, SbVec4f * out, const float zsign)
+{
+  int num = 0;
+  for (int i = 0; i < n; i++) {
+    const SbVec4f & a = in[i];
+    const SbVec4f & b = in[(i + 1) % n];
+    const float da = a[3] + zsign * a[2];
+    const float db = b[3] + zsign * b[2];
+    if (da >= 0.0f) out[num++] = a;
+    if ((da >= 0.0f) != (db >= 0.0f)) {
+      const float t = da / (da - db);
+      out[num++] = a + (b - a) * t;
+    }
+  }
+  return num;
+}
+
+static SbBool
+clip_segment(SbVec4f & a, SbVec4f & b, const float zsign)
+{
+  const float da = a[3] + zsign * a[2];
+  const float db = b[3] + zsign * b[2];
+  if (da < 0.0f && db < 0.0f) return FALSE;
+  if (da < 0.0f) a = a + (b - a) * (da / (da - db));
+  else if (db < 0.0f) b = b + (a - b) * (db / (db - da));
+  return TRUE;
+}
+
+// *************************************************************************
+
+SbIdDepthBuffer::SbIdDepthBuffer(void)
+  : capacity(0), depth(NULL), ids(NULL)
+{
+  this->regionorigin[0] = this->regionorigin[1] = 0;
+  this->regionsize[0] = this->regionsize[1] = 0;
+}
+
+SbIdDepthBuffer::~SbIdDepthBuffer()
+{
+  delete[] this->depth;
+  delete[] this->ids;
+}
+
+// Sets up the viewport used for mapping clip coordinates to window
+// coordinates, and the window space pixel region to store, and
+// clears the buffer. The region is clipped against the viewport.
+void
+SbIdDepthBuffer::setRegion(const SbVec2s & vporigin, const SbVec2s & vpsize,
+                           const SbBox2s & region)
+{
+  this->vporigin.setValue((float) vporigin[0], (float) vporigin[1]);
+  this->vpsize.setValue((float) vpsize[0], (float) vpsize[1]);
+
+  for (int i = 0; i < 2; i++) {
+    const int lo = SbMax((int) region.getMin()[i], (int) vporigin[i]);
+    const int hi = SbMin((int) region.getMax()[i],
+                         (int) vporigin[i] + (int) vpsize[i] - 1);
+    this->regionorigin[i] = lo;
+    this->regionsize[i] = SbMax(hi - lo + 1, 0);
+  }
+  if (region.isEmpty()) this->regionsize[0] = this->regionsize[1] = 0;
+
+  const int numpixels = this->regionsize[0] * this->regionsize[1];
+  if (numpixels > this->capacity) {
+    delete[] this->depth;
+    delete[] this->ids;
+    this->depth = new float[numpixels];
+    this->ids = new uint32_t[numpixels];
+    this->capacity = numpixels;
+  }
+  for (int i = 0; i < numpixels; i++) {
+    this->depth[i] = FLT_MAX;
+    this->ids[i] = 0;
+  }
+}
+
+SbVec2f
+SbIdDepthBuffer::toWindow(const SbVec4f & c, float & z) const
+{
+  const float w = c[3];
+  z = c[2] / w;
+  return SbVec2f((c[0] / w + 1.0f) * 0.5f * this->vpsize[0] + this->vporigin[0],
+                 (c[1] / w + 1.0f) * 0.5f * this->vpsize[1] + this->vporigin[1]);
+}
+
+void
+SbIdDepthBuffer::addTriangle(const SbVec4f & c0, const SbVec4f & c1,
+                             const SbVec4f & c2, const uint32_t id,
+                             const CullMode cull)
+{
+  if (this->regionsize[0] == 0 || this->regionsize[1] == 0) return;
+
+  // clip against the near and the far plane, which gives a convex
+  // polygon with at most five vertices
+  SbVec4f tri[3] = { c0, c1, c2 };
+  SbVec4f tmp[4];
+  SbVec4f poly[5];
+  int n = clip_polygon(tri, 3, tmp, 1.0f);
+  if (n < 3) return;
+  n = clip_polygon(tmp, n, poly, -1.0f);
+  if (n < 3) return;
+
+  SbVec2f p[5];
+  float z[5];
+  double area = 0.0;
+  for (int i = 0; i < n; i++) {
+    // points exactly in the eye plane can only be both on the near
+    // and the far plane for a degenerate projection
+    if (poly[i][3] <= 0.0f) return;
+    p[i] = this->toWindow(poly[i], z[i]);
+  }
+  for (int i = 0; i < n; i++) {
+    const SbVec2f & a = p[i];
+    const SbVec2f & b = p[(i + 1) % n];
+    area += double(a[0]) * double(b[1]) - double(b[0]) * double(a[1]);
+  }
+  if (area == 0.0) return;
+  if (cull == CULL_CLOCKWISE && area < 0.0) return;
+  if (cull == CULL_COUNTERCLOCKWISE && area > 0.0) return;
+
+  for (int i = 1; i < n - 1; i++) {
+    this->rasterTriangle(p[0], z[0], p[i], z[i], p[i + 1], z[i + 1], id);
+  }
+}
+
+void
+SbIdDepthBuffer::rasterTriangle(const SbVec2f & p0, const float z0,
+                                const SbVec2f & p1, const float z1,
+                                const SbVec2f & p2, const float z2,
+                                const uint32_t id)
+{
+  // pixel centers covered by the triangle bounding box, clipped
+  // against the region
+  const float minx = SbMin(SbMin(p0[0], p1[0]), p2[0]);
+  const float maxx = SbMax(SbMax(p0[0], p1[0]), p2[0]);
+  const float miny = SbMin(SbMin(p0[1], p1[1]), p2[1]);
+  const float maxy = SbMax(SbMax(p0[1], p1[1]), p2[1]);
+
+  const int rx0 = this->regionorigin[0];
+  const int ry0 = this->regionorigin[1];
+  const int rx1 = rx0 + this->regionsize[0] - 1;
+  const int ry1 = ry0 + this->regionsize[1] - 1;
+
+  if (maxx < float(rx0) || minx > float(rx1 + 1) ||
+      maxy < float(ry0) || miny > float(ry1 + 1)) return;
+
+  const int x0 = SbMax((int) ceil(minx - 0.5f), rx0);
+  const int x1 = SbMin((int) floor(maxx - 0.5f), rx1);
+  const int y0 = SbMax((int) ceil(miny - 0.5f), ry0);
+  const int y1 = SbMin((int) floor(maxy - 0.5f), ry1);
+  if (x0 > x1 || y0 > y1) return;
+
+  // edge functions, oriented so that the inside is positive
+  double area =
+    (double(p1[0]) - p0[0]) * (double(p2[1]) - p0[1]) -
+    (double(p1[1]) - p0[1]) * (double(p2[0]) - p0[0]);
+  if (area == 0.0) return;
+  const double sign = area > 0.0 ? 1.0 : -1.0;
+  area *= sign;
+
+  const SbVec2f * v[3] = { &p0, &p1, &p2 };
+  double a[3], b[3], c[3];
+  for (int i = 0; i < 3; i++) {
+    // edge opposite to vertex i
+    const SbVec2f & e0 = *v[(i + 1) % 3];
+    const SbVec2f & e1 = *v[(i + 2) % 3];
+    a[i] = sign * (double(e0[1]) - e1[1]);
+    b[i] = sign * (double(e1[0]) - e0[0]);
+    c[i] = sign * (double(e0[0]) * e1[1] - double(e0[1]) * e1[0]);
+  }
+
+  for (int y = y0; y <= y1; y++) {
+    const double py = y + 0.5;
+    const double px = x0 + 0.5;
+    double w0 = a[0] * px + b[0] * py + c[0];
+    double w1 = a[1] * px + b[1] * py + c[1];
+    double w2 = a[2] * px + b[2] * py + c[2];
+    const int rowidx = (y - ry0) * this->regionsize[0] - rx0;
+    for (int x = x0; x <= x1; x++) {
+      if (w0 >= 0.0 && w1 >= 0.0 && w2 >= 0.0) {
+        const float z = float((w0 * z0 + w1 * z1 + w2 * z2) / area);
+        const int idx = rowidx + x;
+        if (z <= this->depth[idx]) {
+          this->depth[idx] = z;
+          this->ids[idx] = id;
+        }
+      }
+      w0 += a[0];
+      w1 += a[1];
+      w2 += a[2];
+    }
+  }
+}
+
+void
+SbIdDepthBuffer::addLine(const SbVec4f & c0, const SbVec4f & c1,
+                         const uint32_t id)
+{
+  if (this->regionsize[0] == 0 || this->regionsize[1] == 0) return;
+
+  SbVec4f a = c0, b = c1;
+  if (!clip_segment(a, b, 1.0f) || !clip_segment(a, b, -1.0f)) return;
+  if (a[3] <= 0.0f || b[3] <= 0.0f) return;
+
+  float za, zb;
+  const SbVec2f pa = this->toWindow(a, za);
+  const SbVec2f pb = this->toWindow(b, zb);
+
+  // simple DDA, one sample per pixel along the major axis
+  const float dx = pb[0] - pa[0];
+  const float dy = pb[1] - pa[1];
+  const int steps = SbMax((int) ceil(SbMax(fabs(dx), fabs(dy))), 1);
+  for (int i = 0; i <= steps; i++) {
+    const float t = float(i) / float(steps);
+    const int x = (int) floor(pa[0] + dx * t) - this->regionorigin[0];
+    const int y = (int) floor(pa[1] + dy * t) - this->regionorigin[1];
+    if (x < 0 || y < 0 || x >= this->regionsize[0] || y >= this->regionsize[1]) continue;
+    const float z = za + (zb - za) * t;
+    const int idx = y * this->regionsize[0] + x;
+    if (z <= this->depth[idx]) {
+      this->depth[idx] = z;
+      this->ids[idx] = id;
+    }
+  }
+}
+
+void
+SbIdDepthBuffer::addPoint(const SbVec4f & c, const float size,
+                          const uint32_t id)
+{
+  if (this->regionsize[0] == 0 || this->regionsize[1] == 0) return;
+  if (c[3] <= 0.0f || c[2] < -c[3] || c[2] > c[3]) return;
+
+  float z;
+  const SbVec2f p = this->toWindow(c, z);
+  const float half = SbMax(size, 1.0f) * 0.5f;
+
+  const int x0 = SbMax((int) ceil(p[0] - half - 0.5f), this->regionorigin[0]);
+  const int x1 = SbMin((int) ceil(p[0] + half - 0.5f) - 1,
+                       this->regionorigin[0] + this->regionsize[0] - 1);
+  const int y0 = SbMax((int) ceil(p[1] - half - 0.5f), this->regionorigin[1]);
+  const int y1 = SbMin((int) ceil(p[1] + half - 0.5f) - 1,
+                       this->regionorigin[1] + this->regionsize[1] - 1);
+
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) {
+      const int idx =
+        (y - this->regionorigin[1]) * this->regionsize[0] + (x - this->regionorigin[0]);
+      if (z <= this->depth[idx]) {
+        this->depth[idx] = z;
+        this->ids[idx] = id;
+      }
+    }
+  }
+}
+
+// Returns the id stored for the window space pixel (x, y), or 0 if
+// the pixel is empty or outside the region.
+uint32_t
+SbIdDepthBuffer::getId(const int x, const int y) const
+{
+  const int rx = x - this->regionorigin[0];
+  const int ry = y - this->regionorigin[1];
+  if (rx < 0 || ry < 0 || rx >= this->regionsize[0] || ry >= this->regionsize[1]) {
+    return 0;
+  }
+  return this->ids[ry * this->regionsize[0] + rx];
+}
+
+// Sets the bit for each id visible in a pixel whose center is inside
+// the lasso. 'bits' must hold at least numids bits, and must be
+// cleared by the caller. Returns the number of visible ids.
+int
+SbIdDepthBuffer::markVisible(const SbLassoGrid & lasso, unsigned char * bits,
+                             const uint32_t numids) const
+{
+  int numvisible = 0;
+  for (int y = 0; y < this->regionsize[1]; y++) {
+    const uint32_t * row = this->ids + y * this->regionsize[0];
+    const float py = float(this->regionorigin[1] + y) + 0.5f;
+    for (int x = 0; x < this->regionsize[0]; x++) {
+      const uint32_t id = row[x];
+      if (id == 0 || id >= numids) continue;
+      const unsigned char flag = (unsigned char) (1 << (id & 0x7));
+      if (bits[id >> 3] & flag) continue;
+      if (!lasso.isInside(SbVec2f(float(this->regionorigin[0] + x) + 0.5f, py))) continue;
+      bits[id >> 3] |= flag;
+      numvisible++;
+    }
+  }
+  return numvisible;
+}
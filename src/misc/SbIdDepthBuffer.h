@@ -0,0 +1,117 @@
+#ifndef COIN_SBIDDEPTHBUFFER_H
+#define COIN_SBIDDEPTHBUFFER_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+// *************************************************************************
+// This class (SbIdDepthBuffer) is internal and must not be exposed in
+// the Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbBox2s.h>
+#include <Inventor/SbVec2f.h>
+#include <Inventor/SbVec2s.h>
+#include <Inventor/SbVec4f.h>
+
+class SbLassoGrid;
+
+// *************************************************************************
+
+// SbIdDepthBuffer is a small software rasterizer which stores an
+// integer id and a depth value per pixel. It is used to find out which
+// primitives are visible inside a screen space region without
+// rendering through OpenGL.
+//
+// Primitives are given in clip coordinates (i.e. multiplied with the
+// model, view and projection matrices, but not divided by w), and are
+// clipped against the near and far planes before they are
+// rasterized. Only the pixels inside the region given to setRegion()
+// are stored, so the cost is proportional to the region size, not the
+// viewport size. Pixels are sampled at their centers, and the depth
+// test is the same as GL_LEQUAL, so primitives drawn later win when
+// depths are equal.
+//
+// Id 0 is reserved for "no primitive".
+
+class SbIdDepthBuffer {
+public:
+  enum CullMode {
+    CULL_NONE,
+    CULL_CLOCKWISE,
+    CULL_COUNTERCLOCKWISE
+  };
+
+  SbIdDepthBuffer(void);
+  ~SbIdDepthBuffer();
+
+  void setRegion(const SbVec2s & vporigin, const SbVec2s & vpsize,
+                 const SbBox2s & region);
+
+  void addTriangle(const SbVec4f & c0, const SbVec4f & c1, const SbVec4f & c2,
+                   const uint32_t id, const CullMode cull = CULL_NONE);
+  void addLine(const SbVec4f & c0, const SbVec4f & c1, const uint32_t id);
+  void addPoint(const SbVec4f & c, const float size, const uint32_t id);
+
+  uint32_t getId(const int x, const int y) const;
+  int markVisible(const SbLassoGrid & lasso, unsigned char * bits,
+                  const uint32_t numids) const;
+
+private:
+  SbVec2f toWindow(const SbVec4f & c, float & depth) const;
+  void rasterTriangle(const SbVec2f & p0, const float z0,
+                      const SbVec2f & p1, const float z1,
+                      const SbVec2f & p2, const float z2,
+                      const uint32_t id);
+
+  SbVec2f vporigin;
+  SbVec2f vpsize;
+  int regionorigin[2];
+  int regionsize[2];
+  int capacity;
+  float * depth;
+  uint32_t * ids;
+
+  // NOT IMPLEMENTED:
+  SbIdDepthBuffer(const SbIdDepthBuffer & rhs);
+  SbIdDepthBuffer & operator = (const SbIdDepthBuffer & rhs);
+};
+
+#endif // !COIN_SBIDDEPTHBUFFER_H
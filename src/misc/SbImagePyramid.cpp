@@ -0,0 +1,680 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "misc/SbImagePyramid.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif // HAVE_SYS_TYPES_H
+
+#if defined(HAVE_UNISTD_H) && defined(HAVE_SYS_STAT_H) && !defined(_WIN32)
+#define SBIMAGEPYRAMID_MMAP
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <Inventor/errors/SoDebugError.h>
+
+#include "misc/SbImageResize.h"
+
+// *************************************************************************
+
+// The file starts with a 32 byte header: the magic bytes below,
+// followed by the width, height, number of components, tile size and
+// number of levels as little endian 32-bit values, and 4 reserved
+// bytes. The tiles follow right after, level by level, row by row.
+
+static const char PYRAMID_MAGIC[8] = { 'C', 'O', 'I', 'N', 'P', 'Y', 'R', '1' };
+static const int PYRAMID_HEADERSIZE = 32;
+
+static void
+pyramid_put32(unsigned char * p, const uint32_t val)
+{
+  p[0] = (unsigned char) (val & 0xff);
+  p[1] = (unsigned char) ((val >> 8) & 0xff);
+  p[2] = (unsigned char) ((val >> 16) & 0xff);
+  p[3] = (unsigned char) ((val >> 24) & 0xff);
+}
+
+static uint32_t
+pyramid_get32(const unsigned char * p)
+{
+  return
+    uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+    (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// positions the file beyond the 2GB limit of fseek() where possible
+static SbBool
+pyramid_seek(FILE * fp, const uint64_t offset)
+{
+#if defined(_MSC_VER)
+  return _fseeki64(fp, (__int64) offset, SEEK_SET) == 0;
+#elif defined(HAVE_UNISTD_H)
+  return fseeko(fp, (off_t) offset, SEEK_SET) == 0;
+#else
+  return fseek(fp, (long) offset, SEEK_SET) == 0;
+#endif
+}
+
+// each level is half the size of the previous one, rounded up
+static SbVec2i32
+pyramid_level_size(const SbVec2i32 & size, const int level)
+{
+  return SbVec2i32(((size[0] - 1) >> level) + 1,
+                   ((size[1] - 1) >> level) + 1);
+}
+
+static SbVec2i32
+pyramid_num_tiles(const SbVec2i32 & size, const int tilesize, const int level)
+{
+  const SbVec2i32 levelsize = pyramid_level_size(size, level);
+  return SbVec2i32((levelsize[0] - 1) / tilesize + 1,
+                   (levelsize[1] - 1) / tilesize + 1);
+}
+
+static int
+pyramid_num_levels(const SbVec2i32 & size, const int tilesize)
+{
+  int levels = 1;
+  for (;;) {
+    const SbVec2i32 tiles = pyramid_num_tiles(size, tilesize, levels - 1);
+    if (tiles[0] == 1 && tiles[1] == 1) return levels;
+    levels++;
+  }
+}
+
+// cuts a strip of rows into a row of tiles, repeating the last row
+// and column of the strip to fill the tiles
+static void
+pyramid_cut_tiles(const unsigned char * src, const int width, const int height,
+                  const int nc, const int tilesize, const int numtiles,
+                  unsigned char * dst)
+{
+  const size_t srcrow = size_t(width) * nc;
+  for (int tx = 0; tx < numtiles; tx++) {
+    const int x0 = tx * tilesize;
+    const int n = SbMin(tilesize, width - x0);
+    for (int y = 0; y < tilesize; y++) {
+      const unsigned char * s = src + SbMin(y, height - 1) * srcrow + size_t(x0) * nc;
+      memcpy(dst, s, n * nc);
+      for (int x = n; x < tilesize; x++) {
+        memcpy(dst + x * nc, dst + (n - 1) * nc, nc);
+      }
+      dst += tilesize * nc;
+    }
+  }
+}
+
+// *************************************************************************
+
+/*!
+  Writes a pyramid file for an image of \a size pixels with \a nc
+  components per pixel, split into tiles of \a tilesize x \a tilesize
+  pixels. The image rows are fetched through \a cb, one strip of tile
+  rows at a time. Returns FALSE if the file could not be written or if
+  \a cb failed, in which case no file is left behind.
+*/
+SbBool
+SbImagePyramid::create(const char * filename, const SbVec2i32 & size,
+                       const int nc, const int tilesize,
+                       ReadRowsCB * cb, void * closure)
+{
+  assert(nc >= 1 && nc <= 4);
+  if (size[0] < 1 || size[1] < 1 || tilesize < 1) return FALSE;
+
+  FILE * fp = fopen(filename, "w+b");
+  if (fp == NULL) {
+    SoDebugError::postWarning("SbImagePyramid::create",
+                              "Could not open '%s' for writing.", filename);
+    return FALSE;
+  }
+
+  const int numlevels = pyramid_num_levels(size, tilesize);
+  const size_t tilebytes = size_t(tilesize) * tilesize * nc;
+
+  unsigned char header[PYRAMID_HEADERSIZE];
+  memset(header, 0, PYRAMID_HEADERSIZE);
+  memcpy(header, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC));
+  pyramid_put32(header + 8, size[0]);
+  pyramid_put32(header + 12, size[1]);
+  pyramid_put32(header + 16, nc);
+  pyramid_put32(header + 20, tilesize);
+  pyramid_put32(header + 24, numlevels);
+  SbBool ok = fwrite(header, 1, PYRAMID_HEADERSIZE, fp) == PYRAMID_HEADERSIZE;
+
+  // the full resolution level, one strip of tile rows at a time
+  SbVec2i32 numtiles = pyramid_num_tiles(size, tilesize, 0);
+  std::vector<unsigned char> strip(size_t(size[0]) * tilesize * nc);
+  std::vector<unsigned char> tiles(numtiles[0] * tilebytes);
+  for (int ty = 0; ok && ty < numtiles[1]; ty++) {
+    const int y0 = ty * tilesize;
+    const int numrows = SbMin(tilesize, size[1] - y0);
+    ok = cb(closure, y0, numrows, &strip[0]);
+    if (ok) {
+      pyramid_cut_tiles(&strip[0], size[0], numrows, nc, tilesize,
+                        numtiles[0], &tiles[0]);
+      ok = fwrite(&tiles[0], 1, tiles.size(), fp) == tiles.size();
+    }
+  }
+
+  // the other levels are made by halving two and two tile rows of
+  // the previous level, read back from the file
+  uint64_t readoffset = PYRAMID_HEADERSIZE;
+  uint64_t writeoffset = PYRAMID_HEADERSIZE + uint64_t(numtiles[0]) * numtiles[1] * tilebytes;
+  for (int level = 1; ok && level < numlevels; level++) {
+    const SbVec2i32 prevsize = pyramid_level_size(size, level - 1);
+    const SbVec2i32 prevtiles = numtiles;
+    numtiles = pyramid_num_tiles(size, tilesize, level);
+
+    const int srcw = 2 * numtiles[0] * tilesize;
+    const int srch = 2 * tilesize;
+    const size_t prevrowbytes = prevtiles[0] * tilebytes;
+    std::vector<unsigned char> prevrows(2 * prevrowbytes);
+    std::vector<unsigned char> src(size_t(srcw) * srch * nc);
+    std::vector<unsigned char> half(size_t(srcw / 2) * tilesize * nc);
+    tiles.resize(numtiles[0] * tilebytes);
+
+    for (int ty = 0; ok && ty < numtiles[1]; ty++) {
+      const int numprevrows = SbMin(2, prevtiles[1] - 2 * ty);
+      ok = pyramid_seek(fp, readoffset + 2 * ty * uint64_t(prevrowbytes)) &&
+        fread(&prevrows[0], 1, numprevrows * prevrowbytes, fp) == numprevrows * prevrowbytes;
+      if (!ok) break;
+
+      // untile the rows, repeating the last row and column of the
+      // previous level
+      const int validw = SbMin(prevsize[0], srcw);
+      for (int y = 0; y < srch; y++) {
+        const int py = SbMin(2 * ty * tilesize + y, prevsize[1] - 1) - 2 * ty * tilesize;
+        const unsigned char * tilerow =
+          &prevrows[0] + (py / tilesize) * prevrowbytes + (py % tilesize) * tilesize * nc;
+        unsigned char * dst = &src[0] + size_t(y) * srcw * nc;
+        for (int tx = 0; tx * tilesize < validw; tx++) {
+          const int n = SbMin(tilesize, validw - tx * tilesize);
+          memcpy(dst + tx * tilesize * nc, tilerow + tx * tilebytes, n * nc);
+        }
+        for (int x = validw; x < srcw; x++) {
+          memcpy(dst + x * nc, dst + (validw - 1) * nc, nc);
+        }
+      }
+
+      SbImageResize::halve(&src[0], srcw, srch, 1, nc, &half[0]);
+      pyramid_cut_tiles(&half[0], srcw / 2, tilesize, nc, tilesize,
+                        numtiles[0], &tiles[0]);
+      ok = pyramid_seek(fp, writeoffset + ty * uint64_t(tiles.size())) &&
+        fwrite(&tiles[0], 1, tiles.size(), fp) == tiles.size();
+    }
+    readoffset = writeoffset;
+    writeoffset += uint64_t(numtiles[0]) * numtiles[1] * tilebytes;
+  }
+
+  if (fclose(fp) != 0) ok = FALSE;
+  if (!ok) {
+    SoDebugError::postWarning("SbImagePyramid::create",
+                              "Could not create '%s'.", filename);
+    remove(filename);
+  }
+  return ok;
+}
+
+// ReadRowsCB for images in memory
+static SbBool
+pyramid_memory_rows(void * closure, const int y, const int numrows,
+                    unsigned char * rows)
+{
+  const void * const * data = (const void * const *) closure;
+  const unsigned char * bytes = (const unsigned char *) data[0];
+  const size_t rowbytes = *((const size_t *) data[1]);
+  memcpy(rows, bytes + y * rowbytes, numrows * rowbytes);
+  return TRUE;
+}
+
+/*!
+  \overload
+
+  Writes a pyramid file for an image which is already in memory.
+*/
+SbBool
+SbImagePyramid::create(const char * filename, const unsigned char * bytes,
+                       const SbVec2i32 & size, const int nc,
+                       const int tilesize)
+{
+  const size_t rowbytes = size_t(size[0]) * nc;
+  const void * data[2] = { bytes, &rowbytes };
+  return SbImagePyramid::create(filename, size, nc, tilesize,
+                                pyramid_memory_rows, (void *) data);
+}
+
+/*!
+  Returns TRUE if \a filename is a pyramid file.
+*/
+SbBool
+SbImagePyramid::isPyramidFile(const char * filename)
+{
+  FILE * fp = fopen(filename, "rb");
+  if (fp == NULL) return FALSE;
+  char magic[sizeof(PYRAMID_MAGIC)];
+  const SbBool ok =
+    fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+    memcmp(magic, PYRAMID_MAGIC, sizeof(magic)) == 0;
+  fclose(fp);
+  return ok;
+}
+
+// *************************************************************************
+
+SbImagePyramid::SbImagePyramid(void)
+  : size(0, 0), nc(0), tilesize(0), numlevels(0), leveloffset(NULL),
+    fp(NULL), mapping(NULL), mappingsize(0)
+{
+}
+
+SbImagePyramid::~SbImagePyramid()
+{
+  this->close();
+}
+
+/*!
+  Opens a pyramid file written by create(). The file is memory mapped
+  if \a usemapping is TRUE and the platform supports it. Returns FALSE
+  if the file could not be opened or is not a valid pyramid file.
+*/
+SbBool
+SbImagePyramid::open(const char * filename, const SbBool usemapping)
+{
+  this->close();
+
+  FILE * f = fopen(filename, "rb");
+  if (f == NULL) return FALSE;
+
+  unsigned char header[PYRAMID_HEADERSIZE];
+  if (fread(header, 1, PYRAMID_HEADERSIZE, f) != PYRAMID_HEADERSIZE ||
+      memcmp(header, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC)) != 0) {
+    fclose(f);
+    return FALSE;
+  }
+
+  const SbVec2i32 filesize((int32_t) pyramid_get32(header + 8),
+                           (int32_t) pyramid_get32(header + 12));
+  const int filenc = (int) pyramid_get32(header + 16);
+  const int filetilesize = (int) pyramid_get32(header + 20);
+  const int filelevels = (int) pyramid_get32(header + 24);
+  if (filesize[0] < 1 || filesize[1] < 1 || filenc < 1 || filenc > 4 ||
+      filetilesize < 1 || filelevels != pyramid_num_levels(filesize, filetilesize)) {
+    SoDebugError::postWarning("SbImagePyramid::open",
+                              "'%s' has an invalid header.", filename);
+    fclose(f);
+    return FALSE;
+  }
+
+  this->size = filesize;
+  this->nc = filenc;
+  this->tilesize = filetilesize;
+  this->numlevels = filelevels;
+  this->leveloffset = new uint64_t[filelevels + 1];
+  const uint64_t tilebytes = uint64_t(filetilesize) * filetilesize * filenc;
+  this->leveloffset[0] = PYRAMID_HEADERSIZE;
+  for (int i = 0; i < filelevels; i++) {
+    const SbVec2i32 tiles = pyramid_num_tiles(filesize, filetilesize, i);
+    this->leveloffset[i + 1] = this->leveloffset[i] + tilebytes * tiles[0] * tiles[1];
+  }
+  const uint64_t totalsize = this->leveloffset[filelevels];
+
+  // a truncated file is an error, whether it is mapped or not
+  unsigned char last;
+  if (!pyramid_seek(f, totalsize - 1) || fread(&last, 1, 1, f) != 1) {
+    SoDebugError::postWarning("SbImagePyramid::open",
+                              "'%s' is truncated.", filename);
+    fclose(f);
+    this->close();
+    return FALSE;
+  }
+
+#ifdef SBIMAGEPYRAMID_MMAP
+  if (usemapping && totalsize <= uint64_t(size_t(-1))) {
+    void * p = mmap(NULL, (size_t) totalsize, PROT_READ, MAP_SHARED, fileno(f), 0);
+    if (p != MAP_FAILED) {
+      this->mapping = (const unsigned char *) p;
+      this->mappingsize = totalsize;
+      // the mapping stays valid after the file is closed
+      fclose(f);
+      return TRUE;
+    }
+  }
+#endif // SBIMAGEPYRAMID_MMAP
+
+  this->fp = f;
+  return TRUE;
+}
+
+void
+SbImagePyramid::close(void)
+{
+#ifdef SBIMAGEPYRAMID_MMAP
+  if (this->mapping) {
+    munmap((void *) this->mapping, (size_t) this->mappingsize);
+  }
+#endif // SBIMAGEPYRAMID_MMAP
+  if (this->fp) fclose(this->fp);
+  delete[] this->leveloffset;
+  this->mapping = NULL;
+  this->mappingsize = 0;
+  this->fp = NULL;
+  this->leveloffset = NULL;
+  this->size.setValue(0, 0);
+  this->nc = 0;
+  this->tilesize = 0;
+  this->numlevels = 0;
+}
+
+SbBool
+SbImagePyramid::isOpen(void) const
+{
+  return this->mapping != NULL || this->fp != NULL;
+}
+
+SbBool
+SbImagePyramid::isMapped(void) const
+{
+  return this->mapping != NULL;
+}
+
+/*!
+  Returns the size of the full resolution image.
+*/
+const SbVec2i32 &
+SbImagePyramid::getSize(void) const
+{
+  return this->size;
+}
+
+int
+SbImagePyramid::getNumComponents(void) const
+{
+  return this->nc;
+}
+
+int
+SbImagePyramid::getTileSize(void) const
+{
+  return this->tilesize;
+}
+
+int
+SbImagePyramid::getNumLevels(void) const
+{
+  return this->numlevels;
+}
+
+SbVec2i32
+SbImagePyramid::getLevelSize(const int level) const
+{
+  return pyramid_level_size(this->size, level);
+}
+
+SbVec2i32
+SbImagePyramid::getNumTiles(const int level) const
+{
+  return pyramid_num_tiles(this->size, this->tilesize, level);
+}
+
+uint64_t
+SbImagePyramid::getTileOffset(const int level, const int x, const int y) const
+{
+  const SbVec2i32 tiles = this->getNumTiles(level);
+  assert(x >= 0 && x < tiles[0] && y >= 0 && y < tiles[1]);
+  const uint64_t tilebytes = uint64_t(this->tilesize) * this->tilesize * this->nc;
+  return this->leveloffset[level] + (uint64_t(y) * tiles[0] + x) * tilebytes;
+}
+
+/*!
+  Returns the pixels of tile (\a x, \a y) in \a level. For a mapped
+  file this points into the mapping, otherwise the tile is read into
+  \a buffer, which must hold tilesize * tilesize * numcomponents
+  bytes. Returns NULL if the tile could not be read.
+*/
+const unsigned char *
+SbImagePyramid::getTile(const int level, const int x, const int y,
+                        unsigned char * buffer) const
+{
+  assert(level >= 0 && level < this->numlevels);
+  const uint64_t offset = this->getTileOffset(level, x, y);
+  if (this->mapping) return this->mapping + offset;
+
+  const size_t tilebytes = size_t(this->tilesize) * this->tilesize * this->nc;
+#ifdef COIN_THREADSAFE
+  this->mutex.lock();
+#endif // COIN_THREADSAFE
+  const SbBool ok =
+    pyramid_seek(this->fp, offset) &&
+    fread(buffer, 1, tilebytes, this->fp) == tilebytes;
+#ifdef COIN_THREADSAFE
+  this->mutex.unlock();
+#endif // COIN_THREADSAFE
+  return ok ? buffer : NULL;
+}
+
+/*!
+  Copies \a size pixels starting at \a origin in \a level into \a
+  dst. Pixels outside the image get the value of the closest edge
+  pixel. Returns FALSE if a tile could not be read.
+*/
+SbBool
+SbImagePyramid::getRegion(const int level, const SbVec2i32 & origin,
+                          const SbVec2i32 & regionsize, unsigned char * dst) const
+{
+  assert(level >= 0 && level < this->numlevels);
+  const SbVec2i32 levelsize = this->getLevelSize(level);
+  const int ts = this->tilesize;
+  const int pixbytes = this->nc;
+  const size_t dstrow = size_t(regionsize[0]) * pixbytes;
+
+  // the columns to copy, and where they go. Columns outside the image
+  // are filled in afterwards.
+  const int x0 = SbClamp(origin[0], 0, levelsize[0] - 1);
+  const int x1 = SbClamp(origin[0] + regionsize[0] - 1, 0, levelsize[0] - 1);
+  const int dstx = SbClamp(x0 - origin[0], 0, regionsize[0] - 1);
+  const int tx0 = x0 / ts;
+  const int tx1 = x1 / ts;
+
+  const int numtiles = tx1 - tx0 + 1;
+  std::vector<const unsigned char *> rowtiles(numtiles);
+  std::vector<unsigned char> buffers;
+  if (!this->mapping) {
+    buffers.resize(size_t(numtiles) * ts * ts * pixbytes);
+  }
+
+  int currenttilerow = -1;
+  for (int y = 0; y < regionsize[1]; y++) {
+    const int sy = SbClamp(origin[1] + y, 0, levelsize[1] - 1);
+    if (sy / ts != currenttilerow) {
+      currenttilerow = sy / ts;
+      for (int i = 0; i < numtiles; i++) {
+        rowtiles[i] =
+          this->getTile(level, tx0 + i, currenttilerow,
+                        this->mapping ? NULL : &buffers[size_t(i) * ts * ts * pixbytes]);
+        if (rowtiles[i] == NULL) return FALSE;
+      }
+    }
+    unsigned char * d = dst + y * dstrow;
+    unsigned char * dd = d + dstx * pixbytes;
+    const int iy = sy % ts;
+    for (int x = x0; x <= x1; ) {
+      const int tx = x / ts;
+      const int n = SbMin(x1 + 1, (tx + 1) * ts) - x;
+      memcpy(dd, rowtiles[tx - tx0] + (iy * ts + (x - tx * ts)) * pixbytes, n * pixbytes);
+      dd += n * pixbytes;
+      x += n;
+    }
+    const int last = dstx + (x1 - x0);
+    for (int x = 0; x < dstx; x++) {
+      memcpy(d + x * pixbytes, d + dstx * pixbytes, pixbytes);
+    }
+    for (int x = last + 1; x < regionsize[0]; x++) {
+      memcpy(d + x * pixbytes, d + last * pixbytes, pixbytes);
+    }
+  }
+  return TRUE;
+}
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+#ifdef COIN_INT_TEST_SUITE
+
+#include <cstdlib>
+
+#include "coindefs.h"
+
+static unsigned char *
+imgpyramid_test_image(const int w, const int h, const int nc)
+{
+  unsigned char * bytes = new unsigned char[w * h * nc];
+  for (int i = 0; i < w * h * nc; i++) bytes[i] = (unsigned char) (rand() & 0xff);
+  return bytes;
+}
+
+static SbBool
+imgpyramid_failing_rows(void * COIN_UNUSED_ARG(closure), const int y,
+                        const int COIN_UNUSED_ARG(numrows),
+                        unsigned char * COIN_UNUSED_ARG(rows))
+{
+  return y == 0;
+}
+
+BOOST_AUTO_TEST_CASE(pyramidLevels)
+{
+  const char * name = "sbimagepyramid.pyramidtest";
+  const SbVec2i32 size(300, 200);
+  const int nc = 3;
+  srand(7);
+  unsigned char * bytes = imgpyramid_test_image(size[0], size[1], nc);
+  BOOST_REQUIRE(SbImagePyramid::create(name, bytes, size, nc, 64));
+  BOOST_CHECK(SbImagePyramid::isPyramidFile(name));
+
+  // 300x200, 150x100, 75x50 and 38x25, the last one in a single tile
+  SbImagePyramid pyramid;
+  BOOST_REQUIRE(pyramid.open(name));
+  BOOST_CHECK_EQUAL(pyramid.getNumLevels(), 4);
+  BOOST_CHECK(pyramid.getNumTiles(0) == SbVec2i32(5, 4));
+  BOOST_CHECK(pyramid.getLevelSize(3) == SbVec2i32(38, 25));
+
+  // the full resolution level is the source image
+  unsigned char * region = new unsigned char[size[0] * size[1] * nc];
+  BOOST_REQUIRE(pyramid.getRegion(0, SbVec2i32(0, 0), size, region));
+  BOOST_CHECK(memcmp(region, bytes, size[0] * size[1] * nc) == 0);
+
+  // the next level is a 2x2 box filter of it
+  unsigned char pixel[3];
+  BOOST_REQUIRE(pyramid.getRegion(1, SbVec2i32(40, 70), SbVec2i32(1, 1), pixel));
+  int mismatches = 0;
+  for (int c = 0; c < nc; c++) {
+    const unsigned char * p = bytes + (140 * size[0] + 80) * nc + c;
+    const int expected = (p[0] + p[nc] + p[size[0] * nc] + p[(size[0] + 1) * nc] + 2) >> 2;
+    if (pixel[c] != expected) mismatches++;
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+
+  // regions outside the image repeat the edge pixels
+  BOOST_REQUIRE(pyramid.getRegion(0, SbVec2i32(298, -2), SbVec2i32(4, 4), region));
+  const unsigned char * corner = bytes + 299 * nc;
+  mismatches = 0;
+  for (int y = 0; y < 2; y++) {
+    for (int x = 1; x < 4; x++) {
+      if (memcmp(region + (y * 4 + x) * nc, corner, nc) != 0) mismatches++;
+    }
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+
+  delete[] region;
+  delete[] bytes;
+  pyramid.close();
+  remove(name);
+}
+
+BOOST_AUTO_TEST_CASE(pyramidUnmapped)
+{
+  const char * name = "sbimagepyramid.pyramidtest";
+  const SbVec2i32 size(129, 70);
+  const int nc = 2;
+  srand(8);
+  unsigned char * bytes = imgpyramid_test_image(size[0], size[1], nc);
+  BOOST_REQUIRE(SbImagePyramid::create(name, bytes, size, nc, 32));
+
+  // reading tiles from the file gives the same pixels as the mapping
+  SbImagePyramid mapped, unmapped;
+  BOOST_REQUIRE(mapped.open(name, TRUE));
+  BOOST_REQUIRE(unmapped.open(name, FALSE));
+  BOOST_CHECK(!unmapped.isMapped());
+
+  int mismatches = 0;
+  for (int level = 0; level < mapped.getNumLevels(); level++) {
+    const SbVec2i32 levelsize = mapped.getLevelSize(level);
+    const int n = levelsize[0] * levelsize[1] * nc;
+    unsigned char * a = new unsigned char[n];
+    unsigned char * b = new unsigned char[n];
+    BOOST_REQUIRE(mapped.getRegion(level, SbVec2i32(0, 0), levelsize, a));
+    BOOST_REQUIRE(unmapped.getRegion(level, SbVec2i32(0, 0), levelsize, b));
+    if (memcmp(a, b, n) != 0) mismatches++;
+    delete[] a;
+    delete[] b;
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+
+  delete[] bytes;
+  mapped.close();
+  unmapped.close();
+  remove(name);
+}
+
+BOOST_AUTO_TEST_CASE(pyramidReadFailure)
+{
+  // a source which fails part way leaves no file behind
+  const char * name = "sbimagepyramid.pyramidtest";
+  BOOST_CHECK(!SbImagePyramid::create(name, SbVec2i32(64, 64), 1, 16,
+                                      imgpyramid_failing_rows, NULL));
+  BOOST_CHECK(!SbImagePyramid::isPyramidFile(name));
+  SbImagePyramid pyramid;
+  BOOST_CHECK(!pyramid.open(name));
+}
+
+#endif // COIN_INT_TEST_SUITE
+#endif // COIN_TEST_SUITE
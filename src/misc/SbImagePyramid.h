@@ -0,0 +1,133 @@
+#ifndef COIN_SBIMAGEPYRAMID_H
+#define COIN_SBIMAGEPYRAMID_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+// *************************************************************************
+// This class (SbImagePyramid) is internal and must not be exposed in
+// the Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <stdio.h>
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbVec2i32.h>
+#include <Inventor/system/inttypes.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#ifdef COIN_THREADSAFE
+#include <Inventor/threads/SbMutex.h>
+#endif // COIN_THREADSAFE
+
+// *************************************************************************
+
+// SbImagePyramid is a tiled mipmap pyramid of a 2D image, stored in a
+// file on disk. It is used by SoGLBigImage for images which are too
+// large to keep in memory.
+//
+// The file is written once by create(), which streams the source
+// image in strips of rows, so the full image never has to be in
+// memory. Each level is half the size of the one before it (rounded
+// up), down to the first level which fits in a single tile. Every
+// level is split into square tiles of the same size, stored
+// uncompressed one after the other, with the edges of the border
+// tiles repeated to fill them.
+//
+// An opened file is memory mapped when the platform supports it, so
+// reading a tile is just a pointer lookup. Otherwise tiles are read
+// from the file on demand.
+
+class SbImagePyramid {
+public:
+  // Called by create() to get rows [y, y+numrows> of the source
+  // image, in the same row order as SbImage, into the tightly packed
+  // buffer rows.
+  typedef SbBool ReadRowsCB(void * closure, const int y, const int numrows,
+                            unsigned char * rows);
+
+  static SbBool create(const char * filename, const SbVec2i32 & size,
+                       const int nc, const int tilesize,
+                       ReadRowsCB * cb, void * closure);
+  static SbBool create(const char * filename, const unsigned char * bytes,
+                       const SbVec2i32 & size, const int nc,
+                       const int tilesize);
+  static SbBool isPyramidFile(const char * filename);
+
+  SbImagePyramid(void);
+  ~SbImagePyramid();
+
+  SbBool open(const char * filename, const SbBool usemapping = TRUE);
+  void close(void);
+  SbBool isOpen(void) const;
+  SbBool isMapped(void) const;
+
+  const SbVec2i32 & getSize(void) const;
+  int getNumComponents(void) const;
+  int getTileSize(void) const;
+  int getNumLevels(void) const;
+  SbVec2i32 getLevelSize(const int level) const;
+  SbVec2i32 getNumTiles(const int level) const;
+
+  const unsigned char * getTile(const int level, const int x, const int y,
+                                unsigned char * buffer) const;
+  SbBool getRegion(const int level, const SbVec2i32 & origin,
+                   const SbVec2i32 & regionsize, unsigned char * dst) const;
+
+private:
+  uint64_t getTileOffset(const int level, const int x, const int y) const;
+
+  SbVec2i32 size;
+  int nc;
+  int tilesize;
+  int numlevels;
+  uint64_t * leveloffset;
+
+  FILE * fp;
+  const unsigned char * mapping;
+  uint64_t mappingsize;
+#ifdef COIN_THREADSAFE
+  mutable SbMutex mutex;
+#endif // COIN_THREADSAFE
+};
+
+#endif // !COIN_SBIMAGEPYRAMID_H
@@ -0,0 +1,682 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "misc/SbImageResize.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <Inventor/C/threads/wsched.h>
+#include <Inventor/system/inttypes.h>
+
+#include "threads/wschedp.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SBIMAGERESIZE_SSE2
+#include <emmintrin.h>
+#endif
+
+// *************************************************************************
+
+// Destination images smaller than this are processed in the calling
+// thread, as splitting them up costs more than it saves.
+static const int MIN_PARALLEL_BYTES = 64 * 1024;
+
+// The number of destination bytes to aim for in each parallel task.
+static const int TASK_BYTES = 16 * 1024;
+
+static void
+run_rows(cc_wsched * sched, const int numrows, const int rowbytes,
+         cc_wsched_range_f * func, void * closure)
+{
+  if (double(numrows) * double(rowbytes) < MIN_PARALLEL_BYTES) {
+    func(closure, 0, numrows);
+    return;
+  }
+  if (sched == NULL) { sched = cc_wsched_global_instance(); }
+  const int grainsize = SbMax(1, TASK_BYTES / SbMax(rowbytes, 1));
+  cc_wsched_parallel_for(sched, 0, numrows, grainsize, func, closure);
+}
+
+// *************************************************************************
+
+struct halve_data {
+  const unsigned char * src;
+  unsigned char * dst;
+  int width, height, depth, nc;
+  int newwidth, newheight;
+  int round, shift;
+};
+
+// Add up 1, 2 or 4 rows of bytes into 16-bit sums.
+static void
+sum_rows(const unsigned char * const * rows, const int numrows,
+         const int len, uint16_t * sum)
+{
+  int i = 0;
+#ifdef SBIMAGERESIZE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= len; i += 16) {
+    __m128i lo = zero;
+    __m128i hi = zero;
+    for (int j = 0; j < numrows; j++) {
+      const __m128i v = _mm_loadu_si128((const __m128i *) (rows[j] + i));
+      lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+      hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+    }
+    _mm_storeu_si128((__m128i *) (sum + i), lo);
+    _mm_storeu_si128((__m128i *) (sum + i + 8), hi);
+  }
+#endif // SBIMAGERESIZE_SSE2
+  for (; i < len; i++) {
+    unsigned int s = 0;
+    for (int j = 0; j < numrows; j++) s += rows[j][i];
+    sum[i] = (uint16_t) s;
+  }
+}
+
+// Add up horizontally neighbouring pixels of a row of sums, and
+// round and scale the result down to bytes.
+static void
+sum_pairs(const uint16_t * sum, const int nc, const int numpixels,
+          const int round, const int shift, unsigned char * out)
+{
+  const int len = numpixels * nc;
+  int i = 0;
+#ifdef SBIMAGERESIZE_SSE2
+  // 16 sums in, 8 bytes out. The pixels are 16, 32 or 64 bits wide
+  // after widening, so pairs of neighbours can be lined up with
+  // shifts and shuffles.
+  if (nc != 3) {
+    const __m128i r = _mm_set1_epi16((short) round);
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    for (; i + 8 <= len; i += 8) {
+      const __m128i a = _mm_loadu_si128((const __m128i *) (sum + 2 * i));
+      const __m128i b = _mm_loadu_si128((const __m128i *) (sum + 2 * i + 8));
+      __m128i t;
+      if (nc == 1) {
+        const __m128i sa = _mm_add_epi32(_mm_srli_epi32(_mm_slli_epi32(a, 16), 16),
+                                         _mm_srli_epi32(a, 16));
+        const __m128i sb = _mm_add_epi32(_mm_srli_epi32(_mm_slli_epi32(b, 16), 16),
+                                         _mm_srli_epi32(b, 16));
+        t = _mm_packs_epi32(sa, sb);
+      }
+      else if (nc == 2) {
+        const __m128i sa = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i sb = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+        t = _mm_add_epi16(_mm_unpacklo_epi64(sa, sb), _mm_unpackhi_epi64(sa, sb));
+      }
+      else {
+        t = _mm_add_epi16(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+      }
+      t = _mm_srl_epi16(_mm_add_epi16(t, r), s);
+      _mm_storel_epi64((__m128i *) (out + i), _mm_packus_epi16(t, t));
+    }
+  }
+#endif // SBIMAGERESIZE_SSE2
+  for (int p = i / nc; p < numpixels; p++) {
+    const uint16_t * s0 = sum + 2 * p * nc;
+    for (int c = 0; c < nc; c++) {
+      out[p * nc + c] = (unsigned char) ((s0[c] + s0[nc + c] + round) >> shift);
+    }
+  }
+}
+
+static void
+halve_rows(void * closure, int begin, int end)
+{
+  const halve_data * d = (const halve_data *) closure;
+  const int nc = d->nc;
+  const int srcrow = d->width * nc;
+  const int dstrow = d->newwidth * nc;
+  const int sumlen = (d->width > 1 ? 2 * d->newwidth : 1) * nc;
+  const int ny = d->height > 1 ? 2 : 1;
+  const int nz = d->depth > 1 ? 2 : 1;
+  uint16_t * sum = new uint16_t[sumlen];
+
+  for (int r = begin; r < end; r++) {
+    const int y = (r % d->newheight) * ny;
+    const int z = (r / d->newheight) * nz;
+    const unsigned char * rows[4];
+    int numrows = 0;
+    for (int k = 0; k < nz; k++) {
+      for (int j = 0; j < ny; j++) {
+        rows[numrows++] = d->src + (size_t(z + k) * d->height + (y + j)) * srcrow;
+      }
+    }
+    sum_rows(rows, numrows, sumlen, sum);
+
+    unsigned char * out = d->dst + size_t(r) * dstrow;
+    if (d->width > 1) {
+      sum_pairs(sum, nc, d->newwidth, d->round, d->shift, out);
+    }
+    else {
+      for (int i = 0; i < sumlen; i++) {
+        out[i] = (unsigned char) ((sum[i] + d->round) >> d->shift);
+      }
+    }
+  }
+  delete[] sum;
+}
+
+/*!
+  Creates the next mipmap level of an image by averaging each 2x2 (or
+  2x2x2 for 3D images) block of pixels. Dimensions of size 1 are left
+  as is, so a 1D image is halved along its single dimension. Odd
+  sizes are rounded down, leaving out the last row or column.
+
+  \a dst must have room for the halved image.
+*/
+void
+SbImageResize::halve(const unsigned char * src,
+                     const int width, const int height, const int depth,
+                     const int nc, unsigned char * dst, cc_wsched * sched)
+{
+  assert(nc >= 1 && nc <= 4);
+  assert(width > 1 || height > 1 || depth > 1);
+
+  halve_data d;
+  d.src = src;
+  d.dst = dst;
+  d.width = width;
+  d.height = height;
+  d.depth = depth;
+  d.nc = nc;
+  d.newwidth = SbMax(width >> 1, 1);
+  d.newheight = SbMax(height >> 1, 1);
+  const int newdepth = SbMax(depth >> 1, 1);
+
+  // box filter over 2^k pixels, where k is the number of halved
+  // dimensions. Averages of two pixels are truncated, larger averages
+  // are rounded.
+  const int k = (width > 1 ? 1 : 0) + (height > 1 ? 1 : 0) + (depth > 1 ? 1 : 0);
+  d.shift = k;
+  d.round = k > 1 ? 1 << (k - 1) : 0;
+
+  run_rows(sched, d.newheight * newdepth, d.newwidth * nc, halve_rows, &d);
+}
+
+// *************************************************************************
+
+struct nearest_data {
+  const unsigned char * src;
+  unsigned char * dst;
+  int nc;
+  int newwidth, newheight;
+  size_t srcrow, srcimage;
+  const int * xoffset;
+  const int * yoffset;
+  const int * zoffset;
+};
+
+static void
+nearest_rows(void * closure, int begin, int end)
+{
+  const nearest_data * d = (const nearest_data *) closure;
+  const int nc = d->nc;
+  const int dstrow = d->newwidth * nc;
+
+  for (int r = begin; r < end; r++) {
+    const unsigned char * row = d->src +
+      d->zoffset[r / d->newheight] * d->srcimage +
+      d->yoffset[r % d->newheight] * d->srcrow;
+    unsigned char * out = d->dst + size_t(r) * dstrow;
+    for (int x = 0; x < d->newwidth; x++) {
+      const unsigned char * p = row + d->xoffset[x];
+      for (int c = 0; c < nc; c++) out[c] = p[c];
+      out += nc;
+    }
+  }
+}
+
+// Source pixel index for each destination pixel along one axis. The
+// positions are accumulated in single precision, exactly like the
+// original scalar resize loops did, so the result is unchanged.
+static void
+nearest_offsets(const int size, const int newsize, const int stride,
+                std::vector<int> & offsets)
+{
+  const float delta = float(size) / float(newsize);
+  float pos = 0.0f;
+  offsets.resize(newsize);
+  for (int i = 0; i < newsize; i++) {
+    offsets[i] = int(pos) * stride;
+    pos += delta;
+  }
+}
+
+/*!
+  Low quality resize, picking the nearest source pixel for each
+  destination pixel.
+*/
+void
+SbImageResize::resizeNearest(const unsigned char * src,
+                             const int width, const int height, const int depth,
+                             const int nc, unsigned char * dst,
+                             const int newwidth, const int newheight,
+                             const int newdepth, cc_wsched * sched)
+{
+  assert(nc >= 1 && nc <= 4);
+  std::vector<int> xoffset, yoffset, zoffset;
+  nearest_offsets(width, newwidth, nc, xoffset);
+  nearest_offsets(height, newheight, 1, yoffset);
+  nearest_offsets(depth, newdepth, 1, zoffset);
+
+  nearest_data d;
+  d.src = src;
+  d.dst = dst;
+  d.nc = nc;
+  d.newwidth = newwidth;
+  d.newheight = newheight;
+  d.srcrow = size_t(width) * nc;
+  d.srcimage = d.srcrow * height;
+  d.xoffset = &xoffset[0];
+  d.yoffset = &yoffset[0];
+  d.zoffset = &zoffset[0];
+
+  run_rows(sched, newheight * newdepth, newwidth * nc, nearest_rows, &d);
+}
+
+// *************************************************************************
+
+// The source pixels contributing to one destination pixel along one
+// axis, as an index range with weights summing to one.
+struct filter_tap {
+  int first;
+  int count;
+  int weights;
+};
+
+struct filter_axis {
+  std::vector<filter_tap> taps;
+  std::vector<float> weights;
+};
+
+// Box filter when shrinking, so every source pixel contributes with
+// its coverage of the destination pixel, and linear interpolation
+// between pixel centers when enlarging.
+static void
+filter_weights(const int size, const int newsize, filter_axis & axis)
+{
+  axis.taps.resize(newsize);
+  axis.weights.clear();
+  const double scale = double(size) / double(newsize);
+
+  for (int i = 0; i < newsize; i++) {
+    filter_tap & tap = axis.taps[i];
+    tap.weights = int(axis.weights.size());
+    if (newsize < size) {
+      const double lo = i * scale;
+      const double hi = (i + 1) * scale;
+      tap.first = int(floor(lo));
+      const int last = SbMin(int(ceil(hi)) - 1, size - 1);
+      tap.count = last - tap.first + 1;
+      for (int j = tap.first; j <= last; j++) {
+        const double cover = SbMin(hi, double(j + 1)) - SbMax(lo, double(j));
+        axis.weights.push_back(float(cover / scale));
+      }
+    }
+    else {
+      const double u = SbMax((i + 0.5) * scale - 0.5, 0.0);
+      tap.first = SbMin(int(floor(u)), size - 1);
+      const float f = float(u - tap.first);
+      if (tap.first + 1 < size && f > 0.0f) {
+        tap.count = 2;
+        axis.weights.push_back(1.0f - f);
+        axis.weights.push_back(f);
+      }
+      else {
+        tap.count = 1;
+        axis.weights.push_back(1.0f);
+      }
+    }
+  }
+}
+
+struct filter_data {
+  const unsigned char * src;
+  unsigned char * dst;
+  int nc;
+  int newwidth, newheight;
+  size_t srcrow, srcimage;
+  const filter_axis * axis[3];
+};
+
+static void
+filter_rows(void * closure, int begin, int end)
+{
+  const filter_data * d = (const filter_data *) closure;
+  const int nc = d->nc;
+  const int dstrow = d->newwidth * nc;
+  const filter_axis & xaxis = *d->axis[0];
+  const filter_axis & yaxis = *d->axis[1];
+  const filter_axis & zaxis = *d->axis[2];
+  float * accum = new float[dstrow];
+
+  for (int r = begin; r < end; r++) {
+    const filter_tap & ytap = yaxis.taps[r % d->newheight];
+    const filter_tap & ztap = zaxis.taps[r / d->newheight];
+    for (int i = 0; i < dstrow; i++) accum[i] = 0.0f;
+
+    for (int k = 0; k < ztap.count; k++) {
+      for (int j = 0; j < ytap.count; j++) {
+        const float w = zaxis.weights[ztap.weights + k] * yaxis.weights[ytap.weights + j];
+        const unsigned char * row = d->src +
+          (ztap.first + k) * d->srcimage + (ytap.first + j) * d->srcrow;
+        float * acc = accum;
+        for (int x = 0; x < d->newwidth; x++) {
+          const filter_tap & xtap = xaxis.taps[x];
+          const float * xw = &xaxis.weights[xtap.weights];
+          const unsigned char * p = row + xtap.first * nc;
+          for (int c = 0; c < nc; c++) {
+            float v = 0.0f;
+            for (int i = 0; i < xtap.count; i++) v += xw[i] * p[i * nc + c];
+            acc[c] += w * v;
+          }
+          acc += nc;
+        }
+      }
+    }
+
+    unsigned char * out = d->dst + size_t(r) * dstrow;
+    for (int i = 0; i < dstrow; i++) {
+      out[i] = (unsigned char) SbClamp(accum[i] + 0.5f, 0.0f, 255.0f);
+    }
+  }
+  delete[] accum;
+}
+
+/*!
+  High quality resize. Each axis is box filtered when shrinking and
+  linearly interpolated when enlarging.
+*/
+void
+SbImageResize::resizeFiltered(const unsigned char * src,
+                              const int width, const int height, const int depth,
+                              const int nc, unsigned char * dst,
+                              const int newwidth, const int newheight,
+                              const int newdepth, cc_wsched * sched)
+{
+  assert(nc >= 1 && nc <= 4);
+  filter_axis axis[3];
+  filter_weights(width, newwidth, axis[0]);
+  filter_weights(height, newheight, axis[1]);
+  filter_weights(depth, newdepth, axis[2]);
+
+  filter_data d;
+  d.src = src;
+  d.dst = dst;
+  d.nc = nc;
+  d.newwidth = newwidth;
+  d.newheight = newheight;
+  d.srcrow = size_t(width) * nc;
+  d.srcimage = d.srcrow * height;
+  for (int i = 0; i < 3; i++) d.axis[i] = &axis[i];
+
+  run_rows(sched, newheight * newdepth, newwidth * nc, filter_rows, &d);
+}
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+#ifdef COIN_INT_TEST_SUITE
+
+#include <cstdlib>
+#include <cstring>
+#include <Inventor/C/threads/wsched.h>
+
+// Reference copies of the scalar loops SoGLImage used before the
+// kernels were moved here.
+static void
+imgresize_halve_2d(const int width, const int height, const int nc,
+                   const unsigned char * src, unsigned char * dst)
+{
+  const int nextrow = width * nc;
+  if (width == 1 || height == 1) {
+    const int n = SbMax(width >> 1, height >> 1);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < nc; j++) { *dst++ = (src[0] + src[nc]) >> 1; src++; }
+      src += nc;
+    }
+    return;
+  }
+  for (int i = 0; i < (height >> 1); i++) {
+    for (int j = 0; j < (width >> 1); j++) {
+      for (int c = 0; c < nc; c++) {
+        *dst++ = (src[0] + src[nc] + src[nextrow] + src[nextrow + nc] + 2) >> 2;
+        src++;
+      }
+      src += nc;
+    }
+    src += nextrow;
+  }
+}
+
+static void
+imgresize_halve_3d(const int width, const int height, const int depth,
+                   const int nc, const unsigned char * src, unsigned char * dst)
+{
+  const int rowsize = width * nc;
+  const int imagesize = width * height * nc;
+  for (int k = 0; k < (depth >> 1); k++) {
+    for (int j = 0; j < (height >> 1); j++) {
+      for (int i = 0; i < (width >> 1); i++) {
+        for (int c = 0; c < nc; c++) {
+          *dst++ = (src[0] + src[nc] +
+                    src[rowsize] + src[rowsize + nc] +
+                    src[imagesize] + src[imagesize + nc] +
+                    src[imagesize + rowsize] + src[imagesize + rowsize + nc] +
+                    4) >> 3;
+          src++;
+        }
+        src += nc;
+      }
+      src += rowsize;
+    }
+    src += imagesize;
+  }
+}
+
+static void
+imgresize_nearest_3d(const unsigned char * src, unsigned char * dst,
+                     const int width, const int height, const int depth,
+                     const int nc, const int newwidth, const int newheight,
+                     const int newdepth)
+{
+  const float dx = float(width) / float(newwidth);
+  const float dy = float(height) / float(newheight);
+  const float dz = float(depth) / float(newdepth);
+  float sz = 0.0f;
+  for (int z = 0; z < newdepth; z++) {
+    float sy = 0.0f;
+    for (int y = 0; y < newheight; y++) {
+      float sx = 0.0f;
+      for (int x = 0; x < newwidth; x++) {
+        const int offset = ((int(sz) * height + int(sy)) * width + int(sx)) * nc;
+        for (int i = 0; i < nc; i++) *dst++ = src[offset + i];
+        sx += dx;
+      }
+      sy += dy;
+    }
+    sz += dz;
+  }
+}
+
+static unsigned char *
+imgresize_random_image(const int numbytes)
+{
+  unsigned char * img = new unsigned char[numbytes];
+  for (int i = 0; i < numbytes; i++) img[i] = (unsigned char) (rand() & 0xff);
+  return img;
+}
+
+BOOST_AUTO_TEST_CASE(halveMatchesScalar)
+{
+  static const int sizes[][3] = {
+    { 64, 32, 1 }, { 2, 64, 1 }, { 128, 1, 1 }, { 1, 32, 1 },
+    { 34, 6, 1 }, { 32, 16, 8 }, { 6, 10, 2 }
+  };
+  srand(1);
+  int mismatches = 0;
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    const int w = sizes[s][0], h = sizes[s][1], d = sizes[s][2];
+    for (int nc = 1; nc <= 4; nc++) {
+      unsigned char * src = imgresize_random_image(w * h * d * nc);
+      const int outsize = SbMax(w >> 1, 1) * SbMax(h >> 1, 1) * SbMax(d >> 1, 1) * nc;
+      unsigned char * expected = new unsigned char[outsize];
+      unsigned char * result = new unsigned char[outsize];
+      if (d == 1) imgresize_halve_2d(w, h, nc, src, expected);
+      else imgresize_halve_3d(w, h, d, nc, src, expected);
+      SbImageResize::halve(src, w, h, d, nc, result);
+      if (memcmp(expected, result, outsize) != 0) mismatches++;
+      delete[] src;
+      delete[] expected;
+      delete[] result;
+    }
+  }
+  BOOST_CHECK_MESSAGE(mismatches == 0, "halved images differ from the scalar version");
+}
+
+BOOST_AUTO_TEST_CASE(halveDegenerate3D)
+{
+  // a 3D image with one dimension of size 1 is halved as a 2D image
+  srand(2);
+  unsigned char * src = imgresize_random_image(16 * 1 * 8 * 3);
+  unsigned char * expected = new unsigned char[8 * 4 * 3];
+  unsigned char * result = new unsigned char[8 * 4 * 3];
+  imgresize_halve_2d(16, 8, 3, src, expected);
+  SbImageResize::halve(src, 16, 1, 8, 3, result);
+  BOOST_CHECK_MESSAGE(memcmp(expected, result, 8 * 4 * 3) == 0,
+                      "degenerate 3D image not halved as 2D image");
+  delete[] src;
+  delete[] expected;
+  delete[] result;
+}
+
+BOOST_AUTO_TEST_CASE(nearestMatchesScalar)
+{
+  static const int sizes[][6] = {
+    { 37, 23, 1, 64, 16, 1 }, { 100, 3, 1, 16, 32, 1 }, { 9, 7, 5, 4, 16, 8 }
+  };
+  srand(3);
+  int mismatches = 0;
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    const int * sz = sizes[s];
+    for (int nc = 1; nc <= 4; nc++) {
+      unsigned char * src = imgresize_random_image(sz[0] * sz[1] * sz[2] * nc);
+      const int outsize = sz[3] * sz[4] * sz[5] * nc;
+      unsigned char * expected = new unsigned char[outsize];
+      unsigned char * result = new unsigned char[outsize];
+      imgresize_nearest_3d(src, expected, sz[0], sz[1], sz[2], nc, sz[3], sz[4], sz[5]);
+      SbImageResize::resizeNearest(src, sz[0], sz[1], sz[2], nc, result, sz[3], sz[4], sz[5]);
+      if (memcmp(expected, result, outsize) != 0) mismatches++;
+      delete[] src;
+      delete[] expected;
+      delete[] result;
+    }
+  }
+  BOOST_CHECK_MESSAGE(mismatches == 0, "resized images differ from the scalar version");
+}
+
+BOOST_AUTO_TEST_CASE(filteredResize)
+{
+  srand(4);
+  // an exact 2:1 reduction is the same box filter as used for mipmaps,
+  // apart from rounding
+  unsigned char * src = imgresize_random_image(64 * 32 * 4);
+  unsigned char * halved = new unsigned char[32 * 16 * 4];
+  unsigned char * filtered = new unsigned char[32 * 16 * 4];
+  SbImageResize::halve(src, 64, 32, 1, 4, halved);
+  SbImageResize::resizeFiltered(src, 64, 32, 1, 4, filtered, 32, 16, 1);
+  int maxdiff = 0;
+  for (int i = 0; i < 32 * 16 * 4; i++) {
+    maxdiff = SbMax(maxdiff, abs(int(halved[i]) - int(filtered[i])));
+  }
+  BOOST_CHECK_MESSAGE(maxdiff <= 1, "2:1 filtered resize differs from halving");
+
+  // enlarging a constant image keeps it constant
+  unsigned char constant[5 * 3 * 2];
+  memset(constant, 77, sizeof(constant));
+  unsigned char * large = new unsigned char[16 * 8 * 2];
+  SbImageResize::resizeFiltered(constant, 5, 3, 1, 2, large, 16, 8, 1);
+  int nonconstant = 0;
+  for (int i = 0; i < 16 * 8 * 2; i++) { if (large[i] != 77) nonconstant++; }
+  BOOST_CHECK_MESSAGE(nonconstant == 0, "enlarged constant image is not constant");
+
+  delete[] src;
+  delete[] halved;
+  delete[] filtered;
+  delete[] large;
+}
+
+BOOST_AUTO_TEST_CASE(threadCountIndependent)
+{
+  // large enough to be split into parallel tasks
+  const int w = 512, h = 256, nc = 3;
+  srand(5);
+  unsigned char * src = imgresize_random_image(w * h * nc);
+  cc_wsched * serial = cc_wsched_construct(0);
+  cc_wsched * parallel = cc_wsched_construct(3);
+
+  const int outsize = 300 * 200 * nc;
+  unsigned char * a = new unsigned char[outsize];
+  unsigned char * b = new unsigned char[outsize];
+
+  SbImageResize::halve(src, w, h, 1, nc, a, serial);
+  SbImageResize::halve(src, w, h, 1, nc, b, parallel);
+  BOOST_CHECK_MESSAGE(memcmp(a, b, (w / 2) * (h / 2) * nc) == 0,
+                      "threaded halving gives a different result");
+
+  SbImageResize::resizeNearest(src, w, h, 1, nc, a, 300, 200, 1, serial);
+  SbImageResize::resizeNearest(src, w, h, 1, nc, b, 300, 200, 1, parallel);
+  BOOST_CHECK_MESSAGE(memcmp(a, b, outsize) == 0,
+                      "threaded nearest resize gives a different result");
+
+  SbImageResize::resizeFiltered(src, w, h, 1, nc, a, 300, 200, 1, serial);
+  SbImageResize::resizeFiltered(src, w, h, 1, nc, b, 300, 200, 1, parallel);
+  BOOST_CHECK_MESSAGE(memcmp(a, b, outsize) == 0,
+                      "threaded filtered resize gives a different result");
+
+  cc_wsched_destruct(serial);
+  cc_wsched_destruct(parallel);
+  delete[] src;
+  delete[] a;
+  delete[] b;
+}
+
+#endif // COIN_INT_TEST_SUITE
+#endif // COIN_TEST_SUITE
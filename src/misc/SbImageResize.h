@@ -0,0 +1,84 @@
+#ifndef COIN_SBIMAGERESIZE_H
+#define COIN_SBIMAGERESIZE_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+// *************************************************************************
+// This class (SbImageResize) is internal and must not be exposed in
+// the Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/C/threads/common.h>
+
+// *************************************************************************
+
+// SbImageResize has the image scaling kernels used when preparing
+// texture images: halving for mipmap generation, and resizing to the
+// size supported by the graphics hardware.
+//
+// Images are tightly packed, with 1 to 4 bytes per pixel. 2D images
+// are given with a depth of 1. The work is split into rows of the
+// destination image, which are processed in parallel through a
+// cc_wsched scheduler. When no scheduler is given, the one shared by
+// Coin's internal parallel loops is used. The result does not depend
+// on the number of threads.
+
+class SbImageResize {
+public:
+  static void halve(const unsigned char * src,
+                    const int width, const int height, const int depth,
+                    const int nc, unsigned char * dst,
+                    cc_wsched * sched = NULL);
+
+  static void resizeNearest(const unsigned char * src,
+                            const int width, const int height, const int depth,
+                            const int nc, unsigned char * dst,
+                            const int newwidth, const int newheight,
+                            const int newdepth, cc_wsched * sched = NULL);
+
+  static void resizeFiltered(const unsigned char * src,
+                             const int width, const int height, const int depth,
+                             const int nc, unsigned char * dst,
+                             const int newwidth, const int newheight,
+                             const int newdepth, cc_wsched * sched = NULL);
+};
+
+#endif // !COIN_SBIMAGERESIZE_H
@@ -0,0 +1,363 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "misc/SbLassoGrid.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cmath>
+
+#include <Inventor/SbBasic.h>
+
+// *************************************************************************
+
+// The grid never gets finer than this number of cells along each
+// axis. The cost of building the grid is proportional to the number
+// of cells, and for interactive lassos there is little to gain from
+// going further.
+static const int MAXCELLS = 64;
+
+static inline double
+orient(const SbVec2f & a, const SbVec2f & b, const SbVec2f & c)
+{
+  return
+    (double(b[0]) - double(a[0])) * (double(c[1]) - double(a[1])) -
+    (double(b[1]) - double(a[1])) * (double(c[0]) - double(a[0]));
+}
+
+// Test whether c is within the bounding box of the segment a-b. Only
+// meaningful when a, b and c are known to be collinear.
+static inline SbBool
+in_segment_box(const SbVec2f & a, const SbVec2f & b, const SbVec2f & c)
+{
+  return
+    c[0] >= SbMin(a[0], b[0]) && c[0] <= SbMax(a[0], b[0]) &&
+    c[1] >= SbMin(a[1], b[1]) && c[1] <= SbMax(a[1], b[1]);
+}
+
+// Test whether the segments a0-a1 and b0-b1 intersect. Touching and
+// overlapping segments count as intersecting.
+static SbBool
+segments_intersect(const SbVec2f & a0, const SbVec2f & a1,
+                   const SbVec2f & b0, const SbVec2f & b1)
+{
+  const double d0 = orient(a0, a1, b0);
+  const double d1 = orient(a0, a1, b1);
+  const double d2 = orient(b0, b1, a0);
+  const double d3 = orient(b0, b1, a1);
+
+  if (((d0 > 0.0 && d1 < 0.0) || (d0 < 0.0 && d1 > 0.0)) &&
+      ((d2 > 0.0 && d3 < 0.0) || (d2 < 0.0 && d3 > 0.0))) {
+    return TRUE;
+  }
+  if (d0 == 0.0 && in_segment_box(a0, a1, b0)) return TRUE;
+  if (d1 == 0.0 && in_segment_box(a0, a1, b1)) return TRUE;
+  if (d2 == 0.0 && in_segment_box(b0, b1, a0)) return TRUE;
+  if (d3 == 0.0 && in_segment_box(b0, b1, a1)) return TRUE;
+  return FALSE;
+}
+
+// Even-odd ray crossing test for a single edge, with the same
+// half-open rule as the classic point in polygon test, so vertices
+// exactly at the height of the ray are counted once.
+static inline SbBool
+edge_crosses_ray(const SbVec2f & a, const SbVec2f & b,
+                 const double x, const double y)
+{
+  if ((a[1] > y) == (b[1] > y)) return FALSE;
+  const double xint =
+    double(a[0]) + (double(b[0]) - double(a[0])) *
+    (y - double(a[1])) / (double(b[1]) - double(a[1]));
+  return x < xint;
+}
+
+// *************************************************************************
+
+SbLassoGrid::SbLassoGrid(void)
+{
+  this->numcells[0] = this->numcells[1] = 0;
+}
+
+void
+SbLassoGrid::setPolygon(const SbList<SbVec2s> & coords)
+{
+  int i, x, y;
+
+  this->points.truncate(0);
+  this->bounds.makeEmpty();
+  this->cellflags.truncate(0);
+  this->cellstart.truncate(0);
+  this->celledges.truncate(0);
+  this->rowstart.truncate(0);
+  this->rowedges.truncate(0);
+  this->numcells[0] = this->numcells[1] = 0;
+
+  const int n = coords.getLength();
+  for (i = 0; i < n; i++) {
+    const SbVec2f p((float) coords[i][0], (float) coords[i][1]);
+    this->points.append(p);
+    this->bounds.extendBy(p);
+  }
+  if (n == 0) return;
+
+  // aim for a handful of edges per cell row or column
+  const int res = SbClamp((int) ceil(sqrt((double) n)) * 2, 1, MAXCELLS);
+  float size[2];
+  this->bounds.getSize(size[0], size[1]);
+  this->origin = this->bounds.getMin();
+  for (i = 0; i < 2; i++) {
+    this->numcells[i] = SbClamp((int) size[i], 1, res);
+    this->cellsize[i] = size[i] > 0.0f ? size[i] / this->numcells[i] : 1.0f;
+  }
+  const int numx = this->numcells[0];
+  const int numy = this->numcells[1];
+
+  // find the cells crossed by each edge, then sort the (cell, edge)
+  // pairs by cell
+  SbList<int> pairs;
+  SbList<int> rowpairs;
+  for (i = 0; i < n; i++) {
+    const SbVec2f & a = this->points[i];
+    const SbVec2f & b = this->points[(i + 1) % n];
+    int x0, y0, x1, y1;
+    this->getCell(SbMin(a[0], b[0]), SbMin(a[1], b[1]), x0, y0);
+    this->getCell(SbMax(a[0], b[0]), SbMax(a[1], b[1]), x1, y1);
+    for (y = y0; y <= y1; y++) {
+      rowpairs.append(y);
+      rowpairs.append(i);
+      for (x = x0; x <= x1; x++) {
+        if (this->cellOverlapsSegment(x, y, a, b)) {
+          pairs.append(y * numx + x);
+          pairs.append(i);
+        }
+      }
+    }
+  }
+
+  const int numc = numx * numy;
+  for (i = 0; i <= numc; i++) this->cellstart.append(0);
+  for (i = 0; i <= numy; i++) this->rowstart.append(0);
+  for (i = 0; i < pairs.getLength(); i += 2) this->cellstart[pairs[i] + 1]++;
+  for (i = 0; i < rowpairs.getLength(); i += 2) this->rowstart[rowpairs[i] + 1]++;
+  for (i = 0; i < numc; i++) this->cellstart[i + 1] += this->cellstart[i];
+  for (i = 0; i < numy; i++) this->rowstart[i + 1] += this->rowstart[i];
+
+  SbList<int> fill;
+  for (i = 0; i < numc; i++) fill.append(this->cellstart[i]);
+  for (i = 0; i < pairs.getLength() / 2; i++) this->celledges.append(0);
+  for (i = 0; i < pairs.getLength(); i += 2) {
+    this->celledges[fill[pairs[i]]++] = pairs[i + 1];
+  }
+  fill.truncate(0);
+  for (i = 0; i < numy; i++) fill.append(this->rowstart[i]);
+  for (i = 0; i < rowpairs.getLength() / 2; i++) this->rowedges.append(0);
+  for (i = 0; i < rowpairs.getLength(); i += 2) {
+    this->rowedges[fill[rowpairs[i]]++] = rowpairs[i + 1];
+  }
+
+  // classify the cell centers
+  for (y = 0; y < numy; y++) {
+    const double cy = this->origin[1] + (y + 0.5) * this->cellsize[1];
+    for (x = 0; x < numx; x++) {
+      const double cx = this->origin[0] + (x + 0.5) * this->cellsize[0];
+      SbBool inside = FALSE;
+      for (i = this->rowstart[y]; i < this->rowstart[y + 1]; i++) {
+        const int e = this->rowedges[i];
+        if (edge_crosses_ray(this->points[e], this->points[(e + 1) % n], cx, cy)) {
+          inside = !inside;
+        }
+      }
+      const int c = y * numx + x;
+      unsigned char flags = inside ? CENTER_INSIDE : 0;
+      if (this->cellstart[c + 1] > this->cellstart[c]) flags |= ON_OUTLINE;
+      this->cellflags.append(flags);
+    }
+  }
+}
+
+void
+SbLassoGrid::getCell(const float x, const float y, int & cx, int & cy) const
+{
+  cx = SbClamp((int) floor((x - this->origin[0]) / this->cellsize[0]),
+               0, this->numcells[0] - 1);
+  cy = SbClamp((int) floor((y - this->origin[1]) / this->cellsize[1]),
+               0, this->numcells[1] - 1);
+}
+
+// Conservative test for whether a segment touches a cell. The cell is
+// grown slightly so that rounding in getCell() can never place a point
+// in a cell which was considered to be untouched by the outline.
+SbBool
+SbLassoGrid::cellOverlapsSegment(const int cx, const int cy,
+                                 const SbVec2f & p0, const SbVec2f & p1) const
+{
+  const float ex = this->cellsize[0] * 0.01f;
+  const float ey = this->cellsize[1] * 0.01f;
+  const float x0 = this->origin[0] + cx * this->cellsize[0] - ex;
+  const float x1 = this->origin[0] + (cx + 1) * this->cellsize[0] + ex;
+  const float y0 = this->origin[1] + cy * this->cellsize[1] - ey;
+  const float y1 = this->origin[1] + (cy + 1) * this->cellsize[1] + ey;
+
+  if (SbMax(p0[0], p1[0]) < x0 || SbMin(p0[0], p1[0]) > x1 ||
+      SbMax(p0[1], p1[1]) < y0 || SbMin(p0[1], p1[1]) > y1) {
+    return FALSE;
+  }
+
+  const double d0 = orient(p0, p1, SbVec2f(x0, y0));
+  const double d1 = orient(p0, p1, SbVec2f(x1, y0));
+  const double d2 = orient(p0, p1, SbVec2f(x1, y1));
+  const double d3 = orient(p0, p1, SbVec2f(x0, y1));
+  if (d0 > 0.0 && d1 > 0.0 && d2 > 0.0 && d3 > 0.0) return FALSE;
+  if (d0 < 0.0 && d1 < 0.0 && d2 < 0.0 && d3 < 0.0) return FALSE;
+  return TRUE;
+}
+
+SbBool
+SbLassoGrid::edgeCrossesSegment(const int edge,
+                                const SbVec2f & p0, const SbVec2f & p1) const
+{
+  const int n = this->points.getLength();
+  return segments_intersect(this->points[edge], this->points[(edge + 1) % n],
+                            p0, p1);
+}
+
+// *************************************************************************
+
+// Returns TRUE if p is inside the lasso.
+SbBool
+SbLassoGrid::isInside(const SbVec2f & p) const
+{
+  if (this->numcells[0] == 0 || !this->bounds.intersect(p)) return FALSE;
+
+  int cx, cy;
+  this->getCell(p[0], p[1], cx, cy);
+  const unsigned char flags = this->cellflags[cy * this->numcells[0] + cx];
+  if (!(flags & ON_OUTLINE)) return (flags & CENTER_INSIDE) ? TRUE : FALSE;
+
+  // the outline crosses the cell, so count crossings with the edges
+  // spanning this row
+  const int n = this->points.getLength();
+  SbBool inside = FALSE;
+  for (int i = this->rowstart[cy]; i < this->rowstart[cy + 1]; i++) {
+    const int e = this->rowedges[i];
+    if (edge_crosses_ray(this->points[e], this->points[(e + 1) % n], p[0], p[1])) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// Returns TRUE if the segment p0-p1 touches the lasso outline.
+SbBool
+SbLassoGrid::crossesOutline(const SbVec2f & p0, const SbVec2f & p1) const
+{
+  if (this->numcells[0] == 0) return FALSE;
+  const SbVec2f & bmin = this->bounds.getMin();
+  const SbVec2f & bmax = this->bounds.getMax();
+  if (SbMax(p0[0], p1[0]) < bmin[0] || SbMin(p0[0], p1[0]) > bmax[0] ||
+      SbMax(p0[1], p1[1]) < bmin[1] || SbMin(p0[1], p1[1]) > bmax[1]) {
+    return FALSE;
+  }
+
+  int x0, y0, x1, y1;
+  this->getCell(SbMin(p0[0], p1[0]), SbMin(p0[1], p1[1]), x0, y0);
+  this->getCell(SbMax(p0[0], p1[0]), SbMax(p0[1], p1[1]), x1, y1);
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) {
+      const int c = y * this->numcells[0] + x;
+      if (!(this->cellflags[c] & ON_OUTLINE)) continue;
+      if (!this->cellOverlapsSegment(x, y, p0, p1)) continue;
+      for (int i = this->cellstart[c]; i < this->cellstart[c + 1]; i++) {
+        if (this->edgeCrossesSegment(this->celledges[i], p0, p1)) return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}
+
+// Returns TRUE if some part of the segment p0-p1 is inside the lasso.
+SbBool
+SbLassoGrid::intersectsSegment(const SbVec2f & p0, const SbVec2f & p1) const
+{
+  return
+    this->isInside(p0) || this->isInside(p1) || this->crossesOutline(p0, p1);
+}
+
+// Returns TRUE if the entire segment p0-p1 is inside the lasso.
+SbBool
+SbLassoGrid::containsSegment(const SbVec2f & p0, const SbVec2f & p1) const
+{
+  return
+    this->isInside(p0) && this->isInside(p1) && !this->crossesOutline(p0, p1);
+}
+
+// Returns TRUE if some part of the triangle is inside the lasso.
+SbBool
+SbLassoGrid::intersectsTriangle(const SbVec2f & p0, const SbVec2f & p1,
+                                const SbVec2f & p2) const
+{
+  if (this->numcells[0] == 0) return FALSE;
+  SbBox2f tribox;
+  tribox.extendBy(p0);
+  tribox.extendBy(p1);
+  tribox.extendBy(p2);
+  if (!tribox.intersect(this->bounds)) return FALSE;
+
+  if (this->isInside(p0) || this->isInside(p1) || this->isInside(p2)) return TRUE;
+  if (this->crossesOutline(p0, p1) || this->crossesOutline(p1, p2) ||
+      this->crossesOutline(p2, p0)) return TRUE;
+
+  // the lasso is either completely inside the triangle, or completely
+  // outside it
+  const SbVec2f & l = this->points[0];
+  const double d0 = orient(p0, p1, l);
+  const double d1 = orient(p1, p2, l);
+  const double d2 = orient(p2, p0, l);
+  return
+    (d0 > 0.0 && d1 > 0.0 && d2 > 0.0) ||
+    (d0 < 0.0 && d1 < 0.0 && d2 < 0.0);
+}
+
+// Returns TRUE if the entire triangle is inside the lasso.
+SbBool
+SbLassoGrid::containsTriangle(const SbVec2f & p0, const SbVec2f & p1,
+                              const SbVec2f & p2) const
+{
+  return
+    this->isInside(p0) && this->isInside(p1) && this->isInside(p2) &&
+    !this->crossesOutline(p0, p1) &&
+    !this->crossesOutline(p1, p2) &&
+    !this->crossesOutline(p2, p0);
+}
@@ -0,0 +1,110 @@
+#ifndef COIN_SBLASSOGRID_H
+#define COIN_SBLASSOGRID_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+// *************************************************************************
+// This class (SbLassoGrid) is internal and must not be exposed in
+// the Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbBox2f.h>
+#include <Inventor/SbVec2f.h>
+#include <Inventor/SbVec2s.h>
+#include <Inventor/lists/SbList.h>
+
+// *************************************************************************
+
+// SbLassoGrid answers point, line segment and triangle queries
+// against a screen space lasso polygon. The bounding box of the lasso
+// is split into a grid of cells, and each cell is classified as being
+// completely inside the lasso, completely outside, or crossed by the
+// lasso outline. Most queries are then answered from the cell
+// classification alone, and only the few lasso edges crossing a cell
+// (or a cell row, for point queries) need to be tested exactly.
+//
+// Point containment uses the even-odd rule, so self-intersecting
+// lassos behave like they do when drawn with the stencil buffer.
+
+class SbLassoGrid {
+public:
+  SbLassoGrid(void);
+
+  void setPolygon(const SbList<SbVec2s> & coords);
+  const SbBox2f & getBounds(void) const { return this->bounds; }
+
+  SbBool isInside(const SbVec2f & p) const;
+  SbBool crossesOutline(const SbVec2f & p0, const SbVec2f & p1) const;
+  SbBool intersectsSegment(const SbVec2f & p0, const SbVec2f & p1) const;
+  SbBool containsSegment(const SbVec2f & p0, const SbVec2f & p1) const;
+  SbBool intersectsTriangle(const SbVec2f & p0, const SbVec2f & p1,
+                            const SbVec2f & p2) const;
+  SbBool containsTriangle(const SbVec2f & p0, const SbVec2f & p1,
+                          const SbVec2f & p2) const;
+
+private:
+  enum CellFlags {
+    CENTER_INSIDE = 0x1,
+    ON_OUTLINE = 0x2
+  };
+
+  void getCell(const float x, const float y, int & cx, int & cy) const;
+  SbBool cellOverlapsSegment(const int cx, const int cy,
+                             const SbVec2f & p0, const SbVec2f & p1) const;
+  SbBool edgeCrossesSegment(const int edge,
+                            const SbVec2f & p0, const SbVec2f & p1) const;
+
+  SbList<SbVec2f> points;
+  SbBox2f bounds;
+  SbVec2f origin;
+  SbVec2f cellsize;
+  int numcells[2];
+
+  SbList<unsigned char> cellflags;
+  // edges crossing each cell, and edges spanning each cell row, stored
+  // as index ranges into the edge lists
+  SbList<int> cellstart;
+  SbList<int> celledges;
+  SbList<int> rowstart;
+  SbList<int> rowedges;
+};
+
+#endif // !COIN_SBLASSOGRID_H
@@ -0,0 +1,762 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "misc/SbMeshDecimator.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include <Inventor/C/threads/common.h>
+#include <Inventor/C/threads/sched.h>
+
+// *************************************************************************
+
+// Edges along the mesh boundary and along normal/texture coordinate
+// seams get an extra quadric for the plane perpendicular to the
+// adjacent triangle, scaled by this factor.
+static const double SBMESHDECIMATOR_BOUNDARY_WEIGHT = 10.0;
+
+// A collapse is not done if it would turn the normal of any of the
+// remaining triangles more than this (the cosine of ~78 degrees).
+static const double SBMESHDECIMATOR_MIN_NORMAL_DOT = 0.2;
+
+namespace {
+
+// Symmetric 4x4 matrix, stored as the upper triangle.
+struct Quadric {
+  double a[10];
+
+  Quadric(void) { for (int i = 0; i < 10; i++) this->a[i] = 0.0; }
+
+  void addPlane(const double * n, const double d, const double w) {
+    this->a[0] += w * n[0] * n[0];
+    this->a[1] += w * n[0] * n[1];
+    this->a[2] += w * n[0] * n[2];
+    this->a[3] += w * n[0] * d;
+    this->a[4] += w * n[1] * n[1];
+    this->a[5] += w * n[1] * n[2];
+    this->a[6] += w * n[1] * d;
+    this->a[7] += w * n[2] * n[2];
+    this->a[8] += w * n[2] * d;
+    this->a[9] += w * d * d;
+  }
+  Quadric & operator+=(const Quadric & q) {
+    for (int i = 0; i < 10; i++) this->a[i] += q.a[i];
+    return *this;
+  }
+  double evaluate(const double * p) const {
+    const double x = p[0], y = p[1], z = p[2];
+    return
+      this->a[0]*x*x + 2.0*this->a[1]*x*y + 2.0*this->a[2]*x*z + 2.0*this->a[3]*x +
+      this->a[4]*y*y + 2.0*this->a[5]*y*z + 2.0*this->a[6]*y +
+      this->a[7]*z*z + 2.0*this->a[8]*z +
+      this->a[9];
+  }
+  // Finds the point with the smallest error, if the matrix is well
+  // conditioned.
+  SbBool optimize(double * p) const {
+    const double a00 = this->a[0], a01 = this->a[1], a02 = this->a[2];
+    const double a11 = this->a[4], a12 = this->a[5], a22 = this->a[7];
+    const double c0 = a11 * a22 - a12 * a12;
+    const double c1 = a02 * a12 - a01 * a22;
+    const double c2 = a01 * a12 - a02 * a11;
+    const double det = a00 * c0 + a01 * c1 + a02 * c2;
+    const double trace = a00 + a11 + a22;
+    if (trace <= 0.0 || std::fabs(det) < 1.0e-6 * trace * trace * trace) return FALSE;
+    const double b0 = -this->a[3], b1 = -this->a[6], b2 = -this->a[8];
+    p[0] = (c0 * b0 + c1 * b1 + c2 * b2) / det;
+    p[1] = (c1 * b0 + (a00 * a22 - a02 * a02) * b1 + (a01 * a02 - a00 * a12) * b2) / det;
+    p[2] = (c2 * b0 + (a01 * a02 - a00 * a12) * b1 + (a00 * a11 - a01 * a01) * b2) / det;
+    return TRUE;
+  }
+};
+
+struct Collapse {
+  double cost;
+  int u, v;
+  int stampu, stampv;
+  double p[3];
+
+  // std::priority_queue returns the largest element first
+  bool operator<(const Collapse & c) const { return this->cost > c.cost; }
+};
+
+struct Edge {
+  int v0, v1;   // position vertices, v0 < v1
+  int w0, w1;   // wedges at v0 and v1
+  int triangle;
+
+  bool operator<(const Edge & e) const {
+    if (this->v0 != e.v0) return this->v0 < e.v0;
+    return this->v1 < e.v1;
+  }
+};
+
+struct Level {
+  SbList<SbVec3f> points;
+  SbList<SbVec3f> normals;
+  SbList<SbVec2f> texcoords;
+  SbList<int32_t> triangles;
+};
+
+} // anonymous namespace
+
+// *************************************************************************
+
+class SbMeshDecimatorP {
+public:
+  SbBool usenormals;
+  SbBool usetexcoords;
+
+  // input. "wedges" are the vertices given by the user, which may
+  // share a position with other wedges
+  SbList<SbVec3f> points;
+  SbList<SbVec3f> normals;
+  SbList<SbVec2f> texcoords;
+  SbList<int32_t> input;
+  SbList<float> ratios;
+  SbList<Level *> levels;
+
+  // working data, freed after decimate()
+  std::vector<int> wedgemap;        // wedge -> canonical wedge
+  std::vector<int> wedgepos;        // canonical wedge -> position vertex
+  std::vector<double> pos;          // 3 doubles per position vertex
+  std::vector<Quadric> quadrics;
+  std::vector<std::vector<int> > vtris;
+  std::vector<int> stamp;
+  std::vector<char> alive;
+  std::vector<int> mark;
+  int markgen;
+  std::vector<int> tri;             // 3 canonical wedges per triangle
+  std::vector<char> tdead;
+  int numlive;
+  std::priority_queue<Collapse> heap;
+
+  int corner(const int t, const int i) const {
+    return this->wedgepos[this->tri[3 * t + i]];
+  }
+  SbBool sameWedge(const int w0, const int w1) const;
+  SbBool samePosition(const int w0, const int w1) const;
+
+  void init(void);
+  void addEdgeConstraint(const int t, const int a, const int b);
+  void pushCollapse(const int u, const int v);
+  SbBool isValid(const Collapse & c);
+  void collapse(const Collapse & c);
+  void emit(Level * level);
+  void cleanup(void);
+
+  static void decimate_cb(void * closure);
+};
+
+#define PRIVATE(obj) ((obj)->pimpl)
+
+// *************************************************************************
+
+SbBool
+SbMeshDecimatorP::samePosition(const int w0, const int w1) const
+{
+  return this->points[w0] == this->points[w1];
+}
+
+SbBool
+SbMeshDecimatorP::sameWedge(const int w0, const int w1) const
+{
+  if (!(this->points[w0] == this->points[w1])) return FALSE;
+  if (this->usenormals && !(this->normals[w0] == this->normals[w1])) return FALSE;
+  if (this->usetexcoords && !(this->texcoords[w0] == this->texcoords[w1])) return FALSE;
+  return TRUE;
+}
+
+namespace {
+
+struct WedgeCompare {
+  const SbMeshDecimatorP * thisp;
+  WedgeCompare(const SbMeshDecimatorP * p) : thisp(p) { }
+
+  static int cmp(const float * a, const float * b, const int n) {
+    for (int i = 0; i < n; i++) {
+      if (a[i] < b[i]) return -1;
+      if (a[i] > b[i]) return 1;
+    }
+    return 0;
+  }
+  bool operator()(const int w0, const int w1) const {
+    int c = cmp(thisp->points[w0].getValue(), thisp->points[w1].getValue(), 3);
+    if (c == 0 && thisp->usenormals) {
+      c = cmp(thisp->normals[w0].getValue(), thisp->normals[w1].getValue(), 3);
+    }
+    if (c == 0 && thisp->usetexcoords) {
+      c = cmp(thisp->texcoords[w0].getValue(), thisp->texcoords[w1].getValue(), 2);
+    }
+    if (c == 0) return w0 < w1;
+    return c < 0;
+  }
+};
+
+} // anonymous namespace
+
+// Welds the input vertices, and sets up the quadrics and the initial
+// collapse candidates.
+void
+SbMeshDecimatorP::init(void)
+{
+  int i;
+  const int numwedges = this->points.getLength();
+
+  // sort the wedges so that equal wedges and equal positions are
+  // neighbours
+  std::vector<int> order(numwedges);
+  for (i = 0; i < numwedges; i++) order[i] = i;
+  std::sort(order.begin(), order.end(), WedgeCompare(this));
+
+  this->wedgemap.resize(numwedges);
+  this->wedgepos.assign(numwedges, -1);
+  int numpos = 0;
+  for (i = 0; i < numwedges; i++) {
+    const int w = order[i];
+    if (i > 0 && this->sameWedge(order[i-1], w)) {
+      this->wedgemap[w] = this->wedgemap[order[i-1]];
+      continue;
+    }
+    this->wedgemap[w] = w;
+    if (i == 0 || !this->samePosition(order[i-1], w)) numpos++;
+    this->wedgepos[w] = numpos - 1;
+  }
+
+  this->pos.resize(3 * numpos);
+  for (i = 0; i < numwedges; i++) {
+    const int p = this->wedgepos[i];
+    if (p < 0) continue;
+    const SbVec3f & v = this->points[i];
+    this->pos[3*p] = v[0];
+    this->pos[3*p+1] = v[1];
+    this->pos[3*p+2] = v[2];
+  }
+
+  this->quadrics.assign(numpos, Quadric());
+  this->vtris.assign(numpos, std::vector<int>());
+  this->stamp.assign(numpos, 0);
+  this->alive.assign(numpos, 1);
+  this->mark.assign(numpos, 0);
+  this->markgen = 0;
+
+  // triangles, skipping those that are degenerate after welding
+  const int numinput = this->input.getLength() / 3;
+  this->tri.reserve(numinput * 3);
+  for (i = 0; i < numinput; i++) {
+    const int w0 = this->wedgemap[this->input[3*i]];
+    const int w1 = this->wedgemap[this->input[3*i+1]];
+    const int w2 = this->wedgemap[this->input[3*i+2]];
+    const int p0 = this->wedgepos[w0];
+    const int p1 = this->wedgepos[w1];
+    const int p2 = this->wedgepos[w2];
+    if (p0 == p1 || p1 == p2 || p0 == p2) continue;
+    const int t = static_cast<int>(this->tri.size()) / 3;
+    this->tri.push_back(w0);
+    this->tri.push_back(w1);
+    this->tri.push_back(w2);
+    this->vtris[p0].push_back(t);
+    this->vtris[p1].push_back(t);
+    this->vtris[p2].push_back(t);
+  }
+  const int numtri = static_cast<int>(this->tri.size()) / 3;
+  this->tdead.assign(numtri, 0);
+  this->numlive = numtri;
+
+  // the error quadric of each vertex is the sum of the planes of the
+  // triangles around it, weighted by area
+  std::vector<Edge> edges;
+  edges.reserve(numtri * 3);
+  for (i = 0; i < numtri; i++) {
+    const double * p0 = &this->pos[3 * this->corner(i, 0)];
+    const double * p1 = &this->pos[3 * this->corner(i, 1)];
+    const double * p2 = &this->pos[3 * this->corner(i, 2)];
+    const double e1[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] };
+    const double e2[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] };
+    double n[3] = {
+      e1[1]*e2[2] - e1[2]*e2[1],
+      e1[2]*e2[0] - e1[0]*e2[2],
+      e1[0]*e2[1] - e1[1]*e2[0]
+    };
+    const double len = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+    if (len > 0.0) {
+      n[0] /= len; n[1] /= len; n[2] /= len;
+      const double d = -(n[0]*p0[0] + n[1]*p0[1] + n[2]*p0[2]);
+      for (int j = 0; j < 3; j++) {
+        this->quadrics[this->corner(i, j)].addPlane(n, d, len * 0.5);
+      }
+    }
+    for (int j = 0; j < 3; j++) {
+      Edge e;
+      const int a = this->corner(i, j);
+      const int b = this->corner(i, (j+1) % 3);
+      e.v0 = SbMin(a, b);
+      e.v1 = SbMax(a, b);
+      e.w0 = this->tri[3*i + (a < b ? j : (j+1) % 3)];
+      e.w1 = this->tri[3*i + (a < b ? (j+1) % 3 : j)];
+      e.triangle = i;
+      edges.push_back(e);
+    }
+  }
+
+  // find boundary and seam edges, and add the initial collapses
+  std::sort(edges.begin(), edges.end());
+  const int numedges = static_cast<int>(edges.size());
+  int start = 0;
+  while (start < numedges) {
+    int end = start + 1;
+    while (end < numedges &&
+           edges[end].v0 == edges[start].v0 &&
+           edges[end].v1 == edges[start].v1) end++;
+
+    SbBool constrain = (end - start) != 2;
+    if (!constrain) {
+      const Edge & e0 = edges[start];
+      const Edge & e1 = edges[start+1];
+      constrain = !this->sameWedge(e0.w0, e1.w0) || !this->sameWedge(e0.w1, e1.w1);
+    }
+    if (constrain) {
+      for (i = start; i < end; i++) {
+        this->addEdgeConstraint(edges[i].triangle, edges[i].v0, edges[i].v1);
+      }
+    }
+    start = end;
+  }
+  for (i = 0; i < numedges; i++) {
+    if (i == 0 || edges[i].v0 != edges[i-1].v0 || edges[i].v1 != edges[i-1].v1) {
+      this->pushCollapse(edges[i].v0, edges[i].v1);
+    }
+  }
+}
+
+// Adds the plane through the edge a-b, perpendicular to triangle t, to
+// the quadrics of a and b.
+void
+SbMeshDecimatorP::addEdgeConstraint(const int t, const int a, const int b)
+{
+  const double * p0 = &this->pos[3 * this->corner(t, 0)];
+  const double * p1 = &this->pos[3 * this->corner(t, 1)];
+  const double * p2 = &this->pos[3 * this->corner(t, 2)];
+  const double e1[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] };
+  const double e2[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] };
+  const double n[3] = {
+    e1[1]*e2[2] - e1[2]*e2[1],
+    e1[2]*e2[0] - e1[0]*e2[2],
+    e1[0]*e2[1] - e1[1]*e2[0]
+  };
+  const double * pa = &this->pos[3*a];
+  const double * pb = &this->pos[3*b];
+  const double e[3] = { pb[0]-pa[0], pb[1]-pa[1], pb[2]-pa[2] };
+  double m[3] = {
+    e[1]*n[2] - e[2]*n[1],
+    e[2]*n[0] - e[0]*n[2],
+    e[0]*n[1] - e[1]*n[0]
+  };
+  const double len = std::sqrt(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+  if (len == 0.0) return;
+  m[0] /= len; m[1] /= len; m[2] /= len;
+  const double d = -(m[0]*pa[0] + m[1]*pa[1] + m[2]*pa[2]);
+  const double w = SBMESHDECIMATOR_BOUNDARY_WEIGHT * (e[0]*e[0] + e[1]*e[1] + e[2]*e[2]);
+  this->quadrics[a].addPlane(m, d, w);
+  this->quadrics[b].addPlane(m, d, w);
+}
+
+void
+SbMeshDecimatorP::pushCollapse(const int u, const int v)
+{
+  Quadric q = this->quadrics[u];
+  q += this->quadrics[v];
+
+  Collapse c;
+  c.u = u;
+  c.v = v;
+  c.stampu = this->stamp[u];
+  c.stampv = this->stamp[v];
+  if (q.optimize(c.p)) {
+    c.cost = q.evaluate(c.p);
+  }
+  else {
+    // pick the best of the end points and the midpoint
+    const double * pu = &this->pos[3*u];
+    const double * pv = &this->pos[3*v];
+    const double mid[3] = {
+      (pu[0] + pv[0]) * 0.5, (pu[1] + pv[1]) * 0.5, (pu[2] + pv[2]) * 0.5
+    };
+    const double * cand[3] = { pu, pv, mid };
+    c.cost = -1.0;
+    for (int i = 0; i < 3; i++) {
+      const double cost = q.evaluate(cand[i]);
+      if (c.cost < 0.0 || cost < c.cost) {
+        c.cost = cost;
+        c.p[0] = cand[i][0]; c.p[1] = cand[i][1]; c.p[2] = cand[i][2];
+      }
+    }
+  }
+  if (c.cost < 0.0) c.cost = 0.0;
+  this->heap.push(c);
+}
+
+// Checks that collapsing the edge does not make the mesh non-manifold,
+// and that no triangle is flipped.
+SbBool
+SbMeshDecimatorP::isValid(const Collapse & c)
+{
+  const int u = c.u, v = c.v;
+  size_t i;
+  int j;
+
+  // the vertices adjacent to both u and v must be the opposite
+  // vertices of the triangles sharing the edge
+  const int gen0 = ++this->markgen;
+  for (i = 0; i < this->vtris[u].size(); i++) {
+    const int t = this->vtris[u][i];
+    for (j = 0; j < 3; j++) this->mark[this->corner(t, j)] = gen0;
+  }
+  const int gen1 = ++this->markgen;
+  int numshared = 0, numcommon = 0;
+  for (i = 0; i < this->vtris[v].size(); i++) {
+    const int t = this->vtris[v][i];
+    SbBool hasu = FALSE;
+    for (j = 0; j < 3; j++) if (this->corner(t, j) == u) hasu = TRUE;
+    if (hasu) numshared++;
+    for (j = 0; j < 3; j++) {
+      const int w = this->corner(t, j);
+      if (w == u || w == v) continue;
+      if (this->mark[w] == gen0) { numcommon++; this->mark[w] = gen1; }
+    }
+  }
+  if (numshared == 0 || numcommon > numshared) return FALSE;
+
+  // no triangle may flip
+  const int ends[2] = { u, v };
+  for (int e = 0; e < 2; e++) {
+    const std::vector<int> & tris = this->vtris[ends[e]];
+    for (i = 0; i < tris.size(); i++) {
+      const int t = tris[i];
+      const double * p[3];
+      const double * q[3];
+      int numend = 0;
+      for (j = 0; j < 3; j++) {
+        const int w = this->corner(t, j);
+        p[j] = &this->pos[3*w];
+        q[j] = p[j];
+        if (w == u || w == v) { q[j] = c.p; numend++; }
+      }
+      if (numend > 1) continue; // will be removed
+
+      double n0[3], n1[3];
+      const double * src[2][3] = { { p[0], p[1], p[2] }, { q[0], q[1], q[2] } };
+      double * dst[2] = { n0, n1 };
+      for (int k = 0; k < 2; k++) {
+        const double a[3] = { src[k][1][0]-src[k][0][0], src[k][1][1]-src[k][0][1], src[k][1][2]-src[k][0][2] };
+        const double b[3] = { src[k][2][0]-src[k][0][0], src[k][2][1]-src[k][0][1], src[k][2][2]-src[k][0][2] };
+        dst[k][0] = a[1]*b[2] - a[2]*b[1];
+        dst[k][1] = a[2]*b[0] - a[0]*b[2];
+        dst[k][2] = a[0]*b[1] - a[1]*b[0];
+      }
+      const double l0 = std::sqrt(n0[0]*n0[0] + n0[1]*n0[1] + n0[2]*n0[2]);
+      const double l1 = std::sqrt(n1[0]*n1[0] + n1[1]*n1[1] + n1[2]*n1[2]);
+      if (l0 == 0.0) continue;
+      if (l1 == 0.0) return FALSE;
+      const double dot = (n0[0]*n1[0] + n0[1]*n1[1] + n0[2]*n1[2]) / (l0 * l1);
+      if (dot < SBMESHDECIMATOR_MIN_NORMAL_DOT) return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+static void
+sbmeshdecimator_remove(std::vector<int> & list, const int t)
+{
+  for (size_t i = 0; i < list.size(); i++) {
+    if (list[i] == t) {
+      list[i] = list.back();
+      list.pop_back();
+      return;
+    }
+  }
+}
+
+// Collapses v into u.
+void
+SbMeshDecimatorP::collapse(const Collapse & c)
+{
+  const int u = c.u, v = c.v;
+  this->pos[3*u] = c.p[0];
+  this->pos[3*u+1] = c.p[1];
+  this->pos[3*u+2] = c.p[2];
+  this->quadrics[u] += this->quadrics[v];
+
+  std::vector<int> & vlist = this->vtris[v];
+  for (size_t i = 0; i < vlist.size(); i++) {
+    const int t = vlist[i];
+    SbBool hasu = FALSE;
+    int j;
+    for (j = 0; j < 3; j++) if (this->corner(t, j) == u) hasu = TRUE;
+    if (hasu) {
+      this->tdead[t] = 1;
+      this->numlive--;
+      for (j = 0; j < 3; j++) {
+        const int w = this->corner(t, j);
+        if (w != v) sbmeshdecimator_remove(this->vtris[w], t);
+      }
+    }
+    else {
+      for (j = 0; j < 3; j++) {
+        const int w = this->tri[3*t + j];
+        if (this->wedgepos[w] == v) this->wedgepos[w] = u;
+      }
+      this->vtris[u].push_back(t);
+    }
+  }
+  vlist.clear();
+  this->alive[v] = 0;
+  this->stamp[u]++;
+
+  // new collapse candidates for the edges around u
+  const int gen = ++this->markgen;
+  this->mark[u] = gen;
+  const std::vector<int> & ulist = this->vtris[u];
+  for (size_t i = 0; i < ulist.size(); i++) {
+    for (int j = 0; j < 3; j++) {
+      const int w = this->corner(ulist[i], j);
+      if (this->mark[w] == gen) continue;
+      this->mark[w] = gen;
+      this->pushCollapse(SbMin(u, w), SbMax(u, w));
+    }
+  }
+}
+
+void
+SbMeshDecimatorP::emit(Level * level)
+{
+  std::vector<int> outidx(this->points.getLength(), -1);
+  const int numtri = static_cast<int>(this->tri.size()) / 3;
+  for (int t = 0; t < numtri; t++) {
+    if (this->tdead[t]) continue;
+    for (int j = 0; j < 3; j++) {
+      const int w = this->tri[3*t + j];
+      if (outidx[w] < 0) {
+        outidx[w] = level->points.getLength();
+        const double * p = &this->pos[3 * this->wedgepos[w]];
+        level->points.append(SbVec3f(static_cast<float>(p[0]),
+                                     static_cast<float>(p[1]),
+                                     static_cast<float>(p[2])));
+        if (this->usenormals) level->normals.append(this->normals[w]);
+        if (this->usetexcoords) level->texcoords.append(this->texcoords[w]);
+      }
+      level->triangles.append(outidx[w]);
+    }
+  }
+}
+
+void
+SbMeshDecimatorP::cleanup(void)
+{
+  std::vector<int>().swap(this->wedgemap);
+  std::vector<int>().swap(this->wedgepos);
+  std::vector<double>().swap(this->pos);
+  std::vector<Quadric>().swap(this->quadrics);
+  std::vector<std::vector<int> >().swap(this->vtris);
+  std::vector<int>().swap(this->stamp);
+  std::vector<char>().swap(this->alive);
+  std::vector<int>().swap(this->mark);
+  std::vector<int>().swap(this->tri);
+  std::vector<char>().swap(this->tdead);
+  this->heap = std::priority_queue<Collapse>();
+}
+
+void
+SbMeshDecimatorP::decimate_cb(void * closure)
+{
+  static_cast<SbMeshDecimator *>(closure)->decimate();
+}
+
+// *************************************************************************
+
+SbMeshDecimator::SbMeshDecimator(const SbBool usenormals, const SbBool usetexcoords)
+{
+  PRIVATE(this) = new SbMeshDecimatorP;
+  PRIVATE(this)->usenormals = usenormals;
+  PRIVATE(this)->usetexcoords = usetexcoords;
+  PRIVATE(this)->numlive = 0;
+  PRIVATE(this)->markgen = 0;
+}
+
+SbMeshDecimator::~SbMeshDecimator()
+{
+  for (int i = 0; i < PRIVATE(this)->levels.getLength(); i++) {
+    delete PRIVATE(this)->levels[i];
+  }
+  delete PRIVATE(this);
+}
+
+// Adds a vertex, and returns its index.
+int
+SbMeshDecimator::addVertex(const SbVec3f & point,
+                           const SbVec3f & normal,
+                           const SbVec2f & texcoord)
+{
+  PRIVATE(this)->points.append(point);
+  if (PRIVATE(this)->usenormals) PRIVATE(this)->normals.append(normal);
+  if (PRIVATE(this)->usetexcoords) PRIVATE(this)->texcoords.append(texcoord);
+  return PRIVATE(this)->points.getLength() - 1;
+}
+
+void
+SbMeshDecimator::addTriangle(const int v0, const int v1, const int v2)
+{
+  PRIVATE(this)->input.append(v0);
+  PRIVATE(this)->input.append(v1);
+  PRIVATE(this)->input.append(v2);
+}
+
+int
+SbMeshDecimator::getNumVertices(void) const
+{
+  return PRIVATE(this)->points.getLength();
+}
+
+int
+SbMeshDecimator::getNumTriangles(void) const
+{
+  return PRIVATE(this)->input.getLength() / 3;
+}
+
+// Sets the levels to generate, as the fraction of the input triangles
+// to keep. The ratios should be in decreasing order.
+void
+SbMeshDecimator::setLevels(const int numlevels, const float * ratios)
+{
+  PRIVATE(this)->ratios.truncate(0);
+  for (int i = 0; i < numlevels; i++) {
+    PRIVATE(this)->ratios.append(ratios[i]);
+  }
+}
+
+// Generates all the levels. Can be called from any thread, as long
+// as the instance is not used by other threads at the same time.
+void
+SbMeshDecimator::decimate(void)
+{
+  SbMeshDecimatorP * thisp = PRIVATE(this);
+  int i;
+  for (i = 0; i < thisp->levels.getLength(); i++) delete thisp->levels[i];
+  thisp->levels.truncate(0);
+
+  thisp->init();
+  const int numinput = this->getNumTriangles();
+  for (i = 0; i < thisp->ratios.getLength(); i++) {
+    const int target = static_cast<int>(thisp->ratios[i] * numinput);
+    while (thisp->numlive > target && !thisp->heap.empty()) {
+      const Collapse c = thisp->heap.top();
+      thisp->heap.pop();
+      if (!thisp->alive[c.u] || !thisp->alive[c.v] ||
+          thisp->stamp[c.u] != c.stampu || thisp->stamp[c.v] != c.stampv) {
+        continue; // stale
+      }
+      if (!thisp->isValid(c)) continue;
+      thisp->collapse(c);
+    }
+    Level * level = new Level;
+    thisp->emit(level);
+    thisp->levels.append(level);
+  }
+  thisp->cleanup();
+}
+
+int
+SbMeshDecimator::getNumLevels(void) const
+{
+  return PRIVATE(this)->levels.getLength();
+}
+
+const SbList<SbVec3f> &
+SbMeshDecimator::getPoints(const int level) const
+{
+  return PRIVATE(this)->levels[level]->points;
+}
+
+// Empty unless normals were enabled in the constructor.
+const SbList<SbVec3f> &
+SbMeshDecimator::getNormals(const int level) const
+{
+  return PRIVATE(this)->levels[level]->normals;
+}
+
+// Empty unless texture coordinates were enabled in the constructor.
+const SbList<SbVec2f> &
+SbMeshDecimator::getTexCoords(const int level) const
+{
+  return PRIVATE(this)->levels[level]->texcoords;
+}
+
+// Three indices into the vertex lists for each triangle.
+const SbList<int32_t> &
+SbMeshDecimator::getTriangles(const int level) const
+{
+  return PRIVATE(this)->levels[level]->triangles;
+}
+
+// Decimates several meshes, using up to \a numthreads threads. The
+// largest meshes are started first, to spread the work evenly.
+void
+SbMeshDecimator::decimate(SbMeshDecimator * const * meshes, const int nummeshes,
+                          const int numthreads)
+{
+#ifdef HAVE_THREADS
+  if (numthreads > 1 && nummeshes > 1 &&
+      cc_thread_implementation() != CC_NO_THREADS) {
+    cc_sched * sched = cc_sched_construct(SbMin(numthreads, nummeshes));
+    for (int i = 0; i < nummeshes; i++) {
+      (void) cc_sched_schedule(sched, SbMeshDecimatorP::decimate_cb, meshes[i],
+                               static_cast<float>(meshes[i]->getNumTriangles()));
+    }
+    cc_sched_wait_all(sched);
+    cc_sched_destruct(sched);
+    return;
+  }
+#endif // HAVE_THREADS
+  for (int i = 0; i < nummeshes; i++) {
+    meshes[i]->decimate();
+  }
+}
+
+#undef PRIVATE
@@ -0,0 +1,107 @@
+#ifndef COIN_SBMESHDECIMATOR_H
+#define COIN_SBMESHDECIMATOR_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+// *************************************************************************
+// This class (SbMeshDecimator) is internal and must not be exposed in
+// the Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbVec2f.h>
+#include <Inventor/SbVec3f.h>
+#include <Inventor/lists/SbList.h>
+
+class SbMeshDecimatorP;
+
+// *************************************************************************
+
+// SbMeshDecimator reduces the number of triangles in a triangle mesh
+// by repeatedly collapsing the edge which changes the shape of the
+// mesh the least, measured with the quadric error metric of Garland
+// and Heckbert ("Surface Simplification Using Quadric Error Metrics",
+// SIGGRAPH 97).
+//
+// Vertices are given with a position, and optionally a normal and a
+// texture coordinate. Vertices with the same position are welded
+// together while decimating, so the mesh will not tear apart along
+// normal or texture coordinate seams, and edges along the mesh
+// boundary or along seams are penalized to keep their shape. Edge
+// collapses that would flip a triangle or make the mesh non-manifold
+// are not done.
+//
+// Several levels of detail can be generated in one go. Each level
+// continues from the result of the previous one, so the levels are
+// nested and the total cost is the same as for the coarsest level.
+
+class SbMeshDecimator {
+public:
+  SbMeshDecimator(const SbBool usenormals, const SbBool usetexcoords);
+  ~SbMeshDecimator();
+
+  int addVertex(const SbVec3f & point,
+                const SbVec3f & normal = SbVec3f(0.0f, 0.0f, 0.0f),
+                const SbVec2f & texcoord = SbVec2f(0.0f, 0.0f));
+  void addTriangle(const int v0, const int v1, const int v2);
+
+  int getNumVertices(void) const;
+  int getNumTriangles(void) const;
+
+  void setLevels(const int numlevels, const float * ratios);
+  void decimate(void);
+
+  int getNumLevels(void) const;
+  const SbList<SbVec3f> & getPoints(const int level) const;
+  const SbList<SbVec3f> & getNormals(const int level) const;
+  const SbList<SbVec2f> & getTexCoords(const int level) const;
+  const SbList<int32_t> & getTriangles(const int level) const;
+
+  static void decimate(SbMeshDecimator * const * meshes, const int nummeshes,
+                       const int numthreads);
+
+private:
+  SbMeshDecimatorP * pimpl;
+
+  // NOT IMPLEMENTED:
+  SbMeshDecimator(const SbMeshDecimator & rhs);
+  SbMeshDecimator & operator = (const SbMeshDecimator & rhs);
+};
+
+#endif // !COIN_SBMESHDECIMATOR_H
@@ -0,0 +1,146 @@
+#ifndef COIN_SBRADIXSORT_H
+#define COIN_SBRADIXSORT_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+// *************************************************************************
+// This class (SbRadixSort) is internal and must not be exposed in the
+// Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <string.h> // memset(), memcpy()
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/lists/SbList.h>
+
+// *************************************************************************
+
+// SbRadixSort sorts an array of float keys in O(n) time using a
+// least-significant-digit radix sort on the IEEE-754 bit patterns of
+// the keys. The keys themselves are not touched. The result is a
+// permutation of indices into the key array. The sort is stable, so
+// indices with equal keys keep the order they had in the input
+// permutation (which is the identity permutation unless a seed
+// permutation is given).
+//
+// All buffers are kept between invocations, so an instance that is
+// used for sorting every frame will not reallocate memory unless the
+// number of keys grows.
+
+class SbRadixSort {
+public:
+  enum Order { ASCENDING, DESCENDING };
+
+  SbRadixSort(void) { }
+
+  // Sort the n first keys in keyarray. If seed is non-NULL, it should
+  // point to a permutation of [0, n-1] which decides the order of
+  // elements with equal keys. Returns a pointer to the sorted index
+  // array, valid until the next call to sort().
+  const int * sort(const float * keyarray, const int n,
+                   const Order order = ASCENDING,
+                   const int * seed = NULL)
+  {
+    this->keys.truncate(0);
+    this->indices[0].truncate(0);
+    this->indices[1].truncate(0);
+    if (n == 0) return NULL;
+
+    int i;
+    for (i = 0; i < n; i++) {
+      uint32_t k = SbRadixSort::floatToKey(keyarray[i]);
+      if (order == DESCENDING) k = ~k;
+      this->keys.append(k);
+      this->indices[0].append(seed ? seed[i] : i);
+      this->indices[1].append(0);
+    }
+
+    const uint32_t * karray = this->keys.getArrayPtr();
+    int * src = const_cast<int *>(this->indices[0].getArrayPtr());
+    int * dst = const_cast<int *>(this->indices[1].getArrayPtr());
+
+    uint32_t histogram[4][256];
+    (void) memset(histogram, 0, sizeof(histogram));
+    for (i = 0; i < n; i++) {
+      const uint32_t k = karray[i];
+      histogram[0][k & 0xff]++;
+      histogram[1][(k >> 8) & 0xff]++;
+      histogram[2][(k >> 16) & 0xff]++;
+      histogram[3][k >> 24]++;
+    }
+
+    for (int pass = 0; pass < 4; pass++) {
+      uint32_t * h = histogram[pass];
+      const int shift = pass * 8;
+      // if every key has the same digit in this pass, the pass
+      // wouldn't change the order, and can be skipped
+      if (h[(karray[src[0]] >> shift) & 0xff] == static_cast<uint32_t>(n)) continue;
+
+      uint32_t sum = 0;
+      for (i = 0; i < 256; i++) {
+        const uint32_t tmp = h[i];
+        h[i] = sum;
+        sum += tmp;
+      }
+      for (i = 0; i < n; i++) {
+        const int idx = src[i];
+        dst[h[(karray[idx] >> shift) & 0xff]++] = idx;
+      }
+      int * tmp = src; src = dst; dst = tmp;
+    }
+    return src;
+  }
+
+private:
+  // Flips the bits of a float so that the resulting unsigned integers
+  // compare in the same order as the original floats. Negative
+  // numbers get all bits inverted, positive numbers only the sign
+  // bit. -0.0 is mapped to 0.0, so that they compare equal.
+  static uint32_t floatToKey(const float f) {
+    const float v = (f == 0.0f) ? 0.0f : f;
+    uint32_t u;
+    (void) memcpy(&u, &v, sizeof(uint32_t));
+    const uint32_t mask = (u & 0x80000000) ? 0xffffffff : 0x80000000;
+    return u ^ mask;
+  }
+
+  SbList <uint32_t> keys;
+  SbList <int> indices[2];
+};
+
+#endif // !COIN_SBRADIXSORT_H
@@ -84,13 +84,16 @@
 #include <Inventor/sensors/SoDataSensor.h>
 
 #include "misc/SoBaseP.h"
+#include "coindefs.h"
 #include "nodes/SoUnknownNode.h"
 #include "fields/SoGlobalField.h"
 #include "misc/SbHash.h"
 #include "upgraders/SoUpgrader.h"
 #include "threads/threadsutilp.h"
+#include "threads/atomicp.h"
 #include "tidbitsp.h"
 #include "io/SoInputP.h"
+#include "io/SoOutput_Writer.h"
 #include "io/SoWriterefCounter.h"
 
 #ifdef HAVE_CONFIG_H
@@ -178,6 +181,49 @@ SoType SoBase::classTypeId STATIC_SOTYPE_INIT;
 // <mortene@sim.no>
 #define ALIVE_PATTERN 0xd
 
+// Mirror of the SoBase::objdata bitfields. The reference count is
+// updated with a compare-and-swap on the 32-bit word holding both
+// fields, and going through an identically declared struct lets us
+// do that without assuming anything about how the compiler lays out
+// the bits.
+struct SoBaseObjData {
+  int referencecount  : 28;
+  unsigned int alive  :  4;
+};
+
+// Returns the reference count stored in the objdata word.
+static int32_t
+sobase_get_refcount(const void * objdata)
+{
+  const int32_t word =
+    cc_atomic_load32(static_cast<const volatile int32_t *>(objdata));
+  SoBaseObjData data;
+  (void)memcpy(&data, &word, sizeof(data));
+  return data.referencecount;
+}
+
+// Atomically adds delta to the reference count stored in the objdata
+// word, leaving the "alive" bits untouched. Returns the new count.
+static int32_t
+sobase_add_refcount(const void * objdata, const int32_t delta)
+{
+  volatile int32_t * word =
+    static_cast<volatile int32_t *>(const_cast<void *>(objdata));
+  int32_t oldword = cc_atomic_load32(word);
+  for (;;) {
+    SoBaseObjData data;
+    (void)memcpy(&data, &oldword, sizeof(data));
+    data.referencecount += delta;
+    const int32_t newcount = data.referencecount;
+
+    int32_t newword;
+    (void)memcpy(&newword, &data, sizeof(newword));
+    const int32_t prevword = cc_atomic_cas32(word, oldword, newword);
+    if (prevword == oldword) { return newcount; }
+    oldword = prevword;
+  }
+}
+
 unsigned int SbHashFunc(const SoBase * key) {
   return SbHashFunc(reinterpret_cast<size_t>(key));
 }
@@ -198,7 +244,9 @@ SoBase::SoBase(void)
   assert((SoBase::classTypeId != SoType::badType()) &&
          "An SoBase-derived class was attempted instantiated *before* Coin initialization. (Have you perhaps placed an SoBase-derived instance (e.g. a scene graph node) in non-heap memory?) See SoBase class documentation for more info.");
 
-  cc_rbptree_init(&this->auditortree);
+  this->auditordata.num = 0;
+  this->auditordata.haslist = 0;
+  this->auditordata.overflow = NULL;
 
   this->objdata.referencecount = 0;
 
@@ -236,14 +284,23 @@ SoBase::~SoBase()
   // used to check that we are still alive.
   this->objdata.alive = (~ALIVE_PATTERN) & 0xf;
 
-  if (SoBase::PImpl::auditordict) {
-    //SoAuditorList * l;
-    if (SoBase::PImpl::auditordict->find(this)!=SoBase::PImpl::auditordict->const_end()) {
-      SoBase::PImpl::auditordict->erase(this);
-      //delete l;
+  SoBase::AuditorOverflow * overflow = this->auditordata.overflow;
+  if (overflow) {
+    cc_rbptree_clean(&overflow->tree);
+    delete overflow;
+  }
+
+  // only objects getAuditors() has been called for have a list
+  if (this->auditordata.haslist) {
+    CC_MUTEX_LOCK(SoBase::PImpl::auditor_mutex);
+    SoAuditorList * l;
+    if (SoBase::PImpl::auditordict &&
+        SoBase::PImpl::auditordict->get(this, l)) {
+      (void)SoBase::PImpl::auditordict->erase(this);
+      delete l;
     }
+    CC_MUTEX_UNLOCK(SoBase::PImpl::auditor_mutex);
   }
-  cc_rbptree_clean(&this->auditortree);
 
 #if COIN_DEBUG
   if (SoBase::PImpl::trackbaseobjects) {
@@ -256,8 +313,8 @@ SoBase::~SoBase()
 }
 
 //
-// callback from auditortree that is used to add sensor
-// auditors to the list (closure).
+// Adds the auditor to the list (closure) if it is a sensor. Also used
+// as a callback from the overflow auditor tree.
 //
 static void
 sobase_sensor_add_cb(void * auditor, void * type, void * closure)
@@ -313,7 +370,13 @@ SoBase::destroy(void)
   // Find all auditors that they need to cut off their link to this
   // object. I believe this is necessary only for sensors.
   SbList<SoDataSensor *> auditingsensors;
-  cc_rbptree_traverse(&this->auditortree, (cc_rbptree_traversecb *)sobase_sensor_add_cb, &auditingsensors);
+  for (int i = 0; i < this->auditordata.num; i++) {
+    const uintptr_t type = this->auditordata.type[i];
+    sobase_sensor_add_cb(this->auditordata.object[i], (void *)type, &auditingsensors);
+  }
+  if (this->auditordata.overflow) {
+    cc_rbptree_traverse(&this->auditordata.overflow->tree, (cc_rbptree_traversecb *)sobase_sensor_add_cb, &auditingsensors);
+  }
 
   // Notify sensors that we're dying.
   for (int j = 0; j < auditingsensors.getLength(); j++)
@@ -346,6 +409,9 @@ SoBase::destroy(void)
 void
 SoBase::initClass(void)
 {
+  // sobase_add_refcount() updates the objdata bitfields as one word.
+  COIN_CT_ASSERT(sizeof(SoBaseObjData) == sizeof(int32_t));
+
   // check_for_leaks() goes through the allocation list, and checks if
   // all allocated SoBase-derived instances was deallocated before the
   // atexit-routines were run.
@@ -369,7 +435,6 @@ SoBase::initClass(void)
   SoBase::PImpl::refwriteprefix = new SbString("+");
   SoBase::PImpl::allbaseobj = new SoBaseSet;
 
-  CC_MUTEX_CONSTRUCT(SoBase::PImpl::mutex);
   CC_MUTEX_CONSTRUCT(SoBase::PImpl::obj2name_mutex);
   CC_MUTEX_CONSTRUCT(SoBase::PImpl::name2obj_mutex);
   CC_MUTEX_CONSTRUCT(SoBase::PImpl::allbaseobj_mutex);
@@ -410,10 +475,12 @@ SoBase::cleanClass(void)
 
   SoBase::classTypeId STATIC_SOTYPE_INIT;
 
-  CC_MUTEX_DESTRUCT(SoBase::PImpl::mutex);
   CC_MUTEX_DESTRUCT(SoBase::PImpl::obj2name_mutex);
   CC_MUTEX_DESTRUCT(SoBase::PImpl::allbaseobj_mutex);
   CC_MUTEX_DESTRUCT(SoBase::PImpl::name2obj_mutex);
+  // the lists are deleted first, so that objects destructed later
+  // don't use the mutex
+  SoBase::PImpl::cleanup_auditordict();
   CC_MUTEX_DESTRUCT(SoBase::PImpl::auditor_mutex);
   CC_MUTEX_DESTRUCT(SoBase::PImpl::global_mutex);
 
@@ -475,19 +542,15 @@ SoBase::ref(void) const
 {
   if (COIN_DEBUG) this->assertAlive();
 
-  CC_MUTEX_LOCK(SoBase::PImpl::mutex);
-#if COIN_DEBUG
-  int32_t currentrefcount = this->objdata.referencecount;
-#endif // COIN_DEBUG
-  this->objdata.referencecount++;
-  CC_MUTEX_UNLOCK(SoBase::PImpl::mutex);
+  const int32_t refcount = sobase_add_refcount(&this->objdata, 1);
 
 #if COIN_DEBUG
-  if (this->objdata.referencecount < currentrefcount) {
+  // Incrementing the largest count wraps around to the smallest.
+  if (refcount == -(1 << 27)) {
     SoDebugError::post("SoBase::ref",
                        "%p ('%s') - referencecount overflow!: %d -> %d",
                        this, this->getTypeId().getName().getString(),
-                       currentrefcount, this->objdata.referencecount);
+                       (1 << 27) - 1, refcount);
 
     // The reference counter is contained within 27 bits of signed
     // integer, which means it can go up to about ~67 million
@@ -506,7 +569,7 @@ SoBase::ref(void) const
     SoDebugError::postInfo("SoBase::ref",
                            "%p ('%s') - referencecount: %d",
                            this, this->getTypeId().getName().getString(),
-                           this->objdata.referencecount);
+                           refcount);
   }
 #endif // COIN_DEBUG
 }
@@ -525,18 +588,14 @@ SoBase::unref(void) const
 {
   if (COIN_DEBUG) this->assertAlive();
 
-  CC_MUTEX_LOCK(SoBase::PImpl::mutex);
-  this->objdata.referencecount--;
-  int refcount = this->objdata.referencecount;
-
-  CC_MUTEX_UNLOCK(SoBase::PImpl::mutex);
+  const int32_t refcount = sobase_add_refcount(&this->objdata, -1);
 
 #if COIN_DEBUG
   if (SoBase::PImpl::tracerefs) {
     SoDebugError::postInfo("SoBase::unref",
                            "%p ('%s') - referencecount: %d",
                            this, this->getTypeId().getName().getString(),
-                           this->objdata.referencecount);
+                           refcount);
   }
   if (refcount < 0) {
     // Do the debug output in two calls, since the getTypeId() might
@@ -564,13 +623,16 @@ SoBase::unrefNoDelete(void) const
 {
   if (COIN_DEBUG) this->assertAlive();
 
-  this->objdata.referencecount--;
+#if COIN_DEBUG
+  const int32_t refcount =
+#endif // COIN_DEBUG
+    sobase_add_refcount(&this->objdata, -1);
 #if COIN_DEBUG
   if (SoBase::PImpl::tracerefs) {
     SoDebugError::postInfo("SoBase::unrefNoDelete",
                            "%p ('%s') - referencecount: %d",
                            this, this->getTypeId().getName().getString(),
-                           this->objdata.referencecount);
+                           refcount);
   }
 #endif // COIN_DEBUG
 }
@@ -581,7 +643,7 @@ SoBase::unrefNoDelete(void) const
 int32_t
 SoBase::getRefCount(void) const
 {
-  return this->objdata.referencecount;
+  return sobase_get_refcount(&this->objdata);
 }
 
 /*!
@@ -803,12 +865,37 @@ SoBase::notify(SoNotList * l)
   SoDebugError::postInfo("SoBase::notify", "base %p, list %p", this, l);
 #endif // debug
 
+  const int numinline = this->auditordata.num;
   SoBase::PImpl::NotifyData notdata;
-  notdata.cnt = cc_rbptree_size(&this->auditortree);
+  notdata.cnt = numinline;
+  if (this->auditordata.overflow) {
+    notdata.cnt += cc_rbptree_size(&this->auditordata.overflow->tree);
+  }
   notdata.list = l;
   notdata.thisp = this;
 
-  cc_rbptree_traverse(&this->auditortree, (cc_rbptree_traversecb *)SoBase::PImpl::rbptree_notify_cb, &notdata);
+  if (notdata.cnt == 1 && numinline == 1) { // fast path for common case
+    this->doNotify(l, this->auditordata.object[0],
+                   (SoNotRec::Type) this->auditordata.type[0]);
+    return;
+  }
+
+  // Take a copy of the inline auditors, as notification may add or
+  // remove auditors.
+  void * object[NUM_INLINE_AUDITORS];
+  unsigned char type[NUM_INLINE_AUDITORS];
+  for (int i = 0; i < numinline; i++) {
+    object[i] = this->auditordata.object[i];
+    type[i] = this->auditordata.type[i];
+  }
+  for (int i = 0; i < numinline; i++) {
+    const uintptr_t tmp = type[i];
+    SoBase::PImpl::rbptree_notify_cb(object[i], (void *)tmp, &notdata);
+  }
+
+  if (this->auditordata.overflow) {
+    cc_rbptree_traverse(&this->auditordata.overflow->tree, (cc_rbptree_traversecb *)SoBase::PImpl::rbptree_notify_cb, &notdata);
+  }
   assert(notdata.cnt == 0);
 }
 
@@ -823,8 +910,15 @@ SoBase::addAuditor(void * const auditor, const SoNotRec::Type type)
 {
   // MSVC7 on 64-bit Windows wants to go through this type before
   // casting to void*.
+  if (this->auditordata.num < NUM_INLINE_AUDITORS) {
+    this->auditordata.object[this->auditordata.num] = auditor;
+    this->auditordata.type[this->auditordata.num] = (unsigned char) type;
+    this->auditordata.num++;
+    return;
+  }
+
   const uintptr_t val = (uintptr_t)type;
-  cc_rbptree_insert(&this->auditortree, auditor, (void *)val);
+  cc_rbptree_insert(&this->getAuditorOverflow()->tree, auditor, (void *)val);
 }
 
 /*!
@@ -836,7 +930,34 @@ SoBase::addAuditor(void * const auditor, const SoNotRec::Type type)
 void
 SoBase::removeAuditor(void * const auditor, const SoNotRec::Type COIN_UNUSED_ARG(type))
 {
-  cc_rbptree_remove(&this->auditortree, auditor);
+  const int num = this->auditordata.num;
+  for (int i = 0; i < num; i++) {
+    if (this->auditordata.object[i] == auditor) {
+      // keep the remaining auditors in the order they were added
+      for (int j = i + 1; j < num; j++) {
+        this->auditordata.object[j-1] = this->auditordata.object[j];
+        this->auditordata.type[j-1] = this->auditordata.type[j];
+      }
+      this->auditordata.num--;
+      return;
+    }
+  }
+  if (this->auditordata.overflow) {
+    (void)cc_rbptree_remove(&this->auditordata.overflow->tree, auditor);
+  }
+}
+
+//
+// Returns the overflow auditor store, allocating it if necessary.
+//
+SoBase::AuditorOverflow *
+SoBase::getAuditorOverflow(void) const
+{
+  if (this->auditordata.overflow == NULL) {
+    this->auditordata.overflow = new SoBase::AuditorOverflow;
+    cc_rbptree_init(&this->auditordata.overflow->tree);
+  }
+  return this->auditordata.overflow;
 }
 
 
@@ -866,20 +987,23 @@ SoBase::getAuditors(void) const
   }
 
   SoAuditorList * l = NULL;
-  SbHash<const SoBase *, SoAuditorList *>::const_iterator iter
-    = 
-    SoBase::PImpl::auditordict->find(this);
-  if (iter!=SoBase::PImpl::auditordict->const_end()) {
-    l = iter->obj;
+  if (SoBase::PImpl::auditordict->get(this, l)) {
     // empty list before copying in new values
-    for (int i = 0; i < l->getLength(); i++) {
-      l->remove(i);
-    }
+    while (l->getLength() > 0) { l->remove(l->getLength() - 1); }
   }
   else {
-    (*SoBase::PImpl::auditordict)[this] = new SoAuditorList;
+    l = new SoAuditorList;
+    (void)SoBase::PImpl::auditordict->put(this, l);
+    this->auditordata.haslist = 1;
+  }
+
+  for (int i = 0; i < this->auditordata.num; i++) {
+    l->append(this->auditordata.object[i],
+              (SoNotRec::Type) this->auditordata.type[i]);
+  }
+  if (this->auditordata.overflow) {
+    cc_rbptree_traverse(&this->auditordata.overflow->tree, (cc_rbptree_traversecb*)sobase_audlist_add, (void*) l);
   }
-  cc_rbptree_traverse(&this->auditortree, (cc_rbptree_traversecb*)sobase_audlist_add, (void*) l);
 
   CC_MUTEX_UNLOCK(SoBase::PImpl::auditor_mutex);
 
@@ -1236,6 +1360,15 @@ SoBase::writeHeader(SoOutput * out, SbBool isgroup, SbBool isengine) const
     }
   }
   else {
+    SoOutput_Writer * writer = SoOutput_Writer::getWriter(out);
+    if (writer->getType() == SoOutput_Writer::CHUNKEDFILE) {
+      // record the object in the table of contents of the file
+      out->checkHeader();
+      static_cast<SoOutput_ChunkedFileWriter *>(writer)->
+        addObject(SbName(this->getFileFormatName()),
+                  (name != SbName::empty() || multiref) ? writename : SbName::empty());
+    }
+
     if (name != SbName::empty() || multiref) {
       out->write(PImpl::DEF_KEYWORD);
       if (!out->isBinary()) out->write(' ');
@@ -1825,6 +1958,47 @@ DEF root Separator {
 	   newroot->unref();
  }
 
+BOOST_AUTO_TEST_CASE(checkAuditors)
+{
+  // more parents than there is room for inline in SoBase
+  const int numparents = 10;
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoSeparator * shared = new SoSeparator;
+  SoSeparator * parents[numparents];
+  for (int i = 0; i < numparents; i++) {
+    parents[i] = new SoSeparator;
+    parents[i]->addChild(shared);
+    root->addChild(parents[i]);
+  }
+
+  const SoAuditorList & auditors = shared->getAuditors();
+  BOOST_CHECK_MESSAGE(auditors.getLength() == numparents,
+                      "all parents should be auditors");
+  int found = 0;
+  for (int i = 0; i < numparents; i++) {
+    if (auditors.find(parents[i], SoNotRec::PARENT) != -1) found++;
+  }
+  BOOST_CHECK_MESSAGE(found == numparents,
+                      "all parents should be found as PARENT auditors");
+
+  for (int i = 0; i < numparents; i += 2) { parents[i]->removeChild(shared); }
+  BOOST_CHECK_MESSAGE(shared->getAuditors().getLength() == numparents / 2,
+                      "removed parents should no longer be auditors");
+
+  // notification should reach the root through all remaining parents
+  const uint32_t rootid = root->getNodeId();
+  shared->touch();
+  BOOST_CHECK_MESSAGE(root->getNodeId() != rootid,
+                      "notification should propagate to the root");
+
+  // auditors stored inline only
+  BOOST_CHECK_MESSAGE(parents[1]->getAuditors().getLength() == 1,
+                      "the root should be the only auditor");
+
+  root->unref();
+}
+
 #endif // COIN_TEST_SUITE
 
 /* *********************************************************************** */
@@ -66,13 +66,10 @@ const char SoBase::PImpl::ROUTE_KEYWORD[] = "ROUTE";
 const char SoBase::PImpl::PROTO_KEYWORD[] = "PROTO";
 const char SoBase::PImpl::EXTERNPROTO_KEYWORD[] = "EXTERNPROTO";
 
-void * SoBase::PImpl::mutex = NULL;
 void * SoBase::PImpl::name2obj_mutex = NULL;
 void * SoBase::PImpl::obj2name_mutex = NULL;
-void * SoBase::PImpl::auditor_mutex = NULL;
 void * SoBase::PImpl::global_mutex = NULL;
 
-SbHash<const SoBase *, SoAuditorList *> * SoBase::PImpl::auditordict = NULL;
 
 // Only a small number of SoBase derived objects will under usual
 // conditions have designated names, so we use a couple of static
@@ -90,6 +87,11 @@ SbBool SoBase::PImpl::trackbaseobjects = FALSE;
 void * SoBase::PImpl::allbaseobj_mutex = NULL;
 SoBaseSet * SoBase::PImpl::allbaseobj = NULL; // maps from SoBase * to NULL
 
+// The lists returned from SoBase::getAuditors(), for the objects it
+// has been called for.
+void * SoBase::PImpl::auditor_mutex = NULL;
+SbHash<const SoBase *, SoAuditorList *> * SoBase::PImpl::auditordict = NULL;
+
 SbString * SoBase::PImpl::refwriteprefix = NULL;
 
 SbBool SoBase::PImpl::tracerefs = FALSE;
@@ -109,6 +111,25 @@ SoBase::PImpl::readNode(SoInput * in)
   return (SoNode *) node;
 }
 
+// Deletes the lists returned from SoBase::getAuditors().
+void
+SoBase::PImpl::cleanup_auditordict(void)
+{
+  if (SoBase::PImpl::auditordict) {
+    for(
+       SbHash<const SoBase *, SoAuditorList *>::const_iterator iter =
+         SoBase::PImpl::auditordict->const_begin();
+       iter!=SoBase::PImpl::auditordict->const_end();
+       ++iter
+       ) {
+      delete iter->obj;
+    }
+
+    delete SoBase::PImpl::auditordict;
+    SoBase::PImpl::auditordict = NULL;
+  }
+}
+
 // Remove reference from a name to the instance pointer.
 void
 SoBase::PImpl::removeName2Obj(SoBase * const base, const char * const name)
@@ -136,24 +157,6 @@ SoBase::PImpl::removeObj2Name(SoBase * const base, const char * const COIN_UNUSE
   CC_MUTEX_UNLOCK(SoBase::PImpl::obj2name_mutex);
 }
 
-void
-SoBase::PImpl::cleanup_auditordict(void)
-{
-  if (SoBase::PImpl::auditordict) {
-    for(
-       SbHash<const SoBase *, SoAuditorList *>::const_iterator iter =
-         SoBase::PImpl::auditordict->const_begin();
-       iter!=SoBase::PImpl::auditordict->const_end();
-       ++iter
-       ) {
-      delete iter->obj;
-    }
-
-    delete SoBase::PImpl::auditordict;
-    SoBase::PImpl::auditordict = NULL;
-  }
-}
-
 void
 SoBase::PImpl::check_for_leaks(void)
 {
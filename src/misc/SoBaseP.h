@@ -33,6 +33,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 \**************************************************************************/
 
+#include <Inventor/C/base/rbptree.h>
+
 #include "misc/SbHash.h"
 
 class SoBase;
@@ -62,13 +64,10 @@ public:
   static const char PROTO_KEYWORD[];
   static const char EXTERNPROTO_KEYWORD[];
 
-  static void * mutex;
   static void * name2obj_mutex;
   static void * obj2name_mutex;
-  static void * auditor_mutex;
   static void * global_mutex;
 
-  static SbHash<const SoBase *, SoAuditorList *> * auditordict;
   static SbHash<const char *, SbPList *> * name2obj;
   static SbHash<const SoBase *, const char *> * obj2name;
 
@@ -76,6 +75,9 @@ public:
   static void * allbaseobj_mutex;
   static SoBaseSet * allbaseobj; // maps from SoBase * to NULL
 
+  static void * auditor_mutex;
+  static SbHash<const SoBase *, SoAuditorList *> * auditordict;
+
   static SbString * refwriteprefix;
   static SbBool tracerefs;
   static uint32_t writecounter;
@@ -109,4 +111,9 @@ public:
 
 }; // SoBase::PImpl
 
+// Auditors which do not fit inline in SoBase::auditordata.
+struct SoBase::AuditorOverflow {
+  cc_rbptree tree;
+};
+
 #endif // !COIN_SOBASEP_H
@@ -116,6 +116,7 @@
 #include "misc/SoDBP.h"
 #include "misc/SbHash.h"
 #include "misc/SoConfigSettings.h"
+#include "io/SoInputP.h"
 #include "rendering/SoVBO.h"
 
 #ifdef HAVE_VRML97
@@ -585,6 +586,11 @@ SoDB::read(SoInput * in, SoBase *& base)
   Returns \c FALSE on error. Returns \c TRUE with \a rootnode equal to
   \c NULL if we hit end of file instead of a new node specification in
   the file.
+
+  This method can be called repeatedly to read the top-level nodes of
+  a file one at a time, so that each can be processed and released
+  before the next is read. Use SoInput::setNodeCallback() to also get
+  the separators below the top-level nodes as soon as they are read.
  */
 SbBool
 SoDB::read(SoInput * in, SoNode *& rootnode)
@@ -658,6 +664,12 @@ SoDB::read(SoInput * in, SoNode *& rootnode)
 
   Returns \c NULL on any error.
 
+  Progress is reported as "File import" to the callbacks set up with
+  SoDB::addProgressCallback(), and the import is aborted if one of
+  them returns \c TRUE after a top-level node has been read. See
+  SoInput::setNodeCallback() for how to process the nodes while the
+  file is being read.
+
   Tip: a common operation to do after importing a scene graph is to
   pick out the memory pointers to one or more of the imported nodes
   for further handling. This can be accomplished by using either the
@@ -1231,15 +1243,25 @@ SoDB::readAllWrapper(SoInput * in, const SoType & grouptype)
 
   const int stackdepth = in->filestack.getLength();
 
+  SoInputP::beginReadAll(in);
+
   SoGroup * root = (SoGroup *)grouptype.createInstance();
   SoNode * topnode;
   do {
     if (!SoDB::read(in, topnode)) {
+      SoInputP::endReadAll(in, FALSE);
+      root->ref();
+      root->unref();
+      return NULL;
+    }
+    if (topnode && SoInputP::nodeRead(in, topnode)) { root->addChild(topnode); }
+    if (topnode && SoInputP::progress(in, TRUE)) {
+      SoReadError::post(in, "File import aborted.");
+      SoInputP::endReadAll(in, FALSE);
       root->ref();
       root->unref();
       return NULL;
     }
-    if (topnode) { root->addChild(topnode); }
   } while (topnode && in->skipWhiteSpace());
 
   if (!in->eof()) {
@@ -1285,6 +1307,8 @@ SoDB::readAllWrapper(SoInput * in, const SoType & grouptype)
   assert((stackdepth == 1 && in->filestack.getLength() == 1) ||
          (stackdepth - 1 == in->filestack.getLength()));
 
+  SoInputP::endReadAll(in, TRUE);
+
   // Strip off extra root group node if it was unnecessary (i.e. if
   // the file only had a single top-level root, and it was of the same
   // type as is requested returned).
@@ -1883,6 +1907,70 @@ BOOST_AUTO_TEST_CASE(globalfield_import)
   g->unref();
 }
 
+struct NodeCallbackData {
+  SbList<SoNode *> nodes;
+  SbList<int> depths;
+};
+
+static SbBool
+nodeCallback(void * userdata, SoInput * in, SoNode * node, int depth)
+{
+  NodeCallbackData * data = (NodeCallbackData *) userdata;
+  node->ref();
+  data->nodes.append(node);
+  data->depths.append(depth);
+  return strncmp(node->getName().getString(), "Drop", 4) != 0;
+}
+
+static SbBool
+progressCallback(const SbName & itemid, float fraction, SbBool interruptible, void * userdata)
+{
+  if (itemid == "File import") ((SbList<float> *) userdata)->append(fraction);
+  return FALSE;
+}
+
+BOOST_AUTO_TEST_CASE(readWithNodeCallback)
+{
+  static const char scene[] = "#Inventor V2.1 ascii\n"
+    "DEF A Separator { DEF B Separator { DEF C Separator { } } Cube { } DEF Drop1 Separator { } }\n"
+    "DEF D Group { DEF E Separator { } }\n"
+    "DEF Drop2 Separator { }\n";
+
+  NodeCallbackData data;
+  SbList<float> fractions;
+  SoDB::addProgressCallback(progressCallback, &fractions);
+
+  SoInput in;
+  in.setBuffer((void *) scene, strlen(scene));
+  in.setNodeCallback(nodeCallback, &data, 1);
+  SoSeparator * root = SoDB::readAll(&in);
+  SoDB::removeProgressCallback(progressCallback, &fractions);
+  BOOST_REQUIRE(root);
+  root->ref();
+
+  // nodes are passed on as soon as they are read, so children first
+  static const char * names[] = { "B", "Drop1", "A", "E", "D", "Drop2" };
+  static const int depths[] = { 1, 1, 0, 1, 0, 0 };
+  BOOST_REQUIRE_EQUAL(data.nodes.getLength(), 6);
+  for (int i = 0; i < 6; i++) {
+    BOOST_CHECK(data.nodes[i]->getName() == names[i]);
+    BOOST_CHECK_EQUAL(data.depths[i], depths[i]);
+  }
+
+  // dropped nodes are left out of the scene graph
+  BOOST_CHECK_EQUAL(root->getNumChildren(), 2);
+  SoGroup * a = (SoGroup *) SoNode::getByName("A");
+  BOOST_REQUIRE(a);
+  BOOST_CHECK_EQUAL(a->getNumChildren(), 2);
+
+  BOOST_REQUIRE(fractions.getLength() >= 2);
+  BOOST_CHECK_EQUAL(fractions[0], 0.0f);
+  BOOST_CHECK_EQUAL(fractions[fractions.getLength() - 1], 1.0f);
+
+  for (int i = 0; i < data.nodes.getLength(); i++) data.nodes[i]->unref();
+  root->unref();
+}
+
 // *************************************************************************
 
 #endif // COIN_TEST_SUITE
@@ -281,15 +281,19 @@ SoDBP::read3DSFile(SoInput * in)
 }
 
 
-void
+// Invokes the progress callbacks. Returns TRUE if any of them asks
+// for an interruptible process to be aborted.
+SbBool
 SoDBP::progress(const SbName & itemid,
                 float fraction,
                 SbBool interruptible)
 {
+  SbBool abort = FALSE;
   if (SoDBP::progresscblist != NULL) {
     for (int i = 0; i < SoDBP::progresscblist->getLength(); i++) {
       SoDBP::ProgressCallbackInfo info = (*SoDBP::progresscblist)[i];
-      info.func(itemid, fraction, interruptible, info.userdata);
+      if (info.func(itemid, fraction, interruptible, info.userdata)) abort = TRUE;
     }
   }
+  return abort && interruptible;
 }
@@ -97,9 +97,9 @@ public:
   static SbBool is3dsFile(SoInput * in);
   static SoSeparator * read3DSFile(SoInput * in);
 
-  static void progress(const SbName & itemid,
-                       float fraction,
-                       SbBool interruptible);
+  static SbBool progress(const SbName & itemid,
+                         float fraction,
+                         SbBool interruptible);
 
   struct ProgressCallbackInfo {
     SoDB::ProgressCallbackType * func;
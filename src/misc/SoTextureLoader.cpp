@@ -0,0 +1,554 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "misc/SoTextureLoader.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+#include <Inventor/SbImage.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/C/tidbits.h>
+#include <Inventor/C/threads/common.h>
+#include <Inventor/C/threads/sched.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/elements/SoViewportRegionElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/sensors/SoTimerSensor.h>
+#ifdef HAVE_THREADS
+#include <Inventor/threads/SbCondVar.h>
+#include <Inventor/threads/SbMutex.h>
+#endif // HAVE_THREADS
+
+#include "tidbitsp.h"
+#include "misc/SbHash.h"
+
+// *************************************************************************
+
+class texloader_job {
+public:
+  texloader_job(void) : images(NULL) { }
+  ~texloader_job() { delete[] this->images; }
+
+  enum State { QUEUED, DECODING, DONE };
+
+  const SoBase * owner;
+  SbList<SbString> filenames;
+  SbList<SbString> searchdirs;
+  SoTextureLoader::FinishedCB * cb;
+  void * closure;
+  SoTextureLoader::ReadCB * readcb;
+  void * readclosure;
+  float priority;
+  uint32_t schedid;
+
+  // the fields below are protected by the loader mutex once the job
+  // has been scheduled
+  State state;
+  SbBool cancelled;
+  SbImage * images;
+  size_t numbytes;
+};
+
+class SoTextureLoaderP {
+public:
+  static SoTextureLoaderP * instance(void);
+  static void cleanup(void);
+  static void sensorCB(void * closure, SoSensor * sensor);
+  static void decode(texloader_job * job);
+#ifdef HAVE_THREADS
+  static void run(void * closure);
+#endif // HAVE_THREADS
+
+  SbBool runQueued(void);
+  void deliver(void);
+  void lock(void) {
+#ifdef HAVE_THREADS
+    this->mutex.lock();
+#endif // HAVE_THREADS
+  }
+  void unlock(void) {
+#ifdef HAVE_THREADS
+    this->mutex.unlock();
+#endif // HAVE_THREADS
+  }
+
+  static SoTextureLoaderP * single;
+
+  cc_sched * sched;
+  size_t budget;
+  SbBool exiting;
+  SoTimerSensor * sensor;
+
+  // accessed only from the thread processing the sensor queue
+  SbList<texloader_job *> jobs;
+  SbHash<const SoBase *, texloader_job *> owners;
+
+  // protected by the mutex
+  SbList<texloader_job *> done;
+  size_t pendingbytes;
+#ifdef HAVE_THREADS
+  SbMutex mutex;
+  SbCondVar changed;
+#endif // HAVE_THREADS
+};
+
+SoTextureLoaderP * SoTextureLoaderP::single = NULL;
+
+// *************************************************************************
+
+SoTextureLoaderP *
+SoTextureLoaderP::instance(void)
+{
+  if (single) return single;
+
+  single = new SoTextureLoaderP;
+  single->sched = NULL;
+  single->exiting = FALSE;
+  single->pendingbytes = 0;
+
+  int megabytes = 64;
+  const char * env = coin_getenv("COIN_TEXTURE_LOADER_MEMORY");
+  if (env) { megabytes = SbMax(atoi(env), 1); }
+  single->budget = size_t(megabytes) * 1024 * 1024;
+
+#ifdef HAVE_THREADS
+  int numthreads = 2;
+  env = coin_getenv("COIN_TEXTURE_LOADER_THREADS");
+  if (env) { numthreads = SbMax(atoi(env), 0); }
+  if (numthreads > 0 && cc_thread_implementation() != CC_NO_THREADS) {
+    single->sched = cc_sched_construct(numthreads);
+  }
+#endif // HAVE_THREADS
+
+  // Finished images are picked up by polling, like SoVRMLImageTexture
+  // always did. Without threads, this is also where the images are
+  // decoded.
+  single->sensor = new SoTimerSensor(SoTextureLoaderP::sensorCB, single);
+  single->sensor->setInterval(SbTime(0.05));
+
+  coin_atexit((coin_atexit_f *) SoTextureLoaderP::cleanup, CC_ATEXIT_NORMAL);
+  return single;
+}
+
+void
+SoTextureLoaderP::cleanup(void)
+{
+  SoTextureLoaderP * thisp = single;
+  single = NULL;
+
+  thisp->lock();
+  thisp->exiting = TRUE;
+#ifdef HAVE_THREADS
+  thisp->changed.wakeAll();
+#endif // HAVE_THREADS
+  thisp->unlock();
+
+  // waits for the jobs being decoded, and drops the queued ones
+  if (thisp->sched) { cc_sched_destruct(thisp->sched); }
+
+  for (int i = 0; i < thisp->jobs.getLength(); i++) {
+    delete thisp->jobs[i];
+  }
+  delete thisp->sensor;
+  delete thisp;
+}
+
+void
+SoTextureLoaderP::decode(texloader_job * job)
+{
+  const int numdirs = job->searchdirs.getLength();
+  SbList<const SbString *> dirs(numdirs);
+  for (int i = 0; i < numdirs; i++) { dirs.append(&job->searchdirs[i]); }
+
+  const int numfiles = job->filenames.getLength();
+  job->images = new SbImage[numfiles];
+  job->numbytes = 0;
+  for (int i = 0; i < numfiles; i++) {
+    SbImage & image = job->images[i];
+    SbBool ok;
+    if (job->readcb) {
+      ok = job->readcb(job->filenames[i], &image, job->readclosure);
+    }
+    else {
+      ok = image.readFile(job->filenames[i], dirs.getArrayPtr(), numdirs);
+    }
+    if (!ok) {
+      image.setValue(SbVec3s(0, 0, 0), 0, NULL);
+      continue;
+    }
+    int nc;
+    SbVec3s size;
+    (void) image.getValue(size, nc);
+    job->numbytes += size_t(size[0]) * size_t(size[1]) *
+      size_t(SbMax(size[2], short(1))) * size_t(nc);
+  }
+}
+
+#ifdef HAVE_THREADS
+
+// the cc_sched job function
+void
+SoTextureLoaderP::run(void * closure)
+{
+  texloader_job * job = (texloader_job *) closure;
+  SoTextureLoaderP * thisp = single;
+  assert(thisp);
+
+  thisp->mutex.lock();
+  while (!job->cancelled && !thisp->exiting &&
+         thisp->pendingbytes > 0 && thisp->pendingbytes >= thisp->budget) {
+    thisp->changed.wait(thisp->mutex);
+  }
+  if (!job->cancelled && !thisp->exiting) {
+    job->state = texloader_job::DECODING;
+    thisp->mutex.unlock();
+    SoTextureLoaderP::decode(job);
+    thisp->mutex.lock();
+    thisp->pendingbytes += job->numbytes;
+  }
+  job->state = texloader_job::DONE;
+  thisp->done.append(job);
+  thisp->changed.wakeAll();
+  thisp->mutex.unlock();
+}
+
+#endif // HAVE_THREADS
+
+// Decodes queued jobs in the calling thread, when there are no
+// background threads. Returns TRUE if any job was decoded.
+SbBool
+SoTextureLoaderP::runQueued(void)
+{
+  if (this->sched) return FALSE;
+
+  // spend at most a frame's worth of time on each round, so the
+  // application stays responsive while many images are loaded
+  const SbTime start = SbTime::getTimeOfDay();
+  SbBool didrun = FALSE;
+  do {
+    texloader_job * next = NULL;
+    for (int i = 0; i < this->jobs.getLength(); i++) {
+      texloader_job * job = this->jobs[i];
+      if (job->state == texloader_job::QUEUED &&
+          (next == NULL || job->priority > next->priority)) {
+        next = job;
+      }
+    }
+    if (next == NULL) break;
+    SoTextureLoaderP::decode(next);
+    next->state = texloader_job::DONE;
+    this->done.append(next);
+    didrun = TRUE;
+  } while ((SbTime::getTimeOfDay() - start).getValue() < 1.0 / 30.0);
+  return didrun;
+}
+
+void
+SoTextureLoaderP::deliver(void)
+{
+  this->lock();
+  SbList<texloader_job *> finished(this->done);
+  this->done.truncate(0);
+  this->unlock();
+
+  for (int i = 0; i < finished.getLength(); i++) {
+    texloader_job * job = finished[i];
+    const int idx = this->jobs.find(job);
+    assert(idx >= 0);
+    this->jobs.removeFast(idx);
+
+    if (!job->cancelled) {
+      this->owners.erase(job->owner);
+      const int numfiles = job->filenames.getLength();
+      SbList<SbImage *> images(numfiles);
+      for (int j = 0; j < numfiles; j++) { images.append(&job->images[j]); }
+      job->cb(job->closure, images.getArrayPtr(), numfiles);
+    }
+
+    this->lock();
+    this->pendingbytes -= job->numbytes;
+#ifdef HAVE_THREADS
+    this->changed.wakeAll();
+#endif // HAVE_THREADS
+    this->unlock();
+    delete job;
+  }
+}
+
+void
+SoTextureLoaderP::sensorCB(void * closure, SoSensor * COIN_UNUSED_ARG(sensor))
+{
+  SoTextureLoaderP * thisp = (SoTextureLoaderP *) closure;
+  (void) thisp->runQueued();
+  thisp->deliver();
+  if (thisp->jobs.getLength() == 0) { thisp->sensor->unschedule(); }
+}
+
+// *************************************************************************
+
+/*!
+  Returns \c TRUE if texture images should be loaded through
+  SoTextureLoader, which is the case when the environment variable
+  COIN_ASYNC_TEXTURE_LOADING is set to 1. Images are read
+  synchronously by default, since applications which don't render
+  interactively, e.g. offscreen renderers and file converters, expect
+  the images to be available as soon as a scene has been read.
+
+  The variable is checked each time a texture node loads a file.
+*/
+SbBool
+SoTextureLoader::isEnabled(void)
+{
+  const char * env = coin_getenv("COIN_ASYNC_TEXTURE_LOADING");
+  return (env && atoi(env) > 0) ? TRUE : FALSE;
+}
+
+/*!
+  Schedules \a filenames to be read for \a owner, replacing any
+  pending request from \a owner. \a cb is called with one image for
+  each file when they have been read. Images which could not be read
+  are empty.
+
+  The files are read with SbImage::readFile(), searching \a
+  searchdirs, unless a \a readcb is given. Such a callback is called
+  in one of the loader threads, and the loader waits for it to return
+  if the request is cancelled while the callback runs.
+*/
+void
+SoTextureLoader::load(const SoBase * owner,
+                      const SbString * filenames, const int numfiles,
+                      const SbString * const * searchdirs, const int numdirs,
+                      FinishedCB * cb, void * closure, const float priority,
+                      ReadCB * readcb, void * readclosure)
+{
+  SoTextureLoader::cancel(owner);
+  SoTextureLoaderP * thisp = SoTextureLoaderP::instance();
+
+  texloader_job * job = new texloader_job;
+  job->owner = owner;
+  for (int i = 0; i < numfiles; i++) { job->filenames.append(filenames[i]); }
+  for (int i = 0; i < numdirs; i++) { job->searchdirs.append(*searchdirs[i]); }
+  job->cb = cb;
+  job->closure = closure;
+  job->readcb = readcb;
+  job->readclosure = readclosure;
+  job->priority = priority;
+  job->schedid = 0;
+  job->state = texloader_job::QUEUED;
+  job->cancelled = FALSE;
+  job->numbytes = 0;
+
+  thisp->jobs.append(job);
+  thisp->owners.put(owner, job);
+  if (thisp->sched) {
+    job->schedid = cc_sched_schedule(thisp->sched, SoTextureLoaderP::run,
+                                     job, priority);
+  }
+  if (!thisp->sensor->isScheduled()) { thisp->sensor->schedule(); }
+}
+
+/*!
+  Returns \c TRUE if there is a pending request from \a owner.
+*/
+SbBool
+SoTextureLoader::isLoading(const SoBase * owner)
+{
+  SoTextureLoaderP * thisp = SoTextureLoaderP::single;
+  texloader_job * job;
+  return thisp && thisp->owners.get(owner, job);
+}
+
+/*!
+  Changes the priority of the pending request from \a owner. Requests
+  with higher priorities are read first. Has no effect if the files
+  are already being read.
+*/
+void
+SoTextureLoader::setPriority(const SoBase * owner, const float priority)
+{
+  SoTextureLoaderP * thisp = SoTextureLoaderP::single;
+  texloader_job * job;
+  if (!thisp || !thisp->owners.get(owner, job)) return;
+  if (job->priority == priority) return;
+
+  job->priority = priority;
+  if (thisp->sched) {
+    cc_sched_change_priority(thisp->sched, job->schedid, priority);
+  }
+}
+
+/*!
+  Cancels the pending request from \a owner, if any. The callback
+  will not be called for a cancelled request.
+*/
+void
+SoTextureLoader::cancel(const SoBase * owner)
+{
+  SoTextureLoaderP * thisp = SoTextureLoaderP::single;
+  texloader_job * job;
+  if (!thisp || !thisp->owners.get(owner, job)) return;
+  thisp->owners.erase(owner);
+
+  thisp->lock();
+  job->cancelled = TRUE;
+  SbBool remove = FALSE;
+  if (job->state == texloader_job::QUEUED) {
+    remove = !thisp->sched || cc_sched_unschedule(thisp->sched, job->schedid);
+  }
+#ifdef HAVE_THREADS
+  // a job waiting for the memory budget must notice the cancellation
+  thisp->changed.wakeAll();
+  // a custom read callback may refer to the owner
+  while (job->readcb && job->state == texloader_job::DECODING) {
+    thisp->changed.wait(thisp->mutex);
+  }
+#endif // HAVE_THREADS
+  thisp->unlock();
+
+  // otherwise the job is deleted when delivered
+  if (remove) {
+    thisp->jobs.removeItem(job);
+    delete job;
+  }
+}
+
+/*!
+  Reads the pending request from \a owner, if any, and delivers the
+  images before returning. Texture nodes call this when an action
+  other than SoGLRenderAction needs the image, as such actions can't
+  use a placeholder.
+*/
+void
+SoTextureLoader::finish(const SoBase * owner)
+{
+  SoTextureLoaderP * thisp = SoTextureLoaderP::single;
+  texloader_job * job;
+  if (!thisp || !thisp->owners.get(owner, job)) return;
+
+  // decode the files here unless a loader thread has started on them
+  thisp->lock();
+  SbBool decodehere = FALSE;
+  if (job->state == texloader_job::QUEUED) {
+    decodehere = !thisp->sched || cc_sched_unschedule(thisp->sched, job->schedid);
+    if (decodehere) job->state = texloader_job::DECODING;
+  }
+  thisp->unlock();
+
+  if (decodehere) {
+    SoTextureLoaderP::decode(job);
+    thisp->lock();
+    thisp->pendingbytes += job->numbytes;
+    job->state = texloader_job::DONE;
+    thisp->done.append(job);
+    thisp->unlock();
+  }
+
+  // delivering the finished jobs also frees the memory budget a
+  // loader thread may be waiting for
+  while (thisp->owners.get(owner, job)) {
+    thisp->deliver();
+#ifdef HAVE_THREADS
+    thisp->mutex.lock();
+    if (thisp->owners.get(owner, job) && job->state != texloader_job::DONE) {
+      thisp->changed.wait(thisp->mutex);
+    }
+    thisp->mutex.unlock();
+#endif // HAVE_THREADS
+  }
+}
+
+/*!
+  Reads all pending requests and delivers the images before
+  returning.
+*/
+void
+SoTextureLoader::finishAll(void)
+{
+  SoTextureLoaderP * thisp = SoTextureLoaderP::single;
+  if (!thisp) return;
+
+  while (thisp->jobs.getLength()) {
+    (void) thisp->runQueued();
+    thisp->deliver();
+#ifdef HAVE_THREADS
+    thisp->mutex.lock();
+    SbBool busy = FALSE;
+    for (int i = 0; i < thisp->jobs.getLength() && !busy; i++) {
+      busy = thisp->jobs[i]->state != texloader_job::DONE;
+    }
+    if (thisp->sched && busy && thisp->done.getLength() == 0) {
+      thisp->changed.wait(thisp->mutex);
+    }
+    thisp->mutex.unlock();
+#endif // HAVE_THREADS
+  }
+  thisp->sensor->unschedule();
+}
+
+/*!
+  Returns a load priority for a texture used in \a state: the
+  approximate size, in pixels, of one unit of the current coordinate
+  system, at the current origin. Nearby and large textures get higher
+  priorities than small or distant ones.
+*/
+float
+SoTextureLoader::getPriority(SoState * state)
+{
+  const SbMatrix & mm = SoModelMatrixElement::get(state);
+  const SbViewVolume & vv = SoViewVolumeElement::get(state);
+  const SbViewportRegion & vp = SoViewportRegionElement::get(state);
+
+  SbVec3f origin, axis;
+  mm.multVecMatrix(SbVec3f(0.0f, 0.0f, 0.0f), origin);
+  float scale = 0.0f;
+  for (int i = 0; i < 3; i++) {
+    SbVec3f unit(0.0f, 0.0f, 0.0f);
+    unit[i] = 1.0f;
+    mm.multDirMatrix(unit, axis);
+    scale = SbMax(scale, axis.length());
+  }
+
+  const float worldsize = float(fabs(vv.getWorldToScreenScale(origin, 1.0f)));
+  if (worldsize <= FLT_EPSILON) return FLT_MAX;
+  const SbVec2s pixels = vp.getViewportSizePixels();
+  return scale / worldsize * float(SbMax(pixels[0], pixels[1]));
+}
@@ -0,0 +1,101 @@
+#ifndef COIN_SOTEXTURELOADER_H
+#define COIN_SOTEXTURELOADER_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+// *************************************************************************
+// This class (SoTextureLoader) is internal and must not be exposed in
+// the Coin API.
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+// *************************************************************************
+
+#include <Inventor/SbBasic.h>
+#include <Inventor/SbString.h>
+
+class SbImage;
+class SoBase;
+class SoState;
+
+// *************************************************************************
+
+// SoTextureLoader reads texture image files in background threads,
+// so texture nodes don't stall rendering while images are decoded.
+// It is used when COIN_ASYNC_TEXTURE_LOADING is set to 1.
+//
+// A request is identified by its owner, the texture node, and a new
+// request from the same owner replaces one that is still pending.
+// Requests are decoded in priority order. Texture nodes typically
+// update the priority from GLRender() with getPriority(), so the
+// textures covering most of the screen are decoded first.
+//
+// The decoded images are delivered through the callback from the
+// sensor queue, i.e. in the same thread that renders, so the owner
+// can apply them without any locking and touch() itself once to
+// trigger a redraw. Actions other than SoGLRenderAction can't render
+// a placeholder, and wait for the owner's images with finish().
+//
+// Decoded images waiting to be delivered are bounded by a memory
+// budget. When the budget is used up, decoding is paused until the
+// images have been delivered.
+
+class SoTextureLoader {
+public:
+  typedef SbBool ReadCB(const SbString & filename, SbImage * image,
+                        void * closure);
+  typedef void FinishedCB(void * closure, SbImage * const * images,
+                          const int numimages);
+
+  static SbBool isEnabled(void);
+
+  static void load(const SoBase * owner,
+                   const SbString * filenames, const int numfiles,
+                   const SbString * const * searchdirs, const int numdirs,
+                   FinishedCB * cb, void * closure,
+                   const float priority = 0.0f,
+                   ReadCB * readcb = NULL, void * readclosure = NULL);
+  static SbBool isLoading(const SoBase * owner);
+  static void setPriority(const SoBase * owner, const float priority);
+  static void cancel(const SoBase * owner);
+  static void finish(const SoBase * owner);
+  static void finishAll(void);
+
+  static float getPriority(SoState * state);
+};
+
+#endif // !COIN_SOTEXTURELOADER_H
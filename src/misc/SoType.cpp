@@ -131,6 +131,10 @@
 /*! \file SoType.h */
 #include <Inventor/SoType.h>
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
 #include <assert.h>
 #include <stdlib.h> // NULL
 #include <string.h> // strcmp()
@@ -146,6 +150,12 @@
 #include <Inventor/C/tidbits.h>
 #include <Inventor/C/glue/dl.h>
 
+#ifdef COIN_THREADSAFE
+#include <Inventor/threads/SbRWMutex.h>
+#include <Inventor/threads/SbThreadMutex.h>
+#include "threads/atomicp.h"
+#endif // COIN_THREADSAFE
+
 #include "tidbitsp.h"
 #include "misc/SbHash.h"
 
@@ -204,6 +214,87 @@ static Name2HandleMap * module_dict = NULL;
 typedef SbHash<const char *, void *> NameMap;
 static NameMap * dynload_tries = NULL;
 
+// hash map from type name (without the "So" prefix) to the classes
+// which have not been initialized yet. See SoType::deferInitClass().
+struct SoTypeDeferredData {
+  SbName parent;
+  SoType::initClassMethod method;
+};
+typedef SbHash<const char *, SoTypeDeferredData> Name2DeferredMap;
+static Name2DeferredMap * deferred_dict = NULL;
+
+#ifdef COIN_THREADSAFE
+static SbThreadMutex * deferred_mutex = NULL;
+// the number of classes in deferred_dict
+static volatile int32_t deferred_num = 0;
+// guards type_dict and the length of SoType::typedatalist against
+// types created by another thread, which may happen while there are
+// deferred classes
+static SbRWMutex * type_rwmutex = NULL;
+#define DEFERRED_LOCK deferred_mutex->lock()
+#define DEFERRED_UNLOCK deferred_mutex->unlock()
+#define TYPE_WRITE_LOCK type_rwmutex->writeLock()
+#define TYPE_WRITE_UNLOCK type_rwmutex->writeUnlock()
+#else // !COIN_THREADSAFE
+#define DEFERRED_LOCK
+#define DEFERRED_UNLOCK
+#define TYPE_WRITE_LOCK
+#define TYPE_WRITE_UNLOCK
+#endif // !COIN_THREADSAFE
+
+// While there are deferred classes, another thread may be creating
+// types by initializing one of them, so types are looked up with a
+// read lock held. Lookups from several threads still run at the same
+// time, and only wait while a type is being created. Returns TRUE if
+// the lock was taken.
+//
+// The lock must not be held while initializing a deferred class, as
+// creating its types takes the write lock.
+static SbBool
+sotype_read_lock_if_deferred(void)
+{
+#ifdef COIN_THREADSAFE
+  if (cc_atomic_load32(&deferred_num) > 0) {
+    type_rwmutex->readLock();
+    return TRUE;
+  }
+#endif // COIN_THREADSAFE
+  return FALSE;
+}
+
+static void
+sotype_read_unlock_if_deferred(const SbBool locked)
+{
+#ifdef COIN_THREADSAFE
+  if (locked) type_rwmutex->readUnlock();
+#endif // COIN_THREADSAFE
+}
+
+// The type list and dictionary are allocated with room for this many
+// types, which is well above the number of builtin types after all
+// deferred classes are initialized.
+//
+// SoType::getName(), getParent(), isDerivedFrom() and the other
+// methods called on an SoType read SoType::typedatalist without
+// locking. This is safe while types are created by other threads
+// only because an entry is not changed after it is appended (except
+// by removeType(), overrideType() and makeInternal(), which must not
+// be used on types other threads are using), and the list is not
+// reallocated as long as it holds fewer than SOTYPE_INITIAL_SIZE
+// types. SoType::createType() warns in debug
+// builds when the list has to grow while there are deferred classes.
+static const int SOTYPE_INITIAL_SIZE = 1024;
+
+// Returns the type name as it is used for builtin types, without
+// the "So" prefix.
+static SbName
+sotype_noprefix_name(const SbName & name)
+{
+  const char * str = name.getString();
+  if ((str[0] == 'S') && (str[1] == 'o')) return SbName(str + 2);
+  return name;
+}
+
 // *************************************************************************
 
 /*!
@@ -233,13 +324,18 @@ SoType::init(void)
   // SoType::init() has been called for a second time. --mortene
   assert(SoType::typedatalist == NULL);
 
-  SoType::typedatalist = new SbList<SoTypeData *>;
-  type_dict = new Name2IdMap;
+  SoType::typedatalist = new SbList<SoTypeData *>(SOTYPE_INITIAL_SIZE);
+  type_dict = new Name2IdMap(SOTYPE_INITIAL_SIZE);
 
   SoType::typedatalist->append(new SoTypeData(SbName("BadType")));
   type_dict->put(SbName("BadType").getString(), 0);
 
   dynload_tries = new NameMap;
+  deferred_dict = new Name2DeferredMap;
+#ifdef COIN_THREADSAFE
+  deferred_mutex = new SbThreadMutex;
+  type_rwmutex = new SbRWMutex(SbRWMutex::READ_PRECEDENCE);
+#endif // COIN_THREADSAFE
 }
 
 // Clean up internal resource usage.
@@ -253,6 +349,15 @@ SoType::clean(void)
   SoType::typedatalist = NULL;
   delete dynload_tries;
   dynload_tries = NULL;
+  delete deferred_dict;
+  deferred_dict = NULL;
+#ifdef COIN_THREADSAFE
+  delete deferred_mutex;
+  deferred_mutex = NULL;
+  delete type_rwmutex;
+  type_rwmutex = NULL;
+  deferred_num = 0;
+#endif // COIN_THREADSAFE
   delete type_dict;
   type_dict = NULL;
   delete module_dict;
@@ -284,7 +389,10 @@ SoType::createType(const SoType parent, const SbName name,
   // if a class type is already loaded and registered - in the public API.
   // 20040831 larsa  (ref could-have-been-used-to-fix-upgrader-slowness-bug)
   int16_t discard;
-  if (type_dict->get(name.getString(), discard)) {
+  TYPE_WRITE_LOCK;
+  const SbBool exists = type_dict->get(name.getString(), discard);
+  TYPE_WRITE_UNLOCK;
+  if (exists) {
     SoDebugError::post("SoType::createType",
                        "a type with name ``%s'' already created",
                        name.getString());
@@ -296,6 +404,19 @@ SoType::createType(const SoType parent, const SbName name,
   SoDebugError::postInfo("SoType::createType", "%s", name.getString());
 #endif // debug
 
+#if COIN_DEBUG && defined(COIN_THREADSAFE)
+  if ((SoType::typedatalist->getLength() == SOTYPE_INITIAL_SIZE) &&
+      (cc_atomic_load32(&deferred_num) > 0)) {
+    SoDebugError::postWarning("SoType::createType",
+                              "more than %d types created while there are "
+                              "deferred classes, which is not safe if "
+                              "other threads use types meanwhile. Call "
+                              "SoType::initDeferredClasses() first.",
+                              SOTYPE_INITIAL_SIZE);
+  }
+#endif // COIN_DEBUG && COIN_THREADSAFE
+
+  TYPE_WRITE_LOCK;
   SoType newType;
   newType.index = SoType::typedatalist->getLength();
   SoTypeData * typeData = new SoTypeData(name, newType, TRUE, data, parent, method);
@@ -303,6 +424,7 @@ SoType::createType(const SoType parent, const SbName name,
 
   // add to dictionary for fast lookup
   type_dict->put(name.getString(), newType.getKey());
+  TYPE_WRITE_UNLOCK;
 
   return newType;
 }
@@ -317,7 +439,9 @@ SbBool
 SoType::removeType(const SbName & name)
 {
   int16_t index = 0;
+  TYPE_WRITE_LOCK;
   if (!type_dict->get(name.getString(), index)) {
+    TYPE_WRITE_UNLOCK;
     SoDebugError::post("SoType::removeType",
                        "type with name ``%s'' not found",
                        name.getString());
@@ -327,6 +451,7 @@ SoType::removeType(const SbName & name)
   type_dict->erase(name.getString());
   SoTypeData *typedata = (*SoType::typedatalist)[index];
   (*SoType::typedatalist)[index] = NULL;
+  TYPE_WRITE_UNLOCK;
   delete typedata;
 
 #if COIN_DEBUG && 0 // debug
@@ -336,6 +461,148 @@ SoType::removeType(const SbName & name)
   return TRUE;
 }
 
+/*!
+  \typedef SoType::initClassMethod
+
+  The function signature of a class' static initClass() method.
+
+  \since Coin 4.0
+*/
+
+/*!
+  Registers the initClass() method of the class \a name, to be
+  invoked the first time the type is asked for instead of right away.
+  \a parent is the name of the class' parent class, which may itself
+  be deferred. Type names are given with or without the "So" prefix,
+  like for SoType::fromName().
+
+  The class is initialized when the type is looked up through
+  SoType::fromName() (and therefore when it is read from a file),
+  when SoType::getAllDerivedFrom() is called for one of its parent
+  classes, or when SoType::initDeferredClass() is called for it.
+  For classes using the SO_NODE_SOURCE() and SO_ENGINE_SOURCE()
+  macros, this includes calling getClassTypeId() and constructing an
+  instance.
+
+  This is used for most of the builtin node and engine classes, so
+  that SoDB::init() only has to set up the classes an application
+  actually uses. Classes which enable elements in actions, or do
+  anything else in initClass() which other classes depend on, must
+  not be deferred.
+
+  If the environment variable COIN_NO_DEFERRED_INIT_CLASS is set to a
+  positive integer, \a method is invoked immediately.
+
+  \sa initDeferredClass(), initDeferredClasses()
+  \since Coin 4.0
+*/
+void
+SoType::deferInitClass(const SbName & name, const SbName & parent,
+                       const initClassMethod method)
+{
+  static int deferinit = -1;
+  if (deferinit == -1) {
+    const char * env = coin_getenv("COIN_NO_DEFERRED_INIT_CLASS");
+    deferinit = (env && atoi(env) > 0) ? FALSE : TRUE;
+  }
+  assert(deferred_dict && "SoType static class data not yet initialized");
+  if (!deferinit) {
+    method();
+    return;
+  }
+  SoTypeDeferredData data;
+  data.parent = sotype_noprefix_name(parent);
+  data.method = method;
+  DEFERRED_LOCK;
+  if (deferred_dict->put(sotype_noprefix_name(name).getString(), data)) {
+#ifdef COIN_THREADSAFE
+    (void)cc_atomic_add32(&deferred_num, 1);
+#endif // COIN_THREADSAFE
+  }
+  DEFERRED_UNLOCK;
+}
+
+/*!
+  Initializes the class \a name if its initialization was deferred
+  with SoType::deferInitClass(). Returns \c TRUE if the class was
+  initialized, and \c FALSE if it was not deferred or has already
+  been initialized.
+
+  \since Coin 4.0
+*/
+SbBool
+SoType::initDeferredClass(const SbName & name)
+{
+  if (deferred_dict == NULL) return FALSE;
+
+  SoTypeDeferredData data;
+  DEFERRED_LOCK;
+  const char * key = sotype_noprefix_name(name).getString();
+  const SbBool found = deferred_dict->get(key, data);
+  if (found) {
+    // remove the entry first, as initClass() will look up its own
+    // class type
+    (void)deferred_dict->erase(key);
+    data.method();
+#ifdef COIN_THREADSAFE
+    // only counted out when its types have been created
+    (void)cc_atomic_add32(&deferred_num, -1);
+#endif // COIN_THREADSAFE
+  }
+  DEFERRED_UNLOCK;
+  return found;
+}
+
+/*!
+  Initializes all classes whose initialization was deferred with
+  SoType::deferInitClass(). Applications which create instances of
+  builtin classes from several threads at once may want to call this
+  after SoDB::init(), as type lookups through SoType::fromName() and
+  SoType::fromKey() take a lock, and wait for classes initialized by
+  other threads, while there are deferred classes left.
+
+  \since Coin 4.0
+*/
+void
+SoType::initDeferredClasses(void)
+{
+  if (deferred_dict == NULL) return;
+
+  DEFERRED_LOCK;
+  SbList<const char *> keys;
+  deferred_dict->makeKeyList(keys);
+  for (int i = 0; i < keys.getLength(); i++) {
+    (void)SoType::initDeferredClass(keys[i]);
+  }
+  DEFERRED_UNLOCK;
+}
+
+// Initializes the deferred classes which are derived from the
+// initialized type \a type.
+static void
+sotype_init_deferred_derived_from(const SoType type)
+{
+  if ((deferred_dict == NULL) || (deferred_dict->getNumElements() == 0)) return;
+
+  DEFERRED_LOCK;
+  SbList<const char *> keys;
+  deferred_dict->makeKeyList(keys);
+  for (int i = 0; i < keys.getLength(); i++) {
+    // follow the parents up to the first initialized class
+    SoTypeDeferredData data;
+    const char * name = keys[i];
+    while (deferred_dict->get(name, data)) name = data.parent.getString();
+    int16_t index;
+    const SbBool locked = sotype_read_lock_if_deferred();
+    const SbBool initialized = type_dict->get(name, index);
+    sotype_read_unlock_if_deferred(locked);
+    if (initialized && SoType::fromKey(index).isDerivedFrom(type)) {
+      (void)SoType::initDeferredClass(keys[i]);
+    }
+  }
+  DEFERRED_UNLOCK;
+}
+
 /*!
   This method makes a new class's instantiation method override
   the instantiation method of an existing class.
@@ -526,8 +793,22 @@ SoType::fromName(const SbName name)
   SbName noprefixname(tmp);
 
   int16_t index = 0;
-  if (!type_dict->get(name.getString(), index) &&
-      !type_dict->get(noprefixname.getString(), index)) {
+  SbBool locked = sotype_read_lock_if_deferred();
+  SbBool found =
+    type_dict->get(name.getString(), index) ||
+    type_dict->get(noprefixname.getString(), index);
+  sotype_read_unlock_if_deferred(locked);
+
+  // builtin classes may not have been initialized yet
+  if (!found && SoType::initDeferredClass(noprefixname)) {
+    locked = sotype_read_lock_if_deferred();
+    found =
+      type_dict->get(name.getString(), index) ||
+      type_dict->get(noprefixname.getString(), index);
+    sotype_read_unlock_if_deferred(locked);
+  }
+
+  if (!found) {
     if ( !SoDB::isInitialized() ) {
       return SoType::badType();
     }
@@ -640,10 +921,12 @@ SoType::fromName(const SbName name)
       initClass();
 
       // We run these tests to get the index.
-      if (!type_dict->get(name.getString(), index) &&
-          !type_dict->get(noprefixname.getString(), index)) {
-        assert(0 && "how did this happen?");
-      }
+      locked = sotype_read_lock_if_deferred();
+      found =
+        type_dict->get(name.getString(), index) ||
+        type_dict->get(noprefixname.getString(), index);
+      sotype_read_unlock_if_deferred(locked);
+      assert(found && "how did this happen?");
     }
   }
 
@@ -660,10 +943,13 @@ SoType::fromName(const SbName name)
 SoType
 SoType::fromKey(uint16_t key)
 {
+  const SbBool locked = sotype_read_lock_if_deferred();
   assert(SoType::typedatalist);
   assert(key < SoType::typedatalist->getLength());
 
-  return (*SoType::typedatalist)[(int)key]->type;
+  const SoType type = (*SoType::typedatalist)[(int)key]->type;
+  sotype_read_unlock_if_deferred(locked);
+  return type;
 }
 
 /*!
@@ -773,6 +1059,10 @@ SoType::isDerivedFrom(const SoType parent) const
   NB: do not write code which depends in any way on the order of the
   elements returned in \a list.
 
+  Classes derived from \a type whose initialization has been deferred
+  (see SoType::deferInitClass()) are initialized first, so they are
+  included in \a list.
+
   Here is a small, stand-alone example which shows how this method can
   be used for introspection, listing all subclasses of the SoBase
   superclass:
@@ -815,6 +1105,16 @@ SoType::getAllDerivedFrom(const SoType type, SoTypeList & list)
 {
   assert(type != SoType::badType() && "argument is badType()");
 
+  sotype_init_deferred_derived_from(type);
+  return SoType::getAllInitializedDerivedFrom(type, list);
+}
+
+// Like getAllDerivedFrom(), but without initializing deferred
+// classes. Used by SoActionMethodList, which is set up again when
+// new types are created anyway.
+int
+SoType::getAllInitializedDerivedFrom(const SoType type, SoTypeList & list)
+{
   int counter = 0;
   int n = SoType::typedatalist->getLength();
   for (int i = 0; i < n; i++) {
@@ -967,6 +1267,7 @@ SoType::isInternal(void) const
 #include <Inventor/SoType.h>
 #include <Inventor/SbName.h>
 #include <Inventor/nodes/SoNode.h>
+#include <Inventor/lists/SoTypeList.h>
 
 static void * createInstance(void)
 {
@@ -987,4 +1288,39 @@ BOOST_AUTO_TEST_CASE(testRemoveType)
                       "Type didn't deregister correctly");
 }
 
+static void initDeferredParent(void)
+{
+  (void)SoType::createType(SoNode::getClassTypeId(), SbName("MyDeferredParent"), createInstance, 0);
+}
+
+static void initDeferredChild(void)
+{
+  SoType parent = SoType::fromName(SbName("MyDeferredParent"));
+  (void)SoType::createType(parent, SbName("MyDeferredChild"), createInstance, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testDeferInitClass)
+{
+  SoType::deferInitClass(SbName("MyDeferredParent"), SbName("SoNode"), initDeferredParent);
+  SoType::deferInitClass(SbName("MyDeferredChild"), SbName("MyDeferredParent"), initDeferredChild);
+
+  SoType child = SoType::fromName(SbName("MyDeferredChild"));
+  BOOST_CHECK_MESSAGE(child != SoType::badType(),
+                      "deferred type not initialized by fromName()");
+  SoType parent = SoType::fromName(SbName("MyDeferredParent"));
+  BOOST_CHECK_MESSAGE(parent != SoType::badType() && child.isDerivedFrom(parent),
+                      "parent of deferred type not initialized");
+  BOOST_CHECK_MESSAGE(!SoType::initDeferredClass(SbName("MyDeferredChild")),
+                      "deferred type initialized twice");
+  (void)SoType::removeType(SbName("MyDeferredChild"));
+  (void)SoType::removeType(SbName("MyDeferredParent"));
+
+  SoType::deferInitClass(SbName("MyDeferredParent"), SbName("SoNode"), initDeferredParent);
+  SoTypeList list;
+  (void)SoType::getAllDerivedFrom(SoNode::getClassTypeId(), list);
+  BOOST_CHECK_MESSAGE(list.find(SoType::fromName(SbName("MyDeferredParent"))) != -1,
+                      "deferred type not initialized by getAllDerivedFrom()");
+  (void)SoType::removeType(SbName("MyDeferredParent"));
+}
+
 #endif // COIN_TEST_SUITE
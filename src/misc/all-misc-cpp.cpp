@@ -50,6 +50,11 @@
 #include "AudioTools.cpp"
 #include "CoinResources.cpp"
 #include "CoinStaticObjectInDLL.cpp"
+#include "SbIdDepthBuffer.cpp"
+#include "SbImageResize.cpp"
+#include "SbImagePyramid.cpp"
+#include "SbLassoGrid.cpp"
+#include "SbMeshDecimator.cpp"
 #include "SoAudioDevice.cpp"
 #include "SoBaseP.cpp"
 #include "SoChildList.cpp"
@@ -80,4 +85,5 @@
 #include "SoShaderGenerator.cpp"
 #include "SoState.cpp"
 #include "SoTempPath.cpp"
+#include "SoTextureLoader.cpp"
 #include "SoType.cpp"
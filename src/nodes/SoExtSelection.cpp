@@ -128,6 +128,8 @@
 #include <Inventor/misc/SoGLDriverDatabase.h>
 
 #include "nodes/SoSubNodeP.h"
+#include "misc/SbIdDepthBuffer.h"
+#include "misc/SbLassoGrid.h"
 #include "coindefs.h" // COIN_OBSOLETED()
 
 // *************************************************************************
@@ -215,6 +217,12 @@
 
   Set this field to VISIBLE_SHAPES to make only the primitives visible
   from the current viewpoint be selected.
+
+  Visibility is found with a software depth buffer covering the
+  lasso's bounding box, so VISIBLE_SHAPES selections do not need an
+  OpenGL context. Set the environment variable
+  COIN_EXTSELECTION_USE_OFFSCREENRENDERER to a positive integer to use
+  OpenGL offscreen rendering instead.
 */
 
 // *************************************************************************
@@ -276,6 +284,7 @@ public:
   SbViewportRegion curvp;
 
   static SbBool debug(void);
+  static SbBool useOffscreenRenderer(void);
 
   void handleEventRectangle(SoHandleEventAction * action);
   void handleEventLasso(SoHandleEventAction * action);
@@ -349,8 +358,21 @@ public:
                       SoCallbackAction * action,
                       const SoPrimitiveVertex * v);
 
+  SbBool primitivesDone(const SbBool hasfiltercb);
+  SbBool insideLasso(const SoPrimitiveVertex * const * v, const int num) const;
+  SbBool invokePrimitiveFilter(SoCallbackAction * action,
+                               const SoPrimitiveVertex * const * v,
+                               const int num) const;
+  void addPrimitiveToIdBuffer(SoCallbackAction * action,
+                              const SoPrimitiveVertex * const * v,
+                              const int num);
+  void testVisiblePrimitive(SoCallbackAction * action,
+                            const SoPrimitiveVertex * const * v,
+                            const int num);
+
   void selectAndReset(SoHandleEventAction * action);
   void performSelection(SoHandleEventAction * action);
+  void performSoftwareSelection(SoHandleEventAction * action);
 
   void validateViewportBBox(SbBox2s & bbox, 
                             const SbVec2s & vpsize);
@@ -408,7 +430,6 @@ public:
     SbVec2s vpsize;
     SbBool abort;
     SbBool allhit;
-    SbBool onlyrect;
     SbBool allshapes;
     SbBool hasgeometry;
   } primcbdata_t;
@@ -454,6 +475,18 @@ public:
   SbBool somefacesvisible;
   SoPathList dummypathlist;
 
+  // The lasso, set up for fast point, line and triangle queries.
+  SbLassoGrid lassogrid;
+
+  // State for resolving VISIBLE_SHAPES without OpenGL. All primitives
+  // are first rasterized into the id buffer, with ids handed out in
+  // traversal order. The second traversal hands out the same ids, and
+  // only primitives with visible ids are considered for selection.
+  enum SoftwarePass { SOFTWARE_NONE, SOFTWARE_RASTER, SOFTWARE_SELECT };
+  SoftwarePass softwarepass;
+  uint32_t softwareid;
+  SbIdDepthBuffer * idbuffer;
+
 private:
   SoExtSelection * master;
 };
@@ -471,6 +504,19 @@ SoExtSelectionP::debug(void)
   return dbg ? TRUE : FALSE;
 }
 
+// VISIBLE_SHAPES selections are resolved with a software rasterizer,
+// unless the old OpenGL offscreen rendering method has been asked for.
+SbBool
+SoExtSelectionP::useOffscreenRenderer(void)
+{
+  static int useoffscreen = -1;
+  if (useoffscreen == -1) {
+    const char * env = coin_getenv("COIN_EXTSELECTION_USE_OFFSCREENRENDERER");
+    useoffscreen = env && (atoi(env) > 0);
+  }
+  return useoffscreen ? TRUE : FALSE;
+}
+
 // *************************************************************************
 
 //
@@ -647,38 +693,6 @@ poly_poly_intersect(const SbList <SbVec2s> & poly1,
   return FALSE;
 }
 
-static SbBool
-poly_line_intersect(const SbList <SbVec2s> & poly,
-                    const SbVec2s & p0,
-                    const SbVec2s & p1,
-                    const SbBool checkcontained = TRUE)
-{
-  if (checkcontained && point_in_poly(poly, p0)) return TRUE;
-  if (checkcontained && point_in_poly(poly, p1)) return TRUE;
-
-  int n = poly.getLength();
-  SbVec2s prev = poly[n-1];
-  for (int i = 0; i < n; i++) {
-    if (line_line_intersect(prev, poly[i], p0, p1)) return TRUE;
-    prev = poly[i];
-  }
-  return FALSE;
-}
-
-// do a bbox rejection test before calling this method
-static SbBool
-poly_tri_intersect(const SbList <SbVec2s> & poly,
-                   const SbVec2s & v0,
-                   const SbVec2s & v1,
-                   const SbVec2s & v2)
-{
-  SbList <SbVec2s> poly2;
-  poly2.append(v0);
-  poly2.append(v1);
-  poly2.append(v2);
-  return poly_poly_intersect(poly, poly2);
-}
-
 // only used by polyprojboxintersect()
 static SbBool
 test_quad_intersect(const SbList <SbVec2s> & poly,
@@ -804,6 +818,10 @@ SoExtSelection::SoExtSelection(void)
   PRIVATE(this)->renderer = NULL;
   PRIVATE(this)->lassorenderer = NULL;
 
+  PRIVATE(this)->softwarepass = SoExtSelectionP::SOFTWARE_NONE;
+  PRIVATE(this)->softwareid = 0;
+  PRIVATE(this)->idbuffer = NULL;
+  PRIVATE(this)->visibletrianglesbitarray = NULL;
 }
 
 /*!
@@ -813,6 +831,7 @@ SoExtSelection::~SoExtSelection()
 {
   delete PRIVATE(this)->renderer;
   delete PRIVATE(this)->lassorenderer;
+  delete PRIVATE(this)->idbuffer;
   delete PRIVATE(this)->cbaction;
   delete PRIVATE(this)->visitedshapepaths;
   delete PRIVATE(this);
@@ -1441,6 +1460,11 @@ SoExtSelectionP::postShapeCallback(void * data, SoCallbackAction * action, const
 {
   SoExtSelection * ext = (SoExtSelection*)data;
 
+  // nothing is decided while filling the id buffer
+  if (PRIVATE(ext)->softwarepass == SOFTWARE_RASTER) {
+    return SoCallbackAction::CONTINUE;
+  }
+
   SbBool hit = FALSE;
   switch (ext->lassoPolicy.getValue()) {
   case SoExtSelection::FULL:
@@ -1613,7 +1637,7 @@ SoExtSelectionP::testBBox(SoCallbackAction * action,
     case SelectionState::LASSO:
       if (full) {
         for (i = 0; i < 8; i++) {
-          if (!point_in_poly(this->runningselection.coords, projpts[i])) break;
+          if (!this->lassogrid.isInside(SbVec2f(projpts[i]))) break;
         }
         if (i == 8) hit = TRUE;
       }
@@ -1672,7 +1696,6 @@ SoExtSelectionP::testPrimitives(SoCallbackAction * action,
   this->primcbdata.vporg = SoViewportRegionElement::get(action->getState()).getViewportOriginPixels();
   this->primcbdata.vpsize = SoViewportRegionElement::get(action->getState()).getViewportSizePixels();
   this->primcbdata.abort = FALSE;
-  this->primcbdata.onlyrect = (this->runningselection.mode == SelectionState::LASSO);
   this->primcbdata.hasgeometry = FALSE;
   // signal to callback action that we want to generate primitives for
   // this shape
@@ -1719,6 +1742,17 @@ SoExtSelectionP::triangleCB(void * userData,
   SoExtSelectionP * thisp = ((SoExtSelection*)userData)->pimpl;
 
   thisp->primcbdata.hasgeometry = TRUE;
+
+  const SoPrimitiveVertex * v[3] = { v1, v2, v3 };
+  if (thisp->softwarepass == SOFTWARE_RASTER) {
+    thisp->addPrimitiveToIdBuffer(action, v, 3);
+    return;
+  }
+  if (thisp->softwarepass == SOFTWARE_SELECT) {
+    thisp->testVisiblePrimitive(action, v, 3);
+    return;
+  }
+
   thisp->drawcallbackcounter++;
 
   if (!thisp->applyonlyonselectedtriangles) {
@@ -1739,71 +1773,14 @@ SoExtSelectionP::triangleCB(void * userData,
   // Increase draw counter. Used below.
   thisp->drawcounter++;
 
-  if(thisp->primcbdata.abort){
-    return;
-  }
-
+  if (thisp->primitivesDone(thisp->triangleFilterCB != NULL)) return;
 
-  if(!thisp->triangleFilterCB && thisp->primcbdata.fulltest &&
-     !thisp->primcbdata.allhit) {
-    thisp->primcbdata.abort = TRUE;
-    return;
-  }
-  if(!thisp->triangleFilterCB && !thisp->primcbdata.fulltest &&
-     thisp->primcbdata.hit) {
-    thisp->primcbdata.abort = TRUE;
+  if (!thisp->insideLasso(v, 3)) {
+    thisp->primcbdata.allhit = FALSE;
     return;
   }
 
 
-  SbVec2s p0 = project_pt(thisp->primcbdata.projmatrix, v1->getPoint(),
-                          thisp->primcbdata.vporg, thisp->primcbdata.vpsize);
-  SbVec2s p1 = project_pt(thisp->primcbdata.projmatrix, v2->getPoint(),
-                          thisp->primcbdata.vporg, thisp->primcbdata.vpsize);
-  SbVec2s p2 = project_pt(thisp->primcbdata.projmatrix, v3->getPoint(),
-                          thisp->primcbdata.vporg, thisp->primcbdata.vpsize);
-
-
-  if(thisp->primcbdata.fulltest) { // entire triangle must be inside lasso
-
-    if(thisp->runningselection.mode == SelectionState::RECTANGLE){ // Rectangle check only
-      if (!thisp->primcbdata.lassorect.intersect(p0) || (!point_in_poly(thisp->runningselection.coords, p0))) {
-        thisp->primcbdata.allhit = FALSE;
-        return;
-      }
-      if (!thisp->primcbdata.lassorect.intersect(p1) || (!point_in_poly(thisp->runningselection.coords, p1))) {
-        thisp->primcbdata.allhit = FALSE;
-        return;
-      }
-      if (!thisp->primcbdata.lassorect.intersect(p2) || (!point_in_poly(thisp->runningselection.coords, p2))) {
-        thisp->primcbdata.allhit = FALSE;
-        return;
-      }
-    }
-
-    if(poly_line_intersect(thisp->runningselection.coords, p0, p1, FALSE) || !point_in_poly(thisp->runningselection.coords, p0)) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
-    if(poly_line_intersect(thisp->runningselection.coords, p1, p2, FALSE) || !point_in_poly(thisp->runningselection.coords, p1)) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
-    if(poly_line_intersect(thisp->runningselection.coords, p2, p0, FALSE) || !point_in_poly(thisp->runningselection.coords, p2)) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
-
-
-  } else { // some part of the triangle must be inside lasso
-    if (!poly_tri_intersect(thisp->runningselection.coords, p0, p1, p2)) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
-  }
-
-
-
   if(!thisp->applyonlyonselectedtriangles){ // --- First pass
 
     if(!thisp->primcbdata.allshapes){ // LassoMode==VISIBLE_SHAPES
@@ -1936,6 +1913,17 @@ SoExtSelectionP::lineSegmentCB(void *userData,
   SoExtSelectionP * thisp = ((SoExtSelection*)userData)->pimpl;
 
   thisp->primcbdata.hasgeometry = TRUE;
+
+  const SoPrimitiveVertex * v[2] = { v1, v2 };
+  if (thisp->softwarepass == SOFTWARE_RASTER) {
+    thisp->addPrimitiveToIdBuffer(action, v, 2);
+    return;
+  }
+  if (thisp->softwarepass == SOFTWARE_SELECT) {
+    thisp->testVisiblePrimitive(action, v, 2);
+    return;
+  }
+
   thisp->drawcallbackcounter++;
 
   if (!thisp->applyonlyonselectedtriangles) {
@@ -1956,52 +1944,13 @@ SoExtSelectionP::lineSegmentCB(void *userData,
   // Increase draw counter. Used below.
   thisp->drawcounter++;
 
-  if (thisp->primcbdata.abort) return;
+  if (thisp->primitivesDone(thisp->lineFilterCB != NULL)) return;
 
-  if (!thisp->lineFilterCB && thisp->primcbdata.fulltest &&
-      !thisp->primcbdata.allhit) {
-    thisp->primcbdata.abort = TRUE;
-    return;
-  }
-  if (!thisp->lineFilterCB && !thisp->primcbdata.fulltest &&
-      thisp->primcbdata.hit) {
-    thisp->primcbdata.abort = TRUE;
+  if (!thisp->insideLasso(v, 2)) {
+    thisp->primcbdata.allhit = FALSE;
     return;
   }
 
-  SbVec2s p0 = project_pt(thisp->primcbdata.projmatrix, v1->getPoint(),
-                          thisp->primcbdata.vporg, thisp->primcbdata.vpsize);
-
-  SbVec2s p1 = project_pt(thisp->primcbdata.projmatrix, v2->getPoint(),
-                          thisp->primcbdata.vporg, thisp->primcbdata.vpsize);
-
-  if (thisp->primcbdata.fulltest) {
-
-
-    if (thisp->runningselection.mode == SelectionState::RECTANGLE){ // Rectangle check only
-      if (!thisp->primcbdata.lassorect.intersect(p0) || (!point_in_poly(thisp->runningselection.coords, p0))) {
-        thisp->primcbdata.allhit = FALSE;
-        return;
-      }
-
-      if (!thisp->primcbdata.lassorect.intersect(p1) || (!point_in_poly(thisp->runningselection.coords, p1))) {
-        thisp->primcbdata.allhit = FALSE;
-        return;
-      }
-    }
-
-    if (poly_line_intersect(thisp->runningselection.coords, p0, p1, FALSE) || !point_in_poly(thisp->runningselection.coords, p0)) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
-  }
-  else {
-    if (!poly_line_intersect(thisp->runningselection.coords, p0, p1, TRUE)) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
-  }
-
 
   if(!thisp->applyonlyonselectedtriangles){ // --- First pass
 
@@ -2102,6 +2051,16 @@ SoExtSelectionP::pointCB(void *userData,
   SoExtSelectionP * thisp = ((SoExtSelection*)userData)->pimpl;
  
   thisp->primcbdata.hasgeometry = TRUE;
+
+  if (thisp->softwarepass == SOFTWARE_RASTER) {
+    thisp->addPrimitiveToIdBuffer(action, &v, 1);
+    return;
+  }
+  if (thisp->softwarepass == SOFTWARE_SELECT) {
+    thisp->testVisiblePrimitive(action, &v, 1);
+    return;
+  }
+
   thisp->drawcallbackcounter++;
 
   if (!thisp->applyonlyonselectedtriangles) {
@@ -2122,34 +2081,9 @@ SoExtSelectionP::pointCB(void *userData,
   thisp->drawcounter++;
 
 
-  if(thisp->primcbdata.abort){
-    return;
-  }
-
-  if(!thisp->pointFilterCB && thisp->primcbdata.fulltest &&
-      !thisp->primcbdata.allhit) {
-    thisp->primcbdata.abort = TRUE;
-    return;
-  }
-  if(!thisp->pointFilterCB && !thisp->primcbdata.fulltest &&
-      thisp->primcbdata.hit) {
-    thisp->primcbdata.abort = TRUE;
-    return;
-  }
-
-
-  SbVec2s p = project_pt(thisp->primcbdata.projmatrix, v->getPoint(),
-                         thisp->primcbdata.vporg, thisp->primcbdata.vpsize);
-
-  if (thisp->runningselection.mode == SelectionState::RECTANGLE){ // Rectangle check only
-
-    SbBool onlyrect = thisp->primcbdata.onlyrect;
-    if (!thisp->primcbdata.lassorect.intersect(p) || (onlyrect || !point_in_poly(thisp->runningselection.coords, p))) {
-      thisp->primcbdata.allhit = FALSE;
-      return;
-    }
+  if (thisp->primitivesDone(thisp->pointFilterCB != NULL)) return;
 
-  } else if(!point_in_poly(thisp->runningselection.coords, p)) {
+  if (!thisp->insideLasso(&v, 1)) {
     thisp->primcbdata.allhit = FALSE;
     return;
   }
@@ -2239,6 +2173,159 @@ SoExtSelectionP::addPointToOffscreenBuffer(SoCallbackAction * action,
 }
 
 
+// Returns TRUE if the remaining primitives of the current shape can
+// be skipped, since they can no longer change whether the shape is
+// selected. This is never the case when a filter callback is set, as
+// the client wants to see all primitives.
+SbBool
+SoExtSelectionP::primitivesDone(const SbBool hasfiltercb)
+{
+  if (this->primcbdata.abort) return TRUE;
+  if (hasfiltercb) return FALSE;
+
+  if ((this->primcbdata.fulltest && !this->primcbdata.allhit) ||
+      (!this->primcbdata.fulltest && this->primcbdata.hit)) {
+    this->primcbdata.abort = TRUE;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+// Test a point (num == 1), line segment (num == 2) or triangle (num
+// == 3) against the lasso. With the FULL policy the entire primitive
+// must be inside the lasso, otherwise some part of it must be inside.
+SbBool
+SoExtSelectionP::insideLasso(const SoPrimitiveVertex * const * v,
+                             const int num) const
+{
+  SbVec2f p[3];
+  for (int i = 0; i < num; i++) {
+    p[i] = SbVec2f(project_pt(this->primcbdata.projmatrix, v[i]->getPoint(),
+                              this->primcbdata.vporg, this->primcbdata.vpsize));
+  }
+
+  const SbBool full = this->primcbdata.fulltest;
+  switch (num) {
+  case 1:
+    return this->lassogrid.isInside(p[0]);
+  case 2:
+    return full ?
+      this->lassogrid.containsSegment(p[0], p[1]) :
+      this->lassogrid.intersectsSegment(p[0], p[1]);
+  default:
+    assert(num == 3);
+    return full ?
+      this->lassogrid.containsTriangle(p[0], p[1], p[2]) :
+      this->lassogrid.intersectsTriangle(p[0], p[1], p[2]);
+  }
+}
+
+// Present a primitive to the client through the filter callback for
+// its primitive type. Returns TRUE if the primitive was accepted.
+SbBool
+SoExtSelectionP::invokePrimitiveFilter(SoCallbackAction * action,
+                                       const SoPrimitiveVertex * const * v,
+                                       const int num) const
+{
+  switch (num) {
+  case 1:
+    return this->pointFilterCB(this->pointFilterCBData, action, v[0]);
+  case 2:
+    return this->lineFilterCB(this->lineFilterCBData, action, v[0], v[1]);
+  default:
+    assert(num == 3);
+    return this->triangleFilterCB(this->triangleFilterCBData, action,
+                                  v[0], v[1], v[2]);
+  }
+}
+
+// First pass of a VISIBLE_SHAPES selection without OpenGL: rasterize
+// the primitive into the id buffer. All primitives are added, also
+// the ones outside the lasso, as they can still hide other
+// primitives.
+void
+SoExtSelectionP::addPrimitiveToIdBuffer(SoCallbackAction * action,
+                                        const SoPrimitiveVertex * const * v,
+                                        const int num)
+{
+  const uint32_t id = this->softwareid++;
+
+  SbVec4f c[3];
+  for (int i = 0; i < num; i++) {
+    const SbVec3f & p = v[i]->getPoint();
+    this->primcbdata.projmatrix.multVecMatrix(SbVec4f(p[0], p[1], p[2], 1.0f), c[i]);
+  }
+
+  SoState * state = action->getState();
+  switch (num) {
+  case 1:
+    this->idbuffer->addPoint(c[0], SoPointSizeElement::get(state), id);
+    break;
+  case 2:
+    this->idbuffer->addLine(c[0], c[1], id);
+    break;
+  default:
+    {
+      assert(num == 3);
+      // cull back faces the same way addTriangleToOffscreenBuffer()
+      // sets up OpenGL to do it
+      SoShapeHintsElement::VertexOrdering vertexorder;
+      SoShapeHintsElement::ShapeType shapetype;
+      SoShapeHintsElement::FaceType facetype;
+      SoShapeHintsElement::get(state, vertexorder, shapetype, facetype);
+
+      SbIdDepthBuffer::CullMode cull = SbIdDepthBuffer::CULL_NONE;
+      if (shapetype == SoShapeHintsElement::SOLID) {
+        if (vertexorder == SoShapeHintsElement::CLOCKWISE) {
+          cull = SbIdDepthBuffer::CULL_COUNTERCLOCKWISE;
+        }
+        else if (vertexorder == SoShapeHintsElement::COUNTERCLOCKWISE) {
+          cull = SbIdDepthBuffer::CULL_CLOCKWISE;
+        }
+      }
+      this->idbuffer->addTriangle(c[0], c[1], c[2], id, cull);
+    }
+    break;
+  }
+}
+
+// Second pass of a VISIBLE_SHAPES selection without OpenGL: test the
+// primitive against the lasso, and accept it if it was visible inside
+// the lasso after the first pass.
+void
+SoExtSelectionP::testVisiblePrimitive(SoCallbackAction * action,
+                                      const SoPrimitiveVertex * const * v,
+                                      const int num)
+{
+  // ids are handed out in traversal order, so an id must be used up
+  // even when the primitive is skipped
+  const uint32_t id = this->softwareid++;
+
+  SbBool hasfiltercb;
+  switch (num) {
+  case 1: hasfiltercb = this->pointFilterCB != NULL; break;
+  case 2: hasfiltercb = this->lineFilterCB != NULL; break;
+  default: hasfiltercb = this->triangleFilterCB != NULL; break;
+  }
+
+  if (this->primitivesDone(hasfiltercb)) return;
+
+  if (!this->insideLasso(v, num)) {
+    this->primcbdata.allhit = FALSE;
+    return;
+  }
+  if (!(this->visibletrianglesbitarray[id >> 3] & (0x1 << (id & 0x07)))) return;
+
+  this->somefacesvisible = TRUE;
+  if (!hasfiltercb) {
+    this->primcbdata.hit = TRUE;
+  }
+  else if (this->invokePrimitiveFilter(action, v, num)) {
+    this->primcbdata.hit = TRUE;
+    this->primcbdata.allhit = TRUE;
+  }
+}
+
 // invoke selection policy on a shape
 void
 SoExtSelectionP::doSelect(const SoPath * path)
@@ -2572,6 +2659,7 @@ SoExtSelectionP::performSelection(SoHandleEventAction * action)
     this->runningselection.coords.append(p1);
     this->runningselection.coords.append(SbVec2s(p0[0], p1[1]));
   }
+  this->lassogrid.setPolygon(this->runningselection.coords);
 
   //Send signal to client that tris are coming up,
   PUBLIC(this)->startCBList->invokeCallbacks(PUBLIC(this));
@@ -2603,6 +2691,9 @@ SoExtSelectionP::performSelection(SoHandleEventAction * action)
     this->cbaction->apply(action->getCurPath()->getHead());
 
   }
+  else if (!SoExtSelectionP::useOffscreenRenderer()) {
+    this->performSoftwareSelection(action);
+  }
   else {
 
     //
@@ -2751,6 +2842,60 @@ SoExtSelectionP::performSelection(SoHandleEventAction * action)
   PUBLIC(this)->touch();
 }
 
+// Find the visible primitives inside the lasso without using OpenGL.
+//
+// The scene is traversed twice. The first traversal rasterizes all
+// primitives into a software id and depth buffer covering the lasso
+// bounding box, after which the ids visible inside the lasso are
+// collected. The second traversal does the lasso tests, and only lets
+// primitives with visible ids through to the filter callbacks.
+void
+SoExtSelectionP::performSoftwareSelection(SoHandleEventAction * action)
+{
+  SoNode * root = action->getCurPath()->getHead();
+  primcbdata.allshapes = FALSE;
+
+  // visibility is not taken into account for the bounding box
+  // policies, so the primitives will never be needed
+  const int policy = PUBLIC(this)->lassoPolicy.getValue();
+  if (policy == SoExtSelection::FULL_BBOX ||
+      policy == SoExtSelection::PART_BBOX) {
+    this->cbaction->apply(root);
+    return;
+  }
+
+  SbBox2s rectbbox;
+  for (int i = 0; i < this->runningselection.coords.getLength(); i++) {
+    rectbbox.extendBy(this->runningselection.coords[i]);
+  }
+  this->validateViewportBBox(rectbbox, this->curvp.getViewportSizePixels());
+
+  if (this->idbuffer == NULL) { this->idbuffer = new SbIdDepthBuffer; }
+  this->idbuffer->setRegion(this->curvp.getViewportOriginPixels(),
+                            this->curvp.getViewportSizePixels(),
+                            rectbbox);
+
+  this->softwarepass = SOFTWARE_RASTER;
+  this->softwareid = 1;
+  this->cbaction->apply(root);
+
+  const uint32_t numids = this->softwareid;
+  const size_t numbytes = (numids + 7) / 8;
+  this->visibletrianglesbitarray = new unsigned char[numbytes];
+  (void)memset(this->visibletrianglesbitarray, 0, numbytes);
+
+  if (this->idbuffer->markVisible(this->lassogrid,
+                                  this->visibletrianglesbitarray, numids) > 0) {
+    this->softwarepass = SOFTWARE_SELECT;
+    this->softwareid = 1;
+    this->cbaction->apply(root);
+  }
+
+  this->softwarepass = SOFTWARE_NONE;
+  delete [] this->visibletrianglesbitarray;
+  this->visibletrianglesbitarray = NULL;
+}
+
 //
 // avoid an empty viewport bbox (support for a single click and 
 // a 1-pixel-size rectangles/lassos).
@@ -2775,3 +2920,142 @@ SoExtSelectionP::validateViewportBBox(SbBox2s & bbox,
 
 #undef PRIVATE
 #undef PUBLIC
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoHandleEventAction.h>
+#include <Inventor/events/SoMouseButtonEvent.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoOrthographicCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+// Sets up an orthographic view where one unit is ten pixels, with a
+// cube in front of another cube to the left, and a third cube to the
+// right. In window coordinates the left cubes cover [20, 40] x [40,
+// 60], and the right cube covers [70, 90] x [40, 60].
+static SoExtSelection *
+extsel_make_scene(SoCube * cubes[3])
+{
+  SoExtSelection * sel = new SoExtSelection;
+  sel->ref();
+
+  SoOrthographicCamera * camera = new SoOrthographicCamera;
+  camera->position = SbVec3f(0.0f, 0.0f, 10.0f);
+  camera->height = 10.0f;
+  camera->nearDistance = 1.0f;
+  camera->farDistance = 30.0f;
+  sel->addChild(camera);
+
+  const SbVec3f pos[3] = {
+    SbVec3f(-2.0f, 0.0f, 0.0f), SbVec3f(-2.0f, 0.0f, -5.0f), SbVec3f(3.0f, 0.0f, 0.0f)
+  };
+  for (int i = 0; i < 3; i++) {
+    SoSeparator * sep = new SoSeparator;
+    SoTranslation * t = new SoTranslation;
+    t->translation = pos[i];
+    cubes[i] = new SoCube;
+    sep->addChild(t);
+    sep->addChild(cubes[i]);
+    sel->addChild(sep);
+  }
+  return sel;
+}
+
+static void
+extsel_send_button(SoNode * root, const SoMouseButtonEvent::Button button,
+                   const SoButtonEvent::State state, const SbVec2s & pos)
+{
+  SbViewportRegion vp(100, 100);
+  SoMouseButtonEvent ev;
+  ev.setButton(button);
+  ev.setState(state);
+  ev.setPosition(pos);
+  SoHandleEventAction ha(vp);
+  ha.setEvent(&ev);
+  ha.apply(root);
+}
+
+static void
+extsel_select_rectangle(SoExtSelection * sel, const SbVec2s & p0, const SbVec2s & p1)
+{
+  sel->lassoType = SoExtSelection::RECTANGLE;
+  extsel_send_button(sel, SoMouseButtonEvent::BUTTON1, SoButtonEvent::DOWN, p0);
+  extsel_send_button(sel, SoMouseButtonEvent::BUTTON1, SoButtonEvent::UP, p1);
+}
+
+static void
+extsel_select_lasso(SoExtSelection * sel, const SbVec2s * coords, const int num)
+{
+  sel->lassoType = SoExtSelection::LASSO;
+  for (int i = 0; i < num - 1; i++) {
+    extsel_send_button(sel, SoMouseButtonEvent::BUTTON1, SoButtonEvent::DOWN, coords[i]);
+  }
+  extsel_send_button(sel, SoMouseButtonEvent::BUTTON2, SoButtonEvent::DOWN, coords[num - 1]);
+}
+
+static SbBool
+extsel_is_selected(SoSelection * sel, SoNode * node)
+{
+  for (int i = 0; i < sel->getNumSelected(); i++) {
+    if (sel->getPath(i)->getTail() == node) return TRUE;
+  }
+  return FALSE;
+}
+
+BOOST_AUTO_TEST_CASE(visibleShapesWithoutGL)
+{
+  SoCube * cubes[3];
+  SoExtSelection * sel = extsel_make_scene(cubes);
+  sel->lassoMode = SoExtSelection::VISIBLE_SHAPES;
+  sel->lassoPolicy = SoExtSelection::PART;
+
+  extsel_select_rectangle(sel, SbVec2s(15, 15), SbVec2s(95, 85));
+  BOOST_CHECK_MESSAGE(sel->getNumSelected() == 2, "expected two visible shapes");
+  BOOST_CHECK_MESSAGE(extsel_is_selected(sel, cubes[0]), "front cube not selected");
+  BOOST_CHECK_MESSAGE(!extsel_is_selected(sel, cubes[1]), "hidden cube selected");
+  BOOST_CHECK_MESSAGE(extsel_is_selected(sel, cubes[2]), "right cube not selected");
+
+  // the entire front cube is inside this rectangle
+  sel->lassoPolicy = SoExtSelection::FULL;
+  extsel_select_rectangle(sel, SbVec2s(15, 35), SbVec2s(45, 65));
+  BOOST_CHECK_MESSAGE(sel->getNumSelected() == 1 && extsel_is_selected(sel, cubes[0]),
+                      "expected only the front cube");
+
+  sel->lassoMode = SoExtSelection::ALL_SHAPES;
+  sel->lassoPolicy = SoExtSelection::PART;
+  extsel_select_rectangle(sel, SbVec2s(15, 15), SbVec2s(95, 85));
+  BOOST_CHECK_MESSAGE(sel->getNumSelected() == 3, "expected all shapes");
+
+  sel->unref();
+}
+
+BOOST_AUTO_TEST_CASE(concaveLasso)
+{
+  SoCube * cubes[3];
+  SoExtSelection * sel = extsel_make_scene(cubes);
+  sel->lassoMode = SoExtSelection::ALL_SHAPES;
+
+  // a U-shaped lasso around the right cube, with a notch cutting into
+  // the top of the cube
+  const SbVec2s lasso[] = {
+    SbVec2s(65, 30), SbVec2s(95, 30), SbVec2s(95, 70), SbVec2s(85, 70),
+    SbVec2s(85, 45), SbVec2s(75, 45), SbVec2s(75, 70), SbVec2s(65, 70)
+  };
+  const int num = sizeof(lasso) / sizeof(lasso[0]);
+
+  sel->lassoPolicy = SoExtSelection::PART;
+  extsel_select_lasso(sel, lasso, num);
+  BOOST_CHECK_MESSAGE(sel->getNumSelected() == 1 && extsel_is_selected(sel, cubes[2]),
+                      "expected only the right cube");
+
+  sel->lassoPolicy = SoExtSelection::FULL;
+  extsel_select_lasso(sel, lasso, num);
+  BOOST_CHECK_MESSAGE(sel->getNumSelected() == 0,
+                      "the notch should keep the right cube from being selected");
+
+  sel->unref();
+}
+
+#endif // COIN_TEST_SUITE
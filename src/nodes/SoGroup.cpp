@@ -212,6 +212,7 @@
 #include "rendering/SoGL.h"
 #include "glue/glp.h"
 #include "io/SoWriterefCounter.h"
+#include "io/SoInputP.h"
 
 #include <Inventor/annex/Profiler/SoProfiler.h>
 #include "profiler/SoNodeProfiling.h"
@@ -355,17 +356,20 @@ SoGroup::readChildren(SoInput * in)
     return FALSE;
   }
 
+  SoInputP::pushGroup(in);
   for (unsigned int i=0; !in->isBinary() || (i < numchildren); i++) {
     SoBase * child;
     if (SoBase::read(in, child, SoNode::getClassTypeId())) {
       if (child == NULL) {
 	if (in->eof()) {
 	  SoReadError::post(in, "Premature end of file");
+	  SoInputP::popGroup(in);
 	  return FALSE;
 	}
 	else {
 	  if (in->isBinary()) {
 	    SoReadError::post(in, "Couldn't read valid identifier name");
+	    SoInputP::popGroup(in);
 	    return FALSE;
 	  }
 
@@ -377,10 +381,11 @@ SoGroup::readChildren(SoInput * in)
 	  }
 #endif // debug
 	  // Completed reading of children for ASCII format import.
+	  SoInputP::popGroup(in);
 	  return TRUE;
 	}
       }
-      else {
+      else if (SoInputP::nodeRead(in, (SoNode *)child)) {
 	this->addChild((SoNode *)child);
       }
     }
@@ -388,12 +393,14 @@ SoGroup::readChildren(SoInput * in)
       // SoReadError::post() is called within the SoBase::read()
       // frame upon error conditions, so don't duplicate with
       // another error message here.  mortene.
+      SoInputP::popGroup(in);
       return FALSE;
     }
   }
 
   // A successful import operation for binary format reading of child
   // nodes will exit here.
+  SoInputP::popGroup(in);
   return TRUE;
 }
 
@@ -0,0 +1,816 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SoInstancedCopy SoInstancedCopy.h Inventor/nodes/SoInstancedCopy.h
+  \brief The SoInstancedCopy class draws its children at a large number of positions.
+  \ingroup nodes
+
+  SoInstancedCopy is meant for scenes where the same piece of
+  geometry is repeated a very large number of times, like the bolts
+  of a big assembly or the trees of a forest. It is similar to
+  SoMultipleCopy, but the children are assumed to look the same for
+  every instance, which makes it possible to share most of the work
+  between the instances:
+
+  <ul>
+
+  <li>The bounding box of the children is calculated (and cached)
+  only once, and the bounding box of the node is found by
+  transforming it once per instance.</li>
+
+  <li>When rendering, instances that are outside the view volume are
+  culled individually before any of the children are traversed. The
+  children are compiled into a single OpenGL display list, which is
+  replayed for each visible instance with only the instance
+  transformation sent in between.</li>
+
+  <li>When picking, only the instances whose bounding box is hit by
+  the pick ray are traversed. The index of the instance that was hit
+  is stored as an SoInstanceDetail for this node in the
+  SoPickedPoint.</li>
+
+  <li>SoGetPrimitiveCountAction traverses the children once and
+  multiplies the result by the number of instances.</li>
+
+  </ul>
+
+  The instance transformations can be given either as matrices in
+  the SoInstancedCopy::matrix field, or as separate translation,
+  rotation and scale values. If the SoInstancedCopy::matrix field
+  contains any values, the other three fields are ignored.
+
+  Unlike SoMultipleCopy, this node does not set SoSwitchElement
+  while traversing the children, so an SoSwitch below it with
+  whichChild set to SO_SWITCH_INHERIT can not be used to make the
+  instances differ.
+
+  <b>FILE FORMAT/DEFAULTS:</b>
+  \code
+    InstancedCopy {
+        matrix [  ]
+        translation 0 0 0
+        rotation [  ]
+        scaleFactor [  ]
+    }
+  \endcode
+
+  \sa SoMultipleCopy, SoArray, SoInstanceDetail
+  \COIN_CLASS_EXTENSION
+  \since Coin 4.0
+*/
+
+// *************************************************************************
+
+#include <Inventor/nodes/SoInstancedCopy.h>
+
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/caches/SoBoundingBoxCache.h>
+#include <Inventor/caches/SoGLCacheList.h>
+#include <Inventor/details/SoInstanceDetail.h>
+#include <Inventor/elements/SoCacheElement.h>
+#include <Inventor/elements/SoCullElement.h>
+#include <Inventor/elements/SoLocalBBoxMatrixElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoSwitchElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/lists/SoPickedPointList.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSwitch.h> // SO_SWITCH_ALL
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoFullPath.h>
+#include <Inventor/threads/SbStorage.h>
+
+#ifdef COIN_THREADSAFE
+#include <Inventor/threads/SbMutex.h>
+#endif // COIN_THREADSAFE
+
+#include "nodes/SoSubNodeP.h"
+
+// *************************************************************************
+
+/*!
+  \var SoMFMatrix SoInstancedCopy::matrix
+
+  The transformation matrices of the instances. If this field
+  contains any values, there will be one instance per matrix, and the
+  SoInstancedCopy::translation, SoInstancedCopy::rotation and
+  SoInstancedCopy::scaleFactor fields are ignored.
+
+  The field is empty by default.
+*/
+
+/*!
+  \var SoMFVec3f SoInstancedCopy::translation
+
+  Per-instance translations. Used only when SoInstancedCopy::matrix
+  is empty.
+
+  The number of instances is the number of values in the longest of
+  the SoInstancedCopy::translation, SoInstancedCopy::rotation and
+  SoInstancedCopy::scaleFactor fields. If a field has fewer values,
+  its last value is used for the remaining instances, and an empty
+  field does not contribute to the instance transformations.
+
+  The default value is a single translation of [0, 0, 0], ie a single
+  untransformed instance.
+*/
+
+/*!
+  \var SoMFRotation SoInstancedCopy::rotation
+
+  Per-instance rotations. Used only when SoInstancedCopy::matrix is
+  empty. The field is empty by default.
+*/
+
+/*!
+  \var SoMFVec3f SoInstancedCopy::scaleFactor
+
+  Per-instance scale factors. Used only when SoInstancedCopy::matrix
+  is empty. The field is empty by default.
+*/
+
+// *************************************************************************
+
+// when doing threadsafe rendering, each thread needs its own
+// glcachelist
+typedef struct {
+  SoGLCacheList * glcachelist;
+} soinstancedcopy_storage;
+
+static void
+soinstancedcopy_storage_construct(void * data)
+{
+  soinstancedcopy_storage * ptr = (soinstancedcopy_storage*) data;
+  ptr->glcachelist = NULL;
+}
+
+static void
+soinstancedcopy_storage_destruct(void * data)
+{
+  soinstancedcopy_storage * ptr = (soinstancedcopy_storage*) data;
+  delete ptr->glcachelist;
+}
+
+// *************************************************************************
+
+class SoInstancedCopyP {
+public:
+  SoInstancedCopyP(void)
+    : bboxcache(NULL),
+      matricesvalid(FALSE),
+      instancesboxvalid(FALSE)
+  {
+    this->glcachestorage =
+      new SbStorage(sizeof(soinstancedcopy_storage),
+                    soinstancedcopy_storage_construct,
+                    soinstancedcopy_storage_destruct);
+  }
+  ~SoInstancedCopyP() {
+    if (this->bboxcache) this->bboxcache->unref();
+    delete this->glcachestorage;
+  }
+
+  SoInstancedCopy * master;
+
+  // bounding box of the children, in the space of this node
+  SoBoundingBoxCache * bboxcache;
+
+  // the instance transformations, calculated from the fields
+  SbList<SbMatrix> matrices;
+  SbBool matricesvalid;
+
+  // union and average center of the transformed children bboxes
+  SbBox3f instancesbox;
+  SbVec3f instancescenter;
+  SbBool instancesboxvalid;
+
+#ifdef COIN_THREADSAFE
+  SbMutex mutex;
+#endif // COIN_THREADSAFE
+  SbStorage * glcachestorage;
+  static void invalidate_gl_cache(void * tls, void *) {
+    soinstancedcopy_storage * ptr = (soinstancedcopy_storage*) tls;
+    if (ptr->glcachelist) {
+      ptr->glcachelist->invalidateAll();
+    }
+  }
+
+  SoGLCacheList * getGLCacheList(SbBool createifnull);
+  void invalidateGLCaches(void) {
+    this->glcachestorage->applyToAll(invalidate_gl_cache, NULL);
+  }
+
+  const SbMatrix * getMatrices(int & num);
+  SbBool getChildrenBox(SoState * state, SbBox3f & box);
+  void tagPickedPoints(SoRayPickAction * action, const int instance,
+                       const int first);
+
+  void lock(void) {
+#ifdef COIN_THREADSAFE
+    this->mutex.lock();
+#endif // COIN_THREADSAFE
+  }
+  void unlock(void) {
+#ifdef COIN_THREADSAFE
+    this->mutex.unlock();
+#endif // COIN_THREADSAFE
+  }
+};
+
+#define PRIVATE(obj) ((obj)->pimpl)
+#define PUBLIC(obj) ((obj)->master)
+
+// *************************************************************************
+
+SoGLCacheList *
+SoInstancedCopyP::getGLCacheList(SbBool createifnull)
+{
+  soinstancedcopy_storage * ptr =
+    (soinstancedcopy_storage*) this->glcachestorage->get();
+  if (createifnull && ptr->glcachelist == NULL) {
+    ptr->glcachelist = new SoGLCacheList(SoSeparator::getNumRenderCaches());
+  }
+  return ptr->glcachelist;
+}
+
+// Returns the instance matrices, recalculating them from the fields
+// if any of them has changed since the last call.
+const SbMatrix *
+SoInstancedCopyP::getMatrices(int & num)
+{
+  this->lock();
+  if (!this->matricesvalid) {
+    const int n = PUBLIC(this)->getNumInstances();
+    this->matrices.truncate(0);
+    for (int i = 0; i < n; i++) {
+      this->matrices.append(PUBLIC(this)->getInstanceMatrix(i));
+    }
+    this->matricesvalid = TRUE;
+  }
+  this->unlock();
+  num = this->matrices.getLength();
+  return num ? this->matrices.getArrayPtr() : NULL;
+}
+
+// Returns TRUE and the bounding box of the children if we have a
+// valid bounding box cache. The cache is updated in getBoundingBox().
+SbBool
+SoInstancedCopyP::getChildrenBox(SoState * state, SbBox3f & box)
+{
+  SbBool valid = FALSE;
+  this->lock();
+  if (this->bboxcache && this->bboxcache->isValid(state)) {
+    box = this->bboxcache->getProjectedBox();
+    valid = TRUE;
+  }
+  this->unlock();
+  return valid;
+}
+
+// Attaches an SoInstanceDetail to the picked points below this node
+// which do not have one yet, from index first of the picked point
+// list, which was its length before the instance was traversed.
+// Follows the same strategy as the nodekit details in
+// SoBaseKit::rayPick().
+void
+SoInstancedCopyP::tagPickedPoints(SoRayPickAction * action, const int instance,
+                                  const int first)
+{
+  const SoPickedPointList & pplist = action->getPickedPointList();
+  const int n = pplist.getLength();
+  // when not picking all, a closer point replaces the one in the
+  // list instead of being appended
+  for (int i = action->isPickAll() ? first : 0; i < n; i++) {
+    SoPickedPoint * pp = pplist[i];
+    SoFullPath * path = (SoFullPath*) pp->getPath();
+    if (path->containsNode(PUBLIC(this)) && pp->getDetail(PUBLIC(this)) == NULL) {
+      SoInstanceDetail * detail = new SoInstanceDetail;
+      detail->setInstanceIndex(instance);
+      pp->setDetail(detail, PUBLIC(this));
+    }
+  }
+}
+
+// *************************************************************************
+
+SO_NODE_SOURCE(SoInstancedCopy);
+
+/*!
+  Constructor.
+*/
+SoInstancedCopy::SoInstancedCopy(void)
+{
+  PRIVATE(this) = new SoInstancedCopyP;
+  PRIVATE(this)->master = this;
+
+  SO_NODE_INTERNAL_CONSTRUCTOR(SoInstancedCopy);
+
+  SO_NODE_ADD_FIELD(matrix, (SbMatrix::identity()));
+  SO_NODE_ADD_FIELD(translation, (0.0f, 0.0f, 0.0f));
+  SO_NODE_ADD_FIELD(rotation, (SbRotation::identity()));
+  SO_NODE_ADD_FIELD(scaleFactor, (1.0f, 1.0f, 1.0f));
+
+  this->matrix.setNum(0);
+  this->matrix.setDefault(TRUE);
+  this->rotation.setNum(0);
+  this->rotation.setDefault(TRUE);
+  this->scaleFactor.setNum(0);
+  this->scaleFactor.setDefault(TRUE);
+}
+
+/*!
+  Destructor.
+*/
+SoInstancedCopy::~SoInstancedCopy()
+{
+  delete PRIVATE(this);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::initClass(void)
+{
+  SO_NODE_INTERNAL_INIT_CLASS(SoInstancedCopy, SO_FROM_COIN_4_0);
+
+  // the pick method is inherited from SoPickAction unless we
+  // register rayPick() explicitly
+  SoRayPickAction::addMethod(SoInstancedCopy::getClassTypeId(), SoNode::rayPickS);
+}
+
+/*!
+  Returns the number of instances specified by the fields of this
+  node.
+*/
+int
+SoInstancedCopy::getNumInstances(void) const
+{
+  if (this->matrix.getNum() > 0) return this->matrix.getNum();
+  int n = this->translation.getNum();
+  if (this->rotation.getNum() > n) n = this->rotation.getNum();
+  if (this->scaleFactor.getNum() > n) n = this->scaleFactor.getNum();
+  return n;
+}
+
+/*!
+  Returns the transformation matrix of instance \a idx.
+*/
+SbMatrix
+SoInstancedCopy::getInstanceMatrix(const int idx) const
+{
+  assert(idx >= 0 && idx < this->getNumInstances());
+  if (this->matrix.getNum() > 0) return this->matrix[idx];
+
+  const int numt = this->translation.getNum();
+  const int numr = this->rotation.getNum();
+  const int nums = this->scaleFactor.getNum();
+
+  SbMatrix m;
+  m.setTransform(numt ? this->translation[SbMin(idx, numt-1)] : SbVec3f(0.0f, 0.0f, 0.0f),
+                 numr ? this->rotation[SbMin(idx, numr-1)] : SbRotation::identity(),
+                 nums ? this->scaleFactor[SbMin(idx, nums-1)] : SbVec3f(1.0f, 1.0f, 1.0f));
+  return m;
+}
+
+// Doc in superclass.
+SbBool
+SoInstancedCopy::affectsState(void) const
+{
+  // state is pushed/popped for each instance
+  return FALSE;
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::doAction(SoAction * action)
+{
+  SoState * state = action->getState();
+  int n;
+  const SbMatrix * m = PRIVATE(this)->getMatrices(n);
+  for (int i = 0; i < n && !action->hasTerminated(); i++) {
+    state->push();
+    SoModelMatrixElement::mult(state, this, m[i]);
+    inherited::doAction(action);
+    state->pop();
+  }
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::getBoundingBox(SoGetBoundingBoxAction * action)
+{
+  SoState * state = action->getState();
+
+  if (action->getCurPathCode() == SoAction::OFF_PATH) return;
+  if (action->getCurPathCode() == SoAction::IN_PATH ||
+      action->isInCameraSpace() || action->isResetPath()) {
+    // the instance boxes can't be shared, do it the slow way
+    SoInstancedCopy::doAction(action);
+    return;
+  }
+
+  int n;
+  const SbMatrix * m = PRIVATE(this)->getMatrices(n);
+  if (n == 0) return;
+
+  PRIVATE(this)->lock();
+  SbBool validcache =
+    PRIVATE(this)->bboxcache && PRIVATE(this)->bboxcache->isValid(state);
+  PRIVATE(this)->unlock();
+
+  if (validcache) {
+    SoCacheElement::addCacheDependency(state, PRIVATE(this)->bboxcache);
+    if (PRIVATE(this)->bboxcache->hasLinesOrPoints()) {
+      SoBoundingBoxCache::setHasLinesOrPoints(state);
+    }
+  }
+  else {
+    SbXfBox3f abox = action->getXfBoundingBox();
+    SbBool storedinvalid = SoCacheElement::setInvalid(FALSE);
+    state->push();
+
+    PRIVATE(this)->lock();
+    if (PRIVATE(this)->bboxcache) PRIVATE(this)->bboxcache->unref();
+    PRIVATE(this)->bboxcache = new SoBoundingBoxCache(state);
+    PRIVATE(this)->bboxcache->ref();
+    PRIVATE(this)->instancesboxvalid = FALSE;
+    PRIVATE(this)->unlock();
+    // set active cache to record cache dependencies
+    SoCacheElement::set(state, PRIVATE(this)->bboxcache);
+
+    SoLocalBBoxMatrixElement::makeIdentity(state);
+    action->getXfBoundingBox().makeEmpty();
+    inherited::getBoundingBox(action);
+
+    SbXfBox3f childrenbbox = action->getXfBoundingBox();
+    SbBool childrencenterset = action->isCenterSet();
+    SbVec3f childrencenter;
+    if (childrencenterset) childrencenter = action->getCenter();
+
+    action->getXfBoundingBox() = abox; // reset action bbox
+
+    PRIVATE(this)->bboxcache->set(childrenbbox, childrencenterset, childrencenter);
+    state->pop();
+    SoCacheElement::setInvalid(storedinvalid);
+  }
+
+  PRIVATE(this)->lock();
+  if (!PRIVATE(this)->instancesboxvalid) {
+    const SbBox3f & childbox = PRIVATE(this)->bboxcache->getProjectedBox();
+    const SbVec3f childcenter = PRIVATE(this)->bboxcache->isCenterSet() ?
+      PRIVATE(this)->bboxcache->getCenter() :
+      (childbox.isEmpty() ? SbVec3f(0.0f, 0.0f, 0.0f) : childbox.getCenter());
+    SbBox3f & box = PRIVATE(this)->instancesbox;
+    SbVec3f acccenter(0.0f, 0.0f, 0.0f);
+    box.makeEmpty();
+    for (int i = 0; i < n; i++) {
+      SbVec3f c;
+      m[i].multVecMatrix(childcenter, c);
+      acccenter += c;
+      if (!childbox.isEmpty()) {
+        SbBox3f tbox = childbox;
+        tbox.transform(m[i]);
+        box.extendBy(tbox);
+      }
+    }
+    PRIVATE(this)->instancescenter = acccenter / float(n);
+    PRIVATE(this)->instancesboxvalid = TRUE;
+  }
+  SbBox3f box = PRIVATE(this)->instancesbox;
+  SbVec3f center = PRIVATE(this)->instancescenter;
+  PRIVATE(this)->unlock();
+
+  if (!box.isEmpty()) {
+    action->extendBy(box);
+    action->resetCenter();
+    action->setCenter(center, TRUE);
+  }
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::GLRender(SoGLRenderAction * action)
+{
+  SoState * state = action->getState();
+
+  if (action->getCurPathCode() == SoAction::IN_PATH) {
+    SoInstancedCopy::doAction(action);
+    return;
+  }
+
+  int n;
+  const SbMatrix * m = PRIVATE(this)->getMatrices(n);
+  if (n == 0 || this->getNumChildren() == 0) return;
+
+  // Cull each instance against the view volume, unless we are being
+  // compiled into a GL cache further up in the graph.
+  SbBox3f childbox;
+  SbBool docull =
+    !state->isCacheOpen() &&
+    !SoCullElement::completelyInside(state) &&
+    PRIVATE(this)->getChildrenBox(state, childbox) &&
+    !childbox.isEmpty();
+
+  if (docull) {
+    PRIVATE(this)->lock();
+    SbBool outside = PRIVATE(this)->instancesboxvalid &&
+      SoCullElement::cullTest(state, PRIVATE(this)->instancesbox, TRUE);
+    PRIVATE(this)->unlock();
+    if (outside) return;
+  }
+
+  // Compile the children into a display list while rendering the
+  // first visible instance, and replay it for the others. If a cache
+  // is already open further up, the instances will end up in that
+  // cache instead.
+  SoGLCacheList * glcachelist = NULL;
+  if (SoSeparator::getNumRenderCaches() > 0 && !SoCacheElement::anyOpen(state)) {
+    PRIVATE(this)->lock();
+    glcachelist = PRIVATE(this)->getGLCacheList(TRUE);
+    PRIVATE(this)->unlock();
+  }
+  SbBool triedopen = FALSE;
+
+  for (int i = 0; i < n && !action->hasTerminated(); i++) {
+    if (docull) {
+      SbBox3f box = childbox;
+      box.transform(m[i]);
+      if (SoCullElement::cullTest(state, box, TRUE)) continue;
+    }
+
+    state->push();
+    SoModelMatrixElement::mult(state, this, m[i]);
+
+    if (glcachelist && glcachelist->call(action)) {
+      state->pop();
+      continue;
+    }
+
+    SbBool createcache = glcachelist && !triedopen;
+    if (createcache) {
+      glcachelist->open(action, FALSE);
+      triedopen = TRUE;
+    }
+    inherited::GLRender(action);
+    if (createcache) glcachelist->close(action);
+
+    state->pop();
+  }
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::rayPick(SoRayPickAction * action)
+{
+  SoState * state = action->getState();
+  int n;
+  const SbMatrix * m = PRIVATE(this)->getMatrices(n);
+
+  SbBox3f childbox;
+  SbBool usebox = PRIVATE(this)->getChildrenBox(state, childbox);
+  if (usebox && childbox.isEmpty()) return;
+
+  for (int i = 0; i < n && !action->hasTerminated(); i++) {
+    state->push();
+    SoModelMatrixElement::mult(state, this, m[i]);
+    if (usebox) {
+      action->setObjectSpace();
+      if (!action->intersect(childbox, TRUE)) {
+        state->pop();
+        continue;
+      }
+    }
+    const int first = action->getPickedPointList().getLength();
+    inherited::doAction(action);
+    state->pop();
+    PRIVATE(this)->tagPickedPoints(action, i, first);
+  }
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::pick(SoPickAction * action)
+{
+  SoInstancedCopy::doAction(action);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::callback(SoCallbackAction * action)
+{
+  SoInstancedCopy::doAction(action);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::audioRender(SoAudioRenderAction * action)
+{
+  SoInstancedCopy::doAction((SoAction*)action);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::handleEvent(SoHandleEventAction * action)
+{
+  inherited::handleEvent(action);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::getMatrix(SoGetMatrixAction * action)
+{
+  // path does not specify which instance to traverse
+  inherited::getMatrix(action);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::search(SoSearchAction * action)
+{
+  SoState * state = action->getState();
+  state->push();
+  SoSwitchElement::set(state, SO_SWITCH_ALL);
+  inherited::search(action);
+  state->pop();
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::getPrimitiveCount(SoGetPrimitiveCountAction * action)
+{
+  int n;
+  const SbMatrix * m = PRIVATE(this)->getMatrices(n);
+  if (n == 0) return;
+
+  // count the children once, and add the same amount for each of the
+  // other instances
+  const int numtriangles = action->getTriangleCount();
+  const int numlines = action->getLineCount();
+  const int numpoints = action->getPointCount();
+  const int numtexts = action->getTextCount();
+  const int numimages = action->getImageCount();
+
+  SoState * state = action->getState();
+  state->push();
+  SoModelMatrixElement::mult(state, this, m[0]);
+  inherited::doAction(action);
+  state->pop();
+
+  const int extra = n - 1;
+  action->addNumTriangles((action->getTriangleCount() - numtriangles) * extra);
+  action->addNumLines((action->getLineCount() - numlines) * extra);
+  action->addNumPoints((action->getPointCount() - numpoints) * extra);
+  action->addNumText((action->getTextCount() - numtexts) * extra);
+  action->addNumImage((action->getImageCount() - numimages) * extra);
+}
+
+// Doc in superclass.
+void
+SoInstancedCopy::notify(SoNotList * nl)
+{
+  inherited::notify(nl);
+
+  PRIVATE(this)->lock();
+  PRIVATE(this)->matricesvalid = FALSE;
+  PRIVATE(this)->instancesboxvalid = FALSE;
+  if (PRIVATE(this)->bboxcache) PRIVATE(this)->bboxcache->invalidate();
+  PRIVATE(this)->invalidateGLCaches();
+  PRIVATE(this)->unlock();
+}
+
+#undef PRIVATE
+#undef PUBLIC
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/details/SoInstanceDetail.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+BOOST_AUTO_TEST_CASE(initialized)
+{
+  SoInstancedCopy * node = new SoInstancedCopy;
+  assert(node);
+  node->ref();
+  BOOST_CHECK_MESSAGE(node->getTypeId() != SoType::badType(),
+                      "missing class initialization");
+  BOOST_CHECK_MESSAGE(node->getNumInstances() == 1,
+                      "default should be a single instance");
+  node->unref();
+}
+
+BOOST_AUTO_TEST_CASE(boundingBoxAndPick)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoInstancedCopy * node = new SoInstancedCopy;
+  root->addChild(node);
+  node->addChild(new SoCube);
+
+  node->translation.set1Value(0, SbVec3f(0.0f, 0.0f, 0.0f));
+  node->translation.set1Value(1, SbVec3f(10.0f, 0.0f, 0.0f));
+  node->translation.set1Value(2, SbVec3f(20.0f, 0.0f, 0.0f));
+  node->scaleFactor.set1Value(0, SbVec3f(1.0f, 1.0f, 1.0f));
+  node->scaleFactor.set1Value(1, SbVec3f(1.0f, 2.0f, 1.0f));
+  BOOST_CHECK_MESSAGE(node->getNumInstances() == 3, "expected three instances");
+
+  SbViewportRegion vp(100, 100);
+  SoGetBoundingBoxAction bba(vp);
+  bba.apply(root);
+  SbBox3f box = bba.getBoundingBox();
+  BOOST_CHECK_MESSAGE(box.getMin() == SbVec3f(-1.0f, -2.0f, -1.0f) &&
+                      box.getMax() == SbVec3f(21.0f, 2.0f, 1.0f),
+                      "wrong bounding box");
+
+  // change the fields, the cached instance box must be updated
+  node->translation.set1Value(2, SbVec3f(30.0f, 0.0f, 0.0f));
+  bba.apply(root);
+  box = bba.getBoundingBox();
+  BOOST_CHECK_MESSAGE(box.getMax() == SbVec3f(31.0f, 2.0f, 1.0f),
+                      "bounding box not updated");
+
+  SoRayPickAction rpa(vp);
+  rpa.setRay(SbVec3f(10.0f, 0.0f, 10.0f), SbVec3f(0.0f, 0.0f, -1.0f));
+  rpa.apply(root);
+  const SoPickedPoint * pp = rpa.getPickedPoint();
+  BOOST_REQUIRE_MESSAGE(pp != NULL, "expected a hit");
+  const SoDetail * detail = pp->getDetail(node);
+  BOOST_REQUIRE_MESSAGE(detail &&
+                        detail->isOfType(SoInstanceDetail::getClassTypeId()),
+                        "missing instance detail");
+  BOOST_CHECK_MESSAGE(((const SoInstanceDetail *)detail)->getInstanceIndex() == 1,
+                      "wrong instance index");
+  BOOST_CHECK_MESSAGE((pp->getPoint() - SbVec3f(10.0f, 0.0f, 1.0f)).length() < 1e-4f,
+                      "wrong picked point");
+
+  rpa.setRay(SbVec3f(5.0f, 0.0f, 10.0f), SbVec3f(0.0f, 0.0f, -1.0f));
+  rpa.apply(root);
+  BOOST_CHECK_MESSAGE(rpa.getPickedPoint() == NULL, "expected a miss");
+
+  // each instance's points get its own index
+  rpa.setPickAll(TRUE);
+  rpa.setRay(SbVec3f(-10.0f, 0.0f, 0.0f), SbVec3f(1.0f, 0.0f, 0.0f));
+  rpa.apply(root);
+  const SoPickedPointList & pplist = rpa.getPickedPointList();
+  BOOST_CHECK_EQUAL(pplist.getLength(), 6);
+  for (int i = 0; i < pplist.getLength(); i++) {
+    detail = pplist[i]->getDetail(node);
+    BOOST_REQUIRE_MESSAGE(detail &&
+                          detail->isOfType(SoInstanceDetail::getClassTypeId()),
+                          "missing instance detail");
+    const float x = pplist[i]->getPoint()[0];
+    const int expected = (x < 5.0f) ? 0 : ((x < 20.0f) ? 1 : 2);
+    BOOST_CHECK_EQUAL(((const SoInstanceDetail *)detail)->getInstanceIndex(), expected);
+  }
+
+  SoGetPrimitiveCountAction pca(vp);
+  pca.apply(root);
+  BOOST_CHECK_MESSAGE(pca.getTriangleCount() == 3 * 12,
+                      "wrong triangle count");
+
+  root->unref();
+}
+
+#endif // COIN_TEST_SUITE
@@ -104,6 +104,8 @@
 #include <Inventor/actions/SoGLRenderAction.h>
 #include <Inventor/actions/SoCallbackAction.h>
 #include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/elements/SoDecimationPercentageElement.h>
+#include <Inventor/elements/SoDecimationTypeElement.h>
 #include <Inventor/elements/SoModelMatrixElement.h>
 #include <Inventor/elements/SoGLCacheContextElement.h>
 
@@ -361,7 +363,9 @@ SoLOD::getPrimitiveCount(SoGetPrimitiveCountAction *action)
 
 /*!
   Returns the child to traverse based on the ranges in
-  SoLOD::range. Will clamp to index to the number of children.  This
+  SoLOD::range. Will clamp to index to the number of children. If the
+  decimation type is SoDecimationTypeElement::PERCENTAGE, the distance
+  is divided by the decimation percentage.  This
   method will return -1 if no child should be traversed.  This will
   only happen if the node has no children though.
 */
@@ -377,6 +381,13 @@ SoLOD::whichToTraverse(SoAction *action)
 
   float dist = (vv.getProjectionPoint() - worldcenter).length();
 
+  // a decimation percentage below 1 makes the node switch to coarser
+  // children closer to the viewer
+  if (state->isElementEnabled(SoDecimationTypeElement::getClassStackIndex()) &&
+      (SoDecimationTypeElement::get(state) == SoDecimationTypeElement::PERCENTAGE)) {
+    dist /= SbClamp(SoDecimationPercentageElement::get(state), 0.01f, 1.0f);
+  }
+
   int i;
   int n = this->range.getNum();
 
@@ -126,6 +126,10 @@
   SoComplexity::value equal to 1.0 will cause the first child of
   SoLevelOfDetail to always be used.
 
+  If the decimation type is SoDecimationTypeElement::PERCENTAGE, the
+  projected area is also scaled by the decimation percentage before
+  it is compared with the SoLevelOfDetail::screenArea values.
+
 
   As mentioned above, there is one other level-of-detail node in the
   Coin library: SoLOD. The difference between that one and this is
@@ -164,6 +168,8 @@
 #include <Inventor/caches/SoBoundingBoxCache.h>
 #include <Inventor/elements/SoCacheElement.h>
 #include <Inventor/elements/SoComplexityElement.h>
+#include <Inventor/elements/SoDecimationPercentageElement.h>
+#include <Inventor/elements/SoDecimationTypeElement.h>
 #include <Inventor/elements/SoGLCacheContextElement.h>
 #include <Inventor/elements/SoLocalBBoxMatrixElement.h>
 #include <Inventor/elements/SoViewportRegionElement.h>
@@ -393,6 +399,11 @@ SoLevelOfDetail::doAction(SoAction *action)
   // SoComplexity::value > 0.5.
   projarea = float(size[0]) * float(size[1]) * (complexity + 0.5f);
 
+  if (state->isElementEnabled(SoDecimationTypeElement::getClassStackIndex()) &&
+      (SoDecimationTypeElement::get(state) == SoDecimationTypeElement::PERCENTAGE)) {
+    projarea *= SbClamp(SoDecimationPercentageElement::get(state), 0.0f, 1.0f);
+  }
+
   // In case there are too few or too many screenArea values.
   n = SbMin(n, this->screenArea.getNum());
 
@@ -542,84 +542,85 @@ void
 SoNode::initClasses(void)
 {
   SoCamera::initClass();
-  SoPerspectiveCamera::initClass();
-  SoOrthographicCamera::initClass();
-  SoFrustumCamera::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoPerspectiveCamera, SoCamera);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoOrthographicCamera, SoCamera);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoFrustumCamera, SoCamera);
   SoShape::initClass();
-  SoAsciiText::initClass();
-  SoCone::initClass();
-  SoCube::initClass();
-  SoCylinder::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoAsciiText, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoCone, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoCube, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoCylinder, SoShape);
   SoVertexShape::initClass();
   SoNonIndexedShape::initClass();
-  SoFaceSet::initClass();
-  SoLineSet::initClass();
-  SoPointSet::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoFaceSet, SoNonIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoLineSet, SoNonIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoPointSet, SoNonIndexedShape);
   SoMarkerSet::initClass();
-  SoQuadMesh::initClass();
-  SoTriangleStripSet::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoQuadMesh, SoNonIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTriangleStripSet, SoNonIndexedShape);
   SoIndexedShape::initClass();
-  SoIndexedFaceSet::initClass();
-  SoIndexedLineSet::initClass();
-  SoIndexedPointSet::initClass();
-  SoIndexedMarkerSet::initClass();
-  SoIndexedTriangleStripSet::initClass();
-  SoImage::initClass();
-  SoIndexedNurbsCurve::initClass();
-  SoIndexedNurbsSurface::initClass();
-  SoNurbsCurve::initClass();
-  SoNurbsSurface::initClass();
-  SoSphere::initClass();
-  SoText2::initClass();
-  SoText3::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedFaceSet, SoIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedLineSet, SoIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedPointSet, SoIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedMarkerSet, SoIndexedPointSet);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedTriangleStripSet, SoIndexedShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoImage, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedNurbsCurve, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoIndexedNurbsSurface, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoNurbsCurve, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoNurbsSurface, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoSphere, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoText2, SoShape);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoText3, SoShape);
   SoGroup::initClass();
   SoSeparator::initClass();
-  SoAnnotation::initClass();
-  SoLocateHighlight::initClass();
-  SoWWWAnchor::initClass();
-  SoArray::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoAnnotation, SoSeparator);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoLocateHighlight, SoSeparator);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoWWWAnchor, SoLocateHighlight);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoArray, SoGroup);
   SoSwitch::initClass();
-  SoBlinker::initClass();
-  SoLOD::initClass();
-  SoLevelOfDetail::initClass();
-  SoMultipleCopy::initClass();
-  SoPathSwitch::initClass();
-  SoTransformSeparator::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoBlinker, SoSwitch);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoLOD, SoGroup);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoLevelOfDetail, SoGroup);
+  SoScreenSpaceErrorLOD::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoMultipleCopy, SoGroup);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoPathSwitch, SoGroup);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTransformSeparator, SoGroup);
   SoTransformation::initClass();
-  SoMatrixTransform::initClass();
-  SoRotation::initClass();
-  SoPendulum::initClass();
-  SoRotor::initClass();
-  SoResetTransform::initClass();
-  SoRotationXYZ::initClass();
-  SoScale::initClass();
-  SoTranslation::initClass();
-  SoShuttle::initClass();
-  SoTransform::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoMatrixTransform, SoTransformation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoRotation, SoTransformation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoPendulum, SoRotation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoRotor, SoRotation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoResetTransform, SoTransformation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoRotationXYZ, SoTransformation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoScale, SoTransformation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTranslation, SoTransformation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShuttle, SoTranslation);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTransform, SoTransformation);
   SoUnits::initClass();
   SoBaseColor::initClass();
-  SoCallback::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoCallback, SoNode);
   SoClipPlane::initClass();
   SoColorIndex::initClass();
   SoComplexity::initClass();
   SoCoordinate3::initClass();
   SoCoordinate4::initClass();
   SoLight::initClass();
-  SoDirectionalLight::initClass();
-  SoSpotLight::initClass();
-  SoPointLight::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoDirectionalLight, SoLight);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoSpotLight, SoLight);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoPointLight, SoLight);
   SoDrawStyle::initClass();
   SoEnvironment::initClass();
-  SoEventCallback::initClass();
-  SoFile::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoEventCallback, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoFile, SoNode);
   SoFont::initClass();
-  SoFontStyle::initClass();
-  SoInfo::initClass();
-  SoLabel::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoFontStyle, SoFont);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoInfo, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoLabel, SoNode);
   SoLightModel::initClass();
   SoProfile::initClass();
-  SoLinearProfile::initClass();
-  SoNurbsProfile::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoLinearProfile, SoProfile);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoNurbsProfile, SoProfile);
   SoMaterial::initClass();
   SoMaterialBinding::initClass();
   SoVertexAttributeBinding::initClass();
@@ -641,15 +642,15 @@ SoNode::initClasses(void)
   SoTextureCoordinate3::initClass();
   SoTextureCoordinateBinding::initClass();
   SoTextureCoordinateFunction::initClass();
-  SoTextureCoordinateDefault::initClass();
-  SoTextureCoordinateEnvironment::initClass();
-  SoTextureCoordinatePlane::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTextureCoordinateDefault, SoTextureCoordinateFunction);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTextureCoordinateEnvironment, SoTextureCoordinateFunction);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTextureCoordinatePlane, SoTextureCoordinateFunction);
   SoUnknownNode::initClass();
   SoVertexProperty::initClass();
-  SoWWWInline::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoWWWInline, SoNode);
   SoListener::initClass();
 
-  SoTransparencyType::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTransparencyType, SoNode);
   SoTextureScalePolicy::initClass();
 
   SoTextureUnit::initClass();
@@ -668,13 +669,14 @@ SoNode::initClasses(void)
   SoTextureCombine::initClass();
   SoCacheHint::initClass();
   SoTextureCubeMap::initClass();
-  SoTextureCoordinateNormalMap::initClass();
-  SoTextureCoordinateReflectionMap::initClass();
-  SoTextureCoordinateObject::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTextureCoordinateNormalMap, SoTextureCoordinateFunction);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTextureCoordinateReflectionMap, SoTextureCoordinateFunction);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoTextureCoordinateObject, SoTextureCoordinateFunction);
   SoVertexAttribute::initClass();
 
   SoDepthBuffer::initClass();
-  SoAlphaTest::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoAlphaTest, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoInstancedCopy, SoGroup);
 }
 
 /*!
@@ -1560,6 +1562,7 @@ init_action_methods(void)
   SoRayPickAction::addMethod(SoSeparator::getClassTypeId(), SoNode::rayPickS);
   SoRayPickAction::addMethod(SoLOD::getClassTypeId(), SoNode::rayPickS);
   SoRayPickAction::addMethod(SoLevelOfDetail::getClassTypeId(), SoNode::rayPickS);
+  SoRayPickAction::addMethod(SoScreenSpaceErrorLOD::getClassTypeId(), SoNode::rayPickS);
   SoRayPickAction::addMethod(SoShape::getClassTypeId(), SoNode::rayPickS);
   SoRayPickAction::addMethod(SoTexture2::getClassTypeId(), SoNode::rayPickS);
   SoRayPickAction::addMethod(SoBumpMap::getClassTypeId(), SoNode::rayPickS);
@@ -0,0 +1,768 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class SoScreenSpaceErrorLOD SoScreenSpaceErrorLOD.h Inventor/nodes/SoScreenSpaceErrorLOD.h
+  \brief The SoScreenSpaceErrorLOD class selects a child from its projected geometric error.
+
+  \ingroup nodes
+
+  Like SoLOD and SoLevelOfDetail, this node is a group node which
+  traverses only one of its children, where the first child is the
+  most detailed version of a model and each of the following children
+  is a coarser version of the same model. Instead of distance ranges
+  or screen areas which have to be tuned by hand, each child is
+  described by its geometric error: the largest distance, in the
+  coordinate system of the node, between the surface of that child
+  and the surface of the full resolution model. Mesh simplification
+  tools usually report this value.
+
+  The geometric error of a child is projected to the screen at the
+  distance of the SoScreenSpaceErrorLOD::center point, and the node
+  selects the coarsest child whose projected error is not larger than
+  SoScreenSpaceErrorLOD::maxScreenError pixels. Since the projected
+  error follows the camera, the node works the same way for
+  perspective and orthographic cameras, and for different viewport
+  sizes.
+
+  To avoid children popping back and forth when the camera moves
+  slowly around a switching distance, the node remembers the child
+  it rendered in the previous frame. It keeps that child as long as
+  its projected error is within SoScreenSpaceErrorLOD::hysteresis
+  times the limit above SoScreenSpaceErrorLOD::maxScreenError, and
+  only switches to a coarser child when that child's error is
+  hysteresis times the limit below it.
+
+  In addition, a triangle budget can be set for all
+  SoScreenSpaceErrorLOD nodes with setTriangleBudget(). The nodes
+  rendered in a frame report the projected error and the number of
+  triangles of each of their children to a per-action budget. When
+  the next frame starts, the budget is solved greedily: if the
+  selected children add up to more triangles than the budget, the
+  node whose next coarser child has the smallest projected error is
+  switched to that child, until the total is within the budget or
+  all nodes use their coarsest child. The result is used as the
+  minimum child index for each node in that frame, so the budget
+  lags one frame behind the camera. Frame boundaries are found with
+  SoGLRenderAction::getFrameCounter(), and each SoGLRenderAction has
+  its own budget.
+
+  The triangle counts are taken from the
+  SoScreenSpaceErrorLOD::triangleCount field. For children without a
+  value there, the count is found by applying an
+  SoGetPrimitiveCountAction to the child, and cached until the node
+  or something below it changes. If the children depend on state
+  from above the node, like coordinates from an SoCoordinate3 node,
+  the triangle counts should be set in the field.
+
+  Here's an example which shows the coarser children when the
+  errors of the finer ones project to more than two pixels:
+
+  \code
+  ScreenSpaceErrorLOD {
+     geometricError [ 0.001, 0.01, 0.1 ]
+     maxScreenError 2
+
+     File { name "model_full.iv" }
+     File { name "model_medium.iv" }
+     File { name "model_coarse.iv" }
+  }
+  \endcode
+
+  If SoScreenSpaceErrorLOD::geometricError has fewer values than the
+  node has children, the remaining children are never selected.
+
+  If the decimation type is SoDecimationTypeElement::PERCENTAGE, the
+  accepted screen error is divided by the decimation percentage, so
+  lower percentages select coarser children.
+
+  Picking with SoRayPickAction uses the child which was last
+  rendered, so picks hit what is shown on the screen. Other actions
+  select a child from the projected error and the hysteresis, but do
+  not use the triangle budget. SoGetBoundingBoxAction traverses all
+  children, like SoLOD does.
+
+  <b>FILE FORMAT/DEFAULTS:</b>
+  \code
+    ScreenSpaceErrorLOD {
+        geometricError [  ]
+        triangleCount [  ]
+        center 0 0 0
+        maxScreenError 1
+        hysteresis 0.25
+    }
+  \endcode
+
+  \sa SoLOD, SoLevelOfDetail
+  \COIN_CLASS_EXTENSION
+  \since Coin 4.0
+*/
+
+// *************************************************************************
+
+#include <Inventor/nodes/SoScreenSpaceErrorLOD.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/elements/SoCacheElement.h>
+#include <Inventor/elements/SoDecimationPercentageElement.h>
+#include <Inventor/elements/SoDecimationTypeElement.h>
+#include <Inventor/elements/SoGLCacheContextElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/elements/SoViewportRegionElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoState.h>
+
+#include "tidbitsp.h"
+#include "nodes/SoScreenSpaceErrorLODP.h"
+#include "nodes/SoSubNodeP.h"
+#include "profiler/SoNodeProfiling.h"
+
+// *************************************************************************
+
+/*!
+  \var SoMFFloat SoScreenSpaceErrorLOD::geometricError
+
+  The geometric error of each child, in the coordinate system of this
+  node. The values should increase from the first (most detailed)
+  child to the last (coarsest) child.
+
+  The field is empty by default, which makes the node always traverse
+  its first child.
+*/
+/*!
+  \var SoMFInt32 SoScreenSpaceErrorLOD::triangleCount
+
+  The number of triangles in each child, used for the triangle
+  budget. Children without a value, or with a negative value, are
+  counted with an SoGetPrimitiveCountAction.
+
+  The field is empty by default.
+*/
+/*!
+  \var SoSFVec3f SoScreenSpaceErrorLOD::center
+
+  The point, in the coordinate system of this node, at which the
+  geometric errors are projected to the screen. It should be set to
+  the center of the model.
+
+  Default value is [0, 0, 0].
+*/
+/*!
+  \var SoSFFloat SoScreenSpaceErrorLOD::maxScreenError
+
+  The largest projected error, in pixels, that is accepted for the
+  selected child. Default value is 1.
+*/
+/*!
+  \var SoSFFloat SoScreenSpaceErrorLOD::hysteresis
+
+  How far, as a fraction of SoScreenSpaceErrorLOD::maxScreenError,
+  the projected error has to move past the limit before the node
+  switches away from the child it rendered in the previous frame. A
+  value of 0 disables hysteresis. Default value is 0.25.
+*/
+
+// *************************************************************************
+
+int32_t SoScreenSpaceErrorLODP::trianglebudget = 0;
+SbList<SoScreenSpaceErrorLODBudget *> * SoScreenSpaceErrorLODP::budgets = NULL;
+#ifdef COIN_THREADSAFE
+SbMutex * SoScreenSpaceErrorLODP::budgetmutex = NULL;
+#endif // COIN_THREADSAFE
+
+#define PRIVATE(obj) ((obj)->pimpl)
+#define PUBLIC(obj) ((obj)->master)
+
+// called from atexit
+void
+SoScreenSpaceErrorLODP::cleanup(void)
+{
+  for (int i = 0; i < budgets->getLength(); i++) {
+    delete (*budgets)[i];
+  }
+  delete budgets;
+  budgets = NULL;
+#ifdef COIN_THREADSAFE
+  delete budgetmutex;
+  budgetmutex = NULL;
+#endif // COIN_THREADSAFE
+  trianglebudget = 0;
+}
+
+// Returns the number of pixels one unit in the coordinate system of
+// the node covers at the center point.
+float
+SoScreenSpaceErrorLODP::getPixelScale(SoState * state) const
+{
+  const SbMatrix & mm = SoModelMatrixElement::get(state);
+  const SbViewVolume & vv = SoViewVolumeElement::get(state);
+  const SbViewportRegion & vp = SoViewportRegionElement::get(state);
+
+  // the largest scale factor of the model matrix
+  float scale = 0.0f;
+  for (int i = 0; i < 3; i++) {
+    SbVec3f axis(0.0f, 0.0f, 0.0f);
+    axis[i] = 1.0f;
+    SbVec3f dir;
+    mm.multDirMatrix(axis, dir);
+    scale = SbMax(scale, dir.length());
+  }
+
+  // the width of the view volume at the depth of the center point
+  float width = vv.getWidth();
+  if (vv.getProjectionType() == SbViewVolume::PERSPECTIVE) {
+    SbVec3f worldcenter;
+    mm.multVecMatrix(PUBLIC(this)->center.getValue(), worldcenter);
+    const float neardist = vv.getNearDist();
+    float depth = (worldcenter - vv.getProjectionPoint()).dot(vv.getProjectionDirection());
+    // points closer than the near plane are treated as being on it
+    if (depth < neardist) depth = neardist;
+    if (neardist > 0.0f) width *= depth / neardist;
+  }
+  if (width <= 0.0f) return 0.0f;
+  return scale * float(vp.getViewportSizePixels()[0]) / width;
+}
+
+// Finds the projected errors of the levels, and returns the level to
+// use from them and the previously rendered child.
+int
+SoScreenSpaceErrorLODP::selectLevel(SoState * state, SbList<float> & errors) const
+{
+  const int numlevels = this->getNumLevels();
+  const float pixelscale = this->getPixelScale(state);
+  errors.truncate(0);
+  for (int i = 0; i < numlevels; i++) {
+    errors.append(PUBLIC(this)->geometricError[i] * pixelscale);
+  }
+  int prev = this->renderedchild;
+  if (prev >= numlevels) prev = -1;
+  float maxerror = PUBLIC(this)->maxScreenError.getValue();
+  if (state->isElementEnabled(SoDecimationTypeElement::getClassStackIndex()) &&
+      (SoDecimationTypeElement::get(state) == SoDecimationTypeElement::PERCENTAGE)) {
+    maxerror /= SbClamp(SoDecimationPercentageElement::get(state), 0.01f, 1.0f);
+  }
+  return SoScreenSpaceErrorLODP::selectFromErrors(errors.getArrayPtr(), numlevels, maxerror,
+                                                  SbClamp(PUBLIC(this)->hysteresis.getValue(), 0.0f, 1.0f),
+                                                  prev);
+}
+
+int32_t
+SoScreenSpaceErrorLODP::getTriangleCount(SoState * state, const int child)
+{
+  const SoMFInt32 & field = PUBLIC(this)->triangleCount;
+  if ((child < field.getNum()) && (field[child] >= 0)) return field[child];
+
+  this->lock();
+  while (this->trianglecounts.getLength() <= child) {
+    this->trianglecounts.append(-1);
+  }
+  int32_t count = this->trianglecounts[child];
+  this->unlock();
+
+  if (count < 0) {
+    SoGetPrimitiveCountAction pca(SoViewportRegionElement::get(state));
+    pca.apply(PUBLIC(this)->getChild(child));
+    count = pca.getTriangleCount();
+    this->lock();
+    if (child < this->trianglecounts.getLength()) {
+      this->trianglecounts[child] = count;
+    }
+    this->unlock();
+  }
+  return count;
+}
+
+// Reports the levels of the node to the budget of the action, and
+// returns the level the budget assigned to the node in the previous
+// frame.
+int
+SoScreenSpaceErrorLODP::requestBudget(SoGLRenderAction * action,
+                                      const SbList<float> & errors,
+                                      const int desired)
+{
+  const int numlevels = errors.getLength();
+  SbList<int32_t> triangles(numlevels);
+  for (int i = 0; i < numlevels; i++) {
+    triangles.append(this->getTriangleCount(action->getState(), i));
+  }
+
+  SoScreenSpaceErrorLODP::lockBudgets();
+  SoScreenSpaceErrorLODBudget * budget = NULL;
+  for (int i = 0; i < budgets->getLength(); i++) {
+    if ((*budgets)[i]->action == action) {
+      budget = (*budgets)[i];
+      break;
+    }
+  }
+  const uint32_t frame = action->getFrameCounter();
+  if (budget == NULL) {
+    budget = new SoScreenSpaceErrorLODBudget;
+    budget->action = action;
+    budget->frame = frame;
+    budgets->append(budget);
+  }
+  else if (budget->frame != frame) {
+    budget->solve(trianglebudget);
+    budget->frame = frame;
+  }
+
+  int assigned = 0;
+  (void) budget->assigned.get(PUBLIC(this), assigned);
+
+  sosselod_request request;
+  request.node = PUBLIC(this);
+  request.first = budget->errors.getLength();
+  request.numlevels = numlevels;
+  request.desired = desired;
+  budget->requests.append(request);
+  for (int i = 0; i < numlevels; i++) {
+    budget->errors.append(errors[i]);
+    budget->triangles.append(triangles[i]);
+  }
+  SoScreenSpaceErrorLODP::unlockBudgets();
+
+  return SbMin(assigned, numlevels - 1);
+}
+
+// Removes the node from the budgets, so that a node created later at
+// the same address does not get its level, and its requests do not
+// count against the budget when it is solved.
+void
+SoScreenSpaceErrorLODP::removeFromBudgets(void)
+{
+  if (budgets == NULL) return;
+  SoScreenSpaceErrorLODP::lockBudgets();
+  for (int i = 0; i < budgets->getLength(); i++) {
+    SoScreenSpaceErrorLODBudget * budget = (*budgets)[i];
+    (void) budget->assigned.erase(PUBLIC(this));
+    for (int j = 0; j < budget->requests.getLength(); j++) {
+      sosselod_request & r = budget->requests[j];
+      if (r.node != PUBLIC(this)) continue;
+      r.node = NULL;
+      for (int l = 0; l < r.numlevels; l++) budget->triangles[r.first + l] = 0;
+    }
+  }
+  SoScreenSpaceErrorLODP::unlockBudgets();
+}
+
+// Removes the budget of the action. Called when the action is
+// destructed.
+void
+SoScreenSpaceErrorLODP::removeBudget(const SoGLRenderAction * action)
+{
+  if (budgets == NULL) return;
+  SoScreenSpaceErrorLODP::lockBudgets();
+  for (int i = 0; i < budgets->getLength(); i++) {
+    if ((*budgets)[i]->action == action) {
+      delete (*budgets)[i];
+      budgets->removeFast(i);
+      break;
+    }
+  }
+  SoScreenSpaceErrorLODP::unlockBudgets();
+}
+
+// Selects the child to render, and remembers it for the hysteresis
+// of the next frame.
+int
+SoScreenSpaceErrorLODP::selectForRender(SoGLRenderAction * action)
+{
+  if (PUBLIC(this)->getNumChildren() == 0) return -1;
+  int level = 0;
+  if (this->getNumLevels() > 0) {
+    SoState * state = action->getState();
+    SbList<float> errors;
+    level = this->selectLevel(state, errors);
+    if (trianglebudget > 0) {
+      level = SbMax(level, this->requestBudget(action, errors, level));
+      // the level depends on the other nodes in the frame, which
+      // open caches can not know about
+      SoCacheElement::invalidate(state);
+    }
+  }
+  this->renderedchild = level;
+  return level;
+}
+
+// *************************************************************************
+
+SO_NODE_SOURCE(SoScreenSpaceErrorLOD);
+
+/*!
+  Default constructor.
+*/
+SoScreenSpaceErrorLOD::SoScreenSpaceErrorLOD(void)
+{
+  this->commonConstructor();
+}
+
+/*!
+  Constructor.
+
+  The argument should be the approximate number of children which is
+  expected to be inserted below this node. The number need not be
+  exact, as it is only used as a hint for better memory resource
+  allocation.
+*/
+SoScreenSpaceErrorLOD::SoScreenSpaceErrorLOD(int numchildren)
+  : inherited(numchildren)
+{
+  this->commonConstructor();
+}
+
+// private
+void
+SoScreenSpaceErrorLOD::commonConstructor(void)
+{
+  PRIVATE(this) = new SoScreenSpaceErrorLODP(this);
+
+  SO_NODE_INTERNAL_CONSTRUCTOR(SoScreenSpaceErrorLOD);
+
+  SO_NODE_ADD_FIELD(geometricError, (0.0f));
+  SO_NODE_ADD_FIELD(triangleCount, (0));
+  SO_NODE_ADD_FIELD(center, (SbVec3f(0.0f, 0.0f, 0.0f)));
+  SO_NODE_ADD_FIELD(maxScreenError, (1.0f));
+  SO_NODE_ADD_FIELD(hysteresis, (0.25f));
+
+  // the multivalue fields are empty by default
+  this->geometricError.setNum(0);
+  this->geometricError.setDefault(TRUE);
+  this->triangleCount.setNum(0);
+  this->triangleCount.setDefault(TRUE);
+}
+
+/*!
+  Destructor.
+*/
+SoScreenSpaceErrorLOD::~SoScreenSpaceErrorLOD()
+{
+  PRIVATE(this)->removeFromBudgets();
+  delete PRIVATE(this);
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::initClass(void)
+{
+  SO_NODE_INTERNAL_INIT_CLASS(SoScreenSpaceErrorLOD, SO_FROM_COIN_4_0);
+
+  SoScreenSpaceErrorLODP::budgets = new SbList<SoScreenSpaceErrorLODBudget *>;
+#ifdef COIN_THREADSAFE
+  SoScreenSpaceErrorLODP::budgetmutex = new SbMutex;
+#endif // COIN_THREADSAFE
+  coin_atexit(static_cast<coin_atexit_f *>(SoScreenSpaceErrorLODP::cleanup),
+              CC_ATEXIT_NORMAL);
+}
+
+/*!
+  Sets the largest total number of triangles the
+  SoScreenSpaceErrorLOD nodes rendered in a frame should select. A
+  value of 0, which is the default, disables the budget.
+
+  The budget is shared by all SoScreenSpaceErrorLOD nodes rendered
+  with the same SoGLRenderAction, but only counts the triangles of
+  these nodes, not the rest of the scene graph.
+*/
+void
+SoScreenSpaceErrorLOD::setTriangleBudget(const int32_t numtriangles)
+{
+  SoScreenSpaceErrorLODP::trianglebudget = SbMax(numtriangles, 0);
+}
+
+/*!
+  Returns the triangle budget.
+
+  \sa setTriangleBudget()
+*/
+int32_t
+SoScreenSpaceErrorLOD::getTriangleBudget(void)
+{
+  return SoScreenSpaceErrorLODP::trianglebudget;
+}
+
+/*!
+  Returns the geometric error of child \a level projected to the
+  screen, in pixels, for the camera and model matrix in \a state.
+  Returns 0 if there is no geometric error for \a level.
+*/
+float
+SoScreenSpaceErrorLOD::getScreenError(SoState * state, const int level) const
+{
+  if ((level < 0) || (level >= this->geometricError.getNum())) return 0.0f;
+  return this->geometricError[level] * PRIVATE(this)->getPixelScale(state);
+}
+
+/*!
+  Returns the index of the child which was rendered last, or -1 if
+  the node has not been rendered yet.
+*/
+int
+SoScreenSpaceErrorLOD::getRenderedChild(void) const
+{
+  return PRIVATE(this)->renderedchild;
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::doAction(SoAction * action)
+{
+  int numindices;
+  const int * indices;
+  SoAction::PathCode pathcode = action->getPathCode(numindices, indices);
+  if (pathcode == SoAction::IN_PATH) {
+    this->children->traverseInPath(action, numindices, indices);
+  }
+  else {
+    int idx = this->whichToTraverse(action);
+    if (idx >= 0) this->children->traverse(action, idx);
+  }
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::callback(SoCallbackAction * action)
+{
+  SoScreenSpaceErrorLOD::doAction(action);
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::GLRender(SoGLRenderAction * action)
+{
+  switch (action->getCurPathCode()) {
+  case SoAction::NO_PATH:
+  case SoAction::BELOW_PATH:
+    SoScreenSpaceErrorLOD::GLRenderBelowPath(action);
+    break;
+  case SoAction::IN_PATH:
+    SoScreenSpaceErrorLOD::GLRenderInPath(action);
+    break;
+  case SoAction::OFF_PATH:
+    SoScreenSpaceErrorLOD::GLRenderOffPath(action);
+    break;
+  default:
+    assert(0 && "unknown path code.");
+    break;
+  }
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::GLRenderBelowPath(SoGLRenderAction * action)
+{
+  int idx = PRIVATE(this)->selectForRender(action);
+  if (idx >= 0) {
+    SoNode * child = this->getChild(idx);
+    action->pushCurPath(idx, child);
+    if (!action->abortNow()) {
+      SoNodeProfiling profiling;
+      profiling.preTraversal(action);
+      child->GLRenderBelowPath(action);
+      profiling.postTraversal(action);
+    }
+    action->popCurPath();
+  }
+  // don't auto cache LOD nodes.
+  SoGLCacheContextElement::shouldAutoCache(action->getState(),
+                                           SoGLCacheContextElement::DONT_AUTO_CACHE);
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::GLRenderInPath(SoGLRenderAction * action)
+{
+  int numindices;
+  const int * indices;
+  SoAction::PathCode pathcode = action->getPathCode(numindices, indices);
+
+  if (pathcode == SoAction::IN_PATH) {
+    for (int i = 0; (i < numindices) && !action->hasTerminated(); i++) {
+      int idx = indices[i];
+      SoNode * node = this->getChild(idx);
+      action->pushCurPath(idx, node);
+      if (!action->abortNow()) {
+        SoNodeProfiling profiling;
+        profiling.preTraversal(action);
+        node->GLRenderInPath(action);
+        profiling.postTraversal(action);
+      }
+      action->popCurPath(pathcode);
+    }
+  }
+  else {
+    assert(pathcode == SoAction::BELOW_PATH);
+    SoScreenSpaceErrorLOD::GLRenderBelowPath(action);
+  }
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::GLRenderOffPath(SoGLRenderAction * action)
+{
+  int idx = this->whichToTraverse(action);
+  if (idx >= 0) {
+    SoNode * node = this->getChild(idx);
+    if (node->affectsState()) {
+      action->pushCurPath(idx, node);
+      if (!action->abortNow()) {
+        SoNodeProfiling profiling;
+        profiling.preTraversal(action);
+        node->GLRenderOffPath(action);
+        profiling.postTraversal(action);
+      }
+      action->popCurPath();
+    }
+  }
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::rayPick(SoRayPickAction * action)
+{
+  const int rendered = PRIVATE(this)->renderedchild;
+  if ((rendered >= 0) && (rendered < this->getNumChildren()) &&
+      (action->getCurPathCode() != SoAction::IN_PATH)) {
+    this->children->traverse(action, rendered);
+  }
+  else {
+    SoScreenSpaceErrorLOD::doAction(action);
+  }
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::getPrimitiveCount(SoGetPrimitiveCountAction * action)
+{
+  SoScreenSpaceErrorLOD::doAction(action);
+}
+
+/*!
+  Returns the child to traverse for \a action, selected from the
+  projected geometric errors and the child rendered in the previous
+  frame. Returns -1 only if the node has no children.
+*/
+int
+SoScreenSpaceErrorLOD::whichToTraverse(SoAction * action)
+{
+  if (this->getNumChildren() == 0) return -1;
+  if (PRIVATE(this)->getNumLevels() == 0) return 0;
+  SbList<float> errors;
+  return PRIVATE(this)->selectLevel(action->getState(), errors);
+}
+
+// Documented in superclass.
+void
+SoScreenSpaceErrorLOD::notify(SoNotList * list)
+{
+  PRIVATE(this)->lock();
+  PRIVATE(this)->trianglecounts.truncate(0);
+  PRIVATE(this)->unlock();
+  inherited::notify(list);
+}
+
+#undef PRIVATE
+#undef PUBLIC
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/nodes/SoInfo.h>
+#include <Inventor/nodes/SoOrthographicCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+static SoCallbackAction::Response
+sosselod_test_info_cb(void * closure, SoCallbackAction *, const SoNode * node)
+{
+  SbString * str = static_cast<SbString *>(closure);
+  *str += static_cast<const SoInfo *>(node)->string.getValue();
+  return SoCallbackAction::CONTINUE;
+}
+
+BOOST_AUTO_TEST_CASE(selectFromScreenError)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoOrthographicCamera * camera = new SoOrthographicCamera;
+  camera->position.setValue(0.0f, 0.0f, 10.0f);
+  root->addChild(camera);
+  SoScreenSpaceErrorLOD * lod = new SoScreenSpaceErrorLOD;
+  root->addChild(lod);
+  const char * names[] = { "0", "1", "2" };
+  for (int i = 0; i < 3; i++) {
+    SoInfo * info = new SoInfo;
+    info->string = names[i];
+    lod->addChild(info);
+  }
+
+  SbString visited;
+  SoCallbackAction cba(SbViewportRegion(100, 100));
+  cba.addPreCallback(SoInfo::getClassTypeId(), sosselod_test_info_cb, &visited);
+
+  cba.apply(root);
+  BOOST_CHECK_MESSAGE(visited == "0", "expected first child without errors");
+
+  // 10 pixels per unit with a 10 units wide view
+  const float errors[] = { 0.005f, 0.05f, 1.0f };
+  lod->geometricError.setValues(0, 3, errors);
+  camera->height = 10.0f;
+  visited = "";
+  cba.apply(root);
+  BOOST_CHECK_MESSAGE(visited == "1", "expected the coarsest child within one pixel");
+
+  camera->height = 1.0f;
+  visited = "";
+  cba.apply(root);
+  BOOST_CHECK_MESSAGE(visited == "0", "expected the finest child when zoomed in");
+
+  camera->height = 1000.0f;
+  visited = "";
+  cba.apply(root);
+  BOOST_CHECK_MESSAGE(visited == "2", "expected the coarsest child when zoomed out");
+
+  root->unref();
+}
+
+#endif // COIN_TEST_SUITE
@@ -0,0 +1,328 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+// The level selection and the triangle budget solver of
+// SoScreenSpaceErrorLOD, which only work on the projected errors and
+// triangle counts, not on the scene graph.
+
+#include "nodes/SoScreenSpaceErrorLODP.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <stdlib.h>
+
+#include <Inventor/SbBasic.h>
+
+// *************************************************************************
+
+// A possible switch of one request to a coarser level.
+typedef struct {
+  int request;
+  int level;
+  float error;
+} sosselod_step;
+
+extern "C" {
+static int
+sosselod_compare_steps(const void * v0, const void * v1)
+{
+  const sosselod_step * s0 = static_cast<const sosselod_step *>(v0);
+  const sosselod_step * s1 = static_cast<const sosselod_step *>(v1);
+  if (s0->error != s1->error) return (s0->error < s1->error) ? -1 : 1;
+  if (s0->level != s1->level) return s0->level - s1->level;
+  return s0->request - s1->request;
+}
+}
+
+// Returns the level to use out of numlevels levels with the given
+// projected errors, which should be increasing. prev is the level
+// used in the previous frame, or -1.
+int
+SoScreenSpaceErrorLODP::selectFromErrors(const float * errors, const int numlevels,
+                                         const float maxerror, const float hysteresis,
+                                         const int prev)
+{
+  const float keeplimit = maxerror * (1.0f + hysteresis);
+  const float coarserlimit = maxerror * (1.0f - hysteresis);
+  int level = 0;
+  for (int i = 0; i < numlevels; i++) {
+    float limit = maxerror;
+    if (prev >= 0) {
+      if (i == prev) limit = keeplimit;
+      else if (i > prev) limit = coarserlimit;
+    }
+    if (errors[i] <= limit) level = i;
+  }
+  return level;
+}
+
+// Greedily switches requests to coarser levels, cheapest projected
+// error first, until the total number of triangles is within
+// budget. Writes the level of each request to levels, and returns
+// the resulting number of triangles.
+int32_t
+SoScreenSpaceErrorLODP::solveBudget(const sosselod_request * requests,
+                                    const int numrequests,
+                                    const float * errors,
+                                    const int32_t * triangles,
+                                    const int32_t budget, int * levels)
+{
+  int32_t total = 0;
+  SbList<sosselod_step> steps;
+  for (int i = 0; i < numrequests; i++) {
+    const sosselod_request & r = requests[i];
+    levels[i] = r.desired;
+    total += triangles[r.first + r.desired];
+    // make the errors increasing, so the steps of a request are
+    // sorted in level order
+    float error = errors[r.first + r.desired];
+    for (int l = r.desired + 1; l < r.numlevels; l++) {
+      error = SbMax(error, errors[r.first + l]);
+      sosselod_step step;
+      step.request = i;
+      step.level = l;
+      step.error = error;
+      steps.append(step);
+    }
+  }
+  if (total <= budget) return total;
+
+  const int numsteps = steps.getLength();
+  if (numsteps == 0) return total;
+  qsort(&steps[0], numsteps, sizeof(sosselod_step), sosselod_compare_steps);
+  for (int i = 0; (i < numsteps) && (total > budget); i++) {
+    const sosselod_step & step = steps[i];
+    const sosselod_request & r = requests[step.request];
+    assert(step.level == levels[step.request] + 1);
+    total += triangles[r.first + step.level] - triangles[r.first + levels[step.request]];
+    levels[step.request] = step.level;
+  }
+  return total;
+}
+
+void
+SoScreenSpaceErrorLODBudget::solve(const int32_t budget)
+{
+  this->assigned.clear();
+  const int num = this->requests.getLength();
+  if (num > 0) {
+    int * levels = new int[num];
+    SoScreenSpaceErrorLODP::solveBudget(this->requests.getArrayPtr(), num,
+                                        this->errors.getArrayPtr(),
+                                        this->triangles.getArrayPtr(),
+                                        budget, levels);
+    for (int i = 0; i < num; i++) {
+      const sosselod_request & r = this->requests[i];
+      // requests of nodes destructed since are skipped
+      if ((r.node != NULL) && (levels[i] > r.desired)) {
+        // a node reached more than once in a frame uses the coarsest
+        // of its levels
+        int prev;
+        if (!this->assigned.get(r.node, prev) || (levels[i] > prev)) {
+          this->assigned.put(r.node, levels[i]);
+        }
+      }
+    }
+    delete [] levels;
+  }
+  this->requests.truncate(0);
+  this->errors.truncate(0);
+  this->triangles.truncate(0);
+}
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+#ifdef COIN_INT_TEST_SUITE
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/nodes/SoScreenSpaceErrorLOD.h>
+
+static void
+sosselodp_test_request(SoScreenSpaceErrorLODBudget * budget,
+                       const SoScreenSpaceErrorLOD * node,
+                       const float * errors, const int32_t * triangles,
+                       const int numlevels, const int desired)
+{
+  sosselod_request request;
+  request.node = node;
+  request.first = budget->errors.getLength();
+  request.numlevels = numlevels;
+  request.desired = desired;
+  budget->requests.append(request);
+  for (int i = 0; i < numlevels; i++) {
+    budget->errors.append(errors[i]);
+    budget->triangles.append(triangles[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(solveRefinesLargestError)
+{
+  const int32_t triangles[] = {
+    1000, 300, 100,
+    1000, 300, 100,
+    1000, 300, 100
+  };
+  const float errors[] = {
+    0.5f, 1.0f, 8.0f,
+    0.5f, 4.0f, 16.0f,
+    0.5f, 2.0f, 3.0f
+  };
+  sosselod_request requests[3];
+  for (int i = 0; i < 3; i++) {
+    requests[i].node = NULL;
+    requests[i].first = i * 3;
+    requests[i].numlevels = 3;
+    requests[i].desired = 0;
+  }
+  int levels[3];
+
+  int32_t total = SoScreenSpaceErrorLODP::solveBudget(requests, 3, errors, triangles,
+                                                      3000, levels);
+  BOOST_CHECK_MESSAGE(total == 3000 && levels[0] == 0 && levels[1] == 0 && levels[2] == 0,
+                      "expected the desired levels within the budget");
+
+  // switching the first and the third node to their next level is
+  // enough, and keeps the second node, whose next level has the
+  // largest error, at its finest level
+  total = SoScreenSpaceErrorLODP::solveBudget(requests, 3, errors, triangles,
+                                              1700, levels);
+  BOOST_CHECK_MESSAGE(total == 1600, "expected the total to be within the budget");
+  BOOST_CHECK_MESSAGE(levels[0] == 1 && levels[1] == 0 && levels[2] == 1,
+                      "expected the smallest errors to be switched first");
+
+  total = SoScreenSpaceErrorLODP::solveBudget(requests, 3, errors, triangles,
+                                              1500, levels);
+  BOOST_CHECK_MESSAGE(total == 1400 && levels[0] == 1 && levels[1] == 0 && levels[2] == 2,
+                      "expected the largest error to be kept longest");
+
+  // a budget which can not be met leaves all nodes at the coarsest
+  // level
+  total = SoScreenSpaceErrorLODP::solveBudget(requests, 3, errors, triangles,
+                                              10, levels);
+  BOOST_CHECK_MESSAGE(total == 300 && levels[0] == 2 && levels[1] == 2 && levels[2] == 2,
+                      "expected the coarsest levels for a too small budget");
+
+  // nodes never get finer levels than they selected
+  requests[1].desired = 2;
+  total = SoScreenSpaceErrorLODP::solveBudget(requests, 3, errors, triangles,
+                                              1500, levels);
+  BOOST_CHECK_MESSAGE(total == 1400 && levels[0] == 1 && levels[1] == 2 && levels[2] == 0,
+                      "expected the selected levels to be kept within the budget");
+}
+
+BOOST_AUTO_TEST_CASE(selectWithHysteresis)
+{
+  const float errors[] = { 0.5f, 1.1f, 4.0f };
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(errors, 3, 1.0f, 0.25f, -1) == 0,
+                      "expected the finest level without a previous level");
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(errors, 3, 1.0f, 0.25f, 1) == 1,
+                      "expected the previous level to be kept inside the band");
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(errors, 3, 1.0f, 0.0f, 1) == 0,
+                      "expected no band without hysteresis");
+
+  const float beyond[] = { 0.5f, 1.3f, 4.0f };
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(beyond, 3, 1.0f, 0.25f, 1) == 0,
+                      "expected a finer level outside the band");
+
+  const float coarser[] = { 0.5f, 0.9f, 4.0f };
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(coarser, 3, 1.0f, 0.25f, 0) == 0,
+                      "expected the finer previous level to be kept inside the band");
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(coarser, 3, 1.0f, 0.25f, -1) == 1,
+                      "expected the coarser level without a previous level");
+
+  const float below[] = { 0.5f, 0.7f, 4.0f };
+  BOOST_CHECK_MESSAGE(SoScreenSpaceErrorLODP::selectFromErrors(below, 3, 1.0f, 0.25f, 0) == 1,
+                      "expected a coarser level below the band");
+}
+
+BOOST_AUTO_TEST_CASE(removeOnDestruction)
+{
+  const float errors[] = { 0.5f, 1.0f, 2.0f };
+  const int32_t triangles[] = { 1000, 300, 100 };
+
+  SoGLRenderAction * action = new SoGLRenderAction(SbViewportRegion(100, 100));
+  SoScreenSpaceErrorLOD * first = new SoScreenSpaceErrorLOD;
+  first->ref();
+  SoScreenSpaceErrorLOD * second = new SoScreenSpaceErrorLOD;
+  second->ref();
+
+  SoScreenSpaceErrorLODBudget * budget = new SoScreenSpaceErrorLODBudget;
+  budget->action = action;
+  budget->frame = 0;
+  SoScreenSpaceErrorLODP::lockBudgets();
+  SoScreenSpaceErrorLODP::budgets->append(budget);
+  SoScreenSpaceErrorLODP::unlockBudgets();
+
+  sosselodp_test_request(budget, first, errors, triangles, 3, 0);
+  sosselodp_test_request(budget, second, errors, triangles, 3, 0);
+  budget->solve(700);
+  int level = 0;
+  BOOST_CHECK_MESSAGE(budget->assigned.get(first, level) && (level == 1) &&
+                      budget->assigned.get(second, level) && (level == 1),
+                      "expected both nodes to be switched by the budget");
+
+  sosselodp_test_request(budget, first, errors, triangles, 3, 0);
+  sosselodp_test_request(budget, second, errors, triangles, 3, 0);
+  first->unref();
+
+  BOOST_CHECK_MESSAGE(!budget->assigned.get(first, level),
+                      "expected the level of the destructed node to be removed");
+  BOOST_CHECK_MESSAGE(budget->requests[0].node == NULL &&
+                      budget->triangles[0] == 0 && budget->triangles[2] == 0,
+                      "expected the request of the destructed node to be cleared");
+  BOOST_CHECK_MESSAGE(budget->requests[1].node == second,
+                      "expected the request of the other node to be kept");
+
+  // the destructed node does not count against the budget
+  budget->solve(1000);
+  BOOST_CHECK_MESSAGE(budget->assigned.getNumElements() == 0,
+                      "expected the other node to fit in the budget");
+
+  sosselodp_test_request(budget, second, errors, triangles, 3, 0);
+  delete action;
+  int found = 0;
+  SoScreenSpaceErrorLODP::lockBudgets();
+  for (int i = 0; i < SoScreenSpaceErrorLODP::budgets->getLength(); i++) {
+    if ((*SoScreenSpaceErrorLODP::budgets)[i] == budget) found++;
+  }
+  SoScreenSpaceErrorLODP::unlockBudgets();
+  BOOST_CHECK_MESSAGE(found == 0, "expected the budget of the destructed action to be removed");
+
+  second->unref();
+}
+
+#endif // COIN_INT_TEST_SUITE
+#endif // COIN_TEST_SUITE
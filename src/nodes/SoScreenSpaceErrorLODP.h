@@ -0,0 +1,144 @@
+#ifndef COIN_SOSCREENSPACEERRORLODP_H
+#define COIN_SOSCREENSPACEERRORLODP_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* !COIN_INTERNAL */
+
+#include <Inventor/nodes/SoScreenSpaceErrorLOD.h>
+#include <Inventor/lists/SbList.h>
+
+#include "misc/SbHash.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#ifdef COIN_THREADSAFE
+#include <Inventor/threads/SbMutex.h>
+#endif // COIN_THREADSAFE
+
+class SoGLRenderAction;
+class SoState;
+
+// One node's report to the triangle budget of a frame. The projected
+// errors and triangle counts of its levels are stored in the
+// budget's errors and triangles lists, starting at index first.
+typedef struct {
+  const SoScreenSpaceErrorLOD * node;
+  int first;
+  int numlevels;
+  int desired;
+} sosselod_request;
+
+// The triangle budget of one SoGLRenderAction. Requests are collected
+// during a frame, and solved when the first node is rendered in the
+// next frame.
+class SoScreenSpaceErrorLODBudget {
+public:
+  const SoGLRenderAction * action;
+  uint32_t frame;
+  SbList<sosselod_request> requests;
+  SbList<float> errors;
+  SbList<int32_t> triangles;
+  // the levels the budget forced coarser than the nodes selected
+  SbHash<const SoBase *, int> assigned;
+
+  void solve(const int32_t budget);
+};
+
+class SoScreenSpaceErrorLODP {
+public:
+  SoScreenSpaceErrorLODP(SoScreenSpaceErrorLOD * master)
+    : master(master), renderedchild(-1) { }
+
+  SoScreenSpaceErrorLOD * master;
+  int renderedchild;
+  // triangle counts of the children, -1 when not counted yet
+  SbList<int32_t> trianglecounts;
+
+#ifdef COIN_THREADSAFE
+  SbMutex mutex;
+  static SbMutex * budgetmutex;
+#endif // COIN_THREADSAFE
+
+  static int32_t trianglebudget;
+  static SbList<SoScreenSpaceErrorLODBudget *> * budgets;
+  static void cleanup(void);
+
+  static int selectFromErrors(const float * errors, const int numlevels,
+                              const float maxerror, const float hysteresis,
+                              const int prev);
+  static int32_t solveBudget(const sosselod_request * requests,
+                             const int numrequests,
+                             const float * errors, const int32_t * triangles,
+                             const int32_t budget, int * levels);
+
+  int getNumLevels(void) const {
+    return SbMin(this->master->getNumChildren(),
+                 this->master->geometricError.getNum());
+  }
+  float getPixelScale(SoState * state) const;
+  int selectLevel(SoState * state, SbList<float> & errors) const;
+  int32_t getTriangleCount(SoState * state, const int child);
+  int selectForRender(SoGLRenderAction * action);
+  int requestBudget(SoGLRenderAction * action, const SbList<float> & errors,
+                    const int desired);
+  void removeFromBudgets(void);
+  static void removeBudget(const SoGLRenderAction * action);
+
+  void lock(void) {
+#ifdef COIN_THREADSAFE
+    this->mutex.lock();
+#endif // COIN_THREADSAFE
+  }
+  void unlock(void) {
+#ifdef COIN_THREADSAFE
+    this->mutex.unlock();
+#endif // COIN_THREADSAFE
+  }
+  static void lockBudgets(void) {
+#ifdef COIN_THREADSAFE
+    budgetmutex->lock();
+#endif // COIN_THREADSAFE
+  }
+  static void unlockBudgets(void) {
+#ifdef COIN_THREADSAFE
+    budgetmutex->unlock();
+#endif // COIN_THREADSAFE
+  }
+};
+
+#endif // !COIN_SOSCREENSPACEERRORLODP_H
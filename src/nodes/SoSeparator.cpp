@@ -92,6 +92,7 @@
 #endif // COIN_THREADSAFE
 
 #include "coindefs.h" // COIN_OBSOLETED()
+#include "caches/SoShapeListCache.h"
 #include "nodes/SoSubNodeP.h"
 #include "glue/glp.h"
 #include "rendering/SoGL.h"
@@ -317,6 +318,10 @@ public:
   uint32_t bboxcache_usecount;
   uint32_t bboxcache_destroycount;
 
+  SoShapeListCache * shapelistcache;
+  uint32_t shapelistcache_usecount;
+  uint32_t shapelistcache_destroycount;
+
 #ifdef COIN_THREADSAFE
   // FIXME: a mutex for every SoSeparator instance seems a bit
   // excessive, especially since MSWindows might have rather strict
@@ -441,6 +446,10 @@ SoSeparator::commonConstructor(void)
   PRIVATE(this)->bboxcache_usecount = 0;
   PRIVATE(this)->bboxcache_destroycount = 0;
 
+  PRIVATE(this)->shapelistcache = NULL;
+  PRIVATE(this)->shapelistcache_usecount = 0;
+  PRIVATE(this)->shapelistcache_destroycount = 0;
+
   // This environment variable used for local stability / robustness /
   // correctness testing of the render caching. If set >= 1,
   // renderCaching will be set to "ON" with a probability of 0.5 for
@@ -465,6 +474,9 @@ SoSeparator::~SoSeparator()
   if (PRIVATE(this)->bboxcache) {
     PRIVATE(this)->bboxcache->unref();
   }
+  if (PRIVATE(this)->shapelistcache) {
+    PRIVATE(this)->shapelistcache->unref();
+  }
 }
 
 // Doc from superclass.
@@ -608,9 +620,64 @@ SoSeparator::callback(SoCallbackAction * action)
   // action traversal.
 
   if (!this->cullTest(state)) {
+    if (SoShapeListCache::shouldCompile(action)) {
+      this->compiledCallback(action);
+    }
+    else {
+      SoGroup::callback(action);
+    }
+  }
+  state->pop();
+}
+
+// Replays the compiled shape list of the children if it's valid, or
+// traverses them while recording a new one. See
+// SoCallbackAction::setCompiledTraversal().
+void
+SoSeparator::compiledCallback(SoCallbackAction * action)
+{
+  SoState * state = action->getState();
+
+  if (PRIVATE(this)->shapelistcache &&
+      PRIVATE(this)->shapelistcache->canReplay(action)) {
+    SoCacheElement::addCacheDependency(state, PRIVATE(this)->shapelistcache);
+    PRIVATE(this)->shapelistcache_usecount++;
+    PRIVATE(this)->shapelistcache->replay(action);
+    return;
+  }
+
+  // stop compiling if the list is rebuilt more often than it's used,
+  // like for bounding box caching
+  if (PRIVATE(this)->shapelistcache_destroycount > 10 &&
+      float(PRIVATE(this)->shapelistcache_usecount) /
+      float(PRIVATE(this)->shapelistcache_destroycount) < 5.0f) {
     SoGroup::callback(action);
+    return;
   }
+
+  SbBool storedinvalid = SoCacheElement::setInvalid(FALSE);
+  state->push();
+
+  // lock before changing the cache pointer so that the notify()
+  // function can be used by another thread.
+  PRIVATE(this)->lock();
+  if (PRIVATE(this)->shapelistcache) {
+    PRIVATE(this)->shapelistcache_destroycount++;
+    PRIVATE(this)->shapelistcache->unref();
+  }
+  SoShapeListCache * cache = new SoShapeListCache(state);
+  cache->ref();
+  PRIVATE(this)->shapelistcache = cache;
+  PRIVATE(this)->unlock();
+
+  // set active cache to record cache dependencies
+  SoCacheElement::set(state, cache);
+  cache->beginRecording(action);
+  SoGroup::callback(action);
+  cache->endRecording(action);
+
   state->pop();
+  SoCacheElement::setInvalid(storedinvalid);
 }
 
 // *************************************************************************
@@ -951,6 +1018,7 @@ SoSeparator::notify(SoNotList * nl)
   // are valid while reading them
   PRIVATE(this)->lock();
   if (PRIVATE(this)->bboxcache) PRIVATE(this)->bboxcache->invalidate();
+  if (PRIVATE(this)->shapelistcache) PRIVATE(this)->shapelistcache->invalidate();
   PRIVATE(this)->invalidateGLCaches();
   PRIVATE(this)->hassoundchild = SoSeparatorP::MAYBE;
   PRIVATE(this)->unlock();
@@ -68,6 +68,9 @@
 
 #define SO_NODE_INTERNAL_CONSTRUCTOR(_class_) \
   do { \
+    /* The class may not have been initialized yet, see */ \
+    /* SO_NODE_INTERNAL_DEFER_INIT_CLASS(). */ \
+    (void)_class_::getClassTypeId(); \
     SoBase::staticDataLock(); \
     SO_NODE_CONSTRUCTOR_NOLOCK(_class_); \
     /* Restore value of isBuiltIn flag (which is set to FALSE */ \
@@ -93,6 +96,15 @@
   } while (0)
 
 
+// Registers the class to be initialized the first time its type is
+// asked for, instead of right away. Only for classes which do nothing
+// in initClass() that other classes depend on, like enabling elements.
+#define SO_NODE_INTERNAL_DEFER_INIT_CLASS(_class_, _parentclass_) \
+  do { \
+    SoType::deferInitClass(SO__QUOTE(_class_), SO__QUOTE(_parentclass_), \
+                           _class_::initClass); \
+  } while (0)
+
 // *************************************************************************
 
 // Convenience defines to use for the second parameter of the
@@ -201,6 +201,8 @@
 
 #include "coindefs.h" // COIN_OBSOLETED()
 #include "elements/SoTextureScalePolicyElement.h"
+#include "misc/SbImagePyramid.h"
+#include "misc/SoTextureLoader.h"
 #include "nodes/SoSubNodeP.h"
 #include "tidbitsp.h"
 #include <Inventor/C/glue/gl.h>
@@ -375,10 +377,13 @@
 
 class SoTexture2P {
 public:
+  SoTexture2 * master;
   int readstatus;
   SoGLImage * glimage;
   SbBool glimagevalid;
   SoFieldSensor * filenamesensor;
+  // set when filename names a pyramid file for SoGLBigImage
+  SbString pyramidfile;
 
   static SbMutex * mutex;
 
@@ -386,6 +391,10 @@ public:
     delete SoTexture2P::mutex;
     SoTexture2P::mutex = NULL;
   }
+
+  static void imageLoadedCB(void * closure, SbImage * const * images,
+                            const int numimages);
+  SbBool readPyramidFile(const SbString & fullname);
 };
 
 SbMutex * SoTexture2P::mutex = NULL;
@@ -412,6 +421,7 @@ SO_NODE_SOURCE(SoTexture2);
 SoTexture2::SoTexture2(void)
 {
   PRIVATE(this) = new SoTexture2P;
+  PRIVATE(this)->master = this;
 
   SO_NODE_INTERNAL_CONSTRUCTOR(SoTexture2);
 
@@ -453,6 +463,7 @@ SoTexture2::SoTexture2(void)
 */
 SoTexture2::~SoTexture2()
 {
+  SoTextureLoader::cancel(this);
   if (PRIVATE(this)->glimage) PRIVATE(this)->glimage->unref(NULL);
   delete PRIVATE(this)->filenamesensor;
   delete PRIVATE(this);
@@ -519,10 +530,16 @@ SoTexture2::GLRender(SoGLRenderAction * action)
 
   float quality = SoTextureQualityElement::get(state);
 
+  // bring the image in view forward in the loader queue
+  if (SoTextureLoader::isLoading(this)) {
+    SoTextureLoader::setPriority(this, SoTextureLoader::getPriority(state));
+  }
+
   const cc_glglue * glue = cc_glglue_instance(SoGLCacheContextElement::get(state));
   SoTextureScalePolicyElement::Policy scalepolicy =
     SoTextureScalePolicyElement::get(state);
-  SbBool needbig = (scalepolicy == SoTextureScalePolicyElement::FRACTURE);
+  SbBool needbig = (scalepolicy == SoTextureScalePolicyElement::FRACTURE) ||
+    PRIVATE(this)->pyramidfile.getLength() > 0;
   SoType glimagetype = PRIVATE(this)->glimage ? PRIVATE(this)->glimage->getTypeId() : SoType::badType();
     
   LOCK_GLIMAGE(this);
@@ -534,6 +551,14 @@ SoTexture2::GLRender(SoGLRenderAction * action)
     SbVec2s size;
     const unsigned char * bytes =
       this->image.getValue(size, nc);
+
+    // render with a blank texture until the image file has been read
+    if ((!bytes || size == SbVec2s(0,0)) && SoTextureLoader::isLoading(this)) {
+      static const unsigned char placeholder[] = {0xff,0xff,0xff,0xff};
+      bytes = placeholder;
+      size = SbVec2s(2,2);
+      nc = 1;
+    }
     
     if (needbig &&
         (glimagetype != SoGLBigImage::getClassTypeId())) {
@@ -555,7 +580,16 @@ SoTexture2::GLRender(SoGLRenderAction * action)
       PRIVATE(this)->glimage->setFlags(PRIVATE(this)->glimage->getFlags()|SoGLImage::SCALE_DOWN);
     }
 
-    if (bytes && size != SbVec2s(0,0)) {
+    if (PRIVATE(this)->pyramidfile.getLength() > 0) {
+      PRIVATE(this)->glimagevalid =
+        ((SoGLBigImage *) PRIVATE(this)->glimage)->
+        setPyramidFile(PRIVATE(this)->pyramidfile,
+                       translateWrap((Wrap)this->wrapS.getValue()),
+                       translateWrap((Wrap)this->wrapT.getValue()),
+                       quality);
+      if (!PRIVATE(this)->glimagevalid) PRIVATE(this)->pyramidfile.makeEmpty();
+    }
+    else if (bytes && size != SbVec2s(0,0)) {
       PRIVATE(this)->glimage->setData(bytes, size, nc,
                              translateWrap((Wrap)this->wrapS.getValue()),
                              translateWrap((Wrap)this->wrapT.getValue()),
@@ -622,6 +656,9 @@ SoTexture2::doAction(SoAction * action)
   if ((unit == 0) && SoTextureOverrideElement::getImageOverride(state))
     return;
 
+  // only GLRender() can do with a placeholder while the file is read
+  SoTextureLoader::finish(this);
+
   int nc;
   SbVec2s size;
   const unsigned char * bytes = this->image.getValue(size, nc);
@@ -705,6 +742,9 @@ SoTexture2::notify(SoNotList * l)
   SoField * f = l->getLastField();
   if (f == &this->image) {
     PRIVATE(this)->glimagevalid = FALSE;
+    // image set explicitly, forget about the file being read
+    SoTextureLoader::cancel(this);
+    PRIVATE(this)->pyramidfile.makeEmpty();
 
     // write image, not filename
     this->filename.setDefault(TRUE);
@@ -724,11 +764,33 @@ SbBool
 SoTexture2::loadFilename(void)
 {
   SbBool retval = FALSE;
+  PRIVATE(this)->pyramidfile.makeEmpty();
   if (this->filename.getValue().getLength()) {
     SbImage tmpimage;
     const SbStringList & sl = SoInput::getDirectories();
-    if (tmpimage.readFile(this->filename.getValue(),
-                          sl.getArrayPtr(), sl.getLength())) {
+    const SbString fullname =
+      SbImage::searchForFile(this->filename.getValue(), sl.getArrayPtr(),
+                             sl.getLength());
+    // Pyramid files are rendered by SoGLBigImage, which reads only the
+    // parts it needs. Other files found on disk are read in the
+    // background if the texture loader is enabled. The rest go
+    // through SbImage::readFile() right away,
+    // so that errors are reported while reading the scene, and custom
+    // image readers registered with SbImage::addReadImageCB() still
+    // get to load images which are not files.
+    if (fullname.getLength() > 0 &&
+        SbImagePyramid::isPyramidFile(fullname.getString())) {
+      SoTextureLoader::cancel(this);
+      retval = PRIVATE(this)->readPyramidFile(fullname);
+    }
+    else if (SoTextureLoader::isEnabled() && fullname.getLength() > 0) {
+      SoTextureLoader::load(this, &this->filename.getValue(), 1,
+                            sl.getArrayPtr(), sl.getLength(),
+                            SoTexture2P::imageLoadedCB, PRIVATE(this));
+      retval = TRUE;
+    }
+    else if (tmpimage.readFile(this->filename.getValue(),
+                               sl.getArrayPtr(), sl.getLength())) {
       int nc;
       SbVec2s size;
       unsigned char * bytes = tmpimage.getValue(size, nc);
@@ -763,13 +825,219 @@ SoTexture2::filenameSensorCB(void * data, SoSensor *)
   }
   else if (thisp->filename.getValue() == "") {
     // setting filename to "" should reset the node to its initial state
+    SoTextureLoader::cancel(thisp);
     thisp->setReadStatus(0);
+    PRIVATE(thisp)->pyramidfile.makeEmpty();
     thisp->image.setValue(SbVec2s(0,0), 0, NULL);
     thisp->image.setDefault(TRUE);
     thisp->filename.setDefault(TRUE);
   }
 }
 
+//
+// called when an image file read in the background is ready
+//
+void
+SoTexture2P::imageLoadedCB(void * closure, SbImage * const * images,
+                           const int COIN_UNUSED_ARG(numimages))
+{
+  SoTexture2P * thisp = (SoTexture2P *) closure;
+  SoTexture2 * master = thisp->master;
+
+  int nc;
+  SbVec2s size;
+  unsigned char * bytes = images[0]->getValue(size, nc);
+  if (bytes) {
+    // disable notification on image while setting data from filename
+    // as a notify will cause a filename.setDefault(TRUE).
+    SbBool oldnotify = master->image.enableNotify(FALSE);
+    master->image.setValue(size, nc, bytes);
+    master->image.enableNotify(oldnotify);
+    thisp->readstatus = 1;
+  }
+  else {
+    SoDebugError::postWarning("SoTexture2::loadFilename",
+                              "Image file '%s' could not be read",
+                              master->filename.getValue().getString());
+    thisp->readstatus = 0;
+  }
+  master->image.setDefault(TRUE); // write filename, not image
+
+#ifdef COIN_THREADSAFE
+  SoTexture2P::mutex->lock();
+#endif // COIN_THREADSAFE
+  thisp->glimagevalid = FALSE; // recreate GL image in next GLRender()
+#ifdef COIN_THREADSAFE
+  SoTexture2P::mutex->unlock();
+#endif // COIN_THREADSAFE
+  master->touch(); // trigger a redraw
+}
+
+//
+// sets up rendering from a pyramid file. The image field gets the
+// lowest resolution level of the pyramid, for the actions which use
+// the image directly.
+//
+SbBool
+SoTexture2P::readPyramidFile(const SbString & fullname)
+{
+  SbImagePyramid pyramid;
+  if (!pyramid.open(fullname.getString())) return FALSE;
+
+  const int level = pyramid.getNumLevels() - 1;
+  const SbVec2i32 size = pyramid.getLevelSize(level);
+  const int nc = pyramid.getNumComponents();
+  unsigned char * bytes = new unsigned char[size[0] * size[1] * nc];
+  const SbBool ok = pyramid.getRegion(level, SbVec2i32(0, 0), size, bytes);
+  if (ok) {
+    // disable notification on image while setting data from filename
+    // as a notify will cause a filename.setDefault(TRUE).
+    SbBool oldnotify = this->master->image.enableNotify(FALSE);
+    this->master->image.setValue(SbVec2s((short) size[0], (short) size[1]), nc, bytes);
+    this->master->image.enableNotify(oldnotify);
+    this->pyramidfile = fullname;
+    this->glimagevalid = FALSE; // recreate GL image in next GLRender()
+  }
+  delete[] bytes;
+  return ok;
+}
+
 #undef LOCK_GLIMAGE
 #undef UNLOCK_GLIMAGE
 #undef PRIVATE
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <cstdio>
+#include <Inventor/SbImage.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/C/tidbits.h>
+#include <Inventor/C/threads/thread.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/sensors/SoSensorManager.h>
+
+// The test images are small text files holding width, height and a
+// pixel value, decoded by a custom SbImage reader.
+static SbBool
+texture2_read_test_image(const SbString & filename, SbImage * image,
+                         void * /* closure */)
+{
+  if (filename.find(".tex2test") < 0) return FALSE;
+  FILE * fp = fopen(filename.getString(), "r");
+  if (!fp) return FALSE;
+  int w = 0, h = 0, value = 0;
+  const int num = fscanf(fp, "%d %d %d", &w, &h, &value);
+  fclose(fp);
+  if (num != 3) return FALSE;
+
+  SbList<unsigned char> bytes;
+  for (int i = 0; i < w * h; i++) bytes.append((unsigned char) value);
+  image->setValue(SbVec2s((short) w, (short) h), 1, bytes.getArrayPtr());
+  return TRUE;
+}
+
+static SbString
+texture2_write_test_image(const int idx, const int w, const int h,
+                          const int value)
+{
+  SbString name;
+  name.sprintf("texture2-%d.tex2test", idx);
+  FILE * fp = fopen(name.getString(), "w");
+  fprintf(fp, "%d %d %d\n", w, h, value);
+  fclose(fp);
+  return name;
+}
+
+// processes the sensor queue until an image of size \a expected has
+// been delivered, or for at most \a seconds
+static SbBool
+texture2_wait_for_image(SoTexture2 * tex, const SbVec2s & expected,
+                        const double seconds)
+{
+  const SbTime start = SbTime::getTimeOfDay();
+  int nc;
+  SbVec2s size;
+  while ((SbTime::getTimeOfDay() - start).getValue() < seconds) {
+    SoDB::getSensorManager()->processTimerQueue();
+    (void) tex->image.getValue(size, nc);
+    if (size == expected) return TRUE;
+    cc_sleep(0.01f);
+  }
+  return FALSE;
+}
+
+BOOST_AUTO_TEST_CASE(syncImageFile)
+{
+  SbImage::addReadImageCB(texture2_read_test_image, NULL);
+  const SbString name = texture2_write_test_image(0, 4, 2, 0x42);
+
+  SoTexture2 * tex = new SoTexture2;
+  tex->ref();
+  tex->filename = name;
+
+  int nc;
+  SbVec2s size;
+  const unsigned char * bytes = tex->image.getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(4, 2) && nc == 1 && bytes && bytes[7] == 0x42,
+                      "image file not read by default");
+  BOOST_CHECK_MESSAGE(tex->image.isDefault(), "image field should not be written");
+  tex->unref();
+
+  SbImage::removeReadImageCB(texture2_read_test_image, NULL);
+  remove(name.getString());
+}
+
+BOOST_AUTO_TEST_CASE(asyncImageFile)
+{
+  SbImage::addReadImageCB(texture2_read_test_image, NULL);
+  coin_setenv("COIN_ASYNC_TEXTURE_LOADING", "1", TRUE);
+  const SbString name = texture2_write_test_image(0, 4, 2, 0x42);
+  const SbString other = texture2_write_test_image(1, 8, 8, 0x10);
+
+  SoTexture2 * tex = new SoTexture2;
+  tex->ref();
+  tex->filename = name;
+
+  // the image is delivered from the sensor queue
+  int nc;
+  SbVec2s size;
+  const unsigned char * bytes = tex->image.getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(0, 0), "image file read synchronously");
+
+  // other actions than SoGLRenderAction wait for the image
+  SoCallbackAction cba;
+  cba.apply(tex);
+  bytes = tex->image.getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(4, 2) && nc == 1 && bytes && bytes[7] == 0x42,
+                      "SoCallbackAction did not wait for the image");
+  BOOST_CHECK_MESSAGE(tex->image.isDefault(), "image field should not be written");
+
+  tex->filename = other;
+  BOOST_CHECK_MESSAGE(texture2_wait_for_image(tex, SbVec2s(8, 8), 10.0),
+                      "image not delivered from the sensor queue");
+
+  // explicitly setting the image cancels the pending load
+  tex->filename = name;
+  const unsigned char pixel = 0x99;
+  tex->image.setValue(SbVec2s(1, 1), 1, &pixel);
+  (void) texture2_wait_for_image(tex, SbVec2s(4, 2), 0.2);
+  cba.apply(tex);
+  bytes = tex->image.getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(1, 1) && bytes[0] == 0x99,
+                      "cancelled image was still delivered");
+
+  // deleting the node while loading
+  tex->filename = other;
+  tex->unref();
+  SoDB::getSensorManager()->processTimerQueue();
+
+  coin_unsetenv("COIN_ASYNC_TEXTURE_LOADING");
+  SbImage::removeReadImageCB(texture2_read_test_image, NULL);
+  remove(name.getString());
+  remove(other.getString());
+}
+
+#endif // COIN_TEST_SUITE
@@ -97,6 +97,7 @@
 
 #include "nodes/SoSubNodeP.h"
 #include "elements/SoTextureScalePolicyElement.h"
+#include "misc/SoTextureLoader.h"
 
 // *************************************************************************
 
@@ -227,6 +228,7 @@ SoTexture3::SoTexture3(void)
 */
 SoTexture3::~SoTexture3()
 {
+  SoTextureLoader::cancel(this);
   if (this->glimage) this->glimage->unref(NULL);
   delete this->filenamesensor;
 }
@@ -296,10 +298,26 @@ SoTexture3::GLRender(SoGLRenderAction * action)
     return;
 
   float quality = SoTextureQualityElement::get(state);
+
+  // bring the volume in view forward in the loader queue
+  const SbBool loading = SoTextureLoader::isLoading(this);
+  if (loading) {
+    SoTextureLoader::setPriority(this, SoTextureLoader::getPriority(state));
+  }
+
   if (!this->glimagevalid) {
     int nc;
     SbVec3s size;
     const unsigned char *bytes = this->images.getValue(size, nc);
+
+    // render with a blank texture until the image files have been read
+    if ((!bytes || size == SbVec3s(0,0,0)) && loading) {
+      static const unsigned char placeholder[] = {0xff,0xff,0xff,0xff,
+                                                  0xff,0xff,0xff,0xff};
+      bytes = placeholder;
+      size = SbVec3s(2,2,2);
+      nc = 1;
+    }
     //FIXME: 3D support in SoGLBigImage (kintel 20011113)
 //      SbBool needbig =
 //        SoTextureScalePolicyElement::get(state) ==
@@ -361,6 +379,9 @@ SoTexture3::doAction(SoAction *action)
   if (SoTextureOverrideElement::getImageOverride(state) && unit == 0)
     return;
 
+  // only GLRender() can do with a placeholder while the files are read
+  SoTextureLoader::finish(this);
+
   int nc;
   SbVec3s size;
   const unsigned char *bytes = this->images.getValue(size, nc);
@@ -432,6 +453,8 @@ SoTexture3::notify(SoNotList * l)
   SoField *f = l->getLastField();
   if (f == &this->images) {
     this->glimagevalid = FALSE;
+    // images set explicitly, forget about the files being read
+    SoTextureLoader::cancel(this);
     this->filenames.setDefault(TRUE); // write image, not filename
   }
   else if (f == &this->wrapS || f == &this->wrapT || f == &this->wrapR) {
@@ -440,6 +463,76 @@ SoTexture3::notify(SoNotList * l)
   inherited::notify(l);
 }
 
+// Reports a problem with the texture files, as a read error if the
+// files are read as part of reading a scene graph.
+static void
+texture3_post_error(SoInput * in, const SbString & errstr)
+{
+  if (in) SoReadError::post(in, errstr.getString());
+  else SoDebugError::postWarning("SoTexture3::loadFilenames()",
+                                 errstr.getString());
+}
+
+// Copies \a image into layer \a n of the volume in \a images. The
+// volume is allocated from the first image. Returns 1 on success, 0
+// if the image file could not be read and -1 if the image doesn't
+// match the size of the first one.
+static int
+texture3_set_layer(SoTexture3 * tex, const int n, const SbImage & image,
+                   SbVec3s & volumeSize, int & volumenc, SoInput * in)
+{
+  const int numImages = tex->filenames.getNum();
+  const SbString & filename = tex->filenames[n];
+
+  int nc;
+  SbVec3s size;
+  unsigned char *imgbytes = image.getValue(size, nc);
+  if (!imgbytes) {
+    SbString errstr;
+    errstr.sprintf("Could not read texture file #%d: %s",
+                   n, filename.getString());
+    texture3_post_error(in, errstr);
+    return 0;
+  }
+
+  if (size[2]==0) size[2]=1;
+  if (tex->images.isDefault()) { // First time => allocate memory
+    volumeSize.setValue(size[0],
+                        size[1],
+                        size[2]*numImages);
+    volumenc = nc;
+    tex->images.setValue(volumeSize, nc, NULL);
+  }
+  else { // Verify size & components
+    if (size[0] != volumeSize[0] ||
+        size[1] != volumeSize[1] ||
+        //FIXME: always 1 or what? (kintel 20020110)
+        size[2] != (volumeSize[2]/numImages) ||
+        nc != volumenc) {
+      SbString errstr;
+      errstr.sprintf("Texture file #%d (%s) has wrong size:"
+                     "Expected (%d,%d,%d,%d) got (%d,%d,%d,%d)\n",
+                     n, filename.getString(),
+                     volumeSize[0],volumeSize[1],volumeSize[2],
+                     volumenc,
+                     size[0],size[1],size[2],nc);
+      texture3_post_error(in, errstr);
+      return -1;
+    }
+  }
+
+  // disable notification on images while setting data from the
+  // filenames as a notify will cause a filenames.setDefault(TRUE).
+  SbBool oldnotify = tex->images.enableNotify(FALSE);
+  unsigned char *volbytes = tex->images.startEditing(volumeSize,
+                                                     volumenc);
+  memcpy(volbytes+int(size[0])*int(size[1])*int(size[2])*nc*n,
+         imgbytes, int(size[0])*int(size[1])*int(size[2])*nc);
+  tex->images.finishEditing();
+  tex->images.enableNotify(oldnotify);
+  return 1;
+}
+
 //
 // Called from readInstance() or when user changes the
 // filenames field. \e in is set if this function is called
@@ -453,74 +546,39 @@ SoTexture3::loadFilenames(SoInput * in)
 {
   SbBool retval = FALSE;
   SbVec3s volumeSize(0,0,0);
-  int volumenc;
+  int volumenc = 0;
   int numImages = this->filenames.getNum();
-  SbBool sizeError = FALSE;
+  const SbStringList &sl = SoInput::getDirectories();
   int i;
 
   // Fail on empty filenames
   for (i=0;i<numImages;i++) if (this->filenames[i].getLength()==0) break;
 
   if (i==numImages) { // All filenames valid
-    for (int n=0 ; n<numImages && !sizeError ; n++) {
-      SbString filename = this->filenames[n];
-      SbImage tmpimage;
-      const SbStringList &sl = SoInput::getDirectories();
-      if (tmpimage.readFile(filename, sl.getArrayPtr(), sl.getLength())) {
-        int nc;
-        SbVec3s size;
-        unsigned char *imgbytes = tmpimage.getValue(size, nc);
-        if (size[2]==0) size[2]=1;
-        if (this->images.isDefault()) { // First time => allocate memory
-          volumeSize.setValue(size[0],
-                              size[1],
-                              size[2]*numImages);
-          volumenc = nc;
-          this->images.setValue(volumeSize, nc, NULL);
-        }
-        else { // Verify size & components
-          if (size[0] != volumeSize[0] ||
-              size[1] != volumeSize[1] ||
-              //FIXME: always 1 or what? (kintel 20020110)
-              size[2] != (volumeSize[2]/numImages) ||
-              nc != volumenc) {
-            sizeError = TRUE;
-            retval = FALSE;
-
-            SbString errstr;
-            errstr.sprintf("Texture file #%d (%s) has wrong size:"
-                           "Expected (%d,%d,%d,%d) got (%d,%d,%d,%d)\n",
-                           n, filename.getString(),
-                           volumeSize[0],volumeSize[1],volumeSize[2],
-                           volumenc,
-                           size[0],size[1],size[2],nc);
-            if (in) SoReadError::post(in, errstr.getString());
-            else SoDebugError::postWarning("SoTexture3::loadFilenames()",
-                                           errstr.getString());
-          }
-        }
-        if (!sizeError) {
-          // disable notification on images while setting data from the
-          // filenames as a notify will cause a filenames.setDefault(TRUE).
-          SbBool oldnotify = this->images.enableNotify(FALSE);
-          unsigned char *volbytes = this->images.startEditing(volumeSize,
-                                                              volumenc);
-          memcpy(volbytes+int(size[0])*int(size[1])*int(size[2])*nc*n,
-                 imgbytes, int(size[0])*int(size[1])*int(size[2])*nc);
-          this->images.finishEditing();
-          this->images.enableNotify(oldnotify);
-          this->glimagevalid = FALSE; // recreate GL images in next GLRender()
-          retval = TRUE;
-        }
-      }
-      else {
-        SbString errstr;
-        errstr.sprintf("Could not read texture file #%d: %s",
-                       n, filename.getString());
-        if (in) SoReadError::post(in, errstr.getString());
-        else SoDebugError::postWarning("SoTexture3::loadFilenames()",
-                                       errstr.getString());
-        retval = FALSE;
+    // Read the files in the background if they can all be found on
+    // disk. Otherwise read them right away, so errors are reported
+    // while reading the scene.
+    SbBool async = SoTextureLoader::isEnabled();
+    for (i=0;i<numImages && async;i++) {
+      async = SbImage::searchForFile(this->filenames[i], sl.getArrayPtr(),
+                                     sl.getLength()).getLength() > 0;
+    }
+    if (async) {
+      SoTextureLoader::load(this, this->filenames.getValues(0), numImages,
+                            sl.getArrayPtr(), sl.getLength(),
+                            SoTexture3::imagesLoadedCB, this);
+      retval = TRUE;
+    }
+    else {
+      for (int n=0 ; n<numImages ; n++) {
+        SbImage tmpimage;
+        (void) tmpimage.readFile(this->filenames[n],
+                                 sl.getArrayPtr(), sl.getLength());
+        const int result = texture3_set_layer(this, n, tmpimage,
+                                              volumeSize, volumenc, in);
+        retval = (result > 0);
+        if (retval) this->glimagevalid = FALSE; // recreate GL images in next GLRender()
+        if (result < 0) break;
       }
     }
   }
@@ -529,6 +587,29 @@ SoTexture3::loadFilenames(SoInput * in)
   return retval;
 }
 
+//
+// called when the image files read in the background are ready
+//
+void
+SoTexture3::imagesLoadedCB(void * closure, SbImage * const * images,
+                           const int numimages)
+{
+  SoTexture3 * thisp = (SoTexture3 *) closure;
+  SbVec3s volumeSize(0,0,0);
+  int volumenc = 0;
+  SbBool ok = TRUE;
+  for (int n = 0; n < numimages; n++) {
+    const int result = texture3_set_layer(thisp, n, *images[n],
+                                          volumeSize, volumenc, NULL);
+    if (result <= 0) ok = FALSE;
+    if (result < 0) break;
+  }
+  thisp->images.setDefault(TRUE); // write filenames, not images
+  thisp->setReadStatus(ok);
+  thisp->glimagevalid = FALSE; // recreate GL images in next GLRender()
+  thisp->touch(); // trigger a redraw
+}
+
 //
 // called when \e filenames changes
 //
@@ -537,6 +618,7 @@ SoTexture3::filenameSensorCB(void * data, SoSensor *)
 {
   SoTexture3 *thisp = (SoTexture3 *)data;
 
+  SoTextureLoader::cancel(thisp);
   thisp->setReadStatus(TRUE);
   if (thisp->filenames.getNum()<0 ||
       thisp->filenames[0].getLength() &&
@@ -544,3 +626,70 @@ SoTexture3::filenameSensorCB(void * data, SoSensor *)
     thisp->setReadStatus(FALSE);
   }
 }
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <cstdio>
+#include <Inventor/SbImage.h>
+#include <Inventor/C/tidbits.h>
+#include <Inventor/actions/SoCallbackAction.h>
+
+// The test images are small text files holding width, height and a
+// pixel value, decoded by a custom SbImage reader.
+static SbBool
+texture3_read_test_image(const SbString & filename, SbImage * image,
+                         void * /* closure */)
+{
+  if (filename.find(".tex3test") < 0) return FALSE;
+  FILE * fp = fopen(filename.getString(), "r");
+  if (!fp) return FALSE;
+  int w = 0, h = 0, value = 0;
+  const int num = fscanf(fp, "%d %d %d", &w, &h, &value);
+  fclose(fp);
+  if (num != 3) return FALSE;
+
+  SbList<unsigned char> bytes;
+  for (int i = 0; i < w * h; i++) bytes.append((unsigned char) value);
+  image->setValue(SbVec2s((short) w, (short) h), 1, bytes.getArrayPtr());
+  return TRUE;
+}
+
+BOOST_AUTO_TEST_CASE(asyncImageFiles)
+{
+  SbImage::addReadImageCB(texture3_read_test_image, NULL);
+  coin_setenv("COIN_ASYNC_TEXTURE_LOADING", "1", TRUE);
+  SbString names[3];
+  for (int i = 0; i < 3; i++) {
+    names[i].sprintf("texture3-%d.tex3test", i);
+    FILE * fp = fopen(names[i].getString(), "w");
+    fprintf(fp, "2 2 %d\n", i + 1);
+    fclose(fp);
+  }
+
+  SoTexture3 * tex = new SoTexture3;
+  tex->ref();
+  tex->filenames.setValues(0, 3, names);
+
+  // SoCallbackAction waits for the images to be read
+  SoCallbackAction cba;
+  cba.apply(tex);
+
+  int nc;
+  SbVec3s size;
+  const unsigned char * bytes = tex->images.getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec3s(2, 2, 3) && nc == 1 && bytes,
+                      "volume not assembled from the image files");
+  if (bytes) {
+    BOOST_CHECK_MESSAGE(bytes[0] == 1 && bytes[4] == 2 && bytes[11] == 3,
+                        "volume layers in the wrong order");
+  }
+  tex->unref();
+
+  coin_unsetenv("COIN_ASYNC_TEXTURE_LOADING");
+  SbImage::removeReadImageCB(texture3_read_test_image, NULL);
+  for (int i = 0; i < 3; i++) remove(names[i].getString());
+}
+
+#endif // COIN_TEST_SUITE
@@ -59,6 +59,7 @@
 #include "SoFrustumCamera.cpp"
 #include "SoGroup.cpp"
 #include "SoInfo.cpp"
+#include "SoInstancedCopy.cpp"
 #include "SoLOD.cpp"
 #include "SoLabel.cpp"
 #include "SoLevelOfDetail.cpp"
@@ -93,6 +94,8 @@
 #include "SoScale.cpp"
 #include "SoSceneTexture2.cpp"
 #include "SoSceneTextureCubeMap.cpp"
+#include "SoScreenSpaceErrorLOD.cpp"
+#include "SoScreenSpaceErrorLODP.cpp"
 #include "SoSelection.cpp"
 #include "SoSeparator.cpp"
 #include "SoShapeHints.cpp"
@@ -57,6 +57,7 @@ struct SbNodeProfilingData {
   SbTime traversaltime;
   size_t memorysize;
   size_t texturesize;
+  size_t sharedsize;
   int traversalcount;
 
   struct {
@@ -93,7 +94,8 @@ struct SbNameProfilingData {
 SbNodeProfilingData::SbNodeProfilingData(void)
 : node(NULL), /* nodename(NULL), */ nodetype(0),
   parentidx(-1), childidx(0),
-  traversaltime(0.0), memorysize(0), texturesize(0), traversalcount(0)
+  traversaltime(0.0), memorysize(0), texturesize(0), sharedsize(0),
+  traversalcount(0)
 {
   this->flags.glcached = 0;
   this->flags.culled = 0;
@@ -335,6 +337,7 @@ SbProfilingData::operator += (const SbProfilingData & rhs)
       dst[matchidx].traversaltime += src[c].traversaltime;
       dst[matchidx].memorysize += src[c].memorysize;
       dst[matchidx].texturesize += src[c].texturesize;
+      dst[matchidx].sharedsize += src[c].sharedsize;
       dst[matchidx].traversalcount += src[c].traversalcount;
     }
   }
@@ -921,6 +924,9 @@ SbProfilingData::setNodeFootprint(int idx, FootprintType footprinttype, size_t f
   case VIDEO_MEMORY_SIZE:
     PRIVATE(this)->nodeData[idx].texturesize = footprint;
     break;
+  case SHARED_MEMORY_SIZE:
+    PRIVATE(this)->nodeData[idx].sharedsize = footprint;
+    break;
   default:
     break;
   }
@@ -954,6 +960,9 @@ SbProfilingData::getNodeFootprint(int idx, FootprintType footprinttype, unsigned
   case VIDEO_MEMORY_SIZE:
     footprint = PRIVATE(this)->nodeData[idx].texturesize;
     break;
+  case SHARED_MEMORY_SIZE:
+    footprint = PRIVATE(this)->nodeData[idx].sharedsize;
+    break;
   default:
     break;
   }
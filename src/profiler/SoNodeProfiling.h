@@ -83,6 +83,9 @@ public:
                           SbProfilingData::MEMORY_SIZE, managedmem);
     data.setNodeFootprint(this->entryindex,
                           SbProfilingData::VIDEO_MEMORY_SIZE, 0);
+    data.setNodeFootprint(this->entryindex,
+                          SbProfilingData::SHARED_MEMORY_SIZE,
+                          fullpath->getTail()->getFieldsSharedMemorySize());
     this->pretime = SbTime::getTimeOfDay();
   }
 
@@ -56,6 +56,20 @@
   is doubled, and creating the texture object is much slower, so we
   avoid this for SoGLBigImage.
 
+  The subtextures are kept within a texture memory limit (see
+  setTextureMemoryLimit()). When a new subtexture does not fit, the
+  subtextures which have been unused for the longest time are deleted
+  first. If that is not enough, the new subtexture is created with a
+  lower resolution.
+
+  Images which are too large to keep in memory can be read from a
+  pyramid file instead of an SbImage. A pyramid file holds the image
+  and all its lower resolution levels split into tiles, and is written
+  once by createPyramidFile(). When rendering, only the parts of the
+  levels needed for the visible subtextures are read, through a memory
+  mapping of the file where the platform supports it. SoTexture2 uses
+  a pyramid file when its filename field names one.
+
   \COIN_CLASS_EXTENSION
 
   \since Coin 2.0
@@ -76,7 +90,9 @@
 #endif // HAVE_CONFIG_H
 
 #include <Inventor/C/threads/storage.h>
+#include <Inventor/C/tidbits.h>
 #include <Inventor/SbImage.h>
+#include <Inventor/SbString.h>
 #include <Inventor/elements/SoGLCacheContextElement.h>
 #include <Inventor/elements/SoGLDisplayList.h>
 #include <Inventor/errors/SoDebugError.h>
@@ -87,6 +103,8 @@
 #endif // COIN_THREADSAFE
 
 #include "tidbitsp.h"
+#include "misc/SbImagePyramid.h"
+#include "misc/SbImageResize.h"
 #include "rendering/SoGL.h"
 
 // *************************************************************************
@@ -96,6 +114,11 @@
 // on an image, as only few textures are changed each frame.
 static int CHANGELIMIT = 4;
 
+// the number of bytes of texture memory the subtextures of each image
+// may use. 0 means no limit.
+#define DEFAULT_TEXTUREMEMORYLIMIT (256 * 1024 * 1024)
+static size_t TEXTUREMEMORYLIMIT = DEFAULT_TEXTUREMEMORYLIMIT;
+
 // the texturequality limit when linear filtering will be used
 #define LINEAR_LIMIT 0.1f
 
@@ -113,8 +136,12 @@ typedef struct {
   SbImage ** imagearray;
   int * glimagediv;
   uint32_t * glimageage;
+  int * glimagebytes;
+  size_t texturebytes;
   int changecnt;
   unsigned int * averagebuf;
+  unsigned char * regionbuf;
+  int regionbufsize;
 } SoGLBigImageTls;
 
 class SoGLBigImageP {
@@ -131,6 +158,8 @@ public:
   unsigned char ** cache;
   SbVec2s * cachesize;
   int numcachelevels;
+  SbImagePyramid * pyramid;
+  SbImage preview;
 
   // inline for speed
   inline SoGLBigImageTls * getTls(void) {
@@ -163,6 +192,15 @@ public:
                           const int nc,
                           unsigned char * dst,
                           const SbVec2s & targetsize);
+  void copyPyramidSubImage(SoGLBigImageTls * tls,
+                           const int idx,
+                           unsigned char * dst,
+                           const int level,
+                           const SbVec2s & targetsize);
+  void getImageSize(const SoGLBigImage * master, SbVec2i32 & size, int & nc) const;
+  static SbBool makeRoom(SoGLBigImageTls * tls, SoState * state,
+                         const int idx, const int numbytes);
+  static void unrefSubImage(SoGLBigImageTls * tls, SoState * state, const int idx);
   void resetAllTls(SoState * state);
   void resetCache(void);
   static void reset(SoGLBigImageTls * tls, SoState * state = NULL);
@@ -176,6 +214,7 @@ static void soglbigimagep_cleanup(void)
 {
   SoGLBigImageP::classTypeId STATIC_SOTYPE_INIT;
   CHANGELIMIT = 4;
+  TEXTUREMEMORYLIMIT = DEFAULT_TEXTUREMEMORYLIMIT;
 }
 
 static void
@@ -192,7 +231,11 @@ soglbigimagetls_construct(void * closure)
   storage->imagearray = NULL;
   storage->glimagediv = NULL;
   storage->glimageage = NULL;
+  storage->glimagebytes = NULL;
+  storage->texturebytes = 0;
   storage->averagebuf = NULL;
+  storage->regionbuf = NULL;
+  storage->regionbufsize = 0;
 }
 
 static void
@@ -204,6 +247,7 @@ soglbigimagetls_destruct(void * closure)
   // these are not destructed in reset()
   delete[] tls->tmpbuf;
   delete[] tls->averagebuf;
+  delete[] tls->regionbuf;
 }
 
 #define PRIVATE(obj) (obj->pimpl)
@@ -244,6 +288,11 @@ SoGLBigImage::initClass(void)
   SoGLBigImageP::classTypeId =
     SoType::createType(SoGLImage::getClassTypeId(), SbName("GLBigImage"));
   coin_atexit((coin_atexit_f*) soglbigimagep_cleanup, CC_ATEXIT_NORMAL);
+
+  const char * env = coin_getenv("COIN_BIGIMAGE_TEXTURE_MEMORY");
+  if (env) {
+    TEXTUREMEMORYLIMIT = size_t(SbMax(atoi(env), 0)) * 1024 * 1024;
+  }
 }
 
 // Doc in superclass.
@@ -296,6 +345,91 @@ SoGLBigImage::setData(const SbImage * image,
   inherited::setData(image, wraps, wrapt, wrapr, quality, border, NULL);
 }
 
+/*!
+  Sets the image data from the pyramid file \a filename, which must
+  have been written by createPyramidFile(). The subtextures are read
+  from the file when they are needed, so the image does not have to
+  fit in memory. Returns FALSE if the file could not be opened.
+
+  The lowest resolution level of the pyramid is used as the image
+  returned by getImage().
+
+  \since Coin 4.0
+*/
+SbBool
+SoGLBigImage::setPyramidFile(const SbString & filename,
+                             const Wrap wraps,
+                             const Wrap wrapt,
+                             const float quality)
+{
+  SbImagePyramid * pyramid = new SbImagePyramid;
+  if (!pyramid->open(filename.getString())) {
+    SoDebugError::postWarning("SoGLBigImage::setPyramidFile",
+                              "Could not open pyramid file '%s'.",
+                              filename.getString());
+    delete pyramid;
+    return FALSE;
+  }
+
+  delete PRIVATE(this);
+  PRIVATE(this) = new SoGLBigImageP;
+  PRIVATE(this)->pyramid = pyramid;
+
+  const int level = pyramid->getNumLevels() - 1;
+  const SbVec2i32 size = pyramid->getLevelSize(level);
+  const int nc = pyramid->getNumComponents();
+  unsigned char * bytes = new unsigned char[size[0] * size[1] * nc];
+  if (!pyramid->getRegion(level, SbVec2i32(0, 0), size, bytes)) {
+    memset(bytes, 0xff, size[0] * size[1] * nc);
+  }
+  PRIVATE(this)->preview.setValue(SbVec2s((short) size[0], (short) size[1]), nc, bytes);
+  delete[] bytes;
+
+  // the 2D version of setData() would end up in our own setData(),
+  // which resets the private data
+  inherited::setData(&PRIVATE(this)->preview, wraps, wrapt, REPEAT,
+                     quality, 0, NULL);
+  return TRUE;
+}
+
+/*!
+  Writes the pyramid file \a filename for an image of \a size pixels
+  with \a numcomponents components per pixel, to be used with
+  setPyramidFile(). The image rows are read through \a cb, in strips
+  of \a tilesize rows, so the image never has to be in memory in its
+  full size. This makes it possible to use images which are larger
+  than SbImage can hold. The pyramid file will be about a third larger
+  than the raw image data.
+
+  Returns FALSE if the file could not be written, or if \a cb
+  returned FALSE.
+
+  \since Coin 4.0
+*/
+SbBool
+SoGLBigImage::createPyramidFile(const SbString & filename,
+                                const SbVec2i32 & size,
+                                const int numcomponents,
+                                SoGLBigImageReadRowsCB * cb,
+                                void * closure,
+                                const int tilesize)
+{
+  return SbImagePyramid::create(filename.getString(), size, numcomponents,
+                                tilesize, cb, closure);
+}
+
+/*!
+  Returns TRUE if \a filename is a pyramid file written by
+  createPyramidFile().
+
+  \since Coin 4.0
+*/
+SbBool
+SoGLBigImage::isPyramidFile(const SbString & filename)
+{
+  return SbImagePyramid::isPyramidFile(filename.getString());
+}
+
 
 SoGLDisplayList *
 SoGLBigImage::getGLDisplayList(SoState * COIN_UNUSED_ARG(state))
@@ -355,11 +489,9 @@ SoGLBigImage::initSubImages(const SbVec2s & subimagesize) const
     if (ratio < 0.3) tls->glimagesize[1] >>= 1;
   }
 
-  SbVec2s size(0,0);
+  SbVec2i32 size(0,0);
   int nc = 0;
-
-  if (this->getImage() != NULL)
-    (void)(this->getImage()->getValue(size, nc));
+  PRIVATE(this)->getImageSize(this, size, nc);
 
   tls->dim[0] = size[0] / subimagesize[0];
   tls->dim[1] = size[1] / subimagesize[1];
@@ -395,6 +527,16 @@ SoGLBigImage::handleSubImage(const int idx,
   tcmul = tls->tcmul;
 }
 
+/*!
+  Makes subimage \a idx current in \a state, with a resolution
+  chosen from \a projsize, the size in pixels the subimage covers on
+  the screen.
+
+  If \a state is \c NULL, the subimage is read from the image or
+  pyramid file and counted against the texture memory limit, but not
+  sent to OpenGL. This can be used to read subimages ahead of
+  rendering.
+*/
 void
 SoGLBigImage::applySubImage(SoState * state, const int idx,
                             const float quality,
@@ -402,8 +544,10 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
 {
   SbVec2s size;
   int numcomponents;
-  unsigned char * bytes = this->getImage() ?
+  SbImagePyramid * pyramid = PRIVATE(this)->pyramid;
+  unsigned char * bytes = (this->getImage() && !pyramid) ?
     this->getImage()->getValue(size, numcomponents) : NULL;
+  if (pyramid) numcomponents = pyramid->getNumComponents();
 
   SoGLBigImageTls * tls = PRIVATE(this)->getTls();
 
@@ -416,11 +560,13 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
     tls->glimagearray = new SoGLImage*[numimages];
     tls->imagearray = new SbImage*[numimages];
     tls->glimageage = new uint32_t[numimages];
+    tls->glimagebytes = new int[numimages];
     for (int i = 0; i < numimages; i++) {
       tls->glimagearray[i] = NULL;
       tls->imagearray[i] = NULL;
       tls->glimagediv[i] = 1;
       tls->glimageage[i] = 0;
+      tls->glimagebytes[i] = 0;
     }
 
     int numbytes = tls->imagesize[0] * tls->imagesize[1] * numcomponents;
@@ -429,7 +575,7 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
 
     // lock before testing/creating cache to avoid race conditions
     PRIVATE(this)->lock();
-    if (PRIVATE(this)->cache == NULL) {
+    if (PRIVATE(this)->cache == NULL && !pyramid) {
       PRIVATE(this)->createCache(bytes, size, numcomponents);
     }
     PRIVATE(this)->unlock();
@@ -444,6 +590,20 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
   }
   div >>= 1;
 
+  // stay within the texture memory limit, by evicting the least
+  // recently used subtextures, or by lowering the resolution of this
+  // one when that is not enough
+  if (TEXTUREMEMORYLIMIT > 0 &&
+      (tls->glimagearray[idx] == NULL || tls->glimagediv[idx] != div)) {
+    while (!SoGLBigImageP::makeRoom(tls, state, idx,
+                                    (tls->glimagesize[0]/div) *
+                                    (tls->glimagesize[1]/div) * numcomponents) &&
+           (tls->glimagesize[0]/div > 1 || tls->glimagesize[1]/div > 1)) {
+      div <<= 1;
+      level++;
+    }
+  }
+
   if (tls->glimagearray[idx] == NULL ||
       (tls->glimagediv[idx] != div && tls->changecnt < CHANGELIMIT)) {
 
@@ -469,9 +629,9 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
     }
     tls->glimagearray[idx]->setFlags(flags);
 
-    SbVec2s actualsize(tls->glimagesize[0]/div,
-                       tls->glimagesize[1]/div);
-    if (bytes) {
+    SbVec2s actualsize(SbMax(tls->glimagesize[0]/div, 1),
+                       SbMax(tls->glimagesize[1]/div, 1));
+    if (bytes || pyramid) {
       int numbytes = actualsize[0]*actualsize[1]*numcomponents;
       if (numbytes > tls->tmpbufsize) {
         delete[] tls->tmpbuf;
@@ -479,7 +639,11 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
         tls->tmpbufsize = numbytes;
       }
 
-      if (tls->glimagesize == tls->imagesize) {
+      if (pyramid) {
+        PRIVATE(this)->copyPyramidSubImage(tls, idx, tls->tmpbuf,
+                                           level, actualsize);
+      }
+      else if (tls->glimagesize == tls->imagesize) {
         PRIVATE(this)->copySubImage(tls,
                            idx,
                            bytes,
@@ -497,6 +661,9 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
                                  actualsize);
       }
       tls->imagearray[idx]->setValue(actualsize, numcomponents, tls->tmpbuf);
+      tls->texturebytes -= tls->glimagebytes[idx];
+      tls->glimagebytes[idx] = actualsize[0] * actualsize[1] * numcomponents;
+      tls->texturebytes += tls->glimagebytes[idx];
     }
     else tls->imagearray[idx]->setValuePtr(SbVec2s(0,0), 0, NULL);
     
@@ -509,11 +676,13 @@ SoGLBigImage::applySubImage(SoState * state, const int idx,
                                     0, NULL);
   }
 
+  tls->glimageage[idx] = 0;
+  this->resetAge();
+  if (state == NULL) return;
+
   SoGLDisplayList * dl = tls->glimagearray[idx]->getGLDisplayList(state);
   assert(dl);
-  tls->glimageage[idx] = 0;
   SoGLImage::tagImage(state, tls->glimagearray[idx]);
-  this->resetAge();
   dl->call(state);
 }
 
@@ -544,6 +713,24 @@ SoGLBigImage::setChangeLimit(const int limit)
   return old;
 }
 
+/*!
+  Sets the amount of texture memory, in megabytes, that the
+  subtextures of each SoGLBigImage may use. 0 means no limit. Returns
+  the old limit.
+
+  The default limit is 256 megabytes, or the value of the
+  COIN_BIGIMAGE_TEXTURE_MEMORY environment variable.
+
+  \since Coin 4.0
+*/
+int
+SoGLBigImage::setTextureMemoryLimit(const int megabytes)
+{
+  int old = (int) (TEXTUREMEMORYLIMIT / (1024 * 1024));
+  TEXTUREMEMORYLIMIT = size_t(SbMax(megabytes, 0)) * 1024 * 1024;
+  return old;
+}
+
 // needed for cc_storage_apply_to_all() callback
 typedef struct {
   uint32_t maxage;
@@ -579,7 +766,8 @@ SoGLBigImage::unrefOldDL(SoState * state, const uint32_t maxage)
 SoGLBigImageP::SoGLBigImageP(void) :
   cache(NULL),
   cachesize(NULL),
-  numcachelevels(0)
+  numcachelevels(0),
+  pyramid(NULL)
 {
   this->storage = cc_storage_construct_etc(sizeof(SoGLBigImageTls),
                                            soglbigimagetls_construct,
@@ -590,6 +778,7 @@ SoGLBigImageP::~SoGLBigImageP()
 {
   this->resetCache();
   cc_storage_destruct(this->storage);
+  delete this->pyramid;
 }
 
 //  The method copySubImage() handles the downsampling. It averages
@@ -769,6 +958,98 @@ SoGLBigImageP::copyResizeSubImage(SoGLBigImageTls * tls,
   }
 }
 
+//  copyPyramidSubImage() reads the subimage from the pyramid level
+//  with the resolution needed. Levels beyond the lowest resolution
+//  level of the pyramid are made by scaling down from that level.
+void
+SoGLBigImageP::copyPyramidSubImage(SoGLBigImageTls * tls,
+                                   const int idx,
+                                   unsigned char * dst,
+                                   const int level,
+                                   const SbVec2s & targetsize)
+{
+  SbVec2s pos(idx % tls->dim[0], idx / tls->dim[0]);
+  const int nc = this->pyramid->getNumComponents();
+  const int srclevel = SbMin(level, this->pyramid->getNumLevels() - 1);
+
+  const SbVec2i32 origin((pos[0] * tls->imagesize[0]) >> srclevel,
+                         (pos[1] * tls->imagesize[1]) >> srclevel);
+  const SbVec2i32 size(SbMax(tls->imagesize[0] >> srclevel, 1),
+                       SbMax(tls->imagesize[1] >> srclevel, 1));
+
+  SbBool ok;
+  if (size[0] == targetsize[0] && size[1] == targetsize[1]) {
+    ok = this->pyramid->getRegion(srclevel, origin, size, dst);
+  }
+  else {
+    const int numbytes = size[0] * size[1] * nc;
+    if (numbytes > tls->regionbufsize) {
+      delete[] tls->regionbuf;
+      tls->regionbuf = new unsigned char[numbytes];
+      tls->regionbufsize = numbytes;
+    }
+    ok = this->pyramid->getRegion(srclevel, origin, size, tls->regionbuf);
+    if (ok) {
+      SbImageResize::resizeFiltered(tls->regionbuf, size[0], size[1], 1, nc,
+                                    dst, targetsize[0], targetsize[1], 1);
+    }
+  }
+  if (!ok) {
+    memset(dst, 0, targetsize[0] * targetsize[1] * nc);
+  }
+}
+
+void
+SoGLBigImageP::getImageSize(const SoGLBigImage * master,
+                            SbVec2i32 & size, int & nc) const
+{
+  if (this->pyramid) {
+    size = this->pyramid->getSize();
+    nc = this->pyramid->getNumComponents();
+  }
+  else if (master->getImage() != NULL) {
+    SbVec2s imagesize;
+    (void) master->getImage()->getValue(imagesize, nc);
+    size.setValue(imagesize[0], imagesize[1]);
+  }
+}
+
+// Deletes the least recently used subtextures until a subtexture of
+// numbytes bytes can replace subtexture idx without exceeding the
+// texture memory limit. Subtextures used in the current frame are
+// kept. Returns FALSE if there is not enough room.
+SbBool
+SoGLBigImageP::makeRoom(SoGLBigImageTls * tls, SoState * state,
+                        const int idx, const int numbytes)
+{
+  const int numimages = tls->currentdim[0] * tls->currentdim[1];
+  for (;;) {
+    if (tls->texturebytes - tls->glimagebytes[idx] + numbytes <= TEXTUREMEMORYLIMIT) {
+      return TRUE;
+    }
+    int oldest = -1;
+    for (int i = 0; i < numimages; i++) {
+      if (i != idx && tls->glimagearray[i] && tls->glimageage[i] > 0 &&
+          (oldest < 0 || tls->glimageage[i] > tls->glimageage[oldest])) {
+        oldest = i;
+      }
+    }
+    if (oldest < 0) return FALSE;
+    SoGLBigImageP::unrefSubImage(tls, state, oldest);
+  }
+}
+
+void
+SoGLBigImageP::unrefSubImage(SoGLBigImageTls * tls, SoState * state, const int idx)
+{
+  tls->glimagearray[idx]->unref(state);
+  tls->glimagearray[idx] = NULL;
+  delete tls->imagearray[idx];
+  tls->imagearray[idx] = NULL;
+  tls->texturebytes -= tls->glimagebytes[idx];
+  tls->glimagebytes[idx] = 0;
+}
+
 #if 0 // FIXME: Not in use
 // create a lower resolution image by averaging all pixels in a block
 // (from the full resolution image) into a new pixel. This is pretty
@@ -937,11 +1218,14 @@ SoGLBigImageP::reset(SoGLBigImageTls * tls, SoState * state)
   delete[] tls->imagearray;
   delete[] tls->glimageage;
   delete[] tls->glimagediv;
+  delete[] tls->glimagebytes;
   delete[] tls->averagebuf;
   tls->glimagearray = NULL;
   tls->imagearray = NULL;
   tls->glimageage = NULL;
   tls->glimagediv = NULL;
+  tls->glimagebytes = NULL;
+  tls->texturebytes = 0;
   tls->averagebuf = NULL;
   tls->currentdim.setValue(0,0);
 }
@@ -957,8 +1241,7 @@ SoGLBigImageP::unrefOldDL(SoGLBigImageTls * tls, SoState * state, const uint32_t
         SoDebugError::postInfo("SoGLBigImageP::unrefOldDL",
                                "Killed image because of old age.");
 #endif // debug
-        tls->glimagearray[i]->unref(state);
-        tls->glimagearray[i] = NULL;
+        SoGLBigImageP::unrefSubImage(tls, state, i);
       }
       else tls->glimageage[i] += 1;
     }
@@ -982,3 +1265,183 @@ SoGLBigImageP::resetAllTls(SoState * state)
 #endif // DOXYGEN_SKIP_THIS
 
 #undef LINEAR_LIMIT
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <Inventor/SbImage.h>
+
+// The scalar 2D box filter SoGLImage used for mipmaps before the
+// kernels were vectorised.
+static void
+glbigimage_halve(const int width, const int height, const int nc,
+                 const unsigned char * src, unsigned char * dst)
+{
+  const int nextrow = width * nc;
+  for (int i = 0; i < (height >> 1); i++) {
+    for (int j = 0; j < (width >> 1); j++) {
+      for (int c = 0; c < nc; c++) {
+        *dst++ = (src[0] + src[nc] + src[nextrow] + src[nextrow + nc] + 2) >> 2;
+        src++;
+      }
+      src += nc;
+    }
+    src += nextrow;
+  }
+}
+
+static SbBool
+glbigimage_read_rows(void * closure, const int y, const int numrows,
+                     unsigned char * rows)
+{
+  const unsigned char * const * data = (const unsigned char * const *) closure;
+  const int rowbytes = *((const int *) data[1]);
+  memcpy(rows, data[0] + y * rowbytes, numrows * rowbytes);
+  return TRUE;
+}
+
+BOOST_AUTO_TEST_CASE(pyramidLevelsMatchScalar)
+{
+  // the lower levels of a pyramid file are made by halving the image,
+  // and the lowest level is the image of the SoGLBigImage
+  static const int sizes[][2] = { { 128, 64 }, { 32, 128 }, { 64, 64 } };
+  const int tilesize = 16;
+  const SbString filename("glbigimage-test.pyramid");
+  srand(1);
+  int mismatches = 0;
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (int nc = 1; nc <= 4; nc++) {
+      int w = sizes[s][0], h = sizes[s][1];
+      unsigned char * src = new unsigned char[w * h * nc];
+      for (int i = 0; i < w * h * nc; i++) src[i] = (unsigned char) (rand() & 0xff);
+
+      int rowbytes = w * nc;
+      const unsigned char * data[2] = { src, (const unsigned char *) &rowbytes };
+      BOOST_REQUIRE(SoGLBigImage::createPyramidFile(filename, SbVec2i32(w, h), nc,
+                                                    glbigimage_read_rows,
+                                                    (void *) data, tilesize));
+
+      // halve until the image fits in one tile
+      unsigned char * expected = src;
+      while (w > tilesize || h > tilesize) {
+        unsigned char * half = new unsigned char[(w / 2) * (h / 2) * nc];
+        glbigimage_halve(w, h, nc, expected, half);
+        if (expected != src) delete[] expected;
+        expected = half;
+        w /= 2;
+        h /= 2;
+      }
+
+      SoGLBigImage * image = new SoGLBigImage;
+      BOOST_REQUIRE(image->setPyramidFile(filename));
+      int resultnc;
+      SbVec2s resultsize;
+      const unsigned char * result = image->getImage()->getValue(resultsize, resultnc);
+      if (resultsize != SbVec2s((short) w, (short) h) || resultnc != nc ||
+          memcmp(result, expected, w * h * nc) != 0) {
+        mismatches++;
+      }
+      image->unref(NULL);
+
+      if (expected != src) delete[] expected;
+      delete[] src;
+    }
+  }
+  (void) remove(filename.getString());
+  BOOST_CHECK_MESSAGE(mismatches == 0, "halved images differ from the scalar version");
+}
+
+// Writes a pyramid file for a width x height image with one component.
+static SbBool
+glbigimage_write_test_pyramid(const SbString & filename, int width, const int height)
+{
+  unsigned char * src = new unsigned char[width * height];
+  for (int i = 0; i < width * height; i++) src[i] = (unsigned char) (i & 0xff);
+  const unsigned char * data[2] = { src, (const unsigned char *) &width };
+  const SbBool ok =
+    SoGLBigImage::createPyramidFile(filename, SbVec2i32(width, height), 1,
+                                    glbigimage_read_rows, (void *) data);
+  delete[] src;
+  return ok;
+}
+
+// Applies subimage idx in a new frame, and returns TRUE if that
+// changed the resolution of an existing subtexture. With a change
+// limit of 1, exceededChangeLimit() tells exactly that.
+static SbBool
+glbigimage_apply_changed(SoGLBigImage * image, const int idx, const short projsize)
+{
+  (void) image->initSubImages(SbVec2s(128, 128));
+  image->applySubImage(NULL, idx, 0.5f, SbVec2s(projsize, projsize));
+  return image->exceededChangeLimit();
+}
+
+BOOST_AUTO_TEST_CASE(levelFromProjectedSize)
+{
+  const SbString filename("glbigimage-level.pyramid");
+  BOOST_REQUIRE(glbigimage_write_test_pyramid(filename, 512, 512));
+  const int oldlimit = SoGLBigImage::setChangeLimit(1);
+
+  SoGLBigImage * image = new SoGLBigImage;
+  BOOST_REQUIRE(image->setPyramidFile(filename));
+  BOOST_CHECK_MESSAGE(image->initSubImages(SbVec2s(128, 128)) == 16,
+                      "expected 4x4 subimages");
+
+  // full resolution while the projected size is more than half the
+  // subimage size, then one level down for each halving
+  BOOST_CHECK_MESSAGE(!glbigimage_apply_changed(image, 0, 128), "first use is not a change");
+  BOOST_CHECK_MESSAGE(!glbigimage_apply_changed(image, 0, 65), "expected full resolution");
+  BOOST_CHECK_MESSAGE(glbigimage_apply_changed(image, 0, 63), "expected half resolution");
+  BOOST_CHECK_MESSAGE(!glbigimage_apply_changed(image, 0, 40), "expected to keep half resolution");
+  BOOST_CHECK_MESSAGE(glbigimage_apply_changed(image, 0, 31), "expected quarter resolution");
+  BOOST_CHECK_MESSAGE(glbigimage_apply_changed(image, 0, 128), "expected full resolution again");
+
+  image->unref(NULL);
+  (void) SoGLBigImage::setChangeLimit(oldlimit);
+  (void) remove(filename.getString());
+}
+
+BOOST_AUTO_TEST_CASE(textureMemoryLimitEvictsLeastRecentlyUsed)
+{
+  // 128 subimages of 128x128 bytes, of which 64 fit in one megabyte
+  const SbString filename("glbigimage-lru.pyramid");
+  BOOST_REQUIRE(glbigimage_write_test_pyramid(filename, 2048, 1024));
+  const int oldlimit = SoGLBigImage::setChangeLimit(1);
+  const int oldmemory = SoGLBigImage::setTextureMemoryLimit(1);
+
+  SoGLBigImage * image = new SoGLBigImage;
+  BOOST_REQUIRE(image->setPyramidFile(filename));
+  BOOST_CHECK_MESSAGE(image->initSubImages(SbVec2s(128, 128)) == 128,
+                      "expected 16x8 subimages");
+
+  // fill the limit in the first frame, and use only subimage 1 in the
+  // second, so subimage 0 is among the least recently used
+  for (int i = 0; i < 64; i++) image->applySubImage(NULL, i, 0.5f, SbVec2s(128, 128));
+  SoGLImage::endFrame(NULL);
+  (void) glbigimage_apply_changed(image, 1, 128);
+  SoGLImage::endFrame(NULL);
+
+  // subimage 64 only fits when another is deleted
+  (void) glbigimage_apply_changed(image, 64, 128);
+  SoGLImage::endFrame(NULL);
+
+  // a subimage which is still there changes resolution, while a
+  // deleted one is created again
+  BOOST_CHECK_MESSAGE(glbigimage_apply_changed(image, 1, 32),
+                      "recently used subimage should not be evicted");
+  BOOST_CHECK_MESSAGE(glbigimage_apply_changed(image, 64, 32),
+                      "new subimage should be kept");
+  BOOST_CHECK_MESSAGE(!glbigimage_apply_changed(image, 0, 32),
+                      "least recently used subimage should be evicted");
+
+  image->unref(NULL);
+  (void) SoGLBigImage::setTextureMemoryLimit(oldmemory);
+  (void) SoGLBigImage::setChangeLimit(oldlimit);
+  (void) remove(filename.getString());
+}
+
+#endif // COIN_TEST_SUITE
@@ -220,9 +220,8 @@
 #include "tidbitsp.h"
 #include "rendering/SoGL.h"
 #include "elements/SoTextureScaleQualityElement.h"
-#include "glue/GLUWrapper.h"
 #include "glue/glp.h"
-#include "glue/simage_wrapper.h"
+#include "misc/SbImageResize.h"
 #include "threads/threadsutilp.h"
 #include "coindefs.h"
 
@@ -334,115 +333,6 @@ compute_log(int value)
   return i;
 }
 
-//FIXME: Use as a special case of 3D image to reduce codelines ? (kintel 20011115)
-static void
-halve_image(const int width, const int height, const int nc,
-            const unsigned char *datain, unsigned char *dataout)
-{
-  assert(width > 1 || height > 1);
-
-  int nextrow = width *nc;
-  int newwidth = width >> 1;
-  int newheight = height >> 1;
-  unsigned char *dst = dataout;
-  const unsigned char *src = datain;
-
-  // check for 1D images
-  if (width == 1 || height == 1) {
-    int n = SbMax(newwidth, newheight);
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < nc; j++) {
-        *dst = (src[0] + src[nc]) >> 1;
-        dst++; src++;
-      }
-      src += nc; // skip to next pixel
-    }
-  }
-  else {
-    for (int i = 0; i < newheight; i++) {
-      for (int j = 0; j < newwidth; j++) {
-        for (int c = 0; c < nc; c++) {
-          *dst = (src[0] + src[nc] + src[nextrow] + src[nextrow+nc] + 2) >> 2;
-          dst++; src++;
-        }
-        src += nc; // skip to next pixel
-      }
-      src += nextrow;
-    }
-  }
-}
-
-static void
-halve_image(const int width, const int height, const int depth, const int nc,
-            const unsigned char *datain, unsigned char *dataout)
-{
-  assert(width > 1 || height > 1 || depth > 1);
-
-  int rowsize = width * nc;
-  int imagesize = width * height * nc;
-  int newwidth = width >> 1;
-  int newheight = height >> 1;
-  int newdepth = depth >> 1;
-  unsigned char *dst = dataout;
-  const unsigned char *src = datain;
-
-  int numdims = (width>=1?1:0)+(height>=1?1:0)+(depth>=1?1:0);
-  // check for 1D images.
-  if (numdims == 1) {
-    int n = SbMax(SbMax(newwidth, newheight), newdepth);
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < nc; j++) {
-        *dst = (src[0] + src[nc]) >> 1;
-        dst++; src++;
-      }
-      src += nc; // skip to next pixel/row/image
-    }
-  }
-  // check for 2D images
-  else if (numdims == 2) {
-    int s1,s2,blocksize;
-    if (width==1) {
-      s1 = newheight;
-      blocksize = height * nc;
-    }
-    else {
-      s1 = newwidth;
-      blocksize = width * nc;
-    }
-    s2 = depth==1?newheight:newdepth;
-    for (int j = 0; j < s2; j++) {
-      for (int i = 0; i < s1; i++) {
-        for (int j = 0; j < nc; j++) {
-          *dst = (src[0] + src[nc] + src[blocksize] + src[blocksize+nc] + 2) >> 2;
-          dst++; src++;
-        }
-        src += nc; // skip to next pixel (x or y direction)
-      }
-      src += blocksize; // Skip to next row/image
-    }
-  }
-  else { // 3D image
-    for (int k = 0; k < newdepth; k++) {
-      for (int j = 0; j < newheight; j++) {
-        for (int i = 0; i < newwidth; i++) {
-          for (int c = 0; c < nc; c++) {
-            *dst = (src[0] + src[nc] +
-                    src[rowsize] + src[rowsize+nc] +
-                    src[imagesize] + src[imagesize+nc] +
-                    src[imagesize+rowsize] + src[imagesize+rowsize+nc] +
-                    4) >> 3;
-            dst++; src++;
-          }
-          src += nc; // skip one pixel
-        }
-        src += rowsize; // skip one row
-      }
-      src += imagesize; // skip one image
-    }
-  }
-}
-
-
 // fast mipmap creation. no repeated memory allocations.
 static void
 fast_mipmap(SoState * state, int width, int height, int nc,
@@ -472,7 +362,7 @@ fast_mipmap(SoState * state, int width, int height, int nc,
   }
   unsigned char *src = (unsigned char *) data;
   for (level = 1; level <= levels; level++) {
-    halve_image(width, height, nc, src, mipmap_buffer);
+    SbImageResize::halve(src, width, height, 1, nc, mipmap_buffer);
     if (width > 1) width >>= 1;
     if (height > 1) height >>= 1;
     src = mipmap_buffer;
@@ -522,7 +412,7 @@ fast_mipmap(SoState * state, int width, int height, int depth,
   }
   unsigned char *src = (unsigned char *) data;
   for (int level = 1; level <= levels; level++) {
-    halve_image(width, height, depth, nc, src, mipmap_buffer);
+    SbImageResize::halve(src, width, height, depth, nc, mipmap_buffer);
     if (width > 1) width >>= 1;
     if (height > 1) height >>= 1;
     if (depth > 1) depth >>= 1;
@@ -544,78 +434,6 @@ fast_mipmap(SoState * state, int width, int height, int depth,
   }
 }
 
-// A low quality resize function. It is only used when neither simage
-// nor GLU is available.
-static void
-fast_image_resize(const unsigned char * src,
-                  unsigned char * dest,
-                  int width,
-                  int height, int num_comp,
-                  int newwidth, int newheight)
-{
-  float sx, sy, dx, dy;
-  int src_bpr, dest_bpr, xstop, ystop, x, y, offset, i;
-
-  dx = ((float)width)/((float)newwidth);
-  dy = ((float)height)/((float)newheight);
-  src_bpr = width * num_comp;
-  dest_bpr = newwidth * num_comp;
-
-  sy = 0.0f;
-  ystop = newheight * dest_bpr;
-  xstop = newwidth * num_comp;
-  for (y = 0; y < ystop; y += dest_bpr) {
-    sx = 0.0f;
-    for (x = 0; x < xstop; x += num_comp) {
-      offset = ((int)sy)*src_bpr + ((int)sx)*num_comp;
-      for (i = 0; i < num_comp; i++) dest[x+y+i] = src[offset+i];
-      sx += dx;
-    }
-    sy += dy;
-  }
-}
-
-// A low quality resize function for 3D texture image buffers. It is
-// only used when neither simage nor GLU is available.
-static void
-fast_image_resize3d(const unsigned char * src,
-                    unsigned char * dest,
-                    int width, int height,
-                    int nc, int layers,
-                    int newwidth, int newheight,
-                    int newlayers)
-{
-  float sx, sy, sz, dx, dy, dz;
-  int src_bpr, dest_bpr, src_bpl, dest_bpl, xstop, ystop, zstop;
-  int x, y, z, offset, i;
-
-  dx = ((float)width)/((float)newwidth);
-  dy = ((float)height)/((float)newheight);
-  dz = ((float)layers)/((float)newlayers);
-  src_bpr = width * nc;
-  dest_bpr = newwidth * nc;
-  src_bpl = src_bpr * height;
-  dest_bpl = dest_bpr * newheight;
-
-  zstop = newlayers * dest_bpl;
-  ystop = dest_bpl;
-  xstop = dest_bpr;
-  sz = 0.0f;
-  for (z = 0; z < zstop; z += dest_bpl) {
-    sy = 0.0f;
-    for (y = 0; y < ystop; y += dest_bpr) {
-      sx = 0.0f;
-      for (x = 0; x < xstop; x += nc) {
-        offset = ((int)sz)*src_bpl + ((int)sy)*src_bpr + ((int)sx)*nc;
-        for (i = 0; i < nc; i++) dest[x+y+z+i] = src[offset+i];
-        sx += dx;
-      }
-      sy += dy;
-    }
-    sz += dz;
-  }
-}
-
 // *************************************************************************
 
 class SoGLImageP {
@@ -1530,70 +1348,21 @@ SoGLImageP::resizeImage(SoState * state, unsigned char *& imageptr,
     }
 
     if (!customresizedone) {
-      // simage version 1.1.1 has a pretty high quality resize
-      // function. We prefer to use that to avoid using GLU, since
-      // there are lots of buggy GLU libraries out there.
-      if (zsize == 0) { // 2D image
-        // simage_resize and gluScaleImage can be pretty slow. Use
-        // fast_image_resize() if high quality isn't needed
-        if (SoTextureScaleQualityElement::get(state) < 0.5f) {
-          fast_image_resize(bytes, glimage_tmpimagebuffer,
-                            xsize, ysize, numcomponents,
-                            newx, newy);
-        }
-        else if (simage_wrapper()->available &&
-                 simage_wrapper()->versionMatchesAtLeast(1,1,1) &&
-                 simage_wrapper()->simage_resize) {
-
-          unsigned char *result =
-            simage_wrapper()->simage_resize((unsigned char*) bytes,
-                                            xsize, ysize, numcomponents,
-                                            newx, newy);
-          (void)memcpy(glimage_tmpimagebuffer, result, numbytes);
-          simage_wrapper()->simage_free_image(result);
-        }
-        else if (GLUWrapper()->available) {
-          glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-          glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-          glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-          glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-          glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
-          glPixelStorei(GL_PACK_SKIP_ROWS, 0);
-          glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-          glPixelStorei(GL_PACK_ALIGNMENT, 1);
-
-          // FIXME: ignoring the error code. Silly. 20000929 mortene.
-          (void)GLUWrapper()->gluScaleImage(coin_glglue_get_texture_format(glw, numcomponents),
-                                            xsize, ysize,
-                                            GL_UNSIGNED_BYTE, (void*) bytes,
-                                            newx, newy, GL_UNSIGNED_BYTE,
-                                            (void*)glimage_tmpimagebuffer);
-          glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-          glPixelStorei(GL_PACK_ALIGNMENT, 4);
-        }
-        else { // fall back to the internal low-quality resize function
-          fast_image_resize(bytes, glimage_tmpimagebuffer,
-                            xsize, ysize, numcomponents,
-                            newx, newy);
-        }
+      // Nearest pixel sampling if high quality isn't needed, box
+      // filtering / linear interpolation otherwise. Both are done
+      // internally, as there are lots of buggy GLU libraries out
+      // there, and simage may not be available.
+      const int depth = (zsize == 0) ? 1 : zsize;
+      const int newdepth = (newz == 0) ? 1 : newz;
+      if (SoTextureScaleQualityElement::get(state) < 0.5f) {
+        SbImageResize::resizeNearest(bytes, xsize, ysize, depth, numcomponents,
+                                     glimage_tmpimagebuffer,
+                                     newx, newy, newdepth);
       }
-      else { // (zsize > 0) => 3D image
-        if (simage_wrapper()->available &&
-            simage_wrapper()->versionMatchesAtLeast(1,3,0) &&
-            simage_wrapper()->simage_resize3d) {
-          unsigned char *result =
-            simage_wrapper()->simage_resize3d((unsigned char*) bytes,
-                                              xsize, ysize, numcomponents, zsize,
-                                              newx, newy, newz);
-          (void)memcpy(glimage_tmpimagebuffer, result, numbytes);
-          simage_wrapper()->simage_free_image(result);
-        }
-        else {
-          // fall back to the internal low-quality resize function
-          fast_image_resize3d(bytes, glimage_tmpimagebuffer,
-                              xsize, ysize, numcomponents, zsize,
-                              newx, newy, newz);
-        }
+      else {
+        SbImageResize::resizeFiltered(bytes, xsize, ysize, depth, numcomponents,
+                                      glimage_tmpimagebuffer,
+                                      newx, newy, newdepth);
       }
     }
     imageptr = glimage_tmpimagebuffer;
@@ -59,6 +59,8 @@
 #include <Inventor/nodes/SoCamera.h>
 #include <Inventor/elements/SoDrawStyleElement.h>
 #include <Inventor/elements/SoComplexityTypeElement.h>
+#include <Inventor/elements/SoDecimationPercentageElement.h>
+#include <Inventor/elements/SoDecimationTypeElement.h>
 #include <Inventor/elements/SoPolygonOffsetElement.h>
 #include <Inventor/elements/SoMaterialBindingElement.h>
 #include <Inventor/elements/SoOverrideElement.h>
@@ -70,6 +72,7 @@
 #include <Inventor/actions/SoAudioRenderAction.h>
 #include <Inventor/actions/SoGLRenderAction.h>
 #include <Inventor/sensors/SoOneShotSensor.h>
+#include <Inventor/sensors/SoIdleSensor.h>
 #include <Inventor/fields/SoSFTime.h>
 #include <Inventor/misc/SoAudioDevice.h>
 #include <Inventor/SoDB.h>
@@ -276,6 +279,16 @@ SoRenderManager::SoRenderManager(void)
     new SoNodeSensor(SoRenderManagerP::updateClippingPlanesCB, PRIVATE(this));
   PRIVATE(this)->clipsensor->setPriority(this->getRedrawPriority() - 1);
 
+  PRIVATE(this)->targetframetime = SbTime::zero();
+  PRIVATE(this)->minquality = 0.25f;
+  PRIVATE(this)->smallfeaturesize = 4.0f;
+  PRIVATE(this)->quality = 1.0f;
+  PRIVATE(this)->interactivequality = 1.0f;
+  PRIVATE(this)->refining = FALSE;
+  PRIVATE(this)->refinesensor =
+    new SoIdleSensor(SoRenderManagerP::refineCB, this);
+  PRIVATE(this)->lastframetime = SbTime::zero();
+  PRIVATE(this)->averageframetime = SbTime::zero();
 }
 
 /*!
@@ -298,6 +311,7 @@ SoRenderManager::~SoRenderManager()
   }
 
   delete PRIVATE(this)->clipsensor;
+  delete PRIVATE(this)->refinesensor;
 
   if (PRIVATE(this)->scene)
     PRIVATE(this)->scene->unref();
@@ -382,7 +396,9 @@ SoRenderManager::nodesensorCB(void * data, SoSensor * /* sensor */)
   SoDebugError::postInfo("SoRenderManager::nodesensorCB",
                          "detected change in scene graph");
 #endif // debug
-  ((SoRenderManager *)data)->scheduleRedraw();
+  SoRenderManager * thisp = (SoRenderManager *) data;
+  PRIVATE(thisp)->sceneChanged();
+  thisp->scheduleRedraw();
 }
 
 /*!
@@ -590,6 +606,8 @@ SoRenderManager::render(const SbBool clearwindow, const SbBool clearzbuffer)
   //
   // 20050809 mortene.
 
+  const SbTime starttime = SbTime::getTimeOfDay();
+
   if (PRIVATE(this)->scene &&
       // Order is important below, because we don't want to call
       // SoAudioDevice::instance() unless we need to -- as it triggers
@@ -640,6 +658,8 @@ SoRenderManager::render(const SbBool clearwindow, const SbBool clearzbuffer)
     // let SoGLRenderAction handle the accumulation buffer
     this->render(PRIVATE(this)->glaction, TRUE, clearwindow, clearzbuffer);
   }
+
+  PRIVATE(this)->frameRendered(SbTime::getTimeOfDay() - starttime);
 }
 
 /*!
@@ -803,6 +823,16 @@ SoRenderManager::renderSingle(SoGLRenderAction * action,
     SoTextureQualityElement::set(state, node, 0.0f);
     SoTextureOverrideElement::setQualityOverride(state, TRUE);
   }
+
+  // reduced quality from the frame time governor
+  const float quality = PRIVATE(this)->quality;
+  const float featuresize = action->getSmallFeatureSize();
+  if (quality < 1.0f) {
+    SoDecimationTypeElement::set(state, node, SoDecimationTypeElement::PERCENTAGE);
+    SoDecimationPercentageElement::set(state, node, quality);
+    action->setSmallFeatureSize(SbMax(featuresize, PRIVATE(this)->smallfeaturesize *
+                                      (1.0f - quality)));
+  }
   switch (this->getRenderMode()) {
   case SoRenderManager::AS_IS:
     this->actuallyRender(action, initmatrices, clearwindow, clearzbuffer);
@@ -879,6 +909,7 @@ SoRenderManager::renderSingle(SoGLRenderAction * action,
     assert(0 && "unknown rendering mode");
     break;
   }
+  action->setSmallFeatureSize(featuresize);
   state->pop();
 }
 
@@ -1690,6 +1721,163 @@ SoRenderManager::isRealTimeUpdateEnabled(void)
   return SoRenderManagerP::touchtimer;
 }
 
+/*!
+  Sets the time each frame should take to render while the scene is
+  changing, for instance while the user moves the camera around. An
+  SbTime::zero() value, which is the default, disables the frame time
+  governor.
+
+  When a target frame time is set, the render manager measures the
+  time spent in render(). For frames caused by changes in the scene
+  graph, it adjusts a quality level between getMinimumQuality() and
+  1.0 so that the following frames take about \a frametime to
+  render. A quality level below 1.0 has these effects:
+
+  <ul>
+
+  <li>The decimation type is set to
+  SoDecimationTypeElement::PERCENTAGE, with the quality level as the
+  percentage. Shapes scale their complexity value by the percentage,
+  and SoLOD, SoLevelOfDetail and SoScreenSpaceErrorLOD select
+  coarser children.</li>
+
+  <li>Shapes smaller than the small feature size times (1.0 - quality
+  level) pixels are not rendered, see setSmallFeatureSize() and
+  SoGLRenderAction::setSmallFeatureSize().</li>
+
+  </ul>
+
+  When the application becomes idle after a frame with reduced
+  quality, an SoIdleSensor raises the quality level by 0.25 and
+  schedules a new redraw, until the scene is rendered at full
+  quality. Any change in the scene graph stops the refinement and
+  goes back to the interactive quality level.
+
+  The measured time is the time spent issuing the OpenGL commands.
+  Since the driver may still be working when render() returns, it can
+  be lower than the actual frame time.
+
+  \sa getQualityLevel(), getLastFrameTime(), getAverageFrameTime()
+  \since Coin 4.0
+*/
+void
+SoRenderManager::setTargetFrameTime(const SbTime & frametime)
+{
+  PRIVATE(this)->targetframetime = frametime;
+  if (frametime.getValue() <= 0.0) {
+    if (PRIVATE(this)->refinesensor->isScheduled()) {
+      PRIVATE(this)->refinesensor->unschedule();
+    }
+    PRIVATE(this)->refining = FALSE;
+    PRIVATE(this)->quality = 1.0f;
+    PRIVATE(this)->interactivequality = 1.0f;
+  }
+}
+
+/*!
+  Returns the target frame time.
+
+  \sa setTargetFrameTime()
+  \since Coin 4.0
+*/
+SbTime
+SoRenderManager::getTargetFrameTime(void) const
+{
+  return PRIVATE(this)->targetframetime;
+}
+
+/*!
+  Sets the lowest quality level the frame time governor will use,
+  between 0.0 and 1.0. The default value is 0.25.
+
+  \sa setTargetFrameTime()
+  \since Coin 4.0
+*/
+void
+SoRenderManager::setMinimumQuality(const float quality)
+{
+  PRIVATE(this)->minquality = SbClamp(quality, 0.0f, 1.0f);
+}
+
+/*!
+  Returns the lowest quality level the frame time governor will use.
+
+  \sa setMinimumQuality()
+  \since Coin 4.0
+*/
+float
+SoRenderManager::getMinimumQuality(void) const
+{
+  return PRIVATE(this)->minquality;
+}
+
+/*!
+  Sets the size, in pixels, below which shapes are skipped when
+  rendering with a quality level of 0.0. The size used for a frame is
+  \a pixels times (1.0 - quality level), so no shapes are skipped at
+  full quality. The default value is 4 pixels, and 0 disables small
+  feature culling from the frame time governor.
+
+  \sa setTargetFrameTime(), SoGLRenderAction::setSmallFeatureSize()
+  \since Coin 4.0
+*/
+void
+SoRenderManager::setSmallFeatureSize(const float pixels)
+{
+  PRIVATE(this)->smallfeaturesize = pixels;
+}
+
+/*!
+  Returns the small feature size used by the frame time governor.
+
+  \sa setSmallFeatureSize()
+  \since Coin 4.0
+*/
+float
+SoRenderManager::getSmallFeatureSize(void) const
+{
+  return PRIVATE(this)->smallfeaturesize;
+}
+
+/*!
+  Returns the quality level which will be used for the next frame,
+  between getMinimumQuality() and 1.0. It is always 1.0 when no target
+  frame time is set.
+
+  \sa setTargetFrameTime()
+  \since Coin 4.0
+*/
+float
+SoRenderManager::getQualityLevel(void) const
+{
+  return PRIVATE(this)->quality;
+}
+
+/*!
+  Returns the time spent rendering the last frame in render().
+
+  \sa getAverageFrameTime(), setTargetFrameTime()
+  \since Coin 4.0
+*/
+SbTime
+SoRenderManager::getLastFrameTime(void) const
+{
+  return PRIVATE(this)->lastframetime;
+}
+
+/*!
+  Returns an exponential moving average of the time spent rendering
+  frames in render(), where the last frame has a weight of 0.2.
+
+  \sa getLastFrameTime(), setTargetFrameTime()
+  \since Coin 4.0
+*/
+SbTime
+SoRenderManager::getAverageFrameTime(void) const
+{
+  return PRIVATE(this)->averageframetime;
+}
+
 
 /*!
   Adds a function to be called before rendering starts
@@ -1766,3 +1954,83 @@ SoRenderManager::removePostRenderCallback(SoRenderManagerRenderCB * cb, void * d
 
 #undef PRIVATE
 #undef PUBLIC
+
+// *************************************************************************
+
+#ifdef COIN_TEST_SUITE
+
+#include <cmath>
+#include <Inventor/SbTime.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/sensors/SoSensorManager.h>
+
+// Makes render() take at least the given number of seconds, as there
+// is no scene graph to render in the test suite.
+static void
+sorendermanager_test_busy_cb(void * closure, SoRenderManager *)
+{
+  const double seconds = *static_cast<const double *>(closure);
+  const SbTime start = SbTime::getTimeOfDay();
+  while ((SbTime::getTimeOfDay() - start).getValue() < seconds) { }
+}
+
+BOOST_AUTO_TEST_CASE(frameTimeGovernor)
+{
+  double frametime = 0.05;
+  SoRenderManager * mgr = new SoRenderManager;
+  mgr->addPreRenderCallback(sorendermanager_test_busy_cb, &frametime);
+
+  mgr->render();
+  BOOST_CHECK_MESSAGE(mgr->getQualityLevel() == 1.0f,
+                      "expected full quality without a target frame time");
+
+  mgr->setTargetFrameTime(SbTime(0.01));
+  mgr->setMinimumQuality(0.3f);
+  mgr->render();
+  const float first = mgr->getQualityLevel();
+  BOOST_CHECK_MESSAGE(first < 1.0f && first >= 0.3f,
+                      "expected lower quality for frames slower than the target");
+  BOOST_CHECK_MESSAGE(mgr->getLastFrameTime().getValue() >= frametime,
+                      "expected the last frame time to be measured");
+
+  for (int i = 0; i < 4; i++) {
+    mgr->render();
+    BOOST_CHECK_MESSAGE(mgr->getQualityLevel() >= 0.3f,
+                        "expected the quality to stay above the minimum");
+  }
+  BOOST_CHECK_MESSAGE(mgr->getQualityLevel() == 0.3f,
+                      "expected the minimum quality for frames much slower than the target");
+  BOOST_CHECK_MESSAGE(mgr->getAverageFrameTime().getValue() >= frametime,
+                      "expected the average of the slow frames");
+
+  // idle refinement raises the quality in steps of 0.25 until the
+  // scene is at full quality
+  frametime = 0.0;
+  const float steps[] = { 0.55f, 0.8f, 1.0f };
+  for (int i = 0; i < 3; i++) {
+    SoDB::getSensorManager()->processDelayQueue(TRUE);
+    BOOST_CHECK_MESSAGE(fabs(mgr->getQualityLevel() - steps[i]) < 1e-5f,
+                        "expected the idle refinement to raise the quality by 0.25");
+    mgr->render();
+  }
+  SoDB::getSensorManager()->processDelayQueue(TRUE);
+  BOOST_CHECK_MESSAGE(mgr->getQualityLevel() == 1.0f,
+                      "expected the refinement to stop at full quality");
+
+  // a change in the scene graph goes back to the quality of the last
+  // interactive frame
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  mgr->setSceneGraph(root);
+  root->touch();
+  SoDB::getSensorManager()->processDelayQueue(FALSE);
+  BOOST_CHECK_MESSAGE(mgr->getQualityLevel() == 0.3f,
+                      "expected a scene change to stop the refinement");
+  mgr->setSceneGraph(NULL);
+  root->unref();
+
+  delete mgr;
+}
+
+#endif // COIN_TEST_SUITE
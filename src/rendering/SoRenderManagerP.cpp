@@ -41,6 +41,7 @@
 #include <Inventor/actions/SoGetMatrixAction.h>
 #include <Inventor/actions/SoSearchAction.h>
 #include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/sensors/SoIdleSensor.h>
 
 SbBool SoRenderManagerP::touchtimer = TRUE;
 SbBool SoRenderManagerP::cleanupfunctionset = FALSE;
@@ -85,6 +86,79 @@ SoRenderManagerP::redrawshotTriggeredCB(void * data, SoSensor * /* sensor */)
 #endif // debug
 }
 
+// Called from the idle sensor when the application is idle after a
+// frame rendered with reduced quality. Raises the quality one step
+// and renders again.
+void
+SoRenderManagerP::refineCB(void * data, SoSensor * COIN_UNUSED_ARG(sensor))
+{
+  SoRenderManager * thisp = (SoRenderManager *) data;
+  PRIVATE(thisp)->refining = TRUE;
+  PRIVATE(thisp)->quality = SbMin(PRIVATE(thisp)->quality + 0.25f, 1.0f);
+  thisp->scheduleRedraw();
+}
+
+// Called after each frame with the time it took to render it.
+//
+// The governor models the cost of a frame as proportional to the
+// square of the quality level. The quality is used as the decimation
+// percentage, which scales the complexity of shapes, and a complexity
+// value controls the tessellation along both parametric directions of
+// a surface, so the number of triangles, and with it the rendering
+// time of a scene dominated by geometry, goes as quality squared.
+// From one frame time the quality which would have met the target is
+// therefore quality * sqrt(target / frametime). Scenes where the
+// frame time is dominated by costs that do not follow the quality,
+// like fill rate, state changes or a fixed number of nodes, make the
+// governor lower the quality more than needed, until it reaches the
+// minimum quality.
+void
+SoRenderManagerP::frameRendered(const SbTime & frametime)
+{
+  this->lastframetime = frametime;
+  if (this->averageframetime == SbTime::zero()) {
+    this->averageframetime = frametime;
+  }
+  else {
+    this->averageframetime.setValue(this->averageframetime.getValue() * 0.8 +
+                                    frametime.getValue() * 0.2);
+  }
+
+  const double target = this->targetframetime.getValue();
+  if (target <= 0.0) return;
+
+  if (!this->refining) {
+    // Frames which are not refinements are caused by changes in the
+    // scene graph, like camera movement, so the quality is adjusted
+    // to make the next frame take about the target time. The quality
+    // is raised at most 25% per frame to avoid oscillations.
+    const double seconds = frametime.getValue();
+    if (seconds > 0.0) {
+      const float scale = SbMin(float(sqrt(target / seconds)), 1.25f);
+      this->interactivequality =
+        SbClamp(this->quality * scale, this->minquality, 1.0f);
+    }
+    this->quality = this->interactivequality;
+  }
+  if (this->quality < 1.0f) {
+    this->refinesensor->schedule();
+  }
+}
+
+// Called when the scene graph changes. Stops the refinement, so the
+// next frame is rendered with the interactive quality.
+void
+SoRenderManagerP::sceneChanged(void)
+{
+  if (this->refinesensor->isScheduled()) {
+    this->refinesensor->unschedule();
+  }
+  if (this->refining) {
+    this->refining = FALSE;
+    this->quality = this->interactivequality;
+  }
+}
+
 void
 SoRenderManagerP::cleanup(void)
 {
@@ -59,6 +59,7 @@ class SoGetBoundingBoxAction;
 class SoGetMatrixAction;
 class SoSearchAction;
 class SbPList;
+class SoIdleSensor;
 
 class SoRenderManagerP {
 public:
@@ -70,6 +71,9 @@ public:
   void getCameraCoordinateSystem(SbMatrix & matrix,
                                  SbMatrix & inverse);
   static void redrawshotTriggeredCB(void * data, SoSensor * sensor);
+  static void refineCB(void * data, SoSensor * sensor);
+  void frameRendered(const SbTime & frametime);
+  void sceneChanged(void);
   static void cleanup(void);
 
   void lock(void) {
@@ -122,6 +126,17 @@ public:
 
   SbPList * superimpositions;
 
+  // frame time governor
+  SbTime targetframetime;
+  float minquality;
+  float smallfeaturesize;
+  float quality;
+  float interactivequality;
+  SbBool refining;
+  SoIdleSensor * refinesensor;
+  SbTime lastframetime;
+  SbTime averageframetime;
+
   void invokePreRenderCallbacks(void);
   void invokePostRenderCallbacks(void);
   typedef std::pair<SoRenderManagerRenderCB *, void *> RenderCBTouple;
@@ -196,6 +196,7 @@
 #include "glue/cg.h"
 #include "misc/SbHash.h"
 #include "tidbitsp.h"
+#include "nodes/SoSubNodeP.h"
 
 // *************************************************************************
 
@@ -248,11 +249,11 @@ SoShader::init(void)
   if (SoShaderObject::getClassTypeId() == SoType::badType())
     SoShaderObject::initClass();
   if (SoFragmentShader::getClassTypeId() == SoType::badType())
-    SoFragmentShader::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoFragmentShader, SoShaderObject);
   if (SoVertexShader::getClassTypeId() == SoType::badType())
-    SoVertexShader::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVertexShader, SoShaderObject);
   if (SoGeometryShader::getClassTypeId() == SoType::badType())
-    SoGeometryShader::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoGeometryShader, SoShaderObject);
 
   // --- initialization of parameter nodes -----------------------------
   if (SoShaderParameter::getClassTypeId() == SoType::badType())
@@ -262,13 +263,13 @@ SoShader::init(void)
 
   // float vector parameter nodes
   if (SoShaderParameter1f::getClassTypeId() == SoType::badType())
-    SoShaderParameter1f::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter1f, SoUniformShaderParameter);
   if (SoShaderParameter2f::getClassTypeId() == SoType::badType())
-    SoShaderParameter2f::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter2f, SoUniformShaderParameter);
   if (SoShaderParameter3f::getClassTypeId() == SoType::badType())
-    SoShaderParameter3f::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter3f, SoUniformShaderParameter);
   if (SoShaderParameter4f::getClassTypeId() == SoType::badType())
-    SoShaderParameter4f::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter4f, SoUniformShaderParameter);
 
   // float vector array parameter nodes
   if (SoShaderParameterArray1f::getClassTypeId() == SoType::badType())
@@ -282,7 +283,7 @@ SoShader::init(void)
 
   // matrix parameter nodes
   if (SoShaderStateMatrixParameter::getClassTypeId() == SoType::badType())
-    SoShaderStateMatrixParameter::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderStateMatrixParameter, SoUniformShaderParameter);
   if (SoShaderParameterMatrix::getClassTypeId() == SoType::badType())
     SoShaderParameterMatrix::initClass();
   if (SoShaderParameterMatrixArray::getClassTypeId() == SoType::badType())
@@ -290,24 +291,24 @@ SoShader::init(void)
 
   // int32 support
   if (SoShaderParameter1i::getClassTypeId() == SoType::badType())
-    SoShaderParameter1i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter1i, SoUniformShaderParameter);
 
   // FIXME: Do we need int32 support (like in TGS)? 20040924 martin
 #if 1
   if (SoShaderParameter2i::getClassTypeId() == SoType::badType())
-    SoShaderParameter2i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter2i, SoUniformShaderParameter);
   if (SoShaderParameter3i::getClassTypeId() == SoType::badType())
-    SoShaderParameter3i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter3i, SoUniformShaderParameter);
   if (SoShaderParameter4i::getClassTypeId() == SoType::badType())
-    SoShaderParameter4i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameter4i, SoUniformShaderParameter);
   if (SoShaderParameterArray1i::getClassTypeId() == SoType::badType())
-    SoShaderParameterArray1i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameterArray1i, SoUniformShaderParameter);
   if (SoShaderParameterArray2i::getClassTypeId() == SoType::badType())
-    SoShaderParameterArray2i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameterArray2i, SoUniformShaderParameter);
   if (SoShaderParameterArray3i::getClassTypeId() == SoType::badType())
-    SoShaderParameterArray3i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameterArray3i, SoUniformShaderParameter);
   if (SoShaderParameterArray4i::getClassTypeId() == SoType::badType())
-    SoShaderParameterArray4i::initClass();
+    SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoShaderParameterArray4i, SoUniformShaderParameter);
 #endif
 
   SO_SHADER_DIR = coin_getenv("SO_SHADER_DIR");
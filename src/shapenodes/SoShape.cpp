@@ -75,6 +75,8 @@
 #include <Inventor/elements/SoComplexityElement.h>
 #include <Inventor/elements/SoCoordinateElement.h>
 #include <Inventor/elements/SoCullElement.h>
+#include <Inventor/elements/SoDecimationPercentageElement.h>
+#include <Inventor/elements/SoDecimationTypeElement.h>
 #include <Inventor/elements/SoGLCacheContextElement.h>
 #include <Inventor/elements/SoGLLazyElement.h>
 #include <Inventor/elements/SoGLMultiTextureEnabledElement.h>
@@ -507,11 +509,15 @@ SoShape::getScreenSize(SoState * const state, const SbBox3f & boundingbox,
   complexity type. For \c OBJECT_SPACE complexity this will be a
   number between 0 and 1. For \c SCREEN_SPACE complexity it is a
   number from 0 and up.
+
+  If the decimation type is SoDecimationTypeElement::PERCENTAGE, the
+  value is scaled by the decimation percentage.
 */
 float
 SoShape::getComplexityValue(SoAction * action)
 {
   SoState * state = action->getState();
+  float complexity;
   switch (SoComplexityTypeElement::get(state)) {
   case SoComplexityTypeElement::SCREEN_SPACE:
     {
@@ -526,15 +532,17 @@ SoShape::getComplexityValue(SoAction * action)
       // The cast within the sqrt() is done to avoid ambigouity error
       // from HPUX aCC, as sqrt() can be either "long double sqrt(long
       // double)" or "float sqrt(float)". mortene.
-      return float(sqrt((float)SbMax(size[0], size[1]))) * 0.4f *
+      complexity = float(sqrt((float)SbMax(size[0], size[1]))) * 0.4f *
         SoComplexityElement::get(state);
 #else // first version
       float numPixels = float(size[0])* float(size[1]);
-      return numPixels * 0.0001f * SoComplexityElement::get(state);
+      complexity = numPixels * 0.0001f * SoComplexityElement::get(state);
 #endif
     }
+    break;
   case SoComplexityTypeElement::OBJECT_SPACE:
-    return SoComplexityElement::get(state);
+    complexity = SoComplexityElement::get(state);
+    break;
   case SoComplexityTypeElement::BOUNDING_BOX:
     // return default value. We might get here when generating
     // primitives, not when rendering.
@@ -543,6 +551,12 @@ SoShape::getComplexityValue(SoAction * action)
     assert(0 && "unknown complexity type");
     return 0.5f;
   }
+
+  if (state->isElementEnabled(SoDecimationTypeElement::getClassStackIndex()) &&
+      (SoDecimationTypeElement::get(state) == SoDecimationTypeElement::PERCENTAGE)) {
+    complexity *= SbClamp(SoDecimationPercentageElement::get(state), 0.0f, 1.0f);
+  }
+  return complexity;
 }
 
 /*!
@@ -567,6 +581,16 @@ SoShape::shouldGLRender(SoGLRenderAction * action)
     }
   }
 
+  const float featuresize = action->getSmallFeatureSize();
+  if ((featuresize > 0.0f) && PRIVATE(this)->bboxcache &&
+      !state->isCacheOpen() && PRIVATE(this)->bboxcache->isValid(state)) {
+    SbVec2s size;
+    SoShape::getScreenSize(state, PRIVATE(this)->bboxcache->getProjectedBox(), size);
+    if ((float(size[0]) < featuresize) && (float(size[1]) < featuresize)) {
+      return FALSE;
+    }
+  }
+
   SbBool transparent = (shapestyleflags & (SoShapeStyleElement::TRANSP_TEXTURE|
                                            SoShapeStyleElement::TRANSP_MATERIAL)) != 0;
 
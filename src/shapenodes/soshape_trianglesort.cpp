@@ -51,16 +51,24 @@
 #include <Inventor/C/tidbits.h>
 #include <Inventor/system/gl.h>
 
+#include "misc/SbRadixSort.h"
+
 soshape_trianglesort::soshape_trianglesort(void)
 {
   this->pvlist = NULL;
   this->trianglelist = NULL;
+  this->distlist = NULL;
+  this->seedlist = NULL;
+  this->radixsort = NULL;
 }
 
 soshape_trianglesort::~soshape_trianglesort()
 {
   delete this->pvlist;
   delete this->trianglelist;
+  delete this->distlist;
+  delete this->seedlist;
+  delete this->radixsort;
 }
 
 void
@@ -69,6 +77,9 @@ soshape_trianglesort::beginShape(SoState *)
   if (this->pvlist == NULL) {
     this->pvlist = new SbList <SoPrimitiveVertex>;
     this->trianglelist = new SbList <sorted_triangle>;
+    this->distlist = new SbList <float>;
+    this->seedlist = new SbList <int>;
+    this->radixsort = new SbRadixSort;
   }
   pvlist->truncate(0);
 }
@@ -85,24 +96,6 @@ soshape_trianglesort::triangle(SoState *,
   this->pvlist->append(*v3);
 }
 
-// qsort() callback.
-//
-// "extern C" wrapper is needed with the OSF1/cxx compiler (probably a
-// bug in the compiler, but it doesn't seem to hurt to do this
-// anyway).
-extern "C" {
-static int
-compare_triangles(const void * ptr1, const void * ptr2)
-{
-  soshape_trianglesort::sorted_triangle * tri1 = (soshape_trianglesort::sorted_triangle*) ptr1;
-  soshape_trianglesort::sorted_triangle * tri2 = (soshape_trianglesort::sorted_triangle*) ptr2;
-
-  if (tri1->dist > tri2->dist) return -1;
-  if (tri1->dist == tri2->dist) return tri2->backface - tri1->backface;
-  return 1;
-}
-}
-
 void
 soshape_trianglesort::endShape(SoState * state, SoMaterialBundle & mb)
 {
@@ -181,7 +174,23 @@ soshape_trianglesort::endShape(SoState * state, SoMaterialBundle & mb)
   }
 
   const sorted_triangle * tarray = this->trianglelist->getArrayPtr();
-  qsort((void*)tarray, n, sizeof(sorted_triangle), compare_triangles);
+
+  // Sort back to front. Triangles at equal distance are ordered with
+  // backfaces first. Since the radix sort is stable, this is achieved
+  // by seeding it with all backfacing triangles in front of the
+  // frontfacing ones.
+  this->distlist->truncate(0);
+  this->seedlist->truncate(0);
+  for (i = 0; i < n; i++) {
+    this->distlist->append(tarray[i].dist);
+    if (tarray[i].backface) this->seedlist->append(i);
+  }
+  for (i = 0; i < n; i++) {
+    if (!tarray[i].backface) this->seedlist->append(i);
+  }
+  const int * sorted = this->radixsort->sort(this->distlist->getArrayPtr(), n,
+                                             SbRadixSort::DESCENDING,
+                                             this->seedlist->getArrayPtr());
 
   int idx;
 
@@ -190,7 +199,7 @@ soshape_trianglesort::endShape(SoState * state, SoMaterialBundle & mb)
   // sort the triangles anyway.
   glBegin(GL_TRIANGLES);
   for (i = 0; i < n; i++) {
-    idx = tarray[i].idx;
+    idx = tarray[sorted[i]].idx;
     v = varray + idx;
     glTexCoord4fv(v->getTextureCoords().getValue());
     glNormal3fv(v->getNormal().getValue());
@@ -43,6 +43,7 @@
 class SoState;
 class SoPrimitiveVertex;
 class SoMaterialBundle;
+class SbRadixSort;
 
 class soshape_trianglesort {
 public:
@@ -66,6 +67,9 @@ private:
 
   SbList <SoPrimitiveVertex> * pvlist;
   SbList <sorted_triangle> * trianglelist;
+  SbList <float> * distlist;
+  SbList <int> * seedlist;
+  SbRadixSort * radixsort;
 };
 
 #endif // !COIN_SOSHAPE_TRIANGLESORT_H
@@ -32,6 +32,7 @@
 
 #include "common.cpp"
 #include "storage.cpp" /* cc_storage ADT works without the thread abstractions */
+#include "wsched.cpp" /* runs tasks in the calling thread without threads */
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -0,0 +1,209 @@
+#ifndef CC_ATOMICP_H
+#define CC_ATOMICP_H
+
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <Inventor/system/inttypes.h>
+
+/*
+  Atomic operations on 32-bit integers and pointers. The loads have
+  acquire semantics, cc_atomic_store_ptr() has release semantics, and
+  the other operations are full memory barriers.
+
+  Compiler intrinsics are used where available (GCC 4.1+ and
+  compatibles, MSVC). Other thread enabled builds fall back on the
+  global mutex, which is correct but not lock-free. Without thread
+  support these are plain operations.
+*/
+
+#if defined(HAVE_THREADS) && defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 1)))
+#define CC_ATOMIC_GCC_INTRINSICS
+#elif defined(HAVE_THREADS) && defined(_MSC_VER)
+#define CC_ATOMIC_WIN32_INTERLOCKED
+#include <windows.h>
+#include <intrin.h>
+#elif defined(HAVE_THREADS)
+#define CC_ATOMIC_GLOBAL_MUTEX
+#include "threads/mutexp.h"
+#endif
+
+/* Returns the value of *ptr, with acquire semantics. */
+static inline int32_t
+cc_atomic_load32(const volatile int32_t * ptr)
+{
+#if defined(CC_ATOMIC_GCC_INTRINSICS) && defined(__ATOMIC_ACQUIRE)
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(CC_ATOMIC_GCC_INTRINSICS)
+  int32_t val = *ptr;
+  __sync_synchronize();
+  return val;
+#elif defined(CC_ATOMIC_WIN32_INTERLOCKED)
+  int32_t val = *ptr;
+  _ReadWriteBarrier();
+  return val;
+#elif defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_lock();
+  int32_t val = *ptr;
+  cc_mutex_global_unlock();
+  return val;
+#else
+  return *ptr;
+#endif
+}
+
+/*
+  Sets *ptr to newval if it equals oldval. Returns the value *ptr had
+  before the operation, i.e. the exchange happened if the return
+  value equals oldval.
+*/
+static inline int32_t
+cc_atomic_cas32(volatile int32_t * ptr, int32_t oldval, int32_t newval)
+{
+#if defined(CC_ATOMIC_GCC_INTRINSICS)
+  return __sync_val_compare_and_swap(ptr, oldval, newval);
+#elif defined(CC_ATOMIC_WIN32_INTERLOCKED)
+  return static_cast<int32_t>(InterlockedCompareExchange(reinterpret_cast<volatile LONG *>(ptr), newval, oldval));
+#else
+#if defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_lock();
+#endif
+  int32_t val = *ptr;
+  if (val == oldval) *ptr = newval;
+#if defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_unlock();
+#endif
+  return val;
+#endif
+}
+
+/* Adds delta to *ptr, and returns the new value. */
+static inline int32_t
+cc_atomic_add32(volatile int32_t * ptr, int32_t delta)
+{
+#if defined(CC_ATOMIC_GCC_INTRINSICS)
+  return __sync_add_and_fetch(ptr, delta);
+#elif defined(CC_ATOMIC_WIN32_INTERLOCKED)
+  return static_cast<int32_t>(InterlockedExchangeAdd(reinterpret_cast<volatile LONG *>(ptr), delta)) + delta;
+#else
+#if defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_lock();
+#endif
+  int32_t val = (*ptr += delta);
+#if defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_unlock();
+#endif
+  return val;
+#endif
+}
+
+/* Returns the value of *ptr, with acquire semantics. */
+static inline void *
+cc_atomic_load_ptr(void * const volatile * ptr)
+{
+#if defined(CC_ATOMIC_GCC_INTRINSICS) && defined(__ATOMIC_ACQUIRE)
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(CC_ATOMIC_GCC_INTRINSICS)
+  void * val = *ptr;
+  __sync_synchronize();
+  return val;
+#elif defined(CC_ATOMIC_WIN32_INTERLOCKED)
+  void * val = *ptr;
+  _ReadWriteBarrier();
+  return val;
+#elif defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_lock();
+  void * val = *ptr;
+  cc_mutex_global_unlock();
+  return val;
+#else
+  return *ptr;
+#endif
+}
+
+/*
+  Sets *ptr to val, with release semantics, i.e. writes made before
+  this are visible to a thread which reads val with
+  cc_atomic_load_ptr().
+*/
+static inline void
+cc_atomic_store_ptr(void * volatile * ptr, void * val)
+{
+#if defined(CC_ATOMIC_GCC_INTRINSICS) && defined(__ATOMIC_RELEASE)
+  __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+#elif defined(CC_ATOMIC_GCC_INTRINSICS)
+  __sync_synchronize();
+  *ptr = val;
+#elif defined(CC_ATOMIC_WIN32_INTERLOCKED)
+  _ReadWriteBarrier();
+  *ptr = val;
+#elif defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_lock();
+  *ptr = val;
+  cc_mutex_global_unlock();
+#else
+  *ptr = val;
+#endif
+}
+
+/* Pointer version of cc_atomic_cas32(). */
+static inline void *
+cc_atomic_cas_ptr(void * volatile * ptr, void * oldval, void * newval)
+{
+#if defined(CC_ATOMIC_GCC_INTRINSICS)
+  return __sync_val_compare_and_swap(ptr, oldval, newval);
+#elif defined(CC_ATOMIC_WIN32_INTERLOCKED)
+  return InterlockedCompareExchangePointer(ptr, newval, oldval);
+#else
+#if defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_lock();
+#endif
+  void * val = *ptr;
+  if (val == oldval) *ptr = newval;
+#if defined(CC_ATOMIC_GLOBAL_MUTEX)
+  cc_mutex_global_unlock();
+#endif
+  return val;
+#endif
+}
+
+#endif /* ! CC_ATOMICP_H */
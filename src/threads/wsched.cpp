@@ -0,0 +1,605 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*! \file wsched.h */
+#include <Inventor/C/threads/wsched.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+/*
+  The work-stealing scheduler is a complement to cc_sched for
+  fine-grained parallelism. Where cc_sched keeps a single prioritized
+  queue behind one lock, cc_wsched gives each worker thread its own
+  queue of tasks. A worker runs its own tasks newest first, which keeps
+  the data of a split-up loop in the cache, and steals the oldest
+  (and usually largest) task from another worker when its own queue
+  is empty.
+
+  Work is submitted either as a group of independent jobs
+  (cc_wsched_group_run() / cc_wsched_group_wait()), or as a loop over
+  an index range (cc_wsched_parallel_for()) that is recursively split
+  in two halves until the halves are no larger than the grain size.
+
+  A thread waiting for a group executes pending tasks while waiting,
+  so tasks may themselves run groups and loops without risking a
+  deadlock.
+
+  When Coin is built without thread support, or when a scheduler is
+  constructed with zero threads, all work is done by the calling
+  thread.
+*/
+
+#ifndef HAVE_THREADS
+
+struct cc_wsched {
+  int dummy;
+};
+
+struct cc_wsched_group {
+  cc_wsched * sched;
+};
+
+cc_wsched *
+cc_wsched_construct(int numthreads)
+{
+  return (cc_wsched *) malloc(sizeof(cc_wsched));
+}
+
+void
+cc_wsched_destruct(cc_wsched * sched)
+{
+  free(sched);
+}
+
+int
+cc_wsched_get_num_threads(cc_wsched * sched)
+{
+  return 0;
+}
+
+cc_wsched_group *
+cc_wsched_group_construct(cc_wsched * sched)
+{
+  cc_wsched_group * group = (cc_wsched_group *) malloc(sizeof(cc_wsched_group));
+  group->sched = sched;
+  return group;
+}
+
+void
+cc_wsched_group_destruct(cc_wsched_group * group)
+{
+  free(group);
+}
+
+void
+cc_wsched_group_run(cc_wsched_group * group,
+                    cc_wsched_f * workfunc, void * closure)
+{
+  workfunc(closure);
+}
+
+void
+cc_wsched_group_wait(cc_wsched_group * group)
+{
+}
+
+void
+cc_wsched_parallel_for(cc_wsched * sched,
+                       int begin, int end, int grainsize,
+                       cc_wsched_range_f * workfunc, void * closure)
+{
+  if (end > begin) workfunc(closure, begin, end);
+}
+
+#else /* HAVE_THREADS */
+
+#include <Inventor/C/threads/condvar.h>
+#include <Inventor/C/threads/mutex.h>
+#include <Inventor/C/threads/thread.h>
+
+#include "threads/wschedp.h"
+
+/* ********************************************************************** */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* private methods */
+
+static void
+wsched_deque_init(wsched_deque * deque)
+{
+  deque->mutex = cc_mutex_construct();
+  deque->size = 64;
+  deque->tasks = (wsched_task *) malloc(deque->size * sizeof(wsched_task));
+  assert(deque->tasks);
+  deque->top = 0;
+  deque->bottom = 0;
+}
+
+static void
+wsched_deque_clean(wsched_deque * deque)
+{
+  cc_mutex_destruct(deque->mutex);
+  free(deque->tasks);
+}
+
+static void
+wsched_deque_push(wsched_deque * deque, const wsched_task * task)
+{
+  cc_mutex_lock(deque->mutex);
+  if (deque->bottom - deque->top == deque->size) {
+    /* full, double the size and unwrap the ring buffer */
+    int i, n = deque->size;
+    wsched_task * tasks = (wsched_task *) malloc(2 * n * sizeof(wsched_task));
+    assert(tasks);
+    for (i = 0; i < n; i++) {
+      tasks[i] = deque->tasks[(deque->top + i) & (n - 1)];
+    }
+    free(deque->tasks);
+    deque->tasks = tasks;
+    deque->size = 2 * n;
+    deque->top = 0;
+    deque->bottom = n;
+  }
+  deque->tasks[deque->bottom & (deque->size - 1)] = *task;
+  deque->bottom++;
+  cc_mutex_unlock(deque->mutex);
+}
+
+/* take the newest task, used by the deque owner */
+static SbBool
+wsched_deque_pop(wsched_deque * deque, wsched_task * task)
+{
+  SbBool found = FALSE;
+  cc_mutex_lock(deque->mutex);
+  if (deque->bottom != deque->top) {
+    deque->bottom--;
+    *task = deque->tasks[deque->bottom & (deque->size - 1)];
+    found = TRUE;
+  }
+  cc_mutex_unlock(deque->mutex);
+  return found;
+}
+
+/* take the oldest task, used by other threads */
+static SbBool
+wsched_deque_steal(wsched_deque * deque, wsched_task * task)
+{
+  SbBool found = FALSE;
+  cc_mutex_lock(deque->mutex);
+  if (deque->bottom != deque->top) {
+    *task = deque->tasks[deque->top & (deque->size - 1)];
+    deque->top++;
+    found = TRUE;
+  }
+  cc_mutex_unlock(deque->mutex);
+  return found;
+}
+
+/* returns the index of the calling thread's deque */
+static int
+wsched_get_index(cc_wsched * sched)
+{
+  int i;
+  unsigned long id = cc_thread_id();
+  for (i = 0; i < sched->numworkers; i++) {
+    if (sched->workers[i].threadid == id) return i;
+  }
+  /* not a worker thread, use the shared deque */
+  return sched->numworkers;
+}
+
+static SbBool
+wsched_find_task(cc_wsched * sched, int index, wsched_task * task)
+{
+  int i, n = sched->numworkers + 1;
+  if (wsched_deque_pop(&sched->deques[index], task)) return TRUE;
+  for (i = 1; i < n; i++) {
+    if (wsched_deque_steal(&sched->deques[(index + i) % n], task)) return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+wsched_push(cc_wsched * sched, int index, const wsched_task * task)
+{
+  cc_mutex_lock(task->group->mutex);
+  task->group->pending++;
+  cc_mutex_unlock(task->group->mutex);
+
+  wsched_deque_push(&sched->deques[index], task);
+
+  /* the sleep mutex must be taken even if nobody seems to sleep, as a
+     worker checks the deques for the last time while holding it */
+  cc_mutex_lock(sched->sleepmutex);
+  if (sched->numsleeping > 0) cc_condvar_wake_one(sched->sleepcond);
+  cc_mutex_unlock(sched->sleepmutex);
+}
+
+static void
+wsched_finish(cc_wsched_group * group)
+{
+  cc_mutex_lock(group->mutex);
+  assert(group->pending > 0);
+  if (--group->pending == 0) cc_condvar_wake_all(group->donecond);
+  /* the group may be destructed as soon as the mutex is released */
+  cc_mutex_unlock(group->mutex);
+}
+
+static void
+wsched_execute(cc_wsched * sched, int index, wsched_task * task)
+{
+  if (task->rangefunc) {
+    /* split off the upper half until the range is small enough,
+       leaving the halves for idle workers to steal */
+    while (task->end - task->begin > task->grainsize) {
+      wsched_task upper = *task;
+      upper.begin = task->begin + (task->end - task->begin) / 2;
+      task->end = upper.begin;
+      wsched_push(sched, index, &upper);
+    }
+    task->rangefunc(task->closure, task->begin, task->end);
+  }
+  else {
+    task->workfunc(task->closure);
+  }
+  wsched_finish(task->group);
+}
+
+static void *
+wsched_worker_entry_point(void * userdata)
+{
+  wsched_task task;
+  wsched_worker * worker = (wsched_worker *) userdata;
+  cc_wsched * sched = worker->sched;
+
+  cc_mutex_lock(sched->sleepmutex);
+  worker->threadid = cc_thread_id();
+  sched->numstarted++;
+  cc_condvar_wake_all(sched->sleepcond);
+  cc_mutex_unlock(sched->sleepmutex);
+
+  for (;;) {
+    if (wsched_find_task(sched, worker->index, &task)) {
+      wsched_execute(sched, worker->index, &task);
+      continue;
+    }
+    cc_mutex_lock(sched->sleepmutex);
+    if (sched->quit) {
+      cc_mutex_unlock(sched->sleepmutex);
+      break;
+    }
+    /* check once more while holding the sleep mutex, so that a task
+       pushed after the check above is not missed */
+    if (wsched_find_task(sched, worker->index, &task)) {
+      cc_mutex_unlock(sched->sleepmutex);
+      wsched_execute(sched, worker->index, &task);
+      continue;
+    }
+    sched->numsleeping++;
+    (void) cc_condvar_wait(sched->sleepcond, sched->sleepmutex);
+    sched->numsleeping--;
+    cc_mutex_unlock(sched->sleepmutex);
+  }
+  return NULL;
+}
+
+/* ********************************************************************** */
+/* public api */
+
+/*!
+  Construct a work-stealing scheduler that uses \a numthreads worker
+  threads. If \a numthreads is 0, all work is done in the threads
+  that submit it.
+*/
+cc_wsched *
+cc_wsched_construct(int numthreads)
+{
+  int i;
+  cc_wsched * sched = (cc_wsched *) malloc(sizeof(cc_wsched));
+  assert(sched);
+  assert(numthreads >= 0);
+
+  sched->numworkers = numthreads;
+  sched->workers = (wsched_worker *) malloc((numthreads + 1) * sizeof(wsched_worker));
+  sched->deques = (wsched_deque *) malloc((numthreads + 1) * sizeof(wsched_deque));
+  assert(sched->workers && sched->deques);
+  for (i = 0; i <= numthreads; i++) {
+    wsched_deque_init(&sched->deques[i]);
+  }
+  sched->sleepmutex = cc_mutex_construct();
+  sched->sleepcond = cc_condvar_construct();
+  sched->numsleeping = 0;
+  sched->numstarted = 0;
+  sched->quit = FALSE;
+
+  for (i = 0; i < numthreads; i++) {
+    wsched_worker * worker = &sched->workers[i];
+    worker->sched = sched;
+    worker->threadid = 0;
+    worker->index = i;
+    worker->thread = cc_thread_construct(wsched_worker_entry_point, worker);
+  }
+  /* the thread ids must be known before tasks are submitted, as they
+     are used to look up the deque of the calling thread */
+  cc_mutex_lock(sched->sleepmutex);
+  while (sched->numstarted < numthreads) {
+    (void) cc_condvar_wait(sched->sleepcond, sched->sleepmutex);
+  }
+  cc_mutex_unlock(sched->sleepmutex);
+  return sched;
+}
+
+/*!
+  Destruct the scheduler. The worker threads are stopped, and tasks
+  not yet started are discarded. Wait for all groups before calling
+  this method.
+*/
+void
+cc_wsched_destruct(cc_wsched * sched)
+{
+  int i;
+  cc_mutex_lock(sched->sleepmutex);
+  sched->quit = TRUE;
+  cc_condvar_wake_all(sched->sleepcond);
+  cc_mutex_unlock(sched->sleepmutex);
+
+  for (i = 0; i < sched->numworkers; i++) {
+    (void) cc_thread_join(sched->workers[i].thread, NULL);
+    cc_thread_destruct(sched->workers[i].thread);
+  }
+  for (i = 0; i <= sched->numworkers; i++) {
+    wsched_deque_clean(&sched->deques[i]);
+  }
+  cc_condvar_destruct(sched->sleepcond);
+  cc_mutex_destruct(sched->sleepmutex);
+  free(sched->deques);
+  free(sched->workers);
+  free(sched);
+}
+
+/*!
+  Returns the number of worker threads used by the scheduler.
+*/
+int
+cc_wsched_get_num_threads(cc_wsched * sched)
+{
+  return sched->numworkers;
+}
+
+/*!
+  Construct a task group. Tasks are added to the group with
+  cc_wsched_group_run(), and cc_wsched_group_wait() waits until all of
+  them have finished.
+*/
+cc_wsched_group *
+cc_wsched_group_construct(cc_wsched * sched)
+{
+  cc_wsched_group * group = (cc_wsched_group *) malloc(sizeof(cc_wsched_group));
+  assert(group);
+  group->sched = sched;
+  group->mutex = cc_mutex_construct();
+  group->donecond = cc_condvar_construct();
+  group->pending = 0;
+  return group;
+}
+
+/*!
+  Destruct the group. Waits for the tasks in the group to finish
+  first.
+*/
+void
+cc_wsched_group_destruct(cc_wsched_group * group)
+{
+  cc_wsched_group_wait(group);
+  cc_condvar_destruct(group->donecond);
+  cc_mutex_destruct(group->mutex);
+  free(group);
+}
+
+/*!
+  Adds a task to the group. A worker thread will call \a workfunc with
+  the \a closure argument. Tasks may be added from any thread,
+  including from within other tasks.
+*/
+void
+cc_wsched_group_run(cc_wsched_group * group,
+                    cc_wsched_f * workfunc, void * closure)
+{
+  cc_wsched * sched = group->sched;
+  wsched_task task;
+
+  if (sched->numworkers == 0) {
+    workfunc(closure);
+    return;
+  }
+  task.workfunc = workfunc;
+  task.rangefunc = NULL;
+  task.closure = closure;
+  task.group = group;
+  task.begin = task.end = task.grainsize = 0;
+  wsched_push(sched, wsched_get_index(sched), &task);
+}
+
+/*!
+  Waits for all tasks in the group to finish. The calling thread
+  executes pending tasks, from this or other groups, while waiting.
+*/
+void
+cc_wsched_group_wait(cc_wsched_group * group)
+{
+  wsched_task task;
+  cc_wsched * sched = group->sched;
+  const int index = wsched_get_index(sched);
+
+  for (;;) {
+    cc_mutex_lock(group->mutex);
+    if (group->pending == 0) break;
+    cc_mutex_unlock(group->mutex);
+
+    if (wsched_find_task(sched, index, &task)) {
+      wsched_execute(sched, index, &task);
+      continue;
+    }
+    /* the remaining tasks are being executed by other threads. Sleep
+       until they finish, but look for new tasks now and then, as the
+       executing tasks may split up further. */
+    cc_mutex_lock(group->mutex);
+    if (group->pending == 0) break;
+    (void) cc_condvar_timed_wait(group->donecond, group->mutex, 0.001);
+    cc_mutex_unlock(group->mutex);
+  }
+  cc_mutex_unlock(group->mutex);
+}
+
+/*!
+  Calls \a workfunc for subranges of [\a begin, \a end) in parallel,
+  and returns when the whole range has been processed. The range is
+  split in halves until they contain at most \a grainsize
+  indices. If \a grainsize is 0 or less, a grain size giving about
+  eight subranges per thread is chosen.
+
+  The calling thread takes part in the work.
+*/
+void
+cc_wsched_parallel_for(cc_wsched * sched,
+                       int begin, int end, int grainsize,
+                       cc_wsched_range_f * workfunc, void * closure)
+{
+  wsched_task task;
+  cc_wsched_group * group;
+  int index;
+
+  if (end <= begin) return;
+  if (grainsize <= 0) {
+    grainsize = (end - begin) / (8 * (sched->numworkers + 1));
+    if (grainsize < 1) grainsize = 1;
+  }
+  if (sched->numworkers == 0 || end - begin <= grainsize) {
+    workfunc(closure, begin, end);
+    return;
+  }
+
+  group = cc_wsched_group_construct(sched);
+  index = wsched_get_index(sched);
+  task.workfunc = NULL;
+  task.rangefunc = workfunc;
+  task.closure = closure;
+  task.group = group;
+  task.begin = begin;
+  task.end = end;
+  task.grainsize = grainsize;
+
+  cc_mutex_lock(group->mutex);
+  group->pending++;
+  cc_mutex_unlock(group->mutex);
+  wsched_execute(sched, index, &task);
+  cc_wsched_group_destruct(group);
+}
+
+/* ********************************************************************** */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* HAVE_THREADS */
+
+/* ********************************************************************** */
+/* shared instance */
+
+#include <Inventor/C/tidbits.h>
+
+#include "tidbitsp.h"
+#include "threads/threadsutilp.h"
+#include "threads/wschedp.h"
+
+#ifdef HAVE_WIN32_API
+#include <windows.h>
+#elif defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+
+static cc_wsched * wsched_global = NULL;
+
+static void
+wsched_global_cleanup(void)
+{
+  cc_wsched_destruct(wsched_global);
+  wsched_global = NULL;
+}
+
+static int
+wsched_num_processors(void)
+{
+#ifdef HAVE_WIN32_API
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int) info.dwNumberOfProcessors;
+#elif defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  const long num = sysconf(_SC_NPROCESSORS_ONLN);
+  return num > 0 ? (int) num : 1;
+#else
+  return 1;
+#endif
+}
+
+/*
+  Returns the scheduler shared by internal parallel loops. The number
+  of worker threads can be set with the COIN_WSCHED_NUM_THREADS
+  environment variable. Setting it to 0 makes all work run in the
+  calling thread.
+*/
+cc_wsched *
+cc_wsched_global_instance(void)
+{
+  if (wsched_global == NULL) {
+    CC_GLOBAL_LOCK;
+    if (wsched_global == NULL) {
+      int numthreads = wsched_num_processors() - 1;
+      const char * env = coin_getenv("COIN_WSCHED_NUM_THREADS");
+      if (env) { numthreads = atoi(env); }
+      if (numthreads < 0) { numthreads = 0; }
+      wsched_global = cc_wsched_construct(numthreads);
+      coin_atexit((coin_atexit_f *) wsched_global_cleanup, CC_ATEXIT_THREADING_SUBSYSTEM);
+    }
+    CC_GLOBAL_UNLOCK;
+  }
+  return wsched_global;
+}
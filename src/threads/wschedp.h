@@ -0,0 +1,118 @@
+#ifndef CC_WSCHEDP_H
+#define CC_WSCHEDP_H
+
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef COIN_INTERNAL
+#error this is a private header file
+#endif /* ! COIN_INTERNAL */
+
+#include <Inventor/C/threads/common.h>
+#include <Inventor/C/threads/wsched.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ********************************************************************** */
+
+#ifdef HAVE_THREADS
+
+/* A task is either a plain job or a part of a parallel loop. Tasks
+   are stored by value, so running a task needs no allocation. */
+typedef struct {
+  cc_wsched_f * workfunc;
+  cc_wsched_range_f * rangefunc;
+  void * closure;
+  cc_wsched_group * group;
+  int begin, end, grainsize;
+} wsched_task;
+
+/* Double-ended queue of tasks. The owner pushes and pops at the
+   bottom, other threads steal from the top. Each deque has its own
+   lock, so threads only contend when they steal from the same
+   deque. */
+typedef struct {
+  cc_mutex * mutex;
+  wsched_task * tasks;
+  int size;                      /*! Capacity, a power of two */
+  int top;                       /*! Index of the oldest task */
+  int bottom;                    /*! Index after the newest task */
+} wsched_deque;
+
+typedef struct {
+  cc_wsched * sched;
+  cc_thread * thread;
+  unsigned long threadid;        /*! Read-only once the thread is started */
+  int index;
+} wsched_worker;
+
+struct cc_wsched {
+  int numworkers;
+  wsched_worker * workers;
+  wsched_deque * deques;         /*! One per worker, and one shared by
+                                   all other threads */
+  cc_mutex * sleepmutex;         /*! Protects the fields below */
+  cc_condvar * sleepcond;
+  int numsleeping;
+  int numstarted;
+  SbBool quit;
+};
+
+struct cc_wsched_group {
+  cc_wsched * sched;
+  cc_mutex * mutex;              /*! Protects pending */
+  cc_condvar * donecond;
+  int pending;                   /*! Tasks run, but not finished */
+};
+
+#endif /* HAVE_THREADS */
+
+/* ********************************************************************** */
+
+/* The scheduler shared by Coin's internal parallel loops. It is
+   constructed on first use, with one worker thread less than the
+   number of processors, since the calling thread also runs tasks. */
+cc_wsched * cc_wsched_global_instance(void);
+
+/* ********************************************************************** */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* ! CC_WSCHEDP_H */
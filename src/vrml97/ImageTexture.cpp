@@ -205,8 +205,6 @@
 #include <Inventor/misc/SoGLBigImage.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 #include <Inventor/sensors/SoOneShotSensor.h>
-#include <Inventor/sensors/SoTimerSensor.h>
-#include <Inventor/C/threads/sched.h>
 // FIXME: should be able to include file without
 // #ifdef-wrapper. 20051202 mortene.
 #ifdef HAVE_THREADS
@@ -217,6 +215,7 @@
 #include "nodes/SoSubNodeP.h"
 #include "glue/simage_wrapper.h"
 #include "elements/SoTextureScalePolicyElement.h"
+#include "misc/SoTextureLoader.h"
 
 // *************************************************************************
 
@@ -241,11 +240,6 @@ public:
   SoFieldSensor * urlsensor;
   SbBool allowprequalifycb;
 
-  SoTimerSensor * timersensor;
-  SbBool finishedloading;
-  static void timersensor_cb(void * data, SoSensor * sensor);
-
-  void readimage_cleanup(void);
   SbBool isdestructing;
 
   SbStringList searchdirs;
@@ -266,7 +260,6 @@ public:
   }
 
   static SbBool is_exiting;
-  static cc_sched * scheduler;
 
 #ifdef COIN_THREADSAFE
   static SbMutex * glimagemutex;
@@ -286,11 +279,6 @@ public:
     glimagemutex = NULL;
 #endif // COIN_THREADSAFE
 
-    if (scheduler) {
-      cc_sched_destruct(scheduler);
-      scheduler = NULL;
-    }
-
     imagetexture_delay_fetch = TRUE;
     imagetexture_prequalify_cb = NULL;
     imagetexture_prequalify_closure = NULL;
@@ -301,7 +289,6 @@ public:
 SbMutex * SoVRMLImageTextureP::glimagemutex = NULL;
 #endif // COIN_THREADSAFE
 
-cc_sched * SoVRMLImageTextureP::scheduler = NULL;
 SbBool SoVRMLImageTextureP::is_exiting = FALSE;
 
 // *************************************************************************
@@ -321,14 +308,6 @@ SoVRMLImageTexture::initClass(void) // static
   SoType type = SoVRMLImageTexture::getClassTypeId();
   SoRayPickAction::addMethod(type, SoNode::rayPickS);
 
-  // only use/create scheduler if COIN_THREADSAFE is defined, since we need
-  // the mutex below for this to be safely used
-#ifdef COIN_THREADSAFE
-  if (cc_thread_implementation() != CC_NO_THREADS) {
-    SoVRMLImageTextureP::scheduler = cc_sched_construct(1);
-  }
-#endif
-  
 #ifdef COIN_THREADSAFE
   SoVRMLImageTextureP::glimagemutex = new SbMutex;
 #endif // COIN_THREADSAFE
@@ -356,9 +335,6 @@ SoVRMLImageTexture::SoVRMLImageTexture(void)
   PRIVATE(this)->glimagevalid = false;
   PRIVATE(this)->readstatus = 1;
   PRIVATE(this)->allowprequalifycb = TRUE;
-  PRIVATE(this)->timersensor = 
-    new SoTimerSensor(SoVRMLImageTextureP::timersensor_cb, PRIVATE(this));
-  PRIVATE(this)->timersensor->setInterval(SbTime(0.5));
   
   // use field sensor for url since we will load an image if
   // filename changes. This is a time-consuming task which should
@@ -374,13 +350,10 @@ SoVRMLImageTexture::SoVRMLImageTexture(void)
 */
 SoVRMLImageTexture::~SoVRMLImageTexture()
 {
-  delete PRIVATE(this)->timersensor;
-
-  // just wait for all threads to finish reading
-  if (SoVRMLImageTextureP::scheduler) {
-    PRIVATE(this)->isdestructing = TRUE; // signal thread that we are destructing
-    cc_sched_wait_all(SoVRMLImageTextureP::scheduler);
-  }
+  // signal a prequalify callback running in a loader thread that we
+  // are destructing, and wait for it to finish
+  PRIVATE(this)->isdestructing = TRUE;
+  SoTextureLoader::cancel(this);
 
   if (PRIVATE(this)->glimage) PRIVATE(this)->glimage->unref(NULL);
   PRIVATE(this)->clearSearchDirs();
@@ -442,6 +415,11 @@ SoVRMLImageTexture::doAction(SoAction * action)
   int nc;
   SbVec2s size;
   const unsigned char * bytes = PRIVATE(this)->image.getValue(size, nc);
+  // only GLRender() can do with a placeholder while the file is read
+  if (SoTextureLoader::isLoading(this)) {
+    SoTextureLoader::finish(this);
+    bytes = PRIVATE(this)->image.getValue(size, nc);
+  }
   
   if (!PRIVATE(this)->image.hasData()) {
     if (this->url.getNum()) {
@@ -491,6 +469,11 @@ SoVRMLImageTexture::GLRender(SoGLRenderAction * action)
   
   float quality = SoTextureQualityElement::get(state);
 
+  // bring the image in view forward in the loader queue
+  if (SoTextureLoader::isLoading(this)) {
+    SoTextureLoader::setPriority(this, SoTextureLoader::getPriority(state));
+  }
+
   PRIVATE(this)->lock_glimage();
 
   SoTextureScalePolicyElement::Policy scalepolicy =
@@ -695,7 +678,7 @@ SoVRMLImageTexture::default_prequalify_cb(const SbString & url,  void * COIN_UNU
   return ret;
 }
 
-// needed to pass data to a new thread
+// needed to pass data to the sensor callback
 class imagetexture_thread_data {
 public:
   SoVRMLImageTexture * thisp;
@@ -703,24 +686,44 @@ public:
 };
 
 //
-// multithread loading thread.
+// called from a loader thread to run the prequalify callback
+//
+SbBool
+SoVRMLImageTexture::prequalify_read_cb(const SbString & filename,
+                                       SbImage * COIN_UNUSED_ARG(image),
+                                       void * closure)
+{
+  SoVRMLImageTexture * thisp = (SoVRMLImageTexture*) closure;
+  return thisp->readImage(filename);
+}
+
+//
+// called when the loader has read the image
 //
 void
-SoVRMLImageTexture::read_thread(void * closure)
+SoVRMLImageTexture::image_loaded_cb(void * closure, SbImage * const * images,
+                                    const int COIN_UNUSED_ARG(numimages))
 {
-  imagetexture_thread_data * data = (imagetexture_thread_data*) closure;
-  data->thisp->readImage(data->filename);
-  // we allocated this before staring the thread
-  delete data;
+  SoVRMLImageTexture * thisp = (SoVRMLImageTexture*) closure;
+  // the prequalify callback sets the image itself
+  if (images[0]->hasData()) {
+    PRIVATE(thisp)->image = *images[0];
+  }
+  PRIVATE(thisp)->lock_glimage();
+  PRIVATE(thisp)->glimagevalid = false;
+  PRIVATE(thisp)->unlock_glimage();
+  thisp->touch(); // trigger redraw
 }
 
 // callback for SoOneShotSensor which is used to read image when
-// Coin is compiled without the threads module.
+// the prequalify callback can't be called from another thread, or
+// when the texture loader has been disabled.
 void
 SoVRMLImageTexture::oneshot_readimage_cb(void * closure, SoSensor * sensor)
 {
   imagetexture_thread_data * data = (imagetexture_thread_data*) closure;
   data->thisp->readImage(data->filename);
+  data->thisp->touch(); // trigger redraw
   // delete both the sensor and the data
   delete sensor;
   delete data;
@@ -734,22 +737,28 @@ SoVRMLImageTexture::image_read_cb(const SbString & filename, SbImage * image, vo
 {
   SoVRMLImageTexture * thisp = (SoVRMLImageTexture*) closure;
   assert(&PRIVATE(thisp)->image == image);
-  
-  // start a timer sensor which polls the thread that loads images, to
-  // detect when it's done:
-  PRIVATE(thisp)->finishedloading = FALSE; // this will be TRUE when finished
-  PRIVATE(thisp)->timersensor->schedule();
-
-  imagetexture_thread_data * data = new imagetexture_thread_data;
-  data->thisp = thisp;
-  data->filename = filename;
-
-  if (SoVRMLImageTextureP::scheduler) {
-    // use a separate thread to load the image
-    cc_sched_schedule(SoVRMLImageTextureP::scheduler,
-                      read_thread, data, 0);
+
+  const SbBool prequalify =
+    PRIVATE(thisp)->allowprequalifycb && imagetexture_prequalify_cb;
+  // the prequalify callback sets the image data in the node, which is
+  // only safe to do from another thread when the node is threadsafe
+#ifdef COIN_THREADSAFE
+  const SbBool threadsafe = TRUE;
+#else // !COIN_THREADSAFE
+  const SbBool threadsafe = FALSE;
+#endif // !COIN_THREADSAFE
+
+  if (SoTextureLoader::isEnabled() && (!prequalify || threadsafe)) {
+    const SbStringList & sl = PRIVATE(thisp)->searchdirs;
+    SoTextureLoader::load(thisp, &filename, 1,
+                          sl.getArrayPtr(), sl.getLength(),
+                          image_loaded_cb, thisp, 0.0f,
+                          prequalify ? prequalify_read_cb : NULL, thisp);
   }
   else {
+    imagetexture_thread_data * data = new imagetexture_thread_data;
+    data->thisp = thisp;
+    data->filename = filename;
     // schedule a sensor to read the image as soon as the delay sensor
     // queue is processed (typically when the run-time system is idle)
     SoOneShotSensor * sensor = new SoOneShotSensor(oneshot_readimage_cb, data);
@@ -781,11 +790,8 @@ SoVRMLImageTexture::urlSensorCB(void * data, SoSensor *)
   }
   else { // empty image?
     if (thisp->url.getNum() == 0 || thisp->url[0].getLength() == 0) {
-      // wait for threads to finish in case a new thread is used to
-      // load the previous image, and the thread has not finished yet.
-      if (SoVRMLImageTextureP::scheduler) {
-        cc_sched_wait_all(SoVRMLImageTextureP::scheduler);
-      }
+      // forget about the previous image if it's still being loaded
+      SoTextureLoader::cancel(thisp);
 
       thisp->pimpl->image.setValue(SbVec2s(0,0), 0, NULL);
     }
@@ -808,9 +814,6 @@ SoVRMLImageTexture::readImage(const SbString & filename)
   PRIVATE(this)->lock_glimage();
   PRIVATE(this)->glimagevalid = false;
   PRIVATE(this)->unlock_glimage();
-
-  // set flag that timer sensor will test. 
-  PRIVATE(this)->finishedloading = TRUE;
   return retval;
 }
 
@@ -846,17 +849,118 @@ SoVRMLImageTexture::setImageDataMaxAge(const uint32_t maxage)
   imagedata_maxage = maxage;
 }
 
-void 
-SoVRMLImageTextureP::timersensor_cb(void * data, SoSensor * COIN_UNUSED_ARG(sensor))
+#undef PRIVATE
+
+#ifdef COIN_TEST_SUITE
+
+#include <cstdio>
+#include <Inventor/SbImage.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/C/tidbits.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/sensors/SoSensorManager.h>
+
+// The test images are small text files holding width, height and a
+// pixel value, decoded by a custom SbImage reader.
+static SbBool
+imagetexture_read_test_image(const SbString & filename, SbImage * image,
+                             void * /* closure */)
 {
-  SoVRMLImageTextureP * thisp = (SoVRMLImageTextureP*) data;
-  
-  if (thisp->finishedloading) {
-    thisp->master->touch(); // trigger redraw
-    thisp->timersensor->unschedule();
+  if (filename.find(".vrmltex") < 0) return FALSE;
+  FILE * fp = fopen(filename.getString(), "r");
+  if (!fp) return FALSE;
+  int w = 0, h = 0, value = 0;
+  const int num = fscanf(fp, "%d %d %d", &w, &h, &value);
+  fclose(fp);
+  if (num != 3) return FALSE;
+
+  SbList<unsigned char> bytes;
+  for (int i = 0; i < w * h; i++) bytes.append((unsigned char) value);
+  image->setValue(SbVec2s((short) w, (short) h), 1, bytes.getArrayPtr());
+  return TRUE;
+}
+
+static SbString
+imagetexture_write_test_image(const int idx, const int w, const int h,
+                              const int value)
+{
+  SbString name;
+  name.sprintf("imagetexture-%d.vrmltex", idx);
+  FILE * fp = fopen(name.getString(), "w");
+  fprintf(fp, "%d %d %d\n", w, h, value);
+  fclose(fp);
+  return name;
+}
+
+// processes the sensor queue until an image of size \a expected has
+// been delivered, or for at most \a seconds
+static SbBool
+imagetexture_wait_for_image(SoVRMLImageTexture * tex, const SbVec2s & expected,
+                            const double seconds)
+{
+  const SbTime start = SbTime::getTimeOfDay();
+  int nc;
+  SbVec2s size;
+  while ((SbTime::getTimeOfDay() - start).getValue() < seconds) {
+    SoDB::getSensorManager()->processTimerQueue();
+    SoDB::getSensorManager()->processDelayQueue(FALSE);
+    (void) tex->getImage()->getValue(size, nc);
+    if (size == expected) return TRUE;
   }
+  return FALSE;
 }
 
-#undef PRIVATE
+BOOST_AUTO_TEST_CASE(asyncImageFile)
+{
+  SbImage::addReadImageCB(imagetexture_read_test_image, NULL);
+  coin_setenv("COIN_ASYNC_TEXTURE_LOADING", "1", TRUE);
+  const SbString name = imagetexture_write_test_image(0, 4, 2, 0x42);
+  const SbString other = imagetexture_write_test_image(1, 8, 8, 0x10);
+
+  SoVRMLImageTexture * tex = new SoVRMLImageTexture;
+  tex->ref();
+  tex->url = name;
+
+  // the file is read when the image is first needed, and delivered
+  // from the sensor queue
+  int nc;
+  SbVec2s size;
+  const unsigned char * bytes = tex->getImage()->getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(0, 0), "image file read synchronously");
+
+  // other actions than SoGLRenderAction wait for the image
+  SoCallbackAction cba;
+  cba.apply(tex);
+  bytes = tex->getImage()->getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(4, 2) && nc == 1 && bytes && bytes[7] == 0x42,
+                      "SoCallbackAction did not wait for the image");
+
+  tex->url = other;
+  BOOST_CHECK_MESSAGE(imagetexture_wait_for_image(tex, SbVec2s(8, 8), 10.0),
+                      "image not delivered from the sensor queue");
+
+  // clearing the url cancels the pending load
+  tex->url = name;
+  (void) tex->getImage()->getValue(size, nc);
+  tex->url.setNum(0);
+  (void) imagetexture_wait_for_image(tex, SbVec2s(4, 2), 0.2);
+  cba.apply(tex);
+  (void) tex->getImage()->getValue(size, nc);
+  BOOST_CHECK_MESSAGE(size == SbVec2s(0, 0), "cancelled image was still delivered");
+
+  // deleting the node while loading
+  tex->url = other;
+  (void) tex->getImage()->getValue(size, nc);
+  tex->unref();
+  SoDB::getSensorManager()->processTimerQueue();
+
+  coin_unsetenv("COIN_ASYNC_TEXTURE_LOADING");
+  SbImage::removeReadImageCB(imagetexture_read_test_image, NULL);
+  remove(name.getString());
+  remove(other.getString());
+}
+
+#endif // COIN_TEST_SUITE
 
 #endif // HAVE_VRML97
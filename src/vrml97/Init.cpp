@@ -39,6 +39,8 @@
 #include <Inventor/VRMLnodes/SoVRML.h>
 #include <Inventor/VRMLnodes/SoVRMLNodes.h>
 
+#include "nodes/SoSubNodeP.h"
+
 void
 so_vrml_init(void)
 {
@@ -60,61 +62,61 @@ so_vrml_init(void)
   SoVRMLDragSensor::initClass();
 
   SoVRMLAnchor::initClass();
-  SoVRMLAppearance::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLAppearance, SoNode);
   SoVRMLAudioClip::initClass();
-  SoVRMLBackground::initClass();
-  SoVRMLBillboard::initClass();
-  SoVRMLBox::initClass();
-  SoVRMLCollision::initClass();
-  SoVRMLColor::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLBackground, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLBillboard, SoVRMLParent);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLBox, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLCollision, SoVRMLGroup);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLColor, SoNode);
   SoVRMLColorInterpolator::initClass();
-  SoVRMLCone::initClass();
-  SoVRMLCoordinate::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLCone, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLCoordinate, SoNode);
   SoVRMLCoordinateInterpolator::initClass();
-  SoVRMLCylinder::initClass();
-  SoVRMLCylinderSensor::initClass();
-  SoVRMLDirectionalLight::initClass();
-  SoVRMLElevationGrid::initClass();
-  SoVRMLExtrusion::initClass();
-  SoVRMLFog::initClass();
-  SoVRMLFontStyle::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLCylinder, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLCylinderSensor, SoVRMLDragSensor);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLDirectionalLight, SoVRMLLight);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLElevationGrid, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLExtrusion, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLFog, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLFontStyle, SoNode);
   SoVRMLImageTexture::initClass();
-  SoVRMLIndexedFaceSet::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLIndexedFaceSet, SoVRMLIndexedShape);
 
   SoVRMLVertexLine::initClass();
   SoVRMLIndexedLine::initClass();
-  SoVRMLIndexedLineSet::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLIndexedLineSet, SoVRMLIndexedLine);
   SoVRMLInline::initClass();
-  SoVRMLLOD::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLLOD, SoGroup);
   SoVRMLShape::initClass();
-  SoVRMLMaterial::initClass();
-  SoVRMLMovieTexture::initClass();
-  SoVRMLNavigationInfo::initClass();
-  SoVRMLNormal::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLMaterial, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLMovieTexture, SoVRMLTexture);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLNavigationInfo, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLNormal, SoNode);
   SoVRMLNormalInterpolator::initClass();
   SoVRMLOrientationInterpolator::initClass();
-  SoVRMLPixelTexture::initClass();
-  SoVRMLPlaneSensor::initClass();
-  SoVRMLPointLight::initClass();
-  SoVRMLPointSet::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLPixelTexture, SoVRMLTexture);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLPlaneSensor, SoVRMLDragSensor);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLPointLight, SoVRMLLight);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLPointSet, SoVRMLVertexPoint);
   SoVRMLPositionInterpolator::initClass();
-  SoVRMLProximitySensor::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLProximitySensor, SoNode);
   SoVRMLScalarInterpolator::initClass();
   SoVRMLScript::initClass();
   SoVRMLSound::initClass();
-  SoVRMLSphere::initClass();
-  SoVRMLSphereSensor::initClass();
-  SoVRMLSpotLight::initClass();
-  SoVRMLSwitch::initClass();
-  SoVRMLText::initClass();
-  SoVRMLTextureCoordinate::initClass();
-  SoVRMLTextureTransform::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLSphere, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLSphereSensor, SoVRMLDragSensor);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLSpotLight, SoVRMLLight);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLSwitch, SoGroup);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLText, SoVRMLGeometry);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLTextureCoordinate, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLTextureTransform, SoNode);
   SoVRMLTimeSensor::initClass();
-  SoVRMLTouchSensor::initClass();
-  SoVRMLTransform::initClass();
-  SoVRMLViewpoint::initClass();
-  SoVRMLVisibilitySensor::initClass();
-  SoVRMLWorldInfo::initClass();
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLTouchSensor, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLTransform, SoVRMLGroup);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLViewpoint, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLVisibilitySensor, SoNode);
+  SO_NODE_INTERNAL_DEFER_INIT_CLASS(SoVRMLWorldInfo, SoNode);
 }
 
 #endif // HAVE_VRML97
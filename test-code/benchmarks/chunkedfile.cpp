@@ -0,0 +1,137 @@
+/************************************************************************
+ *
+ * Measures reading a scene graph with large multi-field arrays from
+ * the chunked file format (see SoOutput::setCompression()), compared
+ * to plain binary and gzip compressed binary files, as when loading
+ * large CAD or simulation models.
+ *
+ * The scene graph has NUMPARTS parts, each with an SoCoordinate3
+ * node of NUMPOINTS points and an SoIndexedFaceSet with four indices
+ * per point. It is written to FILE in each format, and read back
+ * with SoDB::readAll(). For the chunked file, the arrays of large
+ * parts are not read until they are first accessed, so the time to
+ * access all of them is reported separately. Chunks are decompressed
+ * in parallel when the file is opened, by COIN_WSCHED_NUM_THREADS
+ * threads. Set COIN_CHUNKED_LAZY_SIZE to a large number to
+ * decompress all of them then. The file is removed afterwards.
+ *
+ * Usage: chunkedfile [NUMPARTS [NUMPOINTS [FILE]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+
+static void
+report(const char * what, const SbTime & t)
+{
+  (void)printf("  %-16s %9.2f ms\n", what, t.getValue() * 1000.0);
+}
+
+static double
+sum_values(SoSeparator * root)
+{
+  double sum = 0.0;
+  for (int i = 0; i < root->getNumChildren(); i++) {
+    SoSeparator * part = (SoSeparator *) root->getChild(i);
+    SoCoordinate3 * coords = (SoCoordinate3 *) part->getChild(0);
+    SoIndexedFaceSet * faceset = (SoIndexedFaceSet *) part->getChild(1);
+    const SbVec3f * points = coords->point.getValues(0);
+    const int32_t * indices = faceset->coordIndex.getValues(0);
+    sum += points[coords->point.getNum() - 1][0];
+    sum += indices[faceset->coordIndex.getNum() - 2];
+  }
+  return sum;
+}
+
+static void
+run(SoSeparator * root, const char * filename, const char * method)
+{
+  (void)printf("%s\n", method);
+
+  SoOutput out;
+  if (strcmp(method, "binary") != 0) (void)out.setCompression(method, 0.3f);
+  if (!out.openFile(filename)) return;
+  out.setBinary(TRUE);
+  SbTime t = SbTime::getTimeOfDay();
+  SoWriteAction wa(&out);
+  wa.apply(root);
+  out.closeFile();
+  report("write", SbTime::getTimeOfDay() - t);
+
+  struct stat st;
+  if (stat(filename, &st) == 0) {
+    (void)printf("  %-16s %9.1f MB\n", "file size", st.st_size / 1048576.0);
+  }
+
+  SoInput in;
+  if (!in.openFile(filename)) return;
+  t = SbTime::getTimeOfDay();
+  SoSeparator * read = SoDB::readAll(&in);
+  in.closeFile();
+  report("read", SbTime::getTimeOfDay() - t);
+  if (!read) return;
+  read->ref();
+
+  t = SbTime::getTimeOfDay();
+  const double sum = sum_values(read);
+  report("first access", SbTime::getTimeOfDay() - t);
+  if (sum != sum_values(root)) (void)printf("ERROR: values differ\n");
+  read->unref();
+}
+
+int
+main(int argc, char ** argv)
+{
+  const int numparts = argc > 1 ? atoi(argv[1]) : 100;
+  const int numpoints = argc > 2 ? atoi(argv[2]) : 100000;
+  const char * filename = argc > 3 ? argv[3] : "chunkedfile-benchmark.iv";
+
+  SoDB::init();
+
+  (void)printf("%d parts with %d points\n", numparts, numpoints);
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < numparts; i++) {
+    SoSeparator * part = new SoSeparator;
+    SoCoordinate3 * coords = new SoCoordinate3;
+    coords->point.setNum(numpoints);
+    SbVec3f * points = coords->point.startEditing();
+    for (int j = 0; j < numpoints; j++) {
+      points[j].setValue(float(j % 1000), float(j / 1000), float(i));
+    }
+    coords->point.finishEditing();
+    SoIndexedFaceSet * faceset = new SoIndexedFaceSet;
+    faceset->coordIndex.setNum(numpoints * 4);
+    int32_t * indices = faceset->coordIndex.startEditing();
+    for (int j = 0; j < numpoints; j++) {
+      indices[j * 4 + 0] = j;
+      indices[j * 4 + 1] = (j + 1) % numpoints;
+      indices[j * 4 + 2] = (j + 1000) % numpoints;
+      indices[j * 4 + 3] = -1;
+    }
+    faceset->coordIndex.finishEditing();
+    part->addChild(coords);
+    part->addChild(faceset);
+    root->addChild(part);
+  }
+
+  run(root, filename, "binary");
+  run(root, filename, "GZIP");
+  run(root, filename, "CHUNKED");
+
+  (void)remove(filename);
+  root->unref();
+  return 0;
+}
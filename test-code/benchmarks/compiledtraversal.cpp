@@ -0,0 +1,165 @@
+/************************************************************************
+ *
+ * Measures repeated SoCallbackAction traversals of a static scene
+ * graph with a triangle callback, as when an application extracts the
+ * triangles of the scene for collision detection every frame.
+ *
+ * The scene graph has NUMPARTS parts, each an SoSeparator with a
+ * transform, a material, and an SoIndexedFaceSet grid of NUMQUADS
+ * quads, or an SoSphere for every fourth part. The action is applied
+ * NUMPASSES times, first as normal and then with
+ * SoCallbackAction::setCompiledTraversal() enabled. With compiled
+ * traversal, the first pass records the shapes and primitives below
+ * every separator, and the following passes replay them. Finally, a
+ * single part is changed between passes, so that only its separator
+ * and the root record their lists again.
+ *
+ * The triangle count and the sum of the world space vertices are
+ * printed for each mode, and should be the same.
+ *
+ * Usage: compiledtraversal [NUMPASSES [NUMPARTS [NUMQUADS]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoSphere.h>
+
+struct Sums {
+  int numtriangles;
+  double sum;
+};
+
+static void
+triangle_cb(void * userdata, SoCallbackAction * action,
+            const SoPrimitiveVertex * v1,
+            const SoPrimitiveVertex * v2,
+            const SoPrimitiveVertex * v3)
+{
+  Sums * sums = (Sums *) userdata;
+  const SbMatrix & m = action->getModelMatrix();
+  const SoPrimitiveVertex * v[3] = { v1, v2, v3 };
+  for (int i = 0; i < 3; i++) {
+    SbVec3f p;
+    m.multVecMatrix(v[i]->getPoint(), p);
+    sums->sum += p[0] + p[1] + p[2];
+  }
+  sums->numtriangles++;
+}
+
+static SoSeparator *
+make_part(int idx, int numquads)
+{
+  SoSeparator * part = new SoSeparator;
+  SoTransform * transform = new SoTransform;
+  transform->translation.setValue(float(idx % 32) * 2.0f, float(idx / 32) * 2.0f, 0.0f);
+  part->addChild(transform);
+  SoMaterial * material = new SoMaterial;
+  material->diffuseColor.setValue(float(idx % 7) / 7.0f, 0.5f, 0.5f);
+  part->addChild(material);
+
+  if (idx % 4 == 3) {
+    part->addChild(new SoSphere);
+    return part;
+  }
+
+  const int side = (int) sqrt((double) numquads) + 1;
+  SoCoordinate3 * coords = new SoCoordinate3;
+  coords->point.setNum(side * side);
+  SbVec3f * points = coords->point.startEditing();
+  for (int y = 0; y < side; y++) {
+    for (int x = 0; x < side; x++) {
+      points[y * side + x].setValue(float(x) / side, float(y) / side, 0.0f);
+    }
+  }
+  coords->point.finishEditing();
+  part->addChild(coords);
+
+  SoIndexedFaceSet * faceset = new SoIndexedFaceSet;
+  faceset->coordIndex.setNum((side - 1) * (side - 1) * 5);
+  int32_t * indices = faceset->coordIndex.startEditing();
+  for (int y = 0; y < side - 1; y++) {
+    for (int x = 0; x < side - 1; x++) {
+      *indices++ = y * side + x;
+      *indices++ = y * side + x + 1;
+      *indices++ = (y + 1) * side + x + 1;
+      *indices++ = (y + 1) * side + x;
+      *indices++ = -1;
+    }
+  }
+  faceset->coordIndex.finishEditing();
+  part->addChild(faceset);
+  return part;
+}
+
+static void
+run(SoSeparator * root, int numpasses, SbBool compiled)
+{
+  SoCallbackAction action;
+  action.setCompiledTraversal(compiled);
+  Sums sums;
+  action.addTriangleCallback(SoShape::getClassTypeId(), triangle_cb, &sums);
+
+  SbTime first, rest(0.0), changed(0.0);
+  for (int i = 0; i < numpasses; i++) {
+    sums.numtriangles = 0;
+    sums.sum = 0.0;
+    SbTime t = SbTime::getTimeOfDay();
+    action.apply(root);
+    t = SbTime::getTimeOfDay() - t;
+    if (i == 0) first = t;
+    else rest += t;
+  }
+  const int numchanged = numpasses > 1 ? numpasses - 1 : 1;
+  for (int i = 0; i < numchanged; i++) {
+    SoSeparator * part = (SoSeparator *) root->getChild(0);
+    SoMaterial * material = (SoMaterial *) part->getChild(1);
+    material->shininess.setValue(float(i % 2) * 0.5f);
+    sums.numtriangles = 0;
+    sums.sum = 0.0;
+    SbTime t = SbTime::getTimeOfDay();
+    action.apply(root);
+    changed += SbTime::getTimeOfDay() - t;
+  }
+
+  (void)printf("%-8s first %8.2f ms, unchanged %8.2f ms, one part changed "
+               "%8.2f ms (%d triangles, sum %.1f)\n",
+               compiled ? "compiled" : "normal",
+               first.getValue() * 1000.0,
+               numpasses > 1 ? rest.getValue() * 1000.0 / (numpasses - 1) : 0.0,
+               changed.getValue() * 1000.0 / numchanged,
+               sums.numtriangles, sums.sum);
+}
+
+int
+main(int argc, char ** argv)
+{
+  const int numpasses = argc > 1 ? atoi(argv[1]) : 10;
+  const int numparts = argc > 2 ? atoi(argv[2]) : 1000;
+  const int numquads = argc > 3 ? atoi(argv[3]) : 400;
+
+  SoDB::init();
+
+  (void)printf("%d passes, %d parts, %d quads per part\n",
+               numpasses, numparts, numquads);
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < numparts; i++) root->addChild(make_part(i, numquads));
+
+  run(root, numpasses, FALSE);
+  run(root, numpasses, TRUE);
+
+  root->unref();
+  return 0;
+}
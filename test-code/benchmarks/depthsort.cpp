@@ -0,0 +1,188 @@
+/************************************************************************
+ *
+ * Measures the per-frame cost of SoPrimitiveVertexCache::depthSortTriangles()
+ * while the camera orbits slowly around a random triangle soup, and
+ * compares it with the full shell sort which was used before the
+ * sort became incremental.
+ *
+ * Usage: depthsort [NUMTRIANGLES [NUMFRAMES [DEGREESPERFRAME]]]
+ *
+ * Run with COIN_INCREMENTAL_DEPTHSORT=0 to measure the (radix) full
+ * sort in the cache instead of the incremental one.
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SbPlane.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoSubAction.h>
+#include <Inventor/caches/SoPrimitiveVertexCache.h>
+#include <Inventor/elements/SoBumpMapCoordinateElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoMultiTextureEnabledElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/lists/SbList.h>
+#include <Inventor/nodes/SoCallback.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+// SoCallbackAction doesn't enable all the elements needed to build
+// an SoPrimitiveVertexCache.
+class DepthSortAction : public SoCallbackAction {
+  SO_ACTION_HEADER(DepthSortAction);
+public:
+  static void initClass(void) {
+    SO_ACTION_INIT_CLASS(DepthSortAction, SoCallbackAction);
+    SO_ENABLE(DepthSortAction, SoBumpMapCoordinateElement);
+    SO_ENABLE(DepthSortAction, SoMultiTextureEnabledElement);
+  }
+  DepthSortAction(void) { SO_ACTION_CONSTRUCTOR(DepthSortAction); }
+};
+
+SO_ACTION_SOURCE(DepthSortAction);
+
+static int numtriangles = 100000;
+static SoPrimitiveVertexCache * cache = NULL;
+static SbTime cachetime(0.0);
+
+// the triangle sort as it was done before, on a copy of the indices
+static SbList <SbVec3f> legacyvertices;
+static SbList <int> legacyindices;
+static float * legacydepths = NULL;
+static SbTime legacytime(0.0);
+
+static float
+rnd(void)
+{
+  return float(rand()) / float(RAND_MAX) * 10.0f - 5.0f;
+}
+
+static void
+legacy_sort(const SbPlane & sortplane)
+{
+  const int numtri = legacyindices.getLength() / 3;
+  const SbVec3f * vptr = legacyvertices.getArrayPtr();
+  int * iptr = const_cast<int *>(legacyindices.getArrayPtr());
+  float * darray = legacydepths;
+  int i, j;
+  for (i = 0; i < numtri; i++) {
+    float acc = 0.0;
+    for (j = 0; j < 3; j++) {
+      acc += sortplane.getDistance(vptr[iptr[i*3+j]]);
+    }
+    darray[i] = acc / 3.0f;
+  }
+  int distance;
+  float dtmp;
+  int itmp[3];
+  for (distance = 1; distance <= numtri/9; distance = 3*distance + 1) ;
+  for (; distance > 0; distance /= 3) {
+    for (i = distance; i < numtri; i++) {
+      dtmp = darray[i];
+      itmp[0] = iptr[i*3];
+      itmp[1] = iptr[i*3+1];
+      itmp[2] = iptr[i*3+2];
+      j = i;
+      while (j >= distance && darray[j-distance] > dtmp) {
+        darray[j] = darray[j-distance];
+        iptr[j*3] = iptr[(j-distance)*3];
+        iptr[j*3+1] = iptr[(j-distance)*3+1];
+        iptr[j*3+2] = iptr[(j-distance)*3+2];
+        j -= distance;
+      }
+      darray[j] = dtmp;
+      iptr[j*3] = itmp[0];
+      iptr[j*3+1] = itmp[1];
+      iptr[j*3+2] = itmp[2];
+    }
+  }
+}
+
+static void
+callback(void * closure, SoAction * action)
+{
+  if (!action->isOfType(DepthSortAction::getClassTypeId())) return;
+  SoState * state = action->getState();
+
+  if (cache == NULL) {
+    cache = new SoPrimitiveVertexCache(state);
+    cache->ref();
+    SoPrimitiveVertex pv[3];
+    for (int i = 0; i < numtriangles; i++) {
+      SbVec3f center(rnd(), rnd(), rnd());
+      for (int j = 0; j < 3; j++) {
+        SbVec3f p = center + SbVec3f(rnd(), rnd(), rnd()) * 0.02f;
+        pv[j].setPoint(p);
+        pv[j].setNormal(SbVec3f(0.0f, 0.0f, 1.0f));
+        legacyvertices.append(p);
+        legacyindices.append(i*3+j);
+      }
+      cache->addTriangle(&pv[0], &pv[1], &pv[2]);
+    }
+    cache->close(state);
+    legacydepths = new float[numtriangles];
+  }
+
+  SbTime t = SbTime::getTimeOfDay();
+  cache->depthSortTriangles(state);
+  cachetime += SbTime::getTimeOfDay() - t;
+
+  SbPlane sortplane = SoViewVolumeElement::get(state).getPlane(0.0);
+  sortplane.transform(SoModelMatrixElement::get(state).inverse());
+  t = SbTime::getTimeOfDay();
+  legacy_sort(sortplane);
+  legacytime += SbTime::getTimeOfDay() - t;
+}
+
+int
+main(int argc, char ** argv)
+{
+  int numframes = 360;
+  float degrees = 0.5f;
+  if (argc > 1) numtriangles = atoi(argv[1]);
+  if (argc > 2) numframes = atoi(argv[2]);
+  if (argc > 3) degrees = float(atof(argv[3]));
+
+  SoDB::init();
+  DepthSortAction::initClass();
+  srand(19720408);
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoPerspectiveCamera * camera = new SoPerspectiveCamera;
+  root->addChild(camera);
+  SoCallback * cb = new SoCallback;
+  cb->setCallback(callback, NULL);
+  root->addChild(cb);
+
+  DepthSortAction action;
+  SbRotation step(SbVec3f(0.0f, 1.0f, 0.0f), degrees * float(M_PI) / 180.0f);
+  SbRotation orientation = SbRotation::identity();
+  for (int frame = 0; frame < numframes; frame++) {
+    SbVec3f dir;
+    orientation.multVec(SbVec3f(0.0f, 0.0f, 20.0f), dir);
+    camera->position = dir;
+    camera->orientation = orientation;
+    action.apply(root);
+    // don't count the initial sort
+    if (frame == 0) cachetime = legacytime = SbTime(0.0);
+    orientation *= step;
+  }
+
+  const int counted = numframes > 1 ? numframes - 1 : 1;
+  (void)fprintf(stdout, "%d triangles, %d frames, %.2f degrees per frame\n",
+                numtriangles, numframes, degrees);
+  (void)fprintf(stdout, "  full shell sort:     %8.3f ms/frame\n",
+                legacytime.getValue() * 1000.0 / counted);
+  (void)fprintf(stdout, "  depthSortTriangles:  %8.3f ms/frame\n",
+                cachetime.getValue() * 1000.0 / counted);
+
+  cache->unref();
+  delete[] legacydepths;
+  root->unref();
+  return 0;
+}
@@ -0,0 +1,119 @@
+/************************************************************************
+ *
+ * Measures binding a large file of vertex data to a scene graph, as
+ * when rendering the results of a simulation which are written to
+ * disk as raw arrays.
+ *
+ * A file with NUMPOINTS SbVec3f points is written to FILE, and then
+ * used as the points of an SoCoordinate3 node in two ways:
+ *   - copy: the file is read into memory and copied into the field
+ *     with setValues(), like SoInput does.
+ *   - map:  the file is mapped with SbExternalBuffer::mapFile() and
+ *     bound to the field with setValuesBuffer().
+ * For each, the node is copied NUMCOPIES times, and the bounding box
+ * of the points is computed with SoGetBoundingBoxAction. The file is
+ * removed afterwards.
+ *
+ * Usage: externalbuffer [NUMPOINTS [NUMCOPIES [FILE]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SbExternalBuffer.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoPointSet.h>
+
+static void
+report(const char * what, const SbTime & t)
+{
+  (void)printf("%-16s %9.2f ms\n", what, t.getValue() * 1000.0);
+}
+
+static void
+run(SoCoordinate3 * coords, int numcopies)
+{
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  root->addChild(coords);
+  root->addChild(new SoPointSet);
+
+  SbTime t = SbTime::getTimeOfDay();
+  SoNode ** copies = new SoNode*[numcopies];
+  for (int i = 0; i < numcopies; i++) {
+    copies[i] = root->copy();
+    copies[i]->ref();
+  }
+  report("  copies", SbTime::getTimeOfDay() - t);
+
+  t = SbTime::getTimeOfDay();
+  SoGetBoundingBoxAction action(SbViewportRegion(100, 100));
+  action.apply(root);
+  report("  bounding box", SbTime::getTimeOfDay() - t);
+
+  size_t managed, unmanaged;
+  coords->getFieldsMemorySize(managed, unmanaged);
+  (void)printf("  %.1f MB managed, %.1f MB unmanaged\n",
+               managed / 1048576.0, unmanaged / 1048576.0);
+
+  for (int i = 0; i < numcopies; i++) copies[i]->unref();
+  delete[] copies;
+  root->unref();
+}
+
+int
+main(int argc, char ** argv)
+{
+  const int numpoints = argc > 1 ? atoi(argv[1]) : 5000000;
+  const int numcopies = argc > 2 ? atoi(argv[2]) : 10;
+  const char * filename = argc > 3 ? argv[3] : "externalbuffer-benchmark.bin";
+
+  SoDB::init();
+
+  (void)printf("%d points, %d copies\n", numpoints, numcopies);
+
+  FILE * fp = fopen(filename, "wb");
+  if (!fp) {
+    (void)fprintf(stderr, "could not open %s for writing\n", filename);
+    return 1;
+  }
+  SbVec3f * points = new SbVec3f[numpoints];
+  for (int i = 0; i < numpoints; i++) {
+    points[i].setValue(float(i % 1000), float((i / 1000) % 1000), float(i / 1000000));
+  }
+  (void)fwrite(points, sizeof(SbVec3f), numpoints, fp);
+  (void)fclose(fp);
+  delete[] points;
+
+  (void)printf("copy\n");
+  SbTime t = SbTime::getTimeOfDay();
+  fp = fopen(filename, "rb");
+  points = new SbVec3f[numpoints];
+  (void)fread(points, sizeof(SbVec3f), numpoints, fp);
+  (void)fclose(fp);
+  SoCoordinate3 * coords = new SoCoordinate3;
+  coords->ref();
+  coords->point.setValues(0, numpoints, points);
+  delete[] points;
+  report("  bind", SbTime::getTimeOfDay() - t);
+  run(coords, numcopies);
+  coords->unref();
+
+  (void)printf("map\n");
+  t = SbTime::getTimeOfDay();
+  SbExternalBuffer * buffer = SbExternalBuffer::mapFile(filename);
+  if (!buffer) return 1;
+  coords = new SoCoordinate3;
+  coords->ref();
+  coords->point.setValuesBuffer(numpoints, buffer);
+  report("  bind", SbTime::getTimeOfDay() - t);
+  run(coords, numcopies);
+  coords->unref();
+
+  (void)remove(filename);
+  return 0;
+}
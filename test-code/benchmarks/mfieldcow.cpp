@@ -0,0 +1,126 @@
+/************************************************************************
+ *
+ * Measures copying of a scene graph with large multi-field arrays, as
+ * when an application duplicates an assembly or keeps a copy of the
+ * scene graph for undo.
+ *
+ * The scene graph has NUMPARTS parts, each with an SoCoordinate3
+ * node of NUMPOINTS points and an SoIndexedFaceSet with four indices
+ * per point. Three things are timed:
+ *   - copying the scene graph NUMCOPIES times. Multi-field arrays are
+ *     shared with the original instead of copied, so this should
+ *     allocate little memory.
+ *   - changing one point in every part of every copy, which copies
+ *     the coordinate arrays of the copies, but not the index arrays.
+ *   - destroying the copies.
+ *
+ * The number of bytes shared is reported from
+ * SoFieldContainer::getFieldsSharedMemorySize(), which is what the
+ * profiler shows as SbProfilingData::SHARED_MEMORY_SIZE.
+ *
+ * Usage: mfieldcow [NUMCOPIES [NUMPARTS [NUMPOINTS]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+
+static void
+report(const char * what, const SbTime & t)
+{
+  (void)printf("%-8s %9.2f ms\n", what, t.getValue() * 1000.0);
+}
+
+static size_t
+shared_size(SoSeparator * root, size_t & managed)
+{
+  size_t shared = 0;
+  managed = 0;
+  for (int i = 0; i < root->getNumChildren(); i++) {
+    SoSeparator * part = (SoSeparator *) root->getChild(i);
+    for (int j = 0; j < part->getNumChildren(); j++) {
+      size_t m, u;
+      part->getChild(j)->getFieldsMemorySize(m, u);
+      managed += m;
+      shared += part->getChild(j)->getFieldsSharedMemorySize();
+    }
+  }
+  return shared;
+}
+
+int
+main(int argc, char ** argv)
+{
+  const int numcopies = argc > 1 ? atoi(argv[1]) : 20;
+  const int numparts = argc > 2 ? atoi(argv[2]) : 100;
+  const int numpoints = argc > 3 ? atoi(argv[3]) : 10000;
+
+  SoDB::init();
+
+  (void)printf("%d copies of %d parts with %d points\n",
+               numcopies, numparts, numpoints);
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < numparts; i++) {
+    SoSeparator * part = new SoSeparator;
+    SoCoordinate3 * coords = new SoCoordinate3;
+    coords->point.setNum(numpoints);
+    SbVec3f * points = coords->point.startEditing();
+    for (int j = 0; j < numpoints; j++) points[j].setValue(float(j), float(i), 0.0f);
+    coords->point.finishEditing();
+    SoIndexedFaceSet * faceset = new SoIndexedFaceSet;
+    faceset->coordIndex.setNum(numpoints * 4);
+    int32_t * indices = faceset->coordIndex.startEditing();
+    for (int j = 0; j < numpoints; j++) {
+      indices[j * 4 + 0] = j;
+      indices[j * 4 + 1] = (j + 1) % numpoints;
+      indices[j * 4 + 2] = (j + 2) % numpoints;
+      indices[j * 4 + 3] = -1;
+    }
+    faceset->coordIndex.finishEditing();
+    part->addChild(coords);
+    part->addChild(faceset);
+    root->addChild(part);
+  }
+
+  SoSeparator ** copies = new SoSeparator*[numcopies];
+  SbTime t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numcopies; i++) {
+    copies[i] = (SoSeparator *) root->copy();
+    copies[i]->ref();
+  }
+  report("copy", SbTime::getTimeOfDay() - t);
+
+  size_t managed;
+  size_t shared = shared_size(copies[0], managed);
+  (void)printf("per copy: %.1f MB in field arrays, %.1f MB of it shared\n",
+               managed / 1048576.0, shared / 1048576.0);
+
+  t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numcopies; i++) {
+    for (int j = 0; j < numparts; j++) {
+      SoSeparator * part = (SoSeparator *) copies[i]->getChild(j);
+      SoCoordinate3 * coords = (SoCoordinate3 *) part->getChild(0);
+      coords->point.set1Value(0, SbVec3f(-1.0f, -1.0f, -1.0f));
+    }
+  }
+  report("write", SbTime::getTimeOfDay() - t);
+
+  shared = shared_size(copies[0], managed);
+  (void)printf("per copy: %.1f MB in field arrays, %.1f MB of it shared\n",
+               managed / 1048576.0, shared / 1048576.0);
+
+  t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numcopies; i++) copies[i]->unref();
+  report("destroy", SbTime::getTimeOfDay() - t);
+
+  delete[] copies;
+  root->unref();
+  return 0;
+}
@@ -0,0 +1,150 @@
+/************************************************************************
+ *
+ * Measures the SbName string table (src/base/namemap.cpp) with a large
+ * number of unique names, as in files exported from CAD systems where
+ * every node has its own DEF name.
+ *
+ * Three things are timed:
+ *   - interning NUMNAMES new names like "Pipe_0000001", and looking
+ *     them all up again
+ *   - the same from NUMTHREADS threads at once, each with its own
+ *     names, followed by all threads looking up all names
+ *   - reading a generated file with NUMNAMES DEF'ed nodes. The file
+ *     is written to FILE, and removed afterwards.
+ *
+ * The name table is process global, so the file uses a different
+ * prefix than the interning runs to make sure its names are new.
+ *
+ * Usage: namemap [NUMNAMES [NUMTHREADS [FILE]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SbName.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/C/threads/thread.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+static int numnames = 5000000;
+static int numthreads = 4;
+
+struct ThreadData {
+  const char * prefix;
+  int begin, end;
+  int mismatches;
+};
+
+static void *
+intern_names(void * closure)
+{
+  ThreadData * data = (ThreadData *) closure;
+  char buf[64];
+  for (int i = data->begin; i < data->end; i++) {
+    (void)sprintf(buf, "%s_%07d", data->prefix, i);
+    (void)SbName(buf);
+  }
+  return NULL;
+}
+
+static void *
+lookup_names(void * closure)
+{
+  ThreadData * data = (ThreadData *) closure;
+  char buf[64];
+  for (int i = data->begin; i < data->end; i++) {
+    (void)sprintf(buf, "%s_%07d", data->prefix, i);
+    if (SbName(buf) != buf) data->mismatches++;
+  }
+  return NULL;
+}
+
+static SbTime
+run_threads(cc_thread_f * func, const char * prefix, SbBool allnames)
+{
+  cc_thread ** threads = new cc_thread*[numthreads];
+  ThreadData * data = new ThreadData[numthreads];
+  SbTime t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numthreads; i++) {
+    data[i].prefix = prefix;
+    data[i].begin = allnames ? 0 : (numnames / numthreads) * i;
+    data[i].end = allnames ? numnames :
+      ((i == numthreads - 1) ? numnames : (numnames / numthreads) * (i + 1));
+    data[i].mismatches = 0;
+    threads[i] = cc_thread_construct(func, &data[i]);
+  }
+  int mismatches = 0;
+  for (int i = 0; i < numthreads; i++) {
+    (void)cc_thread_join(threads[i], NULL);
+    cc_thread_destruct(threads[i]);
+    mismatches += data[i].mismatches;
+  }
+  t = SbTime::getTimeOfDay() - t;
+  if (mismatches) (void)printf("ERROR: %d mismatched names\n", mismatches);
+  delete[] data;
+  delete[] threads;
+  return t;
+}
+
+static void
+report(const char * what, const SbTime & t, double numops)
+{
+  (void)printf("%-24s %9.1f ms, %6.1f ns/name\n", what,
+               t.getValue() * 1000.0, t.getValue() * 1.0e9 / numops);
+}
+
+int
+main(int argc, char ** argv)
+{
+  if (argc > 1) numnames = atoi(argv[1]);
+  if (argc > 2) numthreads = atoi(argv[2]);
+  const char * filename = argc > 3 ? argv[3] : "namemap-benchmark.iv";
+  if (numthreads < 1) numthreads = 1;
+
+  SoDB::init();
+
+  (void)printf("%d names, %d threads\n", numnames, numthreads);
+
+  ThreadData single = { "Pipe", 0, numnames, 0 };
+  SbTime t = SbTime::getTimeOfDay();
+  (void)intern_names(&single);
+  report("intern, 1 thread", SbTime::getTimeOfDay() - t, numnames);
+  t = SbTime::getTimeOfDay();
+  (void)lookup_names(&single);
+  report("lookup, 1 thread", SbTime::getTimeOfDay() - t, numnames);
+  if (single.mismatches) (void)printf("ERROR: %d mismatched names\n", single.mismatches);
+
+  t = run_threads(intern_names, "Valve", FALSE);
+  report("intern, all threads", t, numnames);
+  t = run_threads(lookup_names, "Valve", TRUE);
+  report("lookup, all threads", t, double(numnames) * numthreads);
+
+  FILE * fp = fopen(filename, "w");
+  if (!fp) {
+    (void)fprintf(stderr, "could not open %s for writing\n", filename);
+    return 1;
+  }
+  (void)fprintf(fp, "#Inventor V2.1 ascii\n\nSeparator {\n");
+  for (int i = 0; i < numnames; i++) {
+    (void)fprintf(fp, "  DEF Flange_%07d Group { }\n", i);
+  }
+  (void)fprintf(fp, "}\n");
+  (void)fclose(fp);
+
+  SoInput in;
+  if (!in.openFile(filename)) return 1;
+  t = SbTime::getTimeOfDay();
+  SoSeparator * root = SoDB::readAll(&in);
+  report("read file", SbTime::getTimeOfDay() - t, numnames);
+  in.closeFile();
+  (void)remove(filename);
+
+  if (root) {
+    root->ref();
+    (void)printf("read %d nodes\n", root->getNumChildren());
+    root->unref();
+  }
+  return 0;
+}
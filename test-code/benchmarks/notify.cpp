@@ -0,0 +1,108 @@
+/************************************************************************
+ *
+ * Measures notification throughput, i.e. how fast a field change
+ * propagates through the auditors of the nodes above it, and the
+ * cost of adding and removing auditors.
+ *
+ * Three cases are timed:
+ *   - chain:  a field change in a node at the bottom of a chain of
+ *             DEPTH groups, with a node sensor on the top group. Every
+ *             node has a single auditor (its parent, or the sensor).
+ *   - fan-in: a field change in a node which is a child of FANIN
+ *             groups, so that its auditors do not fit inline in
+ *             SoBase.
+ *   - churn:  adding and removing a node to and from FANIN groups.
+ *
+ * Usage: notify [NUMCHANGES [DEPTH [FANIN]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTranslation.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+static void
+report(const char * what, const SbTime & t, int num)
+{
+  (void)printf("%-8s %8.2f ms, %8.1f ns/op\n", what,
+               t.getValue() * 1000.0, t.getValue() * 1.0e9 / num);
+}
+
+int
+main(int argc, char ** argv)
+{
+  const int numchanges = argc > 1 ? atoi(argv[1]) : 200000;
+  const int depth = argc > 2 ? atoi(argv[2]) : 20;
+  const int fanin = argc > 3 ? atoi(argv[3]) : 16;
+
+  SoDB::init();
+
+  (void)printf("%d changes, depth %d, fan-in %d\n", numchanges, depth, fanin);
+
+  // chain
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  SoGroup * group = root;
+  for (int i = 0; i < depth; i++) {
+    SoGroup * child = new SoGroup;
+    group->addChild(child);
+    group = child;
+  }
+  SoTranslation * translation = new SoTranslation;
+  group->addChild(translation);
+  SoNodeSensor * sensor = new SoNodeSensor;
+  sensor->attach(root);
+
+  SbTime t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numchanges; i++) {
+    translation->translation.setValue(float(i), 0.0f, 0.0f);
+  }
+  report("chain", SbTime::getTimeOfDay() - t, numchanges);
+
+  sensor->detach();
+  root->unref();
+
+  // fan-in
+  root = new SoSeparator;
+  root->ref();
+  translation = new SoTranslation;
+  for (int i = 0; i < fanin; i++) {
+    SoGroup * parent = new SoGroup;
+    parent->addChild(translation);
+    root->addChild(parent);
+  }
+  sensor->attach(root);
+
+  t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numchanges; i++) {
+    translation->translation.setValue(float(i), 0.0f, 0.0f);
+  }
+  report("fan-in", SbTime::getTimeOfDay() - t, numchanges);
+
+  sensor->detach();
+
+  // churn
+  const int numrounds = numchanges / fanin + 1;
+  SoTranslation * shared = new SoTranslation;
+  shared->ref();
+  t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numrounds; i++) {
+    for (int j = 0; j < fanin; j++) {
+      ((SoGroup *)root->getChild(j))->addChild(shared);
+    }
+    for (int j = 0; j < fanin; j++) {
+      ((SoGroup *)root->getChild(j))->removeChild(1);
+    }
+  }
+  report("churn", SbTime::getTimeOfDay() - t, numrounds * fanin);
+
+  shared->unref();
+  root->unref();
+  delete sensor;
+  return 0;
+}
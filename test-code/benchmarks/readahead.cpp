@@ -0,0 +1,115 @@
+/************************************************************************
+ *
+ * Measures reading large plain and gzip compressed ASCII files, as
+ * when loading big .iv.gz or .wrz models, with and without reading
+ * ahead on a separate thread.
+ *
+ * Large files are read, and decompressed, into a ring of buffers on
+ * a separate thread while the previous buffers are parsed (see the
+ * COIN_SOINPUT_READ_AHEAD environment variable). The scene graph
+ * has NUMPARTS parts, each with an SoCoordinate3 node of NUMPOINTS
+ * points, and is written to FILE with and without compression. Each
+ * file is read NUMRUNS times with SoDB::readAll() in each mode, in
+ * a separate process for each mode. The files are removed
+ * afterwards.
+ *
+ * Usage: readahead [NUMRUNS [NUMPARTS [NUMPOINTS [FILE]]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/SbString.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+
+static int
+run_child(const char * filename, int numruns)
+{
+  SoDB::init();
+  SbTime total(0.0);
+  for (int i = 0; i < numruns; i++) {
+    SoInput in;
+    if (!in.openFile(filename)) return 1;
+    SbTime t = SbTime::getTimeOfDay();
+    SoSeparator * root = SoDB::readAll(&in);
+    in.closeFile();
+    total += SbTime::getTimeOfDay() - t;
+    if (!root) return 1;
+    root->ref();
+    root->unref();
+  }
+  (void)printf("%f\n", total.getValue() * 1000.0 / numruns);
+  return 0;
+}
+
+static void
+run_mode(const char * self, const char * filename, const char * mode, int numruns)
+{
+  SbString cmd;
+  cmd.sprintf("COIN_SOINPUT_READ_AHEAD=%d %s child %d %s",
+              strcmp(mode, "sync") == 0 ? 0 : 4, self, numruns, filename);
+  FILE * fp = popen(cmd.getString(), "r");
+  double t;
+  if (!fp || fscanf(fp, "%lf", &t) != 1) {
+    (void)fprintf(stderr, "could not run %s\n", cmd.getString());
+    if (fp) (void)pclose(fp);
+    return;
+  }
+  (void)pclose(fp);
+  (void)printf("  %-16s %9.2f ms\n", mode, t);
+}
+
+int
+main(int argc, char ** argv)
+{
+  if (argc > 3 && strcmp(argv[1], "child") == 0) {
+    return run_child(argv[3], atoi(argv[2]));
+  }
+
+  const int numruns = argc > 1 ? atoi(argv[1]) : 5;
+  const int numparts = argc > 2 ? atoi(argv[2]) : 20;
+  const int numpoints = argc > 3 ? atoi(argv[3]) : 20000;
+  const char * filename = argc > 4 ? argv[4] : "readahead-benchmark.iv";
+
+  SoDB::init();
+
+  (void)printf("%d parts with %d points, average of %d runs\n",
+               numparts, numpoints, numruns);
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < numparts; i++) {
+    SoCoordinate3 * coords = new SoCoordinate3;
+    coords->point.setNum(numpoints);
+    SbVec3f * points = coords->point.startEditing();
+    for (int j = 0; j < numpoints; j++) {
+      points[j].setValue(float(j % 1000) * 0.1f, float(j / 1000), float(i));
+    }
+    coords->point.finishEditing();
+    root->addChild(coords);
+  }
+
+  for (int compressed = 0; compressed < 2; compressed++) {
+    SoOutput out;
+    if (compressed && !out.setCompression("GZIP", 0.5f)) break;
+    if (!out.openFile(filename)) return 1;
+    SoWriteAction wa(&out);
+    wa.apply(root);
+    out.closeFile();
+
+    (void)printf("%s\n", compressed ? "gzip" : "plain");
+    run_mode(argv[0], filename, "sync", numruns);
+    run_mode(argv[0], filename, "read-ahead", numruns);
+  }
+
+  (void)remove(filename);
+  root->unref();
+  return 0;
+}
@@ -0,0 +1,131 @@
+/************************************************************************
+ *
+ * Measures contention on SoBase reference counting. A number of
+ * threads construct and destroy SoPath instances over one shared
+ * scene graph, so every append() and truncate() refs and unrefs the
+ * same few nodes from all threads at once.
+ *
+ * The scene graph is a tree of SoGroup nodes with FANOUT children
+ * per group, DEPTH levels deep. Each path goes from the root to a
+ * leaf picked from the path number. The paths do not audit the
+ * graph, so the only shared state they write to is the reference
+ * counts.
+ *
+ * The run is repeated for 1, 2, 4, ... up to NUMTHREADS threads, with
+ * the same number of paths per thread. With lock-free reference
+ * counting, the time per path should grow much less with the number
+ * of threads than it did with a global mutex.
+ *
+ * Usage: refcount [PATHSPERTHREAD [NUMTHREADS [DEPTH [FANOUT]]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/C/threads/thread.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoInfo.h>
+
+static int pathsperthread = 100000;
+static int depth = 8;
+static int fanout = 4;
+static SoGroup * root = NULL;
+
+// SoPath instances audit the children lists of the nodes in the path
+// by default, which is not safe to do from several threads.
+class BenchPath : public SoPath {
+public:
+  BenchPath(const int approxlength) : SoPath(approxlength) {
+    this->auditPath(FALSE);
+  }
+};
+
+static SoGroup *
+build_tree(int level)
+{
+  SoGroup * group = new SoGroup;
+  for (int i = 0; i < fanout; i++) {
+    if (level + 1 < depth) group->addChild(build_tree(level + 1));
+    else group->addChild(new SoInfo);
+  }
+  return group;
+}
+
+static void *
+thread_func(void * closure)
+{
+  const int seed = *((int *) closure);
+  int leaves = 0;
+  for (int i = 0; i < pathsperthread; i++) {
+    BenchPath * path = new BenchPath(depth + 1);
+    path->ref();
+    path->setHead(root);
+    int pick = seed + i;
+    for (int level = 0; level < depth; level++) {
+      path->append(pick % fanout);
+      pick /= fanout;
+    }
+    if (path->getTail()->isOfType(SoInfo::getClassTypeId())) leaves++;
+    path->unref();
+  }
+  *((int *) closure) = leaves;
+  return NULL;
+}
+
+int
+main(int argc, char ** argv)
+{
+  if (argc > 1) pathsperthread = atoi(argv[1]);
+  int maxthreads = argc > 2 ? atoi(argv[2]) : 8;
+  if (argc > 3) depth = atoi(argv[3]);
+  if (argc > 4) fanout = atoi(argv[4]);
+  if (maxthreads < 1) maxthreads = 1;
+  if (depth < 1) depth = 1;
+  if (fanout < 1) fanout = 1;
+
+  SoDB::init();
+
+  root = build_tree(0);
+  root->ref();
+
+  (void)printf("%d paths per thread, depth %d, fanout %d\n",
+               pathsperthread, depth, fanout);
+
+  cc_thread ** threads = new cc_thread*[maxthreads];
+  int * closures = new int[maxthreads];
+
+  for (int numthreads = 1; numthreads <= maxthreads; numthreads *= 2) {
+    SbTime t = SbTime::getTimeOfDay();
+    for (int i = 0; i < numthreads; i++) {
+      closures[i] = i * 7919;
+      threads[i] = cc_thread_construct(thread_func, &closures[i]);
+    }
+    int leaves = 0;
+    for (int i = 0; i < numthreads; i++) {
+      (void)cc_thread_join(threads[i], NULL);
+      cc_thread_destruct(threads[i]);
+      leaves += closures[i];
+    }
+    t = SbTime::getTimeOfDay() - t;
+
+    const double paths = double(numthreads) * double(pathsperthread);
+    (void)printf("%2d threads: %8.2f ms, %7.1f ns/path, %7.2f Mpaths/s "
+                 "(%d leaves, root refcount %d)\n",
+                 numthreads, t.getValue() * 1000.0,
+                 t.getValue() * 1.0e9 / paths,
+                 paths / t.getValue() / 1.0e6,
+                 leaves, root->getRefCount());
+
+    if (numthreads < maxthreads && numthreads * 2 > maxthreads) {
+      numthreads = maxthreads / 2;
+    }
+  }
+
+  delete[] closures;
+  delete[] threads;
+  root->unref();
+  return 0;
+}
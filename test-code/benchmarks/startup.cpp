@@ -0,0 +1,106 @@
+/************************************************************************
+ *
+ * Measures startup time, as seen by short-lived programs like batch
+ * file converters: SoDB::init(), SoInteraction::init(), and reading
+ * and traversing a small scene graph with a few common node types.
+ *
+ * Most builtin node and engine classes are initialized the first
+ * time they are used instead of in SoDB::init() (see
+ * SoType::deferInitClass()). Setting COIN_NO_DEFERRED_INIT_CLASS=1
+ * initializes all classes up front, like before.
+ *
+ * Without arguments, the program runs itself NUMRUNS times in each
+ * mode, since a process can only initialize Coin once, and reports
+ * the average times. The number of types is the number created when
+ * the measurements end.
+ *
+ * Usage: startup [NUMRUNS]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoInteraction.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+static const char scene[] =
+  "#Inventor V2.1 ascii\n\n"
+  "Separator {\n"
+  "  Material { diffuseColor 1 0 0 }\n"
+  "  Transform { translation 1 0 0 }\n"
+  "  Cube { }\n"
+  "  Coordinate3 { point [ 0 0 0, 1 0 0, 1 1 0 ] }\n"
+  "  IndexedFaceSet { coordIndex [ 0, 1, 2, -1 ] }\n"
+  "}\n";
+
+static int
+run_child(void)
+{
+  SbTime t0 = SbTime::getTimeOfDay();
+  SoDB::init();
+  SbTime t1 = SbTime::getTimeOfDay();
+  SoInteraction::init();
+  SbTime t2 = SbTime::getTimeOfDay();
+
+  SoInput in;
+  in.setBuffer((void *)scene, strlen(scene));
+  SoSeparator * root = SoDB::readAll(&in);
+  if (!root) return 1;
+  root->ref();
+  SoGetBoundingBoxAction action(SbViewportRegion(100, 100));
+  action.apply(root);
+  root->unref();
+  SbTime t3 = SbTime::getTimeOfDay();
+
+  (void)printf("%f %f %f %d\n",
+               (t1 - t0).getValue() * 1000.0,
+               (t2 - t1).getValue() * 1000.0,
+               (t3 - t2).getValue() * 1000.0,
+               SoType::getNumTypes());
+  return 0;
+}
+
+static void
+run_mode(const char * self, const char * mode, int numruns)
+{
+  double sum[3] = { 0.0, 0.0, 0.0 };
+  int numtypes = 0, done = 0;
+  char cmd[1024];
+  (void)sprintf(cmd, "COIN_NO_DEFERRED_INIT_CLASS=%d %s child",
+                strcmp(mode, "eager") == 0 ? 1 : 0, self);
+  for (int i = 0; i < numruns; i++) {
+    FILE * fp = popen(cmd, "r");
+    if (!fp) continue;
+    double t[3];
+    if (fscanf(fp, "%lf %lf %lf %d", &t[0], &t[1], &t[2], &numtypes) == 4) {
+      for (int j = 0; j < 3; j++) sum[j] += t[j];
+      done++;
+    }
+    (void)pclose(fp);
+  }
+  if (done == 0) {
+    (void)fprintf(stderr, "could not run %s\n", cmd);
+    return;
+  }
+  (void)printf("%-6s SoDB::init %7.2f ms, SoInteraction::init %6.2f ms, "
+               "read+bbox %6.2f ms, total %7.2f ms, %d types\n", mode,
+               sum[0] / done, sum[1] / done, sum[2] / done,
+               (sum[0] + sum[1] + sum[2]) / done, numtypes);
+}
+
+int
+main(int argc, char ** argv)
+{
+  if (argc > 1 && strcmp(argv[1], "child") == 0) return run_child();
+
+  const int numruns = argc > 1 ? atoi(argv[1]) : 20;
+  (void)printf("average of %d runs\n", numruns);
+  run_mode(argv[0], "eager", numruns);
+  run_mode(argv[0], "lazy", numruns);
+  return 0;
+}
@@ -0,0 +1,154 @@
+/************************************************************************
+ *
+ * Measures reading a large file with many top-level parts, as when a
+ * pipeline converts or analyzes huge models part by part, comparing
+ * SoDB::readAll() of the complete scene graph to processing each
+ * part as soon as it has been read with SoInput::setNodeCallback().
+ *
+ * The file has NUMPARTS top-level separators, each with an
+ * SoCoordinate3 node of NUMPOINTS points and an SoPointSet, and is
+ * written to FILE in ASCII format. For each mode, the time until the
+ * first part is available, the total time, the number of progress
+ * reports from SoDB::addProgressCallback(), and the largest number
+ * of points held in memory at once are reported. The file is
+ * removed afterwards.
+ *
+ * Usage: streamingread [NUMPARTS [NUMPOINTS [FILE]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoPointSet.h>
+
+struct State {
+  SbTime start;
+  SbTime first;
+  int numpoints;
+  int maxpoints;
+  int numreports;
+  double sum;
+};
+
+static void
+report(const char * what, const SbTime & t)
+{
+  (void)printf("  %-16s %9.2f ms\n", what, t.getValue() * 1000.0);
+}
+
+static void
+process(State * state, SoNode * part)
+{
+  if (state->first == SbTime::zero()) {
+    state->first = SbTime::getTimeOfDay() - state->start;
+  }
+  SoCoordinate3 * coords = (SoCoordinate3 *) ((SoSeparator *) part)->getChild(0);
+  const SbVec3f * points = coords->point.getValues(0);
+  for (int i = 0; i < coords->point.getNum(); i++) state->sum += points[i][2];
+}
+
+static SbBool
+node_cb(void * userdata, SoInput * in, SoNode * node, int depth)
+{
+  State * state = (State *) userdata;
+  state->numpoints += ((SoCoordinate3 *) ((SoSeparator *) node)->getChild(0))->point.getNum();
+  if (state->numpoints > state->maxpoints) state->maxpoints = state->numpoints;
+  process(state, node);
+  // the part is not added to the scene graph, and is deleted here
+  node->ref();
+  node->unref();
+  state->numpoints = 0;
+  return FALSE;
+}
+
+static SbBool
+progress_cb(const SbName & itemid, float fraction, SbBool interruptible, void * userdata)
+{
+  ((State *) userdata)->numreports++;
+  return FALSE;
+}
+
+static void
+run(const char * filename, SbBool streaming)
+{
+  (void)printf("%s\n", streaming ? "streaming" : "readAll");
+
+  State state;
+  state.first = SbTime::zero();
+  state.numpoints = state.maxpoints = state.numreports = 0;
+  state.sum = 0.0;
+  SoDB::addProgressCallback(progress_cb, &state);
+
+  SoInput in;
+  if (!in.openFile(filename)) return;
+  if (streaming) in.setNodeCallback(node_cb, &state);
+  state.start = SbTime::getTimeOfDay();
+  SoSeparator * root = SoDB::readAll(&in);
+  in.closeFile();
+  if (!root) return;
+  root->ref();
+  if (!streaming) {
+    for (int i = 0; i < root->getNumChildren(); i++) {
+      state.maxpoints +=
+        ((SoCoordinate3 *) ((SoSeparator *) root->getChild(i))->getChild(0))->point.getNum();
+      process(&state, root->getChild(i));
+    }
+  }
+  const SbTime total = SbTime::getTimeOfDay() - state.start;
+  root->unref();
+  SoDB::removeProgressCallback(progress_cb, &state);
+
+  report("first part", state.first);
+  report("total", total);
+  (void)printf("  %-16s %9d\n", "progress reports", state.numreports);
+  (void)printf("  %-16s %9d (sum %.1f)\n", "max points", state.maxpoints, state.sum);
+}
+
+int
+main(int argc, char ** argv)
+{
+  const int numparts = argc > 1 ? atoi(argv[1]) : 200;
+  const int numpoints = argc > 2 ? atoi(argv[2]) : 20000;
+  const char * filename = argc > 3 ? argv[3] : "streamingread-benchmark.iv";
+
+  SoDB::init();
+
+  (void)printf("%d parts with %d points\n", numparts, numpoints);
+
+  SoSeparator * root = new SoSeparator;
+  root->ref();
+  for (int i = 0; i < numparts; i++) {
+    SoSeparator * part = new SoSeparator;
+    SoCoordinate3 * coords = new SoCoordinate3;
+    coords->point.setNum(numpoints);
+    SbVec3f * points = coords->point.startEditing();
+    for (int j = 0; j < numpoints; j++) {
+      points[j].setValue(float(j % 1000), float(j / 1000), float(i));
+    }
+    coords->point.finishEditing();
+    part->addChild(coords);
+    part->addChild(new SoPointSet);
+    root->addChild(part);
+  }
+
+  // write the parts as top-level nodes
+  SoOutput out;
+  if (!out.openFile(filename)) return 1;
+  SoWriteAction wa(&out);
+  for (int i = 0; i < numparts; i++) wa.apply(root->getChild(i));
+  out.closeFile();
+  root->unref();
+
+  run(filename, FALSE);
+  run(filename, TRUE);
+
+  (void)remove(filename);
+  return 0;
+}
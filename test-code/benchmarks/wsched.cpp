@@ -0,0 +1,108 @@
+/************************************************************************
+ *
+ * Measures the overhead of running many small jobs through the
+ * work-stealing scheduler (cc_wsched), and compares it with the
+ * priority scheduler (cc_sched). Each job sums a few square roots.
+ *
+ * Three variants are timed:
+ *   - cc_sched_schedule() once per job, then cc_sched_wait_all()
+ *   - cc_wsched_group_run() once per job, then cc_wsched_group_wait()
+ *   - cc_wsched_parallel_for() over all jobs
+ *
+ * Usage: wsched [NUMJOBS [NUMTHREADS [JOBSIZE]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SbTime.h>
+#include <Inventor/C/threads/sched.h>
+#include <Inventor/C/threads/wsched.h>
+
+static int jobsize = 100;
+static double * results = NULL;
+
+static void
+job(int idx)
+{
+  double sum = 0.0;
+  for (int i = 0; i < jobsize; i++) sum += sqrt(double(idx + i));
+  results[idx] = sum;
+}
+
+struct JobData {
+  int idx;
+};
+
+static void
+sched_job(void * closure)
+{
+  job(((JobData *) closure)->idx);
+}
+
+static void
+range_job(void * closure, int begin, int end)
+{
+  for (int i = begin; i < end; i++) job(i);
+}
+
+static double
+checksum(int numjobs)
+{
+  double sum = 0.0;
+  for (int i = 0; i < numjobs; i++) { sum += results[i]; results[i] = 0.0; }
+  return sum;
+}
+
+int
+main(int argc, char ** argv)
+{
+  int numjobs = argc > 1 ? atoi(argv[1]) : 200000;
+  int numthreads = argc > 2 ? atoi(argv[2]) : 4;
+  if (numthreads < 1) numthreads = 1; // cc_sched needs a thread
+  if (argc > 3) jobsize = atoi(argv[3]);
+
+  SoDB::init();
+
+  results = new double[numjobs];
+  JobData * data = new JobData[numjobs];
+  for (int i = 0; i < numjobs; i++) { data[i].idx = i; results[i] = 0.0; }
+
+  (void)printf("%d jobs of size %d, %d threads\n", numjobs, jobsize, numthreads);
+
+  cc_sched * sched = cc_sched_construct(numthreads);
+  SbTime t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numjobs; i++) {
+    cc_sched_schedule(sched, sched_job, &data[i], 0.0f);
+  }
+  cc_sched_wait_all(sched);
+  t = SbTime::getTimeOfDay() - t;
+  (void)printf("cc_sched:               %8.2f ms (checksum %g)\n",
+               t.getValue() * 1000.0, checksum(numjobs));
+  cc_sched_destruct(sched);
+
+  cc_wsched * wsched = cc_wsched_construct(numthreads);
+  cc_wsched_group * group = cc_wsched_group_construct(wsched);
+  t = SbTime::getTimeOfDay();
+  for (int i = 0; i < numjobs; i++) {
+    cc_wsched_group_run(group, sched_job, &data[i]);
+  }
+  cc_wsched_group_wait(group);
+  t = SbTime::getTimeOfDay() - t;
+  (void)printf("cc_wsched group:        %8.2f ms (checksum %g)\n",
+               t.getValue() * 1000.0, checksum(numjobs));
+  cc_wsched_group_destruct(group);
+
+  t = SbTime::getTimeOfDay();
+  cc_wsched_parallel_for(wsched, 0, numjobs, 0, range_job, NULL);
+  t = SbTime::getTimeOfDay() - t;
+  (void)printf("cc_wsched parallel_for: %8.2f ms (checksum %g)\n",
+               t.getValue() * 1000.0, checksum(numjobs));
+  cc_wsched_destruct(wsched);
+
+  delete[] data;
+  delete[] results;
+  return 0;
+}
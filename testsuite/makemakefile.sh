@@ -189,7 +189,7 @@ if ${includeInternalTests}
 then
     cat <<"EODATA" >&5
 TS_INCLUDES = -I$(top_srcdir)/include -I$(top_srcdir)/include/Inventor/annex -I$(top_builddir)/include -I$(top_builddir)/include/Inventor/annex -I$(top_srcdir)/testsuite -I$(top_srcdir)/src
-TS_CPPFLAGS = $(TS_INCLUDES) @COIN_TESTSUITE_EXTRA_CPPFLAGS@ @COIN_EXTRA_CPPFLAGS@ @COIN_EXTRA_CXXFLAGS@ -DCOIN_INT_TEST_SUITE -Werror -g2
+TS_CPPFLAGS = $(TS_INCLUDES) @COIN_TESTSUITE_EXTRA_CPPFLAGS@ @COIN_EXTRA_CPPFLAGS@ @COIN_EXTRA_CXXFLAGS@ -DCOIN_INTERNAL -DCOIN_INT_TEST_SUITE -Werror -g2
 EODATA
 else
     cat <<"EODATA" >&5